@@ -0,0 +1,123 @@
+/*
+ * Band plan
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "band_plan.h"
+#include "iridium.h"
+#include "pipeline_stats.h"
+
+/* First simplex channel */
+#define SIMPLEX_CHANNEL ((int)lround((IR_SIMPLEX_FREQUENCY_MIN - IR_BASE_FREQ) \
+                                     / IR_CHANNEL_WIDTH))
+
+static int parse_item(const char *item, uint8_t *wanted) {
+    int lo, hi;
+    if (strcmp(item, "simplex") == 0) {
+        lo = SIMPLEX_CHANNEL;
+        hi = IR_CHANNELS - 1;
+    } else if (strcmp(item, "duplex") == 0) {
+        lo = 0;
+        hi = SIMPLEX_CHANNEL - 1;
+    } else {
+        char *end;
+        lo = hi = (int)strtol(item, &end, 10);
+        if (end == item)
+            return -1;
+        if (*end == '-') {
+            const char *s = end + 1;
+            hi = (int)strtol(s, &end, 10);
+            if (end == s)
+                return -1;
+        }
+        if (*end || lo < 0 || hi < lo || hi >= IR_CHANNELS)
+            return -1;
+    }
+    for (int k = lo; k <= hi; k++)
+        wanted[k] = 1;
+    return 0;
+}
+
+band_plan_t *band_plan_parse(const char *spec) {
+    uint8_t wanted[IR_CHANNELS] = { 0 };
+    char *buf = strdup(spec);
+    char *save = NULL;
+    int ok = buf != NULL;
+
+    for (char *tok = ok ? strtok_r(buf, ",", &save) : NULL; tok && ok;
+         tok = strtok_r(NULL, ",", &save))
+        ok = parse_item(tok, wanted) == 0;
+    free(buf);
+    if (!ok)
+        return NULL;
+
+    band_plan_t *plan = calloc(1, sizeof(*plan));
+    if (!plan)
+        return NULL;
+    for (int k = 0; k < IR_CHANNELS; k++) {
+        plan->index[k] = -1;
+        if (wanted[k]) {
+            plan->index[k] = plan->n_channels;
+            plan->channels[plan->n_channels++] = k;
+        }
+    }
+    if (plan->n_channels == 0) {
+        free(plan);
+        return NULL;
+    }
+    for (int i = 0; i < plan->n_channels; i++)
+        atomic_init(&plan->bursts[i], 0);
+    atomic_init(&plan->off_plan, 0);
+    return plan;
+}
+
+int band_plan_channel(double freq) {
+    double k = floor((freq - IR_BASE_FREQ) / IR_CHANNEL_WIDTH);
+    return k >= 0 && k < IR_CHANNELS ? (int)k : -1;
+}
+
+int band_plan_covers(const band_plan_t *plan, double freq) {
+    return band_plan_covers_range(plan, freq, freq);
+}
+
+int band_plan_covers_range(const band_plan_t *plan, double lo, double hi) {
+    /* Every channel within the Doppler margin of [lo, hi] */
+    int first = (int)floor((lo - BAND_PLAN_DOPPLER_HZ - IR_BASE_FREQ)
+                           / IR_CHANNEL_WIDTH);
+    int last = (int)floor((hi + BAND_PLAN_DOPPLER_HZ - IR_BASE_FREQ)
+                          / IR_CHANNEL_WIDTH);
+    if (first < 0)
+        first = 0;
+    if (last >= IR_CHANNELS)
+        last = IR_CHANNELS - 1;
+    for (int k = first; k <= last; k++)
+        if (plan->index[k] >= 0)
+            return 1;
+    return 0;
+}
+
+void band_plan_count(band_plan_t *plan, double freq) {
+    int k = band_plan_channel(freq);
+    if (k >= 0 && plan->index[k] >= 0)
+        atomic_fetch_add_explicit(&plan->bursts[plan->index[k]], 1,
+                                  memory_order_relaxed);
+    else
+        atomic_fetch_add_explicit(&plan->off_plan, 1, memory_order_relaxed);
+}
+
+void band_plan_add_counters(band_plan_t *plan) {
+    pstats_add_counter_set("channel_bursts", "Bursts detected per band-plan channel",
+                           "channel", plan->n_channels, plan->channels,
+                           plan->bursts);
+    pstats_add_counter("bursts_off_plan",
+                       "Bursts kept by the band plan's Doppler margin, centered in an unplanned channel",
+                       &plan->off_plan);
+}
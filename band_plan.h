@@ -0,0 +1,60 @@
+/*
+ * Band plan -- the Iridium channels a run detects (--channels)
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Band plan -- the Iridium channels a run detects (--channels)
+ *
+ * Channel k spans IR_BASE_FREQ + [k, k + 1) * IR_CHANNEL_WIDTH, as in
+ * GSMTAP: 0-239 are the duplex channels, 240-251 the simplex band from
+ * IR_SIMPLEX_FREQUENCY_MIN. A burst arrives up to BAND_PLAN_DOPPLER_HZ
+ * off its channel, so a planned channel covers that much either side of
+ * itself, and a burst may be counted against a neighbour of the channel
+ * it was sent on.
+ *
+ * Each detector turns the plan into a per-bin mask. A peak outside it
+ * never starts a burst, so the burst is never extracted, queued or
+ * downmixed.
+ */
+
+#ifndef __BAND_PLAN_H__
+#define __BAND_PLAN_H__
+
+#include <stdatomic.h>
+
+#include "gsmtap.h"
+
+/* Largest Doppler shift of an Iridium burst */
+#define BAND_PLAN_DOPPLER_HZ 37500.0
+
+typedef struct band_plan {
+    int n_channels;
+    int channels[IR_CHANNELS];      /* planned channels, ascending */
+    int index[IR_CHANNELS];         /* position in channels[], or -1 */
+    atomic_ulong bursts[IR_CHANNELS];   /* per planned channel */
+    atomic_ulong off_plan;          /* bursts centered outside the plan */
+} band_plan_t;
+
+/* Parse a comma-separated list of simplex, duplex, channel numbers N and
+ * ranges N-M (0-251). Returns NULL if the list is malformed or empty. */
+band_plan_t *band_plan_parse(const char *spec);
+
+/* Channel of freq (Hz), or -1 outside the Iridium band */
+int band_plan_channel(double freq);
+
+/* Nonzero if a burst centered at freq may belong to a planned channel */
+int band_plan_covers(const band_plan_t *plan, double freq);
+
+/* Nonzero if a burst centered anywhere in [lo, hi] may */
+int band_plan_covers_range(const band_plan_t *plan, double lo, double hi);
+
+/* Count a detected burst centered at freq */
+void band_plan_count(band_plan_t *plan, double freq);
+
+/* Export the per-channel counts in the JSON line and on /metrics */
+void band_plan_add_counters(band_plan_t *plan);
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ * Chase soft-decision decoding for the 31-bit BCH codes
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <stdlib.h>
+
+#include "bch_chase.h"
+#include "simd_kernels.h"
+
+int bch_code_init(bch_code_t *code, uint32_t poly, int max_errors)
+{
+    gf2_mod_table_init(&code->mod, poly);
+    code->syn_bits = code->mod.deg;
+
+    int size = 1 << code->syn_bits;
+    code->err = malloc((size + 1) * sizeof(*code->err));
+    if (!code->err)
+        return -1;
+    for (int s = 0; s <= size; s++)
+        code->err[s] = SIMD_CHASE_NONE;
+
+    /* Bit i of the codeword (first bit 0) is bit 30 - i of the word */
+    for (int i = 0; i < 31; i++)
+        code->bit_syn[i] = (uint16_t)gf2_remainder(poly, 1u << (30 - i));
+
+    code->err[0] = SIMD_CHASE_ERR(SIMD_CHASE_NOPOS, SIMD_CHASE_NOPOS);
+    for (int i = 0; i < 31; i++) {
+        uint16_t s = code->bit_syn[i];
+        if (code->err[s] == SIMD_CHASE_NONE)
+            code->err[s] = SIMD_CHASE_ERR(i, SIMD_CHASE_NOPOS);
+    }
+    if (max_errors >= 2) {
+        for (int i = 0; i < 31; i++) {
+            for (int j = i + 1; j < 31; j++) {
+                uint16_t s = code->bit_syn[i] ^ code->bit_syn[j];
+                if (code->err[s] == SIMD_CHASE_NONE)
+                    code->err[s] = SIMD_CHASE_ERR(i, j);
+            }
+        }
+    }
+    return 0;
+}
+
+void bch_code_free(bch_code_t *code)
+{
+    free(code->err);
+    code->err = NULL;
+}
+
+/* Word with the error positions of table entry e flipped */
+static uint32_t apply_err(uint32_t word, uint16_t e)
+{
+    int p1 = e & 31, p2 = (e >> 5) & 31;
+    if (p1 != SIMD_CHASE_NOPOS)
+        word ^= 1u << (30 - p1);
+    if (p2 != SIMD_CHASE_NOPOS)
+        word ^= 1u << (30 - p2);
+    return word;
+}
+
+int bch_chase_decode(const bch_code_t *code, uint32_t word, const float *rel,
+                     int k, uint32_t *out)
+{
+    uint16_t syn0 = (uint16_t)gf2_mod32(&code->mod, word);
+    uint16_t e = code->err[syn0];
+
+    if (e != SIMD_CHASE_NONE) {
+        *out = apply_err(word, e);
+        return __builtin_popcount(*out ^ word);
+    }
+
+    /* Standard BCH failed -- Chase decode with soft info */
+    if (!rel)
+        return -1;
+
+    /* k least reliable positions, by partial selection sort */
+    int pos[31];
+    for (int i = 0; i < 31; i++)
+        pos[i] = i;
+    for (int i = 0; i < k; i++) {
+        int min_idx = i;
+        for (int j = i + 1; j < 31; j++) {
+            if (rel[pos[j]] < rel[pos[min_idx]])
+                min_idx = j;
+        }
+        int tmp = pos[i];
+        pos[i] = pos[min_idx];
+        pos[min_idx] = tmp;
+    }
+
+    /* Position 31 stands for "no error" in the table entries */
+    float rel32[32];
+    for (int i = 0; i < 31; i++)
+        rel32[i] = rel[i];
+    rel32[SIMD_CHASE_NOPOS] = 0.0f;
+
+    /* Candidate m flips position pos[b] for every bit b of m. Each
+     * doubling step adds one position to the second half. */
+    uint16_t syn[1 << CHASE_MAX_BITS];
+    float cost[1 << CHASE_MAX_BITS];
+    syn[0] = syn0;
+    cost[0] = 0.0f;
+    for (int b = 0; b < k; b++) {
+        int h = 1 << b;
+        uint16_t bs = code->bit_syn[pos[b]];
+        float r = rel[pos[b]];
+        for (int m = 0; m < h; m++) {
+            syn[h + m] = syn[m] ^ bs;
+            cost[h + m] = cost[m] + r;
+        }
+    }
+
+    /* A correction that undoes a flip of candidate m overstates its
+     * cost, but the same codeword is also candidate m without that flip,
+     * whose smaller correction is the table entry and whose cost is
+     * exact. So the minimum is the exact one, found at the lower m. */
+    int best = simd_chase_select(syn, cost, 1 << k, code->err, rel32);
+    if (best < 0)
+        return -1;
+
+    uint32_t flipped = word;
+    for (int b = 0; b < k; b++)
+        if (best & (1 << b))
+            flipped ^= 1u << (30 - pos[b]);
+    *out = apply_err(flipped, code->err[syn[best]]);
+    return __builtin_popcount(*out ^ word);
+}
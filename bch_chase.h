@@ -0,0 +1,53 @@
+/*
+ * Chase soft-decision decoding for the 31-bit BCH codes
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Chase soft-decision decoding for the 31-bit BCH codes
+ *
+ * When the hard-decision syndrome is not correctable, every combination of
+ * the k least reliable bits is flipped and decoded again. The syndrome is
+ * linear, so the 2^k candidate syndromes come from the hard syndrome and
+ * the k single-bit syndromes by XOR, without dividing each candidate by the
+ * generator. Each correctable candidate is scored by the reliability of
+ * every bit it changes (flipped bits plus the BCH correction), and the
+ * lowest score wins. Scoring runs in the simd_chase_select kernel.
+ */
+
+#ifndef __BCH_CHASE_H__
+#define __BCH_CHASE_H__
+
+#include <stdint.h>
+
+#include "frame_decode.h"
+
+/* Least reliable bits searched (--chase-bits) */
+#define CHASE_DEFAULT_BITS  5
+#define CHASE_MAX_BITS      10
+
+/* One code: the syndrome table and each syndrome's hard-decision error
+ * positions, packed as in simd_kernels.h (SIMD_CHASE_*) */
+typedef struct {
+    gf2_mod_table_t mod;
+    int syn_bits;
+    uint16_t bit_syn[31];   /* syndrome of an error at bit i, first bit 0 */
+    uint16_t *err;          /* 2^syn_bits entries, plus one of padding */
+} bch_code_t;
+
+/* Build the tables for a 31-bit code with generator poly correcting up
+ * to max_errors (1 or 2) bits. Returns 0, or -1 if out of memory. */
+int bch_code_init(bch_code_t *code, uint32_t poly, int max_errors);
+
+void bch_code_free(bch_code_t *code);
+
+/* Decode a 31-bit word (first bit in bit 30). rel holds the reliability
+ * of each bit, first bit first, or is NULL for hard decisions only; k
+ * bits are searched (1..CHASE_MAX_BITS). Returns the number of bits
+ * changed, with the codeword in *out, or -1 if no candidate decodes. */
+int bch_chase_decode(const bch_code_t *code, uint32_t word, const float *rel,
+                     int k, uint32_t *out);
+
+#endif
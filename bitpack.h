@@ -0,0 +1,98 @@
+/*
+ * Packed bit streams
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Packed bit streams
+ *
+ * Demodulated bits and decoder bitstreams are stored 64 to a word, first
+ * bit in the MSB: bit i of a stream is bit (63 - i % 64) of word i / 64.
+ * Read n bits at any position as an integer with the first bit on top,
+ * the order the Iridium fields and BCH codewords are defined in.
+ *
+ * Buffers carry one word of padding past their last bit, so bits_get()
+ * may always look at the word after the one a field starts in.
+ */
+
+#ifndef __BITPACK_H__
+#define __BITPACK_H__
+
+#include <stdint.h>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+/* Words needed for n bits, padding included */
+#define BITPACK_WORDS(n)    (((n) + 63) / 64 + 1)
+
+/* n (1..64) bits starting at pos, first bit in the MSB of the result */
+static inline uint64_t bits_get(const uint64_t *w, int pos, int n) {
+    const uint64_t *p = w + (pos >> 6);
+    int off = pos & 63;
+    uint64_t v = p[0] << off;
+    if (off)
+        v |= p[1] >> (64 - off);
+    return v >> (64 - n);
+}
+
+static inline int bits_test(const uint64_t *w, int pos) {
+    return (int)(w[pos >> 6] >> (63 - (pos & 63))) & 1;
+}
+
+/* OR the low n (1..64) bits of v in at pos; the target bits must be 0 */
+static inline void bits_put(uint64_t *w, int pos, uint64_t v, int n) {
+    uint64_t *p = w + (pos >> 6);
+    int off = pos & 63;
+    uint64_t a = v << (64 - n);
+    p[0] |= a >> off;
+    if (off && off + n > 64)
+        p[1] |= a << (64 - off);
+}
+
+/* ---- Symbol de-interleaving ----
+ *
+ * A symbol is a pair of bits. In a 64-bit word holding 32 symbols
+ * (symbol 0 on top), gather the odd or even symbols and return them in
+ * reverse symbol order: 31, 29, ..., 1 or 30, 28, ..., 0. This is the
+ * two-way Iridium de-interleave of one 64-bit block.
+ */
+
+/* Pack the 2-bit groups at even group positions (from the LSB) into
+ * the low 32 bits, keeping their order */
+static inline uint32_t sym_compress_even(uint64_t x) {
+#if defined(__BMI2__)
+    return (uint32_t)_pext_u64(x, 0x3333333333333333ULL);
+#else
+    x &= 0x3333333333333333ULL;
+    x = (x | (x >> 2))  & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x >> 4))  & 0x00FF00FF00FF00FFULL;
+    x = (x | (x >> 8))  & 0x0000FFFF0000FFFFULL;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+    return (uint32_t)x;
+#endif
+}
+
+/* Reverse the order of the 16 symbols in a 32-bit word */
+static inline uint32_t sym_reverse16(uint32_t v) {
+    v = ((v >> 2) & 0x33333333u) | ((v & 0x33333333u) << 2);
+    v = ((v >> 4) & 0x0F0F0F0Fu) | ((v & 0x0F0F0F0Fu) << 4);
+    return __builtin_bswap32(v);
+}
+
+/* Symbols 31, 29, ..., 1 of x */
+static inline uint32_t sym_odd_rev(uint64_t x) {
+    /* Symbol s sits at group 31 - s from the LSB, so the odd symbols
+     * are the even groups; compressed, symbol 1 ends up on top */
+    return sym_reverse16(sym_compress_even(x));
+}
+
+/* Symbols 30, 28, ..., 0 of x */
+static inline uint32_t sym_even_rev(uint64_t x) {
+    return sym_reverse16(sym_compress_even(x >> 2));
+}
+
+#endif
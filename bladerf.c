@@ -13,16 +13,16 @@
 
 #include <libbladeRF.h>
 
+#include "sample_pool.h"
 #include "sdr.h"
 
-const unsigned num_transfers = 7;
-
 extern sig_atomic_t running;
 extern pid_t self_pid;
 extern double samp_rate;
-extern double center_freq;
 extern int bladerf_gain_val;
 extern int bias_tee;
+extern int sdr_buffers;
+extern int sdr_buffer_size;
 
 unsigned timeouts = 0;
 int num_samples_workaround = 0;
@@ -47,7 +47,7 @@ out:
         bladerf_free_device_list(devices);
 }
 
-struct bladerf *bladerf_setup(int id) {
+struct bladerf *bladerf_setup(int id, double freq) {
     struct bladerf_version version;
     int status;
     char identifier[32];
@@ -66,7 +66,7 @@ struct bladerf *bladerf_setup(int id) {
 
     if ((status = bladerf_set_bandwidth(bladerf, BLADERF_CHANNEL_RX(0), (unsigned)(samp_rate * 0.9), NULL)) != 0)
         errx(1, "Unable to set bladeRF bandwidth: %s", bladerf_strerror(status));
-    if ((status = bladerf_set_frequency(bladerf, BLADERF_CHANNEL_RX(0), (uint64_t)center_freq)) != 0)
+    if ((status = bladerf_set_frequency(bladerf, BLADERF_CHANNEL_RX(0), (uint64_t)freq)) != 0)
         errx(1, "Unable to set bladeRF center frequency: %s", bladerf_strerror(status));
     if ((status = bladerf_set_gain_mode(bladerf, BLADERF_CHANNEL_RX(0), BLADERF_GAIN_MGC)) != 0)
         errx(1, "Unable to set bladeRF manual gain control: %s", bladerf_strerror(status));
@@ -89,31 +89,41 @@ void *bladerf_rx_cb(struct bladerf *bladerf, struct bladerf_stream *stream, stru
     if (num_samples_workaround)
         num_samples *= 2;
 
-    sample_buf_t *s = malloc(sizeof(*s) + num_samples * sizeof(float) * 2);
-    s->format = SAMPLE_FMT_FLOAT;
+    /* SC16 Q11 (+-2048) scaled up to int16 full scale: the samples stay
+     * 4 bytes each and keep their 12 bits */
+    sample_buf_t *s = sample_buf_alloc(num_samples * sizeof(int16_t) * 2);
+    s->format = SAMPLE_FMT_INT16;
     s->num = num_samples;
-    float *out = (float *)s->samples;
+    s->rx = (int)(intptr_t)user_data;
+    int16_t *out = (int16_t *)s->samples;
     for (i = 0; i < num_samples * 2; ++i)
-        out[i] = d[i] * (1.0f / 2048.0f);
+        out[i] = (int16_t)(d[i] * 16);
 
     if (running)
         push_samples(s);
     else
-        free(s);
+        sample_buf_free(s);
 
     return samples;
 }
 
 void *bladerf_stream_thread(void *arg) {
-    struct bladerf *bladerf = (struct bladerf *)arg;
+    sdr_stream_t *rx = (sdr_stream_t *)arg;
+    struct bladerf *bladerf = (struct bladerf *)rx->dev;
     struct bladerf_stream *stream;
     struct bladerf_rational_rate rate = { .integer = (uint64_t)samp_rate, .num = 0, .den = 1 };
     void **buffers = NULL;
     unsigned timeout;
     int status;
-    unsigned buf_samples = 16384;
+    unsigned buf_samples = sdr_buffer_size ? (unsigned)sdr_buffer_size : 16384;
+    unsigned num_buffers = sdr_buffers ? (unsigned)sdr_buffers : 7;
+
+    /* As many transfers in flight as buffers up to the default 7; beyond
+     * that, half of them, so the callback always has spares to return */
+    unsigned num_transfers = num_buffers <= 7 ? num_buffers
+                           : num_buffers / 2 > 7 ? num_buffers / 2 : 7;
 
-    if ((status = bladerf_init_stream(&stream, bladerf, bladerf_rx_cb, &buffers, num_transfers, BLADERF_FORMAT_SC16_Q11, buf_samples, num_transfers, NULL)) != 0)
+    if ((status = bladerf_init_stream(&stream, bladerf, bladerf_rx_cb, &buffers, num_buffers, BLADERF_FORMAT_SC16_Q11, buf_samples, num_transfers, (void *)(intptr_t)rx->rx)) != 0)
         errx(1, "Unable to initialize bladeRF stream: %s", bladerf_strerror(status));
 
     if ((status = bladerf_set_rational_sample_rate(bladerf, BLADERF_CHANNEL_RX(0), &rate, NULL)) != 0)
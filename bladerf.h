@@ -8,7 +8,8 @@
 #include <libbladeRF.h>
 
 void bladerf_list(void);
-struct bladerf *bladerf_setup(int id);
+struct bladerf *bladerf_setup(int id, double freq);
+/* arg: sdr_stream_t with the device from bladerf_setup() */
 void *bladerf_stream_thread(void *arg);
 
 #endif
@@ -0,0 +1,440 @@
+/*
+ * Burst archive -- segmented burst IQ with a mappable index
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define _GNU_SOURCE
+#include <complex.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "blocking_queue.h"
+#include "burst_archive.h"
+
+#define ARCHIVE_QUEUE_LEN       1024
+#define ARCHIVE_DATA_BUF        (1 << 20)   /* stdio buffer of the .cf32 */
+
+extern atomic_ulong stat_archive_bursts;
+extern atomic_ulong stat_archive_dropped;
+
+typedef struct {
+    burst_archive_rec_t rec;
+    float complex samples[];
+} archive_item_t;
+
+static struct {
+    int open;
+    char *dir;
+    char *prefix;
+    uint64_t segment_bytes;
+    int max_segments;
+
+    Blocking_Queue queue;
+    pthread_t thread;
+
+    /* Writer thread only */
+    FILE *data;
+    FILE *index;
+    char *data_buf;
+    uint32_t segment;           /* number of the open pair */
+    uint32_t oldest;            /* lowest number still on disk */
+    uint64_t data_bytes;        /* bytes in the open .cf32 */
+    int failed;                 /* a write failed; stop writing */
+} ar;
+
+static void segment_path(char *buf, size_t len, uint32_t segment,
+                         const char *ext)
+{
+    snprintf(buf, len, "%s/%s-%06u.%s", ar.dir, ar.prefix, segment, ext);
+}
+
+/* Highest segment number of prefix in dir, and the lowest through *lowest;
+ * -1 if there is none */
+static long scan_segments(long *lowest)
+{
+    DIR *d = opendir(ar.dir);
+    if (!d)
+        return -1;
+
+    size_t plen = strlen(ar.prefix);
+    long highest = -1;
+    *lowest = -1;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        unsigned seg;
+        char ext[8];
+        if (strncmp(e->d_name, ar.prefix, plen) != 0 || e->d_name[plen] != '-')
+            continue;
+        if (sscanf(e->d_name + plen + 1, "%6u.%7s", &seg, ext) != 2 ||
+            strcmp(ext, "idx") != 0)
+            continue;
+        if ((long)seg > highest)
+            highest = seg;
+        if (*lowest < 0 || (long)seg < *lowest)
+            *lowest = seg;
+    }
+    closedir(d);
+    return highest;
+}
+
+static void segment_close(void)
+{
+    if (ar.data) {
+        if (fclose(ar.data) != 0)
+            ar.failed = 1;
+        ar.data = NULL;
+    }
+    if (ar.index) {
+        if (fclose(ar.index) != 0)
+            ar.failed = 1;
+        ar.index = NULL;
+    }
+}
+
+static int segment_open(uint32_t segment)
+{
+    char path[4096];
+
+    segment_path(path, sizeof(path), segment, "cf32");
+    ar.data = fopen(path, "wb");
+    if (!ar.data)
+        goto fail;
+    setvbuf(ar.data, ar.data_buf, _IOFBF, ARCHIVE_DATA_BUF);
+
+    segment_path(path, sizeof(path), segment, "idx");
+    ar.index = fopen(path, "wb");
+    if (!ar.index)
+        goto fail;
+
+    burst_archive_hdr_t hdr = {
+        .version = BURST_ARCHIVE_VERSION,
+        .rec_size = sizeof(burst_archive_rec_t),
+        .segment = segment,
+    };
+    memcpy(hdr.magic, BURST_ARCHIVE_MAGIC, 4);
+    if (fwrite(&hdr, sizeof(hdr), 1, ar.index) != 1)
+        goto fail;
+
+    ar.segment = segment;
+    ar.data_bytes = 0;
+    return 0;
+
+fail:
+    fprintf(stderr, "Warning: burst archive: %s: %s\n", path, strerror(errno));
+    segment_close();
+    return -1;
+}
+
+/* Delete pairs older than the last max_segments */
+static void segment_expire(void)
+{
+    if (ar.max_segments <= 0)
+        return;
+
+    char path[4096];
+    while (ar.segment - ar.oldest >= (uint32_t)ar.max_segments) {
+        segment_path(path, sizeof(path), ar.oldest, "idx");
+        unlink(path);
+        segment_path(path, sizeof(path), ar.oldest, "cf32");
+        unlink(path);
+        ar.oldest++;
+    }
+}
+
+static void archive_write(archive_item_t *item)
+{
+    uint64_t len = (uint64_t)item->rec.num_samples * sizeof(float complex);
+
+    if (ar.data && ar.data_bytes > 0 && ar.data_bytes + len > ar.segment_bytes) {
+        segment_close();
+        if (segment_open(ar.segment + 1) != 0) {
+            ar.failed = 1;
+            return;
+        }
+        segment_expire();
+    }
+
+    item->rec.offset = ar.data_bytes;
+    if (fwrite(item->samples, 1, len, ar.data) != len ||
+        fwrite(&item->rec, sizeof(item->rec), 1, ar.index) != 1) {
+        fprintf(stderr, "Warning: burst archive: write failed: %s\n",
+                strerror(errno));
+        ar.failed = 1;
+        return;
+    }
+    ar.data_bytes += len;
+    atomic_fetch_add(&stat_archive_bursts, 1);
+}
+
+static void *archive_thread(void *arg)
+{
+    (void)arg;
+    archive_item_t *item;
+
+    while (blocking_queue_take(&ar.queue, &item) == 0) {
+        if (!ar.failed)
+            archive_write(item);
+        else
+            atomic_fetch_add(&stat_archive_dropped, 1);
+        free(item);
+
+        /* Samples before their records, so a mapped index never points
+         * past the end of its .cf32 */
+        if (ar.queue.queue_size == 0 && !ar.failed) {
+            fflush(ar.data);
+            fflush(ar.index);
+        }
+    }
+
+    segment_close();
+    return NULL;
+}
+
+int burst_archive_open(const char *dir, const char *prefix,
+                       uint64_t segment_bytes, int max_segments)
+{
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST)
+        return -1;
+
+    ar.dir = strdup(dir);
+    ar.prefix = strdup(prefix);
+    ar.segment_bytes = segment_bytes;
+    ar.max_segments = max_segments;
+    ar.data_buf = malloc(ARCHIVE_DATA_BUF);
+
+    long lowest;
+    long highest = scan_segments(&lowest);
+    ar.oldest = highest < 0 ? 0 : (uint32_t)lowest;
+    if (segment_open(highest < 0 ? 0 : (uint32_t)highest + 1) != 0) {
+        int saved = errno;
+        free(ar.data_buf);
+        free(ar.prefix);
+        free(ar.dir);
+        errno = saved;
+        return -1;
+    }
+    segment_expire();
+
+    blocking_queue_init(&ar.queue, ARCHIVE_QUEUE_LEN);
+    pthread_create(&ar.thread, NULL, archive_thread, NULL);
+    ar.open = 1;
+    return 0;
+}
+
+void burst_archive_add(const downmix_frame_t *frame, int uw_fail)
+{
+    if (!ar.open)
+        return;
+
+    archive_item_t *item = malloc(sizeof(*item) +
+                                  frame->num_samples * sizeof(float complex));
+    if (!item) {
+        atomic_fetch_add(&stat_archive_dropped, 1);
+        return;
+    }
+
+    item->rec = (burst_archive_rec_t){
+        .id = frame->id,
+        .timestamp = frame->timestamp,
+        .center_frequency = frame->center_frequency,
+        .num_samples = (uint32_t)frame->num_samples,
+        .sample_rate = frame->sample_rate,
+        .samples_per_symbol = frame->samples_per_symbol,
+        .magnitude = frame->magnitude,
+        .noise = frame->noise,
+        .uw_start = frame->uw_start,
+        .direction = (uint8_t)frame->direction,
+        .flags = uw_fail ? BURST_ARCHIVE_UW_FAIL : 0,
+    };
+    memcpy(item->samples, frame->samples,
+           frame->num_samples * sizeof(float complex));
+
+    if (blocking_queue_add(&ar.queue, item) != 0) {
+        free(item);
+        atomic_fetch_add(&stat_archive_dropped, 1);
+    }
+}
+
+void burst_archive_close(void)
+{
+    if (!ar.open)
+        return;
+
+    while (ar.queue.queue_size > 0)
+        usleep(10000);
+    blocking_queue_close(&ar.queue);
+    pthread_join(ar.thread, NULL);
+    ar.open = 0;
+
+    free(ar.data_buf);
+    free(ar.prefix);
+    free(ar.dir);
+}
+
+const burst_archive_rec_t *burst_archive_map_index(const char *path, size_t *n)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(burst_archive_hdr_t)) {
+        close(fd);
+        return NULL;
+    }
+
+    /* A record still being written is left out */
+    size_t count = ((size_t)st.st_size - sizeof(burst_archive_hdr_t)) /
+                   sizeof(burst_archive_rec_t);
+    size_t len = sizeof(burst_archive_hdr_t) + count * sizeof(burst_archive_rec_t);
+    void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    const burst_archive_hdr_t *hdr = map;
+    if (memcmp(hdr->magic, BURST_ARCHIVE_MAGIC, 4) != 0 ||
+        hdr->version != BURST_ARCHIVE_VERSION ||
+        hdr->rec_size != sizeof(burst_archive_rec_t)) {
+        munmap(map, len);
+        return NULL;
+    }
+
+    *n = count;
+    return (const burst_archive_rec_t *)(hdr + 1);
+}
+
+void burst_archive_unmap_index(const burst_archive_rec_t *recs, size_t n)
+{
+    const burst_archive_hdr_t *hdr = (const burst_archive_hdr_t *)recs - 1;
+    munmap((void *)hdr, sizeof(*hdr) + n * sizeof(*recs));
+}
+
+static int is_index(const struct dirent *e)
+{
+    size_t len = strlen(e->d_name);
+    return len > 4 && strcmp(e->d_name + len - 4, ".idx") == 0;
+}
+
+static const burst_archive_rec_t *sort_recs;
+
+static int by_time(const void *a, const void *b)
+{
+    const burst_archive_rec_t *ra = &sort_recs[*(const size_t *)a];
+    const burst_archive_rec_t *rb = &sort_recs[*(const size_t *)b];
+    if (ra->timestamp != rb->timestamp)
+        return ra->timestamp < rb->timestamp ? -1 : 1;
+    return *(const size_t *)a < *(const size_t *)b ? -1 : 1;
+}
+
+/* Replay one segment; returns bursts delivered. *stop is set if fn asked
+ * to stop. */
+static long replay_segment(const char *idx_path, burst_archive_fn fn,
+                           void *arg, int *stop)
+{
+    size_t n;
+    const burst_archive_rec_t *recs = burst_archive_map_index(idx_path, &n);
+    if (!recs) {
+        fprintf(stderr, "Warning: burst archive: %s: not an archive index\n",
+                idx_path);
+        return 0;
+    }
+    if (n == 0) {
+        burst_archive_unmap_index(recs, n);
+        return 0;
+    }
+
+    char data_path[4096];
+    snprintf(data_path, sizeof(data_path), "%.*s.cf32",
+             (int)(strlen(idx_path) - 4), idx_path);
+    int fd = open(data_path, O_RDONLY);
+    struct stat st;
+    const uint8_t *data = NULL;
+    size_t data_len = 0;
+    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0) {
+        data_len = (size_t)st.st_size;
+        data = mmap(NULL, data_len, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED)
+            data = NULL;
+    }
+    if (fd >= 0)
+        close(fd);
+    if (!data) {
+        fprintf(stderr, "Warning: burst archive: %s: %s\n", data_path,
+                fd < 0 ? strerror(errno) : "empty or unreadable");
+        burst_archive_unmap_index(recs, n);
+        return 0;
+    }
+
+    /* Workers archive bursts as they finish them; replay in time order */
+    size_t *order = malloc(n * sizeof(*order));
+    for (size_t i = 0; i < n; i++)
+        order[i] = i;
+    sort_recs = recs;
+    qsort(order, n, sizeof(*order), by_time);
+
+    long done = 0;
+    for (size_t i = 0; i < n; i++) {
+        const burst_archive_rec_t *r = &recs[order[i]];
+        size_t len = (size_t)r->num_samples * sizeof(float complex);
+        if (r->offset > data_len || len > data_len - r->offset)
+            continue;
+
+        downmix_frame_t *frame = downmix_frame_alloc(r->num_samples);
+        if (!frame)
+            break;
+        frame->id = r->id;
+        frame->timestamp = r->timestamp;
+        frame->center_frequency = r->center_frequency;
+        frame->sample_rate = r->sample_rate;
+        frame->samples_per_symbol = r->samples_per_symbol;
+        frame->direction = (ir_direction_t)r->direction;
+        frame->magnitude = r->magnitude;
+        frame->noise = r->noise;
+        frame->uw_start = r->uw_start;
+        memcpy(frame->samples, data + r->offset, len);
+
+        if (fn(frame, arg) != 0) {
+            *stop = 1;
+            break;
+        }
+        done++;
+    }
+
+    free(order);
+    munmap((void *)data, data_len);
+    burst_archive_unmap_index(recs, n);
+    return done;
+}
+
+long burst_archive_replay(const char *dir, burst_archive_fn fn, void *arg)
+{
+    struct dirent **names;
+    int n = scandir(dir, &names, is_index, alphasort);
+    if (n < 0)
+        return -1;
+
+    long total = 0;
+    int stop = 0;
+    for (int i = 0; i < n; i++) {
+        if (!stop) {
+            char path[4096];
+            snprintf(path, sizeof(path), "%s/%s", dir, names[i]->d_name);
+            total += replay_segment(path, fn, arg, &stop);
+        }
+        free(names[i]);
+    }
+    free(names);
+    return total;
+}
@@ -0,0 +1,101 @@
+/*
+ * Burst archive -- segmented burst IQ with a mappable index
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Burst archive -- segmented burst IQ with a mappable index
+ *
+ * --save-bursts=DIR keeps every demodulated burst as it entered the
+ * demodulator (cf32 at the downmix output rate, unique word first) in
+ * pairs of append-only files:
+ *
+ *   PREFIX-NNNNNN.cf32    the samples of each burst, back to back
+ *   PREFIX-NNNNNN.idx     a burst_archive_hdr_t, then one
+ *                         burst_archive_rec_t per burst
+ *
+ * Both structs are 64 bytes in host byte order (little endian on every
+ * supported platform), so a mapped index is an array of records in the
+ * order the bursts were demodulated. A segment is closed once its
+ * samples would pass the size cap and the next number is opened; with a
+ * segment limit the oldest pair is deleted. Numbering continues after
+ * the highest segment already in DIR.
+ *
+ * Demod workers only copy the burst into a queue; one writer thread does
+ * the file I/O. A full queue drops the burst rather than stall the
+ * demodulator. --replay-bursts reads an archive back into the demod pool
+ * with burst_archive_replay().
+ */
+
+#ifndef __BURST_ARCHIVE_H__
+#define __BURST_ARCHIVE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "burst_downmix.h"
+
+#define BURST_ARCHIVE_MAGIC     "IRBA"
+#define BURST_ARCHIVE_VERSION   1
+
+/* The burst failed the unique word check (direction is DIR_UNDEF) */
+#define BURST_ARCHIVE_UW_FAIL   0x01
+
+typedef struct {
+    char magic[4];              /* BURST_ARCHIVE_MAGIC */
+    uint32_t version;           /* BURST_ARCHIVE_VERSION */
+    uint32_t rec_size;          /* sizeof(burst_archive_rec_t) */
+    uint32_t segment;           /* NNNNNN of this pair */
+    uint8_t reserved[48];
+} burst_archive_hdr_t;
+
+typedef struct {
+    uint64_t id;
+    uint64_t timestamp;         /* ns */
+    double center_frequency;    /* Hz */
+    uint64_t offset;            /* byte offset of the samples in the .cf32 */
+    uint32_t num_samples;       /* complex float samples */
+    float sample_rate;          /* Hz */
+    float samples_per_symbol;
+    float magnitude;            /* dB */
+    float noise;                /* dBFS/Hz */
+    float uw_start;             /* samples */
+    uint8_t direction;          /* ir_direction_t */
+    uint8_t flags;              /* BURST_ARCHIVE_* */
+    uint8_t reserved[6];
+} burst_archive_rec_t;
+
+/* Create dir if needed and start the writer thread. Segments are named
+ * prefix-NNNNNN; segment_bytes caps the samples of one segment and
+ * max_segments is how many are kept (0 = all). Returns 0, or -1 with
+ * errno set if dir cannot be used. */
+int burst_archive_open(const char *dir, const char *prefix,
+                       uint64_t segment_bytes, int max_segments);
+
+/* Queue a copy of frame for the writer; never blocks. uw_fail marks a
+ * burst that failed the unique word check. No-op if the archive is not
+ * open. */
+void burst_archive_add(const downmix_frame_t *frame, int uw_fail);
+
+/* Write out what is queued, stop the writer and close the segment */
+void burst_archive_close(void);
+
+/* Map the index file at path read-only. Returns its records and sets *n,
+ * or NULL if the file is not a burst archive index. */
+const burst_archive_rec_t *burst_archive_map_index(const char *path, size_t *n);
+
+/* Unmap an index returned by burst_archive_map_index() */
+void burst_archive_unmap_index(const burst_archive_rec_t *recs, size_t n);
+
+/* Takes ownership of frame (see downmix_frame_free()); nonzero stops the
+ * replay */
+typedef int (*burst_archive_fn)(downmix_frame_t *frame, void *arg);
+
+/* Hand every burst archived in dir to fn: the segments (of any prefix) in
+ * name order, each one's bursts in time order. Returns the number of
+ * bursts delivered, or -1 if dir cannot be read. */
+long burst_archive_replay(const char *dir, burst_archive_fn fn, void *arg);
+
+#endif
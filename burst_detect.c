@@ -11,6 +11,7 @@
 
 #define _GNU_SOURCE
 #include <complex.h>
+#include <err.h>
 #include <math.h>
 #include <signal.h>
 #include <stdatomic.h>
@@ -18,20 +19,34 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 #include <fftw3.h>
 
+#include "band_plan.h"
 #include "burst_detect.h"
-#include "fftw_lock.h"
+#include "burst_extract.h"
+#include "burst_sched.h"
+#include "fftw_plans.h"
 #include "iridium.h"
+#include "pipeline_stats.h"
+#include "placement.h"
+#include "sample_pool.h"
 #include "sdr.h"
 #include "simd_kernels.h"
 #include "window_func.h"
 
-#include "blocking_queue.h"
+#include "mpmc_ring.h"
+
+#define NOISE_FLOOR_BLOCK_FRAMES 16  /* frames per history row, BLOCK */
+#define OVERLAP_BATCH   16      /* overlapping frames per batched CPU FFT */
 
 #ifdef USE_GPU
 #include "burst_fft.h"
+
+#define GPU_BATCH_MS    20      /* detector frames per GPU dispatch, in time */
+#define GPU_BATCH_MIN   4
+#define GPU_BATCH_MAX   64
 #endif
 
 /* ---- Internal types ---- */
@@ -44,6 +59,7 @@ typedef struct {
     int center_bin;
     float magnitude;
     float noise;
+    int foreign;                /* outside our range: masked, not emitted */
 } active_burst_t;
 
 typedef struct {
@@ -51,6 +67,30 @@ typedef struct {
     float relative_magnitude;
 } peak_t;
 
+/* ---- Shared sample arena ----
+ *
+ * The IQ ring buffer is divided into fixed-size slabs, each counting the
+ * burst views that still reference it. When the writer enters a slab on a
+ * new lap it waits for downstream workers to release that slab before
+ * overwriting it. The arena is freed once the detector and every
+ * outstanding view have dropped their reference.
+ *
+ * Live capture bounds that wait (see ringbuf_reclaim()): the bursts still
+ * queued on the slab are shed, and then the detector moves to a copy of
+ * the ring, leaving the old arena to the views that hold it. */
+
+#define ARENA_SLAB_SAMPLES 65536
+#define ARENA_WAIT_NS   25000000LL  /* per step of a live reclaim */
+
+struct _burst_arena {
+    void *samples;
+    int sample_bytes;       /* 2 (int8 IQ), 4 (int16 IQ) or 8 (float) */
+    size_t size;            /* capacity in samples, multiple of slab size */
+    int n_slabs;
+    atomic_int *slab_refs;  /* outstanding views per slab */
+    atomic_int refs;        /* detector + outstanding views */
+};
+
 /* ---- Burst detector state ---- */
 
 struct _burst_detector {
@@ -58,27 +98,52 @@ struct _burst_detector {
     double center_frequency;
     int sample_rate;
     int fft_size;
+    int hop_size;           /* samples between frame starts */
+    int overlap;            /* fft_size / hop_size */
     int burst_pre_len;
     int burst_post_len;
+    int trim_bursts;
+    int trim_margin;
     int burst_width;        /* in FFT bins */
     int max_bursts;
     int max_burst_len;
     float threshold;        /* pre-computed: pow(10, dB/10) / history_size / ENBW */
     int history_size;
+    int dc_bin;             /* FFT bin of the SDR LO, may be out of range */
+    int peak_bin_min;       /* bins where new bursts may start */
+    int peak_bin_max;
+    int scan_bin_min;       /* bins searched for peaks */
+    int scan_bin_max;
+    struct band_plan *band_plan;    /* NULL = every channel */
+    uint8_t *band_mask;     /* [fft_size] 1 where the plan's bursts peak */
+    uint64_t burst_id_step;
 
     /* FFT */
-    fftwf_plan fft_plan;
+    fftwf_plan fft_plan;        /* shared with other sub-band detectors */
     float complex *fft_in;
     float complex *fft_out;
 
+    /* Overlapping frames: OVERLAP_BATCH of them per FFTW call */
+    fftwf_plan batch_plan;
+    float complex *batch_in;    /* [OVERLAP_BATCH * fft_size] windowed */
+    float complex *batch_out;
+
     /* Window */
     float *window;
 
     /* Noise floor estimation */
-    float *baseline_history;    /* [history_size * fft_size] circular */
+    int noise_floor;            /* noise_floor_t */
+    float *baseline_history;    /* [history_rows * fft_size] circular, NULL for EMA;
+                                 * block means for BLOCK */
     float *baseline_sum;        /* [fft_size] running sum */
+    float *baseline_block;      /* [fft_size] block being summed (BLOCK) */
+    int history_rows;           /* history_size / block_frames */
+    int block_frames;           /* frames per history row */
+    int block_fill;             /* frames in baseline_block */
+    int history_count;          /* frames in the estimate until primed */
     int history_index;
     int history_primed;
+    int frame_phase;            /* frame count mod overlap; 0 feeds history */
 
     /* Per-FFT frame */
     float *magnitude_shifted;   /* [fft_size] DC-shifted mag^2 */
@@ -99,49 +164,60 @@ struct _burst_detector {
     int num_gone_bursts;
     int gone_bursts_cap;
 
-    peak_t *peaks;
+    peak_t *peaks;              /* max-heap by relative magnitude */
     int num_peaks;
+    int *peak_bins;             /* [fft_size] simd_peak_bins output */
 
     uint64_t burst_id;
     uint64_t n_tagged_bursts;
     uint64_t sample_count;
     uint64_t index;             /* current absolute sample position */
     int squelch_count;
+    uint64_t bytes_out;         /* IQ bytes in emitted views */
+    uint64_t bytes_untrimmed;   /* the same with fixed windows */
 
     /* Diagnostic tracking */
     float peak_signal_db;       /* maximum signal seen (for diagnostic mode) */
 
-    /* IQ ringbuffer for burst sample extraction */
-    float complex *ringbuf;
+    /* IQ ringbuffer for burst sample extraction (aliases arena->samples),
+     * created on the first feed call in that call's sample format */
+    burst_arena_t *arena;
+    void *ringbuf;
+    int ring_format;            /* SAMPLE_FMT_* */
+    int sample_bytes;           /* bytes per ring sample */
     size_t ringbuf_size;        /* total capacity in samples */
     size_t ringbuf_write;       /* write position (mod ringbuf_size) */
     uint64_t ringbuf_start;     /* absolute sample index of oldest sample */
 
-    /* int8 -> float complex conversion buffer */
+    /* Conversion of fed samples to the ring format (either direction) */
     float complex *convert_buf;
     size_t convert_buf_size;
 
     /* Timestamp */
     uint64_t start_time_ns;     /* nanosecond timestamp at sample 0 */
 
+    mpmc_ring_t *input;         /* burst_detector_thread() takes blocks here */
+
 #ifdef USE_GPU
-    /* GPU acceleration */
+    /* GPU acceleration: batches alternate between the context's slots */
     gpu_burst_fft_t *gpu;
     int gpu_batch_size;         /* max frames per GPU dispatch */
-    int gpu_batch_count;        /* frames accumulated so far */
-    float *gpu_batch_input;     /* batch_size * fft_size * 2 floats (complex) */
-    float *gpu_batch_output;    /* batch_size * fft_size floats (magnitude) */
+    const float **gpu_frames[GPU_BURST_FFT_SLOTS];  /* frames of each batch */
+    float complex *gpu_wrap[GPU_BURST_FFT_SLOTS];   /* frames split by the ring end */
 #endif
 };
 
 /* ---- Externs for threading integration ---- */
 
-extern Blocking_Queue samples_queue;
-extern Blocking_Queue burst_queue;
+extern mpmc_ring_t samples_queue;
+extern burst_sched_t *burst_queue;
 extern volatile sig_atomic_t running;
 extern int verbose;
 extern atomic_ulong stat_n_detected;
 extern atomic_ulong stat_n_dropped;
+extern atomic_ulong stat_ring_moves;
+extern atomic_ulong stat_burst_bytes;
+extern atomic_ulong stat_burst_bytes_untrimmed;
 
 /* ---- Helper: dynamic array push ---- */
 
@@ -159,14 +235,136 @@ static void remove_burst(active_burst_t *arr, int *count, int idx) {
     (*count)--;
 }
 
-/* ---- Peak comparison for qsort (descending magnitude) ---- */
+/* ---- Arena reference counting ---- */
+
+static burst_arena_t *arena_create(size_t min_size, int sample_bytes) {
+    burst_arena_t *a = calloc(1, sizeof(*a));
+    a->n_slabs = (int)((min_size + ARENA_SLAB_SAMPLES - 1) / ARENA_SLAB_SAMPLES);
+    if (a->n_slabs < 4)
+        a->n_slabs = 4;
+    a->size = (size_t)a->n_slabs * ARENA_SLAB_SAMPLES;
+    a->sample_bytes = sample_bytes;
+    a->samples = placement_alloc_large((size_t)sample_bytes * a->size);
+    a->slab_refs = calloc(a->n_slabs, sizeof(atomic_int));
+    for (int i = 0; i < a->n_slabs; i++)
+        atomic_init(&a->slab_refs[i], 0);
+    atomic_init(&a->refs, 1);
+    return a;
+}
 
-static int peak_cmp_desc(const void *a, const void *b) {
-    float ma = ((const peak_t *)a)->relative_magnitude;
-    float mb = ((const peak_t *)b)->relative_magnitude;
-    if (ma > mb) return -1;
-    if (ma < mb) return 1;
-    return 0;
+static void arena_unref(burst_arena_t *a) {
+    if (a && atomic_fetch_sub(&a->refs, 1) == 1) {
+        placement_free_large(a->samples, (size_t)a->sample_bytes * a->size);
+        free(a->slab_refs);
+        free(a);
+    }
+}
+
+/* Add delta to the view count of every slab covered by [offset, offset+len) */
+static void arena_hold(burst_arena_t *a, size_t offset, size_t len, int delta) {
+    int first = (int)(offset / ARENA_SLAB_SAMPLES);
+    int last = (int)(((offset + len - 1) % a->size) / ARENA_SLAB_SAMPLES);
+    for (int k = first; ; k = (k + 1) % a->n_slabs) {
+        atomic_fetch_add(&a->slab_refs[k], delta);
+        if (k == last)
+            break;
+    }
+}
+
+void burst_data_release(burst_data_t *burst) {
+    if (!burst)
+        return;
+    if (burst->arena) {
+        arena_hold(burst->arena, burst->offset, burst->num_samples, -1);
+        arena_unref(burst->arena);
+    }
+    free(burst);
+}
+
+/* Bytes per sample of a SAMPLE_FMT_* */
+static int sample_format_bytes(int format) {
+    switch (format) {
+    case SAMPLE_FMT_FLOAT: return sizeof(float complex);
+    case SAMPLE_FMT_INT16: return 2 * sizeof(int16_t);
+    default:               return 2 * sizeof(int8_t);
+    }
+}
+
+/* n samples in format to float complex */
+static void convert_cf(int format, const void *in, float complex *out,
+                       size_t n) {
+    switch (format) {
+    case SAMPLE_FMT_FLOAT:
+        memcpy(out, in, n * sizeof(float complex));
+        break;
+    case SAMPLE_FMT_INT16:
+        simd_convert_i16_cf(in, out, n);
+        break;
+    default:
+        simd_convert_i8_cf(in, out, n);
+        break;
+    }
+}
+
+const float complex *burst_data_cf(const burst_data_t *burst, size_t pos,
+                                   size_t len, float complex *buf) {
+    size_t first = pos < burst->split ? burst->split - pos : 0;
+    if (first > len)
+        first = len;
+
+    /* Float samples within one segment are used in place */
+    if (burst->format == SAMPLE_FMT_FLOAT) {
+        if (first == len)
+            return (const float complex *)burst->samples + pos;
+        if (first == 0)
+            return (const float complex *)burst->wrap + (pos - burst->split);
+    }
+
+    size_t bytes = sample_format_bytes(burst->format);
+    if (first > 0)
+        convert_cf(burst->format, (const uint8_t *)burst->samples + pos * bytes,
+                   buf, first);
+    if (len > first)
+        convert_cf(burst->format,
+                   (const uint8_t *)burst->wrap + (pos + first - burst->split) * bytes,
+                   buf + first, len - first);
+    return buf;
+}
+
+/* ---- Peak heap (strongest first) ----
+ *
+ * create_new_bursts() takes peaks strongest first but usually stops long
+ * before the last one (squelch), so the peaks are heapified in O(n) and
+ * popped as needed instead of sorted.
+ */
+
+static void peak_sift_down(peak_t *h, int n, int i) {
+    peak_t p = h[i];
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= n)
+            break;
+        if (c + 1 < n && h[c + 1].relative_magnitude > h[c].relative_magnitude)
+            c++;
+        if (h[c].relative_magnitude <= p.relative_magnitude)
+            break;
+        h[i] = h[c];
+        i = c;
+    }
+    h[i] = p;
+}
+
+static void peak_heapify(peak_t *h, int n) {
+    for (int i = n / 2 - 1; i >= 0; i--)
+        peak_sift_down(h, n, i);
+}
+
+/* Remove the strongest of n peaks; slot n - 1 is free afterwards */
+static peak_t peak_pop(peak_t *h, int n) {
+    peak_t top = h[0];
+    h[0] = h[n - 1];
+    peak_sift_down(h, n - 1, 0);
+    return top;
 }
 
 /* ---- Create burst detector ---- */
@@ -185,15 +383,30 @@ burst_detector_t *burst_detector_create(burst_config_t *config) {
         d->fft_size = 1 << n;
     }
 
-    /* Burst pre/post lengths */
+    /* Frame hop: a power-of-two fraction of the FFT size */
+    d->overlap = config->overlap > 1 ? config->overlap : 1;
+    while (d->overlap > 1 && (d->fft_size % d->overlap ||
+                              (d->overlap & (d->overlap - 1))))
+        d->overlap--;
+    d->hop_size = d->fft_size / d->overlap;
+
+    /* Burst pre/post lengths. A burst's onset lies within one hop before
+     * the first frame that crosses the threshold (a frame starting after
+     * the onset would have been full of it), so backing up fft_size + hop
+     * leaves at least one fft_size of noise in front of it. */
     d->burst_pre_len = config->burst_pre_len > 0
         ? config->burst_pre_len
-        : 2 * d->fft_size;
+        : d->fft_size + d->hop_size;
 
     d->burst_post_len = config->burst_post_len > 0
         ? config->burst_post_len
         : (int)(config->sample_rate * 16e-3);
 
+    d->trim_bursts = config->trim_bursts;
+    d->trim_margin = config->trim_margin > 0
+        ? config->trim_margin
+        : config->sample_rate / 1000;
+
     /* Burst width in FFT bins */
     int burst_width_hz = config->burst_width > 0
         ? config->burst_width
@@ -216,6 +429,17 @@ burst_detector_t *burst_detector_create(burst_config_t *config) {
         ? config->history_size
         : IR_DEFAULT_HISTORY_SIZE;
 
+    /* Blocks must tile the history exactly for the sum to stay a sum of
+     * history_size frames */
+    d->noise_floor = config->noise_floor;
+    d->block_frames = 1;
+    if (d->noise_floor == NOISE_FLOOR_BLOCK) {
+        d->block_frames = NOISE_FLOOR_BLOCK_FRAMES;
+        while (d->history_size % d->block_frames)
+            d->block_frames /= 2;
+    }
+    d->history_rows = d->history_size / d->block_frames;
+
     /* Threshold: convert from dB to linear, normalized */
     float threshold_db = config->threshold > 0
         ? config->threshold
@@ -225,11 +449,69 @@ burst_detector_t *burst_detector_create(burst_config_t *config) {
     float window_enbw = 1.72f;
     d->threshold = powf(10.0f, threshold_db / 10.0f) / d->history_size / window_enbw;
 
+    /* DC notch sits at the SDR LO, which is only the FFT center when
+     * this detector sees the whole capture */
+    float bin_hz = (float)config->sample_rate / d->fft_size;
+    d->dc_bin = d->fft_size / 2;
+    if (config->lo_frequency != 0)
+        d->dc_bin += (int)lround((config->lo_frequency - config->center_frequency)
+                                 / bin_hz);
+
+    /* Peak acceptance range: stay half a burst away from the band edges,
+     * and inside the owned region when running as a sub-band */
+    d->peak_bin_min = d->burst_width / 2;
+    d->peak_bin_max = d->fft_size - d->burst_width / 2;
+    if (config->peak_low != 0 || config->peak_high != 0) {
+        int lo = d->fft_size / 2 + (int)lround(config->peak_low / bin_hz);
+        int hi = d->fft_size / 2 + (int)lround(config->peak_high / bin_hz);
+        if (lo > d->peak_bin_min) d->peak_bin_min = lo;
+        if (hi < d->peak_bin_max) d->peak_bin_max = hi;
+    }
+
+    /* Band plan: bins where a planned channel's burst may peak. Peaks
+     * outside still shadow their weaker neighbours, like a neighbouring
+     * sub-band's, so the search reaches half a burst past the mask. */
+    d->scan_bin_min = 0;
+    d->scan_bin_max = d->fft_size;
+    if (config->band_plan) {
+        d->band_plan = config->band_plan;
+        d->band_mask = calloc(d->fft_size, 1);
+        if (!d->band_mask)
+            err(1, "Cannot allocate the band plan mask");
+        int first = d->fft_size, last = -1;
+        for (int i = 0; i < d->fft_size; i++) {
+            double freq = d->center_frequency + (i - d->fft_size / 2)
+                          * (double)d->sample_rate / d->fft_size;
+            if (band_plan_covers(d->band_plan, freq)) {
+                d->band_mask[i] = 1;
+                if (first > i) first = i;
+                last = i;
+            }
+        }
+        if (last < 0) {
+            /* Nothing planned here: a sub-band may miss the plan, but
+             * options.c refuses a plan that misses a whole capture */
+            d->scan_bin_min = d->scan_bin_max = 0;
+            if (verbose)
+                fprintf(stderr, "burst_detect: no planned channel within "
+                        "%.0f Hz +- %.0f Hz\n", d->center_frequency,
+                        d->sample_rate / 2.0);
+        } else {
+            d->scan_bin_min = first - d->burst_width / 2;
+            d->scan_bin_max = last + 1 + d->burst_width / 2;
+        }
+    }
+
+    /* Detectors sharing an ID space interleave their IDs */
+    int id_count = config->id_count > 0 ? config->id_count : 1;
+    d->burst_id = (uint64_t)config->id_index * 10;
+    d->burst_id_step = (uint64_t)id_count * 10;
+
     if (verbose) {
-        fprintf(stderr, "burst_detect: fft_size=%d, threshold=%.1f dB (linear=%e), "
+        fprintf(stderr, "burst_detect: fft_size=%d, hop=%d, threshold=%.1f dB (linear=%e), "
                 "history=%d, burst_width=%d bins, max_bursts=%d, "
                 "pre_len=%d, post_len=%d, max_len=%d\n",
-                d->fft_size, threshold_db, d->threshold,
+                d->fft_size, d->hop_size, threshold_db, d->threshold,
                 d->history_size, d->burst_width, d->max_bursts,
                 d->burst_pre_len, d->burst_post_len, d->max_burst_len);
     }
@@ -237,11 +519,14 @@ burst_detector_t *burst_detector_create(burst_config_t *config) {
     /* Allocate FFT */
     d->fft_in = fftwf_alloc_complex(d->fft_size);
     d->fft_out = fftwf_alloc_complex(d->fft_size);
-    fftw_lock();
-    d->fft_plan = fftwf_plan_dft_1d(d->fft_size,
-                                     d->fft_in, d->fft_out,
-                                     FFTW_FORWARD, FFTW_MEASURE);
-    fftw_unlock();
+    d->fft_plan = fftw_plan_shared_dft_1d(d->fft_size, FFTW_FORWARD);
+    if (d->overlap > 1) {
+        size_t batch_len = (size_t)OVERLAP_BATCH * d->fft_size;
+        d->batch_in = fftwf_alloc_complex(batch_len);
+        d->batch_out = fftwf_alloc_complex(batch_len);
+        d->batch_plan = fftw_plan_shared_many(d->fft_size, OVERLAP_BATCH,
+                                              FFTW_FORWARD);
+    }
 
     /* Window: Blackman scaled by 1/0.42 for accurate SNR */
     d->window = aligned_alloc_32(sizeof(float) * d->fft_size);
@@ -250,7 +535,11 @@ burst_detector_t *burst_detector_create(burst_config_t *config) {
         d->window[i] /= 0.42f;
 
     /* Noise floor arrays (aligned for SIMD) */
-    d->baseline_history = aligned_calloc_32(d->fft_size * d->history_size, sizeof(float));
+    if (d->noise_floor != NOISE_FLOOR_EMA)
+        d->baseline_history = placement_alloc_large(
+            (size_t)d->fft_size * d->history_rows * sizeof(float));
+    if (d->noise_floor == NOISE_FLOOR_BLOCK)
+        d->baseline_block = aligned_calloc_32(d->fft_size, sizeof(float));
     d->baseline_sum = aligned_calloc_32(d->fft_size, sizeof(float));
     d->magnitude_shifted = aligned_calloc_32(d->fft_size, sizeof(float));
     d->relative_magnitude = aligned_calloc_32(d->fft_size, sizeof(float));
@@ -264,10 +553,12 @@ burst_detector_t *burst_detector_create(burst_config_t *config) {
 
     d->history_index = 0;
     d->history_primed = 0;
+    d->frame_phase = 0;
 
     /* Peak array */
     d->peaks = malloc(sizeof(peak_t) * d->fft_size);
     d->num_peaks = 0;
+    d->peak_bins = malloc(sizeof(int) * d->fft_size);
 
     /* Burst arrays (start small, grow as needed) */
     d->bursts_cap = 64;
@@ -282,37 +573,45 @@ burst_detector_t *burst_detector_create(burst_config_t *config) {
     d->gone_bursts = malloc(sizeof(active_burst_t) * d->gone_bursts_cap);
     d->num_gone_bursts = 0;
 
-    d->burst_id = 0;
     d->n_tagged_bursts = 0;
     d->sample_count = 0;
     d->index = 0;
     d->squelch_count = 0;
 
-    /* IQ ringbuffer: hold enough for max burst + pre + post + headroom */
+    /* IQ ringbuffer: hold enough for max burst + pre + post + headroom.
+     * Allocated by ringbuf_init() once the sample format is known. */
     d->ringbuf_size = d->max_burst_len + d->burst_pre_len + d->burst_post_len
                       + d->fft_size * 4;
     /* Minimum 2 seconds */
     if (d->ringbuf_size < (size_t)(2 * d->sample_rate))
         d->ringbuf_size = 2 * d->sample_rate;
-    d->ringbuf = malloc(sizeof(float complex) * d->ringbuf_size);
     d->ringbuf_write = 0;
     d->ringbuf_start = 0;
 
     /* Timestamp: set when first samples arrive */
     d->start_time_ns = 0;
+    d->input = &samples_queue;
 
 #ifdef USE_GPU
     /* GPU acceleration */
     d->gpu = NULL;
     if (config->use_gpu) {
-        d->gpu_batch_size = 16;
+        /* GPU_BATCH_MS of frames per dispatch: long enough to amortize
+         * the launch, short enough to keep two in flight per read */
+        d->gpu_batch_size = (int)((int64_t)d->sample_rate * GPU_BATCH_MS
+                                  / 1000 / d->fft_size);
+        if (d->gpu_batch_size < GPU_BATCH_MIN)
+            d->gpu_batch_size = GPU_BATCH_MIN;
+        if (d->gpu_batch_size > GPU_BATCH_MAX)
+            d->gpu_batch_size = GPU_BATCH_MAX;
         d->gpu = gpu_burst_fft_create(d->fft_size, d->gpu_batch_size, d->window);
         if (d->gpu) {
-            d->gpu_batch_count = 0;
-            d->gpu_batch_input = malloc(sizeof(float) * 2 * d->fft_size
-                                        * d->gpu_batch_size);
-            d->gpu_batch_output = malloc(sizeof(float) * d->fft_size
-                                         * d->gpu_batch_size);
+            for (int i = 0; i < GPU_BURST_FFT_SLOTS; i++) {
+                d->gpu_frames[i] = malloc(sizeof(float *) * d->gpu_batch_size);
+                /* Up to overlap frames of a batch can cross the ring end */
+                d->gpu_wrap[i] = aligned_alloc_32(sizeof(float complex)
+                                                  * d->overlap * d->fft_size);
+            }
         } else {
             fprintf(stderr, "burst_detect: GPU init failed, falling back to CPU\n");
         }
@@ -327,39 +626,75 @@ void burst_detector_destroy(burst_detector_t *d) {
 #ifdef USE_GPU
     if (d->gpu) {
         gpu_burst_fft_destroy(d->gpu);
-        free(d->gpu_batch_input);
-        free(d->gpu_batch_output);
+        for (int i = 0; i < GPU_BURST_FFT_SLOTS; i++) {
+            free(d->gpu_frames[i]);
+            free(d->gpu_wrap[i]);
+        }
     }
 #endif
-    fftwf_destroy_plan(d->fft_plan);
+    fftw_plan_release(d->fft_plan);
     fftwf_free(d->fft_in);
     fftwf_free(d->fft_out);
+    fftw_plan_release(d->batch_plan);
+    fftwf_free(d->batch_in);
+    fftwf_free(d->batch_out);
     free(d->window);
-    free(d->baseline_history);
+    placement_free_large(d->baseline_history,
+                         (size_t)d->fft_size * d->history_rows * sizeof(float));
+    free(d->baseline_block);
     free(d->baseline_sum);
     free(d->magnitude_shifted);
     free(d->relative_magnitude);
     free(d->burst_mask);
+    free(d->band_mask);
     free(d->ones);
     free(d->peaks);
+    free(d->peak_bins);
     free(d->bursts);
     free(d->new_bursts);
     free(d->gone_bursts);
-    free(d->ringbuf);
+    arena_unref(d->arena);
     free(d->convert_buf);
-    fprintf(stderr, "burst_detect: tagged %lu bursts total\n",
-            (unsigned long)d->n_tagged_bursts);
+    if (d->trim_bursts && d->n_tagged_bursts > 0)
+        fprintf(stderr, "burst_detect: tagged %lu bursts total, "
+                "%.0f kB per burst (%.0f kB untrimmed)\n",
+                (unsigned long)d->n_tagged_bursts,
+                d->bytes_out / 1e3 / d->n_tagged_bursts,
+                d->bytes_untrimmed / 1e3 / d->n_tagged_bursts);
+    else
+        fprintf(stderr, "burst_detect: tagged %lu bursts total\n",
+                (unsigned long)d->n_tagged_bursts);
     free(d);
 }
 
+void burst_detector_set_start_time(burst_detector_t *d, uint64_t ns) {
+    d->start_time_ns = ns;
+}
+
+void burst_detector_set_input(burst_detector_t *d, void *queue) {
+    d->input = (mpmc_ring_t *)queue;
+}
+
 int burst_detector_active_count(burst_detector_t *d) {
-    return d->num_bursts;
+    int n = 0;
+    for (int i = 0; i < d->num_bursts; i++)
+        n += !d->bursts[i].foreign;
+    return n;
 }
 
 uint64_t burst_detector_total_count(burst_detector_t *d) {
     return d->n_tagged_bursts;
 }
 
+size_t burst_detector_noise_floor_bytes(burst_detector_t *d) {
+    size_t rows = d->history_rows + 1;      /* + baseline_sum */
+    if (d->noise_floor == NOISE_FLOOR_EMA)
+        rows = 1;
+    else if (d->noise_floor == NOISE_FLOOR_BLOCK)
+        rows++;
+    return rows * d->fft_size * sizeof(float);
+}
+
 float burst_detector_noise_floor(burst_detector_t *d) {
     if (!d || !d->baseline_sum || d->history_size == 0)
         return 0.0f;
@@ -387,38 +722,152 @@ float burst_detector_peak_signal(burst_detector_t *d) {
 
 /* ---- Internal: ringbuffer operations ---- */
 
-static void ringbuf_write(burst_detector_t *d, const float complex *samples, size_t n) {
-    for (size_t i = 0; i < n; i++) {
-        d->ringbuf[d->ringbuf_write] = samples[i];
-        d->ringbuf_write = (d->ringbuf_write + 1) % d->ringbuf_size;
+/* Create the ring for samples in format */
+static void ringbuf_init(burst_detector_t *d, int format) {
+    d->ring_format = format;
+    d->sample_bytes = sample_format_bytes(format);
+    d->arena = arena_create(d->ringbuf_size, d->sample_bytes);
+    d->ringbuf = d->arena->samples;
+    d->ringbuf_size = d->arena->size;
+
+#ifdef USE_GPU
+    /* The GPU takes float frames: from an integer ring, every frame of
+     * a batch is converted, not just those crossing the end */
+    if (d->gpu && format != SAMPLE_FMT_FLOAT) {
+        for (int i = 0; i < GPU_BURST_FFT_SLOTS; i++) {
+            free(d->gpu_wrap[i]);
+            d->gpu_wrap[i] = aligned_alloc_32(sizeof(float complex)
+                                              * d->gpu_batch_size * d->fft_size);
+        }
     }
-    /* Update the oldest available sample index */
-    uint64_t total_written = d->sample_count;
-    if (total_written > d->ringbuf_size)
-        d->ringbuf_start = total_written - d->ringbuf_size;
+#endif
 }
 
-static float complex *ringbuf_extract(burst_detector_t *d, uint64_t start,
-                                       uint64_t stop, size_t *out_len) {
+static int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+typedef struct {
+    const burst_arena_t *arena;
+    int slab;
+} slab_ref_t;
+
+/* burst_sched_shed_if() match: the burst's view covers the slab */
+static int view_on_slab(const burst_data_t *b, void *arg) {
+    const slab_ref_t *s = arg;
+    if (b->arena != s->arena)
+        return 0;
+    int first = (int)(b->offset / ARENA_SLAB_SAMPLES);
+    int last = (int)(((b->offset + b->num_samples - 1) % s->arena->size)
+                     / ARENA_SLAB_SAMPLES);
+    if (first <= last)
+        return s->slab >= first && s->slab <= last;
+    return s->slab >= first || s->slab <= last;
+}
+
+/* Write on into a copy of the ring; the old arena stays with its views */
+static void ringbuf_move(burst_detector_t *d) {
+    burst_arena_t *old = d->arena;
+    burst_arena_t *a = arena_create(old->size, old->sample_bytes);
+    memcpy(a->samples, old->samples, (size_t)old->sample_bytes * old->size);
+    d->arena = a;
+    d->ringbuf = a->samples;
+    arena_unref(old);
+    atomic_fetch_add(&stat_ring_moves, 1);
+    if (verbose)
+        fprintf(stderr, "burst_detect: downmix stalled, moved the sample "
+                "ring away from its views\n");
+}
+
+/* Wait until no view holds slab k. A waiting burst queue (file input)
+ * waits as long as the downmix pool needs, but live capture must not let
+ * a backlogged or stuck pool stall the sample queue behind the detector:
+ * after ARENA_WAIT_NS the queued bursts on the slab are shed, and after
+ * as long again the ring moves away from the views still holding it. */
+static void ringbuf_reclaim(burst_detector_t *d, int k) {
+    if (atomic_load(&d->arena->slab_refs[k]) == 0)
+        return;
+
+    int bounded = burst_queue && burst_sched_sheds(burst_queue);
+    int64_t t0 = monotonic_ns();
+    int shed = 0;
+    while (atomic_load(&d->arena->slab_refs[k]) > 0) {
+        if (bounded && monotonic_ns() - t0 >= (shed + 1) * ARENA_WAIT_NS) {
+            if (shed) {
+                ringbuf_move(d);
+                return;
+            }
+            slab_ref_t s = { d->arena, k };
+            burst_sched_shed_if(burst_queue, view_on_slab, &s);
+            shed = 1;
+            continue;
+        }
+        usleep(100);
+    }
+}
+
+static void ringbuf_write(burst_detector_t *d, const void *samples, size_t n) {
+    const uint8_t *in = samples;
+    uint64_t total_written = d->sample_count + n;
+
+    while (n > 0) {
+        size_t pos = d->ringbuf_write;
+        size_t in_slab = pos % ARENA_SLAB_SAMPLES;
+
+        /* Entering a slab on a new lap: any view still on it is from the
+         * previous lap */
+        if (in_slab == 0)
+            ringbuf_reclaim(d, (int)(pos / ARENA_SLAB_SAMPLES));
+
+        size_t chunk = ARENA_SLAB_SAMPLES - in_slab;
+        if (chunk > n)
+            chunk = n;
+        memcpy((uint8_t *)d->ringbuf + pos * d->sample_bytes, in,
+               chunk * d->sample_bytes);
+        in += chunk * d->sample_bytes;
+        n -= chunk;
+        d->ringbuf_write = (pos + chunk) % d->ringbuf_size;
+    }
+
+    /* Update the oldest available sample index. The slab being written is
+     * unprotected, so it never counts as available history. */
+    uint64_t avail = d->ringbuf_size - ARENA_SLAB_SAMPLES;
+    if (total_written > avail)
+        d->ringbuf_start = total_written - avail;
+}
+
+/* Fill bd with a view of [start, stop) and take a reference on it */
+static size_t ringbuf_view(burst_detector_t *d, uint64_t start, uint64_t stop,
+                           burst_data_t *bd) {
     /* Clamp to available range */
     if (start < d->ringbuf_start)
         start = d->ringbuf_start;
-    if (stop <= start) {
-        *out_len = 0;
-        return NULL;
-    }
+    if (stop > d->sample_count)
+        stop = d->sample_count;
+    if (stop <= start)
+        return 0;
 
     size_t len = (size_t)(stop - start);
-    float complex *buf = malloc(sizeof(float complex) * len);
-    size_t rb_pos = (size_t)(start % d->ringbuf_size);
-
-    for (size_t i = 0; i < len; i++) {
-        buf[i] = d->ringbuf[rb_pos];
-        rb_pos = (rb_pos + 1) % d->ringbuf_size;
+    size_t offset = (size_t)(start % d->ringbuf_size);
+
+    bd->arena = d->arena;
+    bd->offset = offset;
+    bd->num_samples = len;
+    bd->format = d->ring_format;
+    bd->samples = (const uint8_t *)d->ringbuf + offset * d->sample_bytes;
+    if (offset + len <= d->ringbuf_size) {
+        bd->split = len;
+        bd->wrap = NULL;
+    } else {
+        bd->split = d->ringbuf_size - offset;
+        bd->wrap = d->ringbuf;
     }
 
-    *out_len = len;
-    return buf;
+    arena_hold(d->arena, offset, len, 1);
+    atomic_fetch_add(&d->arena->refs, 1);
+    return len;
 }
 
 /* ---- Internal: update noise floor (pre) ---- */
@@ -435,20 +884,96 @@ static int update_filters_pre(burst_detector_t *d) {
 
 /* ---- Internal: update noise floor (post) ---- */
 
+/* Replace the oldest history row with this frame */
+static void baseline_full(burst_detector_t *d) {
+    float *hist = d->baseline_history + (size_t)d->history_index * d->fft_size;
+
+    /* Baseline update: sum = sum - old_hist + new_mag (SIMD-accelerated) */
+    simd_baseline_update(d->baseline_sum, hist,
+                         d->magnitude_shifted, d->fft_size);
+    memcpy(hist, d->magnitude_shifted, sizeof(float) * d->fft_size);
+
+    d->history_index++;
+    if (d->history_index == d->history_rows) {
+        d->history_primed = 1;
+        d->history_index = 0;
+    }
+}
+
+/* History rows hold block means. Each frame is added to the sum while a
+ * block_frames-th of the oldest row leaves it, so the sum always covers
+ * history_size frames and moves every frame, like the full history; the
+ * oldest row is gone when the new block is complete and takes its place */
+static void baseline_block(burst_detector_t *d) {
+    float *hist = d->baseline_history + (size_t)d->history_index * d->fft_size;
+    float *block = d->baseline_block;
+
+    simd_baseline_update(d->baseline_sum, hist, d->magnitude_shifted,
+                         d->fft_size);
+    for (int i = 0; i < d->fft_size; i++)
+        block[i] += d->magnitude_shifted[i];
+    if (++d->block_fill < d->block_frames)
+        return;
+
+    float scale = 1.0f / d->block_frames;
+    for (int i = 0; i < d->fft_size; i++) {
+        hist[i] = block[i] * scale;
+        block[i] = 0.0f;
+    }
+    d->block_fill = 0;
+    d->history_index++;
+    if (d->history_index == d->history_rows) {
+        d->history_primed = 1;
+        d->history_index = 0;
+    }
+}
+
+/* Exponential average scaled to a sum of history_size frames: the plain
+ * mean while priming, then each frame weighted 1/history_size */
+static void baseline_ema(burst_detector_t *d) {
+    if (d->history_count < d->history_size)
+        d->history_count++;
+    float w = 1.0f / d->history_count;
+    float scale = (float)d->history_size * w;
+    for (int i = 0; i < d->fft_size; i++)
+        d->baseline_sum[i] += d->magnitude_shifted[i] * scale -
+                              d->baseline_sum[i] * w;
+    if (d->history_count == d->history_size)
+        d->history_primed = 1;
+}
+
+/* Start the estimate over */
+static void baseline_reset(burst_detector_t *d) {
+    d->history_index = 0;
+    d->history_primed = 0;
+    d->history_count = 0;
+    d->block_fill = 0;
+    if (d->baseline_history)
+        memset(d->baseline_history, 0,
+               sizeof(float) * d->fft_size * d->history_rows);
+    if (d->baseline_block)
+        memset(d->baseline_block, 0, sizeof(float) * d->fft_size);
+    memset(d->baseline_sum, 0, sizeof(float) * d->fft_size);
+}
+
 static void update_filters_post(burst_detector_t *d, int force) {
+    /* With overlapping frames only every overlap-th one goes into the
+     * history, so it spans the same time and holds disjoint frames */
+    if (d->frame_phase != 0 && !force)
+        return;
+
     /* Only update average when no bursts active (or forced) */
     if (d->num_bursts == 0 || force) {
-        float *hist = d->baseline_history + d->history_index * d->fft_size;
-
-        /* Baseline update: sum = sum - old_hist + new_mag (SIMD-accelerated) */
-        simd_baseline_update(d->baseline_sum, hist,
-                             d->magnitude_shifted, d->fft_size);
-        memcpy(hist, d->magnitude_shifted, sizeof(float) * d->fft_size);
-
-        d->history_index++;
-        if (d->history_index == d->history_size) {
-            d->history_primed = 1;
-            d->history_index = 0;
+        switch (d->noise_floor) {
+        case NOISE_FLOOR_EMA:
+            baseline_ema(d);
+            break;
+        case NOISE_FLOOR_BLOCK:
+            baseline_block(d);
+            break;
+        default:
+            baseline_full(d);
+            break;
         }
     }
 }
@@ -504,8 +1029,9 @@ static void delete_gone_bursts(burst_detector_t *d) {
 
         if ((b->last_active + d->burst_post_len) <= d->index || long_burst) {
             b->stop = d->index;
-            push_burst(&d->gone_bursts, &d->num_gone_bursts,
-                       &d->gone_bursts_cap, b);
+            if (!b->foreign)
+                push_burst(&d->gone_bursts, &d->num_gone_bursts,
+                           &d->gone_bursts_cap, b);
             remove_burst(d->bursts, &d->num_bursts, i);
             /* don't increment i, next element slid into position */
         } else {
@@ -517,56 +1043,103 @@ static void delete_gone_bursts(burst_detector_t *d) {
         update_filters_post(d, 1);
 }
 
-/* ---- Internal: remove peaks near existing bursts ---- */
-
-static void remove_peaks_around_bursts(burst_detector_t *d) {
-    for (int i = 0; i < d->fft_size; i++)
-        d->relative_magnitude[i] *= d->burst_mask[i];
-}
-
-/* ---- Internal: extract peaks above threshold ---- */
+/* ---- Internal: extract peaks above threshold ----
+ *
+ * Bins under an active burst (burst_mask 0) are skipped in the same
+ * compare, so peaks near existing bursts never enter the list.
+ */
 
 static void extract_peaks(burst_detector_t *d) {
-    d->num_peaks = 0;
-    int half_bw = d->burst_width / 2;
-
     /* DC notch: skip bins near center frequency to reject LO leakage / ADC
      * offset spikes.  Width of 3 bins (~3.7 kHz at 10 MHz / 8192-pt FFT)
      * covers typical SDR DC spikes without losing any real Iridium signal
      * (channels are 41.667 kHz wide and never centered at DC). */
-    int dc_bin = d->fft_size / 2;
+    int dc_bin = d->dc_bin;
     int dc_notch_half = 3;  /* ±3 bins around DC */
 
-    for (int bin = half_bw; bin < d->fft_size - half_bw; bin++) {
-        if (bin >= dc_bin - dc_notch_half && bin <= dc_bin + dc_notch_half)
-            continue;
-        if (d->relative_magnitude[bin] > d->threshold) {
-            d->peaks[d->num_peaks].bin = bin;
-            d->peaks[d->num_peaks].relative_magnitude = d->relative_magnitude[bin];
-            d->num_peaks++;
-        }
+    int half_bw = d->burst_width / 2;
+    int lo = half_bw, hi = d->fft_size - half_bw;
+    if (lo < d->scan_bin_min) lo = d->scan_bin_min;
+    if (hi > d->scan_bin_max) hi = d->scan_bin_max;
+    int notch_lo = dc_bin - dc_notch_half;
+    int notch_hi = dc_bin + dc_notch_half + 1;
+
+    /* The scan range with the notch cut out of it */
+    int n = 0;
+    int below = notch_lo < hi ? notch_lo : hi;
+    if (below > lo)
+        n += simd_peak_bins(d->relative_magnitude, d->burst_mask, d->threshold,
+                            lo, below, d->peak_bins + n);
+    int above = notch_hi > lo ? notch_hi : lo;
+    if (hi > above)
+        n += simd_peak_bins(d->relative_magnitude, d->burst_mask, d->threshold,
+                            above, hi, d->peak_bins + n);
+
+    for (int i = 0; i < n; i++) {
+        d->peaks[i].bin = d->peak_bins[i];
+        d->peaks[i].relative_magnitude = d->relative_magnitude[d->peak_bins[i]];
     }
-
-    /* Sort by magnitude descending */
-    qsort(d->peaks, d->num_peaks, sizeof(peak_t), peak_cmp_desc);
+    d->num_peaks = n;
+    peak_heapify(d->peaks, n);
 }
 
 /* ---- Internal: create new bursts from peaks ---- */
 
+/* A foreign burst is followed like one of our own but never emitted. Its
+ * mask keeps it from starting a burst here later, when noise and the data
+ * symbols move its strongest bin across the boundary into our range. */
+static void track_foreign(burst_detector_t *d, const peak_t *p) {
+    active_burst_t b;
+    memset(&b, 0, sizeof(b));
+    b.center_bin = p->bin;
+    b.start = d->index - d->burst_pre_len;
+    b.last_active = b.start;
+    b.foreign = 1;
+    push_burst(&d->bursts, &d->num_bursts, &d->bursts_cap, &b);
+    mask_burst(d, &b);
+}
+
 static void create_new_bursts(burst_detector_t *d) {
     d->num_new_bursts = 0;
+    int n_foreign = 0;
 
-    for (int i = 0; i < d->num_peaks; i++) {
-        peak_t *p = &d->peaks[i];
+    /* Once there are more bursts than max_bursts the squelch below drops
+     * every new one, so the remaining peaks need not be popped */
+    for (int left = d->num_peaks; left > 0; left--) {
+        if (d->max_bursts > 0 && d->num_bursts > d->max_bursts)
+            break;
+        peak_t peak = peak_pop(d->peaks, left);
+        peak_t *p = &peak;
 
         if (d->burst_mask[p->bin] == 0.0f)
             continue;
 
+        /* A stronger peak outside our own range is a neighbouring
+         * sub-band's burst (or one the band plan leaves out); it shadows
+         * the weaker bins of the same burst that spill over the boundary
+         * into our range. Foreign peaks are kept in the slots the heap
+         * has given up at the back of d->peaks, foreign[j] at
+         * d->peaks[num_peaks - 1 - j]. */
+        peak_t *foreign = d->peaks + d->num_peaks - 1;
+        int shadowed = 0;
+        for (int j = 0; j < n_foreign && !shadowed; j++)
+            shadowed = abs(p->bin - foreign[-j].bin) <= d->burst_width / 2;
+        if (p->bin < d->peak_bin_min || p->bin >= d->peak_bin_max ||
+            (d->band_mask && !d->band_mask[p->bin])) {
+            if (!shadowed) {
+                foreign[-n_foreign++] = *p;
+                track_foreign(d, p);
+            }
+            continue;
+        }
+        if (shadowed)
+            continue;
+
         active_burst_t b;
         memset(&b, 0, sizeof(b));
         b.id = d->burst_id;
         b.center_bin = p->bin;
-        d->burst_id += 10;  /* leave room for sub-IDs downstream */
+        d->burst_id += d->burst_id_step;  /* leave room for sub-IDs downstream */
 
         /* Normalize relative magnitude for SNR estimate */
         b.magnitude = 10.0f * log10f(p->relative_magnitude * d->history_size * 1.72f);
@@ -575,7 +1148,7 @@ static void create_new_bursts(burst_detector_t *d) {
         if (b.magnitude > d->peak_signal_db)
             d->peak_signal_db = b.magnitude;
 
-        /* Burst might have started one FFT frame earlier */
+        /* Burst might have started up to one hop earlier */
         b.start = d->index - d->burst_pre_len;
         b.last_active = b.start;
 
@@ -603,8 +1176,9 @@ static void create_new_bursts(burst_detector_t *d) {
         while (i < d->num_bursts) {
             if (d->bursts[i].start != d->index - (uint64_t)d->burst_pre_len) {
                 d->bursts[i].stop = d->index;
-                push_burst(&d->gone_bursts, &d->num_gone_bursts,
-                           &d->gone_bursts_cap, &d->bursts[i]);
+                if (!d->bursts[i].foreign)
+                    push_burst(&d->gone_bursts, &d->num_gone_bursts,
+                               &d->gone_bursts_cap, &d->bursts[i]);
                 remove_burst(d->bursts, &d->num_bursts, i);
             } else {
                 i++;
@@ -618,11 +1192,7 @@ static void create_new_bursts(burst_detector_t *d) {
         if (d->squelch_count >= 10) {
             if (verbose)
                 fprintf(stderr, "burst_detect: resetting noise estimate\n");
-            d->history_index = 0;
-            d->history_primed = 0;
-            memset(d->baseline_history, 0,
-                   sizeof(float) * d->fft_size * d->history_size);
-            memset(d->baseline_sum, 0, sizeof(float) * d->fft_size);
+            baseline_reset(d);
             d->squelch_count = 0;
         }
     } else {
@@ -631,93 +1201,223 @@ static void create_new_bursts(burst_detector_t *d) {
     }
 }
 
-#ifdef USE_GPU
-/* ---- Internal: run CPU state machine on pre-computed magnitude ---- */
-
-static void process_magnitude_frame(burst_detector_t *d, const float *magnitude) {
-    /* Copy GPU-computed magnitudes into detector state */
-    memcpy(d->magnitude_shifted, magnitude, sizeof(float) * d->fft_size);
+/* ---- Internal: process one FFT frame ---- */
 
-    /* Update filters and detect (same logic as CPU path) */
+/* Run the state machine on d->magnitude_shifted, then step to the next
+ * frame */
+static void detect_frame(burst_detector_t *d) {
     if (update_filters_pre(d)) {
         update_bursts(d);
-        remove_peaks_around_bursts(d);
         extract_peaks(d);
         delete_gone_bursts(d);
         update_burst_mask(d);
         create_new_bursts(d);
     }
     update_filters_post(d, 0);
-}
-
-/* ---- Internal: flush GPU batch and process results ---- */
 
-static void gpu_flush_batch(burst_detector_t *d) {
-    if (d->gpu_batch_count == 0)
-        return;
-
-    if (gpu_burst_fft_process(d->gpu, d->gpu_batch_input,
-                               d->gpu_batch_output,
-                               d->gpu_batch_count) != 0) {
-        fprintf(stderr, "burst_detect: GPU processing failed\n");
-        d->gpu_batch_count = 0;
-        return;
-    }
+    d->index += d->hop_size;
+    if (++d->frame_phase == d->overlap)
+        d->frame_phase = 0;
+}
 
-    /* Process each frame's magnitude through CPU state machine */
-    for (int i = 0; i < d->gpu_batch_count; i++) {
-        process_magnitude_frame(d, d->gpu_batch_output + i * d->fft_size);
-        d->index += d->fft_size;
+/* Window n ring samples in format into out */
+static void window_segment(int format, const void *in, const float *window,
+                           float complex *out, int n) {
+    switch (format) {
+    case SAMPLE_FMT_FLOAT:
+        simd_window_cf(in, window, out, n);
+        break;
+    case SAMPLE_FMT_INT16:
+        simd_window_i16_cf(in, window, out, n);
+        break;
+    default:
+        simd_window_i8_cf(in, window, out, n);
+        break;
     }
+}
 
-    d->gpu_batch_count = 0;
+/* Window the frame at read_idx into out, straight from the ring (both
+ * pieces of a frame that crosses its end). Integer rings are converted
+ * in the same pass, so their frames never exist unwindowed as floats. */
+static void window_frame(burst_detector_t *d, uint64_t read_idx,
+                         float complex *out) {
+    const uint8_t *ring = d->ringbuf;
+    size_t rb_pos = (size_t)(read_idx % d->ringbuf_size);
+    int first = d->ringbuf_size - rb_pos < (size_t)d->fft_size
+              ? (int)(d->ringbuf_size - rb_pos) : d->fft_size;
+    window_segment(d->ring_format, ring + rb_pos * d->sample_bytes, d->window,
+                   out, first);
+    if (first < d->fft_size)
+        window_segment(d->ring_format, ring, d->window + first, out + first,
+                       d->fft_size - first);
 }
-#endif
 
-/* ---- Internal: process one FFT frame ---- */
+/* The frame at d->index */
+static void process_fft_frame(burst_detector_t *d) {
+    uint64_t t0 = pstats_now();
 
-static void process_fft_frame(burst_detector_t *d, const float complex *samples) {
     /* Apply window and copy to FFT input (SIMD-accelerated) */
-    simd_window_cf(samples, d->window, d->fft_in, d->fft_size);
+    window_frame(d, d->index, d->fft_in);
 
     /* Execute FFT */
-    fftwf_execute(d->fft_plan);
+    fftwf_execute_dft(d->fft_plan, d->fft_in, d->fft_out);
 
     /* DC shift (fftshift) + magnitude-squared (SIMD-accelerated) */
     simd_fftshift_mag(d->fft_out, d->magnitude_shifted, d->fft_size);
 
     /* Update filters and detect */
-    if (update_filters_pre(d)) {
-        update_bursts(d);
-        remove_peaks_around_bursts(d);
-        extract_peaks(d);
-        delete_gone_bursts(d);
-        update_burst_mask(d);
-        create_new_bursts(d);
+    detect_frame(d);
+    pstats_stage(STAGE_FFT, t0);
+}
+
+/* ---- Internal: overlapping frames in batches ---- */
+
+/* OVERLAP_BATCH frames from d->index, one hop apart: window them all,
+ * transform them with a single FFTW call, then run the state machine on
+ * each in order. Overlap multiplies the frame count; batching keeps the
+ * per-transform overhead of the extra frames down. */
+static void process_overlap_batch(burst_detector_t *d) {
+    uint64_t t0 = pstats_now();
+    int n = d->fft_size;
+
+    for (int i = 0; i < OVERLAP_BATCH; i++)
+        window_frame(d, d->index + (uint64_t)i * d->hop_size,
+                     d->batch_in + (size_t)i * n);
+    fftwf_execute_dft(d->batch_plan, d->batch_in, d->batch_out);
+
+    for (int i = 0; i < OVERLAP_BATCH; i++) {
+        simd_fftshift_mag(d->batch_out + (size_t)i * n,
+                          d->magnitude_shifted, n);
+        detect_frame(d);
     }
-    update_filters_post(d, 0);
+    pstats_stage(STAGE_FFT, t0);
+}
+
+/* Complete frames in the ring from d->index on */
+static int frames_available(burst_detector_t *d) {
+    if (d->index + d->fft_size > d->sample_count)
+        return 0;
+    return (int)((d->sample_count - d->index - d->fft_size) / d->hop_size) + 1;
 }
 
+#ifdef USE_GPU
+/* ---- Internal: run CPU state machine on pre-computed magnitude ---- */
+
+static void process_magnitude_frame(burst_detector_t *d, const float *magnitude) {
+    /* Copy GPU-computed magnitudes into detector state */
+    memcpy(d->magnitude_shifted, magnitude, sizeof(float) * d->fft_size);
+
+    /* Update filters and detect (same logic as CPU path) */
+    detect_frame(d);
+}
+
+/* ---- Internal: GPU batches ---- */
+
+/* Frame at read_idx in the ring as float complex: in place, or copied
+ * (converted, for an integer ring) to buf */
+static const float complex *ringbuf_frame(burst_detector_t *d,
+                                          uint64_t read_idx,
+                                          float complex *buf) {
+    const uint8_t *ring = d->ringbuf;
+    size_t rb_pos = (size_t)(read_idx % d->ringbuf_size);
+    size_t first = d->ringbuf_size - rb_pos;
+    if (first > (size_t)d->fft_size)
+        first = d->fft_size;
+
+    if (d->ring_format == SAMPLE_FMT_FLOAT && first == (size_t)d->fft_size)
+        return (const float complex *)ring + rb_pos;
+    convert_cf(d->ring_format, ring + rb_pos * d->sample_bytes, buf, first);
+    convert_cf(d->ring_format, ring, buf + first, d->fft_size - first);
+    return buf;
+}
+
+/* Point slot's frame list at the next n frames from read_idx and start
+ * the batch; the frames are read in place from the ring, except those
+ * crossing its end, which get copied to the slot's wrap buffers */
+static int gpu_submit_batch(burst_detector_t *d, int slot, uint64_t read_idx,
+                            int n) {
+    int n_wrapped = 0;
+    for (int i = 0; i < n; i++) {
+        float complex *buf = d->gpu_wrap[slot] + (size_t)n_wrapped * d->fft_size;
+        const float complex *frame = ringbuf_frame(d,
+            read_idx + (uint64_t)i * d->hop_size, buf);
+        if (frame == buf)
+            n_wrapped++;
+        d->gpu_frames[slot][i] = (const float *)frame;
+    }
+    return gpu_burst_fft_submit(d->gpu, slot, d->gpu_frames[slot], n);
+}
+
+/* Finish slot's batch of n frames at d->index and run the state machine
+ * on it; frames the GPU failed on go through the CPU path instead */
+static void gpu_finish_batch(burst_detector_t *d, int slot, int n,
+                             int submitted) {
+    const float *mag = submitted ? gpu_burst_fft_wait(d->gpu, slot) : NULL;
+    if (!mag)
+        fprintf(stderr, "burst_detect: GPU processing failed, batch on CPU\n");
+
+    for (int i = 0; i < n; i++) {
+        if (mag)
+            process_magnitude_frame(d, mag + (size_t)i * d->fft_size);
+        else
+            process_fft_frame(d);
+    }
+}
+#endif
+
 /* ---- Internal: emit completed bursts ---- */
 
+/* Where the burst's frame must have ended, plus the margin: no later than
+ * the longest Iridium frame after the latest possible onset, the end of
+ * the first frame over the threshold. last_active is no help here: the
+ * center bin tracks the unmodulated preamble, and often drops under the
+ * threshold as soon as the payload spreads the burst over its width. */
+static uint64_t trim_stop(burst_detector_t *d, const active_burst_t *ab) {
+    double freq = d->center_frequency + (ab->center_bin - d->fft_size / 2)
+                  * (double)d->sample_rate / d->fft_size;
+    int max_symbols = IR_PREAMBLE_LENGTH_LONG + IR_UW_LENGTH +
+        (freq > IR_SIMPLEX_FREQUENCY_MIN ? IR_MAX_FRAME_LENGTH_SIMPLEX
+                                         : IR_MAX_FRAME_LENGTH_NORMAL);
+    uint64_t frame_len = (uint64_t)max_symbols * d->sample_rate
+                         / IR_SYMBOLS_PER_SECOND;
+
+    return ab->start + d->burst_pre_len + d->fft_size + frame_len
+           + d->trim_margin;
+}
+
 static void emit_gone_bursts(burst_detector_t *d, burst_callback_t cb, void *user) {
     for (int i = 0; i < d->num_gone_bursts; i++) {
         active_burst_t *ab = &d->gone_bursts[i];
 
-        /* Extract IQ samples from ringbuffer */
+        /* Reference IQ samples in the ringbuffer (no copy) */
         uint64_t extract_start = ab->start;
         uint64_t extract_stop = ab->stop + d->burst_pre_len;
-        size_t num_samples;
-        float complex *samples = ringbuf_extract(d, extract_start, extract_stop,
-                                                  &num_samples);
+        uint64_t fixed_stop = extract_stop;
+        if (d->trim_bursts) {
+            uint64_t bound = trim_stop(d, ab);
+            if (bound < extract_stop)
+                extract_stop = bound;
+        }
+        burst_data_t *bd = malloc(sizeof(*bd));
 
-        if (num_samples == 0) {
-            free(samples);
+        if (ringbuf_view(d, extract_start, extract_stop, bd) == 0) {
+            free(bd);
             continue;
         }
 
+        /* What the fixed window would have held, clamped the same way */
+        if (fixed_stop > d->sample_count)
+            fixed_stop = d->sample_count;
+        uint64_t fixed_start = extract_start > d->ringbuf_start
+                               ? extract_start : d->ringbuf_start;
+        uint64_t out = bd->num_samples * d->sample_bytes;
+        uint64_t untrimmed = (fixed_stop - fixed_start) * d->sample_bytes;
+        d->bytes_out += out;
+        d->bytes_untrimmed += untrimmed;
+        atomic_fetch_add(&stat_burst_bytes, out);
+        atomic_fetch_add(&stat_burst_bytes_untrimmed, untrimmed);
+
         /* Build burst data */
-        burst_data_t *bd = malloc(sizeof(*bd));
         bd->info = (burst_info_t){
             .id = ab->id,
             .start = ab->start,
@@ -731,8 +1431,11 @@ static void emit_gone_bursts(burst_detector_t *d, burst_callback_t cb, void *use
         bd->sample_rate = d->sample_rate;
         bd->fft_size = d->fft_size;
         bd->start_time_ns = d->start_time_ns;
-        bd->num_samples = num_samples;
-        bd->samples = samples;
+
+        if (d->band_plan)
+            band_plan_count(d->band_plan, d->center_frequency
+                + (ab->center_bin - d->fft_size / 2)
+                * (double)d->sample_rate / d->fft_size);
 
         cb(bd, user);
         d->n_tagged_bursts++;
@@ -741,99 +1444,55 @@ static void emit_gone_bursts(burst_detector_t *d, burst_callback_t cb, void *use
     d->num_gone_bursts = 0;
 }
 
-/* ---- Public: feed samples ---- */
-
-void burst_detector_feed(burst_detector_t *d, const int8_t *iq,
-                         size_t num_samples, burst_callback_t cb, void *user) {
-    /* Convert int8 IQ pairs to float complex and store in ringbuffer.
-     * Process FFT frames as they become available.
-     *
-     * We maintain a residual buffer for partial FFT frames.
-     */
-
-    /* Track timestamp */
-    if (d->start_time_ns == 0) {
-        struct timespec ts;
-        clock_gettime(CLOCK_REALTIME, &ts);
-        d->start_time_ns = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
-    }
-
-    /* Convert int8 to float complex and write to ringbuffer */
+/* ---- Internal: run every complete FFT frame in the ringbuffer ---- */
 
-    if (num_samples > d->convert_buf_size) {
-        free(d->convert_buf);
-        d->convert_buf_size = num_samples;
-        d->convert_buf = aligned_alloc_32(sizeof(float complex) * d->convert_buf_size);
-    }
-
-    /* int8 IQ -> float complex (SIMD-accelerated) */
-    simd_convert_i8_cf(iq, d->convert_buf, num_samples);
-
-    /* Write to ringbuffer */
-    ringbuf_write(d, d->convert_buf, num_samples);
-    d->sample_count += num_samples;
-
-    /* Process complete FFT frames */
+static void process_pending(burst_detector_t *d, burst_callback_t cb, void *user) {
 #ifdef USE_GPU
     if (d->gpu) {
-        /* GPU path: accumulate frames into batch, flush when full.
-         * Use a local read cursor (read_idx) to track accumulation
-         * position. d->index is only advanced by gpu_flush_batch
-         * when the state machine actually processes each frame. */
+        /* GPU path: batch k is submitted before the state machine runs
+         * on batch k-1, so the transfer and FFT of one overlap the CPU
+         * work on the other. A read is split into at least two batches
+         * when it holds fewer than two full ones. d->index only
+         * advances as frames go through the state machine. */
         uint64_t read_idx = d->index;
-
-        while (read_idx + d->fft_size <= d->sample_count) {
-            size_t rb_pos = (size_t)(read_idx % d->ringbuf_size);
-            float *dst = d->gpu_batch_input
-                         + d->gpu_batch_count * d->fft_size * 2;
-
-            /* Copy complex samples as interleaved float pairs */
-            if (rb_pos + d->fft_size <= d->ringbuf_size) {
-                memcpy(dst, &d->ringbuf[rb_pos],
-                       sizeof(float complex) * d->fft_size);
-            } else {
-                size_t first = d->ringbuf_size - rb_pos;
-                memcpy(dst, &d->ringbuf[rb_pos],
-                       first * sizeof(float complex));
-                memcpy(dst + first * 2, d->ringbuf,
-                       (d->fft_size - first) * sizeof(float complex));
-            }
-
-            read_idx += d->fft_size;
-            d->gpu_batch_count++;
-
-            if (d->gpu_batch_count >= d->gpu_batch_size) {
-                gpu_flush_batch(d);
-                /* gpu_flush_batch advances d->index by batch_count * fft_size */
-
+        int avail = frames_available(d);
+        int per_batch = (avail + 1) / 2;
+        if (per_batch > d->gpu_batch_size)
+            per_batch = d->gpu_batch_size;
+
+        int slot = 0;
+        int prev_n = 0, prev_ok = 0;
+        while (avail > 0) {
+            int n = avail < per_batch ? avail : per_batch;
+            int ok = gpu_submit_batch(d, slot, read_idx, n) == 0;
+            read_idx += (uint64_t)n * d->hop_size;
+            avail -= n;
+
+            if (prev_n > 0) {
+                gpu_finish_batch(d, slot ^ 1, prev_n, prev_ok);
                 if (d->num_gone_bursts > 0)
                     emit_gone_bursts(d, cb, user);
             }
+            prev_n = n;
+            prev_ok = ok;
+            slot ^= 1;
         }
 
-        /* Flush remaining partial batch */
-        if (d->gpu_batch_count > 0)
-            gpu_flush_batch(d);
+        /* Nothing stays in flight past this call: the next read may
+         * overwrite the ring */
+        if (prev_n > 0)
+            gpu_finish_batch(d, slot ^ 1, prev_n, prev_ok);
     } else
 #endif
     {
-        /* CPU path: process one frame at a time */
-        while (d->index + d->fft_size <= d->sample_count) {
-            size_t rb_pos = (size_t)(d->index % d->ringbuf_size);
-
-            if (rb_pos + d->fft_size <= d->ringbuf_size) {
-                process_fft_frame(d, &d->ringbuf[rb_pos]);
-            } else {
-                float complex tmp[d->fft_size];
-                size_t first = d->ringbuf_size - rb_pos;
-                memcpy(tmp, &d->ringbuf[rb_pos], first * sizeof(float complex));
-                memcpy(tmp + first, d->ringbuf,
-                       (d->fft_size - first) * sizeof(float complex));
-                process_fft_frame(d, tmp);
-            }
-
-            d->index += d->fft_size;
+        /* CPU path: overlapping frames in batches while a full batch
+         * is available, the rest one frame at a time */
+        if (d->overlap > 1) {
+            while (frames_available(d) >= OVERLAP_BATCH)
+                process_overlap_batch(d);
         }
+        while (d->index + d->fft_size <= d->sample_count)
+            process_fft_frame(d);
     }
 
     /* Emit any completed bursts */
@@ -841,118 +1500,158 @@ void burst_detector_feed(burst_detector_t *d, const int8_t *iq,
         emit_gone_bursts(d, cb, user);
 }
 
-/* ---- Public: feed float32 samples (no int8 quantization) ---- */
-
-void burst_detector_feed_cf32(burst_detector_t *d, const float *iq,
-                              size_t num_samples, burst_callback_t cb, void *user) {
-    /* Track timestamp */
+static void track_start_time(burst_detector_t *d) {
     if (d->start_time_ns == 0) {
         struct timespec ts;
         clock_gettime(CLOCK_REALTIME, &ts);
         d->start_time_ns = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
     }
+}
+
+/* ---- Public: feed samples ---- */
 
-    /* Convert interleaved float pairs to float complex and write to ringbuffer */
+static float complex *convert_buf(burst_detector_t *d, size_t num_samples) {
     if (num_samples > d->convert_buf_size) {
         free(d->convert_buf);
         d->convert_buf_size = num_samples;
-        d->convert_buf = malloc(sizeof(float complex) * d->convert_buf_size);
+        d->convert_buf = aligned_alloc_32(sizeof(float complex) * d->convert_buf_size);
     }
+    return d->convert_buf;
+}
 
-    for (size_t i = 0; i < num_samples; i++)
-        d->convert_buf[i] = iq[2 * i] + iq[2 * i + 1] * I;
-
-    /* Write to ringbuffer */
-    ringbuf_write(d, d->convert_buf, num_samples);
-    d->sample_count += num_samples;
-
-    /* Process complete FFT frames (identical to int8 path) */
-#ifdef USE_GPU
-    if (d->gpu) {
-        uint64_t read_idx = d->index;
+/* Quantize n float samples to an integer format, the inverse of its
+ * conversion kernel. out may be in: the narrower output never overtakes
+ * the input. */
+static void quantize(int format, const float complex *in, void *out, size_t n) {
+    const float *f = (const float *)in;
+    float scale = format == SAMPLE_FMT_INT16 ? 32768.0f : 128.0f;
+    for (size_t i = 0; i < 2 * n; i++) {
+        float v = roundf(f[i] * scale);
+        v = v > scale - 1.0f ? scale - 1.0f : v < -scale ? -scale : v;
+        if (format == SAMPLE_FMT_INT16)
+            ((int16_t *)out)[i] = (int16_t)v;
+        else
+            ((int8_t *)out)[i] = (int8_t)v;
+    }
+}
 
-        while (read_idx + d->fft_size <= d->sample_count) {
-            size_t rb_pos = (size_t)(read_idx % d->ringbuf_size);
-            float *dst = d->gpu_batch_input
-                         + d->gpu_batch_count * d->fft_size * 2;
+/* Write samples to the ring, which is created in their format on the first
+ * call; samples in another format are converted to the ring's */
+static void feed_samples(burst_detector_t *d, int format, const void *samples,
+                         size_t num_samples, burst_callback_t cb, void *user) {
+    track_start_time(d);
+    if (!d->arena)
+        ringbuf_init(d, format);
 
-            if (rb_pos + d->fft_size <= d->ringbuf_size) {
-                memcpy(dst, &d->ringbuf[rb_pos],
-                       sizeof(float complex) * d->fft_size);
-            } else {
-                size_t first = d->ringbuf_size - rb_pos;
-                memcpy(dst, &d->ringbuf[rb_pos],
-                       first * sizeof(float complex));
-                memcpy(dst + first * 2, d->ringbuf,
-                       (d->fft_size - first) * sizeof(float complex));
-            }
+    if (format == d->ring_format) {
+        ringbuf_write(d, samples, num_samples);
+    } else {
+        float complex *buf = convert_buf(d, num_samples);
+        const float complex *cf = samples;
+        if (format != SAMPLE_FMT_FLOAT) {
+            convert_cf(format, samples, buf, num_samples);
+            cf = buf;
+        }
+        if (d->ring_format != SAMPLE_FMT_FLOAT)
+            quantize(d->ring_format, cf, buf, num_samples);
+        ringbuf_write(d, buf, num_samples);
+    }
+    d->sample_count += num_samples;
 
-            read_idx += d->fft_size;
-            d->gpu_batch_count++;
+    process_pending(d, cb, user);
+}
 
-            if (d->gpu_batch_count >= d->gpu_batch_size) {
-                gpu_flush_batch(d);
-                if (d->num_gone_bursts > 0)
-                    emit_gone_bursts(d, cb, user);
-            }
-        }
+void burst_detector_feed(burst_detector_t *d, const int8_t *iq,
+                         size_t num_samples, burst_callback_t cb, void *user) {
+    feed_samples(d, SAMPLE_FMT_INT8, iq, num_samples, cb, user);
+}
 
-        if (d->gpu_batch_count > 0)
-            gpu_flush_batch(d);
-    } else
-#endif
-    {
-        while (d->index + d->fft_size <= d->sample_count) {
-            size_t rb_pos = (size_t)(d->index % d->ringbuf_size);
+void burst_detector_feed_ci16(burst_detector_t *d, const int16_t *iq,
+                              size_t num_samples, burst_callback_t cb, void *user) {
+    feed_samples(d, SAMPLE_FMT_INT16, iq, num_samples, cb, user);
+}
 
-            if (rb_pos + d->fft_size <= d->ringbuf_size) {
-                process_fft_frame(d, &d->ringbuf[rb_pos]);
-            } else {
-                float complex tmp[d->fft_size];
-                size_t first = d->ringbuf_size - rb_pos;
-                memcpy(tmp, &d->ringbuf[rb_pos], first * sizeof(float complex));
-                memcpy(tmp + first, d->ringbuf,
-                       (d->fft_size - first) * sizeof(float complex));
-                process_fft_frame(d, tmp);
-            }
+/* ---- Public: feed float32 samples (no int8 quantization) ---- */
 
-            d->index += d->fft_size;
-        }
-    }
+void burst_detector_feed_cf32(burst_detector_t *d, const float *iq,
+                              size_t num_samples, burst_callback_t cb, void *user) {
+    /* Interleaved float pairs have the layout of float complex */
+    burst_detector_feed_cf(d, (const float complex *)iq, num_samples, cb, user);
+}
 
-    if (d->num_gone_bursts > 0)
-        emit_gone_bursts(d, cb, user);
+void burst_detector_feed_cf(burst_detector_t *d, const float complex *samples,
+                            size_t num_samples, burst_callback_t cb, void *user) {
+    feed_samples(d, SAMPLE_FMT_FLOAT, samples, num_samples, cb, user);
 }
 
 /* ---- Thread integration: callback that pushes to burst_queue ---- */
 
-static void burst_to_queue(burst_data_t *burst, void *user) {
-    Blocking_Queue *queue = (Blocking_Queue *)user;
-    int ret = blocking_queue_put(queue, burst);
+void burst_to_queue(burst_data_t *burst, void *user) {
+    burst_sched_t *queue = (burst_sched_t *)user;
+    burst = burst_extract(burst);
+    uint64_t t0 = pstats_now();
+    int ret = burst_sched_put(queue, burst);
+    pstats_put_wait(PQ_BURST, t0);
+    pstats_queue_depth(PQ_BURST, burst_sched_depth(queue));
     if (ret != 0) {
-        free(burst->samples);
-        free(burst);
+        burst_data_release(burst);
         atomic_fetch_add(&stat_n_dropped, 1);
     }
 }
 
+/* Bursts one block ended, queued together after the block is fed */
+typedef struct {
+    burst_sched_t *queue;
+    unsigned n;
+    burst_data_t *bursts[BURST_SCHED_BATCH_MAX];
+} burst_batch_t;
+
+static void batch_flush(burst_batch_t *bb) {
+    uint64_t t0 = pstats_now();
+    unsigned put = burst_sched_put_batch(bb->queue, bb->bursts, bb->n);
+    pstats_put_wait(PQ_BURST, t0);
+    pstats_queue_depth(PQ_BURST, burst_sched_depth(bb->queue));
+    for (unsigned i = put; i < bb->n; i++) {
+        burst_data_release(bb->bursts[i]);
+        atomic_fetch_add(&stat_n_dropped, 1);
+    }
+    bb->n = 0;
+}
+
+static void burst_to_batch(burst_data_t *burst, void *user) {
+    burst_batch_t *bb = (burst_batch_t *)user;
+    bb->bursts[bb->n++] = burst_extract(burst);
+    if (bb->n == BURST_SCHED_BATCH_MAX)
+        batch_flush(bb);
+}
+
 /* ---- Thread function ---- */
 
 void *burst_detector_thread(void *arg) {
     burst_detector_t *det = (burst_detector_t *)arg;
+    burst_batch_t batch = { .queue = burst_queue, .n = 0 };
 
     while (1) {
         sample_buf_t *samples;
-        if (blocking_queue_take(&samples_queue, &samples) != 0)
+        uint64_t t0 = pstats_now();
+        if (mpmc_ring_take(det->input, &samples) != 0)
             break;
+        pstats_take_wait(PQ_SAMPLES, t0);
 
         if (samples->format == SAMPLE_FMT_FLOAT)
-            burst_detector_feed_cf32(det, (const float *)samples->samples,
-                                     samples->num, burst_to_queue, &burst_queue);
+            burst_detector_feed_cf32(det, (const float *)sample_buf_data(samples),
+                                     samples->num, burst_to_batch, &batch);
+        else if (samples->format == SAMPLE_FMT_INT16)
+            burst_detector_feed_ci16(det, (const int16_t *)sample_buf_data(samples),
+                                     samples->num, burst_to_batch, &batch);
         else
-            burst_detector_feed(det, samples->samples, samples->num,
-                               burst_to_queue, &burst_queue);
-        free(samples);
+            burst_detector_feed(det, sample_buf_data(samples), samples->num,
+                               burst_to_batch, &batch);
+        sample_buf_free(samples);
+
+        /* Every burst that ended in this block, in one queue operation */
+        if (batch.n > 0)
+            batch_flush(&batch);
     }
 
     burst_detector_destroy(det);
@@ -21,9 +21,12 @@
 #include <stdint.h>
 #include <fftw3.h>
 
+#include "sdr.h"
+
 /* Forward declaration */
 struct _burst_detector;
 typedef struct _burst_detector burst_detector_t;
+struct band_plan;
 
 /* Detected burst metadata */
 typedef struct {
@@ -36,30 +39,68 @@ typedef struct {
     float noise;            /* noise floor in dBFS/Hz */
 } burst_info_t;
 
-/* Complete burst with IQ data, ready for downstream processing */
+/* Shared, reference-counted IQ sample arena owned by the detector ring
+ * buffer. Bursts hold views into it instead of private copies. */
+typedef struct _burst_arena burst_arena_t;
+
+/* Complete burst with IQ data, ready for downstream processing.
+ *
+ * The samples are a read-only view into the detector's ring buffer. A view
+ * that crosses the end of the ring is split in two: samples[0..split) at the
+ * tail of the arena followed by wrap[0..num_samples - split) at its head.
+ * The ring keeps samples as they were fed (format), so read them through
+ * burst_data_cf() unless format is SAMPLE_FMT_FLOAT. The ring region stays
+ * valid until burst_data_release() is called. */
 typedef struct {
     burst_info_t info;
     double center_frequency;  /* absolute center freq of capture */
     int sample_rate;          /* capture sample rate */
     int fft_size;             /* FFT size used for detection */
     uint64_t start_time_ns;   /* wall clock ns at sample 0 (base offset) */
-    size_t num_samples;       /* number of complex float samples */
-    float complex *samples;   /* IQ data covering burst lifetime */
+    size_t num_samples;       /* number of complex samples */
+    int format;               /* SAMPLE_FMT_* of samples and wrap */
+    const void *samples;      /* first contiguous segment */
+    size_t split;             /* samples in first segment */
+    const void *wrap;         /* continuation at arena start, or NULL */
+    burst_arena_t *arena;     /* arena holding the view */
+    size_t offset;            /* view start within arena */
 } burst_data_t;
 
+/* Noise floor estimators: the running sum of the last history_size
+ * burst-free frames per bin, or an approximation of it */
+typedef enum {
+    NOISE_FLOOR_FULL = 0,   /* every frame kept: fft_size * history_size floats */
+    NOISE_FLOOR_BLOCK,      /* 16-frame means kept, sum still updated per frame */
+    NOISE_FLOOR_EMA,        /* exponential average with the same time constant */
+} noise_floor_t;
+
 /* Configuration */
 typedef struct {
     double center_frequency;
     int sample_rate;
     int fft_size;           /* 0 = auto-calculate (~1ms window) */
-    int burst_pre_len;      /* 0 = auto (2 * fft_size) */
+    int overlap;            /* frames per fft_size: 2 = 50%, 4 = 75%,
+                             * 0 or 1 = none (hop = fft_size) */
+    int burst_pre_len;      /* 0 = auto (fft_size + hop) */
     int burst_post_len;     /* 0 = auto (sample_rate * 16ms) */
+    int trim_bursts;        /* 1 = end views where the frame must have ended */
+    int trim_margin;        /* samples kept past that bound, 0 = auto (1 ms) */
     int burst_width;        /* Hz, default 40000 */
     int max_bursts;         /* 0 = auto (80% of channels) */
     int max_burst_len;      /* 0 = auto (sample_rate * 90ms) */
     float threshold;        /* dB, default 16.0 */
     int history_size;       /* default 512 */
+    int noise_floor;        /* noise_floor_t */
     int use_gpu;            /* 1 = use OpenCL GPU FFT, 0 = FFTW CPU */
+    struct band_plan *band_plan;    /* channels to detect, NULL = all */
+
+    /* Sub-band operation (see channelizer.h). All zero for a detector
+     * that sees the whole capture. */
+    double lo_frequency;    /* SDR LO for the DC notch, 0 = center_frequency */
+    double peak_low;        /* Hz from center: only start bursts whose peak */
+    double peak_high;       /* lies in [low, high); both 0 = whole band */
+    int id_index;           /* this detector's slot in a shared ID space */
+    int id_count;           /* detectors sharing the ID space, 0 = 1 */
 } burst_config_t;
 
 /* Create a burst detector with the given configuration.
@@ -67,23 +108,53 @@ typedef struct {
 burst_detector_t *burst_detector_create(burst_config_t *config);
 
 /* Callback for completed bursts. Receives ownership of burst_data_t
- * (caller must free both burst->samples and burst itself). */
+ * (release it with burst_data_release() when done). */
 typedef void (*burst_callback_t)(burst_data_t *burst, void *user);
 
-/* Feed int8 IQ samples to the detector. */
+/* Drop the burst's reference on its ring region and free the burst. */
+void burst_data_release(burst_data_t *burst);
+
+/* Samples [pos, pos + len) of the burst as float complex: a pointer into
+ * the view when it holds them as such in one segment, otherwise converted
+ * or copied into buf (len samples). */
+const float complex *burst_data_cf(const burst_data_t *burst, size_t pos,
+                                   size_t len, float complex *buf);
+
+/* Feed int8 IQ samples to the detector. The ring keeps samples in the
+ * format of the first feed call (int8: 2 bytes a sample, int16: 4, float:
+ * 8); later calls in another format are converted to it. */
 void burst_detector_feed(burst_detector_t *det, const int8_t *iq,
                          size_t num_samples, burst_callback_t cb, void *user);
 
+/* Feed int16 interleaved IQ samples (full scale +-32768). */
+void burst_detector_feed_ci16(burst_detector_t *det, const int16_t *iq,
+                              size_t num_samples, burst_callback_t cb, void *user);
+
 /* Feed float32 interleaved IQ samples (no int8 quantization loss). */
 void burst_detector_feed_cf32(burst_detector_t *det, const float *iq,
                               size_t num_samples, burst_callback_t cb, void *user);
 
+/* Feed complex float samples */
+void burst_detector_feed_cf(burst_detector_t *det, const float complex *samples,
+                            size_t num_samples, burst_callback_t cb, void *user);
+
+/* Override the wall clock time of sample 0 (normally taken at the first
+ * feed call). Must be called before samples are fed. */
+void burst_detector_set_start_time(burst_detector_t *det, uint64_t ns);
+
+/* mpmc_ring_t burst_detector_thread() takes sample blocks from
+ * (default: samples_queue); one per receiver when several capture at once */
+void burst_detector_set_input(burst_detector_t *det, void *queue);
+
 /* Get number of active bursts */
 int burst_detector_active_count(burst_detector_t *det);
 
 /* Get total detected burst count */
 uint64_t burst_detector_total_count(burst_detector_t *det);
 
+/* Bytes the noise floor estimate holds */
+size_t burst_detector_noise_floor_bytes(burst_detector_t *det);
+
 /* Get average noise floor in dBFS/Hz (for diagnostic display) */
 float burst_detector_noise_floor(burst_detector_t *det);
 
@@ -93,7 +164,13 @@ float burst_detector_peak_signal(burst_detector_t *det);
 /* Destroy and free all resources */
 void burst_detector_destroy(burst_detector_t *det);
 
-/* Thread function: pulls from samples_queue, pushes to burst_queue */
+/* Burst callback that puts bursts on the burst_sched_t passed as user,
+ * after narrowband extraction if that is on (see burst_extract.h),
+ * releasing (and counting as dropped) any the closed queue refuses */
+void burst_to_queue(burst_data_t *burst, void *user);
+
+/* Thread function: pulls from its input queue, pushes the bursts each
+ * block ends to burst_queue in one batch */
 void *burst_detector_thread(void *arg);
 
 #endif
@@ -4,7 +4,7 @@
  * Coarse CFO correction → LPF + decimation to 250 kHz (10 sps) →
  * Noise-limiting LPF (20 kHz cutoff) → Burst start detection →
  * Fine CFO (squared FFT + quadratic interpolation) → RRC matched filter →
- * FFT-based sync word correlation (DL + UL patterns) → Phase alignment →
+ * Sync word correlation (DL + UL patterns) → Phase alignment →
  * Frame extraction
  *
  * Original work Copyright 2020 Free Software Foundation, Inc.
@@ -22,7 +22,6 @@
 #define _GNU_SOURCE
 #include <complex.h>
 #include <math.h>
-#include <signal.h>
 #include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -31,14 +30,18 @@
 #include <fftw3.h>
 
 #include "burst_downmix.h"
-#include "fftw_lock.h"
+#include "fftw_plans.h"
 #include "fir_filter.h"
+#include "frame_pool.h"
 #include "iridium.h"
+#include "pipeline_stats.h"
 #include "rotator.h"
 #include "simd_kernels.h"
 #include "window_func.h"
 
-#include "blocking_queue.h"
+#ifdef USE_GPU
+#include "burst_fft.h"
+#endif
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -46,21 +49,60 @@
 
 /* ---- Externs ---- */
 
-extern Blocking_Queue burst_queue;
-extern Blocking_Queue frame_queue;
-extern volatile sig_atomic_t running;
 extern int verbose;
+extern atomic_ulong stat_sync_direct;
+extern atomic_ulong stat_sync_fft;
 /* ---- Constants ---- */
 
 #define CFO_FFT_OVERSAMPLE  16
+#define CFO_ZOOM_SPAN       (CFO_FFT_OVERSAMPLE + 1)  /* fine bins each side */
+#define CFO_ZOOM_ROWS       (2 * CFO_ZOOM_SPAN + 1)
 #define RRC_NTAPS           51
 #define RC_NTAPS            51
 #define RRC_ALPHA           0.4f
 #define START_THRESHOLD     0.45f
 #define PRE_START_US        100  /* microseconds before burst start */
+#define SHIFT_BLOCK         4096 /* input samples rotated per decimator pass */
+
+/* Direct sync correlation: lags searched either side of where each
+ * preamble length puts the correlation peak, and the coarse lag step */
+#define SYNC_WINDOW_SYMBOLS 6
+#define SYNC_COARSE_STEP    4
+#define SYNC_N_WINDOWS      3
+
+/* Least |c|^2 / (sync word energy * input energy) a direct peak needs.
+ * A lag off the unique word but still inside a long preamble matches
+ * only the preamble part of the sync word and scores under 0.45. */
+#define SYNC_DIRECT_MIN_RHO 0.6f
 
 /* ---- Internal state ---- */
 
+/* A batched FFT stage: rows of size points through a shared FFTW plan,
+ * or all rows at once on the GPU */
+typedef struct {
+    int size;
+    int sign;
+    fftwf_plan plan;            /* shared, see fftw_plans.h */
+} batch_fft_t;
+
+/* One burst of a batch between stages */
+typedef struct {
+    int out;                    /* index in the caller's burst array */
+    burst_data_t *burst;
+    uint64_t timestamp;
+    double center_frequency;
+    int start;                  /* burst start in the decimated burst */
+    int frame_len;
+    float complex *frame;       /* frame_len samples from start; after
+                                 * downmix_mid, the RRC output */
+    float complex *buf;         /* slot copy of frame for batches */
+    int buf_cap;
+    ir_direction_t direction;
+    int uw_start;
+    float uw_start_correction;
+    float complex corr_result;
+} dm_slot_t;
+
 struct _burst_downmix {
     /* Configuration */
     int output_sample_rate;
@@ -69,41 +111,64 @@ struct _burst_downmix {
     float samples_per_symbol;
 
     /* Filters */
-    fir_filter_t *input_fir;    /* anti-alias LPF for decimation */
+    fir_filter_t *input_fir;    /* anti-alias LPF, first (or only) stage */
+    fir_filter_t *input_fir2;   /* second decimation stage, NULL if single */
+    int input_dec1;             /* decimation of input_fir */
+    int input_dec2;             /* decimation of input_fir2 */
+    int input_fir_rate;         /* input sample rate input_fir was designed for */
+    int input_fir_mode;         /* input_fir_t */
+    int16_t *q15_taps;          /* Q15: input_fir shifted to the burst */
+    float q15_tap_scale;        /* Q15: taps are scaled by this */
     fir_filter_t *noise_fir;    /* noise-limiting LPF after decimation */
     fir_filter_t *start_fir;    /* magnitude smoothing */
     fir_filter_t *rrc_fir;      /* root-raised-cosine matched filter */
     fir_filter_t *rc_fir;       /* raised-cosine for sync word gen */
 
-    /* CFO estimation FFT */
+    /* CFO estimation FFT, one row per burst of a batch */
+    int fine_cfo;               /* fine_cfo_t */
     int cfo_fft_size;           /* base FFT size */
     int cfo_fft_total;          /* base * oversample factor */
-    fftwf_plan cfo_fft_plan;
+    batch_fft_t cfo_fft;        /* zoom: base size, else total */
     float complex *cfo_fft_in;
     float complex *cfo_fft_out;
     float *cfo_window;          /* Blackman window for CFO */
 
-    /* Correlation FFT */
+    /* Zoom: the squared bursts again (the GPU FFT is in place), the base
+     * FFT twiddles, and the oversampled DFT rows around a coarse bin */
+    float complex *cfo_sq;
+    float complex *cfo_twiddle;
+    float complex *cfo_zoom_taps;
+    float complex *cfo_zoom_work;
+
+    /* Correlation FFT: one forward row per burst, then a DL and a UL
+     * inverse row per burst, or one packed row holding both */
+    int sync_corr;              /* sync_corr_t */
     int corr_fft_size;
     int sync_search_len;
-    fftwf_plan corr_fwd_plan;
+    int ul_pack_offset;         /* UL lags start here in a packed row */
+    batch_fft_t corr_fwd;
     float complex *corr_fwd_in;
     float complex *corr_fwd_out;
 
-    fftwf_plan corr_dl_ifft_plan;
-    float complex *corr_dl_ifft_in;
-    float complex *corr_dl_ifft_out;
+    batch_fft_t corr_inv;
+    float complex *corr_ifft_in;
+    float complex *corr_ifft_out;
 
-    fftwf_plan corr_ul_ifft_plan;
-    float complex *corr_ul_ifft_in;
-    float complex *corr_ul_ifft_out;
-
-    /* Pre-computed sync word FFTs */
+    /* Pre-computed sync word FFTs (packed: both in dl_sync_fft) */
     float complex *dl_sync_fft;
     float complex *ul_sync_fft;
     int dl_sync_len;  /* in samples */
     int ul_sync_len;
 
+    /* Sync words for direct correlation, as dot product taps, and the
+     * lag windows it searches */
+    float complex *dl_sync_taps;
+    float complex *ul_sync_taps;
+    float dl_sync_energy;
+    float ul_sync_energy;
+    int sync_win_lo[SYNC_N_WINDOWS];
+    int sync_win_hi[SYNC_N_WINDOWS];
+
     /* Working buffers (sized for max burst) */
     float complex *work_a;
     float complex *work_b;
@@ -111,8 +176,20 @@ struct _burst_downmix {
     float *mag_filtered_f;
     int work_size;
 
+    /* Fused shift + first decimation stage: one rotated input block plus
+     * the stage's tap history, small enough to stay in cache */
+    float complex *shift_buf;
+    int shift_cap;
+
     /* Pre-start samples */
     int pre_start_samples;
+
+    /* Batches (see burst_downmix_process_batch) */
+    int batch_max;
+    dm_slot_t *slots;
+#ifdef USE_GPU
+    gpu_downmix_fft_t *gpu;     /* NULL: FFTW only */
+#endif
 };
 
 /* ---- Utility: next power of 2 ---- */
@@ -123,6 +200,32 @@ static int next_pow2(int n) {
     return p;
 }
 
+/* ---- Batched FFTs ---- */
+
+static void batch_fft_init(batch_fft_t *f, int size, int sign) {
+    f->size = size;
+    f->sign = sign;
+    f->plan = fftw_plan_shared_dft_1d(size, sign);
+}
+
+/* Transform rows of in; returns whichever buffer holds the result (in,
+ * when the GPU transformed it in place) */
+static float complex *batch_fft_run(burst_downmix_t *dm, const batch_fft_t *f,
+                                    float complex *in, float complex *out,
+                                    int rows) {
+#ifdef USE_GPU
+    if (dm->gpu && gpu_downmix_fft_execute(dm->gpu, (float *)in, f->size,
+                                           rows, f->sign) == 0)
+        return in;
+#else
+    (void)dm;
+#endif
+    for (int i = 0; i < rows; i++)
+        fftwf_execute_dft(f->plan, in + (size_t)i * f->size,
+                          out + (size_t)i * f->size);
+    return out;
+}
+
 /* ---- Utility: FFT shift/unshift ---- */
 
 static int fft_unshift_index(int idx, int size) {
@@ -135,36 +238,31 @@ static int fft_shift_index(int idx, int size) {
 
 /* ---- Sync word generation ---- */
 
-static void generate_sync_word(burst_downmix_t *dm, const int *uw, int uw_len,
-                               int preamble_len, int is_uplink,
-                               float complex **fft_out, int *sync_len_out) {
-    float sps = dm->samples_per_symbol;
-
-    /* Build symbol sequence: preamble + unique word */
-    float complex s0 = 1.0f + 1.0f * I;   /* normalized below */
-    float complex s1 = -1.0f - 1.0f * I;
+int burst_downmix_sync_symbols(int uplink, int preamble_len,
+                               float complex *symbols) {
+    const float complex s0 = 1.0f + 1.0f * I;
+    const float complex s1 = -1.0f - 1.0f * I;
+    const int *uw = uplink ? IR_UW_UL : IR_UW_DL;
 
-    int total_symbols;
-    float complex *symbols;
+    /* Downlink preamble: all s0; uplink: alternating s1, s0 pairs */
+    for (int i = 0; i < preamble_len; i++)
+        symbols[i] = uplink && i % 2 == 0 ? s1 : s0;
+    for (int i = 0; i < IR_UW_LENGTH; i++)
+        symbols[preamble_len + i] = (uw[i] == 0) ? s0 : s1;
+    return preamble_len + IR_UW_LENGTH;
+}
 
-    if (is_uplink) {
-        /* Uplink preamble: alternating s1, s0 pairs */
-        total_symbols = preamble_len + uw_len;
-        symbols = calloc(total_symbols, sizeof(float complex));
-        for (int i = 0; i < preamble_len; i++)
-            symbols[i] = (i % 2 == 0) ? s1 : s0;
-    } else {
-        /* Downlink preamble: all s0 */
-        total_symbols = preamble_len + uw_len;
-        symbols = calloc(total_symbols, sizeof(float complex));
-        for (int i = 0; i < preamble_len; i++)
-            symbols[i] = s0;
-    }
+/* The pulse-shaped preamble + unique word, reversed and conjugated, so
+ * that convolving with it correlates */
+static void generate_sync_word(burst_downmix_t *dm, int preamble_len,
+                               int is_uplink, float complex **template_out,
+                               int *sync_len_out) {
+    float sps = dm->samples_per_symbol;
 
-    /* Add unique word */
-    for (int i = 0; i < uw_len; i++) {
-        symbols[preamble_len + i] = (uw[i] == 0) ? s0 : s1;
-    }
+    float complex *symbols = calloc(preamble_len + IR_UW_LENGTH,
+                                    sizeof(float complex));
+    int total_symbols = burst_downmix_sync_symbols(is_uplink, preamble_len,
+                                                   symbols);
 
     /* Upsample: insert (sps-1) zeros between each symbol */
     int isps = (int)roundf(sps);
@@ -194,28 +292,141 @@ static void generate_sync_word(burst_downmix_t *dm, const int *uw, int uw_len,
     if (padded_len % 2)
         shaped[padded_len / 2] = conjf(shaped[padded_len / 2]);
 
-    /* Compute FFT of sync word template (zero-padded to corr_fft_size) */
+    *template_out = shaped;
+    *sync_len_out = padded_len;
+}
+
+/* FFT of sync word templates placed at the given offsets of one
+ * zero-padded corr_fft_size row */
+static float complex *sync_word_fft(burst_downmix_t *dm, int n,
+                                    float complex *const *templates,
+                                    const int *lens, const int *offsets) {
     float complex *sync_fft_in = fftwf_alloc_complex(dm->corr_fft_size);
     float complex *sync_fft_result = fftwf_alloc_complex(dm->corr_fft_size);
     memset(sync_fft_in, 0, dm->corr_fft_size * sizeof(float complex));
-    int copy_len = padded_len < dm->corr_fft_size ? padded_len : dm->corr_fft_size;
-    memcpy(sync_fft_in, shaped, copy_len * sizeof(float complex));
-    free(shaped);
-
-    fftw_lock();
-    fftwf_plan plan = fftwf_plan_dft_1d(dm->corr_fft_size,
-                                         sync_fft_in, sync_fft_result,
-                                         FFTW_FORWARD, FFTW_ESTIMATE);
-    fftw_unlock();
-    fftwf_execute(plan);
-
-    fftw_lock();
-    fftwf_destroy_plan(plan);
-    fftw_unlock();
+    for (int t = 0; t < n; t++)
+        for (int i = 0; i < lens[t]; i++)
+            sync_fft_in[(offsets[t] + i) % dm->corr_fft_size] += templates[t][i];
+
+    fftwf_execute_dft(dm->corr_fwd.plan, sync_fft_in, sync_fft_result);
     fftwf_free(sync_fft_in);
+    return sync_fft_result;
+}
 
-    *fft_out = sync_fft_result;
-    *sync_len_out = padded_len;
+/* The template reversed back, so the correlation at one lag is a dot
+ * product with the input */
+static float complex *sync_word_taps(const float complex *template, int len,
+                                     float *energy_out) {
+    float complex *taps = aligned_alloc_32(len * sizeof(float complex));
+    float energy = 0;
+    for (int i = 0; i < len; i++) {
+        taps[i] = template[len - 1 - i];
+        energy += crealf(taps[i]) * crealf(taps[i]) +
+                  cimagf(taps[i]) * cimagf(taps[i]);
+    }
+    *energy_out = energy;
+    return taps;
+}
+
+/* Anti-alias LPF ahead of decimation, for bursts at in_sample_rate.
+ *
+ * The overall decimation is split into two stages when that needs fewer
+ * multiply-accumulates per input sample: a short first stage at the full
+ * input rate only has to keep bands that would alias onto the final
+ * passband out of the way, and the sharp 0.4/0.2 * output-rate filter then
+ * runs at the much lower intermediate rate. Each divisor pair is costed
+ * from the tap counts lpf_taps() actually produces. */
+static void design_input_fir(burst_downmix_t *dm, int in_sample_rate) {
+    float out_rate = (float)dm->output_sample_rate;
+    float cutoff = out_rate * 0.4f;
+    float transition = out_rate * 0.2f;
+    int decimation = (int)roundf((float)in_sample_rate / out_rate);
+    if (decimation < 1) decimation = 1;
+
+    int ntaps;
+    float *taps = lpf_taps(&ntaps, 1.0f, (float)in_sample_rate,
+                           cutoff, transition);
+    float best_cost = (float)ntaps / decimation;
+    int best_d1 = 1;
+    free(taps);
+
+    for (int d1 = 2; d1 < decimation; d1++) {
+        if (decimation % d1) continue;
+        float mid_rate = (float)in_sample_rate / d1;
+        /* Pass half the output rate, reject everything that folds onto it */
+        float t1 = mid_rate - out_rate;
+        if (t1 <= 0) continue;
+        int n1, n2;
+        free(lpf_taps(&n1, 1.0f, (float)in_sample_rate, mid_rate / 2.0f, t1));
+        free(lpf_taps(&n2, 1.0f, mid_rate, cutoff, transition));
+        float cost = (float)n1 / d1 + (float)n2 / decimation;
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_d1 = d1;
+        }
+    }
+
+    fir_filter_destroy(dm->input_fir);
+    fir_filter_destroy(dm->input_fir2);
+    dm->input_fir2 = NULL;
+
+    if (best_d1 == 1) {
+        taps = lpf_taps(&ntaps, 1.0f, (float)in_sample_rate,
+                        cutoff, transition);
+        dm->input_fir = fir_filter_create_dec(taps, ntaps, decimation);
+        dm->input_dec1 = decimation;
+        dm->input_dec2 = 1;
+        free(taps);
+    } else {
+        float mid_rate = (float)in_sample_rate / best_d1;
+        taps = lpf_taps(&ntaps, 1.0f, (float)in_sample_rate,
+                        mid_rate / 2.0f, mid_rate - out_rate);
+        dm->input_fir = fir_filter_create_dec(taps, ntaps, best_d1);
+        free(taps);
+        taps = lpf_taps(&ntaps, 1.0f, mid_rate, cutoff, transition);
+        dm->input_fir2 = fir_filter_create_dec(taps, ntaps,
+                                               decimation / best_d1);
+        free(taps);
+        dm->input_dec1 = best_d1;
+        dm->input_dec2 = decimation / best_d1;
+    }
+    dm->input_fir_rate = in_sample_rate;
+
+    /* Q15 taps: both rows of simd_fir_q15_dec() (rewritten per burst,
+     * padding stays zero), scaled as far up as int32 sums allow. Each
+     * output component is at most 32768 * sqrt(2) * sum |taps| * scale. */
+    if (dm->input_fir_mode == INPUT_FIR_Q15) {
+        free(dm->q15_taps);
+        dm->q15_taps = aligned_calloc_32(4 * pad_to_8(dm->input_fir->ntaps),
+                                         sizeof(int16_t));
+        double l1 = 0;
+        for (int i = 0; i < dm->input_fir->ntaps; i++)
+            l1 += fabsf(dm->input_fir->taps[i]);
+        dm->q15_tap_scale = 16384.0f;
+        while (dm->q15_tap_scale > 1.0f &&
+               32768.0 * sqrt(2.0) * l1 * (dm->q15_tap_scale + 1) >= 2147483647.0)
+            dm->q15_tap_scale /= 2;
+    }
+
+    /* Each block must hold at least one output's history plus a stride */
+    int cap = SHIFT_BLOCK + dm->input_fir->ntaps;
+    if (cap > dm->shift_cap) {
+        free(dm->shift_buf);
+        dm->shift_buf = aligned_alloc_32(sizeof(float complex) * cap);
+        dm->shift_cap = cap;
+    }
+
+    if (verbose) {
+        if (dm->input_fir2)
+            fprintf(stderr, "burst_downmix: %d Hz input, decimate %d x %d "
+                    "(%d + %d taps)\n", in_sample_rate, dm->input_dec1,
+                    dm->input_dec2, dm->input_fir->ntaps,
+                    dm->input_fir2->ntaps);
+        else
+            fprintf(stderr, "burst_downmix: %d Hz input, decimate %d "
+                    "(%d taps)\n", in_sample_rate, dm->input_dec1,
+                    dm->input_fir->ntaps);
+    }
 }
 
 /* ---- Create downmix context ---- */
@@ -248,17 +459,10 @@ burst_downmix_t *burst_downmix_create(downmix_config_t *config) {
     }
 
     /* ---- Input anti-alias LPF ---- */
-    {
-        float cutoff = dm->output_sample_rate * 0.4f;
-        float transition = dm->output_sample_rate * 0.2f;
-        /* Use a reasonable input sample rate for tap design.
-         * The actual decimation ratio depends on the burst's input rate.
-         * We design for a generic 10 MHz input. */
-        int ntaps;
-        float *taps = lpf_taps(&ntaps, 1.0f, 10000000.0f, cutoff, transition);
-        dm->input_fir = fir_filter_create(taps, ntaps);
-        free(taps);
-    }
+    /* Designed for a generic 10 MHz input; redesigned on the first burst
+     * that arrives at another rate (see decimate_burst) */
+    dm->input_fir_mode = config ? config->input_fir : INPUT_FIR_FLOAT;
+    design_input_fir(dm, 10000000);
 
     /* ---- Noise-limiting LPF (applied after decimation) ---- */
     {
@@ -313,54 +517,121 @@ burst_downmix_t *burst_downmix_create(downmix_config_t *config) {
             dm->cfo_fft_size *= 2;
     }
     dm->cfo_fft_total = dm->cfo_fft_size * CFO_FFT_OVERSAMPLE;
-    dm->cfo_fft_in = fftwf_alloc_complex(dm->cfo_fft_total);
-    dm->cfo_fft_out = fftwf_alloc_complex(dm->cfo_fft_total);
+    dm->fine_cfo = config ? config->fine_cfo : FINE_CFO_FFT;
+
+    dm->batch_max = (config && config->batch_size > 1) ? config->batch_size : 1;
+    if (dm->batch_max > DOWNMIX_BATCH_MAX)
+        dm->batch_max = DOWNMIX_BATCH_MAX;
+    dm->slots = calloc(dm->batch_max, sizeof(*dm->slots));
+
+    dm->cfo_fft_in = fftwf_alloc_complex((size_t)dm->batch_max * dm->cfo_fft_total);
+    dm->cfo_fft_out = fftwf_alloc_complex((size_t)dm->batch_max * dm->cfo_fft_total);
 
     /* CFO Blackman window */
     dm->cfo_window = malloc(sizeof(float) * dm->cfo_fft_size);
     blackman_window(dm->cfo_window, dm->cfo_fft_size);
 
+    if (dm->fine_cfo == FINE_CFO_ZOOM) {
+        int n = dm->cfo_fft_size;
+        dm->cfo_sq = aligned_alloc_32(sizeof(float complex) * dm->batch_max * n);
+        dm->cfo_twiddle = malloc(sizeof(float complex) * n);
+        for (int i = 0; i < n; i++)
+            dm->cfo_twiddle[i] = cexpf(-2.0f * (float)M_PI * i / n * I);
+        /* Row r is fine bin r - CFO_ZOOM_SPAN from the coarse bin */
+        dm->cfo_zoom_taps = aligned_alloc_32(sizeof(float complex) *
+                                             CFO_ZOOM_ROWS * n);
+        for (int r = 0; r < CFO_ZOOM_ROWS; r++) {
+            int bin = r - CFO_ZOOM_SPAN;
+            for (int i = 0; i < n; i++) {
+                int k = (bin * i) % dm->cfo_fft_total;
+                dm->cfo_zoom_taps[(size_t)r * n + i] =
+                    cexpf(-2.0f * (float)M_PI * k / dm->cfo_fft_total * I);
+            }
+        }
+        dm->cfo_zoom_work = aligned_alloc_32(sizeof(float complex) * n);
+    }
+
     /* ---- Correlation FFT ---- */
     int sync_search_symbols = IR_PREAMBLE_LENGTH_LONG + IR_UW_LENGTH + 8;
     dm->sync_search_len = (int)(sync_search_symbols * dm->samples_per_symbol);
+    dm->sync_corr = config ? config->sync_corr : SYNC_CORR_AUTO;
+
+    /* Sync words */
+    float complex *dl_template, *ul_template;
+    generate_sync_word(dm, IR_PREAMBLE_LENGTH_SHORT, 0,
+                       &dl_template, &dm->dl_sync_len);
+    generate_sync_word(dm, IR_PREAMBLE_LENGTH_SHORT, 1,
+                       &ul_template, &dm->ul_sync_len);
+
+    if (dm->sync_corr == SYNC_CORR_PACKED) {
+        /* DL lags at the start of the row and UL lags after the whole DL
+         * correlation, with room for the UL correlation before it wraps
+         * back onto the DL lags */
+        dm->ul_pack_offset = dm->sync_search_len + dm->dl_sync_len - 1;
+        dm->corr_fft_size = next_pow2(dm->ul_pack_offset + dm->sync_search_len +
+                                      dm->ul_sync_len - 1);
+    } else {
+        int ul_sync_symbols = IR_PREAMBLE_LENGTH_SHORT + IR_UW_LENGTH;
+        int ul_sync_samples = (int)(ul_sync_symbols * dm->samples_per_symbol);
+        dm->corr_fft_size = next_pow2(dm->sync_search_len + ul_sync_samples);
+    }
+
+    /* The peak sits where the unique word ends, so each preamble length
+     * puts it at a known lag past the burst start; find_burst_start()
+     * backs off pre_start_samples before the start */
+    {
+        static const int preambles[SYNC_N_WINDOWS] = {
+            IR_PREAMBLE_LENGTH_SHORT, 32, IR_PREAMBLE_LENGTH_LONG
+        };
+        int half = (int)(SYNC_WINDOW_SYMBOLS * dm->samples_per_symbol);
+        for (int w = 0; w < SYNC_N_WINDOWS; w++) {
+            int center = dm->pre_start_samples +
+                (int)((preambles[w] + IR_UW_LENGTH - 1) * dm->samples_per_symbol);
+            dm->sync_win_lo[w] = center - half < 0 ? 0 : center - half;
+            dm->sync_win_hi[w] = center + half;
+        }
+    }
+
+    size_t corr_rows = (size_t)dm->batch_max * dm->corr_fft_size;
+    dm->corr_fwd_in = fftwf_alloc_complex(corr_rows);
+    dm->corr_fwd_out = fftwf_alloc_complex(corr_rows);
+    dm->corr_ifft_in = fftwf_alloc_complex(2 * corr_rows);
+    dm->corr_ifft_out = fftwf_alloc_complex(2 * corr_rows);
+
+    /* Plans are shared by all workers; each runs them on its own buffers */
+    batch_fft_init(&dm->cfo_fft, dm->fine_cfo == FINE_CFO_ZOOM
+                   ? dm->cfo_fft_size : dm->cfo_fft_total, FFTW_FORWARD);
+    batch_fft_init(&dm->corr_fwd, dm->corr_fft_size, FFTW_FORWARD);
+    batch_fft_init(&dm->corr_inv, dm->corr_fft_size, FFTW_BACKWARD);
+
+#ifdef USE_GPU
+    if (config && config->use_gpu && dm->batch_max > 1) {
+        dm->gpu = gpu_downmix_fft_create(dm->cfo_fft.size, dm->corr_fft_size,
+                                         dm->batch_max);
+        if (!dm->gpu)
+            fprintf(stderr, "burst_downmix: GPU unavailable, batching on FFTW\n");
+    }
+#endif
 
-    /* Need sync word length to determine corr FFT size. */
-    int ul_sync_symbols = IR_PREAMBLE_LENGTH_SHORT + IR_UW_LENGTH;
-    int ul_sync_samples = (int)(ul_sync_symbols * dm->samples_per_symbol);
-    dm->corr_fft_size = next_pow2(dm->sync_search_len + ul_sync_samples);
-
-    dm->corr_fwd_in = fftwf_alloc_complex(dm->corr_fft_size);
-    dm->corr_fwd_out = fftwf_alloc_complex(dm->corr_fft_size);
-    dm->corr_dl_ifft_in = fftwf_alloc_complex(dm->corr_fft_size);
-    dm->corr_dl_ifft_out = fftwf_alloc_complex(dm->corr_fft_size);
-    dm->corr_ul_ifft_in = fftwf_alloc_complex(dm->corr_fft_size);
-    dm->corr_ul_ifft_out = fftwf_alloc_complex(dm->corr_fft_size);
-
-    /* All FFTW plan creation must be serialized (not thread-safe) */
-    fftw_lock();
-    dm->cfo_fft_plan = fftwf_plan_dft_1d(dm->cfo_fft_total,
-                                          dm->cfo_fft_in, dm->cfo_fft_out,
-                                          FFTW_FORWARD, FFTW_MEASURE);
-    dm->corr_fwd_plan = fftwf_plan_dft_1d(dm->corr_fft_size,
-                                            dm->corr_fwd_in, dm->corr_fwd_out,
-                                            FFTW_FORWARD, FFTW_MEASURE);
-    dm->corr_dl_ifft_plan = fftwf_plan_dft_1d(dm->corr_fft_size,
-                                                dm->corr_dl_ifft_in,
-                                                dm->corr_dl_ifft_out,
-                                                FFTW_BACKWARD, FFTW_MEASURE);
-    dm->corr_ul_ifft_plan = fftwf_plan_dft_1d(dm->corr_fft_size,
-                                                dm->corr_ul_ifft_in,
-                                                dm->corr_ul_ifft_out,
-                                                FFTW_BACKWARD, FFTW_MEASURE);
-    fftw_unlock();
-
-    /* Generate sync word FFTs */
-    generate_sync_word(dm, IR_UW_DL, IR_UW_LENGTH,
-                       IR_PREAMBLE_LENGTH_SHORT, 0,
-                       &dm->dl_sync_fft, &dm->dl_sync_len);
-    generate_sync_word(dm, IR_UW_UL, IR_UW_LENGTH,
-                       IR_PREAMBLE_LENGTH_SHORT, 1,
-                       &dm->ul_sync_fft, &dm->ul_sync_len);
+    /* Sync word FFTs and dot product taps */
+    {
+        float complex *templates[2] = { dl_template, ul_template };
+        int lens[2] = { dm->dl_sync_len, dm->ul_sync_len };
+        int zero[2] = { 0, 0 };
+        if (dm->sync_corr == SYNC_CORR_PACKED) {
+            int offsets[2] = { 0, dm->ul_pack_offset };
+            dm->dl_sync_fft = sync_word_fft(dm, 2, templates, lens, offsets);
+        } else {
+            dm->dl_sync_fft = sync_word_fft(dm, 1, &templates[0], &lens[0], zero);
+            dm->ul_sync_fft = sync_word_fft(dm, 1, &templates[1], &lens[1], zero);
+        }
+        dm->dl_sync_taps = sync_word_taps(dl_template, dm->dl_sync_len,
+                                          &dm->dl_sync_energy);
+        dm->ul_sync_taps = sync_word_taps(ul_template, dm->ul_sync_len,
+                                          &dm->ul_sync_energy);
+        free(dl_template);
+        free(ul_template);
+    }
 
     /* ---- Working buffers (generous size, aligned for SIMD) ---- */
     dm->work_size = 2 * 1024 * 1024;  /* 2M samples max */
@@ -376,66 +647,246 @@ void burst_downmix_destroy(burst_downmix_t *dm) {
     if (!dm) return;
 
     fir_filter_destroy(dm->input_fir);
+    fir_filter_destroy(dm->input_fir2);
     fir_filter_destroy(dm->noise_fir);
     fir_filter_destroy(dm->start_fir);
     fir_filter_destroy(dm->rrc_fir);
     fir_filter_destroy(dm->rc_fir);
 
-    fftw_lock();
-    fftwf_destroy_plan(dm->cfo_fft_plan);
-    fftwf_destroy_plan(dm->corr_fwd_plan);
-    fftwf_destroy_plan(dm->corr_dl_ifft_plan);
-    fftwf_destroy_plan(dm->corr_ul_ifft_plan);
-    fftw_unlock();
+    fftw_plan_release(dm->cfo_fft.plan);
+    fftw_plan_release(dm->corr_fwd.plan);
+    fftw_plan_release(dm->corr_inv.plan);
+#ifdef USE_GPU
+    gpu_downmix_fft_destroy(dm->gpu);
+#endif
 
     fftwf_free(dm->cfo_fft_in);
     fftwf_free(dm->cfo_fft_out);
     free(dm->cfo_window);
+    free(dm->cfo_sq);
+    free(dm->cfo_twiddle);
+    free(dm->cfo_zoom_taps);
+    free(dm->cfo_zoom_work);
 
     fftwf_free(dm->corr_fwd_in);
     fftwf_free(dm->corr_fwd_out);
 
-    fftwf_free(dm->corr_dl_ifft_in);
-    fftwf_free(dm->corr_dl_ifft_out);
+    fftwf_free(dm->corr_ifft_in);
+    fftwf_free(dm->corr_ifft_out);
 
-    fftwf_free(dm->corr_ul_ifft_in);
-    fftwf_free(dm->corr_ul_ifft_out);
+    for (int i = 0; i < dm->batch_max; i++)
+        free(dm->slots[i].buf);
+    free(dm->slots);
 
     fftwf_free(dm->dl_sync_fft);
     fftwf_free(dm->ul_sync_fft);
+    free(dm->dl_sync_taps);
+    free(dm->ul_sync_taps);
 
     free(dm->work_a);
     free(dm->work_b);
     free(dm->mag_f);
     free(dm->mag_filtered_f);
+    free(dm->shift_buf);
+    free(dm->q15_taps);
 
     free(dm);
 }
 
-/* ---- Step 2: Decimate ---- */
+/* ---- Steps 1+2: Coarse CFO correction and decimation ---- */
 
-static int decimate_burst(burst_downmix_t *dm, const float complex *in, int in_len,
-                           float complex *out, int in_sample_rate,
-                           uint64_t *timestamp) {
-    int decimation = (int)roundf((float)in_sample_rate / dm->output_sample_rate);
-    if (decimation < 1) decimation = 1;
+/* Rotate view samples [pos, pos + len) into out; samples that are not
+ * float complex in one piece of the view are converted into out first */
+static void rotate_view(rotator_t *r, const burst_data_t *burst, size_t pos,
+                        int len, float complex *out) {
+    rotator_rotate_n(r, out, burst_data_cf(burst, pos, len, out), len);
+}
 
-    int n_out = (in_len - dm->input_fir->ntaps + 1) / decimation;
-    if (n_out <= 0) return 0;
-    if (n_out > dm->work_size) n_out = dm->work_size;
+/* View samples [pos, pos + len) as int16 IQ pairs (int8 widened) */
+static void view_i16(const burst_data_t *burst, size_t pos, size_t len,
+                     int16_t *out) {
+    size_t bytes = burst->format == SAMPLE_FMT_INT16 ? 4 : 2;
+    for (int seg = 0; seg < 2 && len > 0; seg++) {
+        const uint8_t *base;
+        size_t n;
+        if (pos < burst->split) {
+            base = (const uint8_t *)burst->samples + pos * bytes;
+            n = burst->split - pos;
+        } else {
+            base = (const uint8_t *)burst->wrap + (pos - burst->split) * bytes;
+            n = len;
+        }
+        if (n > len) n = len;
+        if (burst->format == SAMPLE_FMT_INT16) {
+            memcpy(out, base, n * 2 * sizeof(int16_t));
+        } else {
+            const int8_t *iq = (const int8_t *)base;
+            for (size_t i = 0; i < 2 * n; i++)
+                out[i] = iq[i];
+        }
+        out += 2 * n;
+        pos += n;
+        len -= n;
+    }
+}
 
-    fir_filter_ccf_dec(dm->input_fir, out, in, n_out, decimation);
+/* First decimation stage, in float: the view is rotated one SHIFT_BLOCK
+ * at a time into shift_buf and every output whose window lies inside the
+ * block is computed before the next block is read, so the full-rate
+ * burst is never written out. Returns the outputs written (at most n1). */
+static int decimate_stage1(burst_downmix_t *dm, const burst_data_t *burst,
+                           int in_len, int skip, float phase_inc,
+                           float complex *stage1, int n1) {
+    fir_filter_t *f1 = dm->input_fir;
+    int d1 = dm->input_dec1;
+
+    rotator_t r;
+    rotator_init(&r);
+    rotator_set_phase(&r, cexpf(phase_inc * skip * I));
+    rotator_set_phase_incr(&r, cexpf(phase_inc * I));
+
+    size_t pos = skip;
+    int have = 0, done = 0;
+    while (done < n1) {
+        int want = dm->shift_cap - have;
+        if ((size_t)want > (size_t)in_len - pos) want = (int)(in_len - pos);
+        rotate_view(&r, burst, pos, want, dm->shift_buf + have);
+        pos += want;
+        have += want;
+
+        int n = (have - f1->ntaps) / d1 + 1;
+        if (n > n1 - done) n = n1 - done;
+        if (n <= 0) break;
+        fir_filter_ccf_dec(f1, stage1 + done, dm->shift_buf, n, d1);
+        done += n;
+
+        int used = n * d1;
+        have -= used;
+        memmove(dm->shift_buf, dm->shift_buf + used,
+                have * sizeof(float complex));
+    }
+    return done;
+}
 
-    /* Adjust timestamp for filter delay */
-    if (timestamp) {
-        uint64_t delay_ns = (uint64_t)((dm->input_fir->ntaps / 2) *
-                            1000000000ULL / in_sample_rate);
-        *timestamp += delay_ns;
+/* First decimation stage in fixed point, for int8 and int16 views. Rather
+ * than rotating every input sample, the taps are shifted up to the burst,
+ * g[k] = h[k] e^(j w k), the view is filtered as int16 IQ, and only the
+ * decimated outputs are rotated:
+ *   sum_k h[k] x[n+k] e^(j w (n+k)) = e^(j w n) sum_k g[k] x[n+k]
+ * Same blocking as decimate_stage1(), with shift_buf holding int16 pairs. */
+static int decimate_stage1_q15(burst_downmix_t *dm, const burst_data_t *burst,
+                               int in_len, int skip, float phase_inc,
+                               float complex *stage1, int n1) {
+    fir_filter_t *f1 = dm->input_fir;
+    int d1 = dm->input_dec1;
+    int ntaps = f1->ntaps;
+    int16_t *tr = dm->q15_taps;
+    int16_t *ti = dm->q15_taps + 2 * pad_to_8(ntaps);
+    for (int k = 0; k < ntaps; k++) {
+        float complex g = f1->taps[k] * dm->q15_tap_scale
+                        * cexpf(phase_inc * k * I);
+        int16_t re = (int16_t)lrintf(crealf(g));
+        int16_t im = (int16_t)lrintf(cimagf(g));
+        tr[2 * k] = re;
+        tr[2 * k + 1] = -im;
+        ti[2 * k] = im;
+        ti[2 * k + 1] = re;
     }
+    float full_scale = burst->format == SAMPLE_FMT_INT16 ? 32768.0f : 128.0f;
+    float scale = 1.0f / (dm->q15_tap_scale * full_scale);
+
+    int16_t *buf = (int16_t *)dm->shift_buf;
+    size_t pos = skip;
+    int have = 0, done = 0;
+    while (done < n1) {
+        int want = dm->shift_cap - have;
+        if ((size_t)want > (size_t)in_len - pos) want = (int)(in_len - pos);
+        view_i16(burst, pos, want, buf + 2 * have);
+        pos += want;
+        have += want;
+
+        int n = (have - ntaps) / d1 + 1;
+        if (n > n1 - done) n = n1 - done;
+        if (n <= 0) break;
+        simd_fir_q15_dec(dm->q15_taps, ntaps, buf, stage1 + done, n, d1,
+                         scale);
+        done += n;
+
+        int used = n * d1;
+        have -= used;
+        memmove(buf, buf + 2 * used, have * 2 * sizeof(int16_t));
+    }
+
+    rotator_t r;
+    rotator_init(&r);
+    rotator_set_phase(&r, cexpf(phase_inc * skip * I));
+    rotator_set_phase_incr(&r, cexpf(phase_inc * d1 * I));
+    rotator_rotate_n(&r, stage1, stage1, done);
+    return done;
+}
+
+/* Shift the burst down by relative_freq and decimate it to the output
+ * rate, starting skip input samples into the view.
+ *
+ * The shift is fused into the first FIR stage (decimate_stage1(), or
+ * decimate_stage1_q15() with --input-fir=q15 on int8/int16 views). A
+ * second stage, if any, then runs over the (already decimated) first-stage
+ * output in work_a. Only the strided outputs are evaluated at each stage. */
+static int decimate_burst(burst_downmix_t *dm, const burst_data_t *burst,
+                          int in_len, int skip, float relative_freq,
+                          float complex *out, uint64_t *timestamp) {
+    int in_sample_rate = burst->sample_rate;
+    fir_filter_t *f1 = dm->input_fir;
+    int d1 = dm->input_dec1;
+    float complex *stage1 = dm->input_fir2 ? dm->work_a : out;
+
+    int n1 = (in_len - skip - f1->ntaps + 1) / d1;
+    if (n1 <= 0) return 0;
+    if (n1 > dm->work_size) n1 = dm->work_size;
+
+    float phase_inc = -2.0f * (float)M_PI * relative_freq;
+    int done;
+    if (dm->input_fir_mode == INPUT_FIR_Q15 && burst->format != SAMPLE_FMT_FLOAT)
+        done = decimate_stage1_q15(dm, burst, in_len, skip, phase_inc,
+                                   stage1, n1);
+    else
+        done = decimate_stage1(dm, burst, in_len, skip, phase_inc, stage1, n1);
+
+    /* Group delay of the cascade, plus the skipped lead-in */
+    double delay = (double)skip + f1->ntaps / 2;
+    int n_out = done;
+    if (dm->input_fir2) {
+        fir_filter_t *f2 = dm->input_fir2;
+        n_out = (done - f2->ntaps + 1) / dm->input_dec2;
+        if (n_out <= 0) return 0;
+        fir_filter_ccf_dec(f2, out, stage1, n_out, dm->input_dec2);
+        delay += (double)(f2->ntaps / 2) * d1;
+    }
+
+    if (timestamp)
+        *timestamp += (uint64_t)(delay * 1e9 / in_sample_rate);
 
     return n_out;
 }
 
+/* Input samples at the head of the view that can be skipped without
+ * touching the burst. The detector backs each burst up by burst_pre_len
+ * (fft_size + hop by default) from the first FFT frame that crossed the
+ * threshold, so the true onset lies at least one fft_size into the view;
+ * half of that, less what find_burst_start() and the filters look back,
+ * is pure noise the downmix would otherwise filter and then discard. */
+static int pre_burst_skip(const burst_downmix_t *dm, const burst_data_t *burst) {
+    int decimation = dm->input_dec1 * dm->input_dec2;
+    int guard = dm->input_fir->ntaps
+              + (dm->pre_start_samples + dm->noise_fir->ntaps
+                 + dm->start_fir->ntaps) * decimation;
+    if (dm->input_fir2)
+        guard += dm->input_fir2->ntaps * dm->input_dec1;
+    int skip = burst->fft_size / 2 - guard;
+    if (skip <= 0) return 0;
+    return skip - skip % decimation;
+}
+
 /* ---- Step 3: Find burst start ---- */
 
 static int find_burst_start(burst_downmix_t *dm, const float complex *frame,
@@ -479,24 +930,35 @@ static int find_burst_start(burst_downmix_t *dm, const float complex *frame,
 
 /* ---- Step 4: Fine CFO estimation ---- */
 
-static float estimate_fine_cfo(burst_downmix_t *dm, const float complex *frame,
-                                int frame_len) {
+/* Square the signal (removes BPSK, creates tone at 2x CFO) and window it
+ * into one row of the CFO FFT input; zoom keeps a copy in sq */
+static void fine_cfo_input(burst_downmix_t *dm, const float complex *frame,
+                           int frame_len, float complex *fft_in,
+                           float complex *sq) {
     int n = dm->cfo_fft_size;
     if (n > frame_len) n = frame_len;
 
-    /* Square the signal (removes BPSK, creates tone at 2x CFO) */
-    memset(dm->cfo_fft_in, 0, dm->cfo_fft_total * sizeof(float complex));
-    simd_csquare_window(frame, dm->cfo_window, dm->cfo_fft_in, n);
+    memset(fft_in, 0, dm->cfo_fft.size * sizeof(float complex));
+    simd_csquare_window(frame, dm->cfo_window, fft_in, n);
+    if (dm->fine_cfo == FINE_CFO_ZOOM)
+        memcpy(sq, fft_in, dm->cfo_fft_size * sizeof(float complex));
+}
 
-    /* FFT */
-    fftwf_execute(dm->cfo_fft_plan);
+/* The slot's copy of its squared burst, for zoom */
+static float complex *fine_cfo_sq(burst_downmix_t *dm, const dm_slot_t *s) {
+    if (dm->fine_cfo != FINE_CFO_ZOOM)
+        return NULL;
+    return dm->cfo_sq + (size_t)(s - dm->slots) * dm->cfo_fft_size;
+}
 
+/* Interpolated spectral peak of one row of the CFO FFT output */
+static float fine_cfo_peak(burst_downmix_t *dm, const float complex *fft_out) {
     /* Find peak magnitude */
     float max_mag = 0;
     int max_idx_shifted = 0;
     for (int i = 0; i < dm->cfo_fft_total; i++) {
-        float re = crealf(dm->cfo_fft_out[i]);
-        float im = cimagf(dm->cfo_fft_out[i]);
+        float re = crealf(fft_out[i]);
+        float im = cimagf(fft_out[i]);
         float m = re * re + im * im;
         if (m > max_mag) {
             max_mag = m;
@@ -513,14 +975,14 @@ static float estimate_fine_cfo(burst_downmix_t *dm, const float complex *frame,
         int idx_p1 = fft_shift_index(max_idx + 1, dm->cfo_fft_total);
 
         float re, im;
-        re = crealf(dm->cfo_fft_out[idx_m1]);
-        im = cimagf(dm->cfo_fft_out[idx_m1]);
+        re = crealf(fft_out[idx_m1]);
+        im = cimagf(fft_out[idx_m1]);
         float alpha = re * re + im * im;
 
         float beta = max_mag;
 
-        re = crealf(dm->cfo_fft_out[idx_p1]);
-        im = cimagf(dm->cfo_fft_out[idx_p1]);
+        re = crealf(fft_out[idx_p1]);
+        im = cimagf(fft_out[idx_p1]);
         float gamma = re * re + im * im;
 
         float denom = alpha - 2.0f * beta + gamma;
@@ -534,90 +996,126 @@ static float estimate_fine_cfo(burst_downmix_t *dm, const float complex *frame,
     return center_offset;
 }
 
+/* The same estimate from the base-size FFT: the oversampled spectrum is
+ * only evaluated within one base bin of the base peak, as a DFT of the
+ * squared burst shifted down by the base bin. The bins are those of the
+ * oversampled FFT, so the peak matches, for about a third of the work
+ * at 10 sps. */
+static float fine_cfo_zoom(burst_downmix_t *dm, const float complex *fft_out,
+                           const float complex *sq) {
+    int n = dm->cfo_fft_size;
+
+    /* Base peak */
+    float max_mag = 0;
+    int base_shifted = 0;
+    for (int i = 0; i < n; i++) {
+        float re = crealf(fft_out[i]);
+        float im = cimagf(fft_out[i]);
+        float m = re * re + im * im;
+        if (m > max_mag) {
+            max_mag = m;
+            base_shifted = i;
+        }
+    }
+
+    /* Shift the base bin to DC */
+    for (int i = 0; i < n; i++)
+        dm->cfo_zoom_work[i] = sq[i] * dm->cfo_twiddle[(base_shifted * i) & (n - 1)];
+
+    /* Oversampled bins around it; the outermost rows only interpolate */
+    float mag[CFO_ZOOM_ROWS];
+    for (int r = 0; r < CFO_ZOOM_ROWS; r++) {
+        float complex c = simd_dot_cc(dm->cfo_zoom_work,
+                                      dm->cfo_zoom_taps + (size_t)r * n, n);
+        mag[r] = crealf(c) * crealf(c) + cimagf(c) * cimagf(c);
+    }
+    int best = 1;
+    for (int r = 2; r < CFO_ZOOM_ROWS - 1; r++)
+        if (mag[r] > mag[best])
+            best = r;
+
+    /* Quadratic interpolation */
+    float correction = 0;
+    float denom = mag[best - 1] - 2.0f * mag[best] + mag[best + 1];
+    if (fabsf(denom) > 1e-10f)
+        correction = 0.5f * (mag[best - 1] - mag[best + 1]) / denom;
+
+    float idx = fft_unshift_index(base_shifted, n) * CFO_FFT_OVERSAMPLE +
+                (best - CFO_ZOOM_SPAN) + correction;
+    if (idx >= dm->cfo_fft_total / 2) idx -= dm->cfo_fft_total;
+    if (idx < -dm->cfo_fft_total / 2) idx += dm->cfo_fft_total;
+
+    /* Normalize: divide by FFT size and by 2 (because we squared) */
+    return idx / dm->cfo_fft_total / 2.0f;
+}
+
 /* ---- Step 7: Sync word correlation ---- */
 
-static int correlate_sync(burst_downmix_t *dm, const float complex *frame,
-                           int frame_len, ir_direction_t *direction,
-                           float *uw_start_correction,
-                           float complex *corr_result_out) {
+/* The start of the frame, zero-padded, as one forward correlation row */
+static void correlate_input(burst_downmix_t *dm, const float complex *frame,
+                            int frame_len, float complex *fft_in) {
     int search_len = dm->sync_search_len;
     if (search_len > frame_len) search_len = frame_len;
 
-    /* Forward FFT of signal */
-    memset(dm->corr_fwd_in, 0, dm->corr_fft_size * sizeof(float complex));
-    memcpy(dm->corr_fwd_in, frame, search_len * sizeof(float complex));
-    fftwf_execute(dm->corr_fwd_plan);
+    memset(fft_in, 0, dm->corr_fft_size * sizeof(float complex));
+    memcpy(fft_in, frame, search_len * sizeof(float complex));
+}
 
-    /* Frequency-domain multiply: signal_fft * sync_fft */
-    /* (sync word is already reversed+conjugated, so this is correlation) */
-    for (int i = 0; i < dm->corr_fft_size; i++) {
-        dm->corr_dl_ifft_in[i] = dm->corr_fwd_out[i] * dm->dl_sync_fft[i];
-        dm->corr_ul_ifft_in[i] = dm->corr_fwd_out[i] * dm->ul_sync_fft[i];
+/* Frequency-domain multiply of one forward row by both sync words, into
+ * its DL and UL inverse rows (the sync words are already reversed and
+ * conjugated, so this is correlation). Packed, both land in the DL row. */
+static void correlate_multiply(burst_downmix_t *dm, const float complex *fwd,
+                               float complex *dl, float complex *ul) {
+    if (dm->sync_corr == SYNC_CORR_PACKED) {
+        for (int i = 0; i < dm->corr_fft_size; i++)
+            dl[i] = fwd[i] * dm->dl_sync_fft[i];
+        return;
     }
-
-    /* Inverse FFTs */
-    fftwf_execute(dm->corr_dl_ifft_plan);
-    fftwf_execute(dm->corr_ul_ifft_plan);
-
-    /* Find DL correlation peak */
-    float max_dl = 0;
-    int offset_dl = 0;
-    for (int i = 0; i < search_len; i++) {
-        float re = crealf(dm->corr_dl_ifft_out[i]);
-        float im = cimagf(dm->corr_dl_ifft_out[i]);
-        float m = re * re + im * im;
-        if (m > max_dl) {
-            max_dl = m;
-            offset_dl = i;
-        }
+    for (int i = 0; i < dm->corr_fft_size; i++) {
+        dl[i] = fwd[i] * dm->dl_sync_fft[i];
+        ul[i] = fwd[i] * dm->ul_sync_fft[i];
     }
+}
 
-    /* Find UL correlation peak */
-    float max_ul = 0;
-    int offset_ul = 0;
-    for (int i = 0; i < search_len; i++) {
-        float re = crealf(dm->corr_ul_ifft_out[i]);
-        float im = cimagf(dm->corr_ul_ifft_out[i]);
+/* Index of the largest |c|^2 in c[0..n), first one on ties */
+static int correlate_argmax(const float complex *c, int n, float *max_out) {
+    float max = 0;
+    int offset = 0;
+    for (int i = 0; i < n; i++) {
+        float re = crealf(c[i]);
+        float im = cimagf(c[i]);
         float m = re * re + im * im;
-        if (m > max_ul) {
-            max_ul = m;
-            offset_ul = i;
+        if (m > max) {
+            max = m;
+            offset = i;
         }
     }
+    *max_out = max;
+    return offset;
+}
 
-    /* Select best direction */
-    int corr_offset;
-    float complex *ifft_out;
-    int sync_len;
-
-    if (max_dl >= max_ul) {
-        *direction = DIR_DOWNLINK;
-        corr_offset = offset_dl;
-        ifft_out = dm->corr_dl_ifft_out;
-        sync_len = dm->dl_sync_len;
-    } else {
-        *direction = DIR_UPLINK;
-        corr_offset = offset_ul;
-        ifft_out = dm->corr_ul_ifft_out;
-        sync_len = dm->ul_sync_len;
-    }
-
-    *corr_result_out = ifft_out[corr_offset];
+/* Unique word position from the chosen peak; v holds the correlation
+ * just before, at and just after it, the neighbours only if interp */
+static int correlate_finish(burst_downmix_t *dm, ir_direction_t direction,
+                            int corr_offset, const float complex v[3],
+                            int interp, float *uw_start_correction,
+                            float complex *corr_result_out) {
+    *corr_result_out = v[1];
 
     /* Quadratic interpolation on correlation peak */
     float correction = 0;
-    if (corr_offset > 0 && corr_offset < search_len - 1) {
+    if (interp) {
         float re, im;
-        re = crealf(ifft_out[corr_offset - 1]);
-        im = cimagf(ifft_out[corr_offset - 1]);
+        re = crealf(v[0]);
+        im = cimagf(v[0]);
         float alpha = re * re + im * im;
 
-        re = crealf(ifft_out[corr_offset]);
-        im = cimagf(ifft_out[corr_offset]);
+        re = crealf(v[1]);
+        im = cimagf(v[1]);
         float beta = re * re + im * im;
 
-        re = crealf(ifft_out[corr_offset + 1]);
-        im = cimagf(ifft_out[corr_offset + 1]);
+        re = crealf(v[2]);
+        im = cimagf(v[2]);
         float gamma = re * re + im * im;
 
         float denom = alpha - 2.0f * beta + gamma;
@@ -626,58 +1124,225 @@ static int correlate_sync(burst_downmix_t *dm, const float complex *frame,
     }
     *uw_start_correction = correction;
 
+    int sync_len = (direction == DIR_DOWNLINK) ? dm->dl_sync_len : dm->ul_sync_len;
+
     /* Preamble starts at: corr_offset - sync_len + 1 */
     int preamble_offset = corr_offset - sync_len + 1;
 
-    /* UW starts after preamble (16 symbols for DL, 32 for UL) */
-    int preamble_symbols = (*direction == DIR_DOWNLINK)
-        ? IR_PREAMBLE_LENGTH_SHORT : 32;
+    /* UW starts after the template's preamble, which is 16 symbols in
+     * both directions, however long the burst's own preamble is */
     int uw_start = preamble_offset +
-                   (int)(preamble_symbols * dm->samples_per_symbol);
+                   (int)(IR_PREAMBLE_LENGTH_SHORT * dm->samples_per_symbol);
 
     return uw_start;
 }
 
-/* ---- Process one burst ---- */
+/* Pick the direction and unique word position from one burst's DL and
+ * UL correlations */
+static int correlate_peak(burst_downmix_t *dm, const float complex *dl_out,
+                          const float complex *ul_out, int frame_len,
+                          ir_direction_t *direction,
+                          float *uw_start_correction,
+                          float complex *corr_result_out) {
+    int search_len = dm->sync_search_len;
+    if (search_len > frame_len) search_len = frame_len;
 
-int burst_downmix_process(burst_downmix_t *dm, burst_data_t *burst,
-                          downmix_frame_t **frames_out) {
-    if (!burst || burst->num_samples < 100) {
-        *frames_out = NULL;
+    float max_dl, max_ul;
+    int offset_dl = correlate_argmax(dl_out, search_len, &max_dl);
+    int offset_ul = correlate_argmax(ul_out, search_len, &max_ul);
+
+    /* Select best direction */
+    int corr_offset;
+    const float complex *ifft_out;
+
+    if (max_dl >= max_ul) {
+        *direction = DIR_DOWNLINK;
+        corr_offset = offset_dl;
+        ifft_out = dl_out;
+    } else {
+        *direction = DIR_UPLINK;
+        corr_offset = offset_ul;
+        ifft_out = ul_out;
+    }
+
+    int interp = corr_offset > 0 && corr_offset < search_len - 1;
+    float complex v[3] = { 0, ifft_out[corr_offset], 0 };
+    if (interp) {
+        v[0] = ifft_out[corr_offset - 1];
+        v[2] = ifft_out[corr_offset + 1];
+    }
+    return correlate_finish(dm, *direction, corr_offset, v, interp,
+                            uw_start_correction, corr_result_out);
+}
+
+/* Correlation of the first n frame samples with one sync word at lag k,
+ * the same value the FFT path gives there */
+static float complex correlate_lag(const float complex *x,
+                                   const float complex *taps, int len, int k) {
+    int j0 = k - len + 1;
+    if (j0 >= 0)
+        return simd_dot_cc(x + j0, taps, len);
+    return simd_dot_cc(x, taps - j0, len + j0);
+}
+
+/* Best lag of one sync word in [lo, hi]: every SYNC_COARSE_STEP lags,
+ * then every lag around the best of those */
+static int correlate_window(const float complex *x, const float complex *taps,
+                            int len, int lo, int hi, float *max_out) {
+    float max = -1;
+    int best = lo;
+    for (int k = lo; k <= hi; k += SYNC_COARSE_STEP) {
+        float complex c = correlate_lag(x, taps, len, k);
+        float m = crealf(c) * crealf(c) + cimagf(c) * cimagf(c);
+        if (m > max) {
+            max = m;
+            best = k;
+        }
+    }
+
+    int f_lo = best - (SYNC_COARSE_STEP - 1);
+    int f_hi = best + (SYNC_COARSE_STEP - 1);
+    if (f_lo < lo) f_lo = lo;
+    if (f_hi > hi) f_hi = hi;
+    int coarse = best;
+    for (int k = f_lo; k <= f_hi; k++) {
+        if (k == coarse) continue;
+        float complex c = correlate_lag(x, taps, len, k);
+        float m = crealf(c) * crealf(c) + cimagf(c) * cimagf(c);
+        if (m > max || (m == max && k < best)) {
+            max = m;
+            best = k;
+        }
+    }
+    *max_out = max;
+    return best;
+}
+
+/* Time-domain correlation at only the lags where a preamble of 16, 32
+ * or 64 symbols puts the peak. Returns 0 if the best peak lands on the
+ * edge of its window, where the true peak may lie outside it, or is too
+ * weak a match to rule out a better one elsewhere; the caller then runs
+ * the full FFT search. */
+static int correlate_direct(burst_downmix_t *dm, const float complex *frame,
+                            int frame_len, ir_direction_t *direction,
+                            float *uw_start_correction,
+                            float complex *corr_result_out, int *uw_start) {
+    int search_len = dm->sync_search_len;
+    if (search_len > frame_len) search_len = frame_len;
+
+    float max_dl = -1, max_ul = -1;
+    int offset_dl = 0, offset_ul = 0, win_dl = -1, win_ul = -1;
+    for (int w = 0; w < SYNC_N_WINDOWS; w++) {
+        int lo = dm->sync_win_lo[w];
+        int hi = dm->sync_win_hi[w];
+        if (hi > search_len - 1) hi = search_len - 1;
+        if (lo > hi) continue;
+
+        float m;
+        int k = correlate_window(frame, dm->dl_sync_taps, dm->dl_sync_len,
+                                 lo, hi, &m);
+        if (m > max_dl) { max_dl = m; offset_dl = k; win_dl = w; }
+        k = correlate_window(frame, dm->ul_sync_taps, dm->ul_sync_len,
+                             lo, hi, &m);
+        if (m > max_ul) { max_ul = m; offset_ul = k; win_ul = w; }
+    }
+    if (win_dl < 0)
+        return 0;
+
+    int corr_offset, w;
+    const float complex *taps;
+    int len;
+    float max, energy;
+    if (max_dl >= max_ul) {
+        *direction = DIR_DOWNLINK;
+        corr_offset = offset_dl; w = win_dl; max = max_dl;
+        taps = dm->dl_sync_taps; len = dm->dl_sync_len;
+        energy = dm->dl_sync_energy;
+    } else {
+        *direction = DIR_UPLINK;
+        corr_offset = offset_ul; w = win_ul; max = max_ul;
+        taps = dm->ul_sync_taps; len = dm->ul_sync_len;
+        energy = dm->ul_sync_energy;
+    }
+
+    /* An edge the search range clipped is an edge of the full search too */
+    if ((corr_offset == dm->sync_win_lo[w] && corr_offset > 0) ||
+        (corr_offset == dm->sync_win_hi[w] && corr_offset < search_len - 1))
         return 0;
+
+    int j0 = corr_offset - len + 1;
+    if (j0 < 0) j0 = 0;
+    float in_energy = 0;
+    for (int j = j0; j <= corr_offset; j++)
+        in_energy += crealf(frame[j]) * crealf(frame[j]) +
+                     cimagf(frame[j]) * cimagf(frame[j]);
+    if (max < SYNC_DIRECT_MIN_RHO * energy * in_energy)
+        return 0;
+
+    int interp = corr_offset > 0 && corr_offset < search_len - 1;
+    float complex v[3] = { 0, correlate_lag(frame, taps, len, corr_offset), 0 };
+    if (interp) {
+        v[0] = correlate_lag(frame, taps, len, corr_offset - 1);
+        v[2] = correlate_lag(frame, taps, len, corr_offset + 1);
     }
+    *uw_start = correlate_finish(dm, *direction, corr_offset, v, interp,
+                                 uw_start_correction, corr_result_out);
+    return 1;
+}
+
+/* ---- Batch stages ----
+ *
+ * A burst is processed in three stages, split at the FFTs: front (steps
+ * 1-3 and the CFO FFT input), mid (steps 4-6) and back (steps 8-9), with
+ * the sync word search (step 7) between mid and back. Between stages the FFTs of every burst in
+ * the batch run together. A batch of one leaves the burst in the work
+ * buffers; larger batches copy each burst to its slot, since the work
+ * buffers are reused by the next burst's stage.
+ */
+
+/* Copy len samples to the slot's own buffer */
+static float complex *slot_store(dm_slot_t *s, const float complex *src,
+                                 int len) {
+    if (len > s->buf_cap) {
+        free(s->buf);
+        s->buf = malloc(sizeof(float complex) * len);
+        s->buf_cap = len;
+    }
+    memcpy(s->buf, src, len * sizeof(float complex));
+    return s->buf;
+}
+
+/* Steps 1-3; returns 0 if the burst yields no frame */
+static int downmix_front(burst_downmix_t *dm, burst_data_t *burst,
+                         dm_slot_t *s, float complex *cfo_in, int keep) {
+    if (!burst || burst->num_samples < 100)
+        return 0;
 
     int n = (int)burst->num_samples;
     if (n > dm->work_size) n = dm->work_size;
 
-    /* Copy burst samples to working buffer */
-    memcpy(dm->work_a, burst->samples, n * sizeof(float complex));
-
     double center_frequency = burst->center_frequency;
     int in_sample_rate = burst->sample_rate;
     /* Compute absolute timestamp: wall clock base + sample offset */
     uint64_t timestamp = burst->start_time_ns +
         (uint64_t)((double)burst->info.start / in_sample_rate * 1e9);
 
-    /* Step 1: Coarse CFO correction */
+    /* Steps 1+2: Coarse CFO correction fused with decimation to the output
+     * sample rate, reading straight from the ring view */
     float relative_freq = (burst->info.center_bin - burst->fft_size / 2)
                           / (float)burst->fft_size;
-    {
-        rotator_t r;
-        rotator_init(&r);
-        float phase_inc = -2.0f * (float)M_PI * relative_freq;
-        rotator_set_phase_incr(&r, cexpf(phase_inc * I));
-        rotator_rotate_n(&r, dm->work_a, dm->work_a, n);
-        center_frequency += relative_freq * in_sample_rate;
-    }
+    center_frequency += relative_freq * in_sample_rate;
 
-    /* Step 2: Decimate to output sample rate */
-    int dec_len = decimate_burst(dm, dm->work_a, n, dm->work_b,
-                                  in_sample_rate, &timestamp);
-    if (dec_len < 100) {
-        *frames_out = NULL;
+    if (in_sample_rate != dm->input_fir_rate)
+        design_input_fir(dm, in_sample_rate);
+    int skip = pre_burst_skip(dm, burst);
+
+    uint64_t t0 = pstats_now();
+    int dec_len = decimate_burst(dm, burst, n, skip, relative_freq,
+                                 dm->work_b, &timestamp);
+    pstats_stage(STAGE_DOWNMIX_FIR, t0);
+    if (dec_len < 100)
         return 0;
-    }
 
     /* Step 2b: Noise-limiting LPF */
     {
@@ -699,15 +1364,31 @@ int burst_downmix_process(burst_downmix_t *dm, burst_data_t *burst,
 
     /* Step 3: Find burst start */
     int start = find_burst_start(dm, dm->work_a, dec_len);
-    if (start >= dec_len - 100) {
-        *frames_out = NULL;
+    if (start >= dec_len - 100)
         return 0;
-    }
 
-    int frame_len = dec_len - start;
+    s->burst = burst;
+    s->timestamp = timestamp;
+    s->center_frequency = center_frequency;
+    s->start = start;
+    s->frame_len = dec_len - start;
+    s->frame = &dm->work_a[start];
+    if (keep)
+        s->frame = slot_store(s, s->frame, s->frame_len);
+
+    fine_cfo_input(dm, s->frame, s->frame_len, cfo_in, fine_cfo_sq(dm, s));
+    return 1;
+}
+
+/* Steps 4-6, given the burst's CFO spectrum */
+static void downmix_mid(burst_downmix_t *dm, dm_slot_t *s,
+                        const float complex *cfo_out, int keep) {
+    int frame_len = s->frame_len;
 
     /* Step 4: Fine CFO estimation */
-    float center_offset = estimate_fine_cfo(dm, &dm->work_a[start], frame_len);
+    float center_offset = (dm->fine_cfo == FINE_CFO_ZOOM)
+        ? fine_cfo_zoom(dm, cfo_out, fine_cfo_sq(dm, s))
+        : fine_cfo_peak(dm, cfo_out);
 
     /* Step 5: Fine CFO correction */
     {
@@ -715,8 +1396,8 @@ int burst_downmix_process(burst_downmix_t *dm, burst_data_t *burst,
         rotator_init(&r);
         float phase_inc = -2.0f * (float)M_PI * center_offset;
         rotator_set_phase_incr(&r, cexpf(phase_inc * I));
-        rotator_rotate_n(&r, dm->work_b, &dm->work_a[start], frame_len);
-        center_frequency += center_offset * dm->output_sample_rate;
+        rotator_rotate_n(&r, dm->work_b, s->frame, frame_len);
+        s->center_frequency += center_offset * dm->output_sample_rate;
     }
 
     /* Step 6: RRC matched filtering */
@@ -733,35 +1414,35 @@ int burst_downmix_process(burst_downmix_t *dm, burst_data_t *burst,
         fir_filter_ccf(dm->rrc_fir, dm->work_b, dm->work_a, frame_len);
     }
 
-    /* Step 7: Sync word correlation */
-    ir_direction_t direction;
-    float uw_start_correction;
-    float complex corr_result;
-    int uw_start = correlate_sync(dm, dm->work_b, frame_len,
-                                   &direction, &uw_start_correction,
-                                   &corr_result);
+    s->frame = dm->work_b;
+    if (keep)
+        s->frame = slot_store(s, s->frame, frame_len);
+}
 
-    if (uw_start < 0 || uw_start >= frame_len) {
-        *frames_out = NULL;
-        return 0;
-    }
+/* Steps 8-9, after the sync word search; returns NULL if no frame fits */
+static downmix_frame_t *downmix_back(burst_downmix_t *dm, dm_slot_t *s) {
+    int frame_len = s->frame_len;
+    int uw_start = s->uw_start;
+
+    if (uw_start < 0 || uw_start >= frame_len)
+        return NULL;
 
     /* Step 8: Phase alignment */
     {
-        float mag = cabsf(corr_result);
+        float mag = cabsf(s->corr_result);
         float complex phase_correction = (mag > 0)
-            ? conjf(corr_result / mag) : 1.0f;
+            ? conjf(s->corr_result / mag) : 1.0f;
 
         rotator_t r;
         rotator_init(&r);
         rotator_set_phase(&r, phase_correction);
         rotator_set_phase_incr(&r, 1.0f);
-        rotator_rotate_n(&r, dm->work_a, dm->work_b, frame_len);
+        rotator_rotate_n(&r, dm->work_a, s->frame, frame_len);
     }
 
     /* Step 9: Frame extraction */
     int max_frame_len, min_frame_len;
-    if (center_frequency > IR_SIMPLEX_FREQUENCY_MIN) {
+    if (s->center_frequency > IR_SIMPLEX_FREQUENCY_MIN) {
         max_frame_len = (int)(IR_MAX_FRAME_LENGTH_SIMPLEX * dm->samples_per_symbol);
         min_frame_len = (int)(IR_MIN_FRAME_LENGTH_SIMPLEX * dm->samples_per_symbol);
     } else {
@@ -770,59 +1451,139 @@ int burst_downmix_process(burst_downmix_t *dm, burst_data_t *burst,
     }
 
     int available = frame_len - uw_start;
-    if (available < min_frame_len) {
-        *frames_out = NULL;
-        return 0;
-    }
+    if (available < min_frame_len)
+        return NULL;
 
     int extract_len = available < max_frame_len ? available : max_frame_len;
 
     /* Build output frame */
-    downmix_frame_t *frame = malloc(sizeof(*frame));
+    burst_data_t *burst = s->burst;
+    downmix_frame_t *frame = downmix_frame_alloc(extract_len);
+    if (!frame)
+        return NULL;
     frame->id = burst->info.id;
-    frame->timestamp = timestamp + (uint64_t)((double)start / dm->output_sample_rate * 1e9);
-    frame->center_frequency = center_frequency;
+    frame->timestamp = s->timestamp + (uint64_t)((double)s->start / dm->output_sample_rate * 1e9);
+    frame->center_frequency = s->center_frequency;
     frame->sample_rate = (float)dm->output_sample_rate;
     frame->samples_per_symbol = dm->samples_per_symbol;
-    frame->direction = direction;
+    frame->direction = s->direction;
     frame->magnitude = burst->info.magnitude;
     frame->noise = burst->info.noise;
-    frame->uw_start = uw_start_correction;
-    frame->num_samples = extract_len;
-    frame->samples = malloc(sizeof(float complex) * extract_len);
+    frame->uw_start = s->uw_start_correction;
     memcpy(frame->samples, &dm->work_a[uw_start], extract_len * sizeof(float complex));
 
-    *frames_out = frame;
-    return 1;
+    return frame;
 }
 
-/* ---- Thread function ---- */
+/* ---- Frames ---- */
 
-void *burst_downmix_thread(void *arg) {
-    burst_downmix_t *dm = (burst_downmix_t *)arg;
+/* Samples start on the first 32-byte boundary after the struct */
+#define FRAME_SAMPLES_OFFSET \
+    ((sizeof(downmix_frame_t) + 31) & ~(size_t)31)
 
-    while (1) {
-        burst_data_t *burst;
-        if (blocking_queue_take(&burst_queue, &burst) != 0)
-            break;
+downmix_frame_t *downmix_frame_alloc(size_t num_samples) {
+    downmix_frame_t *frame = frame_pool_alloc(FRAME_SAMPLES_OFFSET +
+                                              num_samples * sizeof(float complex));
+    if (!frame)
+        return NULL;
+    frame->num_samples = num_samples;
+    frame->samples = (float complex *)((char *)frame + FRAME_SAMPLES_OFFSET);
+    return frame;
+}
 
-        downmix_frame_t *frames = NULL;
-        int n_frames = burst_downmix_process(dm, burst, &frames);
+void downmix_frame_free(downmix_frame_t *frame) {
+    frame_pool_free(frame);
+}
 
-        if (n_frames > 0 && frames) {
-            /* Push frame to queue (process returns a single malloc'd frame) */
-            if (blocking_queue_add(&frame_queue, frames) == BQ_FULL) {
-                free(frames->samples);
-                free(frames);
-            }
-        } else {
-            free(frames);
+/* ---- Process bursts ---- */
+
+int burst_downmix_batch_max(const burst_downmix_t *dm) {
+    return dm->batch_max;
+}
+
+int burst_downmix_process_batch(burst_downmix_t *dm, burst_data_t **bursts,
+                                int n_bursts, downmix_frame_t **frames_out) {
+    if (n_bursts > dm->batch_max) n_bursts = dm->batch_max;
+    int keep = n_bursts > 1;
+    int cfo_row = dm->cfo_fft.size;
+    int corr_row = dm->corr_fft_size;
+
+    /* Steps 1-3, then every CFO FFT */
+    int live = 0;
+    for (int i = 0; i < n_bursts; i++) {
+        frames_out[i] = NULL;
+        dm_slot_t *s = &dm->slots[live];
+        if (downmix_front(dm, bursts[i], s, dm->cfo_fft_in + (size_t)live * cfo_row,
+                          keep)) {
+            s->out = i;
+            live++;
+        }
+    }
+    if (live == 0)
+        return 0;
+
+    float complex *cfo_out = batch_fft_run(dm, &dm->cfo_fft, dm->cfo_fft_in,
+                                           dm->cfo_fft_out, live);
+
+    /* Steps 4-6 */
+    for (int j = 0; j < live; j++)
+        downmix_mid(dm, &dm->slots[j], cfo_out + (size_t)j * cfo_row, keep);
+
+    /* Step 7: Sync word correlation. Direct first where enabled; the
+     * bursts it misses get FFT rows, DL and UL side by side (or one
+     * packed row each). */
+    uint64_t t0 = pstats_now();
+    int fft_slot[DOWNMIX_BATCH_MAX];
+    int n_fft = 0;
+    for (int j = 0; j < live; j++) {
+        dm_slot_t *s = &dm->slots[j];
+        if (dm->sync_corr == SYNC_CORR_AUTO &&
+            correlate_direct(dm, s->frame, s->frame_len, &s->direction,
+                             &s->uw_start_correction, &s->corr_result,
+                             &s->uw_start)) {
+            atomic_fetch_add(&stat_sync_direct, 1);
+            continue;
         }
+        correlate_input(dm, s->frame, s->frame_len,
+                        dm->corr_fwd_in + (size_t)n_fft * corr_row);
+        fft_slot[n_fft++] = j;
+    }
 
-        free(burst->samples);
-        free(burst);
+    if (n_fft > 0) {
+        int inv_rows = dm->sync_corr == SYNC_CORR_PACKED ? 1 : 2;
+        float complex *fwd = batch_fft_run(dm, &dm->corr_fwd, dm->corr_fwd_in,
+                                           dm->corr_fwd_out, n_fft);
+        for (int j = 0; j < n_fft; j++) {
+            float complex *dl = dm->corr_ifft_in + (size_t)inv_rows * j * corr_row;
+            correlate_multiply(dm, fwd + (size_t)j * corr_row, dl, dl + corr_row);
+        }
+        float complex *inv = batch_fft_run(dm, &dm->corr_inv, dm->corr_ifft_in,
+                                           dm->corr_ifft_out, inv_rows * n_fft);
+        for (int j = 0; j < n_fft; j++) {
+            dm_slot_t *s = &dm->slots[fft_slot[j]];
+            const float complex *dl = inv + (size_t)inv_rows * j * corr_row;
+            const float complex *ul = (inv_rows == 1) ? dl + dm->ul_pack_offset
+                                                      : dl + corr_row;
+            s->uw_start = correlate_peak(dm, dl, ul, s->frame_len,
+                                         &s->direction, &s->uw_start_correction,
+                                         &s->corr_result);
+        }
+        atomic_fetch_add(&stat_sync_fft, n_fft);
+    }
+    pstats_stage(STAGE_SYNC, t0);
+
+    /* Steps 8-9 */
+    int n_frames = 0;
+    for (int j = 0; j < live; j++) {
+        dm_slot_t *s = &dm->slots[j];
+        frames_out[s->out] = downmix_back(dm, s);
+        if (frames_out[s->out])
+            n_frames++;
     }
+    return n_frames;
+}
 
-    burst_downmix_destroy(dm);
-    return NULL;
+int burst_downmix_process(burst_downmix_t *dm, burst_data_t *burst,
+                          downmix_frame_t **frames_out) {
+    return burst_downmix_process_batch(dm, &burst, 1, frames_out);
 }
@@ -53,26 +53,73 @@ typedef struct {
 /* Downmix context (opaque, holds FFT plans and filters) */
 typedef struct _burst_downmix burst_downmix_t;
 
+/* Most bursts one burst_downmix_process_batch() call takes */
+#define DOWNMIX_BATCH_MAX 64
+
+/* How burst_downmix finds the sync word */
+typedef enum {
+    SYNC_CORR_AUTO = 0,         /* direct around the expected peaks, FFT if missed */
+    SYNC_CORR_FFT,              /* FFT correlation, DL and UL rows per burst */
+    SYNC_CORR_PACKED,           /* FFT correlation, DL and UL in one row */
+} sync_corr_t;
+
+/* How burst_downmix estimates the fine CFO */
+typedef enum {
+    FINE_CFO_FFT = 0,           /* oversampled FFT of the squared burst */
+    FINE_CFO_ZOOM,              /* short FFT, then a DFT around its peak */
+} fine_cfo_t;
+
+/* Arithmetic of the first input decimation stage */
+typedef enum {
+    INPUT_FIR_FLOAT = 0,        /* shift to float complex, then filter */
+    INPUT_FIR_Q15,              /* filter int8/int16 views in fixed point */
+} input_fir_t;
+
 /* Configuration */
 typedef struct {
     int output_sample_rate;     /* 0 = auto (based on sps * symbol_rate) */
     int search_depth;           /* max samples to search for burst start */
     int handle_multiple_frames; /* allow multiple frames per burst */
+    int batch_size;             /* bursts per batch, 0 or 1 = one at a time */
+    int use_gpu;                /* run batched FFTs on the GPU (USE_GPU) */
+    int sync_corr;              /* sync_corr_t */
+    int fine_cfo;               /* fine_cfo_t */
+    int input_fir;              /* input_fir_t */
 } downmix_config_t;
 
+/* Allocate a frame with room for num_samples samples in the same block
+ * (from frame_pool.h). Returns NULL if out of memory. */
+downmix_frame_t *downmix_frame_alloc(size_t num_samples);
+
+/* Free a frame from downmix_frame_alloc(); NULL is a no-op */
+void downmix_frame_free(downmix_frame_t *frame);
+
 /* Create a downmix context */
 burst_downmix_t *burst_downmix_create(downmix_config_t *config);
 
 /* Process one burst, returns array of frames (may be >1 if multi-frame).
- * Caller owns returned frames and must free samples and frame array.
+ * Caller owns returned frames and frees each with downmix_frame_free().
  * Returns number of frames (0 if burst could not be processed). */
 int burst_downmix_process(burst_downmix_t *dm, burst_data_t *burst,
                           downmix_frame_t **frames_out);
 
+/* Process up to burst_downmix_batch_max() bursts together: the CFO and
+ * sync correlation FFTs of the whole batch run as one batched transform,
+ * on the GPU if the context has one. frames_out[i] is burst i's frame or
+ * NULL. Returns the number of frames. */
+int burst_downmix_process_batch(burst_downmix_t *dm, burst_data_t **bursts,
+                                int n_bursts, downmix_frame_t **frames_out);
+
+/* Batch size the context was created for */
+int burst_downmix_batch_max(const burst_downmix_t *dm);
+
 /* Destroy */
 void burst_downmix_destroy(burst_downmix_t *dm);
 
-/* Thread function: pulls from burst_queue, pushes frames to frame_queue */
-void *burst_downmix_thread(void *arg);
+/* Preamble and unique word of a downlink or uplink burst as symbols
+ * (s0 = 1+j, s1 = -1-j), the sequence the sync search correlates with.
+ * symbols needs room for preamble_len + IR_UW_LENGTH. Returns that count. */
+int burst_downmix_sync_symbols(int uplink, int preamble_len,
+                               float complex *symbols);
 
 #endif
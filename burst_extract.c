@@ -0,0 +1,187 @@
+/*
+ * Narrowband burst extraction -- mix each burst to DC and decimate it
+ * before it is queued for the downmix
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Narrowband burst extraction -- mix each burst to DC and decimate it
+ * before it is queued for the downmix
+ *
+ * The filter only has to protect what the downmix keeps: its own input
+ * FIR passes 0.4 and rejects from 0.6 * its output rate (10 sps), so the
+ * extraction filter passes half that rate and stops where a band would
+ * fold back onto it. Designs are made once per input rate and then only
+ * read, so the threads feeding the queue share them.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "burst_extract.h"
+#include "fir_filter.h"
+#include "iridium.h"
+#include "pipeline_stats.h"
+#include "rotator.h"
+#include "simd_kernels.h"
+
+/* Input samples rotated per pass through the filter */
+#define EXTRACT_BLOCK   8192
+
+/* Distinct input rates (one per detector or channelizer sub-band rate) */
+#define EXTRACT_MAX_RATES 4
+
+/* Rate the downmix decimates to */
+#define DOWNMIX_RATE    (IR_DEFAULT_SPS * IR_SYMBOLS_PER_SECOND)
+
+extern atomic_ulong stat_narrowband_bytes;
+
+typedef struct {
+    int in_rate;
+    int decimation;
+    fir_filter_t *fir;
+} extract_filter_t;
+
+static int extract_rate = 0;
+static extract_filter_t filters[EXTRACT_MAX_RATES];
+static int n_filters = 0;
+static pthread_mutex_t filters_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void burst_extract_init(int rate) {
+    extract_rate = rate;
+}
+
+/* Largest decimation that divides in_rate and keeps at least
+ * extract_rate, or 0 if that leaves nothing to gain */
+static int pick_decimation(int in_rate) {
+    if (in_rate < 2 * extract_rate)
+        return 0;
+    for (int d = in_rate / extract_rate; d >= 2; d--)
+        if (in_rate % d == 0)
+            return d;
+    return 0;
+}
+
+static const extract_filter_t *filter_for(int in_rate) {
+    const extract_filter_t *f = NULL;
+
+    pthread_mutex_lock(&filters_lock);
+    for (int i = 0; i < n_filters; i++) {
+        if (filters[i].in_rate == in_rate) {
+            f = &filters[i];
+            break;
+        }
+    }
+    if (!f && n_filters < EXTRACT_MAX_RATES) {
+        extract_filter_t *nf = &filters[n_filters++];
+        nf->in_rate = in_rate;
+        nf->decimation = pick_decimation(in_rate);
+        nf->fir = NULL;
+        if (nf->decimation) {
+            float out_rate = (float)in_rate / nf->decimation;
+            int ntaps;
+            float *taps = lpf_taps(&ntaps, 1.0f, (float)in_rate,
+                                   out_rate / 2.0f, out_rate - DOWNMIX_RATE);
+            nf->fir = fir_filter_create_dec(taps, ntaps, nf->decimation);
+            free(taps);
+        }
+        f = nf;
+    }
+    pthread_mutex_unlock(&filters_lock);
+
+    return f && f->fir ? f : NULL;
+}
+
+/* Rotate view samples [pos, pos + len) into out, converting them there
+ * first unless they are float complex in one piece of the view */
+static void rotate_view(rotator_t *r, const burst_data_t *burst, size_t pos,
+                        int len, float complex *out) {
+    rotator_rotate_n(r, out, burst_data_cf(burst, pos, len, out), len);
+}
+
+burst_data_t *burst_extract(burst_data_t *burst) {
+    if (!extract_rate || !burst)
+        return burst;
+
+    const extract_filter_t *f = filter_for(burst->sample_rate);
+    if (!f)
+        return burst;
+
+    uint64_t t0 = pstats_now();
+    int dec = f->decimation;
+    int ntaps = f->fir->ntaps;
+
+    /* Start on an input sample that is a multiple of the decimation, so
+     * the narrowband sample indices stay exact */
+    size_t lead = (dec - burst->info.start % dec) % dec;
+    if (burst->num_samples < lead + ntaps)
+        return burst;
+    size_t n_out = (burst->num_samples - lead - ntaps) / dec + 1;
+
+    /* One allocation, so burst_data_release() frees the samples too */
+    burst_data_t *nb = malloc(sizeof(*nb) + n_out * sizeof(float complex));
+    float complex *out = (float complex *)(nb + 1);
+    int cap = EXTRACT_BLOCK + ntaps;
+    float complex *buf = aligned_alloc_32(cap * sizeof(float complex));
+
+    float relative_freq = (burst->info.center_bin - burst->fft_size / 2)
+                          / (float)burst->fft_size;
+    rotator_t r;
+    rotator_init(&r);
+    rotator_set_phase_incr(&r, cexpf(-2.0f * (float)M_PI * relative_freq * I));
+
+    /* Same blockwise rotate-and-filter as the downmix's decimate_burst():
+     * the rotated full-rate burst never exists as a whole */
+    size_t pos = lead, done = 0;
+    int have = 0;
+    while (done < n_out) {
+        int want = cap - have;
+        if ((size_t)want > burst->num_samples - pos)
+            want = (int)(burst->num_samples - pos);
+        rotate_view(&r, burst, pos, want, buf + have);
+        pos += want;
+        have += want;
+
+        int n = (have - ntaps) / dec + 1;
+        if ((size_t)n > n_out - done) n = (int)(n_out - done);
+        if (n <= 0) break;
+        fir_filter_ccf_dec(f->fir, out + done, buf, n, dec);
+        done += n;
+
+        int used = n * dec;
+        have -= used;
+        memmove(buf, buf + used, have * sizeof(float complex));
+    }
+    free(buf);
+
+    *nb = *burst;
+    nb->info.start = (burst->info.start + lead) / dec;
+    nb->info.stop = burst->info.stop / dec;
+    nb->info.last_active = burst->info.last_active / dec;
+    nb->fft_size = burst->fft_size / dec;
+    nb->info.center_bin = nb->fft_size / 2;
+    nb->center_frequency = burst->center_frequency
+                         + relative_freq * burst->sample_rate;
+    nb->sample_rate = burst->sample_rate / dec;
+    /* Output k is centered on input start + lead + k * dec + ntaps / 2 */
+    nb->start_time_ns += (uint64_t)((double)(ntaps / 2) * 1e9
+                                    / burst->sample_rate);
+    nb->num_samples = done;
+    nb->format = SAMPLE_FMT_FLOAT;
+    nb->samples = out;
+    nb->split = done;
+    nb->wrap = NULL;
+    nb->arena = NULL;
+    nb->offset = 0;
+    burst_data_release(burst);
+
+    atomic_fetch_add(&stat_narrowband_bytes, done * sizeof(float complex));
+    pstats_stage(STAGE_EXTRACT, t0);
+    return nb;
+}
@@ -0,0 +1,41 @@
+/*
+ * Narrowband burst extraction -- mix each burst to DC and decimate it
+ * before it is queued for the downmix
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Narrowband burst extraction -- mix each burst to DC and decimate it
+ * before it is queued for the downmix
+ *
+ * A burst leaves the detector as a view of the full-band, full-rate ring,
+ * although it only occupies ~40 kHz of it. With extraction on, the thread
+ * that found the burst shifts its center bin to DC and runs the first
+ * decimating FIR stage straight out of the view, into a private buffer at
+ * a rate of at least the requested one. The view (and its hold on the
+ * ring) is released at once, and the downmix workers see a burst of a
+ * few hundred kHz centered on 0 Hz.
+ */
+
+#ifndef __BURST_EXTRACT_H__
+#define __BURST_EXTRACT_H__
+
+#include "burst_detect.h"
+
+/* Default --narrowband rate (Hz) */
+#define BURST_EXTRACT_DEFAULT_RATE  500000
+
+/* Extract every burst to at least rate Hz from now on; 0 = off. Call
+ * before the detector threads start. */
+void burst_extract_init(int rate);
+
+/* Narrowband copy of a full-rate burst. Takes ownership of burst and
+ * returns a burst that owns its samples, with the metadata rewritten for
+ * the new rate and center. The burst is returned as is when extraction
+ * is off or its rate is not at least twice the extraction rate. Safe to
+ * call from several threads. */
+burst_data_t *burst_extract(burst_data_t *burst);
+
+#endif
@@ -0,0 +1,546 @@
+/*
+ * Burst network link -- detected bursts from edge sniffers to a central one
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Burst network link
+ *
+ * The sender uses a blocking socket with a send timeout: it has nothing
+ * else to do, and a blocked send is exactly the backpressure the burst
+ * queue is built to absorb. A send that times out or fails leaves a
+ * record cut off, so the connection is closed and made again, with
+ * backoff, starting with a new hello.
+ *
+ * The receiver polls the listening socket and its edges' sockets and
+ * reads whatever has arrived into a per-edge buffer, which holds at most
+ * one record past the last complete one.
+ */
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <complex.h>
+#include <err.h>
+#include <errno.h>
+#include <math.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "burst_net.h"
+#include "burst_sched.h"
+#include "sdr.h"
+
+#define BURST_NET_HELLO_LEN     8
+#define BURST_NET_BATCH         16          /* bursts per queue take */
+#define BURST_NET_CHUNK         4096        /* samples converted at a time */
+#define BURST_NET_SEND_TIMEOUT  10          /* s, then the link is dead */
+#define BURST_NET_BACKOFF_MIN_MS 1000
+#define BURST_NET_BACKOFF_MAX_MS 30000
+#define BURST_NET_POLL_MS       100         /* running is checked this often */
+#define BURST_NET_SNDBUF        (4 << 20)
+
+_Static_assert(sizeof(burst_net_rec_t) == 80, "burst_net_rec_t layout");
+
+extern volatile sig_atomic_t running;
+extern burst_sched_t *burst_queue;
+
+extern atomic_ulong stat_burst_net_bursts;
+extern atomic_ulong stat_burst_net_bytes;
+extern atomic_ulong stat_burst_net_dropped;
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Split HOST:PORT (listen: [ADDR:]PORT) into host and port */
+static int split_spec(const char *spec, int listen, char *host, size_t cap,
+                      int *port) {
+    const char *colon = strrchr(spec, ':');
+    const char *port_str = colon ? colon + 1 : spec;
+    if (colon) {
+        size_t len = (size_t)(colon - spec);
+        if (len == 0 || len >= cap)
+            return -1;
+        memcpy(host, spec, len);
+        host[len] = '\0';
+    } else if (listen) {
+        snprintf(host, cap, "0.0.0.0");
+    } else {
+        return -1;
+    }
+    char *end;
+    long p = strtol(port_str, &end, 10);
+    if (*port_str == '\0' || *end != '\0' || p < 1 || p > 65535)
+        return -1;
+    *port = (int)p;
+    return 0;
+}
+
+int burst_net_parse(const char *spec, int listen) {
+    char host[256];
+    int port;
+    if (split_spec(spec, listen, host, sizeof(host), &port) != 0)
+        return -1;
+    struct in_addr a;
+    if (listen && inet_pton(AF_INET, host, &a) != 1)
+        return -1;
+    return 0;
+}
+
+/* ---- Edge: sender ---- */
+
+static struct {
+    char host[256];
+    int port;
+    int wait;
+    int fd;
+    int warned;
+    int backoff_ms;
+    uint64_t retry_at_ms;
+    uint8_t *buf;
+    size_t cap;
+    unsigned long n_sent, n_dropped, n_connects;
+} out = { .fd = -1 };
+
+void burst_net_out_init(const char *spec, int wait) {
+    if (split_spec(spec, 0, out.host, sizeof(out.host), &out.port) != 0)
+        errx(1, "--burst-out must be HOST:PORT (got '%s')", spec);
+    out.wait = wait;
+    out.backoff_ms = BURST_NET_BACKOFF_MIN_MS;
+}
+
+static void out_fail(const char *what) {
+    if (!out.warned)
+        fprintf(stderr, "burst-out: %s %s:%d, retrying with backoff\n",
+                what, out.host, out.port);
+    out.warned = 1;
+    if (out.fd >= 0)
+        close(out.fd);
+    out.fd = -1;
+    out.retry_at_ms = now_ms() + out.backoff_ms;
+    out.backoff_ms *= 2;
+    if (out.backoff_ms > BURST_NET_BACKOFF_MAX_MS)
+        out.backoff_ms = BURST_NET_BACKOFF_MAX_MS;
+}
+
+/* Write all of data; a signal does not cut a record short */
+static int send_all(int fd, const void *data, size_t len) {
+    const uint8_t *p = data;
+    while (len > 0) {
+        ssize_t r = send(fd, p, len, MSG_NOSIGNAL);
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        p += r;
+        len -= (size_t)r;
+    }
+    return 0;
+}
+
+static void out_connect(void) {
+    char port_str[16];
+    snprintf(port_str, sizeof(port_str), "%d", out.port);
+
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(out.host, port_str, &hints, &res) != 0 || !res) {
+        out_fail("cannot resolve");
+        return;
+    }
+    out.fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (out.fd < 0) {
+        freeaddrinfo(res);
+        out_fail("no socket for");
+        return;
+    }
+    int r = connect(out.fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (r != 0) {
+        out_fail("cannot connect to");
+        return;
+    }
+
+    struct timeval tv = { BURST_NET_SEND_TIMEOUT, 0 };
+    setsockopt(out.fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    int flag = 1, sndbuf = BURST_NET_SNDBUF;
+    setsockopt(out.fd, SOL_SOCKET, SO_KEEPALIVE, &flag, sizeof(flag));
+    setsockopt(out.fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+    uint8_t hello[BURST_NET_HELLO_LEN];
+    uint32_t version = BURST_NET_VERSION;
+    memcpy(hello, BURST_NET_MAGIC, 4);
+    memcpy(hello + 4, &version, 4);
+    if (send_all(out.fd, hello, sizeof(hello)) != 0) {
+        out_fail("lost connection to");
+        return;
+    }
+
+    out.backoff_ms = BURST_NET_BACKOFF_MIN_MS;
+    out.warned = 0;
+    out.n_connects++;
+    fprintf(stderr, "burst-out: connected to %s:%d\n", out.host, out.port);
+}
+
+/* Whether there is a connection to send on; file input waits for one */
+static int out_ready(void) {
+    while (out.fd < 0) {
+        uint64_t now = now_ms();
+        if (now >= out.retry_at_ms)
+            out_connect();
+        if (out.fd >= 0 || !out.wait || !running)
+            break;
+        usleep(BURST_NET_POLL_MS * 1000);
+    }
+    return out.fd >= 0;
+}
+
+/* Record for burst in out.buf: the header, then its samples as ci16
+ * scaled to the largest component. Returns the record's bytes. */
+static size_t encode(const burst_data_t *b) {
+    size_t n = b->num_samples;
+    size_t bytes = sizeof(burst_net_rec_t) + n * 2 * sizeof(int16_t);
+    if (bytes > out.cap) {
+        free(out.buf);
+        out.cap = bytes + bytes / 2;
+        out.buf = malloc(out.cap);
+        if (!out.buf)
+            errx(1, "Cannot allocate %zu bytes for --burst-out", out.cap);
+    }
+
+    float complex chunk[BURST_NET_CHUNK];
+    float peak = 0.0f;
+    for (size_t pos = 0; pos < n; pos += BURST_NET_CHUNK) {
+        size_t len = n - pos < BURST_NET_CHUNK ? n - pos : BURST_NET_CHUNK;
+        const float *f = (const float *)burst_data_cf(b, pos, len, chunk);
+        for (size_t i = 0; i < 2 * len; i++) {
+            float a = fabsf(f[i]);
+            if (a > peak)
+                peak = a;
+        }
+    }
+    float scale = peak > 0.0f ? peak / 32767.0f : 1.0f;
+    float inv = 1.0f / scale;
+
+    int16_t *q = (int16_t *)(out.buf + sizeof(burst_net_rec_t));
+    for (size_t pos = 0; pos < n; pos += BURST_NET_CHUNK) {
+        size_t len = n - pos < BURST_NET_CHUNK ? n - pos : BURST_NET_CHUNK;
+        const float *f = (const float *)burst_data_cf(b, pos, len, chunk);
+        for (size_t i = 0; i < 2 * len; i++)
+            q[2 * pos + i] = (int16_t)lrintf(f[i] * inv);
+    }
+
+    burst_net_rec_t rec = {
+        .length = (uint32_t)(bytes - sizeof(uint32_t)),
+        .num_samples = (uint32_t)n,
+        .id = b->info.id,
+        .start = b->info.start,
+        .stop = b->info.stop,
+        .last_active = b->info.last_active,
+        .start_time_ns = b->start_time_ns,
+        .center_frequency = b->center_frequency,
+        .sample_rate = b->sample_rate,
+        .fft_size = b->fft_size,
+        .center_bin = b->info.center_bin,
+        .magnitude = b->info.magnitude,
+        .noise = b->info.noise,
+        .scale = scale,
+    };
+    memcpy(out.buf, &rec, sizeof(rec));
+    return bytes;
+}
+
+static void send_burst(const burst_data_t *b) {
+    if (b->num_samples > BURST_NET_MAX_SAMPLES || !out_ready()) {
+        out.n_dropped++;
+        atomic_fetch_add(&stat_burst_net_dropped, 1);
+        return;
+    }
+    size_t bytes = encode(b);
+    if (send_all(out.fd, out.buf, bytes) != 0) {
+        out_fail("lost connection to");
+        out.n_dropped++;
+        atomic_fetch_add(&stat_burst_net_dropped, 1);
+        return;
+    }
+    out.n_sent++;
+    atomic_fetch_add(&stat_burst_net_bursts, 1);
+    atomic_fetch_add(&stat_burst_net_bytes, bytes);
+}
+
+void *burst_net_out_thread(void *arg) {
+    (void)arg;
+    burst_data_t *bursts[BURST_NET_BATCH];
+    unsigned n;
+
+    while ((n = burst_sched_take_batch(burst_queue, bursts,
+                                       BURST_NET_BATCH)) > 0) {
+        for (unsigned i = 0; i < n; i++) {
+            if (!bursts[i])
+                continue;
+            send_burst(bursts[i]);
+            burst_data_release(bursts[i]);
+        }
+    }
+    return NULL;
+}
+
+void burst_net_out_close(void) {
+    if (out.fd >= 0)
+        close(out.fd);
+    out.fd = -1;
+    free(out.buf);
+    out.buf = NULL;
+    fprintf(stderr, "burst-out: sent %lu bursts, dropped %lu (%lu connections)\n",
+            out.n_sent, out.n_dropped, out.n_connects);
+}
+
+/* ---- Central: receiver ---- */
+
+typedef struct {
+    int fd;
+    char name[64];              /* ADDR:PORT of the edge */
+    int hello;                  /* hello seen */
+    uint8_t *buf;
+    size_t len, cap;
+    unsigned long n_bursts;
+} edge_t;
+
+static int listen_fd = -1;
+static edge_t edges[BURST_NET_MAX_EDGES];
+
+void burst_net_in_open(const char *spec) {
+    char host[64];
+    int port;
+    struct sockaddr_in addr = { .sin_family = AF_INET };
+    if (split_spec(spec, 1, host, sizeof(host), &port) != 0 ||
+        inet_pton(AF_INET, host, &addr.sin_addr) != 1)
+        errx(1, "--burst-in must be [ADDR:]PORT (got '%s')", spec);
+    addr.sin_port = htons((uint16_t)port);
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+        err(1, "Cannot create TCP socket");
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+        err(1, "Cannot bind --burst-in to %s:%d", host, port);
+    if (listen(listen_fd, BURST_NET_MAX_EDGES) != 0)
+        err(1, "Cannot listen on %s:%d", host, port);
+    for (int i = 0; i < BURST_NET_MAX_EDGES; i++)
+        edges[i].fd = -1;
+    fprintf(stderr, "burst-in: listening on %s:%d\n", host, port);
+}
+
+static void edge_drop(edge_t *e, const char *why) {
+    fprintf(stderr, "burst-in: %s %s after %lu bursts\n",
+            e->name, why, e->n_bursts);
+    close(e->fd);
+    e->fd = -1;
+    e->len = 0;
+}
+
+static void accept_edge(void) {
+    struct sockaddr_in peer;
+    socklen_t plen = sizeof(peer);
+    int fd = accept(listen_fd, (struct sockaddr *)&peer, &plen);
+    if (fd < 0)
+        return;
+
+    edge_t *e = NULL;
+    for (int i = 0; i < BURST_NET_MAX_EDGES && !e; i++)
+        if (edges[i].fd < 0)
+            e = &edges[i];
+    char name[64];
+    char ip[INET_ADDRSTRLEN] = "?";
+    inet_ntop(AF_INET, &peer.sin_addr, ip, sizeof(ip));
+    snprintf(name, sizeof(name), "%s:%d", ip, ntohs(peer.sin_port));
+    if (!e) {
+        fprintf(stderr, "burst-in: refusing %s, already %d edges\n",
+                name, BURST_NET_MAX_EDGES);
+        close(fd);
+        return;
+    }
+
+    e->fd = fd;
+    memcpy(e->name, name, sizeof(name));
+    e->hello = 0;
+    e->len = 0;
+    e->n_bursts = 0;
+    fprintf(stderr, "burst-in: edge %s connected\n", e->name);
+}
+
+/* Burst owning its samples (as burst_extract() makes them) from a
+ * complete record */
+static burst_data_t *decode(const burst_net_rec_t *rec, const int16_t *q) {
+    size_t n = rec->num_samples;
+    burst_data_t *b = malloc(sizeof(*b) + n * sizeof(float complex));
+    if (!b)
+        return NULL;
+    float complex *s = (float complex *)(b + 1);
+    float *f = (float *)s;
+    for (size_t i = 0; i < 2 * n; i++)
+        f[i] = q[i] * rec->scale;
+
+    memset(b, 0, sizeof(*b));
+    b->info.id = rec->id;
+    b->info.start = rec->start;
+    b->info.stop = rec->stop;
+    b->info.last_active = rec->last_active;
+    b->info.center_bin = rec->center_bin;
+    b->info.magnitude = rec->magnitude;
+    b->info.noise = rec->noise;
+    b->center_frequency = rec->center_frequency;
+    b->sample_rate = rec->sample_rate;
+    b->fft_size = rec->fft_size;
+    b->start_time_ns = rec->start_time_ns;
+    b->num_samples = n;
+    b->format = SAMPLE_FMT_FLOAT;
+    b->samples = s;
+    b->split = n;
+    return b;
+}
+
+/* Queue the complete records in e's buffer. Returns -1 if the stream is
+ * not one this version understands. */
+static int parse_edge(edge_t *e) {
+    size_t pos = 0;
+
+    if (!e->hello) {
+        if (e->len < BURST_NET_HELLO_LEN)
+            return 0;
+        uint32_t version;
+        memcpy(&version, e->buf + 4, 4);
+        if (memcmp(e->buf, BURST_NET_MAGIC, 4) != 0 ||
+            version != BURST_NET_VERSION)
+            return -1;
+        e->hello = 1;
+        pos = BURST_NET_HELLO_LEN;
+    }
+
+    while (e->len - pos >= sizeof(burst_net_rec_t)) {
+        burst_net_rec_t rec;
+        memcpy(&rec, e->buf + pos, sizeof(rec));
+        size_t bytes = sizeof(rec) + (size_t)rec.num_samples * 2 * sizeof(int16_t);
+        if (rec.num_samples > BURST_NET_MAX_SAMPLES ||
+            rec.length != bytes - sizeof(uint32_t) || rec.sample_rate <= 0 ||
+            rec.fft_size <= 0)
+            return -1;
+        if (e->len - pos < bytes)
+            break;
+
+        /* The samples follow the 80-byte header, so they are aligned */
+        burst_data_t *b = decode(&rec, (const int16_t *)(e->buf + pos + sizeof(rec)));
+        pos += bytes;
+        if (!b)
+            continue;
+        e->n_bursts++;
+        atomic_fetch_add(&stat_burst_net_bursts, 1);
+        atomic_fetch_add(&stat_burst_net_bytes, bytes);
+        if (burst_sched_put(burst_queue, b) != 0)
+            burst_data_release(b);
+    }
+
+    memmove(e->buf, e->buf + pos, e->len - pos);
+    e->len -= pos;
+    return 0;
+}
+
+static void read_edge(edge_t *e) {
+    /* Room for the rest of the record in the buffer, or a header */
+    size_t want = sizeof(burst_net_rec_t);
+    if (e->hello && e->len >= sizeof(burst_net_rec_t)) {
+        burst_net_rec_t rec;
+        memcpy(&rec, e->buf, sizeof(rec));
+        want = sizeof(rec) + (size_t)rec.num_samples * 2 * sizeof(int16_t);
+    }
+    if (want < e->len + 65536)
+        want = e->len + 65536;
+    if (want > e->cap) {
+        uint8_t *nb = realloc(e->buf, want);
+        if (!nb) {
+            edge_drop(e, "dropped (out of memory)");
+            return;
+        }
+        e->buf = nb;
+        e->cap = want;
+    }
+
+    ssize_t r = recv(e->fd, e->buf + e->len, e->cap - e->len, 0);
+    if (r == 0) {
+        edge_drop(e, "disconnected");
+        return;
+    }
+    if (r < 0) {
+        if (errno != EINTR && errno != EAGAIN)
+            edge_drop(e, "lost");
+        return;
+    }
+    e->len += (size_t)r;
+    if (parse_edge(e) != 0)
+        edge_drop(e, "sent a malformed stream, dropped");
+}
+
+void *burst_net_in_thread(void *arg) {
+    (void)arg;
+    struct pollfd pfd[1 + BURST_NET_MAX_EDGES];
+    edge_t *who[1 + BURST_NET_MAX_EDGES];
+
+    while (running) {
+        int n = 0;
+        pfd[n].fd = listen_fd;
+        pfd[n].events = POLLIN;
+        who[n++] = NULL;
+        for (int i = 0; i < BURST_NET_MAX_EDGES; i++) {
+            if (edges[i].fd < 0)
+                continue;
+            pfd[n].fd = edges[i].fd;
+            pfd[n].events = POLLIN;
+            who[n++] = &edges[i];
+        }
+
+        if (poll(pfd, (nfds_t)n, BURST_NET_POLL_MS) <= 0)
+            continue;
+        for (int i = 0; i < n; i++) {
+            if (!(pfd[i].revents & (POLLIN | POLLERR | POLLHUP)))
+                continue;
+            if (who[i])
+                read_edge(who[i]);
+            else
+                accept_edge();
+        }
+    }
+    return NULL;
+}
+
+void burst_net_in_close(void) {
+    for (int i = 0; i < BURST_NET_MAX_EDGES; i++) {
+        edge_t *e = &edges[i];
+        if (e->fd >= 0) {
+            fprintf(stderr, "burst-in: %s sent %lu bursts\n",
+                    e->name, e->n_bursts);
+            close(e->fd);
+            e->fd = -1;
+        }
+        free(e->buf);
+        e->buf = NULL;
+    }
+    if (listen_fd >= 0)
+        close(listen_fd);
+    listen_fd = -1;
+}
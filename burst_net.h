@@ -0,0 +1,91 @@
+/*
+ * Burst network link -- detected bursts from edge sniffers to a central one
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Burst network link -- detected bursts from edge sniffers to a central one
+ *
+ * Splits the pipeline between hosts. An edge process (--burst-out) runs
+ * the detector and narrowband extraction next to the antenna, and a sender
+ * thread takes the place of the downmix pool: it drains the burst queue
+ * and writes each burst to a TCP connection. A central process
+ * (--burst-in) accepts up to BURST_NET_MAX_EDGES edges; a receiver thread
+ * takes the place of the detectors and puts their bursts on one burst
+ * queue, for one downmix and demod pool.
+ *
+ * A connection starts with an 8-byte hello, "IRBN" and a u32
+ * BURST_NET_VERSION, followed by one record per burst: a
+ * burst_net_rec_t, then num_samples ci16 samples. All fields are in host
+ * byte order (little endian on every supported platform). The samples
+ * are block floating point: multiplied by scale they give the burst at
+ * its extracted rate, its largest component at full scale, about half
+ * the bytes of the cf32 the downmix would have read.
+ *
+ * Nothing waits on the network but the sender. A slow link backs the
+ * edge's burst queue up, which sheds by value as it does for a slow
+ * downmix; while there is no connection, bursts are dropped and counted
+ * (file input waits for the connection instead). The central's queue
+ * blocks rather than sheds, so a central that cannot keep up slows the
+ * edges' connections down and the shedding happens at the edges.
+ */
+
+#ifndef __BURST_NET_H__
+#define __BURST_NET_H__
+
+#include <stdint.h>
+
+#define BURST_NET_MAGIC         "IRBN"
+#define BURST_NET_VERSION       1
+
+/* Most edges one central process takes at once */
+#define BURST_NET_MAX_EDGES     16
+
+/* Longest burst a record may carry (samples) */
+#define BURST_NET_MAX_SAMPLES   (1 << 20)
+
+typedef struct {
+    uint32_t length;            /* bytes after this field */
+    uint32_t num_samples;
+    uint64_t id;
+    uint64_t start;             /* burst_info_t sample indices, at */
+    uint64_t stop;              /* sample_rate */
+    uint64_t last_active;
+    uint64_t start_time_ns;     /* ns at sample index 0 */
+    double center_frequency;    /* Hz */
+    int32_t sample_rate;        /* Hz */
+    int32_t fft_size;
+    int32_t center_bin;
+    float magnitude;            /* dB */
+    float noise;                /* dBFS/Hz */
+    float scale;                /* ci16 sample value to float */
+} burst_net_rec_t;
+
+/* Check a --burst-out HOST:PORT or --burst-in [ADDR:]PORT spec: 0 if it
+ * is usable, else -1 */
+int burst_net_parse(const char *spec, int listen);
+
+/* Edge: send bursts to the central at spec (HOST:PORT). wait: keep
+ * retrying the connection rather than drop bursts while it is down (file
+ * input). Call before burst_net_out_thread() starts. */
+void burst_net_out_init(const char *spec, int wait);
+
+/* Drain the burst queue into the connection until the queue is closed
+ * and empty */
+void *burst_net_out_thread(void *arg);
+
+/* Close the connection and print what was sent and dropped */
+void burst_net_out_close(void);
+
+/* Central: bind and listen on spec ([ADDR:]PORT); exits on failure */
+void burst_net_in_open(const char *spec);
+
+/* Accept edges and queue their bursts until running clears */
+void *burst_net_in_thread(void *arg);
+
+/* Close every connection and print what each edge sent */
+void burst_net_in_close(void);
+
+#endif
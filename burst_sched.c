@@ -0,0 +1,474 @@
+/*
+ * Burst scheduler -- byte-budgeted burst queue with priority load shedding
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Entries sit on a FIFO list, which takes follow. Bursts (not wake-ups)
+ * are also kept in a binary min-heap on their value, so the burst to shed
+ * is always at the root and is unlinked from both in O(log n). Shed
+ * bursts are released after the lock is dropped.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "burst_sched.h"
+#include "iridium.h"
+#include "sdr.h"
+
+extern atomic_ulong stat_n_dropped;
+extern atomic_ulong stat_shed_simplex;
+extern atomic_ulong stat_shed_duplex;
+
+typedef struct sched_node {
+    burst_data_t *burst;        /* NULL for a wake-up */
+    size_t bytes;
+    float key[SHED_CRITERIA];   /* larger is more valuable */
+    int simplex;
+    int heap;                   /* index in the heap, -1 for a wake-up */
+    struct sched_node *next;
+} sched_node_t;
+
+struct burst_sched {
+    pthread_mutex_t lock;
+    pthread_cond_t nonempty;
+    pthread_cond_t space;
+
+    sched_node_t *head, *tail;  /* FIFO of every entry */
+    sched_node_t **heap;        /* bursts, least valuable at [0] */
+    unsigned n_heap;
+    unsigned depth;             /* entries on the FIFO */
+    unsigned max_bursts;
+    size_t bytes;
+    size_t budget;
+    int shed;
+    int closed;
+
+    int order[SHED_CRITERIA];
+    int n_order;
+};
+
+static const char *criterion_names[SHED_CRITERIA] = {
+    [SHED_SIMPLEX] = "simplex",
+    [SHED_SNR] = "snr",
+    [SHED_SHORT] = "short",
+};
+
+int burst_sched_parse_order(const char *spec, int order[SHED_CRITERIA])
+{
+    char buf[64];
+    if (strlen(spec) >= sizeof(buf))
+        return -1;
+    strcpy(buf, spec);
+
+    int n = 0, seen = 0;
+    char *save = NULL;
+    for (char *tok = strtok_r(buf, ",", &save); tok;
+         tok = strtok_r(NULL, ",", &save)) {
+        int c;
+        for (c = 0; c < SHED_CRITERIA; c++)
+            if (strcmp(tok, criterion_names[c]) == 0)
+                break;
+        if (c == SHED_CRITERIA || (seen & (1 << c)))
+            return -1;
+        seen |= 1 << c;
+        order[n++] = c;
+    }
+    return n > 0 ? n : -1;
+}
+
+burst_sched_t *burst_sched_create(unsigned max_bursts, size_t budget, int shed,
+                                  const int *order, int n_order)
+{
+    burst_sched_t *q = calloc(1, sizeof(*q));
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->nonempty, NULL);
+    pthread_cond_init(&q->space, NULL);
+    q->heap = malloc(max_bursts * sizeof(*q->heap));
+    q->max_bursts = max_bursts;
+    q->budget = budget;
+    q->shed = shed;
+    q->n_order = n_order;
+    memcpy(q->order, order, n_order * sizeof(*order));
+    return q;
+}
+
+/* ---- Heap on value ---- */
+
+/* a is worth less than b */
+static int less(const burst_sched_t *q, const sched_node_t *a,
+                const sched_node_t *b)
+{
+    for (int i = 0; i < q->n_order; i++) {
+        if (a->key[i] != b->key[i])
+            return a->key[i] < b->key[i];
+    }
+    return 0;
+}
+
+static void heap_set(burst_sched_t *q, unsigned i, sched_node_t *n)
+{
+    q->heap[i] = n;
+    n->heap = (int)i;
+}
+
+static void sift_up(burst_sched_t *q, unsigned i)
+{
+    sched_node_t *n = q->heap[i];
+    while (i > 0) {
+        unsigned parent = (i - 1) / 2;
+        if (!less(q, n, q->heap[parent]))
+            break;
+        heap_set(q, i, q->heap[parent]);
+        i = parent;
+    }
+    heap_set(q, i, n);
+}
+
+static void sift_down(burst_sched_t *q, unsigned i)
+{
+    sched_node_t *n = q->heap[i];
+    for (;;) {
+        unsigned c = 2 * i + 1;
+        if (c >= q->n_heap)
+            break;
+        if (c + 1 < q->n_heap && less(q, q->heap[c + 1], q->heap[c]))
+            c++;
+        if (!less(q, q->heap[c], n))
+            break;
+        heap_set(q, i, q->heap[c]);
+        i = c;
+    }
+    heap_set(q, i, n);
+}
+
+static void heap_remove(burst_sched_t *q, sched_node_t *n)
+{
+    unsigned i = (unsigned)n->heap;
+    sched_node_t *last = q->heap[--q->n_heap];
+    n->heap = -1;
+    if (last == n)
+        return;
+    heap_set(q, i, last);
+    sift_up(q, i);
+    sift_down(q, (unsigned)last->heap);
+}
+
+/* ---- FIFO ---- */
+
+static void fifo_append(burst_sched_t *q, sched_node_t *n)
+{
+    n->next = NULL;
+    if (q->tail)
+        q->tail->next = n;
+    else
+        q->head = n;
+    q->tail = n;
+    q->depth++;
+}
+
+/* Unlink n, found by a walk: sheds are rare next to takes */
+static void fifo_unlink(burst_sched_t *q, sched_node_t *n)
+{
+    sched_node_t **p = &q->head, *prev = NULL;
+    while (*p != n) {
+        prev = *p;
+        p = &(*p)->next;
+    }
+    *p = n->next;
+    if (q->tail == n)
+        q->tail = prev;
+    q->depth--;
+}
+
+/* Caller holds the lock and the FIFO is not empty */
+static sched_node_t *fifo_pop(burst_sched_t *q)
+{
+    sched_node_t *n = q->head;
+    q->head = n->next;
+    if (!q->head)
+        q->tail = NULL;
+    q->depth--;
+    if (n->heap >= 0) {
+        heap_remove(q, n);
+        q->bytes -= n->bytes;
+        pthread_cond_signal(&q->space);
+    }
+    return n;
+}
+
+/* ---- Queue operations ---- */
+
+static size_t burst_bytes(const burst_data_t *b)
+{
+    size_t per = b->format == SAMPLE_FMT_FLOAT ? 8 :
+                 b->format == SAMPLE_FMT_INT16 ? 4 : 2;
+    return b->num_samples * per;
+}
+
+static void fill_key(sched_node_t *n, const burst_data_t *b, const burst_sched_t *q)
+{
+    double freq = b->center_frequency
+                + (b->info.center_bin - b->fft_size / 2)
+                  * (double)b->sample_rate / b->fft_size;
+    n->simplex = freq >= IR_SIMPLEX_FREQUENCY_MIN;
+
+    for (int i = 0; i < q->n_order; i++) {
+        switch (q->order[i]) {
+        case SHED_SIMPLEX:
+            n->key[i] = (float)n->simplex;
+            break;
+        case SHED_SNR:
+            n->key[i] = b->info.magnitude;
+            break;
+        case SHED_SHORT:
+            n->key[i] = -(float)b->num_samples / (float)b->sample_rate;
+            break;
+        }
+    }
+}
+
+static int full(const burst_sched_t *q, size_t bytes)
+{
+    return q->n_heap > 0 &&
+           (q->n_heap >= q->max_bursts || q->bytes + bytes > q->budget);
+}
+
+static void count_shed(const sched_node_t *n)
+{
+    atomic_fetch_add(&stat_n_dropped, 1);
+    atomic_fetch_add(n->simplex ? &stat_shed_simplex : &stat_shed_duplex, 1);
+}
+
+static sched_node_t *node_new(burst_sched_t *q, burst_data_t *burst)
+{
+    sched_node_t *n = malloc(sizeof(*n));
+    n->burst = burst;
+    n->bytes = burst_bytes(burst);
+    fill_key(n, burst, q);
+    return n;
+}
+
+/* Queue n with the lock held, chaining what is shed onto *shed. Returns
+ * -1 if the queue is closed (n is left to the caller). */
+static int put_locked(burst_sched_t *q, sched_node_t *n, sched_node_t **shed)
+{
+    if (!q->shed) {
+        while (!q->closed && full(q, n->bytes))
+            pthread_cond_wait(&q->space, &q->lock);
+    }
+    if (q->closed)
+        return -1;
+
+    /* Make room from the least valuable end, unless the new burst is
+     * itself the least valuable */
+    while (full(q, n->bytes)) {
+        sched_node_t *min = q->heap[0];
+        if (!less(q, min, n)) {
+            n->next = *shed;
+            *shed = n;
+            return 0;
+        }
+        heap_remove(q, min);
+        fifo_unlink(q, min);
+        q->bytes -= min->bytes;
+        min->next = *shed;
+        *shed = min;
+    }
+
+    heap_set(q, q->n_heap++, n);
+    sift_up(q, q->n_heap - 1);
+    fifo_append(q, n);
+    q->bytes += n->bytes;
+    return 0;
+}
+
+static void release_shed(sched_node_t *shed)
+{
+    while (shed) {
+        sched_node_t *next = shed->next;
+        count_shed(shed);
+        burst_data_release(shed->burst);
+        free(shed);
+        shed = next;
+    }
+}
+
+int burst_sched_put(burst_sched_t *q, burst_data_t *burst)
+{
+    sched_node_t *n = node_new(q, burst);
+    sched_node_t *shed = NULL;  /* nodes to release, chained on next */
+
+    pthread_mutex_lock(&q->lock);
+    int ret = put_locked(q, n, &shed);
+    if (ret == 0)
+        pthread_cond_signal(&q->nonempty);
+    pthread_mutex_unlock(&q->lock);
+
+    if (ret != 0)
+        free(n);
+    release_shed(shed);
+    return ret;
+}
+
+unsigned burst_sched_put_batch(burst_sched_t *q, burst_data_t **bursts,
+                               unsigned n)
+{
+    sched_node_t *nodes[BURST_SCHED_BATCH_MAX];
+    sched_node_t *shed = NULL;
+    unsigned done = 0;
+
+    while (done < n) {
+        unsigned k = n - done < BURST_SCHED_BATCH_MAX ?
+                     n - done : BURST_SCHED_BATCH_MAX;
+        for (unsigned i = 0; i < k; i++)
+            nodes[i] = node_new(q, bursts[done + i]);
+
+        unsigned put = 0;
+        pthread_mutex_lock(&q->lock);
+        while (put < k && put_locked(q, nodes[put], &shed) == 0)
+            put++;
+        if (put > 0)
+            pthread_cond_broadcast(&q->nonempty);
+        pthread_mutex_unlock(&q->lock);
+
+        done += put;
+        if (put < k) {
+            for (unsigned i = put; i < k; i++)
+                free(nodes[i]);
+            break;
+        }
+    }
+    release_shed(shed);
+    return done;
+}
+
+int burst_sched_take(burst_sched_t *q, burst_data_t **burst)
+{
+    pthread_mutex_lock(&q->lock);
+    while (!q->head && !q->closed)
+        pthread_cond_wait(&q->nonempty, &q->lock);
+    if (!q->head) {
+        pthread_mutex_unlock(&q->lock);
+        return -1;
+    }
+    sched_node_t *n = fifo_pop(q);
+    pthread_mutex_unlock(&q->lock);
+
+    *burst = n->burst;
+    free(n);
+    return 0;
+}
+
+unsigned burst_sched_take_batch(burst_sched_t *q, burst_data_t **bursts,
+                                unsigned max)
+{
+    sched_node_t *run = NULL, **link = &run;
+    unsigned n = 0;
+
+    pthread_mutex_lock(&q->lock);
+    while (!q->head && !q->closed)
+        pthread_cond_wait(&q->nonempty, &q->lock);
+
+    /* A leading run of bursts, or a wake-up on its own */
+    while (q->head && n < max) {
+        if (n > 0 && !q->head->burst)
+            break;
+        sched_node_t *e = fifo_pop(q);
+        *link = e;
+        link = &e->next;
+        n++;
+        if (!e->burst)
+            break;
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    *link = NULL;
+    for (unsigned i = 0; i < n; i++) {
+        sched_node_t *next = run->next;
+        bursts[i] = run->burst;
+        free(run);
+        run = next;
+    }
+    return n;
+}
+
+void burst_sched_wake(burst_sched_t *q)
+{
+    sched_node_t *n = calloc(1, sizeof(*n));
+    n->heap = -1;
+
+    pthread_mutex_lock(&q->lock);
+    fifo_append(q, n);
+    pthread_cond_signal(&q->nonempty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+int burst_sched_sheds(const burst_sched_t *q)
+{
+    return q->shed;
+}
+
+unsigned burst_sched_shed_if(burst_sched_t *q,
+                             int (*match)(const burst_data_t *, void *),
+                             void *arg)
+{
+    sched_node_t *shed = NULL;
+    unsigned n = 0;
+
+    pthread_mutex_lock(&q->lock);
+    sched_node_t **p = &q->head, *prev = NULL;
+    while (*p) {
+        sched_node_t *e = *p;
+        if (!e->burst || !match(e->burst, arg)) {
+            prev = e;
+            p = &e->next;
+            continue;
+        }
+        *p = e->next;
+        if (q->tail == e)
+            q->tail = prev;
+        q->depth--;
+        heap_remove(q, e);
+        q->bytes -= e->bytes;
+        e->next = shed;
+        shed = e;
+        n++;
+    }
+    if (n > 0)
+        pthread_cond_broadcast(&q->space);
+    pthread_mutex_unlock(&q->lock);
+
+    release_shed(shed);
+    return n;
+}
+
+unsigned burst_sched_depth(burst_sched_t *q)
+{
+    pthread_mutex_lock(&q->lock);
+    unsigned depth = q->depth;
+    pthread_mutex_unlock(&q->lock);
+    return depth;
+}
+
+size_t burst_sched_bytes(burst_sched_t *q)
+{
+    pthread_mutex_lock(&q->lock);
+    size_t bytes = q->bytes;
+    pthread_mutex_unlock(&q->lock);
+    return bytes;
+}
+
+void burst_sched_close(burst_sched_t *q)
+{
+    pthread_mutex_lock(&q->lock);
+    q->closed = 1;
+    pthread_cond_broadcast(&q->nonempty);
+    pthread_cond_broadcast(&q->space);
+    pthread_mutex_unlock(&q->lock);
+}
@@ -0,0 +1,94 @@
+/*
+ * Burst scheduler -- byte-budgeted burst queue with priority load shedding
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Burst scheduler -- byte-budgeted burst queue with priority load shedding
+ *
+ * Sits between the detectors and the downmix pool in place of a plain
+ * blocking queue. Bursts leave in arrival order, but the queue is bounded
+ * by the bytes its bursts' views pin as well as by their number: one long
+ * burst at 10 MHz holds as much as hundreds of short ones.
+ *
+ * When a new burst does not fit, a shedding queue (live capture) drops the
+ * queued or new burst of least value until it does; a waiting queue (file
+ * input) blocks the detector instead, so nothing is lost. Value compares
+ * the criteria of the shed order in turn: simplex band above duplex,
+ * higher SNR, shorter burst. Sheds are counted per band.
+ */
+
+#ifndef __BURST_SCHED_H__
+#define __BURST_SCHED_H__
+
+#include <stddef.h>
+
+#include "burst_detect.h"
+
+/* Value criteria, compared in the order given */
+typedef enum {
+    SHED_SIMPLEX = 0,       /* simplex band (IRA, messaging) first */
+    SHED_SNR,               /* higher SNR first */
+    SHED_SHORT,             /* shorter bursts first */
+    SHED_CRITERIA,
+} shed_criterion_t;
+
+#define SHED_ORDER_DEFAULT  "simplex,snr,short"
+
+/* Most bursts burst_sched_put_batch() queues per lock round-trip */
+#define BURST_SCHED_BATCH_MAX   64
+
+typedef struct burst_sched burst_sched_t;
+
+/* Parse a comma-separated shed order (names of shed_criterion_t, each at
+ * most once) into order. Returns the number of criteria, or -1. */
+int burst_sched_parse_order(const char *spec, int order[SHED_CRITERIA]);
+
+/* Create a queue holding at most max_bursts bursts and budget bytes of
+ * samples. shed: drop the least valuable burst when full instead of
+ * blocking burst_sched_put(). */
+burst_sched_t *burst_sched_create(unsigned max_bursts, size_t budget, int shed,
+                                  const int *order, int n_order);
+
+/* Queue a burst. Returns 0 if the queue took it (it may have been shed),
+ * or -1 if the queue is closed and the caller still owns it. */
+int burst_sched_put(burst_sched_t *q, burst_data_t *burst);
+
+/* Queue n bursts in order, taking the lock once per BURST_SCHED_BATCH_MAX.
+ * Returns how many the queue took; the caller still owns the rest, which
+ * a closed queue refused. */
+unsigned burst_sched_put_batch(burst_sched_t *q, burst_data_t **bursts,
+                               unsigned n);
+
+/* Take the oldest entry, waiting for one. Returns 0, or -1 once the queue
+ * is closed and empty. *burst is NULL for a wake-up. */
+int burst_sched_take(burst_sched_t *q, burst_data_t **burst);
+
+/* Take up to max of the oldest entries in one lock round-trip, waiting
+ * for one: a run of bursts, or a single NULL wake-up. Returns how many,
+ * or 0 once the queue is closed and empty. */
+unsigned burst_sched_take_batch(burst_sched_t *q, burst_data_t **bursts,
+                                unsigned max);
+
+/* Queue a NULL entry for a worker; never shed, never blocks */
+void burst_sched_wake(burst_sched_t *q);
+
+/* 1 if full puts shed, 0 if they wait */
+int burst_sched_sheds(const burst_sched_t *q);
+
+/* Shed every queued burst that match(burst, arg) accepts, counted like
+ * any other shed. Returns how many. */
+unsigned burst_sched_shed_if(burst_sched_t *q,
+                             int (*match)(const burst_data_t *, void *),
+                             void *arg);
+
+/* Entries and sample bytes queued now */
+unsigned burst_sched_depth(burst_sched_t *q);
+size_t burst_sched_bytes(burst_sched_t *q);
+
+/* Wake every waiter; takes drain what is left, puts fail */
+void burst_sched_close(burst_sched_t *q);
+
+#endif
@@ -0,0 +1,598 @@
+/*
+ * Wideband channelizer
+ *
+ * Splits the capture into K half-overlapping sub-bands with one polyphase
+ * filter bank on the dispatcher thread and feeds each to its own burst
+ * detector on a channel thread.
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Wideband channelizer
+ *
+ * Splits the capture into K half-overlapping sub-bands with one polyphase
+ * filter bank on the dispatcher thread and feeds each to its own burst
+ * detector on a channel thread.
+ *
+ * Channel k is centered at (k + 1/2 - K/2) * fs/K from the capture center,
+ * so no channel sits on the SDR LO. The input is shifted down by half a
+ * channel once, which puts every center on a bin of a K-point DFT. Every
+ * D = K/2 input samples the commutator steps: the newest n_taps samples
+ * are weighted by the prototype LPF and folded into K branch sums, and one
+ * K-point FFT of the branches gives the next sample of all K sub-bands.
+ * That is the mix-filter-decimate of each channel rearranged, so the bank
+ * costs about one FIR at the input rate plus an FFT per D samples, where
+ * a mixer and FIR per channel cost K times the input rate. Since D is K/2,
+ * the sub-band sample n of an odd bin carries a sign of (-1)^n.
+ *
+ * The detector of each sub-band only starts bursts in its own fs/K wide
+ * channel; the other half of the sub-band is guard band that keeps edge
+ * bursts intact, and bursts there are tracked as foreign so they are not
+ * started again. All detectors share one wall clock origin (corrected for
+ * the filter delay) and one interleaved burst ID space, so downstream
+ * stages see a single detector.
+ */
+
+#define _GNU_SOURCE
+#include <complex.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <fftw3.h>
+
+#include "burst_sched.h"
+#include "channelizer.h"
+#include "fftw_plans.h"
+#include "fir_filter.h"
+#include "iridium.h"
+#include "pipeline_stats.h"
+#include "placement.h"
+#include "rotator.h"
+#include "sample_pool.h"
+#include "sdr.h"
+#include "simd_kernels.h"
+
+#include "mpmc_ring.h"
+
+#define CHAN_EDGE_HISTORY 64    /* edge bursts held / remembered for de-dup */
+#define CHAN_EDGE_BINS  3       /* detector bins apart that are one burst */
+#define PFB_BATCH       64      /* filter bank outputs per FFTW call */
+
+/* Filter bank output for one input buffer, shared by all channel threads:
+ * channel k reads out[k * stride ..] */
+typedef struct {
+    atomic_int refs;
+    float complex *out;
+    size_t num;                 /* samples per channel */
+    size_t stride;
+} chan_block_t;
+
+/* A burst found close to a channel boundary */
+typedef struct {
+    int channel;
+    double frequency;           /* Hz from capture center */
+    double tolerance;           /* Hz within which a copy is the same burst */
+    uint64_t start;             /* sub-band sample indices (common clock) */
+    uint64_t stop;
+    burst_data_t *burst;        /* while held back */
+} chan_edge_t;
+
+typedef struct {
+    channelizer_t *ch;
+    int index;
+    double offset;              /* channel center - capture center, Hz */
+    double own_lo, own_hi;      /* owned range, Hz from capture center */
+    int bin;                    /* filter bank FFT bin of the center */
+    burst_detector_t *det;
+    mpmc_ring_t queue;
+    pthread_t thread;
+    atomic_ulong n_fed;         /* sub-band samples run through the detector */
+} chan_sub_t;
+
+struct _channelizer {
+    int n_channels;
+    int sample_rate;
+    double center_frequency;
+    double burst_width;         /* Hz */
+    uint64_t delay_ns;          /* FIR group delay */
+    uint64_t start_time_ns;     /* time of input sample 0, 0 = first block */
+    chan_sub_t sub[CHANNELIZER_MAX];
+
+    /* Polyphase filter bank (dispatcher thread) */
+    int decimation;
+    rotator_t rot;              /* half a channel down: centers on bins */
+    float *taps;                /* prototype LPF reversed, zero-padded to a
+                                 * multiple of K, each tap twice (I, Q):
+                                 * [2 * n_taps] */
+    int n_taps;
+    float complex *hist;        /* shifted input, n_taps - 1 samples of
+                                 * history first */
+    size_t hist_len;
+    size_t hist_cap;
+    float complex *converted;   /* integer input as float */
+    size_t converted_cap;
+    uint64_t n_out;             /* sub-band samples so far, for the sign */
+    fftwf_plan plan_batch;      /* PFB_BATCH K-point inverse FFTs */
+    fftwf_plan plan_one;
+    float complex *fold;        /* [PFB_BATCH][K] branch sums */
+    float complex *bins;        /* [PFB_BATCH][K] their FFTs */
+
+    /* Bursts near a boundary can still be found by both neighbours, when
+     * each sees its peak on its own side in the first frame. They are held
+     * until the other channels have caught up, then the detection that
+     * started earliest wins. Only detections a few bins apart are the same
+     * burst: neighbouring channels can carry simultaneous bursts that
+     * Doppler has brought within a burst width of each other. */
+    pthread_mutex_t edge_lock;
+    chan_edge_t pending[CHAN_EDGE_HISTORY];
+    int n_pending;
+    chan_edge_t edges[CHAN_EDGE_HISTORY];   /* recently emitted, ring */
+    int edge_next;
+    unsigned long n_dedup;
+};
+
+extern mpmc_ring_t samples_queue;
+extern burst_sched_t *burst_queue;
+extern int verbose;
+
+static void block_release(chan_block_t *b) {
+    if (atomic_fetch_sub(&b->refs, 1) == 1) {
+        free(b->out);
+        free(b);
+    }
+}
+
+/* ---- Setup ---- */
+
+channelizer_t *channelizer_create(int n_channels, const burst_config_t *config) {
+    if (n_channels < 2 || n_channels > CHANNELIZER_MAX || n_channels % 2) {
+        fprintf(stderr, "channelizer: channel count must be even, 2..%d\n",
+                CHANNELIZER_MAX);
+        return NULL;
+    }
+
+    int decimation = n_channels / 2;
+    if (config->sample_rate % decimation) {
+        fprintf(stderr, "channelizer: sample rate %d is not divisible by %d\n",
+                config->sample_rate, decimation);
+        return NULL;
+    }
+
+    double spacing = (double)config->sample_rate / n_channels;
+    double margin = config->burst_width > 0 ? config->burst_width
+                                            : IR_DEFAULT_BURST_WIDTH;
+
+    /* Flat to the channel edge plus one burst width, and down before the
+     * image of the far sub-band edge folds back into the channel */
+    float cutoff = (float)spacing;
+    float transition = (float)(spacing - 2 * margin);
+    if (transition <= 0) {
+        fprintf(stderr, "channelizer: %d channels of %.0f Hz are too narrow\n",
+                n_channels, spacing);
+        return NULL;
+    }
+
+    int ntaps;
+    float *taps = lpf_taps(&ntaps, 1.0f, (float)config->sample_rate,
+                           cutoff, transition);
+
+    channelizer_t *ch = calloc(1, sizeof(*ch));
+    ch->n_channels = n_channels;
+    ch->sample_rate = config->sample_rate;
+    ch->center_frequency = config->center_frequency;
+    ch->burst_width = margin;
+    pthread_mutex_init(&ch->edge_lock, NULL);
+    for (int i = 0; i < CHAN_EDGE_HISTORY; i++)
+        ch->edges[i].channel = -1;
+    ch->delay_ns = (uint64_t)((ntaps - 1) / 2) * 1000000000ULL
+                   / config->sample_rate;
+
+    ch->decimation = decimation;
+    ch->n_taps = (ntaps + n_channels - 1) / n_channels * n_channels;
+    ch->taps = calloc(2 * ch->n_taps, sizeof(float));
+    for (int i = 0; i < ntaps; i++) {
+        ch->taps[2 * (ch->n_taps - 1 - i)] = taps[i];
+        ch->taps[2 * (ch->n_taps - 1 - i) + 1] = taps[i];
+    }
+    ch->hist_cap = ch->n_taps - 1;
+    ch->hist = calloc(ch->hist_cap, sizeof(float complex));
+    ch->hist_len = ch->n_taps - 1;  /* zero history: output m is at input m*D */
+    rotator_init(&ch->rot);
+    rotator_set_phase_incr(&ch->rot,
+        cexpf(-I * (float)M_PI / (float)n_channels));
+    ch->plan_batch = fftw_plan_shared_many(n_channels, PFB_BATCH,
+                                           FFTW_BACKWARD);
+    ch->plan_one = fftw_plan_shared_dft_1d(n_channels, FFTW_BACKWARD);
+    ch->fold = fftwf_alloc_complex((size_t)PFB_BATCH * n_channels);
+    ch->bins = fftwf_alloc_complex((size_t)PFB_BATCH * n_channels);
+
+    double lo = config->lo_frequency != 0 ? config->lo_frequency
+                                          : config->center_frequency;
+    double band_lo = -config->sample_rate / 2.0 + margin / 2;
+    double band_hi = config->sample_rate / 2.0 - margin / 2;
+
+    for (int k = 0; k < n_channels; k++) {
+        chan_sub_t *s = &ch->sub[k];
+        s->ch = ch;
+        s->index = k;
+        s->offset = (k + 0.5 - n_channels / 2.0) * spacing;
+        s->bin = (k + n_channels / 2) % n_channels;
+
+        /* Own [offset - spacing/2, offset + spacing/2), clipped to the part
+         * of the capture a single detector would have searched */
+        double own_lo = s->offset - spacing / 2;
+        double own_hi = s->offset + spacing / 2;
+        if (own_lo < band_lo) own_lo = band_lo;
+        if (own_hi > band_hi) own_hi = band_hi;
+        s->own_lo = own_lo;
+        s->own_hi = own_hi;
+
+        burst_config_t c = *config;
+        c.center_frequency = config->center_frequency + s->offset;
+        c.sample_rate = config->sample_rate / decimation;
+        c.fft_size = config->fft_size / decimation;
+        c.burst_pre_len = config->burst_pre_len / decimation;
+        c.burst_post_len = config->burst_post_len / decimation;
+        c.trim_margin = config->trim_margin / decimation;
+        c.max_burst_len = config->max_burst_len / decimation;
+        c.lo_frequency = lo;
+        c.peak_low = own_lo - s->offset;
+        c.peak_high = own_hi - s->offset;
+        c.id_index = config->id_index * n_channels + k;
+        c.id_count = (config->id_count > 0 ? config->id_count : 1) * n_channels;
+        s->det = burst_detector_create(&c);
+        atomic_init(&s->n_fed, 0);
+        mpmc_ring_init(&s->queue, CHANNELIZER_QUEUE_SIZE);
+    }
+    free(taps);
+
+    if (verbose)
+        fprintf(stderr, "channelizer: %d channels of %.0f Hz, sub-band rate "
+                "%d Hz, %d-tap polyphase LPF (delay %.1f us)\n",
+                n_channels, spacing, config->sample_rate / decimation,
+                ntaps, ch->delay_ns / 1000.0);
+
+    return ch;
+}
+
+void channelizer_set_start_time(channelizer_t *ch, uint64_t ns) {
+    ch->start_time_ns = ns;
+}
+
+burst_detector_t *channelizer_detector(channelizer_t *ch, int k) {
+    return ch->sub[k].det;
+}
+
+static void channelizer_destroy(channelizer_t *ch) {
+    if (verbose)
+        fprintf(stderr, "channelizer: dropped %lu duplicate edge bursts\n",
+                ch->n_dedup);
+    for (int k = 0; k < ch->n_channels; k++) {
+        chan_sub_t *s = &ch->sub[k];
+        burst_detector_destroy(s->det);
+        mpmc_ring_destroy(&s->queue);
+    }
+    fftw_plan_release(ch->plan_batch);
+    fftw_plan_release(ch->plan_one);
+    fftwf_free(ch->fold);
+    fftwf_free(ch->bins);
+    free(ch->taps);
+    free(ch->hist);
+    free(ch->converted);
+    pthread_mutex_destroy(&ch->edge_lock);
+    free(ch);
+}
+
+/* ---- Channel thread ---- */
+
+static int edge_overlap(const chan_edge_t *a, const chan_edge_t *b) {
+    double tolerance = fmax(a->tolerance, b->tolerance);
+    return a->channel != b->channel &&
+           fabs(a->frequency - b->frequency) <= tolerance &&
+           a->start <= b->stop && b->start <= a->stop;
+}
+
+/* Queue a held burst unless a neighbour already emitted the same one
+ * (caller holds edge_lock) */
+static void edge_emit(channelizer_t *ch, chan_edge_t *e) {
+    for (int i = 0; i < CHAN_EDGE_HISTORY; i++) {
+        if (ch->edges[i].channel >= 0 && edge_overlap(&ch->edges[i], e)) {
+            burst_data_release(e->burst);
+            ch->n_dedup++;
+            return;
+        }
+    }
+    ch->edges[ch->edge_next] = *e;
+    ch->edges[ch->edge_next].burst = NULL;
+    ch->edge_next = (ch->edge_next + 1) % CHAN_EDGE_HISTORY;
+    burst_to_queue(e->burst, burst_queue);
+}
+
+/* A held burst is decided once every other channel has run far enough
+ * past its end to have emitted its own copy, or once its own channel is
+ * half a second ahead (a stalled neighbour must not pin the ring) */
+static int edge_ready(channelizer_t *ch, const chan_edge_t *e) {
+    const burst_data_t *b = e->burst;
+    if (atomic_load(&ch->sub[e->channel].n_fed) > e->stop + b->sample_rate / 2)
+        return 1;
+    for (int k = 0; k < ch->n_channels; k++)
+        if (k != e->channel &&
+            atomic_load(&ch->sub[k].n_fed) < e->stop + 8 * (uint64_t)b->fft_size)
+            return 0;
+    return 1;
+}
+
+static void edge_remove(channelizer_t *ch, int i) {
+    ch->pending[i] = ch->pending[--ch->n_pending];
+}
+
+/* Resolve held bursts that are ready (all of them if force is set);
+ * caller holds edge_lock */
+static void edge_flush(channelizer_t *ch, int force) {
+    int i = 0;
+    while (i < ch->n_pending) {
+        chan_edge_t *e = &ch->pending[i];
+        if (!force && !edge_ready(ch, e)) {
+            i++;
+            continue;
+        }
+
+        /* Keep the copy that starts first (it has the whole preamble) */
+        int j;
+        for (j = 0; j < ch->n_pending; j++)
+            if (j != i && edge_overlap(e, &ch->pending[j]))
+                break;
+        if (j < ch->n_pending) {
+            chan_edge_t *o = &ch->pending[j];
+            int drop = o->start < e->start ||
+                       (o->start == e->start &&
+                        o->burst->info.magnitude > e->burst->info.magnitude)
+                     ? i : j;
+            burst_data_release(ch->pending[drop].burst);
+            ch->n_dedup++;
+            edge_remove(ch, drop);
+            i = 0;
+            continue;
+        }
+
+        edge_emit(ch, e);
+        edge_remove(ch, i);
+    }
+}
+
+static void channel_burst(burst_data_t *burst, void *user) {
+    chan_sub_t *s = (chan_sub_t *)user;
+    channelizer_t *ch = s->ch;
+    double freq = burst->center_frequency - ch->center_frequency
+                + (burst->info.center_bin - burst->fft_size / 2)
+                  * (double)burst->sample_rate / burst->fft_size;
+
+    if (freq - s->own_lo > ch->burst_width && s->own_hi - freq > ch->burst_width) {
+        burst_to_queue(burst, burst_queue);
+        return;
+    }
+
+    pthread_mutex_lock(&ch->edge_lock);
+    if (ch->n_pending == CHAN_EDGE_HISTORY) {
+        edge_emit(ch, &ch->pending[0]);
+        edge_remove(ch, 0);
+    }
+    ch->pending[ch->n_pending++] = (chan_edge_t){
+        .channel = s->index,
+        .frequency = freq,
+        .tolerance = CHAN_EDGE_BINS * (double)burst->sample_rate
+                     / burst->fft_size,
+        .start = burst->info.start,
+        .stop = burst->info.stop,
+        .burst = burst,
+    };
+    pthread_mutex_unlock(&ch->edge_lock);
+}
+
+static void channel_process(chan_sub_t *s, const float complex *in, size_t n) {
+    burst_detector_feed_cf(s->det, in, n, channel_burst, s);
+    atomic_fetch_add(&s->n_fed, n);
+
+    pthread_mutex_lock(&s->ch->edge_lock);
+    edge_flush(s->ch, 0);
+    pthread_mutex_unlock(&s->ch->edge_lock);
+}
+
+static void *channel_thread(void *arg) {
+    chan_sub_t *s = (chan_sub_t *)arg;
+
+    while (1) {
+        chan_block_t *b;
+        if (mpmc_ring_take(&s->queue, &b) != 0)
+            break;
+        channel_process(s, b->out + s->index * b->stride, b->num);
+        block_release(b);
+    }
+    return NULL;
+}
+
+/* ---- Dispatcher thread ---- */
+
+#define PFB_INLINE static inline __attribute__((always_inline))
+
+/* Commutator and FIR branches for the output whose window starts at x, on
+ * interleaved I/Q floats: branch r sums taps r, r + K, ... back from the
+ * newest sample. With the taps reversed (and doubled for I and Q), window
+ * samples c*K + t belong to branch K - 1 - t. */
+PFB_INLINE void pfb_fold_n(int n_ch, int n_taps, const float *taps,
+                           const float *x, float *branch) {
+    float acc[2 * CHANNELIZER_MAX] = { 0 };
+    for (int c = 0; c < 2 * n_taps; c += 2 * n_ch)
+        for (int t = 0; t < 2 * n_ch; t++)
+            acc[t] += taps[c + t] * x[c + t];
+    for (int t = 0; t < n_ch; t++) {
+        branch[2 * (n_ch - 1 - t)] = acc[2 * t];
+        branch[2 * (n_ch - 1 - t) + 1] = acc[2 * t + 1];
+    }
+}
+
+/* A constant K keeps the branch sums in registers */
+static void pfb_fold(const channelizer_t *ch, const float complex *x,
+                     float complex *branch) {
+    const float *xf = (const float *)x;
+    float *bf = (float *)branch;
+    switch (ch->n_channels) {
+    case 2:  pfb_fold_n(2, ch->n_taps, ch->taps, xf, bf); break;
+    case 4:  pfb_fold_n(4, ch->n_taps, ch->taps, xf, bf); break;
+    case 8:  pfb_fold_n(8, ch->n_taps, ch->taps, xf, bf); break;
+    case 16: pfb_fold_n(16, ch->n_taps, ch->taps, xf, bf); break;
+    default: pfb_fold_n(ch->n_channels, ch->n_taps, ch->taps, xf, bf); break;
+    }
+}
+
+/* Run the filter bank over n input samples. Returns their sub-band
+ * samples, or NULL while the window is not yet full. */
+static chan_block_t *pfb_process(channelizer_t *ch, const float complex *in,
+                                 size_t n) {
+    size_t total = ch->hist_len + n;
+    if (total > ch->hist_cap) {
+        float complex *h = aligned_alloc_32(sizeof(float complex) * total);
+        memcpy(h, ch->hist, sizeof(float complex) * ch->hist_len);
+        free(ch->hist);
+        ch->hist = h;
+        ch->hist_cap = total;
+    }
+    rotator_rotate_n(&ch->rot, ch->hist + ch->hist_len, in, (int)n);
+
+    if (total < (size_t)ch->n_taps) {
+        ch->hist_len = total;
+        return NULL;
+    }
+
+    int n_ch = ch->n_channels;
+    int dec = ch->decimation;
+    size_t n_out = (total - ch->n_taps) / dec + 1;
+    chan_block_t *b = malloc(sizeof(*b));
+    atomic_init(&b->refs, n_ch);
+    b->num = n_out;
+    b->stride = (n_out + 3) & ~(size_t)3;
+    b->out = aligned_alloc_32(sizeof(float complex) * b->stride * n_ch);
+
+    for (size_t i = 0; i < n_out; i += PFB_BATCH) {
+        int batch = n_out - i < PFB_BATCH ? (int)(n_out - i) : PFB_BATCH;
+        for (int j = 0; j < batch; j++)
+            pfb_fold(ch, ch->hist + (i + j) * dec, ch->fold + j * n_ch);
+        if (batch == PFB_BATCH) {
+            fftwf_execute_dft(ch->plan_batch, ch->fold, ch->bins);
+        } else {
+            for (int j = 0; j < batch; j++)
+                fftwf_execute_dft(ch->plan_one, ch->fold + j * n_ch,
+                                  ch->bins + j * n_ch);
+        }
+
+        /* Bin m turns by -2 pi m D / K = -pi m a sample */
+        uint64_t m0 = ch->n_out + i;
+        for (int k = 0; k < n_ch; k++) {
+            const float complex *y = ch->bins + ch->sub[k].bin;
+            float complex *out = b->out + k * b->stride + i;
+            if (ch->sub[k].bin & 1) {
+                for (int j = 0; j < batch; j++)
+                    out[j] = ((m0 + j) & 1) ? -y[j * n_ch] : y[j * n_ch];
+            } else {
+                for (int j = 0; j < batch; j++)
+                    out[j] = y[j * n_ch];
+            }
+        }
+    }
+    ch->n_out += n_out;
+
+    size_t consumed = n_out * dec;
+    ch->hist_len = total - consumed;
+    memmove(ch->hist, ch->hist + consumed, sizeof(float complex) * ch->hist_len);
+    return b;
+}
+
+void *channelizer_thread(void *arg) {
+    channelizer_t *ch = (channelizer_t *)arg;
+    int started = 0;
+
+    /* Dispatcher first, sub-band detectors after it */
+    placement_pin_self(PLACE_DETECTOR, 0);
+    for (int k = 0; k < ch->n_channels; k++) {
+        pthread_create(&ch->sub[k].thread, NULL, channel_thread, &ch->sub[k]);
+        placement_pin(ch->sub[k].thread, PLACE_DETECTOR, 1 + k);
+#ifdef __linux__
+        char name[16];
+        snprintf(name, sizeof(name), "chan-%d", k);
+        pthread_setname_np(ch->sub[k].thread, name);
+#endif
+    }
+
+    while (1) {
+        sample_buf_t *samples;
+        uint64_t t0 = pstats_now();
+        if (mpmc_ring_take(&samples_queue, &samples) != 0)
+            break;
+        pstats_take_wait(PQ_SAMPLES, t0);
+
+        /* Common time origin; sub-band sample 0 lags input sample 0 by the
+         * filter delay */
+        if (!started) {
+            uint64_t t0 = ch->start_time_ns;
+            if (t0 == 0) {
+                struct timespec ts;
+                clock_gettime(CLOCK_REALTIME, &ts);
+                t0 = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+            }
+            for (int k = 0; k < ch->n_channels; k++)
+                burst_detector_set_start_time(ch->sub[k].det, t0 - ch->delay_ns);
+            started = 1;
+        }
+
+        const float complex *in;
+        if (samples->format == SAMPLE_FMT_FLOAT) {
+            in = (const float complex *)sample_buf_data(samples);
+        } else {
+            if (samples->num > ch->converted_cap) {
+                free(ch->converted);
+                ch->converted_cap = samples->num;
+                ch->converted = aligned_alloc_32(sizeof(float complex)
+                                                 * ch->converted_cap);
+            }
+            if (samples->format == SAMPLE_FMT_INT16)
+                simd_convert_i16_cf((const int16_t *)sample_buf_data(samples),
+                                    ch->converted, samples->num);
+            else
+                simd_convert_i8_cf(sample_buf_data(samples), ch->converted,
+                                   samples->num);
+            in = ch->converted;
+        }
+        chan_block_t *b = pfb_process(ch, in, samples->num);
+        sample_buf_free(samples);
+        if (!b)
+            continue;
+
+        for (int k = 0; k < ch->n_channels; k++)
+            if (mpmc_ring_put(&ch->sub[k].queue, b) != 0)
+                block_release(b);
+    }
+
+    /* Let the channels finish their backlog (close drops queued items) */
+    for (int k = 0; k < ch->n_channels; k++)
+        while (mpmc_ring_size(&ch->sub[k].queue) > 0)
+            usleep(10000);
+    for (int k = 0; k < ch->n_channels; k++)
+        mpmc_ring_close(&ch->sub[k].queue);
+    for (int k = 0; k < ch->n_channels; k++)
+        pthread_join(ch->sub[k].thread, NULL);
+
+    pthread_mutex_lock(&ch->edge_lock);
+    edge_flush(ch, 1);
+    pthread_mutex_unlock(&ch->edge_lock);
+
+    channelizer_destroy(ch);
+    return NULL;
+}
@@ -0,0 +1,52 @@
+/*
+ * Wideband channelizer -- split the capture into parallel sub-band detectors
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Wideband channelizer -- split the capture into parallel sub-band detectors
+ *
+ * The band is cut into K channels of width sample_rate / K by one
+ * polyphase filter bank decimating by K / 2, so each sub-band is twice the
+ * channel width and overlaps both neighbours by half a channel. Every
+ * sub-band has its own detector thread, burst detector and noise
+ * history, but only starts bursts whose peak lies in its own channel, so a
+ * burst near an edge is detected exactly once, with the full burst width
+ * still inside the sub-band passband.
+ */
+
+#ifndef __CHANNELIZER_H__
+#define __CHANNELIZER_H__
+
+#include "burst_detect.h"
+
+/* Maximum number of channels */
+#define CHANNELIZER_MAX 16
+
+/* Filter bank output blocks buffered per channel thread */
+#define CHANNELIZER_QUEUE_SIZE 256
+
+typedef struct _channelizer channelizer_t;
+
+/* Create a channelizer with n_channels sub-band detectors (even, 2..16)
+ * for the wideband capture described by config. Detector FFT plans are
+ * made here, in the caller's thread. Returns NULL (with a message) if
+ * the sample rate cannot be split that way. */
+channelizer_t *channelizer_create(int n_channels, const burst_config_t *config);
+
+/* Timestamp of the first input sample (default: wall clock when the first
+ * block arrives) */
+void channelizer_set_start_time(channelizer_t *ch, uint64_t ns);
+
+/* Detector for channel k, lowest frequency first (for diagnostics) */
+burst_detector_t *channelizer_detector(channelizer_t *ch, int k);
+
+/* Thread function: pulls from samples_queue, runs the filter bank and fans
+ * its output out to the channel threads, which push to burst_queue. Joins
+ * the channel threads and destroys the channelizer when samples_queue is
+ * closed. */
+void *channelizer_thread(void *arg);
+
+#endif
@@ -0,0 +1,186 @@
+/*
+ * Demod worker pool
+ *
+ * N worker threads pull frames from frame_queue, and one sequencer thread
+ * emits their results in queue order through a reorder ring.
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Demod worker pool
+ *
+ * A worker takes frames and numbers them while holding take_lock, so the
+ * sequence numbers follow frame_queue order exactly. One batch take waits
+ * for the first frame and claims whatever else is already queued, up to
+ * the batch size -- it never waits to fill a batch, so a quiet sky costs
+ * no latency. It then runs the work stage on the batch outside any lock
+ * and marks its ring slots ready. The sequencer waits for the slot of the
+ * next sequence number, runs the output stage and frees the slot. Workers
+ * stop taking frames while the ring is full, so one slow frame backs the
+ * pool up instead of growing memory without bound.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "demod_pool.h"
+#include "pipeline_stats.h"
+#include "placement.h"
+
+#include "mpmc_ring.h"
+
+typedef struct {
+    demod_job_t job;
+    int ready;              /* work stage done, waiting for the sequencer */
+} reorder_slot_t;
+
+static reorder_slot_t ring[DEMOD_REORDER_SIZE];
+static uint64_t next_seq = 0;       /* next number to hand out (take_lock) */
+static uint64_t emit_seq = 0;       /* next number to output (ring_lock) */
+static int workers_alive = 0;       /* ring_lock */
+
+static pthread_mutex_t take_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t ring_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t slot_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t slot_free = PTHREAD_COND_INITIALIZER;
+
+static int pool_size = 0;
+static int batch_size = 1;
+static pthread_t workers[DEMOD_POOL_MAX];
+static pthread_t sequencer;
+static demod_work_fn work_fn;
+static demod_output_fn output_fn;
+
+extern mpmc_ring_t frame_queue;
+extern int verbose;
+
+/* ---- Worker thread ---- */
+
+static void *worker_thread(void *arg) {
+    (void)arg;
+
+    while (1) {
+        void *frames[QPSK_BATCH_MAX];
+        demod_job_t *jobs[QPSK_BATCH_MAX];
+        uint64_t seq;
+
+        pthread_mutex_lock(&take_lock);
+        pthread_mutex_lock(&ring_lock);
+        while (next_seq - emit_seq > (uint64_t)(DEMOD_REORDER_SIZE - batch_size))
+            pthread_cond_wait(&slot_free, &ring_lock);
+        pthread_mutex_unlock(&ring_lock);
+
+        uint64_t t0 = pstats_now();
+        int n = (int)mpmc_ring_take_batch(&frame_queue, frames,
+                                          (unsigned)batch_size);
+        if (n == 0) {
+            pthread_mutex_unlock(&take_lock);
+            break;
+        }
+        pstats_take_wait(PQ_FRAME, t0);
+        seq = next_seq;
+        for (int i = 0; i < n; i++) {
+            reorder_slot_t *slot = &ring[(seq + i) % DEMOD_REORDER_SIZE];
+            memset(&slot->job, 0, sizeof(slot->job));
+            slot->job.frame = frames[i];
+            jobs[i] = &slot->job;
+        }
+        next_seq += n;
+        pthread_mutex_unlock(&take_lock);
+
+        work_fn(jobs, n);
+
+        pthread_mutex_lock(&ring_lock);
+        for (int i = 0; i < n; i++)
+            ring[(seq + i) % DEMOD_REORDER_SIZE].ready = 1;
+        if (emit_seq >= seq && emit_seq < seq + n)
+            pthread_cond_signal(&slot_ready);
+        pthread_mutex_unlock(&ring_lock);
+    }
+
+    pthread_mutex_lock(&ring_lock);
+    workers_alive--;
+    pthread_cond_signal(&slot_ready);
+    pthread_mutex_unlock(&ring_lock);
+    return NULL;
+}
+
+/* ---- Sequencer thread ---- */
+
+static void *sequencer_thread(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&ring_lock);
+    while (1) {
+        reorder_slot_t *slot = &ring[emit_seq % DEMOD_REORDER_SIZE];
+        /* Once every worker has exited, no slot can become ready */
+        while (!slot->ready && workers_alive > 0)
+            pthread_cond_wait(&slot_ready, &ring_lock);
+        if (!slot->ready)
+            break;
+        pthread_mutex_unlock(&ring_lock);
+
+        output_fn(&slot->job);
+
+        pthread_mutex_lock(&ring_lock);
+        slot->ready = 0;
+        emit_seq++;
+        pthread_cond_broadcast(&slot_free);
+    }
+    pthread_mutex_unlock(&ring_lock);
+    return NULL;
+}
+
+/* ---- Public API ---- */
+
+void demod_pool_init(int n_workers, int batch, demod_work_fn work,
+                     demod_output_fn output) {
+    if (n_workers <= 0)
+        n_workers = DEMOD_POOL_DEFAULT;
+    if (n_workers > DEMOD_POOL_MAX)
+        n_workers = DEMOD_POOL_MAX;
+    if (batch <= 0)
+        batch = DEMOD_BATCH_DEFAULT;
+    if (batch > QPSK_BATCH_MAX)
+        batch = QPSK_BATCH_MAX;
+    pool_size = n_workers;
+    batch_size = batch;
+    work_fn = work;
+    output_fn = output;
+
+    if (verbose)
+        fprintf(stderr, "demod_pool: %d workers, batches of up to %d frames\n",
+                n_workers, batch);
+}
+
+void demod_pool_start(void) {
+    workers_alive = pool_size;
+    for (int i = 0; i < pool_size; i++) {
+        pthread_create(&workers[i], NULL, worker_thread, NULL);
+        placement_pin(workers[i], PLACE_DEMOD, i);
+#ifdef __linux__
+        char name[32];
+        snprintf(name, sizeof(name), "demod-%d", i);
+        name[15] = '\0';       /* pthread names are 15 characters */
+        pthread_setname_np(workers[i], name);
+#endif
+    }
+
+    pthread_create(&sequencer, NULL, sequencer_thread, NULL);
+    placement_pin(sequencer, PLACE_OUTPUT, 0);
+#ifdef __linux__
+    pthread_setname_np(sequencer, "output");
+#endif
+}
+
+void demod_pool_join(void) {
+    for (int i = 0; i < pool_size; i++)
+        pthread_join(workers[i], NULL);
+    pthread_join(sequencer, NULL);
+}
@@ -0,0 +1,71 @@
+/*
+ * Demod worker pool -- parallel QPSK demod and decode, in-order output
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Demod worker pool -- parallel QPSK demod and decode, in-order output
+ *
+ * Workers take frames from frame_queue and run the stateless stages
+ * (qpsk_demod, ida_decode, frame_decode) concurrently, several frames per
+ * call when the queue has them so the demod can run their PLLs side by
+ * side (qpsk_demod_batch). Each frame is
+ * numbered as it leaves the queue, and a single sequencer thread hands the
+ * results to the output stage strictly in that order, so everything with
+ * state -- stdout, the IDA reassemblers, the web map -- sees frames in the
+ * same order a single consumer thread would.
+ */
+
+#ifndef __DEMOD_POOL_H__
+#define __DEMOD_POOL_H__
+
+#include "burst_downmix.h"
+#include "frame_decode.h"
+#include "ida_decode.h"
+#include "qpsk_demod.h"
+
+/* Hard upper bound on worker threads */
+#define DEMOD_POOL_MAX 32
+
+/* Default worker count when --demod-workers is not given */
+#define DEMOD_POOL_DEFAULT 2
+
+/* Default frames per work call when --demod-batch is not given */
+#define DEMOD_BATCH_DEFAULT QPSK_BATCH_MAX
+
+/* Frames that may be finished ahead of the oldest one still in a worker */
+#define DEMOD_REORDER_SIZE 256
+
+/* One frame's trip through the pool. The work stage fills in everything
+ * after frame; the output stage owns the job's buffers and frees them. */
+typedef struct {
+    downmix_frame_t *frame;
+    demod_frame_t *demod;       /* NULL if skipped or the UW check failed */
+    int skip;                   /* not handled (outside this process's span) */
+    int ida_ok;
+    ida_burst_t burst;
+    int decoded_ok;
+    decoded_frame_t decoded;
+} demod_job_t;
+
+/* Runs on any worker, concurrently with other batches. jobs holds n
+ * consecutive frames (1 <= n <= the pool's batch size). */
+typedef void (*demod_work_fn)(demod_job_t **jobs, int n);
+
+/* Runs on the sequencer thread, in frame_queue order */
+typedef void (*demod_output_fn)(demod_job_t *job);
+
+/* Prepare the pool (workers or batch 0 = default). */
+void demod_pool_init(int workers, int batch, demod_work_fn work,
+                     demod_output_fn output);
+
+/* Launch the workers and the sequencer. */
+void demod_pool_start(void);
+
+/* Join all threads once every frame has been output. Call after
+ * frame_queue has been closed. */
+void demod_pool_join(void);
+
+#endif
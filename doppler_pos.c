@@ -10,8 +10,10 @@
 
 #include <math.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "doppler_pos.h"
 #include "wgs84.h"
@@ -34,6 +36,21 @@ extern int verbose;
 #define SAT_GAP_RESET_S      600.0   /* reset sat buffer after 10 min gap (new pass) */
 #define MAX_SOLUTION_JUMP    500e3    /* reject solutions >500 km from previous (m) */
 
+/* Positioning thread */
+#define DOPPLER_QUEUE        1024    /* IRA frames queued for the thread (power of two) */
+#define DOPPLER_POLL_US      50000   /* sleep when the queue is empty */
+#define BATCH_INTERVAL_NS    (10ULL * 1000000000ULL)   /* batch solve while no filter runs */
+#define REANCHOR_INTERVAL_NS (300ULL * 1000000000ULL)  /* batch re-solve reseeding the filter */
+
+/* Recursive estimator (EKF on receiver ECEF + clock drift) */
+#define EKF_Q_POS            100.0   /* position process noise (m^2/s) */
+#define EKF_Q_CLK            1e-3    /* clock drift process noise ((m/s)^2/s) */
+#define EKF_MIN_R            1.0     /* floor on range-rate variance ((m/s)^2) */
+#define EKF_SEED_MAX_HDOP    100.0   /* batch solutions worse than this keep batching */
+#define EKF_HEALTH_WINDOW    64      /* updates per divergence check */
+#define CHAN_VOTE_SLOTS      8       /* distinct channels voted on per satellite */
+#define CHAN_MIN_VOTES       5       /* votes before the filter trusts a channel */
+
 /* ---- Internal types ---- */
 
 typedef struct {
@@ -49,8 +66,23 @@ typedef struct {
     int head;               /* next write index */
     int count;              /* total stored (capped at MEAS_PER_SAT) */
     double channel_freq;    /* estimated true channel frequency (0 = unknown) */
+
+    /* Running nearest-channel vote over the buffered measurements (the
+     * recursive estimator's channel; the batch solve re-votes itself) */
+    double vote_freq[CHAN_VOTE_SLOTS];
+    int votes[CHAN_VOTE_SLOTS];
+    uint64_t last_used;     /* last measurement folded into the filter */
 } sat_buffer_t;
 
+/* IRA fields the positioning thread needs, queued by the output thread */
+typedef struct {
+    int sat_id;
+    double lat, lon;
+    int pos_xyz[3];
+    double freq;
+    uint64_t timestamp;
+} raw_meas_t;
+
 /* Flattened measurement for the solver */
 typedef struct {
     double sat_ecef[3];
@@ -62,7 +94,8 @@ typedef struct {
 
 /* ---- Module state ---- */
 
-static pthread_mutex_t pos_lock;
+/* Satellite buffers, solver and filter state belong to the positioning
+ * thread */
 static sat_buffer_t satellites[MAX_SATELLITES];
 static int n_satellites;
 static double height_aiding_m = -1.0;  /* -1 = disabled, >= 0 = altitude in meters */
@@ -74,6 +107,39 @@ static double prev_clock_drift = 0;
 static int has_prev_solution = 0;
 static int jump_reject_count = 0;
 
+/* Output thread → positioning thread */
+static raw_meas_t meas_ring[DOPPLER_QUEUE];
+static atomic_size_t ring_head, ring_tail;
+static atomic_ulong ring_dropped;
+
+static pthread_t doppler_thread;
+static atomic_int doppler_running = 0;
+
+/* Latest solution, read by doppler_pos_solve() */
+static pthread_mutex_t sol_lock = PTHREAD_MUTEX_INITIALIZER;
+static doppler_solution_t published;
+static int published_valid = 0;
+
+/* Seed for the filter, left by the last successful batch solve */
+static struct {
+    int valid;
+    double x[4];
+    double cov[4][4];
+    double sigma2;
+    int n_meas, n_sats;
+} seed;
+
+static struct {
+    int active;
+    double x[4];            /* receiver ECEF (m) and clock drift (m/s) */
+    double P[4][4];
+    double R;               /* range-rate variance from the seeding batch */
+    uint64_t t;             /* time of the last update (ns) */
+    unsigned long n_updates;
+    int n_base, n_base_sats;
+    int window_n, window_rejected;
+} ekf;
+
 /* ---- Helpers ---- */
 
 static double vec3_dot(const double a[3], const double b[3])
@@ -132,11 +198,46 @@ static sat_buffer_t *find_or_create_sat(int sat_id)
     return s;
 }
 
+/* Add (delta 1) or withdraw (delta -1) a measurement's channel vote */
+static void chan_vote(sat_buffer_t *s, double freq, int delta)
+{
+    double chan = assign_channel_freq(freq);
+    int weakest = 0;
+    for (int i = 0; i < CHAN_VOTE_SLOTS; i++) {
+        if (s->votes[i] > 0 && fabs(s->vote_freq[i] - chan) < 1.0) {
+            s->votes[i] += delta;
+            return;
+        }
+        if (s->votes[i] < s->votes[weakest])
+            weakest = i;
+    }
+    /* A channel not in the table; it replaces the weakest one, which at
+     * worst loses a few scattered votes */
+    if (delta > 0) {
+        s->vote_freq[weakest] = chan;
+        s->votes[weakest] = 1;
+    }
+}
+
+/* Channel with the most votes, or 0 if none has CHAN_MIN_VOTES yet */
+static double chan_vote_winner(const sat_buffer_t *s)
+{
+    int best = -1;
+    for (int i = 0; i < CHAN_VOTE_SLOTS; i++)
+        if (s->votes[i] >= CHAN_MIN_VOTES &&
+            (best < 0 || s->votes[i] > s->votes[best]))
+            best = i;
+    return best < 0 ? 0 : s->vote_freq[best];
+}
+
 /* Add measurement to a satellite's circular buffer */
 static void sat_buf_add(sat_buffer_t *s, const double ecef[3],
                          double freq, uint64_t ts)
 {
     sat_meas_t *m = &s->meas[s->head];
+    if (s->count == MEAS_PER_SAT)
+        chan_vote(s, m->freq, -1);
+    chan_vote(s, freq, 1);
     m->sat_ecef[0] = ecef[0];
     m->sat_ecef[1] = ecef[1];
     m->sat_ecef[2] = ecef[2];
@@ -208,35 +309,12 @@ static double estimate_channel_freq(sat_buffer_t *s, uint64_t now)
  * Two positions separated by 5 minutes span ~2200 km of arc, so the orbital
  * plane is determined with sub-degree accuracy despite 4 km quantization.
  * Speed magnitude comes from the vis-viva equation. */
-static int estimate_velocity(sat_buffer_t *s, int idx, double vel[3])
+static int velocity_from_pair(const sat_meas_t *cur,
+                              const sat_meas_t *best_other, double vel[3])
 {
-    sat_meas_t *cur = sat_buf_get(s, idx);
-    if (!cur) return -1;
-
     double r_norm = vec3_norm(cur->sat_ecef);
     if (r_norm < 1e6) return -1;
 
-    /* Find the most temporally separated measurement for best orbital plane
-     * accuracy. Prefer larger separation (more arc = less quantization noise).
-     * Cap at 10 minutes to avoid orbital perturbation drift. */
-    sat_meas_t *best_other = NULL;
-    double best_dt = 0;
-
-    for (int i = 0; i < s->count; i++) {
-        if (i == idx) continue;
-        sat_meas_t *m = sat_buf_get(s, i);
-        if (!m || !m->valid) continue;
-        double dt = fabs((double)(m->timestamp - cur->timestamp) / 1e9);
-        if (dt >= MIN_VEL_INTERVAL_NS / 1e9 && dt < 600.0 && dt > best_dt) {
-            /* Verify the other position is also at valid orbit altitude */
-            double other_r = vec3_norm(m->sat_ecef);
-            if (other_r < 7050e3 || other_r > 7250e3) continue;
-            best_dt = dt;
-            best_other = m;
-        }
-    }
-    if (!best_other) return -1;
-
     /* Orbital angular momentum vector: h = r_cur x r_other
      * Defines the orbital plane normal. Direction depends on which
      * position is "first" but we fix the sign below using temporal order. */
@@ -273,6 +351,60 @@ static int estimate_velocity(sat_buffer_t *s, int idx, double vel[3])
     return 0;
 }
 
+static int estimate_velocity(sat_buffer_t *s, int idx, double vel[3])
+{
+    sat_meas_t *cur = sat_buf_get(s, idx);
+    if (!cur) return -1;
+
+    double r_norm = vec3_norm(cur->sat_ecef);
+    if (r_norm < 1e6) return -1;
+
+    /* Find the most temporally separated measurement for best orbital plane
+     * accuracy. Prefer larger separation (more arc = less quantization noise).
+     * Cap at 10 minutes to avoid orbital perturbation drift. */
+    sat_meas_t *best_other = NULL;
+    double best_dt = 0;
+
+    for (int i = 0; i < s->count; i++) {
+        if (i == idx) continue;
+        sat_meas_t *m = sat_buf_get(s, i);
+        if (!m || !m->valid) continue;
+        double dt = fabs((double)(m->timestamp - cur->timestamp) / 1e9);
+        if (dt >= MIN_VEL_INTERVAL_NS / 1e9 && dt < 600.0 && dt > best_dt) {
+            /* Verify the other position is also at valid orbit altitude */
+            double other_r = vec3_norm(m->sat_ecef);
+            if (other_r < 7050e3 || other_r > 7250e3) continue;
+            best_dt = dt;
+            best_other = m;
+        }
+    }
+    if (!best_other) return -1;
+
+    return velocity_from_pair(cur, best_other, vel);
+}
+
+/* Velocity for the newest measurement. The buffer is in time order (a
+ * long gap resets it), so the oldest usable partner within 10 minutes is
+ * the most separated one estimate_velocity() would pick, and the scan
+ * usually stops at the first entry. */
+static int latest_velocity(sat_buffer_t *s, double vel[3])
+{
+    sat_meas_t *cur = sat_buf_get(s, s->count - 1);
+    if (!cur) return -1;
+
+    for (int i = 0; i < s->count - 1; i++) {
+        sat_meas_t *m = sat_buf_get(s, i);
+        if (!m->valid) continue;
+        double dt = (double)(cur->timestamp - m->timestamp) / 1e9;
+        if (dt >= 600.0) continue;
+        if (dt < MIN_VEL_INTERVAL_NS / 1e9) break;
+        double other_r = vec3_norm(m->sat_ecef);
+        if (other_r < 7050e3 || other_r > 7250e3) continue;
+        return velocity_from_pair(cur, m, vel);
+    }
+    return -1;
+}
+
 /* 4x4 matrix inversion via Gauss-Jordan elimination.
  * Operates in-place on A[4][4], stores inverse in inv[4][4].
  * Returns 0 on success, -1 if singular. */
@@ -321,38 +453,25 @@ static int mat4_invert(double A[4][4], double inv[4][4])
     return 0;
 }
 
-/* ---- Public API ---- */
+/* ---- Measurement intake (positioning thread) ---- */
 
-void doppler_pos_init(void)
-{
-    pthread_mutex_init(&pos_lock, NULL);
-    n_satellites = 0;
-    height_aiding_m = -1.0;
-    height_aiding_enabled = 0;
-    memset(satellites, 0, sizeof(satellites));
-}
-
-void doppler_pos_set_height(double height_m)
-{
-    height_aiding_m = height_m;
-    height_aiding_enabled = 1;
-}
-
-void doppler_pos_add_measurement(const ira_data_t *ira, double frequency,
-                                  uint64_t timestamp)
+/* Validate one queued IRA frame and add it to its satellite's buffer.
+ * Returns the buffer it went into, or NULL if it was rejected. */
+static sat_buffer_t *ingest(const raw_meas_t *rm)
 {
     static unsigned long dbg_total = 0, dbg_sat0 = 0, dbg_coord = 0,
                          dbg_radius = 0, dbg_ok = 0, dbg_vel_rej = 0;
+    sat_buffer_t *s = NULL;
 
     dbg_total++;
 
-    if (ira->sat_id == 0) { dbg_sat0++; goto dbg_print; }
-    if (ira->lat < -90 || ira->lat > 90) { dbg_coord++; goto dbg_print; }
-    if (ira->lon < -180 || ira->lon > 180) { dbg_coord++; goto dbg_print; }
+    if (rm->sat_id == 0) { dbg_sat0++; goto dbg_print; }
+    if (rm->lat < -90 || rm->lat > 90) { dbg_coord++; goto dbg_print; }
+    if (rm->lon < -180 || rm->lon > 180) { dbg_coord++; goto dbg_print; }
 
     /* Convert IRA satellite position to ECEF */
     double sat_ecef[3];
-    ira_xyz_to_ecef(ira->pos_xyz, sat_ecef);
+    ira_xyz_to_ecef(rm->pos_xyz, sat_ecef);
 
     /* Sanity: Iridium orbit radius ~7158 km (780 km altitude).
      * Accept 7050-7250 km (altitude 672-872 km) to reject false positives. */
@@ -362,12 +481,11 @@ void doppler_pos_add_measurement(const ira_data_t *ira, double frequency,
         goto dbg_print;
     }
 
-    pthread_mutex_lock(&pos_lock);
-    sat_buffer_t *s = find_or_create_sat(ira->sat_id);
+    s = find_or_create_sat(rm->sat_id);
     if (s) {
         if (s->count > 0) {
             int last = (s->head - 1 + MEAS_PER_SAT) % MEAS_PER_SAT;
-            double dt = (double)(timestamp - s->meas[last].timestamp) / 1e9;
+            double dt = (double)(rm->timestamp - s->meas[last].timestamp) / 1e9;
 
             /* Long gap: likely a different physical satellite reusing
              * this 7-bit sat_id. Reset the buffer to avoid mixing
@@ -376,10 +494,11 @@ void doppler_pos_add_measurement(const ira_data_t *ira, double frequency,
                 if (verbose)
                     fprintf(stderr, "DOPPLER: sat=%d gap=%.0fs, "
                             "resetting buffer (likely new pass)\n",
-                            ira->sat_id, dt);
+                            rm->sat_id, dt);
                 s->count = 0;
                 s->head = 0;
                 s->channel_freq = 0;
+                memset(s->votes, 0, sizeof(s->votes));
             } else {
                 /* Short gap: verify position consistency.
                  * At ~7.5 km/s, speed > 10 km/s is impossible. */
@@ -389,21 +508,20 @@ void doppler_pos_add_measurement(const ira_data_t *ira, double frequency,
                 double dist = sqrt(dx*dx + dy*dy + dz*dz);
                 if (dt > 0 && dt < 120 && dist / dt > 10000.0) {
                     dbg_vel_rej++;
-                    pthread_mutex_unlock(&pos_lock);
+                    s = NULL;
                     goto dbg_print;
                 }
             }
         }
-        sat_buf_add(s, sat_ecef, frequency, timestamp);
+        sat_buf_add(s, sat_ecef, rm->freq, rm->timestamp);
     }
-    pthread_mutex_unlock(&pos_lock);
 
     if (verbose) {
         double slat, slon, salt;
         ecef_to_geodetic(sat_ecef, &slat, &slon, &salt);
         fprintf(stderr, "DOPPLER: accepted sat=%d pos=%.1f,%.1f "
                 "alt=%.0fkm freq=%.0f\n",
-                ira->sat_id, slat, slon, salt/1000.0, frequency);
+                rm->sat_id, slat, slon, salt/1000.0, rm->freq);
     }
     dbg_ok++;
 
@@ -414,13 +532,17 @@ dbg_print:
                 "reject_vel=%lu\n",
                 dbg_total, dbg_ok, dbg_sat0, dbg_coord, dbg_radius,
                 dbg_vel_rej);
+    return s;
 }
 
-int doppler_pos_solve(doppler_solution_t *out)
+/* ---- Batch solver (positioning thread) ---- */
+
+/* Full iterated weighted least squares over every buffered measurement.
+ * Seeds the recursive estimator (seed) when it produces a new solution. */
+static int batch_solve(doppler_solution_t *out)
 {
     memset(out, 0, sizeof(*out));
 
-    pthread_mutex_lock(&pos_lock);
 
     /* Collect valid measurements with velocity estimates */
     static solver_meas_t all_meas[MAX_SATELLITES * MEAS_PER_SAT];
@@ -630,8 +752,6 @@ done_collect:
                     n_satellites, total_buf, n_meas, sats_used);
     }
 
-    pthread_mutex_unlock(&pos_lock);
-
     /* Check minimum data requirements */
     if (n_meas < MIN_MEASUREMENTS || sats_used < MIN_SATELLITES) {
         out->n_measurements = n_meas;
@@ -1214,6 +1334,9 @@ done_collect:
     /* Compute HDOP from the final solution's covariance */
     int n_total = n_meas + rejected;  /* original array size */
     double hdop = 99.9;
+    double fit_cov[4][4] = {{0}};   /* (H^T H)^-1, unscaled */
+    double fit_res2 = 0;
+    int fit_ok = 0, fit_count = 0;
     {
         double HtH[4][4] = {{0}};
         int count = 0;
@@ -1250,6 +1373,9 @@ done_collect:
                 for (int c = 0; c < 4; c++)
                     HtH[r][c] += H_row[r] * H_row[c];
             count++;
+
+            double res = m->range_rate - (rho_dot_geom + clock_drift);
+            fit_res2 += res * res;
         }
 
         if (count >= 4) {
@@ -1257,6 +1383,10 @@ done_collect:
             memcpy(HtH_copy, HtH, sizeof(HtH));
             double Q[4][4];
             if (mat4_invert(HtH_copy, Q) == 0) {
+                memcpy(fit_cov, Q, sizeof(Q));
+                fit_ok = 1;
+                fit_count = count;
+
                 /* Rotate Q to ENU */
                 double lat, lon, alt;
                 ecef_to_geodetic(rx_ecef, &lat, &lon, &alt);
@@ -1328,6 +1458,24 @@ done_collect:
     prev_clock_drift = clock_drift;
     has_prev_solution = 1;
 
+    /* Seed the recursive estimator: the state with the fit's covariance
+     * scaled by its residual variance */
+    if (fit_ok && fit_count > 4 && hdop <= EKF_SEED_MAX_HDOP) {
+        double sigma2 = fit_res2 / (fit_count - 4);
+        if (sigma2 < EKF_MIN_R) sigma2 = EKF_MIN_R;
+        seed.x[0] = rx_ecef[0];
+        seed.x[1] = rx_ecef[1];
+        seed.x[2] = rx_ecef[2];
+        seed.x[3] = clock_drift;
+        for (int r = 0; r < 4; r++)
+            for (int c = 0; c < 4; c++)
+                seed.cov[r][c] = sigma2 * fit_cov[r][c];
+        seed.sigma2 = sigma2;
+        seed.n_meas = n_meas;
+        seed.n_sats = sats_used;
+        seed.valid = 1;
+    }
+
     /* Convert ECEF to geodetic for output */
     ecef_to_geodetic(rx_ecef, &out->lat, &out->lon, &out->alt);
     out->hdop = hdop;
@@ -1337,3 +1485,316 @@ done_collect:
 
     return 1;
 }
+
+/* ---- Recursive estimator (positioning thread) ---- */
+
+static void ekf_init_from_seed(void)
+{
+    memcpy(ekf.x, seed.x, sizeof(ekf.x));
+    memcpy(ekf.P, seed.cov, sizeof(ekf.P));
+    ekf.R = seed.sigma2;
+    ekf.n_updates = 0;
+    ekf.n_base = seed.n_meas;
+    ekf.n_base_sats = seed.n_sats;
+    ekf.window_n = ekf.window_rejected = 0;
+    ekf.active = 1;
+    seed.valid = 0;
+}
+
+/* Scalar measurement update with innovation innov, Jacobian row H and
+ * variance R. With gate set, an innovation beyond OUTLIER_SIGMA standard
+ * deviations is rejected. Returns 1 if the update was applied. */
+static int ekf_update(const double H[4], double innov, double R, int gate)
+{
+    double PH[4];
+    for (int i = 0; i < 4; i++)
+        PH[i] = ekf.P[i][0]*H[0] + ekf.P[i][1]*H[1] +
+                ekf.P[i][2]*H[2] + ekf.P[i][3]*H[3];
+    double S = H[0]*PH[0] + H[1]*PH[1] + H[2]*PH[2] + H[3]*PH[3] + R;
+    if (S <= 0) return 0;
+    if (gate && innov * innov > OUTLIER_SIGMA * OUTLIER_SIGMA * S)
+        return 0;
+
+    double K[4];
+    for (int i = 0; i < 4; i++) {
+        K[i] = PH[i] / S;
+        ekf.x[i] += K[i] * innov;
+    }
+    /* P -= K (P H)^T, kept symmetric */
+    for (int i = 0; i < 4; i++)
+        for (int j = i; j < 4; j++) {
+            double v = ekf.P[i][j] - K[i] * PH[j];
+            ekf.P[i][j] = ekf.P[j][i] = v;
+        }
+    return 1;
+}
+
+/* Fold the newest measurement of s into the filter: constant cost, the
+ * same measurement model as one row of the batch solve */
+static void ekf_fold(sat_buffer_t *s)
+{
+    sat_meas_t *m = sat_buf_get(s, s->count - 1);
+    if (!m) return;
+
+    double chan = chan_vote_winner(s);
+    if (chan == 0) return;
+    double vel[3];
+    if (latest_velocity(s, vel) != 0) return;
+
+    /* Process noise for the time since the last update: a slow random
+     * walk, so old passes fade out of the estimate */
+    if (m->timestamp > ekf.t) {
+        double dt = (double)(m->timestamp - ekf.t) / 1e9;
+        for (int i = 0; i < 3; i++)
+            ekf.P[i][i] += EKF_Q_POS * dt;
+        ekf.P[3][3] += EKF_Q_CLK * dt;
+        ekf.t = m->timestamp;
+    }
+
+    double *rx_ecef = ekf.x;
+    double los[3];
+    vec3_sub(m->sat_ecef, rx_ecef, los);
+    double rho = vec3_norm(los);
+    int applied = 0;
+
+    /* Visibility: a satellite below the receiver's horizon is a corrupted
+     * position, whatever the residual says */
+    if (rho < 1.0 || vec3_dot(los, rx_ecef) <= 0)
+        goto health;
+
+    double rx_vel[3] = { -OMEGA_EARTH * rx_ecef[1],
+                          OMEGA_EARTH * rx_ecef[0], 0.0 };
+    double rel[3] = { vel[0] - rx_vel[0], vel[1] - rx_vel[1],
+                      vel[2] - rx_vel[2] };
+    double rho_dot_geom = vec3_dot(los, rel) / rho;
+    double range_rate = -(C_LIGHT / chan) * (m->freq - chan);
+    double innov = range_rate - (rho_dot_geom + ekf.x[3]);
+
+    double H[4];
+    double rho2 = rho * rho;
+    H[0] = -rel[0]/rho + los[0]*rho_dot_geom/rho2 + OMEGA_EARTH * los[1] / rho;
+    H[1] = -rel[1]/rho + los[1]*rho_dot_geom/rho2 - OMEGA_EARTH * los[0] / rho;
+    H[2] = -rel[2]/rho + los[2]*rho_dot_geom/rho2;
+    H[3] = 1.0;
+
+    applied = ekf_update(H, innov, ekf.R, 1);
+    if (applied) {
+        /* Height aiding with the batch's relative weight (100x) */
+        if (height_aiding_enabled) {
+            double hlat, hlon, halt;
+            ecef_to_geodetic(ekf.x, &hlat, &hlon, &halt);
+            double rn = vec3_norm(ekf.x);
+            double H_h[4] = { ekf.x[0]/rn, ekf.x[1]/rn, ekf.x[2]/rn, 0 };
+            ekf_update(H_h, height_aiding_m - halt, ekf.R / 100.0, 0);
+        }
+        s->last_used = m->timestamp;
+        ekf.n_updates++;
+    }
+
+health:
+    /* Divergence check: when most recent measurements fail the gate the
+     * filter has lost track; hand back to the batch solve */
+    ekf.window_n++;
+    if (!applied) ekf.window_rejected++;
+    if (ekf.window_n == EKF_HEALTH_WINDOW) {
+        if (ekf.window_rejected > EKF_HEALTH_WINDOW / 2) {
+            if (verbose)
+                fprintf(stderr, "DOPPLER: filter rejected %d of %d "
+                        "measurements, falling back to batch solve\n",
+                        ekf.window_rejected, ekf.window_n);
+            ekf.active = 0;
+        }
+        ekf.window_n = ekf.window_rejected = 0;
+    }
+}
+
+static void ekf_solution(doppler_solution_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    ecef_to_geodetic(ekf.x, &out->lat, &out->lon, &out->alt);
+
+    /* HDOP from the position covariance in ENU, unscaled by the
+     * measurement variance as in the batch solve */
+    double R[3][3];
+    ecef_to_enu_matrix(out->lat, out->lon, R);
+    double q_ee = 0, q_nn = 0;
+    for (int k = 0; k < 3; k++)
+        for (int l = 0; l < 3; l++) {
+            q_ee += R[0][k] * ekf.P[k][l] * R[0][l];
+            q_nn += R[1][k] * ekf.P[k][l] * R[1][l];
+        }
+    out->hdop = (q_ee + q_nn > 0) ? sqrt((q_ee + q_nn) / ekf.R) : 99.9;
+
+    int sats = 0;
+    for (int s = 0; s < n_satellites; s++)
+        if (satellites[s].last_used &&
+            ekf.t - satellites[s].last_used <= MAX_MEAS_AGE_NS)
+            sats++;
+    out->n_satellites = sats ? sats : ekf.n_base_sats;
+    out->n_measurements = ekf.n_base + (int)ekf.n_updates;
+    out->converged = 1;
+}
+
+/* ---- Positioning thread ---- */
+
+static void publish(const doppler_solution_t *sol, int valid)
+{
+    pthread_mutex_lock(&sol_lock);
+    published = *sol;
+    published_valid = valid;
+    pthread_mutex_unlock(&sol_lock);
+}
+
+static void publish_ekf(void)
+{
+    doppler_solution_t sol;
+    ekf_solution(&sol);
+    publish(&sol, 1);
+
+    /* The next batch re-anchor starts from, and guards jumps against,
+     * the filter's position */
+    memcpy(prev_ecef, ekf.x, sizeof(prev_ecef));
+    prev_clock_drift = ekf.x[3];
+    has_prev_solution = 1;
+}
+
+static void run_batch(void)
+{
+    doppler_solution_t sol;
+    seed.valid = 0;
+    int ok = batch_solve(&sol);
+
+    if (seed.valid) {
+        if (verbose && !ekf.active)
+            fprintf(stderr, "DOPPLER: filter seeded from batch solve "
+                    "(%d meas, %d sats, sigma=%.1f m/s)\n",
+                    seed.n_meas, seed.n_sats, sqrt(seed.sigma2));
+        ekf_init_from_seed();
+        ekf.t = 0;
+        for (int s = 0; s < n_satellites; s++) {
+            if (satellites[s].count > 0) {
+                sat_meas_t *m = sat_buf_get(&satellites[s],
+                                            satellites[s].count - 1);
+                if (m->timestamp > ekf.t) ekf.t = m->timestamp;
+            }
+        }
+    }
+
+    if (ekf.active)
+        publish_ekf();
+    else
+        publish(&sol, ok);
+}
+
+static int ring_pop(raw_meas_t *out)
+{
+    size_t head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring_tail, memory_order_acquire);
+    if (head == tail) return 0;
+    *out = meas_ring[head % DOPPLER_QUEUE];
+    atomic_store_explicit(&ring_head, head + 1, memory_order_release);
+    return 1;
+}
+
+static void *doppler_thread_fn(void *arg)
+{
+    (void)arg;
+    uint64_t latest = 0, last_batch = 0;
+
+    while (atomic_load(&doppler_running)) {
+        raw_meas_t rm;
+        int n = 0;
+        while (ring_pop(&rm)) {
+            sat_buffer_t *s = ingest(&rm);
+            if (s && ekf.active)
+                ekf_fold(s);
+            if (rm.timestamp > latest) latest = rm.timestamp;
+            n++;
+        }
+        if (n == 0) {
+            usleep(DOPPLER_POLL_US);
+            continue;
+        }
+
+        /* Scheduled on measurement time, so file replay solves as often
+         * per second of signal as live capture */
+        uint64_t since = latest - last_batch;
+        if (since >= (ekf.active ? REANCHOR_INTERVAL_NS : BATCH_INTERVAL_NS)) {
+            run_batch();
+            last_batch = latest;
+        } else if (ekf.active) {
+            publish_ekf();
+        }
+    }
+    return NULL;
+}
+
+/* ---- Public API ---- */
+
+void doppler_pos_init(void)
+{
+    n_satellites = 0;
+    height_aiding_m = -1.0;
+    height_aiding_enabled = 0;
+    memset(satellites, 0, sizeof(satellites));
+    memset(&ekf, 0, sizeof(ekf));
+    memset(&seed, 0, sizeof(seed));
+    published_valid = 0;
+}
+
+void doppler_pos_set_height(double height_m)
+{
+    height_aiding_m = height_m;
+    height_aiding_enabled = 1;
+}
+
+int doppler_pos_start(void)
+{
+    atomic_store(&doppler_running, 1);
+    if (pthread_create(&doppler_thread, NULL, doppler_thread_fn, NULL) != 0) {
+        atomic_store(&doppler_running, 0);
+        return -1;
+    }
+    return 0;
+}
+
+void doppler_pos_add_measurement(const ira_data_t *ira, double frequency,
+                                  uint64_t timestamp)
+{
+    size_t tail = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring_head, memory_order_acquire);
+    if (tail - head == DOPPLER_QUEUE) {
+        atomic_fetch_add(&ring_dropped, 1);
+        return;
+    }
+
+    raw_meas_t *rm = &meas_ring[tail % DOPPLER_QUEUE];
+    rm->sat_id = ira->sat_id;
+    rm->lat = ira->lat;
+    rm->lon = ira->lon;
+    memcpy(rm->pos_xyz, ira->pos_xyz, sizeof(rm->pos_xyz));
+    rm->freq = frequency;
+    rm->timestamp = timestamp;
+    atomic_store_explicit(&ring_tail, tail + 1, memory_order_release);
+}
+
+int doppler_pos_solve(doppler_solution_t *out)
+{
+    pthread_mutex_lock(&sol_lock);
+    *out = published;
+    int valid = published_valid;
+    pthread_mutex_unlock(&sol_lock);
+    return valid;
+}
+
+void doppler_pos_shutdown(void)
+{
+    if (!atomic_load(&doppler_running)) return;
+    atomic_store(&doppler_running, 0);
+    pthread_join(doppler_thread, NULL);
+
+    unsigned long dropped = atomic_load(&ring_dropped);
+    if (dropped)
+        fprintf(stderr, "DOPPLER: %lu IRA frames dropped (queue full)\n",
+                dropped);
+}
@@ -6,7 +6,10 @@
  *
  * Uses Doppler shift measurements from decoded IRA frames combined with
  * satellite positions to estimate the receiver's geographic location via
- * iterated weighted least squares.
+ * iterated weighted least squares. Once that has converged, a recursive
+ * estimator (EKF) folds in each new measurement at constant cost, and the
+ * batch solve only runs again every few minutes to re-anchor it. All of it
+ * runs on a positioning thread fed through a lock-free queue.
  *
  * Copyright (c) 2026 CEMAXECUTER LLC
  * SPDX-License-Identifier: GPL-3.0-or-later
@@ -31,14 +34,24 @@ typedef struct {
 /* Initialize the positioning engine. Call once at startup. */
 void doppler_pos_init(void);
 
-/* Feed a decoded IRA frame into the measurement buffer. Thread-safe. */
+/* Start the positioning thread, after doppler_pos_set_height().
+ * Returns 0 on success. */
+int doppler_pos_start(void);
+
+/* Queue a decoded IRA frame for the positioning thread. Never blocks (a
+ * frame that finds the queue full is dropped). Call from one thread only
+ * (the output thread). */
 void doppler_pos_add_measurement(const ira_data_t *ira, double frequency,
                                   uint64_t timestamp);
 
-/* Attempt to compute a position solution.
+/* Latest position solution; cheap, nothing is solved here. out also
+ * carries the measurement and satellite counts while no solution exists.
  * Returns 1 if a valid solution was produced, 0 otherwise. */
 int doppler_pos_solve(doppler_solution_t *out);
 
+/* Stop the positioning thread */
+void doppler_pos_shutdown(void);
+
 /* Set assumed receiver height for height aiding (meters above WGS-84).
  * A value of 0 disables height aiding. */
 void doppler_pos_set_height(double height_m);
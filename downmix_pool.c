@@ -0,0 +1,303 @@
+/*
+ * Downmix worker pool
+ *
+ * Runs N burst downmix threads pulling from burst_queue. In adaptive mode
+ * a manager thread samples burst_queue depth and per-worker busy time once
+ * a second and grows or shrinks the pool between 1 worker and one per
+ * spare CPU. Workers pin themselves to their --affinity CPUs.
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Downmix worker pool
+ *
+ * Runs N burst downmix threads pulling from burst_queue. In adaptive mode
+ * a manager thread samples burst_queue depth and per-worker busy time once
+ * a second and grows or shrinks the pool between 1 worker and one per
+ * spare CPU. Workers pin themselves to their --affinity CPUs.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "burst_detect.h"
+#include "burst_downmix.h"
+#include "burst_sched.h"
+#include "downmix_pool.h"
+#include "pipeline_stats.h"
+#include "placement.h"
+
+#include "mpmc_ring.h"
+
+/* Adaptive sizing policy */
+#define POOL_ADAPT_INTERVAL_US  1000000
+#define POOL_GROW_BUSY          0.85    /* grow when workers are this busy */
+#define POOL_GROW_DEPTH         64      /* ...or burst_queue backs up this far */
+#define POOL_SHRINK_BUSY        0.30    /* shrink when workers are this idle */
+#define POOL_SHRINK_INTERVALS   5       /* ...for this many intervals in a row */
+
+typedef struct {
+    int index;
+    pthread_t thread;
+    int started;            /* thread created, not yet joined */
+    atomic_int active;      /* worker loop running */
+    burst_downmix_t *dm;    /* planned once, kept when the worker retires */
+    atomic_ulong busy_ns;   /* cumulative time spent processing bursts */
+} pool_worker_t;
+
+static pool_worker_t workers[DOWNMIX_POOL_MAX];
+static int pool_max = 0;
+static int pool_adaptive = 0;
+static int n_cpus = 1;
+static atomic_int pool_target;  /* workers with index >= target retire */
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t manager;
+static int manager_started = 0;
+static volatile int pool_stopping = 0;
+static downmix_config_t pool_config;
+
+extern burst_sched_t *burst_queue;
+extern mpmc_ring_t frame_queue;
+extern atomic_ulong stat_frames_dropped;
+extern volatile sig_atomic_t running;
+extern int verbose;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* ---- Worker thread ---- */
+
+static void *worker_thread(void *arg) {
+    pool_worker_t *w = (pool_worker_t *)arg;
+
+    placement_pin_self(PLACE_WORKERS, w->index);
+
+    /* Workers added at runtime create their context here, off the hot path */
+    if (!w->dm)
+        w->dm = burst_downmix_create(&pool_config);
+    int batch_max = burst_downmix_batch_max(w->dm);
+
+    while (w->index < atomic_load(&pool_target)) {
+        burst_data_t *bursts[DOWNMIX_BATCH_MAX];
+        downmix_frame_t *frames[DOWNMIX_BATCH_MAX];
+        uint64_t tw = pstats_now();
+        int n = (int)burst_sched_take_batch(burst_queue, bursts,
+                                            (unsigned)batch_max);
+        if (n == 0)
+            break;
+        pstats_take_wait(PQ_BURST, tw);
+
+        /* NULL is a wake-up from the pool manager so idle workers
+         * notice a shrink; it always comes alone */
+        if (!bursts[0])
+            continue;
+
+        uint64_t t0 = now_ns();
+        burst_downmix_process_batch(w->dm, bursts, n, frames);
+        pstats_stage(STAGE_DOWNMIX, t0);
+
+        for (int i = 0; i < n; i++) {
+            /* Push frames to queue (one pooled frame per burst) */
+            if (frames[i] && mpmc_ring_try_put(&frame_queue, frames[i]) != 0) {
+                atomic_fetch_add(&stat_frames_dropped, 1);
+                downmix_frame_free(frames[i]);
+            }
+            burst_data_release(bursts[i]);
+        }
+        pstats_queue_depth(PQ_FRAME, mpmc_ring_size(&frame_queue));
+        atomic_fetch_add(&w->busy_ns, now_ns() - t0);
+    }
+
+    atomic_store(&w->active, 0);
+    return NULL;
+}
+
+/* Start worker i (caller holds pool_lock) */
+static void spawn_worker(int i) {
+    pool_worker_t *w = &workers[i];
+
+    if (w->started) {
+        pthread_join(w->thread, NULL);
+        w->started = 0;
+    }
+
+    atomic_store(&w->active, 1);
+    pthread_create(&w->thread, NULL, worker_thread, w);
+    w->started = 1;
+#ifdef __linux__
+    char name[16];
+    snprintf(name, sizeof(name), "downmix-%d", i);
+    pthread_setname_np(w->thread, name);
+#endif
+}
+
+/* Make sure every slot below the target has a live thread. A worker that
+ * checked the target just before it was raised may have exited. */
+static void ensure_workers(void) {
+    int target = atomic_load(&pool_target);
+    for (int i = 0; i < target; i++)
+        if (!atomic_load(&workers[i].active))
+            spawn_worker(i);
+}
+
+/* ---- Adaptive manager ---- */
+
+static void *manager_thread(void *arg) {
+    (void)arg;
+    uint64_t prev_busy[DOWNMIX_POOL_MAX] = { 0 };
+    uint64_t prev_t = now_ns();
+    int idle_intervals = 0;
+
+    while (running && !pool_stopping) {
+        usleep(POOL_ADAPT_INTERVAL_US);
+        if (!running || pool_stopping)
+            break;
+
+        uint64_t t = now_ns();
+        double dt = (double)(t - prev_t);
+        prev_t = t;
+
+        int target = atomic_load(&pool_target);
+        double busy = 0;
+        for (int i = 0; i < pool_max; i++) {
+            uint64_t b = atomic_load(&workers[i].busy_ns);
+            if (i < target)
+                busy += (double)(b - prev_busy[i]);
+            prev_busy[i] = b;
+        }
+        double util = (dt > 0 && target > 0) ? busy / (dt * target) : 0;
+        unsigned depth = burst_sched_depth(burst_queue);
+
+        if ((util > POOL_GROW_BUSY || depth > POOL_GROW_DEPTH) &&
+            target < pool_max) {
+            atomic_store(&pool_target, target + 1);
+            idle_intervals = 0;
+            if (verbose)
+                fprintf(stderr, "downmix_pool: %d -> %d workers "
+                        "(busy %.0f%%, queue %u)\n",
+                        target, target + 1, util * 100, depth);
+        } else if (util < POOL_SHRINK_BUSY && depth == 0 && target > 1) {
+            if (++idle_intervals >= POOL_SHRINK_INTERVALS) {
+                atomic_store(&pool_target, target - 1);
+                burst_sched_wake(burst_queue);
+                idle_intervals = 0;
+                if (verbose)
+                    fprintf(stderr, "downmix_pool: %d -> %d workers "
+                            "(busy %.0f%%)\n",
+                            target, target - 1, util * 100);
+            }
+        } else {
+            idle_intervals = 0;
+        }
+
+        pthread_mutex_lock(&pool_lock);
+        if (!pool_stopping)
+            ensure_workers();
+        pthread_mutex_unlock(&pool_lock);
+    }
+    return NULL;
+}
+
+/* ---- Public API ---- */
+
+void downmix_pool_init(int n_workers, int adaptive,
+                       const downmix_config_t *config) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    n_cpus = ncpu > 0 ? (int)ncpu : 1;
+    pool_adaptive = adaptive;
+
+    if (adaptive) {
+        /* One worker per CPU not taken by the detector */
+        pool_max = n_cpus > 1 ? n_cpus - 1 : 1;
+        if (pool_max > DOWNMIX_POOL_MAX)
+            pool_max = DOWNMIX_POOL_MAX;
+        if (n_workers <= 0 || n_workers > pool_max)
+            n_workers = pool_max < DOWNMIX_POOL_DEFAULT
+                      ? pool_max : DOWNMIX_POOL_DEFAULT;
+    } else {
+        if (n_workers <= 0)
+            n_workers = DOWNMIX_POOL_DEFAULT;
+        if (n_workers > DOWNMIX_POOL_MAX)
+            n_workers = DOWNMIX_POOL_MAX;
+        pool_max = n_workers;
+    }
+
+    for (int i = 0; i < DOWNMIX_POOL_MAX; i++) {
+        workers[i].index = i;
+        workers[i].started = 0;
+        workers[i].dm = NULL;
+        atomic_init(&workers[i].active, 0);
+        atomic_init(&workers[i].busy_ns, 0);
+    }
+    atomic_init(&pool_target, n_workers);
+
+    if (config)
+        pool_config = *config;
+
+    /* Plan the initial workers now, before any samples arrive, each on
+     * the memory node of the CPU it will run on */
+    for (int i = 0; i < n_workers; i++) {
+        placement_prefer_node(placement_node(PLACE_WORKERS, i));
+        workers[i].dm = burst_downmix_create(&pool_config);
+    }
+    placement_prefer_node(-1);
+
+    const char *cpus = placement_describe(PLACE_WORKERS);
+    if (verbose || adaptive)
+        fprintf(stderr, "downmix_pool: %d workers%s%s%s\n", n_workers,
+                adaptive ? " (adaptive)" : "",
+                *cpus ? ", pinned to CPUs " : "", cpus);
+}
+
+void downmix_pool_start(void) {
+    pthread_mutex_lock(&pool_lock);
+    ensure_workers();
+    pthread_mutex_unlock(&pool_lock);
+
+    if (pool_adaptive) {
+        pthread_create(&manager, NULL, manager_thread, NULL);
+        manager_started = 1;
+#ifdef __linux__
+        pthread_setname_np(manager, "downmix-pool");
+#endif
+    }
+}
+
+void downmix_pool_join(void) {
+    pthread_mutex_lock(&pool_lock);
+    pool_stopping = 1;
+    pthread_mutex_unlock(&pool_lock);
+
+    if (manager_started)
+        pthread_join(manager, NULL);
+
+    for (int i = 0; i < DOWNMIX_POOL_MAX; i++) {
+        pool_worker_t *w = &workers[i];
+        if (w->started)
+            pthread_join(w->thread, NULL);
+        w->started = 0;
+        if (w->dm) {
+            burst_downmix_destroy(w->dm);
+            w->dm = NULL;
+        }
+    }
+}
+
+int downmix_pool_active(void) {
+    int n = 0;
+    for (int i = 0; i < pool_max; i++)
+        n += atomic_load(&workers[i].active);
+    return n;
+}
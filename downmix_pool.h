@@ -0,0 +1,45 @@
+/*
+ * Downmix worker pool -- fixed or load-adaptive set of downmix threads
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Downmix worker pool -- fixed or load-adaptive set of downmix threads
+ */
+
+#ifndef __DOWNMIX_POOL_H__
+#define __DOWNMIX_POOL_H__
+
+#include <pthread.h>
+
+#include "burst_downmix.h"
+
+/* Hard upper bound on worker slots */
+#define DOWNMIX_POOL_MAX 64
+
+/* Default worker count when --workers is not given */
+#define DOWNMIX_POOL_DEFAULT 4
+
+/* Prepare the pool. workers is the initial thread count (0 = default).
+ * In adaptive mode the pool resizes between 1 worker and one per CPU
+ * after the first. Worker i runs on CPU placement_cpu(PLACE_WORKERS, i)
+ * when --affinity pins the workers. Downmix contexts for the
+ * initial workers are planned here, in the caller's thread; workers added
+ * later plan theirs lazily when they first start. Every worker's context
+ * is created from config (NULL = defaults); with config->batch_size > 1
+ * a worker takes up to that many queued bursts per pass. */
+void downmix_pool_init(int workers, int adaptive,
+                       const downmix_config_t *config);
+
+/* Launch the initial workers (and the pool manager in adaptive mode). */
+void downmix_pool_start(void);
+
+/* Join all workers. Call after burst_queue has been closed. */
+void downmix_pool_join(void);
+
+/* Number of running workers */
+int downmix_pool_active(void);
+
+#endif
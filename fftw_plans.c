@@ -0,0 +1,105 @@
+/*
+ * Shared FFTW plans
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Shared FFTW plans
+ *
+ * The cache is a short array searched linearly: a run only ever needs a
+ * handful of distinct transforms. It is protected by the FFTW planner
+ * lock, which plan creation has to hold anyway.
+ */
+
+#include <err.h>
+#include <stddef.h>
+
+#include "fftw_lock.h"
+#include "fftw_plans.h"
+
+#define PLAN_CACHE_MAX 32
+
+typedef struct {
+    int n;
+    int howmany;
+    int sign;
+    int refs;
+    fftwf_plan plan;
+} plan_entry_t;
+
+static plan_entry_t cache[PLAN_CACHE_MAX];
+static int n_created = 0;
+
+fftwf_plan fftw_plan_shared_dft_1d(int n, int sign) {
+    return fftw_plan_shared_many(n, 1, sign);
+}
+
+fftwf_plan fftw_plan_shared_many(int n, int howmany, int sign) {
+    fftw_lock();
+
+    plan_entry_t *free_slot = NULL;
+    for (int i = 0; i < PLAN_CACHE_MAX; i++) {
+        plan_entry_t *e = &cache[i];
+        if (e->refs > 0 && e->n == n && e->howmany == howmany &&
+            e->sign == sign) {
+            e->refs++;
+            fftw_unlock();
+            return e->plan;
+        }
+        if (e->refs == 0 && !free_slot)
+            free_slot = e;
+    }
+    if (!free_slot)
+        errx(1, "FFTW: more than %d distinct plans", PLAN_CACHE_MAX);
+
+    /* FFTW_MEASURE scribbles over its arrays, so plan on scratch ones with
+     * the alignment fftwf_alloc_complex() gives every caller's buffers */
+    size_t len = (size_t)n * howmany;
+    fftwf_complex *in = fftwf_alloc_complex(len);
+    fftwf_complex *out = fftwf_alloc_complex(len);
+    fftwf_plan plan = howmany == 1
+        ? fftwf_plan_dft_1d(n, in, out, sign, FFTW_MEASURE)
+        : fftwf_plan_many_dft(1, &n, howmany, in, NULL, 1, n,
+                              out, NULL, 1, n, sign, FFTW_MEASURE);
+    fftwf_free(in);
+    fftwf_free(out);
+    if (!plan)
+        errx(1, "FFTW: cannot plan a %d-point transform", n);
+
+    free_slot->n = n;
+    free_slot->howmany = howmany;
+    free_slot->sign = sign;
+    free_slot->refs = 1;
+    free_slot->plan = plan;
+    n_created++;
+
+    fftw_unlock();
+    return plan;
+}
+
+void fftw_plan_release(fftwf_plan plan) {
+    if (!plan)
+        return;
+
+    fftw_lock();
+    for (int i = 0; i < PLAN_CACHE_MAX; i++) {
+        plan_entry_t *e = &cache[i];
+        if (e->refs > 0 && e->plan == plan) {
+            if (--e->refs == 0) {
+                fftwf_destroy_plan(e->plan);
+                e->plan = NULL;
+            }
+            break;
+        }
+    }
+    fftw_unlock();
+}
+
+int fftw_plans_created(void) {
+    fftw_lock();
+    int n = n_created;
+    fftw_unlock();
+    return n;
+}
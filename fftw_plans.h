@@ -0,0 +1,42 @@
+/*
+ * Shared FFTW plans
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Shared FFTW plans
+ *
+ * Plans are cached by size, batch count and direction and handed out with a reference
+ * count, so every detector and downmix worker that needs the same
+ * transform plans it once. A shared plan is never run with
+ * fftwf_execute(): callers pass their own buffers to fftwf_execute_dft().
+ * Those buffers must come from fftwf_alloc_complex() (the plans are made
+ * on arrays with the same alignment) and be distinct (out of place).
+ *
+ * Creating and releasing plans takes the FFTW planner lock; executing
+ * them is thread-safe without it.
+ */
+
+#ifndef __FFTW_PLANS_H__
+#define __FFTW_PLANS_H__
+
+#include <fftw3.h>
+
+/* A 1-D out-of-place complex FFTW_MEASURE plan of size n, sign
+ * FFTW_FORWARD or FFTW_BACKWARD; release it with fftw_plan_release() */
+fftwf_plan fftw_plan_shared_dft_1d(int n, int sign);
+
+/* howmany n-point transforms of contiguous rows in one plan: row i is
+ * elements [i * n, (i + 1) * n) of both arrays. howmany 1 is the same
+ * plan as fftw_plan_shared_dft_1d(). */
+fftwf_plan fftw_plan_shared_many(int n, int howmany, int sign);
+
+/* Drop one reference; the plan is destroyed with the last one */
+void fftw_plan_release(fftwf_plan plan);
+
+/* Plans created so far by the functions above (cache misses) */
+int fftw_plans_created(void);
+
+#endif
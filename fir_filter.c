@@ -23,6 +23,11 @@
 /* ---- FIR filter creation/destruction ---- */
 
 fir_filter_t *fir_filter_create(const float *taps, int ntaps) {
+    return fir_filter_create_dec(taps, ntaps, 1);
+}
+
+fir_filter_t *fir_filter_create_dec(const float *taps, int ntaps,
+                                    int decimation) {
     fir_filter_t *f = malloc(sizeof(*f));
     f->ntaps = ntaps;
     /* Allocate taps aligned to 32 bytes and zero-padded to multiple of 8
@@ -33,6 +38,11 @@ fir_filter_t *fir_filter_create(const float *taps, int ntaps) {
     /* Zero-pad remainder */
     for (int i = ntaps; i < padded; i++)
         f->taps[i] = 0.0f;
+
+    f->decimation = decimation;
+    f->ccf = simd_fir_ccf_fixed(simd_fir_fixed, ntaps);
+    f->ccf_dec = simd_fir_ccf_dec_fixed(simd_fir_fixed, ntaps, decimation);
+    f->fff = simd_fir_fff_fixed(simd_fir_fixed, ntaps);
     return f;
 }
 
@@ -46,20 +56,29 @@ void fir_filter_destroy(fir_filter_t *f) {
 
 void fir_filter_ccf(fir_filter_t *f, float complex *out,
                     const float complex *in, int n) {
-    simd_fir_ccf(f->taps, f->ntaps, in, out, n);
+    if (f->ccf)
+        f->ccf(f->taps, f->ntaps, in, out, n);
+    else
+        simd_fir_ccf(f->taps, f->ntaps, in, out, n);
 }
 
 /* ---- Complex FIR filter with decimation ---- */
 
 void fir_filter_ccf_dec(fir_filter_t *f, float complex *out,
                         const float complex *in, int n_out, int decimation) {
-    simd_fir_ccf_dec(f->taps, f->ntaps, in, out, n_out, decimation);
+    if (f->ccf_dec && decimation == f->decimation)
+        f->ccf_dec(f->taps, f->ntaps, in, out, n_out, decimation);
+    else
+        simd_fir_ccf_dec(f->taps, f->ntaps, in, out, n_out, decimation);
 }
 
 /* ---- Real FIR filter ---- */
 
 void fir_filter_fff(fir_filter_t *f, float *out, const float *in, int n) {
-    simd_fir_fff(f->taps, f->ntaps, in, out, n);
+    if (f->fff)
+        f->fff(f->taps, f->ntaps, in, out, n);
+    else
+        simd_fir_fff(f->taps, f->ntaps, in, out, n);
 }
 
 /* ---- sinc function ---- */
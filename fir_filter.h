@@ -15,14 +15,27 @@
 #include <complex.h>
 #include <stddef.h>
 
+#include "simd_kernels.h"
+
 typedef struct {
     float *taps;
     int ntaps;
+    int decimation;             /* the one ccf_dec was picked for */
+    /* Fixed-length kernels of the SIMD set selected at creation, or NULL
+     * for the generic-length ones */
+    simd_fir_ccf_fn ccf;
+    simd_fir_ccf_dec_fn ccf_dec;
+    simd_fir_fff_fn fff;
 } fir_filter_t;
 
-/* Create FIR filter (copies taps) */
+/* Create FIR filter (copies taps). Call after simd_init(). */
 fir_filter_t *fir_filter_create(const float *taps, int ntaps);
 
+/* Same, for a filter that will mostly run with fir_filter_ccf_dec() at
+ * decimation, so a kernel fixed to that decimation can be picked */
+fir_filter_t *fir_filter_create_dec(const float *taps, int ntaps,
+                                    int decimation);
+
 /* Destroy FIR filter */
 void fir_filter_destroy(fir_filter_t *f);
 
@@ -0,0 +1,222 @@
+/*
+ * Binary framed output -- record encoding and decoding
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Binary framed output -- record encoding and decoding
+ *
+ * Fields are written byte by byte in little-endian order, so records are
+ * the same on every host and need no packed structs.
+ */
+
+#include <string.h>
+
+#include "frame_bin.h"
+
+/* ---- Little-endian field access ---- */
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+    return p + 4;
+}
+
+static uint8_t *put_u64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+    return p + 8;
+}
+
+static uint8_t *put_f32(uint8_t *p, float f) {
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    return put_u32(p, v);
+}
+
+static uint8_t *put_f64(uint8_t *p, double d) {
+    uint64_t v;
+    memcpy(&v, &d, sizeof(v));
+    return put_u64(p, v);
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static float get_f32(const uint8_t *p) {
+    uint32_t v = get_u32(p);
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+static double get_f64(const uint8_t *p) {
+    uint64_t v = get_u64(p);
+    double d;
+    memcpy(&d, &v, sizeof(d));
+    return d;
+}
+
+/* ---- Encoding ---- */
+
+#define FRAME_HEADER_LEN  (8 + 8 + 8 + 4 + 4 + 4 + 4 + 2 + 2)
+
+size_t frame_bin_encode_stream(uint8_t *buf, size_t cap, uint64_t t0,
+                               const char *file_info) {
+    size_t info_len = file_info ? strlen(file_info) : 0;
+    if (info_len > 255)
+        info_len = 255;
+    size_t len = 4 + 1 + 1 + 8 + 2 + info_len;
+    if (len > cap)
+        return 0;
+
+    uint8_t *p = put_u32(buf, (uint32_t)(len - 4));
+    *p++ = FRAME_BIN_STREAM;
+    *p++ = FRAME_BIN_VERSION;
+    p = put_u64(p, t0);
+    p = put_u16(p, (uint16_t)info_len);
+    memcpy(p, file_info, info_len);
+    return len;
+}
+
+size_t frame_bin_encode_frame(uint8_t *buf, size_t cap,
+                              const demod_frame_t *frame, int with_llr) {
+    int n_bits = frame->n_bits;
+    if (n_bits > FRAME_BIN_MAX_BITS)
+        n_bits = FRAME_BIN_MAX_BITS;
+    if (!frame->llr)
+        with_llr = 0;
+
+    size_t packed = (size_t)(n_bits + 7) / 8;
+    size_t len = 4 + 1 + FRAME_HEADER_LEN + packed + (with_llr ? n_bits : 0);
+    if (len > cap)
+        return 0;
+
+    int payload_syms = frame->n_payload_symbols;
+    if (payload_syms < 0) payload_syms = 0;
+    int conf = frame->confidence;
+    if (conf < 0) conf = 0;
+    if (conf > 255) conf = 255;
+
+    uint8_t *p = put_u32(buf, (uint32_t)(len - 4));
+    *p++ = FRAME_BIN_FRAME;
+    p = put_u64(p, frame->id);
+    p = put_u64(p, frame->timestamp);
+    p = put_f64(p, frame->center_frequency);
+    p = put_f32(p, frame->magnitude);
+    p = put_f32(p, frame->noise);
+    p = put_f32(p, frame->level);
+    *p++ = (uint8_t)conf;
+    *p++ = (uint8_t)frame->direction;
+    *p++ = with_llr ? FRAME_BIN_HAS_LLR : 0;
+    *p++ = 0;
+    p = put_u16(p, (uint16_t)payload_syms);
+    p = put_u16(p, (uint16_t)n_bits);
+
+    /* The frame's words are already MSB first; bits past n_bits are 0 */
+    for (size_t i = 0; i < packed; i++)
+        p[i] = (uint8_t)(frame->bits[i >> 3] >> (56 - 8 * (i & 7)));
+    p += packed;
+
+    if (with_llr) {
+        for (int i = 0; i < n_bits; i++) {
+            float q = frame->llr[i] * FRAME_BIN_LLR_SCALE + 0.5f;
+            p[i] = q >= 255.0f ? 255 : q > 0 ? (uint8_t)q : 0;
+        }
+    }
+
+    return len;
+}
+
+/* ---- Decoding ---- */
+
+int frame_bin_decode(const uint8_t *body, size_t len, frame_bin_record_t *rec) {
+    if (len < 1)
+        return -1;
+
+    const uint8_t *p = body + 1;
+    const uint8_t *end = body + len;
+    rec->type = body[0];
+
+    if (rec->type == FRAME_BIN_STREAM) {
+        if (end - p < 1 + 8 + 2)
+            return -1;
+        p++;    /* version: fields are only ever appended */
+        rec->t0 = get_u64(p);
+        p += 8;
+        size_t info_len = get_u16(p);
+        p += 2;
+        if ((size_t)(end - p) < info_len || info_len >= sizeof(rec->file_info))
+            return -1;
+        memcpy(rec->file_info, p, info_len);
+        rec->file_info[info_len] = '\0';
+        return FRAME_BIN_STREAM;
+    }
+
+    if (rec->type != FRAME_BIN_FRAME)
+        return 0;
+
+    if (end - p < FRAME_HEADER_LEN)
+        return -1;
+
+    demod_frame_t *f = &rec->frame;
+    memset(f, 0, sizeof(*f));
+    f->id = get_u64(p);
+    f->timestamp = get_u64(p + 8);
+    f->center_frequency = get_f64(p + 16);
+    f->magnitude = get_f32(p + 24);
+    f->noise = get_f32(p + 28);
+    f->level = get_f32(p + 32);
+    f->confidence = p[36];
+    f->direction = (ir_direction_t)p[37];
+    int flags = p[38];
+    f->n_payload_symbols = get_u16(p + 40);
+    f->n_bits = get_u16(p + 42);
+    p += FRAME_HEADER_LEN;
+
+    size_t packed = (size_t)(f->n_bits + 7) / 8;
+    size_t need = packed + ((flags & FRAME_BIN_HAS_LLR) ? (size_t)f->n_bits : 0);
+    if (f->n_bits > FRAME_BIN_MAX_BITS || (size_t)(end - p) < need)
+        return -1;
+
+    for (size_t i = 0; i < packed; i++)
+        f->bits[i >> 3] |= (uint64_t)p[i] << (56 - 8 * (i & 7));
+    /* A writer may leave stray bits in the last byte */
+    if (f->n_bits & 63)
+        f->bits[f->n_bits >> 6] &= ~0ULL << (64 - (f->n_bits & 63));
+    p += packed;
+    f->n_symbols = f->n_bits / 2;
+
+    if (flags & FRAME_BIN_HAS_LLR) {
+        for (int i = 0; i < f->n_bits; i++)
+            rec->llr[i] = p[i] / FRAME_BIN_LLR_SCALE;
+        f->llr = rec->llr;
+    } else {
+        f->llr = NULL;
+    }
+
+    return FRAME_BIN_FRAME;
+}
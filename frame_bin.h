@@ -0,0 +1,79 @@
+/*
+ * Binary framed output -- length-prefixed demodulated frame records
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Binary framed output -- length-prefixed demodulated frame records
+ *
+ * A stream (stdout, a file, or one record per ZMQ message) is a sequence
+ * of records, all little-endian:
+ *
+ *   u32 length            bytes after this field
+ *   u8  type              FRAME_BIN_STREAM or FRAME_BIN_FRAME
+ *
+ * FRAME_BIN_STREAM (written before the first frame):
+ *   u8  version           FRAME_BIN_VERSION
+ *   u64 t0                RAW time origin, ns
+ *   u16 info_len          followed by the RAW file_info string
+ *
+ * FRAME_BIN_FRAME:
+ *   u64 id, u64 timestamp (ns), f64 center_frequency (Hz)
+ *   f32 magnitude, f32 noise, f32 level
+ *   u8  confidence, u8 direction, u8 flags, u8 reserved
+ *   u16 n_payload_symbols, u16 n_bits
+ *   bits packed MSB first, (n_bits + 7) / 8 bytes
+ *   if flags & FRAME_BIN_HAS_LLR: n_bits u8 reliabilities,
+ *     llr * FRAME_BIN_LLR_SCALE saturated to 255
+ *
+ * Readers skip records of unknown type by their length.
+ */
+
+#ifndef __FRAME_BIN_H__
+#define __FRAME_BIN_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "qpsk_demod.h"
+
+#define FRAME_BIN_VERSION       1
+
+#define FRAME_BIN_STREAM        1
+#define FRAME_BIN_FRAME         2
+
+#define FRAME_BIN_HAS_LLR       0x01
+
+/* Quantization of demod_frame_t.llr (normalized so the mean is ~0.7) */
+#define FRAME_BIN_LLR_SCALE     64.0f
+
+/* Largest record: a full simplex frame with reliabilities */
+#define FRAME_BIN_MAX_BITS      DEMOD_MAX_BITS
+#define FRAME_BIN_MAX_RECORD    (64 + FRAME_BIN_MAX_BITS / 8 + FRAME_BIN_MAX_BITS)
+
+/* Encode a stream header / a frame into buf. Return the record length
+ * including the length prefix, or 0 if it does not fit in cap. */
+size_t frame_bin_encode_stream(uint8_t *buf, size_t cap, uint64_t t0,
+                               const char *file_info);
+size_t frame_bin_encode_frame(uint8_t *buf, size_t cap,
+                              const demod_frame_t *frame, int with_llr);
+
+/* Decoded record. For frames, frame.llr points into this struct (NULL
+ * if the record had none). */
+typedef struct {
+    int type;
+    /* FRAME_BIN_STREAM */
+    uint64_t t0;
+    char file_info[256];
+    /* FRAME_BIN_FRAME */
+    demod_frame_t frame;
+    float llr[FRAME_BIN_MAX_BITS];
+} frame_bin_record_t;
+
+/* Decode one record body (the bytes after the length prefix). Returns the
+ * record type, 0 for an unknown type, or -1 if the record is malformed. */
+int frame_bin_decode(const uint8_t *body, size_t len, frame_bin_record_t *rec);
+
+#endif
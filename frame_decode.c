@@ -21,11 +21,15 @@
  * Reference: iridium-toolkit/bitsparser.py (muccc)
  */
 
+#include <err.h>
 #include <math.h>
 #include <string.h>
 #include <stdio.h>
 
+#include "bch_chase.h"
+#include "bitpack.h"
 #include "frame_decode.h"
+#include "ida_decode.h"
 #include "iridium.h"
 
 #ifndef M_PI
@@ -44,40 +48,22 @@
 #define BCH_RA_DATA   21     /* 31 - 10 = 21 data bits */
 #define BCH_HDR_DATA  3      /* 7 - 4 = 3 data bits */
 
-/* Chase decoder: flip up to N least-reliable bits, retry BCH */
-#define CHASE_FLIP_BITS 5    /* 2^5 = 32 combinations per failed block */
-
-/* Access codes (24 bits after UW) */
-static const uint8_t access_dl[] = {
-    0,0,1,1,0,0,0,0,0,0,1,1,0,0,0,0,1,1,1,1,0,0,1,1
-};
-static const uint8_t access_ul[] = {
-    1,1,0,0,1,1,0,0,0,0,1,1,1,1,0,0,1,1,1,1,1,1,0,0
-};
+/* Access codes (24 bits after UW), first bit in the MSB:
+ * DL 001100000011000011110011, UL 110011000011110011111100 */
+#define ACCESS_DL   0x3030F3u
+#define ACCESS_UL   0xCC3CFCu
 
 /* Syndrome lookup tables for BCH error correction */
 /* poly=1207: 1024 entries (10-bit syndrome), each stores error locator XOR mask */
 static struct { int errs; uint32_t locator; } syn_ra[1024];
 /* poly=29: 16 entries (4-bit syndrome) */
 static struct { int errs; uint32_t locator; } syn_hdr[16];
+/* BCH(31,21) with the Chase search tables */
+static bch_code_t code_ra;
 
-/* ---- GF(2) polynomial remainder (BCH syndrome) ---- */
-
-uint32_t bits_to_uint(const uint8_t *bits, int n)
-{
-    uint32_t val = 0;
-    for (int i = 0; i < n; i++)
-        val = (val << 1) | (bits[i] & 1);
-    return val;
-}
+extern int chase_bits;
 
-void uint_to_bits(uint32_t val, uint8_t *bits, int n)
-{
-    for (int i = n - 1; i >= 0; i--) {
-        bits[i] = val & 1;
-        val >>= 1;
-    }
-}
+/* ---- GF(2) polynomial remainder (BCH syndrome) ---- */
 
 uint32_t gf2_remainder(uint32_t poly, uint32_t val)
 {
@@ -90,6 +76,13 @@ uint32_t gf2_remainder(uint32_t poly, uint32_t val)
     return val;
 }
 
+void gf2_mod_table_init(gf2_mod_table_t *tab, uint32_t poly)
+{
+    tab->deg = 31 - __builtin_clz(poly);
+    for (uint32_t t = 0; t < 256; t++)
+        tab->t[t] = (uint16_t)gf2_remainder(poly, t << tab->deg);
+}
+
 /* ---- Build BCH syndrome lookup tables ---- */
 
 static void build_syndrome_table(uint32_t poly, int nbits, int synbits,
@@ -132,6 +125,8 @@ void frame_decode_init(void)
 {
     build_syndrome_table(BCH_POLY_RA, 31, 10, 2, syn_ra, 1024);
     build_syndrome_table(BCH_POLY_HDR, 7, 4, 1, syn_hdr, 16);
+    if (!code_ra.err && bch_code_init(&code_ra, BCH_POLY_RA, 2) != 0)
+        errx(1, "frame_decode_init: out of memory");
 }
 
 int bch_31_21_correct(uint32_t syndrome, uint32_t *locator)
@@ -151,51 +146,46 @@ int bch_31_21_correct(uint32_t syndrome, uint32_t *locator)
  *
  * de_interleave: 64 input bits → 2 × 32 output bits
  * de_interleave3: 96 input bits → 3 × 32 output bits
+ *
+ * Blocks are read from the packed frame and come out as 32-bit words,
+ * first bit in the MSB.
  */
 
-static void de_interleave(const uint8_t *in, uint8_t *out1, uint8_t *out2)
+static void de_interleave(const uint64_t *in, int pos,
+                           uint32_t *out1, uint32_t *out2)
 {
     /* iridium-toolkit applies symbol_reverse (pair-swap) to the raw bitstream
      * BEFORE de_interleave, and de_interleave has its own internal pair-swap.
      * The two swaps cancel out. Since we don't pre-swap, we skip the internal
      * pair-swap too, achieving the same net result. */
+    uint64_t x = bits_get(in, pos, 64);
 
-    /* Odd symbol indices in reverse → out1 (32 bits) */
-    int p = 0;
-    for (int s = 31; s >= 1; s -= 2) {
-        out1[p++] = in[2 * s];
-        out1[p++] = in[2 * s + 1];
-    }
-
-    /* Even symbol indices in reverse → out2 (32 bits) */
-    p = 0;
-    for (int s = 30; s >= 0; s -= 2) {
-        out2[p++] = in[2 * s];
-        out2[p++] = in[2 * s + 1];
-    }
+    /* Odd symbol indices in reverse → out1, even ones → out2 */
+    *out1 = sym_odd_rev(x);
+    *out2 = sym_even_rev(x);
 }
 
-static void de_interleave3(const uint8_t *in,
-                             uint8_t *out1, uint8_t *out2, uint8_t *out3)
+static void de_interleave3(const uint64_t *in, int pos,
+                             uint32_t *out1, uint32_t *out2, uint32_t *out3)
 {
     /* Same as de_interleave: no pair-swap needed since we don't pre-swap.
      * Three-way split with reverse stride-3:
      * first:  symbols[47, 44, 41, ..., 2]  → 16 symbols = 32 bits
      * second: symbols[46, 43, 40, ..., 1]  → 16 symbols = 32 bits
      * third:  symbols[45, 42, 39, ..., 0]  → 16 symbols = 32 bits */
-    int p1 = 0, p2 = 0, p3 = 0;
-    for (int s = 47; s >= 2; s -= 3) {
-        out1[p1++] = in[2 * s];
-        out1[p1++] = in[2 * s + 1];
-    }
-    for (int s = 46; s >= 1; s -= 3) {
-        out2[p2++] = in[2 * s];
-        out2[p2++] = in[2 * s + 1];
-    }
-    for (int s = 45; s >= 0; s -= 3) {
-        out3[p3++] = in[2 * s];
-        out3[p3++] = in[2 * s + 1];
+    uint64_t hi = bits_get(in, pos, 64);         /* symbols 0-31 */
+    uint64_t lo = bits_get(in, pos + 64, 32);    /* symbols 32-47 */
+    uint32_t o[3] = { 0, 0, 0 };
+
+    for (int s = 47; s >= 0; s--) {
+        uint32_t sym = s < 32 ? (uint32_t)(hi >> (62 - 2 * s)) & 3
+                              : (uint32_t)(lo >> (94 - 2 * s)) & 3;
+        int k = (47 - s) % 3;
+        o[k] = (o[k] << 2) | sym;
     }
+    *out1 = o[0];
+    *out2 = o[1];
+    *out3 = o[2];
 }
 
 /* ---- Soft de-interleaving (LLR follows same permutation as bits) ---- */
@@ -216,105 +206,33 @@ static void de_interleave_llr(const float *in, float *out1, float *out2)
 
 /* ---- Chase BCH(31,21) decoder ----
  *
- * When standard BCH fails (>2 errors), flip the least-reliable bit
- * positions (guided by LLR) and retry. With CHASE_FLIP_BITS=5 and
- * BCH t=2, can correct up to 7 errors if the right positions are flipped.
+ * When standard BCH fails (>2 errors), search the chase_bits least-reliable
+ * bit positions (guided by LLR); see bch_chase.h. With 5 bits and BCH
+ * t=2, can correct up to 7 errors if the right positions are flipped.
  */
 
-static int chase_bch_decode_p(const uint8_t *block32, const float *llr32,
-                                uint8_t *out_data, uint8_t *out_check)
+static int chase_bch_decode_p(uint32_t block32, const float *llr32,
+                                uint32_t *out_cw)
 {
-    /* Try standard BCH first */
-    uint32_t val = bits_to_uint(block32, 31);
-    uint32_t syndrome = gf2_remainder(BCH_POLY_RA, val);
-
-    if (syndrome == 0) {
-        uint_to_bits(val >> 10, out_data, BCH_RA_DATA);
-        uint_to_bits(val & 0x3FF, out_check, 10);
-        return 0;
-    }
-
-    if (syndrome < 1024 && syn_ra[syndrome].errs >= 0) {
-        val ^= syn_ra[syndrome].locator;
-        uint_to_bits(val >> 10, out_data, BCH_RA_DATA);
-        uint_to_bits(val & 0x3FF, out_check, 10);
-        return syn_ra[syndrome].errs;
-    }
-
-    /* Standard BCH failed -- Chase decode with soft info */
-    if (!llr32)
-        return -1;
-
-    /* Find CHASE_FLIP_BITS least-reliable positions within the 31-bit codeword.
-     * Simple partial selection sort (N=5 from 31 elements). */
-    int pos[31];
-    for (int i = 0; i < 31; i++)
-        pos[i] = i;
-
-    for (int i = 0; i < CHASE_FLIP_BITS; i++) {
-        int min_idx = i;
-        for (int j = i + 1; j < 31; j++) {
-            if (llr32[pos[j]] < llr32[pos[min_idx]])
-                min_idx = j;
-        }
-        int tmp = pos[i];
-        pos[i] = pos[min_idx];
-        pos[min_idx] = tmp;
-    }
-
-    /* Pre-compute flip masks for each candidate position.
-     * bits_to_uint puts bit[0] at bit position 30, bit[k] at position (30-k). */
-    uint32_t flip_mask[CHASE_FLIP_BITS];
-    for (int i = 0; i < CHASE_FLIP_BITS; i++)
-        flip_mask[i] = 1u << (30 - pos[i]);
-
-    /* Try all 2^CHASE_FLIP_BITS - 1 non-zero combinations */
-    uint32_t base_val = bits_to_uint(block32, 31);
-    for (int mask = 1; mask < (1 << CHASE_FLIP_BITS); mask++) {
-        uint32_t flipped = base_val;
-        for (int b = 0; b < CHASE_FLIP_BITS; b++) {
-            if (mask & (1 << b))
-                flipped ^= flip_mask[b];
-        }
-
-        syndrome = gf2_remainder(BCH_POLY_RA, flipped);
-        if (syndrome == 0) {
-            uint_to_bits(flipped >> 10, out_data, BCH_RA_DATA);
-            uint_to_bits(flipped & 0x3FF, out_check, 10);
-            return 0;
-        }
-        if (syndrome < 1024 && syn_ra[syndrome].errs >= 0) {
-            flipped ^= syn_ra[syndrome].locator;
-            uint_to_bits(flipped >> 10, out_data, BCH_RA_DATA);
-            uint_to_bits(flipped & 0x3FF, out_check, 10);
-            return syn_ra[syndrome].errs;
-        }
-    }
-
-    return -1;
+    /* The 32nd bit is parity */
+    return bch_chase_decode(&code_ra, block32 >> 1, llr32, chase_bits, out_cw);
 }
 
 /* ---- IRA field extraction ---- */
 
-static int extract_signed12(const uint8_t *bits)
+static int extract_signed12(const uint64_t *bits, int pos)
 {
     /* 12-bit signed: bit[0] is sign, bits[1:12] are magnitude */
-    int sign = bits[0];
-    int mag = 0;
-    for (int i = 1; i < 12; i++)
-        mag = (mag << 1) | bits[i];
-    return sign ? (mag - (1 << 11)) : mag;
+    int v = (int)bits_get(bits, pos, 12);
+    return (v & 0x800) ? ((v & 0x7FF) - (1 << 11)) : v;
 }
 
-static int extract_uint(const uint8_t *bits, int n)
+static int extract_uint(const uint64_t *bits, int pos, int n)
 {
-    int val = 0;
-    for (int i = 0; i < n; i++)
-        val = (val << 1) | bits[i];
-    return val;
+    return (int)bits_get(bits, pos, n);
 }
 
-static void parse_ira(const uint8_t *bch_data, int n_bits, ira_data_t *ira)
+static void parse_ira(const uint64_t *bch_data, int n_bits, ira_data_t *ira)
 {
     memset(ira, 0, sizeof(*ira));
 
@@ -322,12 +240,12 @@ static void parse_ira(const uint8_t *bch_data, int n_bits, ira_data_t *ira)
         return;
 
     /* IRA header: 63 bits */
-    ira->sat_id  = extract_uint(&bch_data[0], 7);
-    ira->beam_id = extract_uint(&bch_data[7], 6);
+    ira->sat_id  = extract_uint(bch_data, 0, 7);
+    ira->beam_id = extract_uint(bch_data, 7, 6);
 
-    int pos_x = extract_signed12(&bch_data[13]);
-    int pos_y = extract_signed12(&bch_data[25]);
-    int pos_z = extract_signed12(&bch_data[37]);
+    int pos_x = extract_signed12(bch_data, 13);
+    int pos_y = extract_signed12(bch_data, 25);
+    int pos_z = extract_signed12(bch_data, 37);
 
     /* Store raw XYZ for Doppler positioning */
     ira->pos_xyz[0] = pos_x;
@@ -345,27 +263,18 @@ static void parse_ira(const uint8_t *bch_data, int n_bits, ira_data_t *ira)
     ira->n_pages = 0;
     int offset = 63;
     while (offset + 42 <= n_bits && ira->n_pages < 12) {
-        const uint8_t *page = &bch_data[offset];
-
         /* Check for all-1s terminator */
-        int all_ones = 1;
-        for (int i = 0; i < 42; i++) {
-            if (!page[i]) { all_ones = 0; break; }
-        }
-        if (all_ones) break;
+        if (bits_get(bch_data, offset, 42) == (1ULL << 42) - 1)
+            break;
 
-        uint32_t tmsi = 0;
-        for (int i = 0; i < 32; i++)
-            tmsi = (tmsi << 1) | page[i];
-
-        ira->pages[ira->n_pages].tmsi = tmsi;
-        ira->pages[ira->n_pages].msc_id = extract_uint(&page[34], 5);
+        ira->pages[ira->n_pages].tmsi = (uint32_t)bits_get(bch_data, offset, 32);
+        ira->pages[ira->n_pages].msc_id = extract_uint(bch_data, offset + 34, 5);
         ira->n_pages++;
         offset += 42;
     }
 }
 
-static void parse_ibc(const uint8_t *bch_data, int n_bits,
+static void parse_ibc(const uint64_t *bch_data, int n_bits,
                         int hdr_type, ibc_data_t *ibc)
 {
     memset(ibc, 0, sizeof(*ibc));
@@ -375,19 +284,17 @@ static void parse_ibc(const uint8_t *bch_data, int n_bits,
         return;
 
     /* Block 1: satellite/beam info (first 42 data bits) */
-    ibc->sat_id      = extract_uint(&bch_data[0], 7);
-    ibc->beam_id     = extract_uint(&bch_data[7], 6);
-    ibc->timeslot    = bch_data[14];
-    ibc->sv_blocking = bch_data[15];
+    ibc->sat_id      = extract_uint(bch_data, 0, 7);
+    ibc->beam_id     = extract_uint(bch_data, 7, 6);
+    ibc->timeslot    = bits_test(bch_data, 14);
+    ibc->sv_blocking = bits_test(bch_data, 15);
 
     /* Block 2: type-dependent (next 42 data bits, if available) */
     if (n_bits >= 84) {
-        int type = extract_uint(&bch_data[42], 6);
+        int type = extract_uint(bch_data, 42, 6);
         if (type == 1) {
             /* LBFC (Iridium time counter) */
-            ibc->iri_time = 0;
-            for (int i = 52; i < 84; i++)
-                ibc->iri_time = (ibc->iri_time << 1) | bch_data[i];
+            ibc->iri_time = (uint32_t)bits_get(bch_data, 52, 32);
         }
     }
 }
@@ -396,22 +303,232 @@ static void parse_ibc(const uint8_t *bch_data, int n_bits,
  * The 32nd bit is an overall parity bit. After BCH correction,
  * data + bch + parity must have even weight. */
 
-static int check_parity32(const uint8_t *block32, const uint8_t *bch_data,
-                            int n_data, const uint8_t *bch_check, int n_check)
+static int check_parity32(uint32_t block32, uint32_t codeword)
+{
+    return (__builtin_parity(codeword) ^ (block32 & 1)) == 0;
+}
+
+/* Append the data bits of a corrected BCH(31,21) codeword */
+static int append_data(uint64_t *stream, int len, uint32_t codeword)
 {
-    int ones = 0;
-    for (int i = 0; i < n_data; i++) ones += bch_data[i];
-    for (int i = 0; i < n_check; i++) ones += bch_check[i];
-    ones += block32[31];  /* parity bit */
-    return (ones % 2) == 0;
+    bits_put(stream, len, codeword >> 10, BCH_RA_DATA);
+    return len + BCH_RA_DATA;
 }
 
 /* bch_decode_p: superseded by chase_bch_decode_p which includes
  * the same standard BCH decode as its first step. */
 
+/* IBC header: BCH(7,3) over the 6 bits after the access code (the 7th
+ * bit is implied zero). Returns 1 and the corrected value if it checks. */
+static int ibc_header(const uint64_t *data, int base, uint32_t *hdr)
+{
+    uint32_t val = (uint32_t)bits_get(data, base, 6);
+    uint32_t syn = gf2_remainder(BCH_POLY_HDR, val);
+
+    if (syn != 0) {
+        if (syn >= 16 || syn_hdr[syn].errs < 0)
+            return 0;
+        val ^= syn_hdr[syn].locator;
+    }
+    *hdr = val;
+    return 1;
+}
+
+/* ---- Frame classification ----
+ *
+ * Hard-decision checks only: the access code, the band, the IBC header
+ * and first block pair, and the LCW frame type. No Chase search, so a
+ * frame costs a few table lookups whatever it turns out to be.
+ */
+
+frame_class_t frame_classify(const demod_frame_t *frame, int *maybe_ibc)
+{
+    *maybe_ibc = 0;
+
+    if (frame->n_bits < 24 + 64)
+        return FRAME_CLASS_NONE;
+
+    uint32_t access = (uint32_t)bits_get(frame->bits, 0, 24);
+    int access_ok = access == ACCESS_DL || access == ACCESS_UL;
+
+    /* Ring alerts (and the other simplex types, which no decoder here
+     * handles) are the only frames in the simplex band */
+    if (frame->center_frequency > IR_SIMPLEX_FREQUENCY_MIN)
+        return access_ok ? FRAME_CLASS_IRA : FRAME_CLASS_OTHER;
+
+    /* IBC: header and first block pair decode without soft help */
+    int ibc = 0;
+    uint32_t hdr;
+    if (access_ok && frame->n_bits >= 24 + 6 + 64 &&
+        ibc_header(frame->bits, 24, &hdr)) {
+        uint32_t di1, di2, cw1, cw2;
+        de_interleave(frame->bits, 24 + 6, &di1, &di2);
+        ibc = chase_bch_decode_p(di1, NULL, &cw1) >= 0 &&
+              chase_bch_decode_p(di2, NULL, &cw2) >= 0 &&
+              check_parity32(di1, cw1) && check_parity32(di2, cw2);
+        *maybe_ibc = 1;
+    }
+
+    /* A valid LCW saying IDA wins: random data passes the IBC checks
+     * far more often than it passes the LCW checks with ft=2 */
+    lcw_t lcw;
+    int lcw_ok = ida_decode_lcw(frame, &lcw);
+    if (lcw_ok && lcw.ft == 2)
+        return FRAME_CLASS_IDA;
+    if (ibc)
+        return FRAME_CLASS_IBC;
+    if (lcw_ok && lcw.ft == 0)
+        return FRAME_CLASS_VOC;
+
+    /* Header checks: soft decoding might still recover the blocks */
+    return *maybe_ibc ? FRAME_CLASS_IBC : FRAME_CLASS_OTHER;
+}
+
+/* ---- IBC decode ----
+ * Header: 6 bits BCH(7,3), then 64-bit de-interleaved data blocks.
+ * Detection: BCH correction on header + first data blocks. */
+
+static int decode_ibc(const uint64_t *data, int base, const float *data_llr,
+                      int data_len, decoded_frame_t *out)
+{
+    uint32_t hdr_val;
+    if (data_len < 6 + 64 || !ibc_header(data, base, &hdr_val))
+        return 0;
+
+    /* De-interleave first 64-bit block after header */
+    uint32_t di1, di2;
+    float li1[32], li2[32];
+    de_interleave(data, base + 6, &di1, &di2);
+    if (data_llr)
+        de_interleave_llr(data_llr + 6, li1, li2);
+
+    /* BCH correction on first data blocks */
+    uint32_t cw1, cw2;
+    int e1 = chase_bch_decode_p(di1, data_llr ? li1 : NULL, &cw1);
+    int e2 = chase_bch_decode_p(di2, data_llr ? li2 : NULL, &cw2);
+
+    if (e1 < 0 || e2 < 0 ||
+        !check_parity32(di1, cw1) || !check_parity32(di2, cw2))
+        return 0;
+
+    /* IBC confirmed -- decode all blocks */
+    int bc_type = (int)(hdr_val >> 4) & 0x7;
+    int ibc_max = 262;
+    if (data_len < ibc_max) ibc_max = data_len;
+
+    uint64_t bch_stream[BITPACK_WORDS(256)] = { 0 };
+    int bch_len = 0;
+
+    bch_len = append_data(bch_stream, bch_len, cw1);
+    bch_len = append_data(bch_stream, bch_len, cw2);
+
+    /* Remaining 64-bit blocks with Chase BCH + parity */
+    int offset = 6 + 64;
+    while (offset + 64 <= ibc_max && bch_len + 2 * BCH_RA_DATA <= 256) {
+        de_interleave(data, base + offset, &di1, &di2);
+        if (data_llr && offset + 64 <= data_len)
+            de_interleave_llr(data_llr + offset, li1, li2);
+        int ea = chase_bch_decode_p(di1,
+                    data_llr ? li1 : NULL, &cw1);
+        int eb = chase_bch_decode_p(di2,
+                    data_llr ? li2 : NULL, &cw2);
+        if (ea < 0 || eb < 0) break;
+        if (!check_parity32(di1, cw1)) break;
+        if (!check_parity32(di2, cw2)) break;
+        bch_len = append_data(bch_stream, bch_len, cw1);
+        bch_len = append_data(bch_stream, bch_len, cw2);
+        offset += 64;
+    }
+
+    out->type = FRAME_IBC;
+    parse_ibc(bch_stream, bch_len, bc_type, &out->ibc);
+    return 1;
+}
+
+/* ---- IRA decode ----
+ * First 96 bits: de_interleave3 → 3 × 32-bit blocks.
+ * Detection: Chase BCH correction on all 3 header blocks + parity.
+ * BCH(31,21) t=2 corrects up to 2 errors per block; Chase extends
+ * this with soft info. Three-block parity gate keeps false-positive
+ * rate negligible even with correction enabled. */
+
+static int decode_ira(const uint64_t *data, int base, const float *data_llr,
+                      int data_len, decoded_frame_t *out)
+{
+    if (data_len < 96)
+        return 0;
+
+    uint32_t ra1, ra2, ra3;
+    float la1[32], la2[32], la3[32];
+    de_interleave3(data, base, &ra1, &ra2, &ra3);
+
+    /* De-interleave LLR if available (for Chase decoder) */
+    if (data_llr) {
+        int p1 = 0, p2 = 0, p3 = 0;
+        for (int s = 47; s >= 2; s -= 3) {
+            la1[p1++] = data_llr[2 * s];
+            la1[p1++] = data_llr[2 * s + 1];
+        }
+        for (int s = 46; s >= 1; s -= 3) {
+            la2[p2++] = data_llr[2 * s];
+            la2[p2++] = data_llr[2 * s + 1];
+        }
+        for (int s = 45; s >= 0; s -= 3) {
+            la3[p3++] = data_llr[2 * s];
+            la3[p3++] = data_llr[2 * s + 1];
+        }
+    }
+
+    /* Chase BCH correction on all 3 header blocks */
+    uint32_t c1, c2, c3;
+    int e1 = chase_bch_decode_p(ra1, data_llr ? la1 : NULL, &c1);
+    int e2 = chase_bch_decode_p(ra2, data_llr ? la2 : NULL, &c2);
+    int e3 = chase_bch_decode_p(ra3, data_llr ? la3 : NULL, &c3);
+
+    if (e1 < 0 || e2 < 0 || e3 < 0 ||
+        !check_parity32(ra1, c1) ||
+        !check_parity32(ra2, c2) ||
+        !check_parity32(ra3, c3))
+        return 0;
+
+    /* IRA confirmed -- assemble decoded data */
+    uint64_t bch_stream[BITPACK_WORDS(512)] = { 0 };
+    int bch_len = 0;
+
+    bch_len = append_data(bch_stream, bch_len, c1);
+    bch_len = append_data(bch_stream, bch_len, c2);
+    bch_len = append_data(bch_stream, bch_len, c3);
+
+    /* Remaining 64-bit blocks with Chase BCH + parity */
+    uint32_t di1, di2;
+    float li1[32], li2[32];
+    uint32_t rc1, rc2;
+    int offset = 96;
+    while (offset + 64 <= data_len && bch_len + 2 * BCH_RA_DATA <= 512) {
+        de_interleave(data, base + offset, &di1, &di2);
+        if (data_llr)
+            de_interleave_llr(data_llr + offset, li1, li2);
+        int ea = chase_bch_decode_p(di1,
+                    data_llr ? li1 : NULL, &rc1);
+        int eb = chase_bch_decode_p(di2,
+                    data_llr ? li2 : NULL, &rc2);
+        if (ea < 0 || eb < 0) break;
+        if (!check_parity32(di1, rc1)) break;
+        if (!check_parity32(di2, rc2)) break;
+        bch_len = append_data(bch_stream, bch_len, rc1);
+        bch_len = append_data(bch_stream, bch_len, rc2);
+        offset += 64;
+    }
+
+    out->type = FRAME_IRA;
+    parse_ira(bch_stream, bch_len, &out->ira);
+    return 1;
+}
+
 /* ---- Main decode function ---- */
 
-int frame_decode(const demod_frame_t *frame, decoded_frame_t *out)
+int frame_decode_as(const demod_frame_t *frame, frame_class_t cls,
+                    decoded_frame_t *out)
 {
     memset(out, 0, sizeof(*out));
     out->type = FRAME_UNKNOWN;
@@ -425,174 +542,26 @@ int frame_decode(const demod_frame_t *frame, decoded_frame_t *out)
         return 0;
 
     /* Verify access code */
-    int is_dl = (memcmp(frame->bits, access_dl, 24) == 0);
-    int is_ul = (memcmp(frame->bits, access_ul, 24) == 0);
-    if (!is_dl && !is_ul)
+    uint32_t access = (uint32_t)bits_get(frame->bits, 0, 24);
+    if (access != ACCESS_DL && access != ACCESS_UL)
         return 0;
 
     /* Frame data starts after the access code */
-    const uint8_t *data = frame->bits + 24;
+    const uint64_t *data = frame->bits;
+    const int base = 24;
     const float *data_llr = frame->llr ? frame->llr + 24 : NULL;
     int data_len = frame->n_bits - 24;
 
-    /* ---- Try IBC detection ----
-     * Header: 6 bits BCH(7,3), then 64-bit de-interleaved data blocks.
-     * Detection: BCH correction on header + first data blocks. */
-    if (data_len >= 6 + 64) {
-        /* Check IBC header (BCH(7,3) with error correction) */
-        uint32_t hdr_val = bits_to_uint(data, 6);
-        uint32_t hdr_syn = gf2_remainder(BCH_POLY_HDR, hdr_val);
-        int hdr_ok = 0;
-
-        if (hdr_syn == 0) {
-            hdr_ok = 1;
-        } else if (hdr_syn < 16 && syn_hdr[hdr_syn].errs >= 0) {
-            hdr_val ^= syn_hdr[hdr_syn].locator;
-            hdr_ok = 1;
-        }
-
-        if (hdr_ok) {
-            uint8_t hdr_data[3];
-            uint_to_bits(hdr_val >> 4, hdr_data, 3);
-
-            /* De-interleave first 64-bit block after header */
-            uint8_t di1[32], di2[32];
-            float li1[32], li2[32];
-            de_interleave(data + 6, di1, di2);
-            if (data_llr && data_len >= 6 + 64)
-                de_interleave_llr(data_llr + 6, li1, li2);
-
-            /* BCH correction on first data blocks */
-            uint8_t d1[BCH_RA_DATA], d2[BCH_RA_DATA];
-            uint8_t rc1[10], rc2[10];
-            int e1 = chase_bch_decode_p(di1,
-                        data_llr ? li1 : NULL, d1, rc1);
-            int e2 = chase_bch_decode_p(di2,
-                        data_llr ? li2 : NULL, d2, rc2);
-
-            if (e1 >= 0 && e2 >= 0 &&
-                check_parity32(di1, d1, BCH_RA_DATA, rc1, 10) &&
-                check_parity32(di2, d2, BCH_RA_DATA, rc2, 10)) {
-                /* IBC confirmed -- decode all blocks */
-                int bc_type = extract_uint(hdr_data, 3);
-                int ibc_max = 262;
-                if (data_len < ibc_max) ibc_max = data_len;
-
-                uint8_t bch_stream[256];
-                int bch_len = 0;
-
-                memcpy(bch_stream + bch_len, d1, BCH_RA_DATA);
-                bch_len += BCH_RA_DATA;
-                memcpy(bch_stream + bch_len, d2, BCH_RA_DATA);
-                bch_len += BCH_RA_DATA;
-
-                /* Remaining 64-bit blocks with Chase BCH + parity */
-                int offset = 6 + 64;
-                while (offset + 64 <= ibc_max && bch_len + 2 * BCH_RA_DATA <= (int)sizeof(bch_stream)) {
-                    de_interleave(data + offset, di1, di2);
-                    if (data_llr && offset + 64 <= data_len)
-                        de_interleave_llr(data_llr + offset, li1, li2);
-                    int ea = chase_bch_decode_p(di1,
-                                data_llr ? li1 : NULL, d1, rc1);
-                    int eb = chase_bch_decode_p(di2,
-                                data_llr ? li2 : NULL, d2, rc2);
-                    if (ea < 0 || eb < 0) break;
-                    if (!check_parity32(di1, d1, BCH_RA_DATA, rc1, 10)) break;
-                    if (!check_parity32(di2, d2, BCH_RA_DATA, rc2, 10)) break;
-                    memcpy(bch_stream + bch_len, d1, BCH_RA_DATA);
-                    bch_len += BCH_RA_DATA;
-                    memcpy(bch_stream + bch_len, d2, BCH_RA_DATA);
-                    bch_len += BCH_RA_DATA;
-                    offset += 64;
-                }
-
-                out->type = FRAME_IBC;
-                parse_ibc(bch_stream, bch_len, bc_type, &out->ibc);
-                return 1;
-            }
-        }
-    }
-
-    /* ---- Try IRA detection ----
-     * First 96 bits: de_interleave3 → 3 × 32-bit blocks.
-     * Detection: Chase BCH correction on all 3 header blocks + parity.
-     * BCH(31,21) t=2 corrects up to 2 errors per block; Chase extends
-     * this with soft info. Three-block parity gate keeps false-positive
-     * rate negligible even with correction enabled. */
-    if (data_len >= 96) {
-        uint8_t ra1[32], ra2[32], ra3[32];
-        float la1[32], la2[32], la3[32];
-        de_interleave3(data, ra1, ra2, ra3);
-
-        /* De-interleave LLR if available (for Chase decoder) */
-        if (data_llr) {
-            int p1 = 0, p2 = 0, p3 = 0;
-            for (int s = 47; s >= 2; s -= 3) {
-                la1[p1++] = data_llr[2 * s];
-                la1[p1++] = data_llr[2 * s + 1];
-            }
-            for (int s = 46; s >= 1; s -= 3) {
-                la2[p2++] = data_llr[2 * s];
-                la2[p2++] = data_llr[2 * s + 1];
-            }
-            for (int s = 45; s >= 0; s -= 3) {
-                la3[p3++] = data_llr[2 * s];
-                la3[p3++] = data_llr[2 * s + 1];
-            }
-        }
-
-        /* Chase BCH correction on all 3 header blocks */
-        uint8_t d1[BCH_RA_DATA], d2[BCH_RA_DATA], d3[BCH_RA_DATA];
-        uint8_t c1[10], c2[10], c3[10];
-        int e1 = chase_bch_decode_p(ra1, data_llr ? la1 : NULL, d1, c1);
-        int e2 = chase_bch_decode_p(ra2, data_llr ? la2 : NULL, d2, c2);
-        int e3 = chase_bch_decode_p(ra3, data_llr ? la3 : NULL, d3, c3);
-
-        if (e1 >= 0 && e2 >= 0 && e3 >= 0 &&
-            check_parity32(ra1, d1, BCH_RA_DATA, c1, 10) &&
-            check_parity32(ra2, d2, BCH_RA_DATA, c2, 10) &&
-            check_parity32(ra3, d3, BCH_RA_DATA, c3, 10)) {
-
-            /* IRA confirmed -- assemble decoded data */
-            uint8_t bch_stream[512];
-            int bch_len = 0;
-
-            memcpy(bch_stream + bch_len, d1, BCH_RA_DATA);
-            bch_len += BCH_RA_DATA;
-            memcpy(bch_stream + bch_len, d2, BCH_RA_DATA);
-            bch_len += BCH_RA_DATA;
-            memcpy(bch_stream + bch_len, d3, BCH_RA_DATA);
-            bch_len += BCH_RA_DATA;
-
-            /* Remaining 64-bit blocks with Chase BCH + parity */
-            uint8_t di1[32], di2[32];
-            float li1[32], li2[32];
-            uint8_t rd1[BCH_RA_DATA], rd2[BCH_RA_DATA];
-            uint8_t rc1[10], rc2[10];
-            int offset = 96;
-            while (offset + 64 <= data_len && bch_len + 2 * BCH_RA_DATA <= (int)sizeof(bch_stream)) {
-                de_interleave(data + offset, di1, di2);
-                if (data_llr)
-                    de_interleave_llr(data_llr + offset, li1, li2);
-                int ea = chase_bch_decode_p(di1,
-                            data_llr ? li1 : NULL, rd1, rc1);
-                int eb = chase_bch_decode_p(di2,
-                            data_llr ? li2 : NULL, rd2, rc2);
-                if (ea < 0 || eb < 0) break;
-                if (!check_parity32(di1, rd1, BCH_RA_DATA, rc1, 10)) break;
-                if (!check_parity32(di2, rd2, BCH_RA_DATA, rc2, 10)) break;
-                memcpy(bch_stream + bch_len, rd1, BCH_RA_DATA);
-                bch_len += BCH_RA_DATA;
-                memcpy(bch_stream + bch_len, rd2, BCH_RA_DATA);
-                bch_len += BCH_RA_DATA;
-                offset += 64;
-            }
-
-            out->type = FRAME_IRA;
-            parse_ira(bch_stream, bch_len, &out->ira);
-            return 1;
-        }
-    }
-
+    if (cls != FRAME_CLASS_IRA &&
+        decode_ibc(data, base, data_llr, data_len, out))
+        return 1;
+    if (cls != FRAME_CLASS_IBC &&
+        decode_ira(data, base, data_llr, data_len, out))
+        return 1;
     return 0;
 }
+
+int frame_decode(const demod_frame_t *frame, decoded_frame_t *out)
+{
+    return frame_decode_as(frame, FRAME_CLASS_NONE, out);
+}
@@ -55,16 +55,57 @@ typedef struct {
     };
 } decoded_frame_t;
 
-/* Initialize BCH syndrome tables. Call once at startup. */
+/* What a frame looks like before any soft decoding (frame_classify) */
+typedef enum {
+    FRAME_CLASS_NONE = 0,   /* too short to tell */
+    FRAME_CLASS_IRA,        /* simplex band */
+    FRAME_CLASS_IBC,        /* IBC header checks out */
+    FRAME_CLASS_IDA,        /* LCW frame type 2 */
+    FRAME_CLASS_VOC,        /* LCW frame type 0 */
+    FRAME_CLASS_OTHER,
+    FRAME_CLASS_COUNT
+} frame_class_t;
+
+/* Initialize BCH syndrome tables. Call once at startup, together with
+ * ida_decode_init() if frame_classify() is used. */
 void frame_decode_init(void);
 
+/* Cheap classification from the access code, band, IBC header and first
+ * blocks, and LCW, using hard decisions only. *maybe_ibc is set when the
+ * IBC header checks out, so a frame that fails as the returned class may
+ * still be worth decoding as IBC. */
+frame_class_t frame_classify(const demod_frame_t *frame, int *maybe_ibc);
+
 /* Decode a demodulated frame. Returns 1 if IRA or IBC detected, 0 otherwise. */
 int frame_decode(const demod_frame_t *frame, decoded_frame_t *out);
 
+/* frame_decode() trying only IBC (cls FRAME_CLASS_IBC) or only IRA
+ * (FRAME_CLASS_IRA); any other class tries both. */
+int frame_decode_as(const demod_frame_t *frame, frame_class_t cls,
+                    decoded_frame_t *out);
+
 /* BCH utility functions (shared with ida_decode.c) */
 uint32_t gf2_remainder(uint32_t poly, uint32_t val);
-uint32_t bits_to_uint(const uint8_t *bits, int n);
-void uint_to_bits(uint32_t val, uint8_t *bits, int n);
+
+/* Remainder modulo a fixed polynomial of degree up to 16, one lookup
+ * per byte instead of one shift per bit */
+typedef struct {
+    uint16_t t[256];        /* (t << deg) mod poly */
+    int deg;
+} gf2_mod_table_t;
+
+void gf2_mod_table_init(gf2_mod_table_t *tab, uint32_t poly);
+
+static inline uint32_t gf2_mod32(const gf2_mod_table_t *tab, uint32_t val)
+{
+    uint32_t mask = (1u << tab->deg) - 1;
+    uint32_t r = 0;
+    for (int sh = 24; sh >= 0; sh -= 8) {
+        uint32_t v = (r << 8) | ((val >> sh) & 0xFF);
+        r = (v & mask) ^ tab->t[v >> tab->deg];
+    }
+    return r;
+}
 
 /* BCH(31,21) syndrome correction. Returns error count (0,1,2) or -1.
  * On success, *locator is set to the error XOR mask. */
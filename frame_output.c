@@ -30,18 +30,22 @@
 #include <zmq.h>
 #endif
 
+#include "bitpack.h"
+#include "frame_bin.h"
 #include "frame_output.h"
 #include "iridium.h"
+#include "output_writer.h"
 
 extern int diagnostic_mode;
 extern int parsed_mode;
 extern int acars_enabled;
+extern int output_format;
 
 static const char *out_file_info = NULL;
 static uint64_t t0 = 0;
 static int initialized = 0;
 
-/* ---- Line buffer for ZMQ publishing ---- */
+/* ---- Line buffer ---- */
 
 #define LINE_BUF_SIZE 8192
 static char line_buf[LINE_BUF_SIZE];
@@ -67,6 +71,34 @@ static void buf_char(int c) {
         line_buf[line_pos++] = (char)c;
 }
 
+/* ---- Shared-memory ring (--shm) ---- */
+
+static shm_ring_t *shm_ring = NULL;
+#define SHM_ACTIVE (shm_ring != NULL)
+
+/* ---- Binary records (--format-out=bin) ---- */
+
+static uint8_t bin_buf[FRAME_BIN_MAX_RECORD];
+static int bin_stream_sent = 0;
+
+static void print_bin(const demod_frame_t *frame, int dest) {
+    dest |= OUTPUT_BINARY;
+
+    /* The RAW time origin and file_info go once, ahead of the first frame */
+    if (!bin_stream_sent) {
+        size_t n = frame_bin_encode_stream(bin_buf, sizeof(bin_buf), t0,
+                                           out_file_info);
+        output_writer_put((const char *)bin_buf, n, dest);
+        if (shm_ring)
+            shm_ring_set_preamble(shm_ring, bin_buf, n);
+        bin_stream_sent = 1;
+    }
+
+    size_t n = frame_bin_encode_frame(bin_buf, sizeof(bin_buf), frame,
+                                      output_format == OUTFMT_BIN_LLR);
+    output_writer_put((const char *)bin_buf, n, dest);
+}
+
 /* ---- ZMQ PUB socket ---- */
 
 #ifdef HAVE_ZMQ
@@ -77,30 +109,42 @@ static void *zmq_pub_socket = NULL;
 #define ZMQ_ACTIVE 0
 #endif
 
+/* Destinations other than stdout */
+static int other_dests(void) {
+    return (ZMQ_ACTIVE ? OUTPUT_ZMQ : 0) | (SHM_ACTIVE ? OUTPUT_SHM : 0);
+}
+
+/* Hand the finished line to the output writer, which batches it for
+ * stdout, ZMQ and the shared-memory ring */
 static void buf_flush(int to_stdout) {
-    line_buf[line_pos] = '\0';
+    output_writer_put(line_buf, line_pos,
+                      (to_stdout ? OUTPUT_STDOUT : 0) | other_dests());
+}
 
-    if (to_stdout && line_pos > 0) {
-        fwrite(line_buf, 1, line_pos, stdout);
-        fflush(stdout);
-    }
+/* ---- Public API ---- */
+
+void frame_output_init(const char *fi)
+{
+    out_file_info = fi;
+}
 
+void frame_output_start(int flush_ms)
+{
 #ifdef HAVE_ZMQ
-    if (zmq_pub_socket && line_pos > 0) {
-        /* ZMQ messages are framed, strip trailing newline */
-        int len = line_pos;
-        if (len > 0 && line_buf[len - 1] == '\n')
-            len--;
-        zmq_send(zmq_pub_socket, line_buf, len, 0);
-    }
+    output_writer_init(flush_ms, zmq_pub_socket, shm_ring);
+#else
+    output_writer_init(flush_ms, NULL, shm_ring);
 #endif
 }
 
-/* ---- Public API ---- */
+void frame_output_flush(void)
+{
+    output_writer_flush();
+}
 
-void frame_output_init(const char *fi)
+void frame_output_shutdown(void)
 {
-    out_file_info = fi;
+    output_writer_shutdown();
 }
 
 #ifdef HAVE_ZMQ
@@ -141,6 +185,19 @@ void frame_output_zmq_shutdown(void)
 }
 #endif
 
+int frame_output_shm_init(const char *name, size_t bytes)
+{
+    shm_ring = shm_ring_create(name, bytes, output_format == OUTFMT_RAW ?
+                               SHM_RING_TEXT : SHM_RING_BIN);
+    return shm_ring ? 0 : -1;
+}
+
+void frame_output_shm_shutdown(void)
+{
+    shm_ring_destroy(shm_ring);
+    shm_ring = NULL;
+}
+
 static void ensure_initialized(uint64_t timestamp)
 {
     if (initialized)
@@ -157,16 +214,27 @@ static void ensure_initialized(uint64_t timestamp)
     initialized = 1;
 }
 
+void frame_output_set_epoch(uint64_t timestamp)
+{
+    ensure_initialized(timestamp);
+}
+
 void frame_output_print(demod_frame_t *frame)
 {
     int suppress_stdout = diagnostic_mode || acars_enabled;
 
     /* Skip entirely if nothing would receive the output */
-    if (suppress_stdout && !ZMQ_ACTIVE)
+    if (suppress_stdout && !other_dests())
         return;
 
     ensure_initialized(frame->timestamp);
 
+    if (output_format != OUTFMT_RAW) {
+        print_bin(frame, (suppress_stdout ? 0 : OUTPUT_STDOUT) |
+                         other_dests());
+        return;
+    }
+
     /* Relative timestamp in milliseconds */
     double ts_ms = (double)(frame->timestamp - t0) / 1000000.0;
 
@@ -192,7 +260,7 @@ void frame_output_print(demod_frame_t *frame)
                payload_syms);
 
     for (int i = 0; i < frame->n_bits; i++)
-        buf_char('0' + frame->bits[i]);
+        buf_char('0' + bits_test(frame->bits, i));
 
     buf_char('\n');
     buf_flush(!suppress_stdout);
@@ -204,7 +272,7 @@ void frame_output_print_ida(const ida_burst_t *burst)
 {
     int suppress_stdout = diagnostic_mode;
 
-    if (suppress_stdout && !ZMQ_ACTIVE)
+    if (suppress_stdout && !other_dests())
         return;
 
     ensure_initialized(burst->timestamp);
@@ -245,7 +313,7 @@ void frame_output_print_ida(const ida_burst_t *burst)
     buf_printf("%s", burst->lcw_header);
 
     /* IDA-specific fields from bch_stream */
-    const uint8_t *bs = burst->bch_stream;
+    const uint64_t *bs = burst->bch_stream;
     int bch_len = burst->bch_len;
 
     if (bch_len < 20) {
@@ -254,20 +322,21 @@ void frame_output_print_ida(const ida_burst_t *burst)
         return;
     }
 
+#define BS(i) ('0' + bits_test(bs, (i)))
     /* bits[0:3] */
-    buf_printf("%c%c%c", '0' + bs[0], '0' + bs[1], '0' + bs[2]);
+    buf_printf("%c%c%c", BS(0), BS(1), BS(2));
     /* cont=bits[3:4] */
-    buf_printf(" cont=%c", '0' + bs[3]);
+    buf_printf(" cont=%c", BS(3));
     /* bits[4:5] */
-    buf_printf(" %c", '0' + bs[4]);
+    buf_printf(" %c", BS(4));
     /* ctr=bits[5:8] */
-    buf_printf(" ctr=%c%c%c", '0' + bs[5], '0' + bs[6], '0' + bs[7]);
+    buf_printf(" ctr=%c%c%c", BS(5), BS(6), BS(7));
     /* bits[8:11] */
-    buf_printf(" %c%c%c", '0' + bs[8], '0' + bs[9], '0' + bs[10]);
+    buf_printf(" %c%c%c", BS(8), BS(9), BS(10));
     /* len=da_len */
     buf_printf(" len=%02d", burst->da_len);
     /* 0:bits[16:20] (bitsparser.py hardcodes "0:" prefix) */
-    buf_printf(" 0:%c%c%c%c", '0' + bs[16], '0' + bs[17], '0' + bs[18], '0' + bs[19]);
+    buf_printf(" 0:%c%c%c%c", BS(16), BS(17), BS(18), BS(19));
 
     /* Hex data payload */
     buf_printf(" [");
@@ -337,7 +406,7 @@ void frame_output_print_ida(const ida_burst_t *burst)
     if (bch_len > 9 * 20 + 16) {
         buf_printf(" ");
         for (int i = 9 * 20 + 16; i < bch_len; i++)
-            buf_printf("%c", '0' + bs[i]);
+            buf_char(BS(i));
     } else {
         buf_printf(" 0000");
     }
@@ -347,9 +416,7 @@ void frame_output_print_ida(const ida_burst_t *burst)
         buf_printf(" SBD: ");
         for (int i = 0; i < 20; i++) {
             /* Extract byte from bch_stream bits[1*20 .. 9*20] */
-            int byte = 0;
-            for (int b = 0; b < 8; b++)
-                byte = (byte << 1) | bs[1 * 20 + i * 8 + b];
+            int byte = (int)bits_get(bs, 1 * 20 + i * 8, 8);
             if (byte >= 32 && byte < 127)
                 buf_char(byte);
             else
@@ -357,6 +424,7 @@ void frame_output_print_ida(const ida_burst_t *burst)
         }
     }
 
+#undef BS
     buf_char('\n');
     buf_flush(!suppress_stdout);
 }
@@ -16,11 +16,35 @@
 
 #include "qpsk_demod.h"
 
+/* --format-out */
+typedef enum {
+    OUTFMT_RAW = 0,     /* iridium-toolkit RAW text lines */
+    OUTFMT_BIN,         /* frame_bin.h records */
+    OUTFMT_BIN_LLR,     /* frame_bin.h records with bit reliabilities */
+} out_format_t;
+
 /* Initialize frame output. file_info is borrowed, must remain valid.
  * If NULL, auto-generates from first timestamp. */
 void frame_output_init(const char *file_info);
 
-/* Print one demodulated frame in iridium-toolkit RAW format to stdout. */
+/* Start the batching output writer (after any ZMQ socket is bound).
+ * Lines are written when flush_ms have passed since the oldest unwritten
+ * one, or when the buffer fills; 0, or a terminal on stdout, writes every
+ * line immediately. */
+void frame_output_start(int flush_ms);
+
+/* Write out every line printed so far */
+void frame_output_flush(void);
+
+/* Flush and stop the output writer */
+void frame_output_shutdown(void);
+
+/* Fix the RAW time origin to the second containing timestamp instead of
+ * the first frame's, so separate processes over one recording agree. */
+void frame_output_set_epoch(uint64_t timestamp);
+
+/* Print one demodulated frame in iridium-toolkit RAW format to stdout, or
+ * as a binary record with --format-out=bin. */
 void frame_output_print(demod_frame_t *frame);
 
 #include "ida_decode.h"
@@ -28,6 +52,12 @@ void frame_output_print(demod_frame_t *frame);
 /* Print one decoded IDA burst in iridium-parser.py parsed format to stdout. */
 void frame_output_print_ida(const ida_burst_t *burst);
 
+/* Shared-memory ring output (shm_ring.h) for local readers, RAW lines or
+ * binary records as --format-out says. Call before frame_output_start();
+ * shut down after frame_output_shutdown(). */
+int frame_output_shm_init(const char *name, size_t bytes);
+void frame_output_shm_shutdown(void);
+
 /* ZMQ PUB output for multi-consumer iridium-toolkit compatibility */
 #ifdef HAVE_ZMQ
 int frame_output_zmq_init(const char *endpoint);
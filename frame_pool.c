@@ -0,0 +1,162 @@
+/*
+ * Frame pool
+ *
+ * Per-thread arenas of size-classed free lists. Cross-thread frees push
+ * onto the owning arena's remote list (a Treiber stack that is only ever
+ * emptied whole with one exchange, so it has no ABA problem).
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "frame_pool.h"
+#include "simd_kernels.h"
+
+#define FP_CLASSES      21          /* 64, 96, 128, 192, ... 49152, 65536 */
+#define FP_NO_CLASS     UINT32_MAX
+#define FP_ALIGN        32          /* aligned_alloc_32() */
+
+typedef struct fp_arena fp_arena_t;
+
+/* Hidden header in front of every block, one alignment unit long */
+typedef struct fp_block {
+    struct fp_block *next;      /* free list link */
+    fp_arena_t *arena;          /* owner, NULL if malloc'd */
+    uint32_t cls;               /* size class, or FP_NO_CLASS */
+    char pad[FP_ALIGN - 2 * sizeof(void *) - sizeof(uint32_t)];
+} fp_block_t;
+
+struct fp_arena {
+    fp_block_t *local[FP_CLASSES];              /* owner only */
+    _Atomic(fp_block_t *) remote[FP_CLASSES];   /* freed by other threads */
+    atomic_int owned;           /* a live thread allocates from it */
+    fp_arena_t *next;           /* all arenas, never unlinked */
+};
+
+frame_pool_stats_t frame_pool_stats;
+
+static size_t class_size[FP_CLASSES];
+static _Atomic(fp_arena_t *) arenas;
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+static pthread_key_t arena_key;
+static __thread fp_arena_t *my_arena;
+
+/* Thread exit: leave the arena, with its blocks, to another thread */
+static void arena_release(void *arg) {
+    fp_arena_t *a = (fp_arena_t *)arg;
+    atomic_store_explicit(&a->owned, 0, memory_order_release);
+}
+
+static void pool_init(void) {
+    size_t s = 64;
+    for (int c = 0; c < FP_CLASSES; c += 2) {
+        class_size[c] = s;
+        if (c + 1 < FP_CLASSES)
+            class_size[c + 1] = s + s / 2;
+        s *= 2;
+    }
+    pthread_key_create(&arena_key, arena_release);
+}
+
+static fp_arena_t *arena_get(void) {
+    if (my_arena)
+        return my_arena;
+    pthread_once(&init_once, pool_init);
+
+    /* Adopt one left by an exited thread, or add a new one */
+    fp_arena_t *a;
+    for (a = atomic_load(&arenas); a; a = a->next) {
+        int free_ = 0;
+        if (atomic_compare_exchange_strong_explicit(&a->owned, &free_, 1,
+                memory_order_acquire, memory_order_relaxed))
+            break;
+    }
+    if (!a) {
+        a = calloc(1, sizeof(*a));
+        if (!a)
+            return NULL;
+        atomic_init(&a->owned, 1);
+        a->next = atomic_load(&arenas);
+        while (!atomic_compare_exchange_weak(&arenas, &a->next, a))
+            ;
+    }
+    pthread_setspecific(arena_key, a);
+    my_arena = a;
+    return a;
+}
+
+static void count_in_use(void) {
+    unsigned long n = atomic_fetch_add_explicit(&frame_pool_stats.in_use, 1,
+                                                memory_order_relaxed) + 1;
+    unsigned long peak = atomic_load_explicit(&frame_pool_stats.peak,
+                                              memory_order_relaxed);
+    while (n > peak &&
+           !atomic_compare_exchange_weak_explicit(&frame_pool_stats.peak,
+                &peak, n, memory_order_relaxed, memory_order_relaxed))
+        ;
+}
+
+void *frame_pool_alloc(size_t bytes) {
+    pthread_once(&init_once, pool_init);
+
+    size_t total = bytes + sizeof(fp_block_t);
+    uint32_t cls = 0;
+    while (cls < FP_CLASSES && class_size[cls] < total)
+        cls++;
+    fp_arena_t *a = cls < FP_CLASSES ? arena_get() : NULL;
+
+    if (!a) {
+        /* Oversize (or no arena): plain heap block */
+        atomic_fetch_add(&frame_pool_stats.misses, 1);
+        fp_block_t *b = aligned_alloc_32(total);
+        if (!b)
+            return NULL;
+        b->arena = NULL;
+        b->cls = FP_NO_CLASS;
+        return b + 1;
+    }
+
+    fp_block_t *b = a->local[cls];
+    if (!b)
+        b = atomic_exchange_explicit(&a->remote[cls], NULL, memory_order_acquire);
+    if (b) {
+        a->local[cls] = b->next;
+    } else {
+        b = aligned_alloc_32(class_size[cls]);
+        if (!b)
+            return NULL;
+        b->arena = a;
+        b->cls = cls;
+        atomic_fetch_add(&frame_pool_stats.blocks, 1);
+        atomic_fetch_add(&frame_pool_stats.bytes, class_size[cls]);
+    }
+    count_in_use();
+    return b + 1;
+}
+
+void frame_pool_free(void *p) {
+    if (!p)
+        return;
+    fp_block_t *b = (fp_block_t *)p - 1;
+    fp_arena_t *a = b->arena;
+    if (!a) {
+        free(b);
+        return;
+    }
+    atomic_fetch_sub_explicit(&frame_pool_stats.in_use, 1, memory_order_relaxed);
+
+    if (a == my_arena) {
+        b->next = a->local[b->cls];
+        a->local[b->cls] = b;
+        return;
+    }
+    _Atomic(fp_block_t *) *head = &a->remote[b->cls];
+    b->next = atomic_load_explicit(head, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(head, &b->next, b,
+                memory_order_release, memory_order_relaxed))
+        ;
+}
@@ -0,0 +1,50 @@
+/*
+ * Frame pool -- per-thread size-classed allocator for frame objects
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Frame pool -- per-thread size-classed allocator for frame objects
+ *
+ * Every burst becomes a downmix_frame_t on a downmix worker and a
+ * demod_frame_t on a demod worker, and both are freed by the output
+ * sequencer: small, short-lived objects that cross threads, plus the
+ * demodulator's per-frame scratch. They come from here instead of malloc.
+ *
+ * Each allocating thread owns an arena with a free list per size class
+ * (64 bytes to 64 KB, in steps of 2 and 1.5). Allocation pops the
+ * owner's own list without atomics. A block freed on another thread is
+ * pushed onto a lock-free list of its arena, which the owner takes over
+ * whole once its own list runs dry. A thread that exits leaves its arena
+ * to the next thread that needs one. Blocks are created on demand and
+ * kept, so after warm-up a frame costs no malloc. Larger requests go to
+ * malloc and are counted.
+ */
+
+#ifndef __FRAME_POOL_H__
+#define __FRAME_POOL_H__
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+typedef struct {
+    atomic_ulong blocks;        /* blocks created */
+    atomic_ulong bytes;         /* bytes held by those blocks */
+    atomic_ulong in_use;        /* blocks handed out now */
+    atomic_ulong peak;          /* most blocks handed out at once */
+    atomic_ulong misses;        /* oversize requests served by malloc */
+} frame_pool_stats_t;
+
+extern frame_pool_stats_t frame_pool_stats;
+
+/* Get bytes of memory aligned to 32 bytes. Returns NULL only if out of
+ * memory. */
+void *frame_pool_alloc(size_t bytes);
+
+/* Return memory from frame_pool_alloc(), from any thread. NULL is a
+ * no-op. */
+void frame_pool_free(void *p);
+
+#endif
@@ -18,12 +18,10 @@
  */
 
 #include <arpa/inet.h>
-#include <netinet/in.h>
 #include <string.h>
-#include <sys/socket.h>
-#include <unistd.h>
 
 #include "gsmtap.h"
+#include "net_output.h"
 
 /* Packed GSMTAP header (16 bytes) */
 typedef struct __attribute__((packed)) {
@@ -41,28 +39,21 @@ typedef struct __attribute__((packed)) {
     uint8_t  res;
 } gsmtap_hdr_t;
 
-static int gsmtap_fd = -1;
-static struct sockaddr_in gsmtap_addr;
+/* Packets are queued for the network output thread (net_output.h) */
+static net_sink_t *gsmtap_sink = NULL;
 
 int gsmtap_init(const char *host, int port)
 {
-    gsmtap_fd = socket(AF_INET, SOCK_DGRAM, 0);
-    if (gsmtap_fd < 0)
-        return -1;
-
-    memset(&gsmtap_addr, 0, sizeof(gsmtap_addr));
-    gsmtap_addr.sin_family = AF_INET;
-    gsmtap_addr.sin_port = htons(port);
-    inet_pton(AF_INET, host ? host : GSMTAP_DEFAULT_HOST,
-              &gsmtap_addr.sin_addr);
-    return 0;
+    gsmtap_sink = net_sink_udp("gsmtap", host ? host : GSMTAP_DEFAULT_HOST,
+                               port);
+    return gsmtap_sink ? 0 : -1;
 }
 
 void gsmtap_send(const uint8_t *data, int len,
                  double frequency, ir_direction_t direction,
                  int8_t signal_dbm)
 {
-    if (gsmtap_fd < 0 || len <= 0)
+    if (!gsmtap_sink || len <= 0)
         return;
 
     uint16_t fchan = (uint16_t)((frequency - IR_BASE_FREQ) / IR_CHANNEL_WIDTH);
@@ -89,14 +80,11 @@ void gsmtap_send(const uint8_t *data, int len,
 
     memcpy(pkt + 16, data, len);
 
-    sendto(gsmtap_fd, pkt, 16 + len, 0,
-           (struct sockaddr *)&gsmtap_addr, sizeof(gsmtap_addr));
+    net_send(gsmtap_sink, pkt, 16 + len);
 }
 
 void gsmtap_shutdown(void)
 {
-    if (gsmtap_fd >= 0) {
-        close(gsmtap_fd);
-        gsmtap_fd = -1;
-    }
+    /* The socket is closed by net_output_shutdown() */
+    gsmtap_sink = NULL;
 }
@@ -28,16 +28,19 @@
 /* Iridium L-band channelization */
 #define IR_BASE_FREQ            1616000000.0
 #define IR_CHANNEL_WIDTH        41666.667
+#define IR_CHANNELS             252     /* 240 duplex, then 12 simplex */
 
-/* Initialize GSMTAP UDP socket. Returns 0 on success, -1 on error. */
+/* Initialize GSMTAP UDP sink. Returns 0 on success, -1 on error (e.g. host
+ * is not a dotted-quad address). */
 int gsmtap_init(const char *host, int port);
 
-/* Send a reassembled IDA message as GSMTAP/LAPDm packet. */
+/* Send a reassembled IDA message as GSMTAP/LAPDm packet. The packet is
+ * queued for the network output thread; this never blocks. */
 void gsmtap_send(const uint8_t *data, int len,
                  double frequency, ir_direction_t direction,
                  int8_t signal_dbm);
 
-/* Close the GSMTAP socket. */
+/* Stop sending; the socket itself goes with net_output_shutdown(). */
 void gsmtap_shutdown(void);
 
 #endif
@@ -5,16 +5,16 @@
 
 #include <err.h>
 #include <signal.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <libhackrf/hackrf.h>
 
+#include "sample_pool.h"
 #include "sdr.h"
 
 extern double samp_rate;
-extern double center_freq;
-extern char *serial;
 extern sig_atomic_t running;
 
 extern int hackrf_lna_gain;
@@ -35,7 +35,7 @@ void hackrf_list(void) {
     hackrf_device_list_free(hackrf_devices);
 }
 
-hackrf_device *hackrf_setup(void) {
+hackrf_device *hackrf_setup(const char *serial, double freq) {
     int r;
     hackrf_device *hackrf;
 
@@ -50,7 +50,7 @@ hackrf_device *hackrf_setup(void) {
     }
     if ((r = hackrf_set_sample_rate(hackrf, samp_rate)) != HACKRF_SUCCESS)
         errx(1, "Unable to set HackRF sample rate: %s", hackrf_error_name(r));
-    if ((r = hackrf_set_freq(hackrf, (uint64_t)center_freq)) != HACKRF_SUCCESS)
+    if ((r = hackrf_set_freq(hackrf, (uint64_t)freq)) != HACKRF_SUCCESS)
         errx(1, "Unable to set HackRF center frequency: %s", hackrf_error_name(r));
     if ((r = hackrf_set_vga_gain(hackrf, hackrf_vga_gain)) != HACKRF_SUCCESS)
         errx(1, "Unable to set HackRF VGA gain: %s", hackrf_error_name(r));
@@ -70,14 +70,15 @@ hackrf_device *hackrf_setup(void) {
 
 int hackrf_rx_cb(hackrf_transfer *t) {
     unsigned i;
-    sample_buf_t *s = malloc(sizeof(*s) + t->valid_length * 4);
+    sample_buf_t *s = sample_buf_alloc(t->valid_length);
     s->format = SAMPLE_FMT_INT8;
     s->num = t->valid_length / 2;
+    s->rx = (int)(intptr_t)t->rx_ctx;
     for (i = 0; i < s->num * 2; ++i)
         s->samples[i] = ((int8_t *)t->buffer)[i];
     if (running)
         push_samples(s);
     else
-        free(s);
+        sample_buf_free(s);
     return 0;
 }
@@ -8,7 +8,8 @@
 #include <libhackrf/hackrf.h>
 
 void hackrf_list(void);
-hackrf_device *hackrf_setup(void);
+hackrf_device *hackrf_setup(const char *serial, double freq);
+/* Start with the receiver index as rx_ctx: (void *)(intptr_t)rx */
 int hackrf_rx_cb(hackrf_transfer *t);
 
 #endif
@@ -23,10 +23,14 @@
  * Reference: iridium-toolkit bitsparser.py + ida.py (muccc)
  */
 
+#include <err.h>
 #include <math.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+#include "bch_chase.h"
+#include "bitpack.h"
 #include "ida_decode.h"
 #include "frame_decode.h"
 
@@ -34,7 +38,6 @@
 #define BCH_POLY_DA    3545     /* BCH(31,20) t=2 */
 #define BCH_DA_SYN     11      /* syndrome bits (bit_length(3545)-1) */
 #define BCH_DA_DATA    20      /* 31 - 11 = 20 data bits per block */
-#define BCH_DA_TABLE   2048    /* 2^11 */
 
 /* BCH polynomials for LCW components */
 #define BCH_POLY_LCW1  29      /* 7-bit, 4-bit syndrome */
@@ -42,10 +45,12 @@
 #define BCH_POLY_LCW3  41      /* 26-bit, 5-bit syndrome */
 
 /* Syndrome tables */
-static struct { int errs; uint32_t locator; } syn_da[BCH_DA_TABLE];
 static struct { int errs; uint32_t locator; } syn_lcw1[16];
 static struct { int errs; uint32_t locator; } syn_lcw2[256];
 static struct { int errs; uint32_t locator; } syn_lcw3[32];
+static bch_code_t code_da;
+
+extern int chase_bits;
 
 /* Access codes (same as frame_decode.c) */
 /* Access codes no longer checked here -- direction comes from demodulator UW match */
@@ -59,6 +64,10 @@ static const int lcw_perm[46] = {
      1, 46, 45, 44, 43, 42
 };
 
+/* Pair-swap + permutation of the 46 LCW bits, one table per input byte:
+ * lcw_tab[k][b] is the permuted 46-bit word contributed by byte k */
+static uint64_t lcw_tab[6][256];
+
 /* ---- Build syndrome tables ---- */
 
 static void build_syn(uint32_t poly, int nbits, int max_errors,
@@ -95,81 +104,35 @@ static void build_syn(uint32_t poly, int nbits, int max_errors,
 
 void ida_decode_init(void)
 {
-    build_syn(BCH_POLY_DA, 31, 2, syn_da, BCH_DA_TABLE);
     build_syn(BCH_POLY_LCW1, 7, 1, syn_lcw1, 16);
     build_syn(BCH_POLY_LCW2, 14, 1, syn_lcw2, 256);
     build_syn(BCH_POLY_LCW3, 26, 2, syn_lcw3, 32);
+    if (!code_da.err && bch_code_init(&code_da, BCH_POLY_DA, 2) != 0)
+        errx(1, "ida_decode_init: out of memory");
+
+    /* Output bit i is input bit (lcw_perm[i] - 1) ^ 1: the pair-swap
+     * (symbol_reverse) followed by the 1-indexed permutation */
+    memset(lcw_tab, 0, sizeof(lcw_tab));
+    for (int i = 0; i < 46; i++) {
+        int src = (lcw_perm[i] - 1) ^ 1;
+        for (int b = 0; b < 256; b++)
+            if ((b >> (7 - (src & 7))) & 1)
+                lcw_tab[src >> 3][b] |= 1ULL << (45 - i);
+    }
 }
 
-/* Chase decoder: flip up to N least-reliable bits, retry BCH */
-#define CHASE_FLIP_BITS 5
-
-static int chase_bch_da(const uint8_t *block31, const float *llr31,
-                        uint8_t *out_data, int *fixed)
+/* Chase decoder over the chase_bits least-reliable bits (bch_chase.h) */
+static int chase_bch_da(uint32_t block31, const float *llr31,
+                        uint32_t *out_data, int *fixed)
 {
-    uint32_t val = bits_to_uint(block31, 31);
-    uint32_t syndrome = gf2_remainder(BCH_POLY_DA, val);
-
-    if (syndrome == 0) {
-        uint_to_bits(val >> BCH_DA_SYN, out_data, BCH_DA_DATA);
-        *fixed = 0;
-        return 0;
-    }
-
-    if (syndrome < BCH_DA_TABLE && syn_da[syndrome].errs >= 0) {
-        val ^= syn_da[syndrome].locator;
-        uint_to_bits(val >> BCH_DA_SYN, out_data, BCH_DA_DATA);
-        *fixed = 1;
-        return syn_da[syndrome].errs;
-    }
-
-    /* Standard BCH failed -- Chase decode with soft info */
-    if (!llr31)
+    uint32_t cw;
+    int changed = bch_chase_decode(&code_da, block31, llr31, chase_bits, &cw);
+    if (changed < 0)
         return -1;
 
-    /* Find CHASE_FLIP_BITS least-reliable positions */
-    int pos[31];
-    for (int i = 0; i < 31; i++)
-        pos[i] = i;
-
-    for (int i = 0; i < CHASE_FLIP_BITS; i++) {
-        int min_idx = i;
-        for (int j = i + 1; j < 31; j++) {
-            if (llr31[pos[j]] < llr31[pos[min_idx]])
-                min_idx = j;
-        }
-        int tmp = pos[i];
-        pos[i] = pos[min_idx];
-        pos[min_idx] = tmp;
-    }
-
-    uint32_t flip_mask[CHASE_FLIP_BITS];
-    for (int i = 0; i < CHASE_FLIP_BITS; i++)
-        flip_mask[i] = 1u << (30 - pos[i]);
-
-    uint32_t base_val = bits_to_uint(block31, 31);
-    for (int mask = 1; mask < (1 << CHASE_FLIP_BITS); mask++) {
-        uint32_t flipped = base_val;
-        for (int b = 0; b < CHASE_FLIP_BITS; b++) {
-            if (mask & (1 << b))
-                flipped ^= flip_mask[b];
-        }
-
-        syndrome = gf2_remainder(BCH_POLY_DA, flipped);
-        if (syndrome == 0) {
-            uint_to_bits(flipped >> BCH_DA_SYN, out_data, BCH_DA_DATA);
-            *fixed = 1;
-            return 0;
-        }
-        if (syndrome < BCH_DA_TABLE && syn_da[syndrome].errs >= 0) {
-            flipped ^= syn_da[syndrome].locator;
-            uint_to_bits(flipped >> BCH_DA_SYN, out_data, BCH_DA_DATA);
-            *fixed = 1;
-            return syn_da[syndrome].errs;
-        }
-    }
-
-    return -1;
+    *out_data = cw >> BCH_DA_SYN;
+    *fixed = changed > 0;
+    return changed;
 }
 
 /* Soft de-interleave: LLR follows same permutation as bits */
@@ -190,28 +153,22 @@ static void de_interleave_llr_n(const float *in, int n_sym,
 
 /* ---- LCW extraction ---- */
 
-static int decode_lcw(const uint8_t *data, int data_len, lcw_t *lcw)
+static int decode_lcw(const uint64_t *data, int pos, int data_len, lcw_t *lcw)
 {
     if (data_len < 46)
         return 0;
 
-    /* Apply pair-swap (symbol_reverse) to LCW bits.
+    /* Apply pair-swap (symbol_reverse) and the permutation table.
      * iridium-toolkit applies symbol_reverse globally, and the LCW
      * permutation table expects swapped input. Since we don't pre-swap,
-     * we swap here before applying the permutation. */
-    uint8_t swapped[46];
-    for (int i = 0; i < 46; i += 2) {
-        swapped[i]     = data[i + 1];
-        swapped[i + 1] = data[i];
-    }
-
-    /* Apply permutation table (1-indexed) */
-    uint8_t lcw_bits[46];
-    for (int i = 0; i < 46; i++)
-        lcw_bits[i] = swapped[lcw_perm[i] - 1];
+     * the swap is folded into lcw_tab. */
+    uint64_t in = bits_get(data, pos, 46) << 2;     /* 6 whole bytes */
+    uint64_t lcw_bits = 0;
+    for (int k = 0; k < 6; k++)
+        lcw_bits |= lcw_tab[k][(in >> (40 - 8 * k)) & 0xFF];
 
     /* lcw1: bits 0-6, BCH(7,3), poly=29 */
-    uint32_t v1 = bits_to_uint(lcw_bits, 7);
+    uint32_t v1 = (uint32_t)(lcw_bits >> 39);
     uint32_t s1 = gf2_remainder(BCH_POLY_LCW1, v1);
     if (s1 != 0) {
         if (s1 >= 16 || syn_lcw1[s1].errs < 0) return 0;
@@ -220,7 +177,7 @@ static int decode_lcw(const uint8_t *data, int data_len, lcw_t *lcw)
     int ft = (int)(v1 >> 4) & 0x7;  /* top 3 data bits */
 
     /* lcw2: bits 7-19 + padding zero = 14 bits, poly=465 */
-    uint32_t v2 = (bits_to_uint(lcw_bits + 7, 13) << 1);  /* 13 bits + trailing 0 */
+    uint32_t v2 = (uint32_t)((lcw_bits >> 26) & 0x1FFF) << 1;  /* 13 bits + trailing 0 */
     uint32_t s2 = gf2_remainder(BCH_POLY_LCW2, v2);
     if (s2 != 0) {
         if (s2 >= 256 || syn_lcw2[s2].errs < 0) return 0;
@@ -228,7 +185,7 @@ static int decode_lcw(const uint8_t *data, int data_len, lcw_t *lcw)
     }
 
     /* lcw3: bits 20-45, 26 bits, poly=41 */
-    uint32_t v3 = bits_to_uint(lcw_bits + 20, 26);
+    uint32_t v3 = (uint32_t)(lcw_bits & 0x3FFFFFF);
     uint32_t s3 = gf2_remainder(BCH_POLY_LCW3, v3);
     if (s3 != 0) {
         if (s3 >= 32 || syn_lcw3[s3].errs < 0) return 0;
@@ -252,30 +209,50 @@ static int decode_lcw(const uint8_t *data, int data_len, lcw_t *lcw)
     return 1;
 }
 
+int ida_decode_lcw(const demod_frame_t *frame, lcw_t *lcw)
+{
+    if (frame->direction != DIR_DOWNLINK && frame->direction != DIR_UPLINK)
+        return 0;
+    return decode_lcw(frame->bits, 24, frame->n_bits - 24, lcw);
+}
+
 /* ---- Generalized 2-way de-interleave ----
- * n_sym symbols (2*n_sym input bits) → 2 output arrays of n_sym bits each.
+ * n_sym symbols (2*n_sym input bits) → 2 outputs: symbols n_sym-1,
+ * n_sym-3, ... and n_sym-2, n_sym-4, ..., each packed MSB first into
+ * one word, zero past its end; at most 63 symbols.
  * No pair-swap (cancelled by not pre-applying symbol_reverse). */
 
-static void de_interleave_n(const uint8_t *in, int n_sym,
-                             uint8_t *out1, uint8_t *out2)
+static void de_interleave_n(const uint64_t *in, int pos, int n_sym,
+                             uint64_t *out1, uint64_t *out2)
 {
-    int p = 0;
-    for (int s = n_sym - 1; s >= 1; s -= 2) {
-        out1[p++] = in[2 * s];
-        out1[p++] = in[2 * s + 1];
-    }
-    p = 0;
-    for (int s = n_sym - 2; s >= 0; s -= 2) {
-        out2[p++] = in[2 * s];
-        out2[p++] = in[2 * s + 1];
-    }
+    uint64_t v1 = 0, v2 = 0;
+    for (int s = n_sym - 1; s >= 1; s -= 2)
+        v1 = (v1 << 2) | bits_get(in, pos + 2 * s, 2);
+    for (int s = n_sym - 2; s >= 0; s -= 2)
+        v2 = (v2 << 2) | bits_get(in, pos + 2 * s, 2);
+    int len = 2 * (n_sym / 2);     /* both halves, symbol 0 unused if odd */
+    *out1 = len ? v1 << (64 - len) : 0;
+    *out2 = len ? v2 << (64 - len) : 0;
+}
+
+/* de_interleave_n of one full 124-bit (62-symbol) block, a word at a
+ * time: each output is 62 bits, right-aligned */
+static void de_interleave_124(const uint64_t *in, int pos,
+                               uint64_t *out1, uint64_t *out2)
+{
+    uint64_t hi = bits_get(in, pos, 64);            /* symbols 0-31 */
+    uint64_t lo = bits_get(in, pos + 64, 60) << 4;  /* symbols 32-61, 2 empty */
+
+    /* The empty symbols 63 and 62 lead the odd/even halves of lo */
+    *out1 = ((uint64_t)(sym_odd_rev(lo) & 0x3FFFFFFF) << 32) | sym_odd_rev(hi);
+    *out2 = ((uint64_t)(sym_even_rev(lo) & 0x3FFFFFFF) << 32) | sym_even_rev(hi);
 }
 
 /* ---- IDA payload descramble + Chase BCH decode ---- */
 
-static int descramble_payload(const uint8_t *data, const float *llr,
-                               int data_len,
-                               uint8_t *bch_stream, int max_bch,
+static int descramble_payload(const uint64_t *data, int pos,
+                               const float *llr, int data_len,
+                               uint64_t *bch_stream, int max_bch,
                                int *fixederrs)
 {
     int bch_len = 0;
@@ -286,22 +263,22 @@ static int descramble_payload(const uint8_t *data, const float *llr,
     int remain = data_len % 124;
 
     for (int blk = 0; blk < n_full; blk++) {
-        const uint8_t *block = data + blk * 124;
         const float *block_llr = llr ? llr + blk * 124 : NULL;
 
         /* De-interleave 62 symbols → 2 × 62 bits */
-        uint8_t half1[62], half2[62];
-        de_interleave_n(block, 62, half1, half2);
+        uint64_t half1, half2;
+        de_interleave_124(data, pos + blk * 124, &half1, &half2);
 
         float lhalf1[62], lhalf2[62];
         if (block_llr)
             de_interleave_llr_n(block_llr, 62, lhalf1, lhalf2);
 
         /* Concatenate → 124 bits, split into 4 × 31 bits */
-        uint8_t combined[124];
+        uint32_t chunks[4] = {
+            (uint32_t)(half1 >> 31), (uint32_t)(half1 & 0x7FFFFFFF),
+            (uint32_t)(half2 >> 31), (uint32_t)(half2 & 0x7FFFFFFF),
+        };
         float lcombined[124];
-        memcpy(combined, half1, 62);
-        memcpy(combined + 62, half2, 62);
         if (block_llr) {
             memcpy(lcombined, lhalf1, 62 * sizeof(float));
             memcpy(lcombined + 62, lhalf2, 62 * sizeof(float));
@@ -314,16 +291,16 @@ static int descramble_payload(const uint8_t *data, const float *llr,
             if (bch_len + BCH_DA_DATA > max_bch) break;
 
             int off = order[c] * 31;
-            uint8_t out_data[BCH_DA_DATA];
+            uint32_t out_data;
             int fixed = 0;
-            int errs = chase_bch_da(combined + off,
+            int errs = chase_bch_da(chunks[order[c]],
                                      block_llr ? lcombined + off : NULL,
-                                     out_data, &fixed);
+                                     &out_data, &fixed);
             if (errs < 0)
                 goto done;
 
             *fixederrs += fixed;
-            memcpy(bch_stream + bch_len, out_data, BCH_DA_DATA);
+            bits_put(bch_stream, bch_len, out_data, BCH_DA_DATA);
             bch_len += BCH_DA_DATA;
         }
     }
@@ -331,10 +308,10 @@ static int descramble_payload(const uint8_t *data, const float *llr,
     /* Last partial block */
     if (remain >= 4 && bch_len + 2 * (remain / 2 - 1) <= max_bch) {
         int n_sym_last = remain / 2;
-        uint8_t h1[64], h2[64];
-        de_interleave_n(data + n_full * 124, n_sym_last, h1, h2);
+        uint64_t h1[2] = { 0, 0 }, h2[2] = { 0, 0 };
+        de_interleave_n(data, pos + n_full * 124, n_sym_last, &h1[0], &h2[0]);
 
-        float lh1[64], lh2[64];
+        float lh1[64] = { 0 }, lh2[64] = { 0 };
         const float *last_llr = llr ? llr + n_full * 124 : NULL;
         if (last_llr)
             de_interleave_llr_n(last_llr, n_sym_last, lh1, lh2);
@@ -342,32 +319,31 @@ static int descramble_payload(const uint8_t *data, const float *llr,
         /* Drop first bit of each half (per iridium-toolkit) */
         int half_len = n_sym_last;
         if (half_len > 1 && bch_len + BCH_DA_DATA <= max_bch) {
-            uint8_t combined[128];
+            /* Bits past a half's length read as 0 */
+            uint64_t combined[BITPACK_WORDS(128)] = { 0 };
             float lcombined[128];
-            int clen = 0;
-            for (int i = 1; i < half_len && clen < 128; i++) {
-                combined[clen] = h2[i];
-                if (last_llr) lcombined[clen] = lh2[i];
-                clen++;
-            }
-            for (int i = 1; i < half_len && clen < 128; i++) {
-                combined[clen] = h1[i];
-                if (last_llr) lcombined[clen] = lh1[i];
-                clen++;
+            int clen = 2 * (half_len - 1);
+            bits_put(combined, 0, bits_get(h2, 1, half_len - 1), half_len - 1);
+            bits_put(combined, half_len - 1, bits_get(h1, 1, half_len - 1),
+                     half_len - 1);
+            if (last_llr) {
+                memcpy(lcombined, lh2 + 1, (half_len - 1) * sizeof(float));
+                memcpy(lcombined + half_len - 1, lh1 + 1,
+                       (half_len - 1) * sizeof(float));
             }
 
-            int pos = 0;
-            while (pos + 31 <= clen && bch_len + BCH_DA_DATA <= max_bch) {
-                uint8_t out_data[BCH_DA_DATA];
+            int cpos = 0;
+            while (cpos + 31 <= clen && bch_len + BCH_DA_DATA <= max_bch) {
+                uint32_t out_data;
                 int fixed = 0;
-                int errs = chase_bch_da(combined + pos,
-                                         last_llr ? lcombined + pos : NULL,
-                                         out_data, &fixed);
+                int errs = chase_bch_da((uint32_t)bits_get(combined, cpos, 31),
+                                         last_llr ? lcombined + cpos : NULL,
+                                         &out_data, &fixed);
                 if (errs < 0) break;
                 *fixederrs += fixed;
-                memcpy(bch_stream + bch_len, out_data, BCH_DA_DATA);
+                bits_put(bch_stream, bch_len, out_data, BCH_DA_DATA);
                 bch_len += BCH_DA_DATA;
-                pos += 31;
+                cpos += 31;
             }
         }
     }
@@ -532,10 +508,11 @@ static void format_lcw_header(int ft, const lcw_t *lcw, char *out, int outsz)
         break;
     }
 
-    /* Format: LCW(%d,T:%s,C:%s,%s) padded to 110 chars + 1 space */
-    char raw[128];
+    /* Format: LCW(%d,T:%s,C:%s,%s) padded to 110 chars + 1 space; raw
+     * holds the longest fields, out keeps what fits */
+    char raw[sizeof(code) + sizeof(remain) + 32];
     snprintf(raw, sizeof(raw), "LCW(%d,T:%s,C:%s,%s)", ft, ty, code, remain);
-    snprintf(out, outsz, "%-110s ", raw);
+    snprintf(out, outsz, "%-110.*s ", outsz - 2, raw);
 }
 
 /* ---- Main IDA decode ---- */
@@ -551,28 +528,28 @@ int ida_decode(const demod_frame_t *frame, ida_burst_t *burst)
     if (frame->direction != DIR_DOWNLINK && frame->direction != DIR_UPLINK)
         return 0;
 
-    const uint8_t *data = frame->bits + 24;
+    const uint64_t *data = frame->bits;
     const float *data_llr = frame->llr ? frame->llr + 24 : NULL;
     int data_len = frame->n_bits - 24;
 
     /* Extract LCW */
     lcw_t lcw;
-    if (!decode_lcw(data, data_len, &lcw))
+    if (!decode_lcw(data, 24, data_len, &lcw))
         return 0;
     if (lcw.ft != 2)
         return 0;
 
     /* Descramble + Chase BCH decode payload (skip 46 LCW bits) */
-    const uint8_t *payload_data = data + 46;
     const float *payload_llr = data_llr ? data_llr + 46 : NULL;
     int payload_len = data_len - 46;
     if (payload_len < 124)
         return 0;
 
-    uint8_t bch_stream[512];
+    /* Decoded straight into the (zeroed) burst */
+    uint64_t *bch_stream = burst->bch_stream;
     int fixederrs = 0;
-    int bch_len = descramble_payload(payload_data, payload_llr, payload_len,
-                                      bch_stream, sizeof(bch_stream),
+    int bch_len = descramble_payload(data, 24 + 46, payload_llr, payload_len,
+                                      bch_stream, IDA_BCH_MAX_BITS,
                                       &fixederrs);
 
     /* Need at least 196 bits: 20 header + 160 payload + 16 CRC */
@@ -580,11 +557,10 @@ int ida_decode(const demod_frame_t *frame, ida_burst_t *burst)
         return 0;
 
     /* Extract IDA fields from bitstream_bch */
-    int cont    = bch_stream[3];
-    int da_ctr  = (bch_stream[5] << 2) | (bch_stream[6] << 1) | bch_stream[7];
-    int da_len  = (bch_stream[11] << 4) | (bch_stream[12] << 3) |
-                  (bch_stream[13] << 2) | (bch_stream[14] << 1) | bch_stream[15];
-    int zero1   = (bch_stream[17] << 2) | (bch_stream[18] << 1) | bch_stream[19];
+    int cont    = bits_test(bch_stream, 3);
+    int da_ctr  = (int)bits_get(bch_stream, 5, 3);
+    int da_len  = (int)bits_get(bch_stream, 11, 5);
+    int zero1   = (int)bits_get(bch_stream, 17, 3);
 
     if (zero1 != 0)
         return 0;
@@ -593,12 +569,8 @@ int ida_decode(const demod_frame_t *frame, ida_burst_t *burst)
 
     /* Extract payload bytes (bits 20-179 -> 20 bytes) */
     uint8_t payload[20];
-    for (int i = 0; i < 20; i++) {
-        uint8_t byte = 0;
-        for (int b = 0; b < 8; b++)
-            byte = (byte << 1) | bch_stream[20 + i * 8 + b];
-        payload[i] = byte;
-    }
+    for (int i = 0; i < 20; i++)
+        payload[i] = (uint8_t)bits_get(bch_stream, 20 + i * 8, 8);
 
     /* CRC verification (if da_len > 0) */
     int crc_ok = 0;
@@ -606,29 +578,23 @@ int ida_decode(const demod_frame_t *frame, ida_burst_t *burst)
     uint16_t computed_crc = 0;
     if (da_len > 0 && bch_len >= 196) {
         /* Stored CRC at bits[9*20 .. 9*20+16] */
-        stored_crc = 0;
-        for (int i = 0; i < 16; i++)
-            stored_crc = (stored_crc << 1) | bch_stream[9 * 20 + i];
+        stored_crc = (uint16_t)bits_get(bch_stream, 9 * 20, 16);
 
         /* CRC input: bits 0-19 + 12 zero bits + bits 20 to (end-4) */
         int crc_bits = 20 + 12 + (bch_len - 20 - 4);
         int crc_bytes = (crc_bits + 7) / 8;
         uint8_t crc_buf[64];
         if (crc_bytes <= (int)sizeof(crc_buf)) {
-            memset(crc_buf, 0, sizeof(crc_buf));
-            int bit_pos = 0;
-
-            for (int i = 0; i < 20; i++) {
-                crc_buf[bit_pos / 8] |= bch_stream[i] << (7 - (bit_pos % 8));
-                bit_pos++;
-            }
-            bit_pos += 12;
-            for (int i = 20; i < bch_len - 4; i++) {
-                crc_buf[bit_pos / 8] |= bch_stream[i] << (7 - (bit_pos % 8));
-                bit_pos++;
+            uint64_t crc_in[BITPACK_WORDS(64 * 8)] = { 0 };
+            bits_put(crc_in, 0, bits_get(bch_stream, 0, 20), 20);
+            for (int i = 20; i < bch_len - 4; i += 64) {
+                int n = bch_len - 4 - i < 64 ? bch_len - 4 - i : 64;
+                bits_put(crc_in, i + 12, bits_get(bch_stream, i, n), n);
             }
 
-            computed_crc = crc_ccitt(crc_buf, (bit_pos + 7) / 8);
+            for (int i = 0; i < crc_bytes; i++)
+                crc_buf[i] = (uint8_t)bits_get(crc_in, 8 * i, 8);
+            computed_crc = crc_ccitt(crc_buf, crc_bytes);
             crc_ok = (computed_crc == 0);
         }
     }
@@ -652,10 +618,8 @@ int ida_decode(const demod_frame_t *frame, ida_burst_t *burst)
     burst->payload_len = (da_len > 0) ? da_len : 20;
     memcpy(burst->payload, payload, burst->payload_len);
 
-    /* Store full BCH stream and LCW for parsed output */
+    /* Full BCH stream (already in place) and LCW for parsed output */
     burst->bch_len = bch_len;
-    memcpy(burst->bch_stream, bch_stream,
-           bch_len < (int)sizeof(burst->bch_stream) ? bch_len : (int)sizeof(burst->bch_stream));
     burst->lcw = lcw;
 
     /* Format LCW header string */
@@ -666,70 +630,214 @@ int ida_decode(const demod_frame_t *frame, ida_burst_t *burst)
 
 /* ---- Multi-burst reassembly ---- */
 
-int ida_reassemble(ida_context_t *ctx, const ida_burst_t *burst,
-                   ida_message_cb cb, void *user)
+#define IDA_REASSEMBLY_TIMEOUT_NS   280000000ULL    /* gap between fragments */
+#define IDA_FREQ_TOLERANCE          260.0           /* Hz, fragment to first */
+
+/* Frequency buckets are one tolerance wide, so a continuation lies in the
+ * slot's bucket or one of its neighbours */
+static int64_t freq_bucket(double frequency) {
+    return (int64_t)floor(frequency / IDA_FREQ_TOLERANCE);
+}
+
+static int bucket_of(const ida_context_t *ctx, ir_direction_t direction,
+                     int64_t fbucket, int ctr) {
+    uint64_t h = (uint64_t)fbucket * 0x9E3779B97F4A7C15ULL;
+    h ^= (uint64_t)(direction * 8 + ctr) * 0xC2B2AE3D27D4EB4FULL;
+    h ^= h >> 29;
+    return (int)(h & (uint64_t)ctx->bucket_mask);
+}
+
+/* Hash bucket of a slot, keyed on the counter its next fragment carries */
+static int slot_bucket(const ida_context_t *ctx, const ida_reassembly_t *s) {
+    return bucket_of(ctx, s->direction, freq_bucket(s->frequency),
+                     (s->last_ctr + 1) % 8);
+}
+
+static void chain_insert(ida_context_t *ctx, int idx) {
+    int b = slot_bucket(ctx, &ctx->slots[idx]);
+    ctx->slots[idx].hash_next = ctx->buckets[b];
+    ctx->buckets[b] = idx;
+}
+
+static void chain_remove(ida_context_t *ctx, int idx) {
+    int *link = &ctx->buckets[slot_bucket(ctx, &ctx->slots[idx])];
+    while (*link != idx)
+        link = &ctx->slots[*link].hash_next;
+    *link = ctx->slots[idx].hash_next;
+}
+
+static void lru_unlink(ida_context_t *ctx, int idx) {
+    ida_reassembly_t *s = &ctx->slots[idx];
+    if (s->lru_prev >= 0) ctx->slots[s->lru_prev].lru_next = s->lru_next;
+    else ctx->lru_head = s->lru_next;
+    if (s->lru_next >= 0) ctx->slots[s->lru_next].lru_prev = s->lru_prev;
+    else ctx->lru_tail = s->lru_prev;
+}
+
+static void lru_append(ida_context_t *ctx, int idx) {
+    ida_reassembly_t *s = &ctx->slots[idx];
+    s->lru_prev = ctx->lru_tail;
+    s->lru_next = -1;
+    if (ctx->lru_tail >= 0) ctx->slots[ctx->lru_tail].lru_next = idx;
+    else ctx->lru_head = idx;
+    ctx->lru_tail = idx;
+}
+
+static void slot_release(ida_context_t *ctx, int idx) {
+    chain_remove(ctx, idx);
+    lru_unlink(ctx, idx);
+    ctx->slots[idx].hash_next = ctx->free_head;
+    ctx->free_head = idx;
+    ctx->n_active--;
+}
+
+/* Free slot, or the least recently fed one if all are in use */
+static int slot_alloc(ida_context_t *ctx) {
+    if (ctx->free_head < 0) {
+        slot_release(ctx, ctx->lru_head);
+        atomic_fetch_add(&ctx->stat_evicted, 1);
+    }
+    int idx = ctx->free_head;
+    ctx->free_head = ctx->slots[idx].hash_next;
+    ctx->n_active++;
+    if ((unsigned long)ctx->n_active > atomic_load(&ctx->stat_peak))
+        atomic_store(&ctx->stat_peak, ctx->n_active);
+    return idx;
+}
+
+/* Slot in progress that burst continues, or -1. If several could, the
+ * one closest in frequency wins. */
+static int find_slot(const ida_context_t *ctx, const ida_burst_t *burst) {
+    int best = -1;
+    double best_df = IDA_FREQ_TOLERANCE;
+    int64_t fb = freq_bucket(burst->frequency);
+    for (int64_t b = fb - 1; b <= fb + 1; b++) {
+        int idx = ctx->buckets[bucket_of(ctx, burst->direction, b,
+                                         burst->da_ctr)];
+        for (; idx >= 0; idx = ctx->slots[idx].hash_next) {
+            const ida_reassembly_t *s = &ctx->slots[idx];
+            if (s->direction != burst->direction) continue;
+            if (burst->timestamp < s->last_timestamp) continue;
+            if (burst->timestamp - s->last_timestamp > IDA_REASSEMBLY_TIMEOUT_NS) continue;
+            if ((s->last_ctr + 1) % 8 != burst->da_ctr) continue;
+            double df = fabs(s->frequency - burst->frequency);
+            if (df > IDA_FREQ_TOLERANCE) continue;
+            if (best < 0 || df < best_df) {
+                best = idx;
+                best_df = df;
+            }
+        }
+    }
+    return best;
+}
+
+static void publish(ida_context_t *ctx, const uint8_t *data, int len,
+                    uint64_t timestamp, double frequency,
+                    ir_direction_t direction, float magnitude) {
+    for (int i = 0; i < ctx->n_sinks; i++)
+        ctx->sinks[i].cb(data, len, timestamp, frequency, direction,
+                         magnitude, ctx->sinks[i].user);
+    atomic_fetch_add(&ctx->stat_messages, 1);
+}
+
+int ida_context_init(ida_context_t *ctx, int capacity) {
+    memset(ctx, 0, sizeof(*ctx));
+    if (capacity <= 0)
+        capacity = IDA_REASSEMBLY_DEFAULT;
+
+    /* At least two buckets per slot keeps the chains short */
+    int n_buckets = 1;
+    while (n_buckets < 2 * capacity)
+        n_buckets *= 2;
+
+    ctx->slots = malloc(capacity * sizeof(*ctx->slots));
+    ctx->buckets = malloc(n_buckets * sizeof(*ctx->buckets));
+    if (!ctx->slots || !ctx->buckets) {
+        ida_context_free(ctx);
+        return -1;
+    }
+    ctx->capacity = capacity;
+    ctx->bucket_mask = n_buckets - 1;
+    for (int i = 0; i < n_buckets; i++)
+        ctx->buckets[i] = -1;
+    for (int i = 0; i < capacity; i++)
+        ctx->slots[i].hash_next = i + 1 < capacity ? i + 1 : -1;
+    ctx->free_head = 0;
+    ctx->lru_head = ctx->lru_tail = -1;
+    return 0;
+}
+
+void ida_context_free(ida_context_t *ctx) {
+    free(ctx->slots);
+    free(ctx->buckets);
+    ctx->slots = NULL;
+    ctx->buckets = NULL;
+    ctx->capacity = 0;
+}
+
+int ida_add_sink(ida_context_t *ctx, ida_message_cb cb, void *user) {
+    if (ctx->n_sinks == IDA_MAX_SINKS)
+        return -1;
+    ctx->sinks[ctx->n_sinks].cb = cb;
+    ctx->sinks[ctx->n_sinks].user = user;
+    ctx->n_sinks++;
+    return 0;
+}
+
+int ida_reassemble(ida_context_t *ctx, const ida_burst_t *burst)
 {
     /* Only process CRC-verified bursts */
     if (!burst->crc_ok || burst->da_len == 0)
         return 0;
 
     /* Try to match existing reassembly slot */
-    for (int i = 0; i < IDA_MAX_REASSEMBLY; i++) {
-        ida_reassembly_t *s = &ctx->slots[i];
-        if (!s->active) continue;
-        if (s->direction != burst->direction) continue;
-        if (fabs(s->frequency - burst->frequency) > 260.0) continue;
-        if (burst->timestamp < s->last_timestamp) continue;
-        if (burst->timestamp - s->last_timestamp > 280000000ULL) continue;
-        if ((s->last_ctr + 1) % 8 != burst->da_ctr) continue;
+    int idx = find_slot(ctx, burst);
+    if (idx >= 0) {
+        ida_reassembly_t *s = &ctx->slots[idx];
 
         /* Match -- append payload */
         if (s->data_len + burst->da_len <= (int)sizeof(s->data)) {
             memcpy(s->data + s->data_len, burst->payload, burst->da_len);
             s->data_len += burst->da_len;
         }
-        s->last_timestamp = burst->timestamp;
-        s->last_ctr = burst->da_ctr;
 
         if (!burst->cont) {
             /* Message complete */
-            cb(s->data, s->data_len, burst->timestamp,
-               s->frequency, s->direction, burst->magnitude, user);
-            s->active = 0;
+            publish(ctx, s->data, s->data_len, burst->timestamp,
+                    s->frequency, s->direction, burst->magnitude);
+            slot_release(ctx, idx);
             return 1;
         }
+
+        /* Rekey on the next counter, and move to the recent end */
+        chain_remove(ctx, idx);
+        s->last_timestamp = burst->timestamp;
+        s->last_ctr = burst->da_ctr;
+        chain_insert(ctx, idx);
+        lru_unlink(ctx, idx);
+        lru_append(ctx, idx);
         return 0;
     }
 
     /* Single-burst message (ctr==0, no continuation) */
     if (burst->da_ctr == 0 && !burst->cont) {
-        cb(burst->payload, burst->da_len, burst->timestamp,
-           burst->frequency, burst->direction, burst->magnitude, user);
+        publish(ctx, burst->payload, burst->da_len, burst->timestamp,
+                burst->frequency, burst->direction, burst->magnitude);
         return 1;
     }
 
     /* Start new multi-burst message (ctr==0, continuation expected) */
     if (burst->da_ctr == 0 && burst->cont) {
-        /* Find free slot (or evict oldest) */
-        int idx = -1;
-        uint64_t oldest = UINT64_MAX;
-        for (int i = 0; i < IDA_MAX_REASSEMBLY; i++) {
-            if (!ctx->slots[i].active) { idx = i; break; }
-            if (ctx->slots[i].last_timestamp < oldest) {
-                oldest = ctx->slots[i].last_timestamp;
-                idx = i;
-            }
-        }
-        if (idx < 0) idx = 0;
-
+        idx = slot_alloc(ctx);
         ida_reassembly_t *s = &ctx->slots[idx];
-        s->active = 1;
         s->direction = burst->direction;
         s->frequency = burst->frequency;
         s->last_timestamp = burst->timestamp;
         s->last_ctr = burst->da_ctr;
         memcpy(s->data, burst->payload, burst->da_len);
         s->data_len = burst->da_len;
+        chain_insert(ctx, idx);
+        lru_append(ctx, idx);
         return 0;
     }
 
@@ -737,12 +845,15 @@ int ida_reassemble(ida_context_t *ctx, const ida_burst_t *burst,
     return 0;
 }
 
+/* Frames reach the reassembler in (nearly) timestamp order, so the least
+ * recently fed slot is the first to time out; one fed slightly out of
+ * order only expires a frame or so late */
 void ida_reassemble_flush(ida_context_t *ctx, uint64_t now_ns)
 {
-    for (int i = 0; i < IDA_MAX_REASSEMBLY; i++) {
-        ida_reassembly_t *s = &ctx->slots[i];
-        if (s->active && now_ns > s->last_timestamp + 280000000ULL) {
-            s->active = 0;
-        }
+    while (ctx->lru_head >= 0 &&
+           now_ns > ctx->slots[ctx->lru_head].last_timestamp
+                    + IDA_REASSEMBLY_TIMEOUT_NS) {
+        slot_release(ctx, ctx->lru_head);
+        atomic_fetch_add(&ctx->stat_expired, 1);
     }
 }
@@ -13,6 +13,7 @@
 #ifndef __IDA_DECODE_H__
 #define __IDA_DECODE_H__
 
+#include <stdatomic.h>
 #include <stdint.h>
 #include "qpsk_demod.h"
 #include "burst_downmix.h"
@@ -27,6 +28,9 @@ typedef struct {
     int ec_lcw;         /* total LCW error corrections (-1 if none) */
 } lcw_t;
 
+/* Longest BCH-decoded IDA bitstream */
+#define IDA_BCH_MAX_BITS 512
+
 /* Single IDA burst (after BCH decode, before reassembly) */
 typedef struct {
     uint64_t timestamp;
@@ -46,48 +50,90 @@ typedef struct {
     uint16_t stored_crc;
     uint16_t computed_crc;
     int fixederrs;      /* BCH blocks with corrected errors */
-    /* Full BCH-decoded bitstream for parsed output */
-    uint8_t bch_stream[256];
+    /* Full BCH-decoded bitstream for parsed output, packed (bitpack.h) */
+    uint64_t bch_stream[BITPACK_WORDS(IDA_BCH_MAX_BITS)];
     int bch_len;
     lcw_t lcw;
     char lcw_header[128];   /* formatted LCW(...) string */
 } ida_burst_t;
 
-/* Reassembly slot */
+/* Callback for completed IDA messages */
+typedef void (*ida_message_cb)(const uint8_t *data, int len,
+                                uint64_t timestamp, double frequency,
+                                ir_direction_t direction, float magnitude,
+                                void *user);
+
+/* Reassembly slot: one message in progress */
 typedef struct {
-    int active;
     ir_direction_t direction;
     double frequency;
     uint64_t last_timestamp;
     int last_ctr;
+    int hash_next;          /* next slot in its hash chain (or free list) */
+    int lru_prev, lru_next; /* slots in the order they were last fed */
     uint8_t data[256];
     int data_len;
 } ida_reassembly_t;
 
-#define IDA_MAX_REASSEMBLY 16
+/* Messages in progress: default and upper bound for --ida-slots */
+#define IDA_REASSEMBLY_DEFAULT  256
+#define IDA_REASSEMBLY_MAX      65536
+
+/* Subscribers to completed messages */
+#define IDA_MAX_SINKS 4
 
-/* Reassembly context */
 typedef struct {
-    ida_reassembly_t slots[IDA_MAX_REASSEMBLY];
-} ida_context_t;
+    ida_message_cb cb;
+    void *user;
+} ida_sink_t;
 
-/* Callback for completed IDA messages */
-typedef void (*ida_message_cb)(const uint8_t *data, int len,
-                                uint64_t timestamp, double frequency,
-                                ir_direction_t direction, float magnitude,
-                                void *user);
+/* Reassembly context, shared by every subscriber. Slots in progress are
+ * chained in a hash table on (direction, frequency bucket, expected ctr),
+ * so a burst only looks at the few slots it could continue, and kept on
+ * a list in the order they were last fed, so flushing and eviction start
+ * from the oldest. The counters may be read from any thread. */
+typedef struct {
+    ida_reassembly_t *slots;
+    int capacity;
+    int *buckets;           /* hash chain heads, -1 = empty */
+    int bucket_mask;
+    int free_head;
+    int lru_head, lru_tail; /* least / most recently fed */
+    int n_active;
+    ida_sink_t sinks[IDA_MAX_SINKS];
+    int n_sinks;
+    atomic_ulong stat_messages;     /* messages published */
+    atomic_ulong stat_evicted;      /* in progress, dropped for a new one */
+    atomic_ulong stat_expired;      /* in progress, timed out */
+    atomic_ulong stat_peak;         /* most slots in use at once */
+} ida_context_t;
 
 /* Initialize IDA BCH syndrome tables. Call once at startup. */
 void ida_decode_init(void);
 
+/* Decode just the LCW of a demodulated frame (hard decisions).
+ * Returns 1 and fills lcw if all three components check out. */
+int ida_decode_lcw(const demod_frame_t *frame, lcw_t *lcw);
+
 /* Try to decode a demodulated frame as IDA.
  * Returns 1 if IDA detected, fills burst. 0 otherwise. */
 int ida_decode(const demod_frame_t *frame, ida_burst_t *burst);
 
-/* Feed a decoded burst into the reassembly engine.
- * Calls cb when a complete message is assembled. Returns 1 if emitted. */
-int ida_reassemble(ida_context_t *ctx, const ida_burst_t *burst,
-                   ida_message_cb cb, void *user);
+/* Set up a reassembly context for up to capacity messages in progress
+ * (0 = IDA_REASSEMBLY_DEFAULT). Returns 0 on success, -1 if out of memory. */
+int ida_context_init(ida_context_t *ctx, int capacity);
+
+/* Free a context's slots and hash table */
+void ida_context_free(ida_context_t *ctx);
+
+/* Subscribe cb to completed messages. Returns -1 if the context already
+ * has IDA_MAX_SINKS subscribers. */
+int ida_add_sink(ida_context_t *ctx, ida_message_cb cb, void *user);
+
+/* Feed a decoded burst into the reassembly engine. A completed message is
+ * passed to every subscriber, in the order they were added. Returns 1 if
+ * a message was published. */
+int ida_reassemble(ida_context_t *ctx, const ida_burst_t *burst);
 
 /* Flush timed-out reassembly slots (call every frame). */
 void ida_reassemble_flush(ida_context_t *ctx, uint64_t now_ns);
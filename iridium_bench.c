@@ -0,0 +1,1205 @@
+/*
+ * iridium-bench -- DSP micro-benchmarks for the SIMD kernels and pipeline stages
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * iridium-bench -- DSP micro-benchmarks for the SIMD kernels and pipeline stages
+ *
+ * Every kernel in simd_kernels.h is run for each implementation compiled in
+ * and supported by this CPU, at the sizes the pipeline uses. Then a capture
+ * of synthetic downlink bursts is pushed through the detector, downmix and
+ * demodulator with each supported dispatch table. Results go
+ * to stdout as one JSON object per line (progress goes to stderr), so runs
+ * on different machines and commits can be diffed or collected directly.
+ *
+ * --synth=FILE writes a capture file for end-to-end runs of the sniffer
+ * instead (see perf-harness.sh) and exits.
+ */
+
+#define _GNU_SOURCE
+#include <err.h>
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fftw3.h>
+
+#include "bch_chase.h"
+#include "burst_detect.h"
+#include "burst_extract.h"
+#include "burst_downmix.h"
+#include "burst_sched.h"
+#include "fftw_lock.h"
+#include "fir_filter.h"
+#include "gsmtap.h"
+#include "iridium.h"
+#include "pipeline_stats.h"
+#include "qpsk_demod.h"
+#include "simd_kernels.h"
+#include "window_func.h"
+
+#define C_FEK_BLOCKING_QUEUE_IMPLEMENTATION
+#define C_FEK_FAIR_LOCK_IMPLEMENTATION
+#include "blocking_queue.h"
+#include "mpmc_ring.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* ---- Globals the pipeline modules expect (defined in main.c there) ---- */
+
+pthread_mutex_t fftw_planner_mutex;
+mpmc_ring_t samples_queue;
+burst_sched_t *burst_queue = NULL;
+volatile sig_atomic_t running = 1;
+int verbose = 0;
+char *save_bursts_dir = NULL;
+int use_gardner = 1;
+int chase_bits = CHASE_DEFAULT_BITS;
+atomic_ulong stat_n_detected = 0;
+atomic_ulong stat_n_dropped = 0;
+atomic_ulong stat_burst_bytes = 0;
+atomic_ulong stat_burst_bytes_untrimmed = 0;
+atomic_ulong stat_narrowband_bytes = 0;
+atomic_ulong stat_sync_direct = 0;
+atomic_ulong stat_sync_fft = 0;
+atomic_ulong stat_archive_bursts = 0;
+atomic_ulong stat_shed_simplex = 0;
+atomic_ulong stat_shed_duplex = 0;
+atomic_ulong stat_ring_moves = 0;
+atomic_ulong stat_archive_dropped = 0;
+
+/* ---- Sizes (match the pipeline at 10 Msps) ---- */
+
+#define BENCH_FFT_SIZE      8192    /* detector FFT at 10 Msps */
+#define BENCH_BLOCK         32768   /* samples per read in the file/SDR path */
+#define BENCH_FRAME_LEN     8192    /* downmixed burst at 250 ksps (~33 ms) */
+#define BENCH_IN_RATE       10000000
+#define BENCH_DECIMATION    40      /* 10 Msps -> 250 ksps */
+#define BENCH_STAGE1_DEC    10      /* design_input_fir() at 10 Msps: 10 x 4 */
+#define BENCH_RRC_NTAPS     51      /* burst_downmix.c RRC_NTAPS */
+#define BENCH_RRC_ALPHA     0.4f    /* burst_downmix.c RRC_ALPHA */
+#define BENCH_BURST_SPACING 0.03    /* seconds between synthetic bursts */
+#define BENCH_LEAD_IN       0.6     /* seconds of noise while the detector's
+                                     * 512-frame history fills */
+#define BENCH_PAYLOAD_SYMS  179
+
+static double min_time = 0.2;       /* seconds per measurement */
+static int downmix_batch = 0;       /* bursts per downmix pass, 0 = one */
+static int sync_corr = SYNC_CORR_AUTO;  /* downmix sync word search */
+static int fine_cfo = FINE_CFO_FFT;     /* downmix fine CFO estimator */
+static int trim_bursts = 0;         /* detector --trim-bursts */
+
+/* ---- Kernel sets ---- */
+
+typedef struct {
+    simd_impl_t impl;
+    simd_fir_ccf_fn         fir_ccf;
+    simd_fir_ccf_dec_fn     fir_ccf_dec;
+    simd_fir_fff_fn         fir_fff;
+    simd_window_cf_fn       window_cf;
+    simd_fftshift_mag_fn    fftshift_mag;
+    simd_baseline_update_fn baseline_update;
+    simd_relative_mag_fn    relative_mag;
+    simd_convert_i8_cf_fn   convert_i8_cf;
+    simd_window_i8_cf_fn    window_i8_cf;
+    simd_convert_i16_cf_fn  convert_i16_cf;
+    simd_window_i16_cf_fn   window_i16_cf;
+    simd_mag_squared_fn     mag_squared;
+    simd_max_float_fn       max_float;
+    simd_peak_bins_fn       peak_bins;
+    simd_csquare_window_fn  csquare_window;
+    simd_chase_select_fn    chase_select;
+    simd_pll_batch_fn       pll_batch;
+    simd_dot_cc_fn          dot_cc;
+    const simd_fir_fixed_t *fir_fixed;
+    simd_fir_q15_dec_fn     fir_q15_dec;
+} kernel_set_t;
+
+/* Every set compiled in, called directly so they can be compared */
+static const kernel_set_t kernel_sets[] = {
+    { SIMD_GENERIC,
+      generic_fir_ccf, generic_fir_ccf_dec, generic_fir_fff,
+      generic_window_cf, generic_fftshift_mag, generic_baseline_update,
+      generic_relative_mag, generic_convert_i8_cf, generic_window_i8_cf,
+      generic_convert_i16_cf, generic_window_i16_cf,
+      generic_mag_squared, generic_max_float, generic_peak_bins,
+      generic_csquare_window, generic_chase_select, generic_pll_batch,
+      generic_dot_cc, NULL, generic_fir_q15_dec },
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    { SIMD_AVX2,
+      avx2_fir_ccf, avx2_fir_ccf_dec, avx2_fir_fff,
+      avx2_window_cf, avx2_fftshift_mag, avx2_baseline_update,
+      avx2_relative_mag, avx2_convert_i8_cf, avx2_window_i8_cf,
+      avx2_convert_i16_cf, avx2_window_i16_cf,
+      avx2_mag_squared, avx2_max_float, avx2_peak_bins,
+      avx2_csquare_window, avx2_chase_select, avx2_pll_batch,
+      avx2_dot_cc, avx2_fir_fixed, avx2_fir_q15_dec },
+#ifdef HAVE_AVX512
+    { SIMD_AVX512,
+      avx512_fir_ccf, avx512_fir_ccf_dec, avx512_fir_fff,
+      avx512_window_cf, avx512_fftshift_mag, avx512_baseline_update,
+      avx512_relative_mag, avx512_convert_i8_cf, avx512_window_i8_cf,
+      avx512_convert_i16_cf, avx512_window_i16_cf,
+      avx512_mag_squared, avx512_max_float, avx512_peak_bins,
+      avx512_csquare_window, avx512_chase_select, avx512_pll_batch,
+      avx512_dot_cc, avx512_fir_fixed, avx2_fir_q15_dec },
+#endif
+#endif
+#if defined(__aarch64__)
+    { SIMD_NEON,
+      neon_fir_ccf, neon_fir_ccf_dec, neon_fir_fff,
+      neon_window_cf, neon_fftshift_mag, neon_baseline_update,
+      neon_relative_mag, neon_convert_i8_cf, generic_window_i8_cf,
+      neon_convert_i16_cf, neon_window_i16_cf,
+      neon_mag_squared, neon_max_float, generic_peak_bins,
+      neon_csquare_window, generic_chase_select, generic_pll_batch,
+      generic_dot_cc, NULL, neon_fir_q15_dec },
+#endif
+};
+
+#define N_KERNEL_SETS ((int)(sizeof(kernel_sets) / sizeof(kernel_sets[0])))
+
+/* ---- Timing ---- */
+
+/* Run body in batches until min_time has passed and store the mean
+ * nanoseconds per run in ns_per_call. One untimed warm-up run first. */
+#define BENCH_LOOP(ns_per_call, body) do {                              \
+    body;                                                               \
+    uint64_t _min_ns = (uint64_t)(min_time * 1e9);                      \
+    uint64_t _t0 = pstats_now(), _elapsed, _runs = 0;                   \
+    do {                                                                \
+        for (int _i = 0; _i < 8; _i++) { body; }                        \
+        _runs += 8;                                                     \
+        _elapsed = pstats_now() - _t0;                                  \
+    } while (_elapsed < _min_ns);                                       \
+    (ns_per_call) = (double)_elapsed / (double)_runs;                   \
+} while (0)
+
+/* Keeps reductions from being optimized away */
+static volatile float sink;
+
+static void report_kernel(const char *name, const char *impl, int n,
+                          int ntaps, double ns_per_call) {
+    printf("{\"bench\":\"kernel\",\"name\":\"%s\",\"impl\":\"%s\","
+           "\"n\":%d,\"ntaps\":%d,\"ns_per_call\":%.1f,"
+           "\"ns_per_sample\":%.4f,\"msamples_per_s\":%.2f}\n",
+           name, impl, n, ntaps, ns_per_call, ns_per_call / n,
+           n * 1e3 / ns_per_call);
+    fflush(stdout);
+}
+
+/* ---- Deterministic test data ---- */
+
+static uint64_t rng_state = 0x2545f4914f6cdd1dULL;
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32);
+}
+
+static float rng_uniform(void) {
+    return ((float)rng_next() + 1.0f) / 4294967296.0f;
+}
+
+static float complex rng_gauss(void) {
+    float r = sqrtf(-2.0f * logf(rng_uniform()));
+    float a = 2.0f * (float)M_PI * rng_uniform();
+    return r * cosf(a) + r * sinf(a) * I;
+}
+
+static float complex *noise_cf(size_t n, float sigma) {
+    float complex *x = aligned_alloc_32(n * sizeof(float complex));
+    for (size_t i = 0; i < n; i++)
+        x[i] = sigma * rng_gauss();
+    return x;
+}
+
+static float *uniform_f(size_t n, float lo, float hi) {
+    float *x = aligned_alloc_32(n * sizeof(float));
+    for (size_t i = 0; i < n; i++)
+        x[i] = lo + (hi - lo) * rng_uniform();
+    return x;
+}
+
+/* ---- Kernel benchmarks ---- */
+
+static void bench_kernels(const kernel_set_t *k) {
+    double ns;
+    int fft = BENCH_FFT_SIZE;
+    int nf = BENCH_FRAME_LEN;
+    int ntaps;
+    float *taps;
+
+    /* Filters exactly as burst_downmix_create() designs them */
+    int out_rate = IR_DEFAULT_SPS * IR_SYMBOLS_PER_SECOND;
+    taps = lpf_taps(&ntaps, 1.0f, (float)BENCH_IN_RATE,
+                    out_rate * 0.4f, out_rate * 0.2f);
+    fir_filter_t *input_fir = fir_filter_create(taps, ntaps);
+    free(taps);
+    taps = lpf_taps(&ntaps, 1.0f, (float)out_rate, 20000.0f, 40000.0f);
+    fir_filter_t *noise_fir = fir_filter_create(taps, ntaps);
+    free(taps);
+    taps = rrc_taps(&ntaps, 1.0f, (float)out_rate, (float)IR_SYMBOLS_PER_SECOND,
+                    BENCH_RRC_ALPHA, BENCH_RRC_NTAPS);
+    fir_filter_t *rrc_fir = fir_filter_create(taps, ntaps);
+    free(taps);
+    taps = box_taps(&ntaps, IR_DEFAULT_SPS * 2);
+    fir_filter_t *box_fir = fir_filter_create(taps, ntaps);
+    free(taps);
+    /* The two input stages design_input_fir() splits that into */
+    int mid_rate = BENCH_IN_RATE / BENCH_STAGE1_DEC;
+    int stage2_dec = BENCH_DECIMATION / BENCH_STAGE1_DEC;
+    taps = lpf_taps(&ntaps, 1.0f, (float)BENCH_IN_RATE, mid_rate / 2.0f,
+                    (float)(mid_rate - out_rate));
+    fir_filter_t *stage1_fir = fir_filter_create(taps, ntaps);
+    free(taps);
+    taps = lpf_taps(&ntaps, 1.0f, (float)mid_rate,
+                    out_rate * 0.4f, out_rate * 0.2f);
+    fir_filter_t *stage2_fir = fir_filter_create(taps, ntaps);
+    free(taps);
+
+    size_t n_dec_in = (size_t)nf * BENCH_DECIMATION + pad_to_8(input_fir->ntaps);
+    float complex *wide = noise_cf(n_dec_in, 0.1f);
+    float complex *narrow = noise_cf(nf + 256, 0.1f);
+    float complex *cout = aligned_alloc_32((nf > fft ? nf : fft) * sizeof(float complex));
+    float *real_in = uniform_f(nf + 256, 0.0f, 1.0f);
+    float *fout = aligned_alloc_32((nf > fft ? nf : fft) * sizeof(float));
+    float *window = aligned_alloc_32(fft * sizeof(float));
+    blackman_window(window, fft);
+    float complex *spectrum = noise_cf(fft, 1.0f);
+    float *mag = uniform_f(fft, 0.0f, 1.0f);
+    float *base = uniform_f(fft, 0.5f, 1.5f);
+    float *hist = uniform_f(fft, 0.0f, 1.0f);
+    int8_t *iq = malloc(BENCH_BLOCK * 2);
+    for (int i = 0; i < BENCH_BLOCK * 2; i++)
+        iq[i] = (int8_t)(rng_next() & 0xff);
+    int16_t *iq16 = malloc(BENCH_BLOCK * 2 * sizeof(int16_t));
+    for (int i = 0; i < BENCH_BLOCK * 2; i++)
+        iq16[i] = (int16_t)(rng_next() & 0xffff);
+    float complex *conv = aligned_alloc_32(BENCH_BLOCK * sizeof(float complex));
+
+    /* Downmix filters, one burst at 250 ksps */
+    BENCH_LOOP(ns, k->fir_ccf_dec(input_fir->taps, input_fir->ntaps, wide,
+                                  cout, nf, BENCH_DECIMATION));
+    report_kernel("fir_ccf_dec", simd_impl_name(k->impl), nf * BENCH_DECIMATION,
+                  input_fir->ntaps, ns);
+
+    BENCH_LOOP(ns, k->fir_ccf(noise_fir->taps, noise_fir->ntaps, narrow, cout, nf));
+    report_kernel("fir_ccf_noise_lpf", simd_impl_name(k->impl), nf, noise_fir->ntaps, ns);
+
+    BENCH_LOOP(ns, k->fir_ccf(rrc_fir->taps, rrc_fir->ntaps, narrow, cout, nf));
+    report_kernel("fir_ccf_rrc", simd_impl_name(k->impl), nf, rrc_fir->ntaps, ns);
+
+    BENCH_LOOP(ns, k->fir_fff(box_fir->taps, box_fir->ntaps, real_in, fout, nf));
+    report_kernel("fir_fff_box", simd_impl_name(k->impl), nf, box_fir->ntaps, ns);
+
+    BENCH_LOOP(ns, k->fir_ccf_dec(stage1_fir->taps, stage1_fir->ntaps, wide,
+                                  cout, nf, BENCH_STAGE1_DEC));
+    report_kernel("fir_ccf_dec_stage1", simd_impl_name(k->impl),
+                  nf * BENCH_STAGE1_DEC, stage1_fir->ntaps, ns);
+    BENCH_LOOP(ns, k->fir_ccf_dec(stage2_fir->taps, stage2_fir->ntaps, wide,
+                                  cout, nf, stage2_dec));
+    report_kernel("fir_ccf_dec_stage2", simd_impl_name(k->impl),
+                  nf * stage2_dec, stage2_fir->ntaps, ns);
+
+    /* Stage 1 in fixed point (--input-fir=q15): int16 IQ, complex taps */
+    int16_t *wide16 = malloc(n_dec_in * 2 * sizeof(int16_t));
+    for (size_t i = 0; i < n_dec_in * 2; i++)
+        wide16[i] = (int16_t)(rng_next() & 0xffff);
+    int16_t *q15_taps = aligned_calloc_32(4 * pad_to_8(stage1_fir->ntaps),
+                                          sizeof(int16_t));
+    for (int i = 0; i < stage1_fir->ntaps; i++) {
+        int16_t t = (int16_t)lrintf(stage1_fir->taps[i] * 16384.0f);
+        q15_taps[2 * i] = t;
+        q15_taps[2 * pad_to_8(stage1_fir->ntaps) + 2 * i + 1] = t;
+    }
+    BENCH_LOOP(ns, k->fir_q15_dec(q15_taps, stage1_fir->ntaps, wide16, cout,
+                                  nf, BENCH_STAGE1_DEC, 1.0f / (16384 * 32768.0f)));
+    report_kernel("fir_q15_dec_stage1", simd_impl_name(k->impl),
+                  nf * BENCH_STAGE1_DEC, stage1_fir->ntaps, ns);
+    free(wide16);
+    free(q15_taps);
+
+    /* The same filters with the set's fixed-length kernels, if it has them */
+    simd_fir_ccf_dec_fn dec_fixed;
+    simd_fir_ccf_fn ccf_fixed;
+    simd_fir_fff_fn fff_fixed;
+    if ((dec_fixed = simd_fir_ccf_dec_fixed(k->fir_fixed, stage1_fir->ntaps,
+                                            BENCH_STAGE1_DEC))) {
+        BENCH_LOOP(ns, dec_fixed(stage1_fir->taps, stage1_fir->ntaps, wide,
+                                 cout, nf, BENCH_STAGE1_DEC));
+        report_kernel("fir_ccf_dec_stage1_fixed", simd_impl_name(k->impl),
+                      nf * BENCH_STAGE1_DEC, stage1_fir->ntaps, ns);
+    }
+    if ((dec_fixed = simd_fir_ccf_dec_fixed(k->fir_fixed, stage2_fir->ntaps,
+                                            stage2_dec))) {
+        BENCH_LOOP(ns, dec_fixed(stage2_fir->taps, stage2_fir->ntaps, wide,
+                                 cout, nf, stage2_dec));
+        report_kernel("fir_ccf_dec_stage2_fixed", simd_impl_name(k->impl),
+                      nf * stage2_dec, stage2_fir->ntaps, ns);
+    }
+    if ((ccf_fixed = simd_fir_ccf_fixed(k->fir_fixed, noise_fir->ntaps))) {
+        BENCH_LOOP(ns, ccf_fixed(noise_fir->taps, noise_fir->ntaps, narrow, cout, nf));
+        report_kernel("fir_ccf_noise_lpf_fixed", simd_impl_name(k->impl), nf,
+                      noise_fir->ntaps, ns);
+    }
+    if ((ccf_fixed = simd_fir_ccf_fixed(k->fir_fixed, rrc_fir->ntaps))) {
+        BENCH_LOOP(ns, ccf_fixed(rrc_fir->taps, rrc_fir->ntaps, narrow, cout, nf));
+        report_kernel("fir_ccf_rrc_fixed", simd_impl_name(k->impl), nf,
+                      rrc_fir->ntaps, ns);
+    }
+    if ((fff_fixed = simd_fir_fff_fixed(k->fir_fixed, box_fir->ntaps))) {
+        BENCH_LOOP(ns, fff_fixed(box_fir->taps, box_fir->ntaps, real_in, fout, nf));
+        report_kernel("fir_fff_box_fixed", simd_impl_name(k->impl), nf,
+                      box_fir->ntaps, ns);
+    }
+
+    BENCH_LOOP(ns, k->mag_squared(narrow, fout, nf));
+    report_kernel("mag_squared", simd_impl_name(k->impl), nf, 0, ns);
+
+    /* Detector, one FFT frame */
+    BENCH_LOOP(ns, k->window_cf(spectrum, window, cout, fft));
+    report_kernel("window_cf", simd_impl_name(k->impl), fft, 0, ns);
+
+    BENCH_LOOP(ns, k->fftshift_mag(spectrum, fout, fft));
+    report_kernel("fftshift_mag", simd_impl_name(k->impl), fft, 0, ns);
+
+    BENCH_LOOP(ns, k->baseline_update(base, hist, mag, fft));
+    report_kernel("baseline_update", simd_impl_name(k->impl), fft, 0, ns);
+
+    BENCH_LOOP(ns, k->relative_mag(mag, base, fout, fft));
+    report_kernel("relative_mag", simd_impl_name(k->impl), fft, 0, ns);
+
+    BENCH_LOOP(ns, sink = k->max_float(mag, fft));
+    report_kernel("max_float", simd_impl_name(k->impl), fft, 0, ns);
+
+    /* Peak scan with about one bin in 50 over the threshold */
+    float *peak_mask = uniform_f(fft, 1.0f, 1.0f);
+    int *peak_bins = malloc(fft * sizeof(*peak_bins));
+    BENCH_LOOP(ns, sink = (float)k->peak_bins(mag, peak_mask, 0.98f, 0, fft,
+                                              peak_bins));
+    report_kernel("peak_bins", simd_impl_name(k->impl), fft, 0, ns);
+    free(peak_mask);
+    free(peak_bins);
+
+    BENCH_LOOP(ns, k->csquare_window(spectrum, window, cout, fft));
+    report_kernel("csquare_window", simd_impl_name(k->impl), fft, 0, ns);
+
+    /* Chase search of one BCH(31,21) block at the deepest setting */
+    int n_cand = 1 << CHASE_MAX_BITS;
+    bch_code_t code;
+    if (bch_code_init(&code, 1207, 2) != 0)
+        errx(1, "out of memory");
+    uint16_t *syn = malloc(n_cand * sizeof(*syn));
+    for (int i = 0; i < n_cand; i++)
+        syn[i] = (uint16_t)(rng_next() & 1023);
+    float *cand_cost = uniform_f(n_cand, 0.0f, 4.0f);
+    float *rel = uniform_f(32, 0.0f, 1.0f);
+    rel[SIMD_CHASE_NOPOS] = 0.0f;
+    BENCH_LOOP(ns, sink = (float)k->chase_select(syn, cand_cost, n_cand,
+                                                 code.err, rel));
+    report_kernel("chase_select", simd_impl_name(k->impl), n_cand, 0, ns);
+    bch_code_free(&code);
+    free(syn);
+    free(cand_cost);
+    free(rel);
+
+    /* Batched PLL, a full batch of 16 frames of 512 symbols */
+    int n_pll = 512;
+    float *pll_re = uniform_f(n_pll * SIMD_PLL_LANES, -1.0f, 1.0f);
+    float *pll_im = uniform_f(n_pll * SIMD_PLL_LANES, -1.0f, 1.0f);
+    float pll_phase[SIMD_PLL_LANES];
+    BENCH_LOOP(ns, k->pll_batch(pll_re, pll_im, n_pll, SIMD_PLL_LANES, 0.2f,
+                                pll_phase));
+    report_kernel("pll_batch", simd_impl_name(k->impl),
+                  n_pll * SIMD_PLL_LANES, 0, ns);
+    free(pll_re);
+    free(pll_im);
+
+    /* One lag of the direct sync word correlation at 10 samples/symbol */
+    int n_sync = (IR_PREAMBLE_LENGTH_SHORT + IR_UW_LENGTH) * 10;
+    float complex *sync_taps = noise_cf(n_sync, 1.0f);
+    BENCH_LOOP(ns, sink = crealf(k->dot_cc(spectrum, sync_taps, n_sync)));
+    report_kernel("dot_cc", simd_impl_name(k->impl), n_sync, 0, ns);
+    free(sync_taps);
+
+    /* Sample input, one read block */
+    BENCH_LOOP(ns, k->convert_i8_cf(iq, conv, BENCH_BLOCK));
+    report_kernel("convert_i8_cf", simd_impl_name(k->impl), BENCH_BLOCK, 0, ns);
+
+    /* Detector frame from an int8 ring */
+    BENCH_LOOP(ns, k->window_i8_cf(iq, window, cout, fft));
+    report_kernel("window_i8_cf", simd_impl_name(k->impl), fft, 0, ns);
+
+    /* The same from SC16 */
+    BENCH_LOOP(ns, k->convert_i16_cf(iq16, conv, BENCH_BLOCK));
+    report_kernel("convert_i16_cf", simd_impl_name(k->impl), BENCH_BLOCK, 0, ns);
+    BENCH_LOOP(ns, k->window_i16_cf(iq16, window, cout, fft));
+    report_kernel("window_i16_cf", simd_impl_name(k->impl), fft, 0, ns);
+
+    fir_filter_destroy(input_fir);
+    fir_filter_destroy(noise_fir);
+    fir_filter_destroy(rrc_fir);
+    fir_filter_destroy(box_fir);
+    fir_filter_destroy(stage1_fir);
+    fir_filter_destroy(stage2_fir);
+    free(wide);
+    free(narrow);
+    free(cout);
+    free(real_in);
+    free(fout);
+    free(window);
+    free(spectrum);
+    free(mag);
+    free(base);
+    free(hist);
+    free(iq);
+    free(iq16);
+    free(conv);
+}
+
+/* ---- Synthetic capture ---- */
+
+/* One burst at baseband: preamble and unique word from the downmix's own
+ * sync sequence, then payload_syms random symbols, shaped by the RRC taps
+ * h (one pulse every sps samples) into pulse[len]. */
+static void shape_burst(float complex *pulse, size_t len, const float *h,
+                        int ntaps, double sps, int preamble_len,
+                        int payload_syms) {
+    float complex syms[IR_PREAMBLE_LENGTH_LONG + IR_UW_LENGTH];
+    int n_sync = burst_downmix_sync_symbols(0, preamble_len, syms);
+
+    memset(pulse, 0, len * sizeof(float complex));
+    for (int s = 0; s < n_sync + payload_syms; s++) {
+        float complex v;
+        if (s < n_sync)
+            v = syms[s] * (float)M_SQRT1_2;
+        else
+            v = cexpf(I * (float)(M_PI / 4 + (rng_next() & 3) * M_PI / 2));
+        size_t c = (size_t)llround(s * sps);
+        for (int t = 0; t < ntaps && c + t < len; t++)
+            pulse[c + t] += h[t] * v;
+    }
+}
+
+static size_t burst_len(double sps, int preamble_len, int ntaps) {
+    int n_syms = preamble_len + IR_UW_LENGTH + BENCH_PAYLOAD_SYMS;
+    return (size_t)(n_syms * sps) + ntaps;
+}
+
+static float *synth_rrc(int rate, int *ntaps) {
+    double sps = (double)rate / IR_SYMBOLS_PER_SECOND;
+    return rrc_taps(ntaps, 1.0f / sqrtf((float)sps), (float)rate,
+                    (float)IR_SYMBOLS_PER_SECOND, BENCH_RRC_ALPHA,
+                    (int)(8 * sps));
+}
+
+/* Simplex-band downlink bursts (64-symbol preamble, unique word, random
+ * payload), RRC shaped, spread across the band in white noise */
+static float complex *synth_capture(int rate, int n_bursts, size_t *n_out) {
+    size_t n = (size_t)((BENCH_LEAD_IN + n_bursts * BENCH_BURST_SPACING + 0.05) * rate);
+    float complex *x = noise_cf(n, 0.003f);
+
+    double sps = (double)rate / IR_SYMBOLS_PER_SECOND;
+    int ntaps;
+    float *h = synth_rrc(rate, &ntaps);
+    size_t len = burst_len(sps, IR_PREAMBLE_LENGTH_LONG, ntaps);
+    float complex *pulse = malloc(len * sizeof(float complex));
+
+    for (int b = 0; b < n_bursts; b++) {
+        shape_burst(pulse, len, h, ntaps, sps, IR_PREAMBLE_LENGTH_LONG,
+                    BENCH_PAYLOAD_SYMS);
+
+        double f = ((b * 37) % 21 - 10) * 0.04 * rate;
+        size_t start = (size_t)((BENCH_LEAD_IN + b * BENCH_BURST_SPACING) * rate);
+        for (size_t i = 0; i < len && start + i < n; i++)
+            x[start + i] += 0.25f * pulse[i] *
+                cexpf(I * (float)(2 * M_PI * f * (double)i / rate + 0.3 * b));
+    }
+
+    free(pulse);
+    free(h);
+    *n_out = n;
+    return x;
+}
+
+/* ---- Synthetic capture file (--synth) ---- */
+
+typedef struct {
+    double center;          /* Hz */
+    double duration;        /* seconds */
+    double burst_rate;      /* mean bursts per second (Poisson) */
+    double snr;             /* dB, in the symbol-rate bandwidth */
+    double cfo;             /* maximum |Doppler| in Hz, uniform */
+    double pairs;           /* fraction of bursts with a neighbour alongside */
+    int format;             /* SAMPLE_FMT_* */
+    unsigned long seed;
+} synth_opts_t;
+
+typedef struct {
+    float complex *pulse;
+    size_t len;
+    size_t start;           /* first sample in the file */
+    double freq;            /* offset from the center, Hz */
+    float amp;
+} synth_burst_t;
+
+static double rng_exponential(double mean) {
+    return -mean * log(rng_uniform());
+}
+
+static void write_block(FILE *f, const float complex *x, size_t n, int format,
+                        void *buf) {
+    size_t item;
+    if (format == SAMPLE_FMT_FLOAT) {
+        item = sizeof(float complex);
+        memcpy(buf, x, n * item);
+    } else {
+        float full = format == SAMPLE_FMT_INT16 ? 32767.0f : 127.0f;
+        for (size_t i = 0; i < 2 * n; i++) {
+            float v = lrintf(((const float *)x)[i] * full);
+            v = v > full ? full : v < -full ? -full : v;
+            if (format == SAMPLE_FMT_INT16)
+                ((int16_t *)buf)[i] = (int16_t)v;
+            else
+                ((int8_t *)buf)[i] = (int8_t)v;
+        }
+        item = format == SAMPLE_FMT_INT16 ? 2 * sizeof(int16_t) : 2;
+    }
+    if (fwrite(buf, item, n, f) != n)
+        err(1, "write");
+}
+
+/* Write a capture of downlink bursts on the Iridium channels inside
+ * [center - rate/2, center + rate/2]: Poisson arrivals, a random Doppler
+ * offset each, at a fixed SNR. Simplex channels get the long preamble,
+ * duplex channels the short one. A share of the bursts gets a second one
+ * on the next channel, starting within a millisecond of it, so both sides
+ * of every channel boundary see simultaneous bursts. Streams the file a
+ * block at a time and prints one JSON summary line. */
+static void synth_file(const char *path, int rate, const synth_opts_t *o) {
+    const size_t block = 1 << 20;
+    const float sigma = 0.05f;      /* noise rms, well clear of clipping */
+    size_t n = (size_t)(o->duration * rate);
+    double sps = (double)rate / IR_SYMBOLS_PER_SECOND;
+
+    int ntaps;
+    float *h = synth_rrc(rate, &ntaps);
+    double energy = 0;
+    for (int t = 0; t < ntaps; t++)
+        energy += (double)h[t] * h[t];
+    /* Symbol energy over the noise in one symbol-rate bandwidth */
+    float amp = sigma * (float)sqrt(pow(10.0, o->snr / 10) / energy);
+
+    /* Channels whose bursts, with Doppler, stay inside the capture */
+    int channels[IR_CHANNELS], n_channels = 0;
+    double edge = 0.45 * rate - o->cfo - IR_CHANNEL_WIDTH / 2;
+    for (int k = 0; k < IR_CHANNELS; k++) {
+        double f = IR_BASE_FREQ + (k + 0.5) * IR_CHANNEL_WIDTH;
+        if (fabs(f - o->center) < edge)
+            channels[n_channels++] = k;
+    }
+    if (n_channels == 0)
+        errx(1, "No Iridium channel lies inside %.0f Hz +- %d/2",
+             o->center, rate);
+
+    FILE *f = strcmp(path, "-") == 0 ? stdout : fopen(path, "wb");
+    if (!f)
+        err(1, "%s", path);
+
+    float complex *x = aligned_alloc_32(block * sizeof(float complex));
+    void *buf = malloc(block * sizeof(float complex));
+    synth_burst_t *active = NULL;
+    int n_active = 0, cap_active = 0;
+    unsigned long n_bursts = 0;
+
+    /* Leave the lead-in quiet while the detector's baseline fills */
+    rng_state = 0x2545f4914f6cdd1dULL ^ ((uint64_t)o->seed * 0x9e3779b97f4a7c15ULL);
+    if (rng_state == 0)
+        rng_state = 1;
+    double t_next = BENCH_LEAD_IN + rng_exponential(1.0 / o->burst_rate);
+    for (size_t pos = 0; pos < n; pos += block) {
+        size_t nb = n - pos < block ? n - pos : block;
+
+        while ((size_t)(t_next * rate) < pos + nb) {
+            size_t first = (size_t)(t_next * rate);
+            t_next += rng_exponential(1.0 / o->burst_rate);
+
+            int c = rng_next() % n_channels;
+            int n_pair = o->pairs > 0 && n_channels > 1 &&
+                         rng_uniform() < o->pairs ? 2 : 1;
+            if (c == n_channels - 1 && n_pair == 2)
+                c--;
+            for (int j = 0; j < n_pair; j++) {
+                size_t start = first;
+                if (j > 0)
+                    start += (size_t)(rng_uniform() * rate / 1000);
+                int k = channels[c + j];
+                double freq = IR_BASE_FREQ + (k + 0.5) * IR_CHANNEL_WIDTH;
+                int simplex = freq >= IR_SIMPLEX_FREQUENCY_MIN;
+                int preamble = simplex ? IR_PREAMBLE_LENGTH_LONG
+                                       : IR_PREAMBLE_LENGTH_SHORT;
+                size_t len = burst_len(sps, preamble, ntaps);
+                if (start + len > n)
+                    continue;
+
+                if (n_active == cap_active) {
+                    cap_active = cap_active ? 2 * cap_active : 16;
+                    active = realloc(active, cap_active * sizeof(*active));
+                }
+                synth_burst_t *b = &active[n_active++];
+                b->pulse = malloc(len * sizeof(float complex));
+                b->len = len;
+                b->start = start;
+                b->freq = freq - o->center + o->cfo * (2 * rng_uniform() - 1);
+                b->amp = amp;
+                shape_burst(b->pulse, len, h, ntaps, sps, preamble,
+                            BENCH_PAYLOAD_SYMS);
+                n_bursts++;
+            }
+        }
+
+        for (size_t i = 0; i < nb; i++)
+            x[i] = sigma * M_SQRT1_2 * rng_gauss();
+
+        for (int a = 0; a < n_active; ) {
+            synth_burst_t *b = &active[a];
+            size_t lo = b->start > pos ? b->start : pos;
+            size_t hi = b->start + b->len < pos + nb ? b->start + b->len : pos + nb;
+            double w = 2 * M_PI * b->freq / rate;
+            for (size_t i = lo; i < hi; i++)
+                x[i - pos] += b->amp * b->pulse[i - b->start] *
+                    (float complex)cexp(I * w * (double)(i - b->start));
+            if (b->start + b->len <= pos + nb) {
+                free(b->pulse);
+                *b = active[--n_active];
+            } else {
+                a++;
+            }
+        }
+
+        write_block(f, x, nb, o->format, buf);
+    }
+
+    if (f != stdout)
+        fclose(f);
+    else
+        fflush(f);
+    for (int a = 0; a < n_active; a++)
+        free(active[a].pulse);
+    free(active);
+    free(buf);
+    free(x);
+    free(h);
+
+    static const char *formats[] = {
+        [SAMPLE_FMT_INT8] = "ci8", [SAMPLE_FMT_FLOAT] = "cf32",
+        [SAMPLE_FMT_INT16] = "ci16",
+    };
+    fprintf(f == stdout ? stderr : stdout,
+            "{\"bench\":\"synth\",\"file\":\"%s\",\"format\":\"%s\","
+            "\"rate\":%d,\"center\":%.0f,\"duration_s\":%.3f,\"samples\":%zu,"
+            "\"channels\":%d,\"bursts\":%lu,\"snr_db\":%.1f,\"cfo_hz\":%.0f,"
+            "\"pairs\":%.2f,\"seed\":%lu}\n",
+            path, formats[o->format], rate, o->center, o->duration, n,
+            n_channels, n_bursts, o->snr, o->cfo, o->pairs, o->seed);
+}
+
+/* ---- Pipeline benchmarks ---- */
+
+typedef struct {
+    burst_data_t **bursts;
+    int n, cap;
+} burst_set_t;
+
+/* Detector callback: keep a private, contiguous copy of each burst so the
+ * ring can be reused and the downmix loop can run over them repeatedly.
+ * With --narrowband the extraction runs here, as in burst_to_queue(). */
+static void collect_burst(burst_data_t *burst, void *user) {
+    burst_set_t *set = user;
+
+    burst = burst_extract(burst);
+
+    burst_data_t *copy = malloc(sizeof(*copy));
+    *copy = *burst;
+    float complex *s = malloc(burst->num_samples * sizeof(float complex));
+    const float complex *cf = burst_data_cf(burst, 0, burst->num_samples, s);
+    if (cf != s)
+        memcpy(s, cf, burst->num_samples * sizeof(float complex));
+    copy->format = SAMPLE_FMT_FLOAT;
+    copy->samples = s;
+    copy->split = burst->num_samples;
+    copy->wrap = NULL;
+    copy->arena = NULL;
+    copy->offset = 0;
+    burst_data_release(burst);
+
+    if (set->n == set->cap) {
+        set->cap = set->cap ? set->cap * 2 : 64;
+        set->bursts = realloc(set->bursts, set->cap * sizeof(*set->bursts));
+    }
+    set->bursts[set->n++] = copy;
+}
+
+static void count_burst(burst_data_t *burst, void *user) {
+    (*(int *)user)++;
+    burst_data_release(burst);
+}
+
+static void report_stage(const char *name, const char *impl, int bursts,
+                         uint64_t samples, uint64_t runs, uint64_t elapsed_ns,
+                         double plan_ms, int out) {
+    printf("{\"bench\":\"pipeline\",\"name\":\"%s\",\"impl\":\"%s\","
+           "\"bursts\":%d,\"out\":%d,\"plan_ms\":%.1f,"
+           "\"ns_per_sample\":%.3f,\"bursts_per_s\":%.1f}\n",
+           name, impl, bursts, out, plan_ms,
+           samples ? (double)elapsed_ns / (double)samples : 0.0,
+           elapsed_ns ? runs * 1e9 / (double)elapsed_ns : 0.0);
+    fflush(stdout);
+}
+
+static void bench_pipeline(const char *impl, const float complex *capture,
+                           size_t n_capture, int rate) {
+    uint64_t min_ns = (uint64_t)(min_time * 1e9);
+    burst_set_t set = { 0 };
+
+    /* Detector over the whole capture, in read-sized blocks */
+    burst_config_t det_config = {
+        .center_frequency = IR_SIMPLEX_FREQUENCY_MIN,
+        .sample_rate = rate,
+        .trim_bursts = trim_bursts,
+    };
+    uint64_t t0 = pstats_now();
+    burst_detector_t *det = burst_detector_create(&det_config);
+    double det_plan_ms = (pstats_now() - t0) / 1e6;
+
+    t0 = pstats_now();
+    for (size_t pos = 0; pos < n_capture; pos += BENCH_BLOCK) {
+        size_t n = n_capture - pos < BENCH_BLOCK ? n_capture - pos : BENCH_BLOCK;
+        burst_detector_feed_cf(det, capture + pos, n, collect_burst, &set);
+    }
+    uint64_t elapsed = pstats_now() - t0;
+    burst_detector_destroy(det);
+    report_stage("burst_detect", impl, set.n, n_capture, set.n, elapsed,
+                 det_plan_ms, set.n);
+
+    /* The same capture as int8 IQ, which the ring keeps as such */
+    int8_t *iq = malloc(2 * n_capture);
+    const float *f = (const float *)capture;
+    float peak = 0.0f;
+    for (size_t i = 0; i < 2 * n_capture; i++)
+        peak = fmaxf(peak, fabsf(f[i]));
+    for (size_t i = 0; i < 2 * n_capture; i++)
+        iq[i] = (int8_t)lrintf(f[i] * (127.0f / peak));
+    int n_i8 = 0;
+    det = burst_detector_create(&det_config);
+    t0 = pstats_now();
+    for (size_t pos = 0; pos < n_capture; pos += BENCH_BLOCK) {
+        size_t n = n_capture - pos < BENCH_BLOCK ? n_capture - pos : BENCH_BLOCK;
+        burst_detector_feed(det, iq + 2 * pos, n, count_burst, &n_i8);
+    }
+    elapsed = pstats_now() - t0;
+    burst_detector_destroy(det);
+    free(iq);
+    report_stage("burst_detect_ci8", impl, n_i8, n_capture, n_i8, elapsed,
+                 0.0, n_i8);
+
+    /* And as SC16, kept in a 16-bit ring */
+    int16_t *iq16 = malloc(2 * n_capture * sizeof(int16_t));
+    for (size_t i = 0; i < 2 * n_capture; i++)
+        iq16[i] = (int16_t)lrintf(f[i] * (32767.0f / peak));
+    int n_i16 = 0;
+    det = burst_detector_create(&det_config);
+    t0 = pstats_now();
+    for (size_t pos = 0; pos < n_capture; pos += BENCH_BLOCK) {
+        size_t n = n_capture - pos < BENCH_BLOCK ? n_capture - pos : BENCH_BLOCK;
+        burst_detector_feed_ci16(det, iq16 + 2 * pos, n, count_burst, &n_i16);
+    }
+    elapsed = pstats_now() - t0;
+    burst_detector_destroy(det);
+    free(iq16);
+    report_stage("burst_detect_ci16", impl, n_i16, n_capture, n_i16, elapsed,
+                 0.0, n_i16);
+
+    if (set.n == 0) {
+        fprintf(stderr, "bench: no bursts detected, skipping downmix and demod\n");
+        return;
+    }
+
+    /* Downmix, passes over all bursts; frames from the first pass are
+     * kept for the demodulator */
+    downmix_config_t dm_config = {
+        .batch_size = downmix_batch,
+        .sync_corr = sync_corr,
+        .fine_cfo = fine_cfo,
+    };
+    t0 = pstats_now();
+    burst_downmix_t *dm = burst_downmix_create(&dm_config);
+    double dm_plan_ms = (pstats_now() - t0) / 1e6;
+
+    downmix_frame_t **frames = calloc(set.n, sizeof(*frames));
+    int *n_frames = calloc(set.n, sizeof(*n_frames));
+    int total_frames = 0;
+    uint64_t samples = 0, runs = 0;
+    t0 = pstats_now();
+    int batch = burst_downmix_batch_max(dm);
+    downmix_frame_t *batch_frames[DOWNMIX_BATCH_MAX];
+    do {
+        for (int i = 0; i < set.n; i += batch) {
+            int n = set.n - i < batch ? set.n - i : batch;
+            if (batch > 1) {
+                burst_downmix_process_batch(dm, &set.bursts[i], n, batch_frames);
+            } else {
+                batch_frames[0] = NULL;
+                burst_downmix_process(dm, set.bursts[i], &batch_frames[0]);
+            }
+            for (int k = 0; k < n; k++) {
+                downmix_frame_t *f = batch_frames[k];
+                int nf = f ? 1 : 0;
+                samples += set.bursts[i + k]->num_samples;
+                runs++;
+                if (runs <= (uint64_t)set.n) {
+                    frames[i + k] = f;
+                    n_frames[i + k] = nf;
+                    total_frames += nf;
+                } else {
+                    downmix_frame_free(f);
+                }
+            }
+        }
+        elapsed = pstats_now() - t0;
+    } while (elapsed < min_ns);
+    report_stage("burst_downmix", impl, set.n, samples, runs, elapsed,
+                 dm_plan_ms, total_frames);
+
+    /* Demodulator, passes over all frames */
+    int ok = 0;
+    samples = runs = 0;
+    t0 = pstats_now();
+    do {
+        for (int i = 0; i < set.n; i++) {
+            for (int j = 0; j < n_frames[i]; j++) {
+                demod_frame_t *d = NULL;
+                int r = qpsk_demod(&frames[i][j], &d);
+                samples += frames[i][j].num_samples;
+                if (runs < (uint64_t)total_frames)
+                    ok += r;
+                runs++;
+                demod_frame_free(d);
+            }
+        }
+        elapsed = pstats_now() - t0;
+    } while (total_frames && elapsed < min_ns);
+    report_stage("qpsk_demod", impl, total_frames, samples, runs, elapsed,
+                 0.0, ok);
+
+    /* The same frames through qpsk_demod_batch, full batches */
+    downmix_frame_t **batch_in = malloc((total_frames + 1) * sizeof(*batch_in));
+    if (!batch_in)
+        errx(1, "out of memory");
+    int n_in = 0;
+    for (int i = 0; i < set.n; i++)
+        for (int j = 0; j < n_frames[i]; j++)
+            batch_in[n_in++] = &frames[i][j];
+
+    ok = 0;
+    samples = runs = 0;
+    t0 = pstats_now();
+    do {
+        for (int i = 0; i < n_in; i += QPSK_BATCH_MAX) {
+            int nb = n_in - i < QPSK_BATCH_MAX ? n_in - i : QPSK_BATCH_MAX;
+            demod_frame_t *d[QPSK_BATCH_MAX];
+            int r = qpsk_demod_batch(&batch_in[i], nb, d);
+            for (int k = 0; k < nb; k++) {
+                samples += batch_in[i + k]->num_samples;
+                demod_frame_free(d[k]);
+            }
+            if (runs < (uint64_t)total_frames)
+                ok += r;
+            runs += nb;
+        }
+        elapsed = pstats_now() - t0;
+    } while (total_frames && elapsed < min_ns);
+    report_stage("qpsk_demod_batch", impl, total_frames, samples, runs, elapsed,
+                 0.0, ok);
+    free(batch_in);
+
+    for (int i = 0; i < set.n; i++) {
+        downmix_frame_free(frames[i]);
+        free((void *)set.bursts[i]->samples);
+        free(set.bursts[i]);
+    }
+    free(frames);
+    free(n_frames);
+    free(set.bursts);
+    burst_downmix_destroy(dm);
+}
+
+/* ---- Main ---- */
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "\n"
+        "Runs the SIMD kernels and the detector/downmix/demod stages on\n"
+        "synthetic data and prints one JSON result per line.\n"
+        "\n"
+        "Options:\n"
+        "    -r, --rate=RATE        synthetic capture sample rate (default: 10000000)\n"
+        "    -b, --bursts=N         synthetic bursts in the capture (default: 16)\n"
+        "    -t, --time=SECONDS     minimum run time per measurement (default: 0.2)\n"
+        "    -w, --wisdom=FILE      import FFTW wisdom before planning\n"
+        "    -d, --downmix-batch=N  downmix N bursts per pass (2-64, default: 1)\n"
+        "    -c, --sync-corr=MODE   downmix sync word search (auto, fft, packed)\n"
+        "    -f, --fine-cfo=MODE    downmix fine CFO estimator (fft, zoom)\n"
+        "    -x, --trim-bursts      trim burst views as --trim-bursts does\n"
+        "    -n, --narrowband=RATE  extract bursts to RATE Hz as --narrowband does\n"
+        "    -s, --simd=SET         only run one kernel set (generic, avx2, avx512, neon)\n"
+        "    -k, --kernels-only     skip the pipeline stages\n"
+        "    -p, --pipeline-only    skip the kernel benchmarks\n"
+        "    -h, --help             show this help\n"
+        "\n"
+        "Capture file (writes FILE, '-' for stdout, and exits):\n"
+        "    --synth=FILE           write a synthetic capture for the sniffer\n"
+        "    --center=HZ            center frequency (default: 1622000000)\n"
+        "    --duration=SECONDS     capture length (default: 10)\n"
+        "    --burst-rate=N         mean bursts per second (default: 200)\n"
+        "    --snr=DB               SNR in the symbol-rate bandwidth (default: 20)\n"
+        "    --cfo=HZ               maximum Doppler offset (default: 30000)\n"
+        "    --pairs=FRAC           share of bursts with a second one on the\n"
+        "                            next channel at the same time (default: 0)\n"
+        "    --format=FMT           ci8 (default), ci16 or cf32\n"
+        "    --seed=N               random seed (default: 1)\n",
+        prog);
+    exit(1);
+}
+
+enum {
+    OPT_SYNTH = 256,
+    OPT_CENTER,
+    OPT_DURATION,
+    OPT_BURST_RATE,
+    OPT_SNR,
+    OPT_CFO,
+    OPT_PAIRS,
+    OPT_FORMAT,
+    OPT_SEED,
+};
+
+int main(int argc, char **argv) {
+    int rate = BENCH_IN_RATE;
+    const char *synth_path = NULL;
+    synth_opts_t synth = {
+        .center = 1622000000.0,
+        .duration = 10.0,
+        .burst_rate = 200.0,
+        .snr = 20.0,
+        .cfo = 30000.0,
+        .pairs = 0.0,
+        .format = SAMPLE_FMT_INT8,
+        .seed = 1,
+    };
+    int n_bursts = 16;
+    const char *wisdom = NULL;
+    int run_kernels = 1, run_pipeline = 1;
+    simd_impl_t only = SIMD_AUTO;   /* all sets */
+
+    static const struct option longopts[] = {
+        { "rate",          required_argument, NULL, 'r' },
+        { "bursts",        required_argument, NULL, 'b' },
+        { "time",          required_argument, NULL, 't' },
+        { "wisdom",        required_argument, NULL, 'w' },
+        { "downmix-batch", required_argument, NULL, 'd' },
+        { "sync-corr",     required_argument, NULL, 'c' },
+        { "fine-cfo",      required_argument, NULL, 'f' },
+        { "trim-bursts",   no_argument,       NULL, 'x' },
+        { "narrowband",    required_argument, NULL, 'n' },
+        { "simd",          required_argument, NULL, 's' },
+        { "kernels-only",  no_argument,       NULL, 'k' },
+        { "pipeline-only", no_argument,       NULL, 'p' },
+        { "help",          no_argument,       NULL, 'h' },
+        { "synth",         required_argument, NULL, OPT_SYNTH },
+        { "center",        required_argument, NULL, OPT_CENTER },
+        { "duration",      required_argument, NULL, OPT_DURATION },
+        { "burst-rate",    required_argument, NULL, OPT_BURST_RATE },
+        { "snr",           required_argument, NULL, OPT_SNR },
+        { "cfo",           required_argument, NULL, OPT_CFO },
+        { "pairs",         required_argument, NULL, OPT_PAIRS },
+        { "format",        required_argument, NULL, OPT_FORMAT },
+        { "seed",          required_argument, NULL, OPT_SEED },
+        { NULL, 0, NULL, 0 },
+    };
+
+    int ch;
+    while ((ch = getopt_long(argc, argv, "r:b:t:w:d:c:f:xn:s:kph", longopts, NULL)) != -1) {
+        switch (ch) {
+        case 'r':
+            rate = (int)atof(optarg);
+            if (rate < 1000000)
+                errx(1, "--rate must be at least 1000000");
+            break;
+        case 'b':
+            n_bursts = atoi(optarg);
+            if (n_bursts < 1)
+                errx(1, "--bursts must be at least 1");
+            break;
+        case 't':
+            min_time = atof(optarg);
+            if (min_time <= 0)
+                errx(1, "--time must be positive");
+            break;
+        case 'w':
+            wisdom = optarg;
+            break;
+        case 'd':
+            downmix_batch = atoi(optarg);
+            if (downmix_batch < 2 || downmix_batch > DOWNMIX_BATCH_MAX)
+                errx(1, "--downmix-batch must be 2-%d", DOWNMIX_BATCH_MAX);
+            break;
+        case 'c':
+            if (strcmp(optarg, "auto") == 0)
+                sync_corr = SYNC_CORR_AUTO;
+            else if (strcmp(optarg, "fft") == 0)
+                sync_corr = SYNC_CORR_FFT;
+            else if (strcmp(optarg, "packed") == 0)
+                sync_corr = SYNC_CORR_PACKED;
+            else
+                errx(1, "--sync-corr must be auto, fft or packed");
+            break;
+        case 'f':
+            if (strcmp(optarg, "fft") == 0)
+                fine_cfo = FINE_CFO_FFT;
+            else if (strcmp(optarg, "zoom") == 0)
+                fine_cfo = FINE_CFO_ZOOM;
+            else
+                errx(1, "--fine-cfo must be fft or zoom");
+            break;
+        case 'x':
+            trim_bursts = 1;
+            break;
+        case 'n': {
+            int nb = atoi(optarg);
+            if (nb < BURST_EXTRACT_DEFAULT_RATE)
+                errx(1, "--narrowband must be at least %d", BURST_EXTRACT_DEFAULT_RATE);
+            burst_extract_init(nb);
+            break;
+        }
+        case 's': {
+            int impl = simd_parse_impl(optarg);
+            if (impl < 0)
+                errx(1, "Unknown SIMD set '%s'", optarg);
+            only = (simd_impl_t)impl;
+            break;
+        }
+        case 'k':
+            run_pipeline = 0;
+            break;
+        case 'p':
+            run_kernels = 0;
+            break;
+        case OPT_SYNTH:
+            synth_path = optarg;
+            break;
+        case OPT_CENTER:
+            synth.center = atof(optarg);
+            if (synth.center <= 0)
+                errx(1, "--center must be positive");
+            break;
+        case OPT_DURATION:
+            synth.duration = atof(optarg);
+            if (synth.duration <= BENCH_LEAD_IN)
+                errx(1, "--duration must be more than %.1f", BENCH_LEAD_IN);
+            break;
+        case OPT_BURST_RATE:
+            synth.burst_rate = atof(optarg);
+            if (synth.burst_rate <= 0)
+                errx(1, "--burst-rate must be positive");
+            break;
+        case OPT_SNR:
+            synth.snr = atof(optarg);
+            break;
+        case OPT_CFO:
+            synth.cfo = atof(optarg);
+            if (synth.cfo < 0 || synth.cfo > 100000)
+                errx(1, "--cfo must be 0-100000");
+            break;
+        case OPT_PAIRS:
+            synth.pairs = atof(optarg);
+            if (synth.pairs < 0 || synth.pairs > 1)
+                errx(1, "--pairs must be 0-1");
+            break;
+        case OPT_FORMAT:
+            if (strcmp(optarg, "ci8") == 0)
+                synth.format = SAMPLE_FMT_INT8;
+            else if (strcmp(optarg, "ci16") == 0)
+                synth.format = SAMPLE_FMT_INT16;
+            else if (strcmp(optarg, "cf32") == 0)
+                synth.format = SAMPLE_FMT_FLOAT;
+            else
+                errx(1, "--format must be ci8, ci16 or cf32");
+            break;
+        case OPT_SEED:
+            synth.seed = strtoul(optarg, NULL, 0);
+            break;
+        case 'h':
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if (synth_path) {
+        synth_file(synth_path, rate, &synth);
+        return 0;
+    }
+
+    fftw_lock_init();
+    if (wisdom) {
+        if (!fftwf_import_wisdom_from_filename(wisdom))
+            errx(1, "Cannot import FFTW wisdom from %s", wisdom);
+        fprintf(stderr, "bench: loaded wisdom from %s\n", wisdom);
+    }
+
+    if (run_kernels) {
+        for (int i = 0; i < N_KERNEL_SETS; i++) {
+            const char *name = simd_impl_name(kernel_sets[i].impl);
+            if (only != SIMD_AUTO && kernel_sets[i].impl != only)
+                continue;
+            if (!simd_supported(kernel_sets[i].impl)) {
+                fprintf(stderr, "bench: %s not supported on this CPU\n", name);
+                continue;
+            }
+            fprintf(stderr, "bench: kernels (%s)\n", name);
+            bench_kernels(&kernel_sets[i]);
+        }
+    }
+
+    if (run_pipeline) {
+        fprintf(stderr, "bench: synthesizing %d bursts at %d sps\n", n_bursts, rate);
+        size_t n_capture;
+        float complex *capture = synth_capture(rate, n_bursts, &n_capture);
+
+        for (int i = 0; i < N_KERNEL_SETS; i++) {
+            simd_impl_t impl = kernel_sets[i].impl;
+            if ((only != SIMD_AUTO && impl != only) || !simd_supported(impl))
+                continue;
+            simd_init(impl);
+            bench_pipeline(simd_impl_name(impl), capture, n_capture, rate);
+        }
+        free(capture);
+    }
+
+    return 0;
+}
@@ -0,0 +1,250 @@
+/*
+ * iridium-bin2raw -- convert --format-out=bin records back to RAW lines
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * iridium-bin2raw -- convert --format-out=bin records back to RAW lines
+ *
+ * Reads a binary record stream from a file or stdin, subscribes to an
+ * iridium-sniffer ZMQ PUB socket (one record per message), or follows its
+ * --shm ring, and prints each frame through the sniffer's own RAW printer,
+ * so the output is exactly what iridium-sniffer would have printed in the
+ * default format. A ring of RAW lines is copied through as it is.
+ */
+
+#define _GNU_SOURCE
+#include <err.h>
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef HAVE_ZMQ
+#include <zmq.h>
+#endif
+
+#include "frame_bin.h"
+#include "frame_output.h"
+#include "output_writer.h"
+#include "shm_ring.h"
+
+/* ---- Globals frame_output.c expects (defined in main.c there) ---- */
+
+int diagnostic_mode = 0;
+int parsed_mode = 0;
+int acars_enabled = 0;
+int output_format = OUTFMT_RAW;
+
+static frame_bin_record_t rec;
+static int stream_seen = 0;
+static const char *info_override = NULL;
+
+/* Handle one record body; returns -1 on a malformed record */
+static int handle_record(const uint8_t *body, size_t len) {
+    int type = frame_bin_decode(body, len, &rec);
+    if (type < 0)
+        return -1;
+
+    if (type == FRAME_BIN_STREAM && !stream_seen) {
+        /* Later headers (e.g. --offline-parallel workers) repeat the first */
+        static char info[sizeof(rec.file_info)];
+        memcpy(info, rec.file_info, sizeof(info));
+        frame_output_init(info_override ? info_override :
+                          info[0] ? info : NULL);
+        frame_output_set_epoch(rec.t0);
+        stream_seen = 1;
+    } else if (type == FRAME_BIN_FRAME) {
+        if (!stream_seen) {
+            /* Joined mid-stream (ZMQ): origin from the first frame, as
+             * the sniffer does when it has no epoch */
+            frame_output_init(info_override);
+            stream_seen = 1;
+        }
+        frame_output_print(&rec.frame);
+    }
+    return 0;
+}
+
+static int read_stream(FILE *f) {
+    static uint8_t body[FRAME_BIN_MAX_RECORD];
+    uint8_t hdr[4];
+
+    while (fread(hdr, 1, 4, f) == 4) {
+        uint32_t len = (uint32_t)hdr[0] | ((uint32_t)hdr[1] << 8) |
+                       ((uint32_t)hdr[2] << 16) | ((uint32_t)hdr[3] << 24);
+        if (len == 0 || len > sizeof(body)) {
+            warnx("bad record length %u", len);
+            return 1;
+        }
+        if (fread(body, 1, len, f) != len) {
+            warnx("truncated record");
+            return 1;
+        }
+        if (handle_record(body, len) != 0) {
+            warnx("malformed record");
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#ifdef HAVE_ZMQ
+static int read_zmq(const char *endpoint) {
+    static uint8_t msg[FRAME_BIN_MAX_RECORD];
+
+    void *ctx = zmq_ctx_new();
+    void *sock = ctx ? zmq_socket(ctx, ZMQ_SUB) : NULL;
+    if (!sock || zmq_connect(sock, endpoint) != 0)
+        errx(1, "Cannot connect ZMQ SUB socket to %s", endpoint);
+    zmq_setsockopt(sock, ZMQ_SUBSCRIBE, "", 0);
+
+    /* Each part is one record, length prefix included */
+    while (1) {
+        int n = zmq_recv(sock, msg, sizeof(msg), 0);
+        if (n < 0)
+            break;
+        if (n < 4 || n > (int)sizeof(msg))
+            continue;
+        if (handle_record(msg + 4, (size_t)n - 4) != 0)
+            warnx("malformed record");
+    }
+
+    zmq_close(sock);
+    zmq_ctx_destroy(ctx);
+    return 0;
+}
+#endif
+
+/* Follow a --shm ring until the sniffer closes it. The writer batches
+ * lines every --output-flush-ms, so polling every 2 ms adds no latency
+ * worth having a wakeup mechanism for. */
+static int read_shm(const char *name) {
+    static uint8_t rec_buf[FRAME_BIN_MAX_RECORD > 65536 ? FRAME_BIN_MAX_RECORD : 65536];
+    shm_ring_reader_t rd;
+    const struct timespec idle = { 0, 2000000 };
+
+    while (shm_ring_open(&rd, name) != 0) {
+        if (errno != ENOENT)
+            err(1, "Cannot open shared-memory ring %s", name);
+        nanosleep(&idle, NULL);     /* sniffer not started yet */
+    }
+
+    int binary = rd.format == SHM_RING_BIN;
+    if (binary) {
+        size_t n = shm_ring_preamble(&rd, rec_buf, sizeof(rec_buf));
+        if (n > 4)
+            handle_record(rec_buf + 4, n - 4);
+    }
+
+    uint64_t lost = 0, reported = 0;
+    size_t len;
+    int r;
+    while ((r = shm_ring_read(&rd, rec_buf, sizeof(rec_buf), &len, &lost)) >= 0) {
+        if (lost != reported) {
+            warnx("reader fell behind, %" PRIu64 " records skipped", lost - reported);
+            reported = lost;
+        }
+        if (r == 0) {
+            frame_output_flush();
+            nanosleep(&idle, NULL);
+            continue;
+        }
+        if (!binary)
+            output_writer_put((const char *)rec_buf, len, OUTPUT_STDOUT);
+        else if (len < 4 || handle_record(rec_buf + 4, len - 4) != 0)
+            warnx("malformed record");
+    }
+
+    shm_ring_close(&rd);
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [options] [FILE]\n"
+        "\n"
+        "Converts iridium-sniffer --format-out=bin records (from FILE, or\n"
+        "stdin) to iridium-toolkit RAW lines on stdout.\n"
+        "\n"
+        "Options:\n"
+        "    -i, --file-info=STR    override the file info string in the stream\n"
+#ifdef HAVE_ZMQ
+        "    -z, --zmq=ENDPOINT     subscribe to a ZMQ PUB socket instead of\n"
+        "                            reading a file (e.g. tcp://host:7006)\n"
+#endif
+        "    -m, --shm=NAME         follow an iridium-sniffer --shm ring\n"
+        "                            (e.g. iridium-sniffer), from its newest record\n"
+        "    -h, --help             show this help\n",
+        prog);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    const char *zmq_endpoint = NULL;
+    const char *shm_name = NULL;
+    int ch;
+
+    static const struct option longopts[] = {
+        { "file-info",  required_argument, NULL, 'i' },
+        { "zmq",        required_argument, NULL, 'z' },
+        { "shm",        required_argument, NULL, 'm' },
+        { "help",       no_argument,       NULL, 'h' },
+        { NULL,         0,                 NULL, 0 }
+    };
+
+    while ((ch = getopt_long(argc, argv, "i:z:m:h", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 'i':
+                info_override = optarg;
+                break;
+            case 'z':
+#ifdef HAVE_ZMQ
+                zmq_endpoint = optarg;
+#else
+                errx(1, "--zmq requires ZMQ support (install libzmq3-dev and rebuild)");
+#endif
+                break;
+            case 'm':
+                shm_name = optarg;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    /* Batched into a pipe, line by line on a terminal */
+    frame_output_start(OUTPUT_FLUSH_MS_DEFAULT);
+
+    int ret;
+    if (shm_name) {
+        ret = read_shm(shm_name);
+    } else
+#ifdef HAVE_ZMQ
+    if (zmq_endpoint) {
+        ret = read_zmq(zmq_endpoint);
+    } else
+#endif
+    {
+        (void)zmq_endpoint;
+        FILE *f = stdin;
+        if (optind < argc) {
+            f = fopen(argv[optind], "rb");
+            if (!f)
+                err(1, "Cannot open %s", argv[optind]);
+        }
+        ret = read_stream(f);
+        if (f != stdin)
+            fclose(f);
+    }
+
+    frame_output_shutdown();
+    return ret;
+}
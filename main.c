@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
 #include <sys/types.h>
 #include <time.h>
 #include <unistd.h>
@@ -39,47 +40,46 @@
 
 #include "sdr.h"
 #include "iridium.h"
+#include "band_plan.h"
 #include "burst_detect.h"
+#include "burst_extract.h"
 #include "burst_downmix.h"
+#include "channelizer.h"
+#include "demod_pool.h"
+#include "downmix_pool.h"
+#include "burst_archive.h"
+#include "burst_sched.h"
+#include "burst_net.h"
+#include "sample_pool.h"
+#include "frame_pool.h"
+#include "offline.h"
+#include "pipeline_stats.h"
+#include "placement.h"
 #include "qpsk_demod.h"
 #include "frame_output.h"
+#include "output_writer.h"
+#include "bch_chase.h"
 #include "frame_decode.h"
 #include "web_map.h"
 #include "ida_decode.h"
 #include "doppler_pos.h"
 #include "gsmtap.h"
+#include "net_output.h"
+#include "net_input.h"
 #include "sbd_acars.h"
+#include "shm_ring.h"
 #include "fftw_lock.h"
+#include "fftw_plans.h"
 #include "simd_kernels.h"
 #include <fftw3.h>
 
 /* FFTW planner mutex (defined here, declared in fftw_lock.h) */
 pthread_mutex_t fftw_planner_mutex;
 
-/* FFTW wisdom file path */
-#define FFTW_WISDOM_FILE ".iridium-sniffer-fftw-wisdom"
-
-static void fftw_load_wisdom(void) {
-    const char *home = getenv("HOME");
-    if (!home) return;
-    char path[512];
-    snprintf(path, sizeof(path), "%s/%s", home, FFTW_WISDOM_FILE);
-    if (fftwf_import_wisdom_from_filename(path))
-        fprintf(stderr, "FFTW: loaded wisdom from %s\n", path);
-}
-
-static void fftw_save_wisdom(void) {
-    const char *home = getenv("HOME");
-    if (!home) return;
-    char path[512];
-    snprintf(path, sizeof(path), "%s/%s", home, FFTW_WISDOM_FILE);
-    if (fftwf_export_wisdom_to_filename(path))
-        fprintf(stderr, "FFTW: saved wisdom to %s\n", path);
-}
-
 #define C_FEK_BLOCKING_QUEUE_IMPLEMENTATION
 #define C_FEK_FAIR_LOCK_IMPLEMENTATION
 #include "blocking_queue.h"
+#include "mpmc_ring.h"
 
 #include "pthread_barrier.h"
 
@@ -99,22 +99,19 @@ char *file_info = NULL;
 double threshold_db = IR_DEFAULT_THRESHOLD;
 iq_format_t iq_format = FMT_CI8;
 
-/* SDR selection */
-char *serial = NULL;
-#ifdef HAVE_BLADERF
-int bladerf_num = -1;
-#endif
-#ifdef HAVE_UHD
-char *usrp_serial = NULL;
-#endif
+/* Inputs: SDRs (-i) and network IQ sources (--net-input), in order */
+rx_spec_t rx_specs[SDR_MAX_RX];
+int n_rx = 0;
+int dedup_ms = 40;              /* --dedup-ms, 0 = off */
 #ifdef HAVE_SOAPYSDR
-int soapy_num = -1;
-char *soapy_args = NULL;
 #define SOAPY_SETTINGS_MAX 8
 char *soapy_setting_keys[SOAPY_SETTINGS_MAX];
 char *soapy_setting_vals[SOAPY_SETTINGS_MAX];
 int soapy_setting_count = 0;
 #endif
+/* Driver stream buffers: count and samples each, 0 = backend default */
+int sdr_buffers = 0;
+int sdr_buffer_size = 0;
 
 /* Per-SDR gain settings (defaults from gr-iridium example configs) */
 int hackrf_lna_gain = 40;
@@ -137,8 +134,42 @@ int use_gpu = 1;
 int use_gpu = 0;
 #endif
 
-int no_simd = 0;
+int simd_impl = SIMD_AUTO;      /* --simd / --no-simd */
+int downmix_workers = 0;        /* 0 = default (DOWNMIX_POOL_DEFAULT) */
+int downmix_workers_auto = 0;   /* resize the pool with load */
+int pin_workers = 0;            /* --workers: --affinity=auto unless given */
+int huge_pages = HUGE_PAGES_OFF; /* --huge-pages */
+int demod_workers = 0;          /* 0 = default (DEMOD_POOL_DEFAULT) */
+int demod_batch = 0;            /* 0 = default (DEMOD_BATCH_DEFAULT) */
+int downmix_batch = 0;          /* bursts per downmix pass, 0 = one */
+int sync_corr = SYNC_CORR_AUTO; /* --sync-corr */
+int fine_cfo = FINE_CFO_FFT;    /* --fine-cfo */
+int input_fir = INPUT_FIR_FLOAT; /* --input-fir */
+int detector_overlap = 1;       /* detector frames per FFT length */
+int noise_floor = NOISE_FLOOR_FULL; /* --noise-floor */
+band_plan_t *band_plan = NULL;  /* --channels, NULL = every channel */
+int trim_bursts = 0;            /* end burst views at the frame-length bound */
+double trim_margin_ms = 0;      /* margin past the bound, 0 = default */
+int narrowband_rate = 0;        /* extract bursts to this rate, 0 = off */
+int channelize = 0;             /* sub-band detectors, 0 = one wideband detector */
+int use_mmap = 0;               /* map the input file instead of fread */
+int offline_parallel = 0;       /* worker processes over file segments */
+int stats_json = 0;             /* stats line as JSON with stage timings */
+int output_flush_ms = OUTPUT_FLUSH_MS_DEFAULT;  /* --output-flush-ms */
+int ida_slots = 0;              /* IDA messages in progress, 0 = default */
+int chase_bits = CHASE_DEFAULT_BITS;            /* --chase-bits */
+int output_format = OUTFMT_RAW;                 /* --format-out */
+char *wisdom_path = NULL;       /* --wisdom, NULL = environment or $HOME */
+int plan_only = 0;              /* --plan-only: plan, save wisdom, exit */
 char *save_bursts_dir = NULL;
+int burst_segment_mb = 256;     /* --burst-segment-mb */
+int burst_segments = 0;         /* --burst-segments, 0 = keep all */
+char *replay_bursts_dir = NULL; /* --replay-bursts */
+char *burst_out = NULL;         /* --burst-out: edge, send bursts to HOST:PORT */
+char *burst_in = NULL;          /* --burst-in: central, take bursts on [ADDR:]PORT */
+int burst_queue_mb = 256;       /* --burst-queue-mb */
+int shed_order[SHED_CRITERIA];  /* --shed-order */
+int n_shed_order = 0;           /* 0 = SHED_ORDER_DEFAULT */
 int diagnostic_mode = 0;
 int use_gardner = 1;
 int parsed_mode = 0;
@@ -163,6 +194,8 @@ int feed_tcp_port = 0;
 int zmq_enabled = 0;
 char *zmq_endpoint = NULL;
 #define ZMQ_DEFAULT_ENDPOINT "tcp://*:7006"
+char *shm_name = NULL;          /* --shm ring, NULL = off */
+int shm_mb = SHM_RING_DEFAULT_MB; /* --shm-mb */
 
 /* Threading state */
 volatile sig_atomic_t running = 1;
@@ -172,10 +205,9 @@ pid_t self_pid;
 #define SAMPLES_QUEUE_SIZE 4096
 #define BURST_QUEUE_SIZE   2048
 #define FRAME_QUEUE_SIZE   512
-#define NUM_DOWNMIX_WORKERS 4
-Blocking_Queue samples_queue;
-Blocking_Queue burst_queue;
-Blocking_Queue frame_queue;
+mpmc_ring_t samples_queue;
+burst_sched_t *burst_queue;
+mpmc_ring_t frame_queue;
 
 /* Atomic stats counters (for gr-iridium compatible status line) */
 atomic_ulong stat_n_detected = 0;
@@ -183,25 +215,128 @@ atomic_ulong stat_n_handled = 0;
 atomic_ulong stat_n_ok_bursts = 0;
 atomic_ulong stat_n_ok_sub = 0;
 atomic_ulong stat_n_dropped = 0;
+atomic_ulong stat_frames_dropped = 0;   /* frames lost to a full frame queue */
+atomic_ulong stat_shed_simplex = 0;     /* simplex-band bursts shed by the burst queue */
+atomic_ulong stat_shed_duplex = 0;      /* duplex-band bursts shed by the burst queue */
+atomic_ulong stat_ring_moves = 0;       /* detector rings moved off a stalled downmix */
 atomic_ulong stat_sample_count = 0;
+atomic_ulong stat_samples_dropped = 0;  /* sample blocks lost to a full queue */
+atomic_ulong stat_burst_bytes = 0;      /* IQ bytes in burst views */
+atomic_ulong stat_burst_bytes_untrimmed = 0;    /* the same without --trim-bursts */
+atomic_ulong stat_narrowband_bytes = 0; /* IQ bytes in extracted bursts */
+atomic_ulong stat_sync_direct = 0;      /* sync words found by direct correlation */
+atomic_ulong stat_sync_fft = 0;         /* sync words found by FFT correlation */
+atomic_ulong stat_net_sent = 0;         /* messages sent to network sinks */
+atomic_ulong stat_net_dropped = 0;      /* messages dropped by network sinks */
+atomic_ulong stat_net_in_packets = 0;   /* IQ packets received by --net-input */
+atomic_ulong stat_net_in_lost = 0;      /* IQ packets lost and zero-filled */
+atomic_ulong stat_net_in_late = 0;      /* IQ packets late, duplicate or malformed */
+atomic_ulong stat_rx_duplicates = 0;    /* frames dropped as another input's copy */
+atomic_ulong stat_archive_bursts = 0;   /* bursts written to the --save-bursts archive */
+atomic_ulong stat_archive_dropped = 0;  /* bursts the archive writer fell behind on */
+atomic_ulong stat_burst_net_bursts = 0; /* bursts sent by --burst-out or received by --burst-in */
+atomic_ulong stat_burst_net_bytes = 0;  /* record bytes of those bursts */
+atomic_ulong stat_burst_net_dropped = 0;    /* bursts --burst-out had no connection for */
+atomic_ulong stat_frame_class[FRAME_CLASS_COUNT];   /* frames per frame_classify() type */
 
 /* Global detector pointer for diagnostic stats (set by detector thread) */
 burst_detector_t *global_detector = NULL;
 
+/* One per input: its sample queue, detector, and device with the thread
+ * streaming from it. File input runs as receiver 0 alone. */
+typedef struct {
+    mpmc_ring_t *queue;         /* receiver 0: samples_queue */
+    burst_detector_t *det;
+    pthread_t detector;
+    pthread_t thread;           /* stream thread, unless the driver has its own */
+    int has_thread;
+    sdr_stream_t stream;        /* device and receiver index */
+} receiver_t;
+
+static receiver_t receivers[SDR_MAX_RX] = { { .queue = &samples_queue } };
+static mpmc_ring_t rx_queues[SDR_MAX_RX - 1];     /* receivers 1.. */
+
 /* Input file */
 FILE *in_file = NULL;
+static const int8_t *in_map = NULL;     /* --mmap: whole file */
+static size_t in_map_len = 0;
+
+/* --offline-parallel: this process's share of the file (count 0 = whole) */
+static offline_segment_t offline_seg = { .emit_end_ns = UINT64_MAX };
 
 void parse_options(int argc, char **argv);
 
+/* ---- FFTW wisdom ---- */
+
+/* FFTW wisdom: --wisdom=FILE, else $IRIDIUM_SNIFFER_WISDOM, else this file
+ * in $HOME; "none" for either turns wisdom off */
+#define FFTW_WISDOM_FILE ".iridium-sniffer-fftw-wisdom"
+#define FFTW_WISDOM_ENV "IRIDIUM_SNIFFER_WISDOM"
+
+static char wisdom_file[512];
+static char *wisdom_at_load = NULL;     /* to skip rewriting unchanged wisdom */
+
+static const char *fftw_wisdom_path(void) {
+    if (!wisdom_file[0]) {
+        const char *path = wisdom_path ? wisdom_path : getenv(FFTW_WISDOM_ENV);
+        if (path && *path) {
+            snprintf(wisdom_file, sizeof(wisdom_file), "%s", path);
+        } else {
+            const char *home = getenv("HOME");
+            if (!home) return NULL;
+            snprintf(wisdom_file, sizeof(wisdom_file), "%s/%s", home, FFTW_WISDOM_FILE);
+        }
+    }
+    return strcmp(wisdom_file, "none") ? wisdom_file : NULL;
+}
+
+static void fftw_load_wisdom(void) {
+    const char *path = fftw_wisdom_path();
+    if (!path) return;
+    if (fftwf_import_wisdom_from_filename(path)) {
+        fprintf(stderr, "FFTW: loaded wisdom from %s\n", path);
+        wisdom_at_load = fftwf_export_wisdom_to_string();
+    } else if (verbose || plan_only) {
+        fprintf(stderr, "FFTW: no wisdom in %s, planning from scratch\n", path);
+    }
+}
+
+/* Written to a temporary file and renamed into place, so a process
+ * starting meanwhile never imports half a file */
+static int fftw_save_wisdom(void) {
+    const char *path = fftw_wisdom_path();
+    if (!path) return 0;
+
+    char *now = fftwf_export_wisdom_to_string();
+    int changed = !now || !wisdom_at_load || strcmp(now, wisdom_at_load) != 0;
+    free(wisdom_at_load);
+    wisdom_at_load = now;
+    if (!changed)
+        return 0;
+
+    char tmp[sizeof(wisdom_file) + 32];
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+    if (fftwf_export_wisdom_to_filename(tmp) && rename(tmp, path) == 0) {
+        fprintf(stderr, "FFTW: saved wisdom to %s\n", path);
+        return 0;
+    }
+    warn("FFTW: cannot save wisdom to %s", path);
+    unlink(tmp);
+    return -1;
+}
+
 /* ---- Sample buffer management ---- */
 
 void push_samples(sample_buf_t *buf) {
+    mpmc_ring_t *queue = receivers[buf->rx].queue;
     atomic_fetch_add(&stat_sample_count, buf->num);
-    if (blocking_queue_add(&samples_queue, buf) == BQ_FULL) {
+    if (mpmc_ring_try_put(queue, buf) != 0) {
         if (verbose)
             fprintf(stderr, "WARNING: dropped samples\n");
-        free(buf);
+        atomic_fetch_add(&stat_samples_dropped, 1);
+        sample_buf_free(buf);
     }
+    pstats_queue_depth(PQ_SAMPLES, mpmc_ring_size(queue));
 }
 
 /* ---- Utility ---- */
@@ -212,6 +347,35 @@ static unsigned long now_ms(void) {
     return ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL;
 }
 
+/* CPU seconds used so far by this process and its finished children */
+static double cpu_seconds(void) {
+    struct rusage self, children;
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &children);
+    return self.ru_utime.tv_sec + self.ru_stime.tv_sec
+         + children.ru_utime.tv_sec + children.ru_stime.tv_sec
+         + (self.ru_utime.tv_usec + self.ru_stime.tv_usec
+            + children.ru_utime.tv_usec + children.ru_stime.tv_usec) * 1e-6;
+}
+
+/* --stats-json: one last line with the run's totals, timed from the
+ * first sample to the last frame out, for harnesses comparing builds
+ * and configurations */
+static void print_summary(double wall, double cpu) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    unsigned long samples = atomic_load(&stat_sample_count);
+
+    fprintf(stderr, "{\"summary\":{\"wall_s\":%.3f,\"cpu_s\":%.3f,"
+            "\"max_rss_kb\":%ld,\"samples\":%lu,\"srr\":%.3f,"
+            "\"bursts_detected\":%lu,\"frames_handled\":%lu,"
+            "\"frames_ok\":%lu}}\n",
+            wall, cpu, ru.ru_maxrss, samples,
+            wall > 0 && samp_rate > 0 ? samples / samp_rate / wall : 0.0,
+            atomic_load(&stat_n_detected), atomic_load(&stat_n_handled),
+            atomic_load(&stat_n_ok_bursts));
+}
+
 /* ---- File spewer thread ---- */
 
 static inline int8_t clamp8(float v) {
@@ -220,62 +384,97 @@ static inline int8_t clamp8(float v) {
     return (int8_t)v;
 }
 
+static size_t iq_sample_bytes(void) {
+    switch (iq_format) {
+    case FMT_CI16: return 4;
+    case FMT_CF32: return 8;
+    default:       return 2;
+    }
+}
+
 static void *spewer_thread(void *arg) {
     FILE *f = (FILE *)arg;
     size_t block = 32768;  /* samples per read (each sample = I + Q) */
+    size_t bytes = iq_sample_bytes();
+    uint64_t pos = offline_seg.read_start;
+    uint64_t end = in_map ? in_map_len / bytes : UINT64_MAX;
+    if (offline_seg.count && offline_seg.read_end < end)
+        end = offline_seg.read_end;
 
-    while (running) {
+    while (running && pos < end) {
         sample_buf_t *s;
         size_t r;
+        size_t want = end - pos < block ? (size_t)(end - pos) : block;
+
+        /* Mapped input: the block is already in memory */
+        const int8_t *src = in_map ? in_map + pos * bytes : NULL;
 
         switch (iq_format) {
         case FMT_CI8:
             /* Native: 2 bytes per sample */
-            s = malloc(sizeof(*s) + block * 2);
+            if (src) {
+                s = sample_buf_alloc(0);
+                s->ext = src;
+                r = want;
+            } else {
+                s = sample_buf_alloc(block * 2);
+                r = fread(s->samples, 2, want, f);
+            }
             s->format = SAMPLE_FMT_INT8;
-            r = fread(s->samples, 2, block, f);
             break;
 
-        case FMT_CI16: {
-            /* 4 bytes per sample -> convert to int8 */
-            s = malloc(sizeof(*s) + block * 2);
-            s->format = SAMPLE_FMT_INT8;
-            int16_t *tmp = malloc(block * 4);
-            r = fread(tmp, 4, block, f);
-            for (size_t i = 0; i < r * 2; i++)
-                s->samples[i] = (int8_t)(tmp[i] >> 8);
-            free(tmp);
+        case FMT_CI16:
+            /* Native: 4 bytes per sample, no truncation to int8 */
+            if (src) {
+                s = sample_buf_alloc(0);
+                s->ext = src;
+                r = want;
+            } else {
+                s = sample_buf_alloc(block * 4);
+                r = fread(s->samples, 4, want, f);
+            }
+            s->format = SAMPLE_FMT_INT16;
             break;
-        }
 
         case FMT_CF32: {
             /* Pass float32 samples directly (no int8 quantization) */
-            s = malloc(sizeof(*s) + block * 8);
+            if (src) {
+                s = sample_buf_alloc(0);
+                s->ext = src;
+                r = want;
+            } else {
+                s = sample_buf_alloc(block * 8);
+                r = fread(s->samples, 8, want, f);
+            }
             s->format = SAMPLE_FMT_FLOAT;
-            r = fread(s->samples, 8, block, f);
             break;
         }
 
         default:
-            s = malloc(sizeof(*s));
+            s = sample_buf_alloc(0);
             s->format = SAMPLE_FMT_INT8;
             r = 0;
             break;
         }
 
         if (r == 0) {
-            free(s);
+            sample_buf_free(s);
             break;
         }
+        pos += r;
         s->num = r;
-        if (blocking_queue_put(&samples_queue, s) != 0) {
-            free(s);
+        atomic_fetch_add(&stat_sample_count, r);
+        uint64_t t0 = pstats_now();
+        if (mpmc_ring_put(&samples_queue, s) != 0) {
+            sample_buf_free(s);
             break;
         }
+        pstats_put_wait(PQ_SAMPLES, t0);
+        pstats_queue_depth(PQ_SAMPLES, mpmc_ring_size(&samples_queue));
     }
 
     /* Wait for queue to drain */
-    while (running && samples_queue.queue_size > 0)
+    while (running && mpmc_ring_size(&samples_queue) > 0)
         usleep(10000);
 
     running = 0;
@@ -283,11 +482,40 @@ static void *spewer_thread(void *arg) {
     return NULL;
 }
 
+/* ---- Burst archive replay thread ---- */
+
+static int replay_frame(downmix_frame_t *frame, void *arg) {
+    (void)arg;
+    uint64_t t0 = pstats_now();
+    if (!running || mpmc_ring_put(&frame_queue, frame) != 0) {
+        downmix_frame_free(frame);
+        return 1;
+    }
+    pstats_put_wait(PQ_FRAME, t0);
+    pstats_queue_depth(PQ_FRAME, mpmc_ring_size(&frame_queue));
+    return 0;
+}
+
+/* Feeds archived bursts straight to the demod pool in place of the
+ * spewer, detector and downmix pool */
+static void *replay_thread(void *arg) {
+    (void)arg;
+    long n = burst_archive_replay(replay_bursts_dir, replay_frame, NULL);
+    if (n < 0)
+        fprintf(stderr, "iridium-sniffer: --replay-bursts %s: %s\n",
+                replay_bursts_dir, strerror(errno));
+    else
+        fprintf(stderr, "iridium-sniffer: replayed %ld bursts\n", n);
+
+    running = 0;
+    kill(self_pid, SIGINT);
+    return NULL;
+}
+
 /* ---- IDA/GSMTAP state ---- */
 
+/* One reassembler; GSMTAP, ACARS and MT positions subscribe to it */
 static ida_context_t ida_ctx;
-static ida_context_t acars_ida_ctx;
-static ida_context_t mtpos_ida_ctx;
 
 static atomic_ulong gsmtap_sent_count = 0;
 
@@ -302,86 +530,203 @@ static void gsmtap_ida_cb(const uint8_t *data, int len,
     atomic_fetch_add(&gsmtap_sent_count, 1);
 }
 
-/* ---- Frame consumer: QPSK demod + output ---- */
+/* ACARS text goes to stdout through stdio; write out the batched lines
+ * printed before it first so the two streams stay in order */
+static void acars_out_cb(const uint8_t *data, int len,
+                         uint64_t timestamp, double frequency,
+                         ir_direction_t direction, float magnitude,
+                         void *user)
+{
+    frame_output_flush();
+    acars_ida_cb(data, len, timestamp, frequency, direction, magnitude, user);
+}
 
-static void *frame_consumer_thread(void *arg) {
-    (void)arg;
-    while (1) {
-        downmix_frame_t *frame;
-        if (blocking_queue_take(&frame_queue, &frame) != 0)
-            break;
+/* ---- Frame work: QPSK demod + stateless decode (demod pool workers) ---- */
+
+/* Classify a demodulated frame, then run only the decoders for that type
+ * that some sink needs */
+static void demod_decode(demod_job_t *job) {
+    int want_ida = parsed_mode || gsmtap_enabled || acars_enabled || web_enabled;
+    int want_ira = web_enabled || position_enabled;
+    int want_ibc = web_enabled;
+    if (!want_ida && !want_ira)
+        return;
+
+    int maybe_ibc;
+    uint64_t t0 = pstats_now();
+    frame_class_t cls = frame_classify(job->demod, &maybe_ibc);
+    pstats_stage(STAGE_CLASSIFY, t0);
+    atomic_fetch_add(&stat_frame_class[cls], 1);
+
+    if (cls == FRAME_CLASS_IDA && want_ida) {
+        t0 = pstats_now();
+        job->ida_ok = ida_decode(job->demod, &job->burst);
+        pstats_stage(STAGE_IDA, t0);
+    }
+
+    if (cls == FRAME_CLASS_IRA && want_ira) {
+        t0 = pstats_now();
+        job->decoded_ok = frame_decode_as(job->demod, FRAME_CLASS_IRA,
+                                          &job->decoded);
+        pstats_stage(STAGE_IRA, t0);
+    } else if (want_ibc && (cls == FRAME_CLASS_IBC ||
+               (cls == FRAME_CLASS_IDA && maybe_ibc && !job->ida_ok))) {
+        t0 = pstats_now();
+        job->decoded_ok = frame_decode_as(job->demod, FRAME_CLASS_IBC,
+                                          &job->decoded);
+        pstats_stage(STAGE_IBC, t0);
+    }
+}
+
+static void demod_work(demod_job_t **jobs, int n) {
+    downmix_frame_t *frames[QPSK_BATCH_MAX];
+    demod_frame_t *demods[QPSK_BATCH_MAX];
+    demod_job_t *todo[QPSK_BATCH_MAX];
+    int n_todo = 0;
+
+    for (int i = 0; i < n; i++) {
+        downmix_frame_t *frame = jobs[i]->frame;
+
+        /* Offline worker: frames in the overlap belong to a neighbour */
+        if (frame->timestamp < offline_seg.emit_start_ns ||
+            frame->timestamp >= offline_seg.emit_end_ns) {
+            jobs[i]->skip = 1;
+            continue;
+        }
 
         atomic_fetch_add(&stat_n_handled, 1);
+        todo[n_todo] = jobs[i];
+        frames[n_todo++] = frame;
+    }
+    if (n_todo == 0)
+        return;
+
+    /* --demod-batch=1 keeps the original one-frame demod */
+    uint64_t t0 = pstats_now();
+    if (demod_batch == 1) {
+        if (!qpsk_demod(frames[0], &demods[0]))
+            demods[0] = NULL;
+    } else {
+        qpsk_demod_batch(frames, n_todo, demods);
+    }
+    pstats_stage(STAGE_DEMOD, t0);
 
-        demod_frame_t *demod = NULL;
-        if (qpsk_demod(frame, &demod)) {
-            atomic_fetch_add(&stat_n_ok_bursts, 1);
-            atomic_fetch_add(&stat_n_ok_sub, 1);
-
-            /* Try IDA decode if parsed output or GSMTAP is active */
-            int ida_ok = 0;
-            ida_burst_t burst;
-            if (parsed_mode || gsmtap_enabled || acars_enabled || web_enabled)
-                ida_ok = ida_decode(demod, &burst);
-
-            /* Output: parsed IDA line if available, otherwise RAW */
-            if (parsed_mode && ida_ok)
-                frame_output_print_ida(&burst);
-            else
-                frame_output_print(demod);
-
-            if (web_enabled || position_enabled) {
-                decoded_frame_t decoded;
-                if (frame_decode(demod, &decoded)) {
-                    if (decoded.type == FRAME_IRA) {
-                        if (web_enabled)
-                            web_map_add_ra(&decoded.ira, decoded.timestamp,
-                                            decoded.frequency);
-                        if (position_enabled)
-                            doppler_pos_add_measurement(&decoded.ira,
-                                                         decoded.frequency,
-                                                         decoded.timestamp);
-                    } else if (decoded.type == FRAME_IBC) {
-                        if (web_enabled)
-                            web_map_add_sat(&decoded.ibc, decoded.timestamp);
-                    }
-                }
-            }
+    for (int i = 0; i < n_todo; i++) {
+        todo[i]->demod = demods[i];
+        if (!demods[i])
+            continue;
 
-            if (gsmtap_enabled) {
-                if (ida_ok)
-                    ida_reassemble(&ida_ctx, &burst, gsmtap_ida_cb, NULL);
-                ida_reassemble_flush(&ida_ctx, demod->timestamp);
-            }
+        atomic_fetch_add(&stat_n_ok_bursts, 1);
+        atomic_fetch_add(&stat_n_ok_sub, 1);
+        demod_decode(todo[i]);
+    }
+}
 
-            if (acars_enabled) {
-                if (ida_ok)
-                    ida_reassemble(&acars_ida_ctx, &burst,
-                                   acars_ida_cb, NULL);
-                ida_reassemble_flush(&acars_ida_ctx, demod->timestamp);
-            }
+/* ---- Cross-receiver de-duplication (output thread) ---- */
+
+/* Frames output lately. Overlapping inputs decode the same burst each;
+ * the copy that comes second has the same bits on the same channel and a
+ * timestamp within --dedup-ms (the inputs' clocks start apart). */
+#define RX_DEDUP_RING       1024
+#define RX_DEDUP_FREQ_HZ    10000.0     /* a quarter of the channel spacing */
+
+typedef struct {
+    uint64_t hash;
+    uint64_t timestamp;
+    double frequency;
+    int rx;
+} rx_seen_t;
+
+static rx_seen_t rx_seen[RX_DEDUP_RING];
+static unsigned rx_seen_next = 0;
+
+/* Whether another input already output this frame; if not, it is noted */
+static int rx_duplicate(const demod_frame_t *f) {
+    int rx = (int)(f->id / 10 % (uint64_t)n_rx);   /* see detector id_index */
+    int n_words = (f->n_bits + 63) / 64;
+    uint64_t hash = 14695981039346656037ULL ^ (uint64_t)f->n_bits;
+    for (int i = 0; i < n_words; i++) {
+        uint64_t w = f->bits[i];
+        if (i == n_words - 1 && f->n_bits % 64)
+            w &= ~0ULL << (64 - f->n_bits % 64);
+        hash = (hash ^ w) * 1099511628211ULL;
+    }
+
+    uint64_t window = (uint64_t)dedup_ms * 1000000;
+    for (int i = 0; i < RX_DEDUP_RING; i++) {
+        const rx_seen_t *e = &rx_seen[i];
+        if (e->hash == hash && e->rx != rx &&
+                (f->timestamp > e->timestamp ? f->timestamp - e->timestamp
+                                             : e->timestamp - f->timestamp) <= window &&
+                fabs(f->center_frequency - e->frequency) <= RX_DEDUP_FREQ_HZ)
+            return 1;
+    }
+
+    rx_seen[rx_seen_next++ % RX_DEDUP_RING] = (rx_seen_t){
+        .hash = hash,
+        .timestamp = f->timestamp,
+        .frequency = f->center_frequency,
+        .rx = rx,
+    };
+    return 0;
+}
+
+/* ---- Frame output: printing and stateful consumers (sequencer, in order) ---- */
+
+static void frame_output(demod_job_t *job) {
+    downmix_frame_t *frame = job->frame;
+    demod_frame_t *demod = job->demod;
+
+    if (demod && n_rx > 1 && dedup_ms > 0 && rx_duplicate(demod)) {
+        atomic_fetch_add(&stat_rx_duplicates, 1);
+        demod_frame_free(demod);
+    } else if (demod) {
+        /* Output: parsed IDA line if available, otherwise RAW */
+        if (parsed_mode && job->ida_ok)
+            frame_output_print_ida(&job->burst);
+        else
+            frame_output_print(demod);
+
+        /* Frame timestamps are wall clock only for live capture */
+        if (live) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            uint64_t now = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+            if (now > demod->timestamp)
+                pstats_latency(now - demod->timestamp);
+        }
 
-            if (web_enabled) {
-                if (ida_ok)
-                    ida_reassemble(&mtpos_ida_ctx, &burst,
-                                   mtpos_ida_cb, NULL);
-                ida_reassemble_flush(&mtpos_ida_ctx, demod->timestamp);
+        if (job->decoded_ok) {
+            decoded_frame_t *decoded = &job->decoded;
+            if (decoded->type == FRAME_IRA) {
+                if (web_enabled)
+                    web_map_add_ra(&decoded->ira, decoded->timestamp,
+                                    decoded->frequency);
+                if (position_enabled)
+                    doppler_pos_add_measurement(&decoded->ira,
+                                                 decoded->frequency,
+                                                 decoded->timestamp);
+            } else if (decoded->type == FRAME_IBC) {
+                if (web_enabled)
+                    web_map_add_sat(&decoded->ibc, decoded->timestamp);
             }
+        }
 
-            free(demod->bits);
-            free(demod->llr);
-            free(demod);
-        } else if (verbose) {
-            fprintf(stderr, "demod: UW check failed id=%lu freq=%.0f Hz dir=%s\n",
-                    (unsigned long)frame->id, frame->center_frequency,
-                    frame->direction == DIR_DOWNLINK ? "DL" :
-                    frame->direction == DIR_UPLINK ? "UL" : "??");
+        if (ida_ctx.n_sinks) {
+            if (job->ida_ok)
+                ida_reassemble(&ida_ctx, &job->burst);
+            ida_reassemble_flush(&ida_ctx, demod->timestamp);
         }
 
-        free(frame->samples);
-        free(frame);
+        demod_frame_free(demod);
+    } else if (!job->skip && verbose) {
+        fprintf(stderr, "demod: UW check failed id=%lu freq=%.0f Hz dir=%s\n",
+                (unsigned long)frame->id, frame->center_frequency,
+                frame->direction == DIR_DOWNLINK ? "DL" :
+                frame->direction == DIR_UPLINK ? "UL" : "??");
     }
-    return NULL;
+
+    downmix_frame_free(frame);
 }
 
 /* ---- Stats thread (gr-iridium/iridium-extractor compatible format) ---- */
@@ -400,6 +745,7 @@ static void *stats_thread_fn(void *arg) {
     unsigned long prev_det = 0, prev_ok = 0, prev_sub = 0;
     unsigned long prev_handled = 0, prev_samples = 0;
     unsigned q_max = 0;
+    int json_started = 0;
 
     while (running) {
         usleep(1000000);
@@ -417,6 +763,10 @@ static void *stats_thread_fn(void *arg) {
         unsigned long sub     = atomic_load(&stat_n_ok_sub);
         unsigned long dropped = atomic_load(&stat_n_dropped);
         unsigned long samp    = atomic_load(&stat_sample_count);
+        unsigned long samples_dropped = atomic_load(&stat_samples_dropped);
+        unsigned pool_used, pool_cap;
+        unsigned long pool_miss;
+        sample_pool_stats(&pool_used, &pool_cap, &pool_miss);
 
         /* Per-interval deltas */
         unsigned long dd    = det     - prev_det;
@@ -425,8 +775,10 @@ static void *stats_thread_fn(void *arg) {
         unsigned long dh    = handled - prev_handled;
         unsigned long dsamp = samp    - prev_samples;
 
-        /* Track max queue depth */
-        unsigned qsz = (unsigned)samples_queue.queue_size;
+        /* Track max queue depth (all inputs' sample queues) */
+        unsigned qsz = 0;
+        for (int k = 0; k < (n_rx > 1 ? n_rx : 1); k++)
+            qsz += mpmc_ring_size(receivers[k].queue);
         if (qsz > q_max) q_max = qsz;
 
         /* Rates */
@@ -478,6 +830,18 @@ static void *stats_thread_fn(void *arg) {
             }
 
             fprintf(stderr, "\n");
+        } else if (stats_json) {
+            /* One JSON object per interval: counters, stage timings,
+             * queue waits and latency since the previous line */
+            static pstats_snapshot_t snap[2];
+            static char json[16384];
+            static int cur = 0;
+            pstats_snapshot(&snap[cur]);
+            pstats_format_json(json, sizeof(json), &snap[cur],
+                               json_started ? &snap[cur ^ 1] : NULL);
+            fprintf(stderr, "%s\n", json);
+            json_started = 1;
+            cur ^= 1;
         } else {
             /* Print in gr-iridium format */
             fprintf(stderr, "%ld", (long)time(NULL));
@@ -497,13 +861,23 @@ static void *stats_thread_fn(void *arg) {
             fprintf(stderr, " | ok: %10lu", sub);
             fprintf(stderr, " | ok_avg: %3.0f/s", ok_rate_avg);
             fprintf(stderr, " | d: %lu", dropped);
+            if (live)
+                fprintf(stderr, " | shed: %lu/%lu", atomic_load(&stat_shed_simplex),
+                        atomic_load(&stat_shed_duplex));
+            if (n_rx > 1)
+                fprintf(stderr, " | dup: %lu", atomic_load(&stat_rx_duplicates));
+            fprintf(stderr, " | pool: %u/%u", pool_used, pool_cap);
+            if (pool_miss || samples_dropped)
+                fprintf(stderr, " (miss %lu, sd %lu)", pool_miss, samples_dropped);
+            if (downmix_workers_auto && !replay_bursts_dir && !burst_out)
+                fprintf(stderr, " | w: %d", downmix_pool_active());
             fprintf(stderr, "\n");
         }
 
         /* Suppress unused variable warning */
         (void)dsamp;
 
-        /* Doppler positioning: attempt solve every 10 seconds */
+        /* Doppler positioning: report the latest solution every 10 seconds */
         if (position_enabled && (int)elapsed % 10 == 0 && elapsed > 5) {
             doppler_solution_t sol;
             if (doppler_pos_solve(&sol)) {
@@ -536,25 +910,187 @@ static void sig_handler(int signo) {
     running = 0;
 }
 
-/* ---- Main ---- */
+/* ---- Startup planning ---- */
 
-int main(int argc, char **argv) {
-    pthread_t detector, spewer, stats;
+static void detector_config(burst_config_t *c) {
+    *c = (burst_config_t){
+        .center_frequency = center_freq,
+        .sample_rate = (int)samp_rate,
+        .fft_size = 0,
+        .overlap = detector_overlap,
+        .burst_pre_len = 0,
+        .burst_post_len = 0,
+        .trim_bursts = trim_bursts,
+        .trim_margin = (int)(trim_margin_ms * samp_rate / 1000),
+        .burst_width = IR_DEFAULT_BURST_WIDTH,
+        .max_bursts = 0,
+        .max_burst_len = 0,
+        .threshold = (float)threshold_db,
+        .history_size = IR_DEFAULT_HISTORY_SIZE,
+        .noise_floor = noise_floor,
+        .use_gpu = use_gpu,
+        .band_plan = band_plan,
+        .id_index = offline_seg.index,
+        .id_count = offline_seg.count,
+    };
+}
+
+static void report_noise_floor(size_t bytes) {
+    static const char *names[] = { "full", "block", "ema" };
+    fprintf(stderr, "iridium-sniffer: noise floor %s, %.1f MiB\n",
+            names[noise_floor], bytes / (1024.0 * 1024.0));
+}
+
+/* --plan-only: create the detectors and downmix workers this command line
+ * would run, which plans every transform they use, and save the wisdom.
+ * Nothing is torn down; the process exits right after. */
+static int plan_fftw(void) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    burst_config_t config;
+    detector_config(&config);
+    config.use_gpu = 0;     /* the CPU FFT is planned either way */
+
+    downmix_config_t dm_config = {
+        .batch_size = downmix_batch,
+        .sync_corr = sync_corr,
+        .fine_cfo = fine_cfo,
+        .input_fir = input_fir,
+    };
+    downmix_pool_init(downmix_workers, downmix_workers_auto, &dm_config);
+    if (channelize) {
+        if (!channelizer_create(channelize, &config))
+            errx(1, "Cannot split %.0f Hz into %d sub-bands",
+                 samp_rate, channelize);
+    } else {
+        burst_detector_create(&config);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    fprintf(stderr, "FFTW: planned %d transforms for %.0f Hz in %.1f s\n",
+            fftw_plans_created(), samp_rate,
+            (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9);
+
+    if (!fftw_wisdom_path())
+        warnx("--plan-only with wisdom disabled saves nothing");
+    return fftw_save_wisdom() == 0 ? 0 : 1;
+}
+
+/* ---- Receivers ---- */
+
+/* Open input rx's device, tuned to its frequency, and start streaming */
+static void receiver_start(int rx) {
+    static const char *thread_names[] = {
+        [RX_HACKRF] = "hackrf", [RX_BLADERF] = "bladerf", [RX_USRP] = "usrp",
+        [RX_SOAPY] = "soapy", [RX_NET] = "net_input",
+    };
+    const rx_spec_t *spec = &rx_specs[rx];
+    receiver_t *r = &receivers[rx];
+
+    r->stream.rx = rx;
+    switch (spec->kind) {
+    case RX_NET:
+        r->stream.dev = net_input_create(spec->arg, rx);
+        net_input_open(r->stream.dev);
+        pthread_create(&r->thread, NULL, net_input_thread, r->stream.dev);
+        r->has_thread = 1;
+        break;
+#ifdef HAVE_BLADERF
+    case RX_BLADERF:
+        r->stream.dev = bladerf_setup(spec->num, spec->center_freq);
+        pthread_create(&r->thread, NULL, bladerf_stream_thread, &r->stream);
+        r->has_thread = 1;
+        break;
+#endif
+#ifdef HAVE_UHD
+    case RX_USRP:
+        r->stream.dev = usrp_setup(spec->arg, spec->center_freq);
+        pthread_create(&r->thread, NULL, usrp_stream_thread, &r->stream);
+        r->has_thread = 1;
+        break;
+#endif
+#ifdef HAVE_SOAPYSDR
+    case RX_SOAPY:
+        r->stream.dev = soapy_setup(spec->num, spec->arg, spec->center_freq, rx);
+        pthread_create(&r->thread, NULL, soapy_stream_thread, r->stream.dev);
+        r->has_thread = 1;
+        break;
+#endif
 #ifdef HAVE_HACKRF
-    hackrf_device *hackrf = NULL;
+    case RX_HACKRF:
+        r->stream.dev = hackrf_setup(spec->arg, spec->center_freq);
+        hackrf_start_rx(r->stream.dev, hackrf_rx_cb, (void *)(intptr_t)rx);
+        break;
+#endif
+    default:
+        errx(1, "Input %d: SDR support not built in", rx);
+    }
+    if (r->has_thread)
+        placement_pin(r->thread, PLACE_INPUT, rx);
+#ifdef __linux__
+    if (r->has_thread)
+        pthread_setname_np(r->thread, thread_names[spec->kind]);
+#else
+    (void)thread_names;
+#endif
+}
+
+/* Stop input rx's stream and close its device */
+static void receiver_stop(int rx) {
+    receiver_t *r = &receivers[rx];
+
+    switch (rx_specs[rx].kind) {
+    case RX_NET:
+        pthread_join(r->thread, NULL);
+        net_input_close(r->stream.dev);
+        break;
+#ifdef HAVE_HACKRF
+    case RX_HACKRF:
+        hackrf_stop_rx(r->stream.dev);
+        hackrf_close(r->stream.dev);
+        break;
 #endif
 #ifdef HAVE_BLADERF
-    struct bladerf *bladerf_dev = NULL;
-    pthread_t bladerf_thread;
+    case RX_BLADERF:
+        bladerf_enable_module(r->stream.dev, BLADERF_MODULE_RX, false);
+        pthread_join(r->thread, NULL);
+        bladerf_close(r->stream.dev);
+        break;
 #endif
 #ifdef HAVE_UHD
-    uhd_usrp_handle usrp = NULL;
-    pthread_t usrp_thread;
+    case RX_USRP:
+        pthread_join(r->thread, NULL);
+        usrp_close(r->stream.dev);
+        break;
 #endif
 #ifdef HAVE_SOAPYSDR
-    SoapySDRDevice *soapy = NULL;
-    pthread_t soapy_thread;
+    case RX_SOAPY:
+        pthread_join(r->thread, NULL);
+        soapy_close(r->stream.dev);
+        break;
 #endif
+    default:
+        break;
+    }
+}
+
+/* Whether every HackRF is still streaming (they stop on their own when
+ * one is unplugged, with no thread of ours to notice) */
+static int receivers_streaming(void) {
+#ifdef HAVE_HACKRF
+    for (int k = 0; k < n_rx; k++)
+        if (rx_specs[k].kind == RX_HACKRF &&
+                !hackrf_is_streaming(receivers[k].stream.dev))
+            return 0;
+#endif
+    return 1;
+}
+
+/* ---- Main ---- */
+
+int main(int argc, char **argv) {
+    pthread_t spewer, stats, burst_sender;
 
     signal(SIGINT, sig_handler);
     signal(SIGTERM, sig_handler);
@@ -562,12 +1098,29 @@ int main(int argc, char **argv) {
     self_pid = getpid();
 
     parse_options(argc, argv);
-
-    /* Initialize SIMD dispatch (must be before any DSP) */
-    simd_init(no_simd);
+    int n_receivers = n_rx > 1 ? n_rx : 1;
 
     fprintf(stderr, "iridium-sniffer: center_freq=%.0f Hz, sample_rate=%.0f Hz, threshold=%.1f dB\n",
             center_freq, samp_rate, threshold_db);
+    for (int k = 1; k < n_rx; k++)
+        fprintf(stderr, "iridium-sniffer: input %d center_freq=%.0f Hz\n",
+                k, rx_specs[k].center_freq);
+
+    /* Split offline replay across processes; only workers return */
+    if (offline_parallel > 1) {
+        offline_parallel_fork(offline_parallel, in_file, (int)iq_sample_bytes(),
+                              samp_rate, &offline_seg);
+        self_pid = getpid();
+    }
+
+    if (use_mmap && in_file) {
+        in_map = offline_map_file(in_file, &in_map_len);
+        if (!in_map)
+            errx(1, "Cannot map input file");
+    }
+
+    /* Initialize SIMD dispatch (must be before any DSP) */
+    simd_init((simd_impl_t)simd_impl);
 
     if (diagnostic_mode) {
         fprintf(stderr, "\nDiagnostic Mode - Setup Verification (RAW output suppressed)\n");
@@ -577,7 +1130,12 @@ int main(int argc, char **argv) {
 
     fftw_lock_init();
     fftw_load_wisdom();
+    if (plan_only)
+        return plan_fftw();
+
     frame_output_init(file_info);
+    if (offline_seg.count)
+        frame_output_set_epoch(offline_seg.epoch_ns);
 
 #ifdef HAVE_ZMQ
     if (zmq_enabled) {
@@ -587,12 +1145,70 @@ int main(int argc, char **argv) {
         fprintf(stderr, "ZMQ: publishing on %s\n", ep);
     }
 #endif
+    if (shm_name) {
+        if (frame_output_shm_init(shm_name, (size_t)shm_mb << 20) != 0)
+            err(1, "Failed to create shared-memory ring %s", shm_name);
+        if (verbose)
+            fprintf(stderr, "shm: writing to /dev/shm/%s (%d MB)\n",
+                    shm_name[0] == '/' ? shm_name + 1 : shm_name, shm_mb);
+    }
+    frame_output_start(output_flush_ms);
 
-    if (web_enabled || gsmtap_enabled || position_enabled)
+    /* Pipeline counters for --stats-json and /metrics */
+    pstats_add_counter("samples", "IQ samples received", &stat_sample_count);
+    pstats_add_counter("bursts_detected", "Bursts tagged by the detector", &stat_n_detected);
+    pstats_add_counter("bursts_dropped", "Bursts lost to a full burst queue", &stat_n_dropped);
+    if (live) {
+        pstats_add_counter("bursts_shed_simplex", "Simplex-band bursts shed by a full burst queue",
+                           &stat_shed_simplex);
+        pstats_add_counter("bursts_shed_duplex", "Duplex-band bursts shed by a full burst queue",
+                           &stat_shed_duplex);
+        pstats_add_counter("ring_moves", "Detector rings copied away from a stalled downmix pool",
+                           &stat_ring_moves);
+    }
+    if (band_plan)
+        band_plan_add_counters(band_plan);
+    pstats_add_counter("frames_dropped", "Frames lost to a full frame queue",
+                       &stat_frames_dropped);
+    pstats_add_counter("frames_handled", "Frames run through the demodulator", &stat_n_handled);
+    pstats_add_counter("frame_pool_blocks", "Frame pool blocks created",
+                       &frame_pool_stats.blocks);
+    pstats_add_counter("frame_pool_bytes", "Bytes held by frame pool blocks",
+                       &frame_pool_stats.bytes);
+    pstats_add_counter("frame_pool_peak", "Most frame pool blocks in use at once",
+                       &frame_pool_stats.peak);
+    pstats_add_counter("frame_pool_misses", "Frame allocations too large for the pool",
+                       &frame_pool_stats.misses);
+    pstats_add_counter("frames_ok", "Frames that passed the unique word check", &stat_n_ok_bursts);
+    pstats_add_counter("sample_blocks_dropped", "Sample blocks lost to a full samples queue",
+                       &stat_samples_dropped);
+    pstats_add_counter("burst_bytes", "IQ bytes in burst views passed to downmix",
+                       &stat_burst_bytes);
+    pstats_add_counter("burst_bytes_untrimmed", "IQ bytes the burst views would hold without trimming",
+                       &stat_burst_bytes_untrimmed);
+    pstats_add_counter("narrowband_bytes", "IQ bytes in bursts after narrowband extraction",
+                       &stat_narrowband_bytes);
+    pstats_add_counter("sync_direct", "Sync words found by direct correlation",
+                       &stat_sync_direct);
+    pstats_add_counter("sync_fft", "Sync words found by FFT correlation",
+                       &stat_sync_fft);
+
+    /* The classifier uses both decoders' tables */
+    if (parsed_mode || gsmtap_enabled || acars_enabled || web_enabled ||
+        position_enabled) {
         frame_decode_init();
-
-    if (parsed_mode || gsmtap_enabled || acars_enabled || web_enabled)
         ida_decode_init();
+        pstats_add_counter("frames_ira", "Frames classified as IRA",
+                           &stat_frame_class[FRAME_CLASS_IRA]);
+        pstats_add_counter("frames_ibc", "Frames classified as IBC",
+                           &stat_frame_class[FRAME_CLASS_IBC]);
+        pstats_add_counter("frames_ida", "Frames classified as IDA",
+                           &stat_frame_class[FRAME_CLASS_IDA]);
+        pstats_add_counter("frames_voc", "Frames classified as voice",
+                           &stat_frame_class[FRAME_CLASS_VOC]);
+        pstats_add_counter("frames_other", "Frames of no decodable type",
+                           &stat_frame_class[FRAME_CLASS_OTHER]);
+    }
 
     if (position_enabled) {
         doppler_pos_init();
@@ -600,6 +1216,8 @@ int main(int argc, char **argv) {
          * a value.  Required to prevent solver diverging to extreme altitude
          * when satellite geometry is poor. */
         doppler_pos_set_height(position_height);
+        if (doppler_pos_start() != 0)
+            errx(1, "Failed to start positioning thread");
         fprintf(stderr, "Doppler positioning: enabled (height aiding: %.0f m)\n",
                 position_height);
     }
@@ -633,169 +1251,343 @@ int main(int argc, char **argv) {
         fprintf(stderr, ")\n");
     }
 
-    blocking_queue_init(&samples_queue, SAMPLES_QUEUE_SIZE);
-    blocking_queue_init(&burst_queue, BURST_QUEUE_SIZE);
-    blocking_queue_init(&frame_queue, FRAME_QUEUE_SIZE);
+    int have_net_input = 0;
+    for (int k = 0; k < n_rx; k++)
+        have_net_input |= rx_specs[k].kind == RX_NET;
+    if (have_net_input) {
+        pstats_add_counter("net_in_packets", "IQ packets received from the network input",
+                           &stat_net_in_packets);
+        pstats_add_counter("net_in_lost", "IQ packets lost in transit, filled with zeros",
+                           &stat_net_in_lost);
+        pstats_add_counter("net_in_late", "IQ packets dropped as late, duplicate or malformed",
+                           &stat_net_in_late);
+    }
+    if (n_rx > 1)
+        pstats_add_counter("rx_duplicates", "Frames dropped as decoded by another input",
+                           &stat_rx_duplicates);
+
+    /* Bursts are archived by a writer thread; parallel offline workers
+     * each write their own segments */
+    if (save_bursts_dir) {
+        char prefix[32] = "bursts";
+        if (offline_seg.count)
+            snprintf(prefix, sizeof(prefix), "bursts-w%d", offline_seg.index);
+        if (burst_archive_open(save_bursts_dir, prefix,
+                               (uint64_t)burst_segment_mb << 20, burst_segments) != 0)
+            err(1, "--save-bursts %s", save_bursts_dir);
+        pstats_add_counter("archive_bursts", "Bursts written to the burst archive",
+                           &stat_archive_bursts);
+        pstats_add_counter("archive_dropped", "Bursts dropped by a full or failed burst archive",
+                           &stat_archive_dropped);
+    }
+
+    /* Split pipeline: bursts leave for a central process or arrive from
+     * edge processes */
+    if (burst_out || burst_in) {
+        pstats_add_counter("burst_net_bursts", burst_out ?
+                           "Bursts sent to the central process" :
+                           "Bursts received from edge processes",
+                           &stat_burst_net_bursts);
+        pstats_add_counter("burst_net_bytes", "Burst record bytes sent or received",
+                           &stat_burst_net_bytes);
+    }
+    if (burst_out) {
+        burst_net_out_init(burst_out, !live);
+        pstats_add_counter("burst_net_dropped", "Bursts dropped while the central process was unreachable",
+                           &stat_burst_net_dropped);
+    }
+    if (burst_in)
+        burst_net_in_open(burst_in);
+
+    /* GSMTAP and ACARS sockets are served by their own thread */
+    if (gsmtap_enabled || acars_enabled) {
+        net_output_start();
+        pstats_add_counter("net_sent", "Messages sent to GSMTAP, ACARS and feed sinks",
+                           &stat_net_sent);
+        pstats_add_counter("net_dropped", "Messages dropped by a full or failing network sink",
+                           &stat_net_dropped);
+    }
+
+    /* Complete IDA messages are assembled once and handed to each
+     * consumer in turn */
+    if (gsmtap_enabled || acars_enabled || web_enabled) {
+        if (ida_context_init(&ida_ctx, ida_slots) != 0)
+            errx(1, "Cannot allocate %d IDA reassembly slots", ida_slots);
+        if (gsmtap_enabled)
+            ida_add_sink(&ida_ctx, gsmtap_ida_cb, NULL);
+        if (acars_enabled)
+            ida_add_sink(&ida_ctx, acars_out_cb, NULL);
+        if (web_enabled)
+            ida_add_sink(&ida_ctx, mtpos_ida_cb, NULL);
+        pstats_add_counter("ida_messages", "IDA messages reassembled",
+                           &ida_ctx.stat_messages);
+        pstats_add_counter("ida_evicted", "IDA messages in progress dropped for lack of slots",
+                           &ida_ctx.stat_evicted);
+        pstats_add_counter("ida_expired", "IDA messages in progress that timed out",
+                           &ida_ctx.stat_expired);
+        pstats_add_counter("ida_slots_peak", "Most IDA reassembly slots in use at once",
+                           &ida_ctx.stat_peak);
+    }
+
+    for (int k = 0; k < n_receivers; k++) {
+        if (k > 0)
+            receivers[k].queue = &rx_queues[k - 1];
+        if (mpmc_ring_init(receivers[k].queue, SAMPLES_QUEUE_SIZE) != 0)
+            errx(1, "Cannot allocate sample queue");
+    }
+    sample_pool_init(n_receivers * SAMPLES_QUEUE_SIZE + SAMPLE_POOL_SLACK);
+    /* Live capture sheds the least valuable bursts when the downmix
+     * falls behind; file input waits for it */
+    if (n_shed_order == 0)
+        n_shed_order = burst_sched_parse_order(SHED_ORDER_DEFAULT, shed_order);
+    burst_queue = burst_sched_create(BURST_QUEUE_SIZE,
+                                     (size_t)burst_queue_mb << 20, live,
+                                     shed_order, n_shed_order);
+    if (mpmc_ring_init(&frame_queue, FRAME_QUEUE_SIZE) != 0)
+        errx(1, "Cannot allocate frame queue");
 
     /* Create burst detector and all downmix workers here in the main thread,
      * before the SDR starts. FFTW_MEASURE plan creation can take several
      * seconds without wisdom; doing it here ensures the detector is fully
      * initialized before any samples arrive, preventing startup queue saturation. */
-    burst_config_t det_config = {
-        .center_frequency = center_freq,
-        .sample_rate = (int)samp_rate,
-        .fft_size = 0,
-        .burst_pre_len = 0,
-        .burst_post_len = 0,
-        .burst_width = IR_DEFAULT_BURST_WIDTH,
-        .max_bursts = 0,
-        .max_burst_len = 0,
-        .threshold = (float)threshold_db,
-        .history_size = IR_DEFAULT_HISTORY_SIZE,
+    burst_config_t det_config;
+    detector_config(&det_config);
+    burst_extract_init(narrowband_rate);
+    downmix_config_t dm_config = {
+        .batch_size = downmix_batch,
         .use_gpu = use_gpu,
+        .sync_corr = sync_corr,
+        .fine_cfo = fine_cfo,
+        .input_fir = input_fir,
     };
-    burst_detector_t *det = burst_detector_create(&det_config);
-    global_detector = det;
-
-    burst_downmix_t *dm[NUM_DOWNMIX_WORKERS];
-    for (int i = 0; i < NUM_DOWNMIX_WORKERS; i++) {
-        downmix_config_t dm_config = { 0 };
-        dm[i] = burst_downmix_create(&dm_config);
-    }
-
-    /* Launch burst detector thread */
-    pthread_create(&detector, NULL, burst_detector_thread, det);
+    placement_set_huge_pages(huge_pages);
+    if (pin_workers && !placement_active())
+        placement_parse("auto");
+    placement_resolve(channelize ? 1 + channelize : n_receivers);
+    if (!replay_bursts_dir && !burst_out)
+        downmix_pool_init(downmix_workers, downmix_workers_auto, &dm_config);
+    /* Replay has only the demodulation left to do: a worker per core */
+    if (replay_bursts_dir && demod_workers == 0)
+        demod_workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    /* An edge demodulates nothing */
+    if (burst_out)
+        demod_workers = 1;
+    demod_pool_init(demod_workers, demod_batch, demod_work, frame_output);
+
+    if (replay_bursts_dir) {
+        /* Archived bursts are already detected and downmixed */
+    } else if (burst_in) {
+        /* Edges detect; their bursts arrive on the burst queue */
+    } else if (channelize) {
+        placement_prefer_node(placement_node(PLACE_DETECTOR, 0));
+        channelizer_t *ch = channelizer_create(channelize, &det_config);
+        placement_prefer_node(-1);
+        if (!ch)
+            errx(1, "Cannot split %.0f Hz into %d sub-bands",
+                 samp_rate, channelize);
+        /* Diagnostics follow the sub-band just above the center */
+        global_detector = channelizer_detector(ch, channelize / 2);
+        size_t floor_bytes = 0;
+        for (int k = 0; k < channelize; k++)
+            floor_bytes += burst_detector_noise_floor_bytes(
+                channelizer_detector(ch, k));
+        report_noise_floor(floor_bytes);
+        if (offline_seg.count)
+            channelizer_set_start_time(ch, offline_seg.start_time_ns);
+
+        /* Launch channelizer (dispatcher + one detector thread per sub-band) */
+        pthread_create(&receivers[0].detector, NULL, channelizer_thread, ch);
 #ifdef __linux__
-    pthread_setname_np(detector, "detector");
+        pthread_setname_np(receivers[0].detector, "channelizer");
 #endif
-
-    /* Launch downmix worker pool */
-    pthread_t downmix_workers[NUM_DOWNMIX_WORKERS];
-    for (int i = 0; i < NUM_DOWNMIX_WORKERS; i++) {
-        pthread_create(&downmix_workers[i], NULL, burst_downmix_thread, dm[i]);
+    } else {
+        /* One detector per input, each tuned to its input's frequency and
+         * drawing burst IDs from its own slot of a shared space */
+        size_t floor_bytes = 0;
+        for (int k = 0; k < n_receivers; k++) {
+            receiver_t *r = &receivers[k];
+            if (n_rx > 0)
+                det_config.center_frequency = rx_specs[k].center_freq;
+            if (n_rx > 1) {
+                det_config.id_index = k;
+                det_config.id_count = n_rx;
+            }
+            placement_prefer_node(placement_node(PLACE_DETECTOR, k));
+            r->det = burst_detector_create(&det_config);
+            placement_prefer_node(-1);
+            burst_detector_set_input(r->det, r->queue);
+            floor_bytes += burst_detector_noise_floor_bytes(r->det);
+            if (offline_seg.count)
+                burst_detector_set_start_time(r->det, offline_seg.start_time_ns);
+
+            /* Launch burst detector thread */
+            pthread_create(&r->detector, NULL, burst_detector_thread, r->det);
+            placement_pin(r->detector, PLACE_DETECTOR, k);
 #ifdef __linux__
-        char name[16];
-        snprintf(name, sizeof(name), "downmix-%d", i);
-        pthread_setname_np(downmix_workers[i], name);
+            char name[16];
+            snprintf(name, sizeof(name), k ? "detector%d" : "detector", k);
+            pthread_setname_np(r->detector, name);
 #endif
+        }
+        global_detector = receivers[0].det;
+        report_noise_floor(floor_bytes);
     }
 
-    /* Launch frame consumer (QPSK demod + output) */
-    pthread_t frame_consumer;
-    pthread_create(&frame_consumer, NULL, frame_consumer_thread, NULL);
+    /* Everything is planned now: keep the wisdom even if this run is
+     * killed rather than shut down (offline workers: the first one) */
+    if (offline_seg.index == 0)
+        fftw_save_wisdom();
+
+    /* Launch downmix worker pool, or on an edge the sender in its place */
+    if (burst_out) {
+        pthread_create(&burst_sender, NULL, burst_net_out_thread, NULL);
+        placement_pin(burst_sender, PLACE_WORKERS, 0);
 #ifdef __linux__
-    pthread_setname_np(frame_consumer, "demod");
+        pthread_setname_np(burst_sender, "burst-out");
 #endif
+    } else if (!replay_bursts_dir) {
+        downmix_pool_start();
+    }
+
+    /* Launch demod workers and the in-order output sequencer */
+    demod_pool_start();
 
-    /* Launch stats thread */
-    pthread_create(&stats, NULL, stats_thread_fn, NULL);
+    /* Launch stats thread (offline workers: the first one reports) */
+    if (offline_seg.index == 0) {
+        pthread_create(&stats, NULL, stats_thread_fn, NULL);
 #ifdef __linux__
-    pthread_setname_np(stats, "stats");
+        pthread_setname_np(stats, "stats");
 #endif
+    }
 
+    unsigned long t_start = now_ms();
+    double cpu_start = cpu_seconds();
     if (live) {
-        int sdr_started = 0;
-#ifdef HAVE_BLADERF
-        if (!sdr_started && bladerf_num >= 0) {
-            bladerf_dev = bladerf_setup(bladerf_num);
-            pthread_create(&bladerf_thread, NULL, bladerf_stream_thread, bladerf_dev);
-            sdr_started = 1;
-        }
-#endif
-#ifdef HAVE_UHD
-        if (!sdr_started && usrp_serial != NULL) {
-            usrp = usrp_setup(usrp_serial);
-            pthread_create(&usrp_thread, NULL, usrp_stream_thread, (void *)usrp);
-            sdr_started = 1;
-        }
-#endif
-#ifdef HAVE_SOAPYSDR
-        if (!sdr_started && (soapy_num >= 0 || soapy_args)) {
-            soapy = soapy_setup(soapy_num, soapy_args);
-            pthread_create(&soapy_thread, NULL, soapy_stream_thread, (void *)soapy);
-            sdr_started = 1;
-        }
-#endif
-#ifdef HAVE_HACKRF
-        if (!sdr_started && serial != NULL) {
-            hackrf = hackrf_setup();
-            hackrf_start_rx(hackrf, hackrf_rx_cb, NULL);
-            sdr_started = 1;
-        }
-#endif
-        if (!sdr_started)
+        if (n_rx == 0)
             errx(1, "No SDR selected. Use -i to specify a device "
                  "(run --list to see available devices)");
+        for (int k = 0; k < n_rx; k++)
+            receiver_start(k);
     } else if (in_file != NULL) {
         pthread_create(&spewer, NULL, spewer_thread, in_file);
+        placement_pin(spewer, PLACE_INPUT, 0);
 #ifdef __linux__
         pthread_setname_np(spewer, "spewer");
+#endif
+    } else if (replay_bursts_dir) {
+        pthread_create(&spewer, NULL, replay_thread, NULL);
+        placement_pin(spewer, PLACE_INPUT, 0);
+#ifdef __linux__
+        pthread_setname_np(spewer, "replay");
+#endif
+    } else if (burst_in) {
+        pthread_create(&spewer, NULL, burst_net_in_thread, NULL);
+        placement_pin(spewer, PLACE_INPUT, 0);
+#ifdef __linux__
+        pthread_setname_np(spewer, "burst-in");
 #endif
     }
 
     /* Wait for signal */
     while (running) {
-#ifdef HAVE_HACKRF
-        if (live && hackrf != NULL && !hackrf_is_streaming(hackrf))
+        if (live && !receivers_streaming())
             break;
-#endif
         pause();
     }
     running = 0;
 
     /* Shutdown SDR */
     if (live) {
+        for (int k = 0; k < n_rx; k++)
+            receiver_stop(k);
 #ifdef HAVE_HACKRF
-        if (hackrf != NULL) {
-            hackrf_stop_rx(hackrf);
-            hackrf_close(hackrf);
-            hackrf_exit();
-        }
-#endif
-#ifdef HAVE_BLADERF
-        if (bladerf_dev != NULL) {
-            bladerf_enable_module(bladerf_dev, BLADERF_MODULE_RX, false);
-            pthread_join(bladerf_thread, NULL);
-            bladerf_close(bladerf_dev);
-        }
-#endif
-#ifdef HAVE_UHD
-        if (usrp != NULL) {
-            pthread_join(usrp_thread, NULL);
-            usrp_close(usrp);
-        }
-#endif
-#ifdef HAVE_SOAPYSDR
-        if (soapy != NULL) {
-            pthread_join(soapy_thread, NULL);
-            soapy_close(soapy);
-        }
+        for (int k = 0; k < n_rx; k++)
+            if (rx_specs[k].kind == RX_HACKRF) {
+                hackrf_exit();
+                break;
+            }
 #endif
     }
 
     /* Drain queues and join threads in pipeline order */
-    blocking_queue_close(&samples_queue);
+    for (int k = 0; k < n_receivers; k++)
+        mpmc_ring_close(receivers[k].queue);
     if (!live && in_file != NULL)
         pthread_join(spewer, NULL);
-    pthread_join(detector, NULL);
+    if (burst_in) {
+        pthread_join(spewer, NULL);
+    } else if (!replay_bursts_dir) {
+        for (int k = 0; k < n_receivers; k++)
+            pthread_join(receivers[k].detector, NULL);
+    }
+    offline_unmap_file(in_map, in_map_len);
 
     /* Wait for burst_queue to drain before closing */
-    while (burst_queue.queue_size > 0)
+    while (burst_sched_depth(burst_queue) > 0)
         usleep(10000);
-    blocking_queue_close(&burst_queue);
-    for (int i = 0; i < NUM_DOWNMIX_WORKERS; i++)
-        pthread_join(downmix_workers[i], NULL);
+    burst_sched_close(burst_queue);
+    if (burst_out) {
+        pthread_join(burst_sender, NULL);
+        burst_net_out_close();
+    } else if (!replay_bursts_dir) {
+        downmix_pool_join();
+    }
+    if (burst_in)
+        burst_net_in_close();
 
     /* Wait for frame_queue to drain before closing */
-    while (frame_queue.queue_size > 0)
+    while (mpmc_ring_size(&frame_queue) > 0)
         usleep(10000);
-    blocking_queue_close(&frame_queue);
-    pthread_join(frame_consumer, NULL);
-    pthread_join(stats, NULL);
+    mpmc_ring_close(&frame_queue);
+    if (replay_bursts_dir)
+        pthread_join(spewer, NULL);
+    demod_pool_join();
+    burst_archive_close();
+    frame_output_shutdown();
+    if (shm_name)
+        frame_output_shm_shutdown();
+    double run_wall = (now_ms() - t_start) / 1000.0;
+    double run_cpu = cpu_seconds() - cpu_start;
+    if (offline_seg.index == 0)
+        pthread_join(stats, NULL);
+
+    if (verbose)
+        fprintf(stderr, "frame pool: %lu blocks (%.1f MB), %lu in use at most, "
+                "%lu oversize\n", atomic_load(&frame_pool_stats.blocks),
+                atomic_load(&frame_pool_stats.bytes) / 1048576.0,
+                atomic_load(&frame_pool_stats.peak),
+                atomic_load(&frame_pool_stats.misses));
+
+    if (stats_json && offline_seg.index == 0)
+        print_summary(run_wall, run_cpu);
+
+    if (verbose && band_plan) {
+        fprintf(stderr, "channels:");
+        for (int i = 0; i < band_plan->n_channels; i++) {
+            unsigned long n = atomic_load(&band_plan->bursts[i]);
+            if (n)
+                fprintf(stderr, " %d:%lu", band_plan->channels[i], n);
+        }
+        fprintf(stderr, ", %lu off plan\n", atomic_load(&band_plan->off_plan));
+    }
+
+    if (position_enabled)
+        doppler_pos_shutdown();
 
     if (web_enabled)
         web_map_shutdown();
 
+    if (ida_ctx.n_sinks) {
+        if (verbose)
+            fprintf(stderr, "IDA: %lu messages, %lu of %d slots in use at most, "
+                    "%lu evicted, %lu expired\n",
+                    atomic_load(&ida_ctx.stat_messages),
+                    atomic_load(&ida_ctx.stat_peak), ida_ctx.capacity,
+                    atomic_load(&ida_ctx.stat_evicted),
+                    atomic_load(&ida_ctx.stat_expired));
+        ida_context_free(&ida_ctx);
+    }
+
     if (gsmtap_enabled) {
         fprintf(stderr, "iridium-sniffer: sent %lu GSMTAP packets\n",
                 atomic_load(&gsmtap_sent_count));
@@ -807,6 +1599,8 @@ int main(int argc, char **argv) {
         acars_shutdown();
     }
 
+    net_output_shutdown();
+
 #ifdef HAVE_ZMQ
     if (zmq_enabled)
         frame_output_zmq_shutdown();
@@ -815,7 +1609,9 @@ int main(int argc, char **argv) {
     if (in_file != NULL)
         fclose(in_file);
 
-    fftw_save_wisdom();
+    /* In case anything was planned after startup */
+    if (offline_seg.index == 0)
+        fftw_save_wisdom();
     free(file_info);
     fprintf(stderr, "iridium-sniffer: shutdown complete\n");
     return 0;
@@ -0,0 +1,325 @@
+/*
+ * MPMC ring -- bounded lock-free multi-producer multi-consumer queue
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define _GNU_SOURCE
+#include <limits.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "mpmc_ring.h"
+
+#define MPMC_SPIN           200     /* failed tries before sleeping */
+#define MPMC_CELL_YIELD     64      /* spins on a busy cell before yielding */
+
+static inline void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static void futex_wait(atomic_uint *word, unsigned seen)
+{
+#ifdef __linux__
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+#else
+    (void)word; (void)seen;
+    usleep(50);
+#endif
+}
+
+static void futex_wake(atomic_uint *word, int n)
+{
+#ifdef __linux__
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+#else
+    (void)word; (void)n;
+#endif
+}
+
+/* Wake up to n sleepers on word, if there are any */
+static void notify(atomic_uint *word, atomic_int *waiters, int n)
+{
+    /* Orders the cell stores before the waiters check; the waiter's
+     * increment and re-check are ordered the same way */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(waiters, memory_order_relaxed) > 0) {
+        atomic_fetch_add(word, 1);
+        futex_wake(word, n);
+    }
+}
+
+/* Wait until the cell at pos reaches seq (its previous owner is done) */
+static void cell_wait(mpmc_cell_t *c, size_t seq)
+{
+    for (int spin = 0;
+         atomic_load_explicit(&c->seq, memory_order_acquire) != seq; spin++) {
+        if (spin < MPMC_CELL_YIELD)
+            cpu_relax();
+        else
+            sched_yield();
+    }
+}
+
+int mpmc_ring_init(mpmc_ring_t *r, unsigned capacity)
+{
+    size_t cap = 1;
+    while (cap < capacity)
+        cap <<= 1;
+
+    r->cells = malloc(cap * sizeof(*r->cells));
+    if (!r->cells)
+        return -1;
+    for (size_t i = 0; i < cap; i++)
+        atomic_init(&r->cells[i].seq, i);
+    r->mask = cap - 1;
+    r->spin = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? MPMC_SPIN : 0;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    atomic_init(&r->closed, 0);
+    atomic_init(&r->item_seq, 0);
+    atomic_init(&r->space_seq, 0);
+    atomic_init(&r->item_waiters, 0);
+    atomic_init(&r->space_waiters, 0);
+    return 0;
+}
+
+void mpmc_ring_destroy(mpmc_ring_t *r)
+{
+    free(r->cells);
+    r->cells = NULL;
+}
+
+/* ---- Non-waiting operations ---- */
+
+static int put_one(mpmc_ring_t *r, void *item)
+{
+    size_t pos = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    mpmc_cell_t *c;
+    for (;;) {
+        c = &r->cells[pos & r->mask];
+        size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&r->tail, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if (dif < 0) {
+            return -1;
+        } else {
+            pos = atomic_load_explicit(&r->tail, memory_order_relaxed);
+        }
+    }
+    c->item = item;
+    atomic_store_explicit(&c->seq, pos + 1, memory_order_release);
+    return 0;
+}
+
+static int take_one(mpmc_ring_t *r, void **item)
+{
+    size_t pos = atomic_load_explicit(&r->head, memory_order_relaxed);
+    mpmc_cell_t *c;
+    for (;;) {
+        c = &r->cells[pos & r->mask];
+        size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&r->head, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if (dif < 0) {
+            return -1;
+        } else {
+            pos = atomic_load_explicit(&r->head, memory_order_relaxed);
+        }
+    }
+    *item = c->item;
+    atomic_store_explicit(&c->seq, pos + r->mask + 1, memory_order_release);
+    return 0;
+}
+
+int mpmc_ring_try_put(mpmc_ring_t *r, void *item)
+{
+    if (atomic_load_explicit(&r->closed, memory_order_relaxed) ||
+        put_one(r, item) != 0)
+        return -1;
+    notify(&r->item_seq, &r->item_waiters, 1);
+    return 0;
+}
+
+int mpmc_ring_try_take(mpmc_ring_t *r, void *item)
+{
+    if (atomic_load_explicit(&r->closed, memory_order_relaxed) ||
+        take_one(r, (void **)item) != 0)
+        return -1;
+    notify(&r->space_seq, &r->space_waiters, 1);
+    return 0;
+}
+
+unsigned mpmc_ring_try_put_batch(mpmc_ring_t *r, void *const *items, unsigned n)
+{
+    if (n == 0 || atomic_load_explicit(&r->closed, memory_order_relaxed))
+        return 0;
+
+    /* Claim up to n positions below head + capacity in one step */
+    size_t cap = r->mask + 1;
+    size_t pos = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    size_t k;
+    for (;;) {
+        size_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+        if ((intptr_t)(pos - head) < 0) {
+            /* pos is stale: takes have passed it */
+            pos = atomic_load_explicit(&r->tail, memory_order_relaxed);
+            continue;
+        }
+        size_t room = cap - (pos - head);
+        if (room == 0)
+            return 0;
+        k = room < n ? room : n;
+        if (atomic_compare_exchange_weak_explicit(&r->tail, &pos, pos + k,
+                memory_order_relaxed, memory_order_relaxed))
+            break;
+    }
+
+    /* A take that claimed one of these cells may still be reading it */
+    for (size_t i = 0; i < k; i++) {
+        mpmc_cell_t *c = &r->cells[(pos + i) & r->mask];
+        cell_wait(c, pos + i);
+        c->item = items[i];
+        atomic_store_explicit(&c->seq, pos + i + 1, memory_order_release);
+    }
+    notify(&r->item_seq, &r->item_waiters, (int)k);
+    return (unsigned)k;
+}
+
+unsigned mpmc_ring_try_take_batch(mpmc_ring_t *r, void **items, unsigned max)
+{
+    if (max == 0 || atomic_load_explicit(&r->closed, memory_order_relaxed))
+        return 0;
+
+    /* Claim up to max positions below tail in one step */
+    size_t pos = atomic_load_explicit(&r->head, memory_order_relaxed);
+    size_t k;
+    for (;;) {
+        size_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+        size_t avail = tail - pos;
+        if (avail > r->mask + 1) {
+            /* pos is stale: other takes have moved on */
+            pos = atomic_load_explicit(&r->head, memory_order_relaxed);
+            continue;
+        }
+        if (avail == 0)
+            return 0;
+        k = avail < max ? avail : max;
+        if (atomic_compare_exchange_weak_explicit(&r->head, &pos, pos + k,
+                memory_order_relaxed, memory_order_relaxed))
+            break;
+    }
+
+    /* A put that claimed one of these cells may still be filling it */
+    for (size_t i = 0; i < k; i++) {
+        mpmc_cell_t *c = &r->cells[(pos + i) & r->mask];
+        cell_wait(c, pos + i + 1);
+        items[i] = c->item;
+        atomic_store_explicit(&c->seq, pos + i + r->mask + 1,
+                              memory_order_release);
+    }
+    notify(&r->space_seq, &r->space_waiters, (int)k);
+    return (unsigned)k;
+}
+
+/* ---- Waiting operations ---- */
+
+/* Sleep on word unless ready holds after registering as a waiter. If it
+ * does, a claimed cell is still being filled or emptied: yield to its
+ * owner instead. */
+#define WAIT_FOR(r, word, waiters, ready)                                   \
+    do {                                                                    \
+        unsigned seen_ = atomic_load(word);                                 \
+        atomic_fetch_add(waiters, 1);                                       \
+        if (ready)                                                          \
+            sched_yield();                                                  \
+        else if (!atomic_load(&(r)->closed))                                \
+            futex_wait(word, seen_);                                        \
+        atomic_fetch_sub(waiters, 1);                                       \
+    } while (0)
+
+int mpmc_ring_put(mpmc_ring_t *r, void *item)
+{
+    for (int spin = 0;; spin++) {
+        if (atomic_load_explicit(&r->closed, memory_order_relaxed))
+            return -1;
+        if (put_one(r, item) == 0) {
+            notify(&r->item_seq, &r->item_waiters, 1);
+            return 0;
+        }
+        if (spin < r->spin) {
+            cpu_relax();
+            continue;
+        }
+        WAIT_FOR(r, &r->space_seq, &r->space_waiters,
+                 mpmc_ring_size(r) <= r->mask);
+    }
+}
+
+int mpmc_ring_take(mpmc_ring_t *r, void *item)
+{
+    for (int spin = 0;; spin++) {
+        if (atomic_load_explicit(&r->closed, memory_order_relaxed))
+            return -1;
+        if (take_one(r, (void **)item) == 0) {
+            notify(&r->space_seq, &r->space_waiters, 1);
+            return 0;
+        }
+        if (spin < r->spin) {
+            cpu_relax();
+            continue;
+        }
+        WAIT_FOR(r, &r->item_seq, &r->item_waiters, mpmc_ring_size(r) > 0);
+    }
+}
+
+unsigned mpmc_ring_take_batch(mpmc_ring_t *r, void **items, unsigned max)
+{
+    for (int spin = 0;; spin++) {
+        if (atomic_load_explicit(&r->closed, memory_order_relaxed))
+            return 0;
+        unsigned n = mpmc_ring_try_take_batch(r, items, max);
+        if (n > 0)
+            return n;
+        if (spin < r->spin) {
+            cpu_relax();
+            continue;
+        }
+        WAIT_FOR(r, &r->item_seq, &r->item_waiters, mpmc_ring_size(r) > 0);
+    }
+}
+
+void mpmc_ring_close(mpmc_ring_t *r)
+{
+    atomic_store(&r->closed, 1);
+    atomic_fetch_add(&r->item_seq, 1);
+    atomic_fetch_add(&r->space_seq, 1);
+    futex_wake(&r->item_seq, INT_MAX);
+    futex_wake(&r->space_seq, INT_MAX);
+}
+
+unsigned mpmc_ring_size(mpmc_ring_t *r)
+{
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    return tail > head ? (unsigned)(tail - head) : 0;
+}
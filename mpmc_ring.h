@@ -0,0 +1,93 @@
+/*
+ * MPMC ring -- bounded lock-free multi-producer multi-consumer queue
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * MPMC ring -- bounded lock-free multi-producer multi-consumer queue
+ *
+ * Dmitry Vyukov's bounded queue: each cell carries a sequence number that
+ * says whether it is free for the put at its position or holds the item
+ * for the take at it, so one compare-and-swap on the tail (or head) claims
+ * a position and a release store publishes it. Batch calls claim several
+ * positions with one compare-and-swap and then fill (or empty) the cells
+ * in order, briefly waiting on any cell whose previous owner is still
+ * finishing with it. Head and tail sit on cache lines of their own.
+ *
+ * Waiting calls spin for a short while (not at all on a single CPU, where
+ * the other side cannot run meanwhile), then sleep on a futex word that
+ * the other side bumps only while someone is waiting, so an uncontended
+ * put or take makes no system call. Without futexes (not Linux) a waiter
+ * polls with short sleeps instead.
+ *
+ * As with blocking_queue.h, closing makes every put and take fail at once,
+ * even on a ring that still holds items.
+ */
+
+#ifndef __MPMC_RING_H__
+#define __MPMC_RING_H__
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define MPMC_CACHE_LINE 64
+
+typedef struct {
+    atomic_size_t seq;
+    void *item;
+} mpmc_cell_t;
+
+typedef struct {
+    atomic_size_t head;         /* next position to take */
+    char pad0[MPMC_CACHE_LINE - sizeof(atomic_size_t)];
+    atomic_size_t tail;         /* next position to put */
+    char pad1[MPMC_CACHE_LINE - sizeof(atomic_size_t)];
+
+    mpmc_cell_t *cells;
+    size_t mask;                /* capacity - 1 */
+    int spin;                   /* tries before sleeping (0 on one CPU) */
+    atomic_int closed;
+
+    /* Futex words, bumped by the other side while waiters is nonzero */
+    atomic_uint item_seq;       /* after puts */
+    atomic_uint space_seq;      /* after takes */
+    atomic_int item_waiters;
+    atomic_int space_waiters;
+} mpmc_ring_t;
+
+/* Allocate a ring of at least capacity cells (rounded up to a power of
+ * two). Returns 0, or -1 if out of memory. */
+int mpmc_ring_init(mpmc_ring_t *r, unsigned capacity);
+void mpmc_ring_destroy(mpmc_ring_t *r);
+
+/* Put one item without waiting. Returns 0, or -1 if full or closed. */
+int mpmc_ring_try_put(mpmc_ring_t *r, void *item);
+
+/* Put one item, waiting for room. Returns 0, or -1 once closed. */
+int mpmc_ring_put(mpmc_ring_t *r, void *item);
+
+/* Put up to n items without waiting; returns how many of the first were
+ * put (0 if full or closed) */
+unsigned mpmc_ring_try_put_batch(mpmc_ring_t *r, void *const *items, unsigned n);
+
+/* Take one item without waiting. Returns 0, or -1 if empty or closed. */
+int mpmc_ring_try_take(mpmc_ring_t *r, void *item);
+
+/* Take one item, waiting for one. Returns 0, or -1 once closed. */
+int mpmc_ring_take(mpmc_ring_t *r, void *item);
+
+/* Take up to max items without waiting; returns how many */
+unsigned mpmc_ring_try_take_batch(mpmc_ring_t *r, void **items, unsigned max);
+
+/* Take up to max items, waiting for at least one; 0 once closed */
+unsigned mpmc_ring_take_batch(mpmc_ring_t *r, void **items, unsigned max);
+
+/* Make every put and take fail and wake all waiters */
+void mpmc_ring_close(mpmc_ring_t *r);
+
+/* Items queued, or about to be (positions claimed by puts) */
+unsigned mpmc_ring_size(mpmc_ring_t *r);
+
+#endif
@@ -0,0 +1,392 @@
+/*
+ * Network IQ input -- sequenced sample packets over UDP or ZMQ
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Network IQ input
+ *
+ * Pool buffers all have the payload size of the first request, so the
+ * first packet is received into a bounce buffer and sets it; later UDP
+ * batches scatter into buffers of that size (rounded up to 1 KiB). A
+ * datagram that does not fit is truncated by the kernel and dropped, and
+ * the next one fills its place with zeros like any lost packet.
+ */
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <err.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#ifdef HAVE_ZMQ
+#include <zmq.h>
+#endif
+
+#include "net_input.h"
+#include "sample_pool.h"
+#include "sdr.h"
+
+#define NET_IQ_BATCH        32          /* datagrams per recvmmsg() */
+#define NET_IQ_RCVBUF       (8 << 20)   /* socket buffer: ~0.4 s of ci8 at 10 Msps */
+#define NET_IQ_POLL_MS      100         /* running is checked this often */
+
+extern sig_atomic_t running;
+extern pid_t self_pid;
+extern int verbose;
+
+extern atomic_ulong stat_net_in_packets;
+extern atomic_ulong stat_net_in_lost;
+extern atomic_ulong stat_net_in_late;
+
+struct net_input {
+    int rx;                     /* receiver index blocks are tagged with */
+    struct sockaddr_in bind_addr;
+    int fd;
+#ifdef HAVE_ZMQ
+    int use_zmq;
+    char *zmq_endpoint;
+    void *zmq_ctx, *zmq_sub;
+#endif
+
+    /* Sequence tracking (receiver thread only) */
+    int have_seq;
+    uint32_t next_seq;
+    size_t last_payload;        /* bytes, the size a lost packet is filled with */
+    int last_format;
+    size_t payload_cap;         /* pool buffer payload, from the first packet */
+    unsigned long n_packets, n_lost, n_late, n_resyncs;
+};
+
+static int format_bytes(int format) {
+    switch (format) {
+    case SAMPLE_FMT_INT8:  return 2;
+    case SAMPLE_FMT_INT16: return 4;
+    case SAMPLE_FMT_FLOAT: return 8;
+    default:               return 0;
+    }
+}
+
+static int parse_spec(net_input_t *ni, const char *spec) {
+    if (strncmp(spec, "zmq://", 6) == 0) {
+#ifdef HAVE_ZMQ
+        if (spec[6] == '\0')
+            return -1;
+        ni->use_zmq = 1;
+        ni->zmq_endpoint = strdup(spec + 6);
+        return 0;
+#else
+        return -1;
+#endif
+    }
+    if (strncmp(spec, "udp://", 6) != 0)
+        return -1;
+
+    char host[64] = "0.0.0.0";
+    const char *port_str = spec + 6;
+    const char *colon = strrchr(port_str, ':');
+    if (colon) {
+        size_t len = (size_t)(colon - port_str);
+        if (len == 0 || len >= sizeof(host))
+            return -1;
+        memcpy(host, port_str, len);
+        host[len] = '\0';
+        port_str = colon + 1;
+    }
+    char *end;
+    long port = strtol(port_str, &end, 10);
+    if (*port_str == '\0' || *end != '\0' || port < 1 || port > 65535)
+        return -1;
+
+    memset(&ni->bind_addr, 0, sizeof(ni->bind_addr));
+    ni->bind_addr.sin_family = AF_INET;
+    ni->bind_addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host, &ni->bind_addr.sin_addr) != 1)
+        return -1;
+    return 0;
+}
+
+net_input_t *net_input_create(const char *spec, int rx) {
+    net_input_t *ni = calloc(1, sizeof(*ni));
+    if (!ni)
+        return NULL;
+    if (parse_spec(ni, spec) != 0) {
+        net_input_free(ni);
+        return NULL;
+    }
+    ni->rx = rx;
+    ni->fd = -1;
+    return ni;
+}
+
+int net_input_parse(const char *spec) {
+    net_input_t *ni = net_input_create(spec, 0);
+    net_input_free(ni);
+    return ni ? 0 : -1;
+}
+
+void net_input_open(net_input_t *ni) {
+#ifdef HAVE_ZMQ
+    if (ni->use_zmq) {
+        int timeout = NET_IQ_POLL_MS;
+        ni->zmq_ctx = zmq_ctx_new();
+        ni->zmq_sub = ni->zmq_ctx ? zmq_socket(ni->zmq_ctx, ZMQ_SUB) : NULL;
+        if (!ni->zmq_sub)
+            errx(1, "Cannot create ZMQ SUB socket");
+        zmq_setsockopt(ni->zmq_sub, ZMQ_SUBSCRIBE, "", 0);
+        zmq_setsockopt(ni->zmq_sub, ZMQ_RCVTIMEO, &timeout, sizeof(timeout));
+        if (zmq_connect(ni->zmq_sub, ni->zmq_endpoint) != 0)
+            errx(1, "Cannot connect ZMQ SUB socket to %s: %s",
+                 ni->zmq_endpoint, zmq_strerror(zmq_errno()));
+        fprintf(stderr, "net input: ZMQ SUB connected to %s\n", ni->zmq_endpoint);
+        return;
+    }
+#endif
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+        err(1, "Cannot create UDP socket");
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    int rcvbuf = NET_IQ_RCVBUF;
+    socklen_t len = sizeof(rcvbuf);
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (verbose && getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, &len) == 0 &&
+            rcvbuf < NET_IQ_RCVBUF)
+        warnx("net input: socket buffer capped at %d bytes "
+              "(raise net.core.rmem_max)", rcvbuf);
+
+    struct timeval tv = { 0, NET_IQ_POLL_MS * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    /* A multicast group is joined on every interface and bound as is */
+    struct sockaddr_in addr = ni->bind_addr;
+    if (IN_MULTICAST(ntohl(addr.sin_addr.s_addr))) {
+        struct ip_mreq mreq;
+        mreq.imr_multiaddr = addr.sin_addr;
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0)
+            err(1, "Cannot join multicast group %s", inet_ntoa(addr.sin_addr));
+    }
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+        err(1, "Cannot bind UDP %s:%d", inet_ntoa(addr.sin_addr),
+            ntohs(addr.sin_port));
+    fprintf(stderr, "net input: listening on UDP %s:%d\n",
+            inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
+    ni->fd = fd;
+}
+
+/* Queue n_packets lost packets' worth of zero samples */
+static void fill_gap(net_input_t *ni, uint32_t n_packets) {
+    for (uint32_t i = 0; i < n_packets && running; i++) {
+        sample_buf_t *s = sample_buf_alloc(ni->last_payload);
+        if (!s)
+            return;
+        memset(s->samples, 0, ni->last_payload);
+        s->format = ni->last_format;
+        s->num = (unsigned)(ni->last_payload / format_bytes(ni->last_format));
+        s->rx = ni->rx;
+        push_samples(s);
+    }
+}
+
+/* Check the header of a len-byte packet whose payload is in s, fill any
+ * gap before it, and push it; s is consumed either way */
+static void deliver(net_input_t *ni, const uint8_t *hdr, sample_buf_t *s,
+                    size_t len, int truncated) {
+    int format = hdr[8];
+    int bytes = format_bytes(format);
+    if (truncated || len < NET_IQ_HDR_LEN || bytes == 0 ||
+            memcmp(hdr, NET_IQ_MAGIC, 4) != 0) {
+        ni->n_late++;
+        atomic_fetch_add(&stat_net_in_late, 1);
+        sample_buf_free(s);
+        return;
+    }
+    uint32_t seq = (uint32_t)hdr[4] | (uint32_t)hdr[5] << 8 |
+                   (uint32_t)hdr[6] << 16 | (uint32_t)hdr[7] << 24;
+
+    if (ni->have_seq && seq != ni->next_seq) {
+        int32_t d = (int32_t)(seq - ni->next_seq);
+        if (d < 0 && d >= -NET_IQ_MAX_GAP) {
+            ni->n_late++;
+            atomic_fetch_add(&stat_net_in_late, 1);
+            sample_buf_free(s);
+            return;
+        }
+        if (d > 0 && d <= NET_IQ_MAX_GAP) {
+            ni->n_lost += (unsigned long)d;
+            atomic_fetch_add(&stat_net_in_lost, (unsigned long)d);
+            fill_gap(ni, (uint32_t)d);
+        } else {
+            ni->n_resyncs++;
+            if (verbose)
+                warnx("net input: sequence jumped from %u to %u, resyncing",
+                      ni->next_seq, seq);
+        }
+    }
+    ni->have_seq = 1;
+    ni->next_seq = seq + 1;
+    ni->last_payload = (len - NET_IQ_HDR_LEN) / bytes * bytes;
+    ni->last_format = format;
+
+    ni->n_packets++;
+    atomic_fetch_add(&stat_net_in_packets, 1);
+    s->format = format;
+    s->num = (unsigned)(ni->last_payload / bytes);
+    s->rx = ni->rx;
+    if (s->num == 0) {
+        sample_buf_free(s);
+        return;
+    }
+    push_samples(s);
+}
+
+/* A whole packet in memory: copy its payload into a pool buffer. The first
+ * one sets the pool's buffer size. */
+static void deliver_copy(net_input_t *ni, const uint8_t *pkt, size_t len) {
+    if (len < NET_IQ_HDR_LEN) {
+        ni->n_late++;
+        atomic_fetch_add(&stat_net_in_late, 1);
+        return;
+    }
+    size_t payload = len - NET_IQ_HDR_LEN;
+    if (ni->payload_cap == 0)
+        ni->payload_cap = (payload + 1023) & ~(size_t)1023;
+    sample_buf_t *s = sample_buf_alloc(payload > ni->payload_cap ? payload
+                                                                 : ni->payload_cap);
+    if (!s)
+        return;
+    memcpy(s->samples, pkt + NET_IQ_HDR_LEN, payload);
+    deliver(ni, pkt, s, len, 0);
+}
+
+#ifdef HAVE_ZMQ
+static void zmq_receive(net_input_t *ni) {
+    while (running) {
+        zmq_msg_t msg;
+        zmq_msg_init(&msg);
+        if (zmq_msg_recv(&msg, ni->zmq_sub, 0) >= 0)
+            deliver_copy(ni, zmq_msg_data(&msg), zmq_msg_size(&msg));
+        zmq_msg_close(&msg);
+    }
+}
+#endif
+
+static void udp_receive(net_input_t *ni) {
+    uint8_t *bounce = NULL;
+    uint8_t hdr[NET_IQ_BATCH][NET_IQ_HDR_LEN];
+    sample_buf_t *bufs[NET_IQ_BATCH] = { 0 };
+    size_t payload_cap;
+
+    while (running) {
+        if ((payload_cap = ni->payload_cap) == 0) {
+            if (!bounce && !(bounce = malloc(NET_IQ_HDR_LEN + NET_IQ_MAX_PAYLOAD))) {
+                warnx("net input: unable to allocate receive buffer");
+                break;
+            }
+            ssize_t n = recv(ni->fd, bounce, NET_IQ_HDR_LEN + NET_IQ_MAX_PAYLOAD, 0);
+            if (n > 0)
+                deliver_copy(ni, bounce, (size_t)n);
+            continue;
+        }
+
+        /* Headers to their own array, payloads straight into pool buffers */
+        struct iovec iov[NET_IQ_BATCH][2];
+        int n_bufs = 0;
+        while (n_bufs < NET_IQ_BATCH) {
+            if (!bufs[n_bufs] && !(bufs[n_bufs] = sample_buf_alloc(payload_cap)))
+                break;
+            iov[n_bufs][0].iov_base = hdr[n_bufs];
+            iov[n_bufs][0].iov_len = NET_IQ_HDR_LEN;
+            iov[n_bufs][1].iov_base = bufs[n_bufs]->samples;
+            iov[n_bufs][1].iov_len = payload_cap;
+            n_bufs++;
+        }
+        if (n_bufs == 0) {
+            warnx("net input: unable to allocate sample buffers");
+            break;
+        }
+
+#ifdef __linux__
+        struct mmsghdr msgs[NET_IQ_BATCH];
+        memset(msgs, 0, n_bufs * sizeof(msgs[0]));
+        for (int i = 0; i < n_bufs; i++) {
+            msgs[i].msg_hdr.msg_iov = iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 2;
+        }
+        int r = recvmmsg(ni->fd, msgs, (unsigned)n_bufs, MSG_WAITFORONE, NULL);
+        for (int i = 0; i < r; i++) {
+            deliver(ni, hdr[i], bufs[i], msgs[i].msg_len,
+                    msgs[i].msg_hdr.msg_flags & MSG_TRUNC);
+            bufs[i] = NULL;
+        }
+#else
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov[0];
+        msg.msg_iovlen = 2;
+        ssize_t n = recvmsg(ni->fd, &msg, 0);
+        if (n >= 0) {
+            deliver(ni, hdr[0], bufs[0], (size_t)n, msg.msg_flags & MSG_TRUNC);
+            bufs[0] = NULL;
+        }
+#endif
+    }
+
+    for (int i = 0; i < NET_IQ_BATCH; i++)
+        sample_buf_free(bufs[i]);
+    free(bounce);
+}
+
+void *net_input_thread(void *arg) {
+    net_input_t *ni = (net_input_t *)arg;
+#ifdef HAVE_ZMQ
+    if (ni->use_zmq)
+        zmq_receive(ni);
+    else
+#endif
+        udp_receive(ni);
+
+    running = 0;
+    kill(self_pid, SIGINT);
+    return NULL;
+}
+
+void net_input_close(net_input_t *ni) {
+#ifdef HAVE_ZMQ
+    if (ni->zmq_sub) {
+        zmq_close(ni->zmq_sub);
+        zmq_ctx_destroy(ni->zmq_ctx);
+        ni->zmq_sub = NULL;
+    }
+#endif
+    if (ni->fd >= 0)
+        close(ni->fd);
+    ni->fd = -1;
+    fprintf(stderr, "net input %d: %lu packets, %lu lost (zero-filled), "
+            "%lu late or malformed, %lu resyncs\n", ni->rx,
+            ni->n_packets, ni->n_lost, ni->n_late, ni->n_resyncs);
+    net_input_free(ni);
+}
+
+void net_input_free(net_input_t *ni) {
+    if (!ni)
+        return;
+#ifdef HAVE_ZMQ
+    free(ni->zmq_endpoint);
+#endif
+    free(ni);
+}
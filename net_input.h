@@ -0,0 +1,66 @@
+/*
+ * Network IQ input -- sequenced sample packets over UDP or ZMQ
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Network IQ input -- sequenced sample packets over UDP or ZMQ
+ *
+ * An edge box streams its SDR's samples to the sniffer as packets of a
+ * NET_IQ_HDR_LEN-byte header and a payload of whole samples:
+ *
+ *   offset 0  magic   "IRIQ"
+ *          4  seq     uint32, little endian, +1 per packet (wraps)
+ *          8  format  uint8, SAMPLE_FMT_* of the payload
+ *          9  zero    3 bytes, reserved
+ *
+ * UDP packets are taken in batches with recvmmsg(), each payload scattered
+ * straight into a pooled sample_buf_t; ZMQ messages (SUB socket) are
+ * copied into one. Blocks go to push_samples() like an SDR's, tagged with
+ * the input's receiver index; each input has its own socket. A jump in
+ * seq means packets were lost: as many zero samples as they would have
+ * held are queued in their place, so the detector's sample clock and the
+ * timestamps it derives stay continuous. Late and duplicate packets are
+ * dropped, and a jump of more than NET_IQ_MAX_GAP packets either way is
+ * taken as a restarted sender and followed without a fill.
+ */
+
+#ifndef __NET_INPUT_H__
+#define __NET_INPUT_H__
+
+#define NET_IQ_MAGIC        "IRIQ"
+#define NET_IQ_HDR_LEN      12
+
+/* Largest payload of one packet (the UDP maximum less the header) */
+#define NET_IQ_MAX_PAYLOAD  (65507 - NET_IQ_HDR_LEN)
+
+/* Longest run of lost packets that is zero-filled */
+#define NET_IQ_MAX_GAP      4096
+
+typedef struct net_input net_input_t;
+
+/* Parse an input spec, udp://[ADDR:]PORT (ADDR may be a multicast group
+ * to join) or zmq://ENDPOINT (a SUB socket connects to it), into an input
+ * whose blocks are tagged with receiver rx. Returns NULL if spec is
+ * malformed or names a transport not built in. */
+net_input_t *net_input_create(const char *spec, int rx);
+
+/* Check a spec as net_input_create() would: 0 if it is usable, else -1 */
+int net_input_parse(const char *spec);
+
+/* Bind or connect the input's socket; exits on failure */
+void net_input_open(net_input_t *ni);
+
+/* Receive on the net_input_t passed as arg until running clears, pushing
+ * sample blocks */
+void *net_input_thread(void *arg);
+
+/* Close the socket, print the packet counts and free the input */
+void net_input_close(net_input_t *ni);
+
+/* Free an input that was never opened */
+void net_input_free(net_input_t *ni);
+
+#endif
@@ -0,0 +1,429 @@
+/*
+ * Network output -- UDP and TCP sinks served by a dedicated I/O thread
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Network output -- UDP and TCP sinks served by a dedicated I/O thread
+ *
+ * Each sink owns a single-producer ring of message pointers: the output
+ * thread fills it, the I/O thread drains it. The I/O thread sleeps in
+ * poll() on a wake pipe and its TCP sockets; the producer only writes to
+ * the pipe when no wake-up is already pending, so a burst of messages
+ * costs one syscall. getaddrinfo() runs on the I/O thread, so a hanging
+ * DNS lookup delays only the TCP feed it belongs to.
+ */
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "net_output.h"
+
+#define NET_UDP_BATCH       32      /* datagrams per sendmmsg() */
+#define NET_POLL_MS         100     /* reconnect timers are checked this often */
+#define NET_BACKOFF_MIN_MS  1000
+#define NET_BACKOFF_MAX_MS  60000
+#define NET_SHUTDOWN_MS     1000
+
+extern atomic_ulong stat_net_sent;
+extern atomic_ulong stat_net_dropped;
+
+typedef struct {
+    size_t len;
+    unsigned char data[];
+} net_msg_t;
+
+struct _net_sink {
+    char name[32];
+    int tcp;
+    int fd;
+    struct sockaddr_in addr;    /* UDP destination */
+
+    /* TCP connection state (I/O thread only) */
+    char *host;
+    int port;
+    int connecting;
+    int warned;                 /* failure already reported */
+    int backoff_ms;
+    uint64_t retry_at_ms;
+    size_t head_sent;           /* bytes of the head message written */
+    short revents;
+
+    /* Ring: producer advances tail, I/O thread advances head */
+    net_msg_t *ring[NET_BACKLOG];
+    atomic_size_t head, tail;
+    atomic_ulong n_sent, n_dropped;
+};
+
+static net_sink_t *sinks[NET_MAX_SINKS];
+static int n_sinks = 0;
+
+static pthread_t io_thread;
+static int io_started = 0;
+static atomic_int io_running = 0;
+static int wake_pipe[2] = { -1, -1 };
+static atomic_int wake_pending = 0;
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void set_nonblock(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+static net_sink_t *sink_new(const char *name, int tcp) {
+    if (n_sinks == NET_MAX_SINKS)
+        return NULL;
+    net_sink_t *s = calloc(1, sizeof(*s));
+    snprintf(s->name, sizeof(s->name), "%s", name);
+    s->tcp = tcp;
+    s->fd = -1;
+    sinks[n_sinks++] = s;
+    return s;
+}
+
+net_sink_t *net_sink_udp(const char *name, const char *host, int port) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1)
+        return NULL;
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+        return NULL;
+    net_sink_t *s = sink_new(name, 0);
+    if (!s) {
+        close(fd);
+        return NULL;
+    }
+    set_nonblock(fd);
+    s->fd = fd;
+    s->addr = addr;
+    return s;
+}
+
+net_sink_t *net_sink_tcp(const char *name, const char *host, int port) {
+    net_sink_t *s = sink_new(name, 1);
+    if (!s)
+        return NULL;
+    s->host = strdup(host);
+    s->port = port;
+    s->backoff_ms = NET_BACKOFF_MIN_MS;
+    return s;
+}
+
+/* ---- Producer side ---- */
+
+void net_send(net_sink_t *s, const void *data, size_t len) {
+    if (!s || len == 0)
+        return;
+
+    size_t tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&s->head, memory_order_acquire);
+    if (tail - head == NET_BACKLOG) {
+        atomic_fetch_add(&s->n_dropped, 1);
+        atomic_fetch_add(&stat_net_dropped, 1);
+        return;
+    }
+
+    net_msg_t *m = malloc(sizeof(*m) + len);
+    m->len = len;
+    memcpy(m->data, data, len);
+    s->ring[tail % NET_BACKLOG] = m;
+    atomic_store_explicit(&s->tail, tail + 1, memory_order_release);
+
+    if (!atomic_exchange(&wake_pending, 1) && wake_pipe[1] >= 0) {
+        ssize_t r = write(wake_pipe[1], "", 1);
+        (void)r;
+    }
+}
+
+/* ---- I/O thread ---- */
+
+static size_t queued(net_sink_t *s) {
+    return atomic_load_explicit(&s->tail, memory_order_acquire)
+         - atomic_load_explicit(&s->head, memory_order_relaxed);
+}
+
+static net_msg_t *peek(net_sink_t *s, size_t i) {
+    return s->ring[(atomic_load_explicit(&s->head, memory_order_relaxed) + i)
+                   % NET_BACKLOG];
+}
+
+/* Free the n oldest messages, counting them as sent or dropped */
+static void pop(net_sink_t *s, size_t n, int sent) {
+    size_t head = atomic_load_explicit(&s->head, memory_order_relaxed);
+    for (size_t i = 0; i < n; i++)
+        free(s->ring[(head + i) % NET_BACKLOG]);
+    atomic_store_explicit(&s->head, head + n, memory_order_release);
+    if (sent) {
+        atomic_fetch_add(&s->n_sent, n);
+        atomic_fetch_add(&stat_net_sent, n);
+    } else {
+        atomic_fetch_add(&s->n_dropped, n);
+        atomic_fetch_add(&stat_net_dropped, n);
+    }
+}
+
+static void service_udp(net_sink_t *s) {
+    size_t n;
+    while ((n = queued(s)) > 0) {
+        if (n > NET_UDP_BATCH) n = NET_UDP_BATCH;
+#ifdef __linux__
+        struct mmsghdr msgs[NET_UDP_BATCH];
+        struct iovec iov[NET_UDP_BATCH];
+        memset(msgs, 0, n * sizeof(msgs[0]));
+        for (size_t i = 0; i < n; i++) {
+            net_msg_t *m = peek(s, i);
+            iov[i].iov_base = m->data;
+            iov[i].iov_len = m->len;
+            msgs[i].msg_hdr.msg_name = &s->addr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(s->addr);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int r = sendmmsg(s->fd, msgs, (unsigned)n, 0);
+#else
+        int r = 0;
+        while ((size_t)r < n) {
+            net_msg_t *m = peek(s, r);
+            if (sendto(s->fd, m->data, m->len, 0, (struct sockaddr *)&s->addr,
+                       sizeof(s->addr)) < 0)
+                break;
+            r++;
+        }
+        if (r == 0)
+            r = -1;
+#endif
+        if (r > 0) {
+            pop(s, r, 1);
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return;     /* socket buffer full, wait for POLLOUT */
+        } else {
+            pop(s, 1, 0);   /* e.g. ECONNREFUSED from an earlier datagram */
+        }
+    }
+}
+
+static void tcp_fail(net_sink_t *s, uint64_t now, const char *what) {
+    if (!s->warned)
+        fprintf(stderr, "net: %s: %s %s:%d, retrying with backoff\n",
+                s->name, what, s->host, s->port);
+    s->warned = 1;
+    if (s->fd >= 0)
+        close(s->fd);
+    s->fd = -1;
+    s->connecting = 0;
+    /* A message cut off mid-line is worthless on a new connection */
+    if (s->head_sent) {
+        pop(s, 1, 0);
+        s->head_sent = 0;
+    }
+    s->retry_at_ms = now + s->backoff_ms;
+    s->backoff_ms *= 2;
+    if (s->backoff_ms > NET_BACKOFF_MAX_MS)
+        s->backoff_ms = NET_BACKOFF_MAX_MS;
+}
+
+static void tcp_connected(net_sink_t *s) {
+    s->connecting = 0;
+    s->backoff_ms = NET_BACKOFF_MIN_MS;
+    int flag = 1;
+    setsockopt(s->fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    fprintf(stderr, "net: %s: connected to %s:%d\n", s->name, s->host, s->port);
+    s->warned = 0;
+}
+
+static void tcp_connect(net_sink_t *s, uint64_t now) {
+    char port_str[16];
+    snprintf(port_str, sizeof(port_str), "%d", s->port);
+
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(s->host, port_str, &hints, &res) != 0 || !res) {
+        tcp_fail(s, now, "cannot resolve");
+        return;
+    }
+
+    s->fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (s->fd < 0) {
+        freeaddrinfo(res);
+        tcp_fail(s, now, "no socket for");
+        return;
+    }
+    set_nonblock(s->fd);
+    int r = connect(s->fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (r == 0)
+        tcp_connected(s);
+    else if (errno == EINPROGRESS)
+        s->connecting = 1;
+    else
+        tcp_fail(s, now, "cannot connect to");
+}
+
+static void service_tcp(net_sink_t *s, uint64_t now) {
+    if (s->fd < 0) {
+        if (now < s->retry_at_ms)
+            return;
+        tcp_connect(s, now);
+        if (s->fd < 0)
+            return;
+    }
+
+    if (s->connecting) {
+        if (!(s->revents & (POLLOUT | POLLERR | POLLHUP)))
+            return;
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(s->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err) {
+            tcp_fail(s, now, "cannot connect to");
+            return;
+        }
+        tcp_connected(s);
+    }
+
+    while (queued(s) > 0) {
+        net_msg_t *m = peek(s, 0);
+        ssize_t r = send(s->fd, m->data + s->head_sent, m->len - s->head_sent,
+                         MSG_NOSIGNAL);
+        if (r > 0) {
+            s->head_sent += r;
+            if (s->head_sent == m->len) {
+                pop(s, 1, 1);
+                s->head_sent = 0;
+            }
+        } else if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        } else {
+            tcp_fail(s, now, "lost connection to");
+            return;
+        }
+    }
+}
+
+static void *io_thread_fn(void *arg) {
+    (void)arg;
+    struct pollfd pfd[NET_MAX_SINKS + 1];
+    int slot[NET_MAX_SINKS];
+    uint64_t deadline = 0;
+
+    while (1) {
+        uint64_t now = now_ms();
+        if (!atomic_load(&io_running)) {
+            if (!deadline)
+                deadline = now + NET_SHUTDOWN_MS;
+            size_t left = 0;
+            for (int i = 0; i < n_sinks; i++)
+                left += queued(sinks[i]);
+            if (left == 0 || now >= deadline)
+                break;
+        }
+
+        int n = 0;
+        pfd[n].fd = wake_pipe[0];
+        pfd[n].events = POLLIN;
+        n++;
+        for (int i = 0; i < n_sinks; i++) {
+            net_sink_t *s = sinks[i];
+            slot[i] = -1;
+            s->revents = 0;
+            if (s->fd < 0 || (!s->connecting && queued(s) == 0))
+                continue;
+            slot[i] = n;
+            pfd[n].fd = s->fd;
+            pfd[n].events = POLLOUT;
+            n++;
+        }
+
+        /* A sink with messages left is waiting for a connect or for room
+         * in its socket buffer; POLLOUT says when to try again */
+        poll(pfd, n, NET_POLL_MS);
+
+        if (pfd[0].revents & POLLIN) {
+            char buf[64];
+            while (read(wake_pipe[0], buf, sizeof(buf)) > 0)
+                ;
+        }
+        atomic_store(&wake_pending, 0);
+
+        now = now_ms();
+        for (int i = 0; i < n_sinks; i++) {
+            net_sink_t *s = sinks[i];
+            if (slot[i] >= 0)
+                s->revents = pfd[slot[i]].revents;
+            if (s->tcp)
+                service_tcp(s, now);
+            else if (queued(s) > 0)
+                service_udp(s);
+        }
+    }
+    return NULL;
+}
+
+void net_output_start(void) {
+    if (io_started || n_sinks == 0)
+        return;
+    if (pipe(wake_pipe) != 0) {
+        perror("net_output: pipe");
+        return;
+    }
+    set_nonblock(wake_pipe[0]);
+    set_nonblock(wake_pipe[1]);
+    atomic_store(&io_running, 1);
+    pthread_create(&io_thread, NULL, io_thread_fn, NULL);
+    io_started = 1;
+}
+
+void net_output_shutdown(void) {
+    if (io_started) {
+        atomic_store(&io_running, 0);
+        ssize_t r = write(wake_pipe[1], "", 1);
+        (void)r;
+        pthread_join(io_thread, NULL);
+        close(wake_pipe[0]);
+        close(wake_pipe[1]);
+        wake_pipe[0] = wake_pipe[1] = -1;
+        io_started = 0;
+    }
+
+    for (int i = 0; i < n_sinks; i++) {
+        net_sink_t *s = sinks[i];
+        size_t left = queued(s);
+        if (left)
+            pop(s, left, 0);
+        unsigned long dropped = atomic_load(&s->n_dropped);
+        if (dropped)
+            fprintf(stderr, "net: %s: sent %lu messages, dropped %lu\n",
+                    s->name, atomic_load(&s->n_sent), dropped);
+        if (s->fd >= 0)
+            close(s->fd);
+        free(s->host);
+        free(s);
+        sinks[i] = NULL;
+    }
+    n_sinks = 0;
+}
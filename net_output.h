@@ -0,0 +1,56 @@
+/*
+ * Network output -- UDP and TCP sinks served by a dedicated I/O thread
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Network output -- UDP and TCP sinks served by a dedicated I/O thread
+ *
+ * GSMTAP, the ACARS JSON streams and the aggregator feeds hand finished
+ * messages to net_send(), which copies them onto the sink's bounded
+ * lock-free ring and returns; it never touches a socket. The I/O thread
+ * sends queued UDP datagrams in batches (sendmmsg() where available),
+ * and keeps TCP sinks on non-blocking sockets, resolving and reconnecting
+ * them with exponential backoff. A slow or unreachable endpoint only
+ * fills its own ring, and messages that do not fit are dropped and
+ * counted instead of stalling the output thread.
+ */
+
+#ifndef __NET_OUTPUT_H__
+#define __NET_OUTPUT_H__
+
+#include <stddef.h>
+
+/* Messages queued per sink before new ones are dropped (power of two) */
+#define NET_BACKLOG         1024
+
+/* Most sinks in one process */
+#define NET_MAX_SINKS       8
+
+typedef struct _net_sink net_sink_t;
+
+/* UDP sink sending to host (dotted quad) and port. name (copied) labels
+ * the sink in messages. Returns NULL if host is not a valid address or
+ * no socket can be made. Create all sinks before net_output_start(). */
+net_sink_t *net_sink_udp(const char *name, const char *host, int port);
+
+/* TCP sink for host (name or address) and port. The I/O thread resolves
+ * and connects it, and reconnects whenever the connection is lost.
+ * Returns NULL only when NET_MAX_SINKS sinks exist. */
+net_sink_t *net_sink_tcp(const char *name, const char *host, int port);
+
+/* Start the I/O thread (no-op without sinks) */
+void net_output_start(void);
+
+/* Queue a copy of len bytes for sink (NULL is ignored). Never blocks; a
+ * message that does not fit the sink's backlog is dropped. Call from one
+ * thread only (the output thread). */
+void net_send(net_sink_t *sink, const void *data, size_t len);
+
+/* Give queued messages up to NET_SHUTDOWN_MS to go out, stop the I/O
+ * thread, close every sink and print what each one sent and dropped */
+void net_output_shutdown(void);
+
+#endif
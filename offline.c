@@ -0,0 +1,168 @@
+/*
+ * Offline replay -- memory-mapped input and multi-process file splitting
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Offline replay -- memory-mapped input and multi-process file splitting
+ *
+ * Workers are separate processes rather than threads: the pipeline keeps
+ * its queues, detector and output state in globals, and a fork gives each
+ * segment a private copy of all of it for free. Workers read the file
+ * through a shared read-only mapping, so the page cache is shared too.
+ */
+
+#define _GNU_SOURCE
+#include <err.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "offline.h"
+
+/* ---- Memory-mapped input ---- */
+
+const int8_t *offline_map_file(FILE *f, size_t *len) {
+    struct stat st;
+    int fd = fileno(f);
+
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        fprintf(stderr, "mmap: input is not a regular file\n");
+        return NULL;
+    }
+    if (st.st_size == 0) {
+        fprintf(stderr, "mmap: input file is empty\n");
+        return NULL;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "mmap: %s\n", strerror(errno));
+        return NULL;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    *len = (size_t)st.st_size;
+    return map;
+}
+
+void offline_unmap_file(const int8_t *map, size_t len) {
+    if (map)
+        munmap((void *)map, len);
+}
+
+/* ---- Parallel replay ---- */
+
+static void parent_sig_handler(int signo) {
+    (void)signo;
+}
+
+static void copy_output(FILE *from) {
+    char buf[65536];
+    size_t r;
+
+    rewind(from);
+    while ((r = fread(buf, 1, sizeof(buf), from)) > 0)
+        if (fwrite(buf, 1, r, stdout) != r)
+            break;
+    fflush(stdout);
+}
+
+void offline_parallel_fork(int n, FILE *f, int sample_bytes,
+                           double sample_rate, offline_segment_t *seg) {
+    struct stat st;
+    if (fstat(fileno(f), &st) != 0 || !S_ISREG(st.st_mode))
+        errx(1, "--offline-parallel needs a regular input file");
+
+    uint64_t total = (uint64_t)st.st_size / (uint64_t)sample_bytes;
+    uint64_t seg_len = (total + (uint64_t)n - 1) / (uint64_t)n;
+    uint64_t overlap = (uint64_t)(OFFLINE_OVERLAP_SEC * sample_rate);
+
+    /* Every worker numbers samples from the same wall-clock epoch */
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t epoch = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+
+    FILE *out[OFFLINE_PARALLEL_MAX];
+    pid_t pid[OFFLINE_PARALLEL_MAX];
+
+    fflush(stdout);
+    fflush(stderr);
+
+    for (int i = 0; i < n; i++) {
+        out[i] = tmpfile();
+        if (!out[i])
+            err(1, "Cannot create temporary output file");
+    }
+
+    for (int i = 0; i < n; i++) {
+        uint64_t own_start = (uint64_t)i * seg_len;
+        uint64_t own_end = own_start + seg_len;
+        if (own_start > total) own_start = total;
+        if (own_end > total) own_end = total;
+
+        pid[i] = fork();
+        if (pid[i] < 0)
+            err(1, "fork");
+        if (pid[i] > 0)
+            continue;
+
+        /* Worker */
+        if (dup2(fileno(out[i]), STDOUT_FILENO) < 0)
+            err(1, "dup2");
+        for (int j = 0; j < n; j++)
+            fclose(out[j]);
+
+        seg->index = i;
+        seg->count = n;
+        seg->read_start = own_start > overlap ? own_start - overlap : 0;
+        seg->read_start -= seg->read_start % OFFLINE_ALIGN;
+        seg->read_end = own_end + overlap < total ? own_end + overlap : total;
+        seg->epoch_ns = epoch;
+        seg->start_time_ns = epoch +
+            (uint64_t)((double)seg->read_start / sample_rate * 1e9);
+        seg->emit_start_ns = i == 0 ? 0 :
+            epoch + (uint64_t)((double)own_start / sample_rate * 1e9);
+        seg->emit_end_ns = i == n - 1 ? UINT64_MAX :
+            epoch + (uint64_t)((double)own_end / sample_rate * 1e9);
+        return;
+    }
+
+    /* Parent: wait in segment order, forwarding interrupts to the workers.
+     * No SA_RESTART, so a signal breaks waitpid out with EINTR. */
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = parent_sig_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    int failed = 0;
+    for (int i = 0; i < n; i++) {
+        int status;
+        while (waitpid(pid[i], &status, 0) < 0) {
+            if (errno != EINTR)
+                err(1, "waitpid");
+            for (int j = i; j < n; j++)
+                kill(pid[j], SIGINT);
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "offline: worker %d failed\n", i);
+            failed = 1;
+        }
+        copy_output(out[i]);
+        fclose(out[i]);
+    }
+
+    exit(failed);
+}
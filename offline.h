@@ -0,0 +1,65 @@
+/*
+ * Offline replay -- memory-mapped input and multi-process file splitting
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Offline replay -- memory-mapped input and multi-process file splitting
+ *
+ * --mmap maps the recording read-only so the file reader can hand the
+ * detector views straight into the page cache instead of copying every
+ * block through fread.
+ *
+ * --offline-parallel=N forks N copies of the whole pipeline, each reading
+ * one time segment of the file plus an overlap on both sides (so the noise
+ * estimate has settled and bursts crossing the cut are seen whole). A
+ * worker only emits frames whose timestamp falls in its own segment, so
+ * each frame comes out exactly once. Worker output goes to a temporary
+ * file; the parent concatenates them in segment order, which keeps the
+ * RAW stream in timestamp order across the cuts.
+ */
+
+#ifndef __OFFLINE_H__
+#define __OFFLINE_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* Samples read on each side of a segment, in seconds of input */
+#define OFFLINE_OVERLAP_SEC 1.0
+
+/* Segment reads start on a multiple of this many samples, so every worker
+ * sees the same FFT frame grid as a single-process run */
+#define OFFLINE_ALIGN 65536
+
+/* Maximum number of offline workers */
+#define OFFLINE_PARALLEL_MAX 64
+
+typedef struct {
+    int index;                  /* this worker, 0 .. count - 1 */
+    int count;                  /* number of workers */
+    uint64_t read_start;        /* first sample to read */
+    uint64_t read_end;          /* one past the last sample to read */
+    uint64_t epoch_ns;          /* timestamp of the first sample in the file */
+    uint64_t start_time_ns;     /* timestamp of sample read_start */
+    uint64_t emit_start_ns;     /* earliest frame timestamp this worker owns */
+    uint64_t emit_end_ns;       /* first frame timestamp owned by the next worker */
+} offline_segment_t;
+
+/* Map the whole input file read-only with a sequential access hint.
+ * Returns NULL (with a message) if the file cannot be mapped. */
+const int8_t *offline_map_file(FILE *f, size_t *len);
+
+void offline_unmap_file(const int8_t *map, size_t len);
+
+/* Fork n workers over the input file. Returns in each worker with its
+ * segment filled in and stdout redirected to the worker's temporary file.
+ * The parent never returns: it forwards SIGINT/SIGTERM, waits for the
+ * workers, writes their output to stdout in order and exits. Must be
+ * called before any thread is started. */
+void offline_parallel_fork(int n, FILE *f, int sample_bytes,
+                           double sample_rate, offline_segment_t *seg);
+
+#endif
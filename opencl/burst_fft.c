@@ -8,6 +8,13 @@
  *   4. fftshift + magnitude squared kernel
  *   5. Download magnitude floats back to CPU
  *
+ * All five are enqueued without blocking on one in-order queue; each
+ * slot has its own buffers and the download's event, so a second batch
+ * can be queued before the CPU waits for the first.
+ *
+ * The downmix engine uploads rows of complex samples, runs one batched
+ * in-place VkFFT transform and reads them back.
+ *
  * Adapted from ice9-bluetooth-sniffer opencl/fft.c pattern
  *
  * Original work Copyright 2022 ICE9 Consulting LLC
@@ -25,6 +32,13 @@
  *   4. fftshift + magnitude squared kernel
  *   5. Download magnitude floats back to CPU
  *
+ * All five are enqueued without blocking on one in-order queue; each
+ * slot has its own buffers and the download's event, so a second batch
+ * can be queued before the CPU waits for the first.
+ *
+ * The downmix engine uploads rows of complex samples, runs one batched
+ * in-place VkFFT transform and reads them back.
+ *
  * Adapted from ice9-bluetooth-sniffer opencl/fft.c pattern.
  */
 
@@ -81,6 +95,14 @@ static const char *burst_kernels_source =
 
 /* ---- GPU context ---- */
 
+typedef struct {
+    cl_mem cl_input;        /* float [batch_size * fft_size * 2] (complex) */
+    cl_mem cl_fft;          /* float [batch_size * fft_size * 2] (complex, in-place FFT) */
+    cl_mem cl_magnitude;    /* float [batch_size * fft_size] */
+    float *magnitude;       /* host copy of cl_magnitude */
+    cl_event done;          /* download finished, 0 = nothing in flight */
+} burst_slot_t;
+
 struct gpu_burst_fft {
     int fft_size;
     int batch_size;
@@ -94,13 +116,12 @@ struct gpu_burst_fft {
     cl_kernel kern_magnitude;
 
     /* GPU buffers */
-    cl_mem cl_input;        /* float [batch_size * fft_size * 2] (complex) */
-    cl_mem cl_fft;          /* float [batch_size * fft_size * 2] (complex, in-place FFT) */
-    cl_mem cl_magnitude;    /* float [batch_size * fft_size] */
+    burst_slot_t slots[GPU_BURST_FFT_SLOTS];
     cl_mem cl_window;       /* float [fft_size] (uploaded once) */
 
-    /* VkFFT */
+    /* VkFFT: one app, launched on each slot's cl_fft */
     VkFFTApplication vkfft_app;
+    int vkfft_ready;
     uint64_t fft_buffer_size;
 };
 
@@ -227,17 +248,23 @@ gpu_burst_fft_t *gpu_burst_fft_create(int fft_size, int batch_size,
     size_t mag_batch_bytes = (size_t)batch_size * fft_size * sizeof(float);
     size_t window_bytes = (size_t)fft_size * sizeof(float);
 
-    g->cl_input = clCreateBuffer(g->context, CL_MEM_READ_ONLY,
-                                  complex_batch_bytes, NULL, &err);
-    if (err != CL_SUCCESS) goto err_bufs;
+    for (int i = 0; i < GPU_BURST_FFT_SLOTS; i++) {
+        burst_slot_t *sl = &g->slots[i];
 
-    g->cl_fft = clCreateBuffer(g->context, CL_MEM_READ_WRITE,
-                                complex_batch_bytes, NULL, &err);
-    if (err != CL_SUCCESS) goto err_bufs;
+        sl->cl_input = clCreateBuffer(g->context, CL_MEM_READ_ONLY,
+                                       complex_batch_bytes, NULL, &err);
+        if (err != CL_SUCCESS) goto err_bufs;
 
-    g->cl_magnitude = clCreateBuffer(g->context, CL_MEM_WRITE_ONLY,
-                                      mag_batch_bytes, NULL, &err);
-    if (err != CL_SUCCESS) goto err_bufs;
+        sl->cl_fft = clCreateBuffer(g->context, CL_MEM_READ_WRITE,
+                                     complex_batch_bytes, NULL, &err);
+        if (err != CL_SUCCESS) goto err_bufs;
+
+        sl->cl_magnitude = clCreateBuffer(g->context, CL_MEM_WRITE_ONLY,
+                                           mag_batch_bytes, NULL, &err);
+        if (err != CL_SUCCESS) goto err_bufs;
+
+        sl->magnitude = malloc(mag_batch_bytes);
+    }
 
     g->cl_window = clCreateBuffer(g->context, CL_MEM_READ_ONLY,
                                    window_bytes, NULL, &err);
@@ -248,14 +275,9 @@ gpu_burst_fft_t *gpu_burst_fft_create(int fft_size, int batch_size,
                                 window_bytes, window, 0, NULL, NULL);
     if (err != CL_SUCCESS) goto err_bufs;
 
-    /* Set static kernel arguments */
-    clSetKernelArg(g->kern_window, 0, sizeof(cl_mem), &g->cl_input);
+    /* Set static kernel arguments; the buffers are set per batch */
     clSetKernelArg(g->kern_window, 1, sizeof(cl_mem), &g->cl_window);
-    clSetKernelArg(g->kern_window, 2, sizeof(cl_mem), &g->cl_fft);
     clSetKernelArg(g->kern_window, 3, sizeof(int), &fft_size);
-
-    clSetKernelArg(g->kern_magnitude, 0, sizeof(cl_mem), &g->cl_fft);
-    clSetKernelArg(g->kern_magnitude, 1, sizeof(cl_mem), &g->cl_magnitude);
     clSetKernelArg(g->kern_magnitude, 2, sizeof(int), &fft_size);
 
     /* Initialize VkFFT */
@@ -268,31 +290,24 @@ gpu_burst_fft_t *gpu_burst_fft_create(int fft_size, int batch_size,
     config.device = &g->device;
     config.context = &g->context;
     config.commandQueue = &g->queue;
-    config.buffer = &g->cl_fft;
+    config.buffer = &g->slots[0].cl_fft;
     config.bufferSize = &g->fft_buffer_size;
 
     VkFFTResult vk_res = initializeVkFFT(&g->vkfft_app, config);
     if (vk_res != VKFFT_SUCCESS) {
         fprintf(stderr, "VkFFT init error: %d\n", vk_res);
-        goto err_bufs;
+        gpu_burst_fft_destroy(g);
+        return NULL;
     }
+    g->vkfft_ready = 1;
 
-    fprintf(stderr, "GPU burst FFT: %d-point, batch %d, VkFFT ready\n",
-            fft_size, batch_size);
+    fprintf(stderr, "GPU burst FFT: %d-point, batch %d x %d, VkFFT ready\n",
+            fft_size, batch_size, GPU_BURST_FFT_SLOTS);
     return g;
 
 err_bufs:
     fprintf(stderr, "OpenCL: buffer allocation error %d\n", err);
-    if (g->cl_input) clReleaseMemObject(g->cl_input);
-    if (g->cl_fft) clReleaseMemObject(g->cl_fft);
-    if (g->cl_magnitude) clReleaseMemObject(g->cl_magnitude);
-    if (g->cl_window) clReleaseMemObject(g->cl_window);
-    clReleaseKernel(g->kern_window);
-    clReleaseKernel(g->kern_magnitude);
-    clReleaseProgram(g->program);
-    clReleaseCommandQueue(g->queue);
-    clReleaseContext(g->context);
-    free(g);
+    gpu_burst_fft_destroy(g);
     return NULL;
 }
 
@@ -301,12 +316,19 @@ err_bufs:
 void gpu_burst_fft_destroy(gpu_burst_fft_t *g) {
     if (!g) return;
 
-    deleteVkFFT(&g->vkfft_app);
-
-    clReleaseMemObject(g->cl_input);
-    clReleaseMemObject(g->cl_fft);
-    clReleaseMemObject(g->cl_magnitude);
-    clReleaseMemObject(g->cl_window);
+    clFinish(g->queue);
+    if (g->vkfft_ready)
+        deleteVkFFT(&g->vkfft_app);
+
+    for (int i = 0; i < GPU_BURST_FFT_SLOTS; i++) {
+        burst_slot_t *sl = &g->slots[i];
+        if (sl->done) clReleaseEvent(sl->done);
+        if (sl->cl_input) clReleaseMemObject(sl->cl_input);
+        if (sl->cl_fft) clReleaseMemObject(sl->cl_fft);
+        if (sl->cl_magnitude) clReleaseMemObject(sl->cl_magnitude);
+        free(sl->magnitude);
+    }
+    if (g->cl_window) clReleaseMemObject(g->cl_window);
     clReleaseKernel(g->kern_window);
     clReleaseKernel(g->kern_magnitude);
     clReleaseProgram(g->program);
@@ -318,54 +340,253 @@ void gpu_burst_fft_destroy(gpu_burst_fft_t *g) {
 
 /* ---- Process batch ---- */
 
-int gpu_burst_fft_process(gpu_burst_fft_t *g, const float *input,
-                           float *output, int batch_count) {
+int gpu_burst_fft_submit(gpu_burst_fft_t *g, int slot,
+                          const float *const *frames, int batch_count) {
     cl_int err;
 
-    if (batch_count <= 0 || batch_count > g->batch_size)
+    if (batch_count <= 0 || batch_count > g->batch_size ||
+        slot < 0 || slot >= GPU_BURST_FFT_SLOTS || g->slots[slot].done)
         return -1;
 
-    size_t complex_bytes = (size_t)batch_count * g->fft_size * 2 * sizeof(float);
+    burst_slot_t *sl = &g->slots[slot];
+    size_t frame_bytes = (size_t)g->fft_size * 2 * sizeof(float);
     size_t mag_bytes = (size_t)batch_count * g->fft_size * sizeof(float);
     size_t work_items = (size_t)batch_count * g->fft_size;
 
-    /* 1. Upload input samples to GPU */
-    err = clEnqueueWriteBuffer(g->queue, g->cl_input, CL_FALSE, 0,
-                                complex_bytes, input, 0, NULL, NULL);
-    if (err != CL_SUCCESS) {
-        fprintf(stderr, "GPU: upload error %d\n", err);
-        return -1;
+    /* 1. Upload each frame straight from the caller's memory; the
+     * in-order queue runs the kernels after the writes */
+    for (int i = 0; i < batch_count; i++) {
+        err = clEnqueueWriteBuffer(g->queue, sl->cl_input, CL_FALSE,
+                                    i * frame_bytes, frame_bytes, frames[i],
+                                    0, NULL, NULL);
+        if (err != CL_SUCCESS) {
+            fprintf(stderr, "GPU: upload error %d\n", err);
+            goto err_queued;
+        }
     }
 
     /* 2. Window multiply kernel */
+    clSetKernelArg(g->kern_window, 0, sizeof(cl_mem), &sl->cl_input);
+    clSetKernelArg(g->kern_window, 2, sizeof(cl_mem), &sl->cl_fft);
     err = clEnqueueNDRangeKernel(g->queue, g->kern_window, 1, NULL,
                                   &work_items, NULL, 0, NULL, NULL);
     if (err != CL_SUCCESS) {
         fprintf(stderr, "GPU: window kernel error %d\n", err);
-        return -1;
+        goto err_queued;
     }
 
-    /* 3. VkFFT forward FFT (in-place on cl_fft) */
+    /* 3. VkFFT forward FFT (in-place on the slot's cl_fft) */
     VkFFTLaunchParams params = {};
     params.commandQueue = &g->queue;
+    params.buffer = &sl->cl_fft;
 
     VkFFTResult vk_res = VkFFTAppend(&g->vkfft_app, -1, &params);
     if (vk_res != VKFFT_SUCCESS) {
         fprintf(stderr, "GPU: VkFFT error %d\n", vk_res);
-        return -1;
+        goto err_queued;
     }
 
     /* 4. fftshift + magnitude kernel */
+    clSetKernelArg(g->kern_magnitude, 0, sizeof(cl_mem), &sl->cl_fft);
+    clSetKernelArg(g->kern_magnitude, 1, sizeof(cl_mem), &sl->cl_magnitude);
     err = clEnqueueNDRangeKernel(g->queue, g->kern_magnitude, 1, NULL,
                                   &work_items, NULL, 0, NULL, NULL);
     if (err != CL_SUCCESS) {
         fprintf(stderr, "GPU: magnitude kernel error %d\n", err);
+        goto err_queued;
+    }
+
+    /* 5. Download magnitude results; wait() blocks on the event */
+    err = clEnqueueReadBuffer(g->queue, sl->cl_magnitude, CL_FALSE, 0,
+                               mag_bytes, sl->magnitude, 0, NULL, &sl->done);
+    if (err != CL_SUCCESS) {
+        fprintf(stderr, "GPU: download error %d\n", err);
+        sl->done = 0;
+        goto err_queued;
+    }
+    clFlush(g->queue);
+
+    return 0;
+
+err_queued:
+    /* Let the writes already queued finish before the caller reuses
+     * the frames */
+    clFinish(g->queue);
+    return -1;
+}
+
+const float *gpu_burst_fft_wait(gpu_burst_fft_t *g, int slot) {
+    if (slot < 0 || slot >= GPU_BURST_FFT_SLOTS || !g->slots[slot].done)
+        return NULL;
+
+    burst_slot_t *sl = &g->slots[slot];
+    cl_int err = clWaitForEvents(1, &sl->done);
+    clReleaseEvent(sl->done);
+    sl->done = 0;
+    if (err != CL_SUCCESS) {
+        fprintf(stderr, "GPU: batch wait error %d\n", err);
+        return NULL;
+    }
+    return sl->magnitude;
+}
+
+/* ---- Batched downmix FFTs ---- */
+
+struct gpu_downmix_fft {
+    int cfo_size;
+    int corr_size;
+    int batch_size;
+
+    cl_device_id device;
+    cl_context context;
+    cl_command_queue queue;
+    cl_mem cl_data;         /* complex, max(batch * cfo, 2 * batch * corr) */
+
+    /* One app per shape, all on cl_data */
+    VkFFTApplication app_cfo;       /* cfo_size x batch */
+    VkFFTApplication app_corr;      /* corr_size x batch */
+    VkFFTApplication app_corr_inv;  /* corr_size x 2 * batch */
+    int n_apps;
+    uint64_t buffer_size;
+};
+
+static int downmix_app_init(gpu_downmix_fft_t *g, VkFFTApplication *app,
+                            int size, int batches) {
+    VkFFTConfiguration config = {};
+    config.FFTdim = 1;
+    config.size[0] = (uint64_t)size;
+    config.numberBatches = (uint64_t)batches;
+    config.device = &g->device;
+    config.context = &g->context;
+    config.commandQueue = &g->queue;
+    config.buffer = &g->cl_data;
+    config.bufferSize = &g->buffer_size;
+
+    VkFFTResult res = initializeVkFFT(app, config);
+    if (res != VKFFT_SUCCESS) {
+        fprintf(stderr, "VkFFT init error: %d (%d-point x %d)\n",
+                res, size, batches);
+        return -1;
+    }
+    g->n_apps++;
+    return 0;
+}
+
+gpu_downmix_fft_t *gpu_downmix_fft_create(int cfo_size, int corr_size,
+                                           int batch_size) {
+    cl_int err;
+
+    gpu_downmix_fft_t *g = calloc(1, sizeof(*g));
+    if (!g) return NULL;
+
+    g->cfo_size = cfo_size;
+    g->corr_size = corr_size;
+    g->batch_size = batch_size;
+
+    g->device = find_opencl_device();
+    if (!g->device) {
+        fprintf(stderr, "OpenCL: no device found\n");
+        free(g);
+        return NULL;
+    }
+
+    g->context = clCreateContext(NULL, 1, &g->device, NULL, NULL, &err);
+    if (err != CL_SUCCESS) {
+        fprintf(stderr, "OpenCL: create context error %d\n", err);
+        free(g);
+        return NULL;
+    }
+
+    g->queue = clCreateCommandQueue(g->context, g->device, 0, &err);
+    if (err != CL_SUCCESS) {
+        fprintf(stderr, "OpenCL: create queue error %d\n", err);
+        clReleaseContext(g->context);
+        free(g);
+        return NULL;
+    }
+
+    size_t cfo_elems = (size_t)batch_size * cfo_size;
+    size_t corr_elems = (size_t)2 * batch_size * corr_size;
+    g->buffer_size = (cfo_elems > corr_elems ? cfo_elems : corr_elems)
+                   * 2 * sizeof(float);
+
+    g->cl_data = clCreateBuffer(g->context, CL_MEM_READ_WRITE,
+                                 (size_t)g->buffer_size, NULL, &err);
+    if (err != CL_SUCCESS) {
+        fprintf(stderr, "OpenCL: buffer allocation error %d\n", err);
+        goto err_out;
+    }
+
+    if (downmix_app_init(g, &g->app_cfo, cfo_size, batch_size) != 0 ||
+        downmix_app_init(g, &g->app_corr, corr_size, batch_size) != 0 ||
+        downmix_app_init(g, &g->app_corr_inv, corr_size, 2 * batch_size) != 0)
+        goto err_out;
+
+    fprintf(stderr, "GPU downmix FFT: %d/%d-point, batch %d, VkFFT ready\n",
+            cfo_size, corr_size, batch_size);
+    return g;
+
+err_out:
+    gpu_downmix_fft_destroy(g);
+    return NULL;
+}
+
+void gpu_downmix_fft_destroy(gpu_downmix_fft_t *g) {
+    if (!g) return;
+
+    /* Apps are initialized in this order; release the ones that were */
+    if (g->n_apps > 0) deleteVkFFT(&g->app_cfo);
+    if (g->n_apps > 1) deleteVkFFT(&g->app_corr);
+    if (g->n_apps > 2) deleteVkFFT(&g->app_corr_inv);
+
+    if (g->cl_data) clReleaseMemObject(g->cl_data);
+    clReleaseCommandQueue(g->queue);
+    clReleaseContext(g->context);
+
+    free(g);
+}
+
+int gpu_downmix_fft_execute(gpu_downmix_fft_t *g, float *data, int size,
+                             int rows, int sign) {
+    cl_int err;
+    VkFFTApplication *app;
+    int max_rows;
+
+    if (sign > 0) {
+        app = &g->app_corr_inv;
+        max_rows = 2 * g->batch_size;
+    } else if (size == g->cfo_size) {
+        app = &g->app_cfo;
+        max_rows = g->batch_size;
+    } else {
+        app = &g->app_corr;
+        max_rows = g->batch_size;
+    }
+    if (rows <= 0 || rows > max_rows || (sign > 0 && size != g->corr_size))
+        return -1;
+
+    /* The app always transforms max_rows; rows past the batch are stale
+     * and never read back */
+    size_t bytes = (size_t)rows * size * 2 * sizeof(float);
+
+    err = clEnqueueWriteBuffer(g->queue, g->cl_data, CL_FALSE, 0,
+                                bytes, data, 0, NULL, NULL);
+    if (err != CL_SUCCESS) {
+        fprintf(stderr, "GPU: upload error %d\n", err);
+        return -1;
+    }
+
+    VkFFTLaunchParams params = {};
+    params.commandQueue = &g->queue;
+
+    VkFFTResult vk_res = VkFFTAppend(app, sign, &params);
+    if (vk_res != VKFFT_SUCCESS) {
+        fprintf(stderr, "GPU: VkFFT error %d\n", vk_res);
         return -1;
     }
 
-    /* 5. Download magnitude results */
-    err = clEnqueueReadBuffer(g->queue, g->cl_magnitude, CL_TRUE, 0,
-                               mag_bytes, output, 0, NULL, NULL);
+    err = clEnqueueReadBuffer(g->queue, g->cl_data, CL_TRUE, 0,
+                               bytes, data, 0, NULL, NULL);
     if (err != CL_SUCCESS) {
         fprintf(stderr, "GPU: download error %d\n", err);
         return -1;
@@ -18,7 +18,15 @@
  * Batches multiple FFT frames and processes them on GPU:
  *   window multiply -> forward FFT -> fftshift + magnitude squared
  *
- * CPU handles the burst state machine on the returned magnitudes.
+ * Each context has GPU_BURST_FFT_SLOTS independent batch slots, so one
+ * batch can be uploaded and transformed while the CPU runs the burst
+ * state machine on the magnitudes of the previous one. Frames are read
+ * from the caller's memory (the detector's ring buffer) without an
+ * intermediate copy.
+ *
+ * The same backends also provide the downmixer's batched FFT engine:
+ * plain in-place complex transforms over rows of one burst each (the
+ * fine CFO FFT and the sync word correlation), no pre/post kernels.
  */
 
 #ifndef __BURST_FFT_H__
@@ -28,6 +36,9 @@
 
 typedef struct gpu_burst_fft gpu_burst_fft_t;
 
+/* Batches that can be in flight at once */
+#define GPU_BURST_FFT_SLOTS 2
+
 /* Create GPU FFT context.
  * fft_size: FFT length (must be power of 2)
  * batch_size: max frames per GPU dispatch (e.g. 16)
@@ -38,13 +49,42 @@ gpu_burst_fft_t *gpu_burst_fft_create(int fft_size, int batch_size,
 /* Destroy GPU FFT context and release all resources. */
 void gpu_burst_fft_destroy(gpu_burst_fft_t *g);
 
-/* Process a batch of FFT frames on GPU.
- * input: batch_count * fft_size interleaved float pairs (re, im)
- * output: batch_count * fft_size floats (magnitude squared, DC-shifted)
+/* Start processing a batch in slot (0 .. GPU_BURST_FFT_SLOTS - 1).
+ * frames: batch_count pointers to fft_size interleaved float pairs
+ *         (re, im); they must stay valid and unchanged until
+ *         gpu_burst_fft_wait() on the same slot returns
  * batch_count: number of frames in this batch (<= batch_size)
+ * The slot must not have a batch in flight.
  * Returns 0 on success, -1 on error. */
-int gpu_burst_fft_process(gpu_burst_fft_t *g, const float *input,
-                           float *output, int batch_count);
+int gpu_burst_fft_submit(gpu_burst_fft_t *g, int slot,
+                          const float *const *frames, int batch_count);
+
+/* Wait for the batch in slot to finish.
+ * Returns batch_count * fft_size floats (magnitude squared, DC-shifted),
+ * valid until the slot's next submit, or NULL on error. */
+const float *gpu_burst_fft_wait(gpu_burst_fft_t *g, int slot);
+
+/* ---- Batched downmix FFTs ---- */
+
+typedef struct gpu_downmix_fft gpu_downmix_fft_t;
+
+/* Create the downmix FFT engine.
+ * cfo_size: fine CFO FFT length, batch_size rows
+ * corr_size: sync correlation FFT length, batch_size forward rows and
+ *            2 * batch_size inverse rows (DL and UL per burst)
+ * Both sizes must be powers of 2. */
+gpu_downmix_fft_t *gpu_downmix_fft_create(int cfo_size, int corr_size,
+                                           int batch_size);
+
+/* Destroy the engine and release all resources. */
+void gpu_downmix_fft_destroy(gpu_downmix_fft_t *g);
+
+/* Transform rows of size interleaved complex floats in place.
+ * size: cfo_size or corr_size from create
+ * sign: -1 forward, +1 inverse (unnormalized, as FFTW)
+ * Returns 0 on success, -1 on error (data is then left untouched). */
+int gpu_downmix_fft_execute(gpu_downmix_fft_t *g, float *data, int size,
+                             int rows, int sign);
 
 #endif /* USE_GPU */
 #endif /* __BURST_FFT_H__ */
@@ -29,6 +29,24 @@
 #include "soapysdr.h"
 #endif
 
+#include "band_plan.h"
+#include "bch_chase.h"
+#include "burst_extract.h"
+#include "burst_net.h"
+#include "burst_sched.h"
+#include "channelizer.h"
+#include "demod_pool.h"
+#include "frame_output.h"
+#include "ida_decode.h"
+#include "downmix_pool.h"
+#include "iridium.h"
+#include "net_input.h"
+#include "offline.h"
+#include "placement.h"
+#include "sdr.h"
+#include "shm_ring.h"
+#include "simd_kernels.h"
+
 typedef enum {
     FMT_CI8 = 0,
     FMT_CI16,
@@ -44,16 +62,10 @@ extern double threshold_db;
 extern iq_format_t iq_format;
 extern FILE *in_file;
 
-extern char *serial;
-#ifdef HAVE_BLADERF
-extern int bladerf_num;
-#endif
-#ifdef HAVE_UHD
-extern char *usrp_serial;
-#endif
+extern rx_spec_t rx_specs[SDR_MAX_RX];
+extern int n_rx;
+extern int dedup_ms;
 #ifdef HAVE_SOAPYSDR
-extern int soapy_num;
-extern char *soapy_args;
 #define SOAPY_SETTINGS_MAX 8
 extern char *soapy_setting_keys[SOAPY_SETTINGS_MAX];
 extern char *soapy_setting_vals[SOAPY_SETTINGS_MAX];
@@ -67,9 +79,45 @@ extern int bladerf_gain_val;
 extern int usrp_gain_val;
 extern double soapy_gain_val;
 extern int bias_tee;
+extern int sdr_buffers;
+extern int sdr_buffer_size;
 extern int use_gpu;
-extern int no_simd;
+extern int simd_impl;
+extern int downmix_workers;
+extern int downmix_workers_auto;
+extern int pin_workers;
+extern int huge_pages;
+extern int demod_workers;
+extern int demod_batch;
+extern int downmix_batch;
+extern int sync_corr;
+extern int fine_cfo;
+extern int input_fir;
+extern int detector_overlap;
+extern int noise_floor;
+extern band_plan_t *band_plan;
+extern int trim_bursts;
+extern double trim_margin_ms;
+extern int narrowband_rate;
+extern int ida_slots;
+extern int chase_bits;
+extern int channelize;
+extern int use_mmap;
+extern int offline_parallel;
+extern int stats_json;
+extern int output_flush_ms;
+extern int output_format;
+extern char *wisdom_path;
+extern int plan_only;
 extern char *save_bursts_dir;
+extern int burst_segment_mb;
+extern int burst_segments;
+extern char *replay_bursts_dir;
+extern char *burst_out;
+extern char *burst_in;
+extern int burst_queue_mb;
+extern int shed_order[];
+extern int n_shed_order;
 extern int web_enabled;
 extern int web_port;
 extern int gsmtap_enabled;
@@ -93,10 +141,13 @@ extern char *feed_tcp_host;
 extern int feed_tcp_port;
 extern int zmq_enabled;
 extern char *zmq_endpoint;
+extern char *shm_name;
+extern int shm_mb;
 
 static void usage(int exitcode) {
     fprintf(stderr,
-"Usage: iridium-sniffer <-f FILE | -i IFACE> [options]\n"
+"Usage: iridium-sniffer <-f FILE | -i IFACE | --replay-bursts=DIR |\n"
+"                        --burst-in=[ADDR:]PORT> [options]\n"
 "Standalone Iridium satellite burst detector and demodulator.\n"
 "Outputs iridium-toolkit compatible RAW format to stdout.\n"
 "\n"
@@ -104,14 +155,36 @@ static void usage(int exitcode) {
 "    -f, --file=FILE         read IQ samples from file\n"
 "    -l, --live              capture live from SDR (implied by -i)\n"
 "    --format=FMT            IQ file format: ci8 (default), ci16, cf32\n"
+"    --mmap                  map the input file instead of reading it; ci8\n"
+"                             and cf32 samples are used in place\n"
+"    --offline-parallel=N    split the file into N overlapping segments run\n"
+"                             by separate processes, output merged in order\n"
+"                             (implies --mmap)\n"
+"    --replay-bursts=DIR     demodulate the bursts archived in DIR by\n"
+"                             --save-bursts, skipping detection and downmix\n"
+"    --burst-in=[ADDR:]PORT  demodulate the bursts edge sniffers send with\n"
+"                             --burst-out (TCP, up to 16 edges at once)\n"
 "\n"
 "SDR options:\n"
 "    -i, --interface=IFACE   SDR to use (see --list for available devices):\n"
 "                             soapy-N (by index) or soapy:driver=X,serial=Y (by args)\n"
-"                             hackrf-SERIAL, bladerfN, usrp-PRODUCT-SERIAL\n"
-"    -c, --center-freq=HZ    center frequency in Hz (default: 1622000000)\n"
+"                             hackrf-SERIAL, bladerfN, usrp-PRODUCT-SERIAL;\n"
+"                             repeatable, with --net-input, up to 8 inputs\n"
+"    -c, --center-freq=HZ    center frequency in Hz (default: 1622000000);\n"
+"                             once for every input or once per input, in order\n"
 "    -r, --sample-rate=HZ    sample rate in Hz (default: 10000000)\n"
 "    -B, --bias-tee           enable bias tee power\n"
+"    --net-input=SPEC        take IQ from the network like an SDR (repeatable):\n"
+"                             udp://[ADDR:]PORT (ADDR may be a multicast group)\n"
+"                             or zmq://ENDPOINT (SUB); -r and -c must match\n"
+"                             the sender\n"
+"    --dedup-ms=MS           with several inputs, drop a frame another input\n"
+"                             decoded within MS ms on the same channel\n"
+"                             (0-1000, default: 40, 0 = keep all)\n"
+"    --sdr-buffers=N         driver stream buffers (2-1024, default: the\n"
+"                             backend's); more ride out stalls, fewer cut latency\n"
+"    --sdr-buffer-size=N     samples per driver buffer (1024-1048576, a\n"
+"                             multiple of 1024; default: the backend's)\n"
 "\n"
 "Gain options:\n"
 "    --hackrf-lna=GAIN       HackRF LNA gain in dB (default: 40)\n"
@@ -125,10 +198,75 @@ static void usage(int exitcode) {
 "\n"
 "Detection options:\n"
 "    -d, --threshold=DB      burst detection threshold in dB (default: 16.0)\n"
+"    --detector-overlap=PCT  overlap of the detector's FFT frames: 0 (default),\n"
+"                             50 or 75; finer burst timing and shorter\n"
+"                             extracted bursts for 2x or 4x the FFTs\n"
+"    --trim-bursts[=MS]      end each burst where its frame must have ended,\n"
+"                             plus MS ms (default: 1), instead of 16 ms\n"
+"                             past its last active frame\n"
+"    --noise-floor=MODE      detector noise floor history: full (default)\n"
+"                             keeps every frame; block keeps means of\n"
+"                             16 frames; ema keeps an exponential average\n"
+"                             (no history)\n"
+"    --channels=LIST         only detect bursts of these Iridium channels:\n"
+"                             simplex, duplex, N or N-M (0-251, 240 up are\n"
+"                             simplex), comma-separated; each reaches 37.5 kHz\n"
+"                             either side for Doppler. Counts bursts per channel\n"
+"    --narrowband[=RATE]     mix each burst to DC and decimate it to at least\n"
+"                             RATE Hz (default: 500000) in the detector thread,\n"
+"                             so the downmix gets small private buffers\n"
 #ifdef USE_GPU
 "    --no-gpu                disable GPU acceleration (use CPU FFTW)\n"
 #endif
 "    --no-simd               disable SIMD acceleration (use scalar kernels)\n"
+"    --simd=SET              kernel set: auto (default), generic, avx2,\n"
+"                             avx512, or neon\n"
+"    --workers=N|auto        downmix worker threads (default: 4); auto sizes\n"
+"                             the pool with load, up to one per spare CPU.\n"
+"                             Either form pins the detector to CPU 0 and the\n"
+"                             workers to the other CPUs (as --affinity=auto)\n"
+"    --affinity=SPEC         pin pipeline threads: auto, or ROLE:CPUS,... with\n"
+"                             ROLE input, detector, workers, demod or output\n"
+"                             and CPUS like 4, 4-15 or 2+6-7; the Nth thread\n"
+"                             of a role takes the Nth CPU, wrapping. Buffers\n"
+"                             are placed on the NUMA node of their thread\n"
+"    --huge-pages[=MODE]     back the detector ring and noise floor history\n"
+"                             with huge pages: thp (default, transparent) or\n"
+"                             explicit (hugetlbfs pool, thp if it is empty)\n"
+"    --downmix-batch=N       downmix up to N queued bursts per pass (2-64);\n"
+"                             GPU builds run the CFO and sync correlation\n"
+"                             FFTs of a batch as one GPU transform\n"
+"    --sync-corr=MODE        sync word search: auto (default) correlates\n"
+"                             directly at the lags the preamble lengths\n"
+"                             give, with the FFT search as fallback; fft\n"
+"                             always runs the FFT search; packed runs it\n"
+"                             with DL and UL in one inverse FFT\n"
+"    --fine-cfo=MODE         fine CFO estimate: fft (default) takes the peak\n"
+"                             of a 16x zero-padded FFT; zoom takes a short\n"
+"                             FFT and evaluates the same bins around its peak\n"
+"    --input-fir=MODE        first downmix decimation stage: float (default)\n"
+"                             or q15, which filters int8/int16 input in\n"
+"                             16-bit fixed point with frequency-shifted taps\n"
+"    --burst-queue-mb=MB     sample bytes the burst queue may hold between\n"
+"                             detector and downmix (1-65536, default: 256)\n"
+"    --shed-order=LIST       live capture sheds the least valuable queued\n"
+"                             burst when that queue is full, valued by\n"
+"                             simplex band, snr and short in the order given\n"
+"                             (default: simplex,snr,short)\n"
+"    --demod-workers=N       demod/decode worker threads (default: 2); output\n"
+"                             order is kept by a single sequencer thread\n"
+"    --demod-batch=N         demod up to N queued frames per worker pass\n"
+"                             with their PLLs side by side in SIMD lanes\n"
+"                             (1-16, default: 16; 1 = one frame at a time)\n"
+"    --channelize=K          split the band into K sub-bands (even, 2-16),\n"
+"                             each with its own detector thread\n"
+"    --stats-json            print the once-a-second stats as JSON, with\n"
+"                             per-stage timing, queue waits and latency,\n"
+"                             and a summary line (time, CPU, RSS) at exit\n"
+"    --wisdom=FILE|none      FFTW wisdom file (default: $IRIDIUM_SNIFFER_WISDOM,\n"
+"                             else ~/.iridium-sniffer-fftw-wisdom)\n"
+"    --plan-only             plan the FFTs for -r, --channelize and --workers,\n"
+"                             save the wisdom and exit (no input needed)\n"
 "\n"
 "Web map:\n"
 "    --web[=PORT]            enable live web map (default port: 8888)\n"
@@ -141,10 +279,21 @@ static void usage(int exitcode) {
 "\n"
 "Output options:\n"
 "    --file-info=STR         file info string for output (default: auto)\n"
-"    --save-bursts=DIR       save IQ samples of decoded bursts to directory\n"
+"    --save-bursts=DIR       archive IQ samples of demodulated bursts in DIR\n"
+"    --burst-segment-mb=MB   start a new archive segment after MB of samples\n"
+"                             (1-65536, default: 256)\n"
+"    --burst-segments=N      keep only the newest N archive segments\n"
+"                             (default: 0, keep all)\n"
 "    --diagnostic            setup verification mode (suppresses RAW output)\n"
 "    --no-gardner           disable Gardner timing recovery (enabled by default)\n"
+"    --chase-bits=K         least reliable bits searched when a BCH block does\n"
+"                             not decode (1-10, default: 5; 2^K candidates)\n"
 "    --parsed               output parsed IDA lines (pipe to reassembler.py)\n"
+"    --format-out=FMT        output format: raw (default), bin (binary records,\n"
+"                             see frame_bin.h) or bin-llr (bin with bit\n"
+"                             reliabilities); iridium-bin2raw converts back\n"
+"    --output-flush-ms=MS   batch output lines for up to MS ms (default: 100,\n"
+"                             0 = write each line; a terminal is never batched)\n"
 "    --acars               decode and display ACARS messages from IDA\n"
 "    --acars-json          output ACARS as JSON (compatible with acars.py)\n"
 "    --acars-udp=HOST:PORT stream ACARS JSON via UDP (repeatable, max 4)\n"
@@ -153,10 +302,20 @@ static void usage(int exitcode) {
 "                             tcp://HOST:PORT for airframes.io direct\n"
 "                             bare --feed defaults to tcp://feed.airframes.io:5590\n"
 "    --station=ID          station identifier for ACARS JSON output\n"
+"    --ida-slots=N         multi-burst IDA messages reassembled at once\n"
+"                             (default: 256), shared by GSMTAP, ACARS and --web\n"
 #ifdef HAVE_ZMQ
 "    --zmq[=ENDPOINT]     publish output via ZMQ PUB socket for multi-consumer\n"
 "                             (default: tcp://*:7006, compatible with iridium-toolkit)\n"
 #endif
+"    --shm[=NAME]          also write output to a shared-memory ring,\n"
+"                             /dev/shm/NAME (default: iridium-sniffer), that\n"
+"                             any number of local readers follow; readers\n"
+"                             that fall behind skip ahead, never slow it\n"
+"    --shm-mb=MB           ring size (1-1024, default: 16)\n"
+"    --burst-out=HOST:PORT send detected bursts to a --burst-in sniffer\n"
+"                             over TCP instead of demodulating them here\n"
+"                             (implies --narrowband)\n"
 "    -v, --verbose           verbose output to stderr\n"
 "    -h, --help              show this help\n"
 "    --list                  list available SDR interfaces\n"
@@ -183,10 +342,19 @@ static void list_interfaces(void) {
     exit(0);
 }
 
+/* Add an input for -i or --net-input */
+static void add_rx(rx_kind_t kind, char *arg, int num) {
+    if (n_rx == SDR_MAX_RX)
+        errx(1, "At most %d inputs (-i and --net-input) can be given", SDR_MAX_RX);
+    rx_specs[n_rx++] = (rx_spec_t){ .kind = kind, .arg = arg, .num = num };
+}
+
 void parse_options(int argc, char **argv) {
     int ch;
     int format_explicit = 0;
     const char *in_filename = NULL;
+    double center_freqs[SDR_MAX_RX];
+    int n_center_freqs = 0;
 
     enum {
         OPT_HACKRF_LNA = 0x100,
@@ -200,9 +368,12 @@ void parse_options(int argc, char **argv) {
         OPT_LIST,
         OPT_NO_GPU,
         OPT_NO_SIMD,
+        OPT_SIMD,
         OPT_WEB,
         OPT_GSMTAP,
         OPT_SAVE_BURSTS,
+        OPT_BURST_SEGMENT_MB,
+        OPT_BURST_SEGMENTS,
         OPT_DIAGNOSTIC,
         OPT_GARDNER,
         OPT_NO_GARDNER,
@@ -215,6 +386,41 @@ void parse_options(int argc, char **argv) {
         OPT_STATION,
         OPT_SOAPY_SETTING,
         OPT_ZMQ,
+        OPT_SHM,
+        OPT_SHM_MB,
+        OPT_WORKERS,
+        OPT_AFFINITY,
+        OPT_HUGE_PAGES,
+        OPT_DEMOD_WORKERS,
+        OPT_BURST_QUEUE_MB,
+        OPT_SHED_ORDER,
+        OPT_DEMOD_BATCH,
+        OPT_DOWNMIX_BATCH,
+        OPT_SYNC_CORR,
+        OPT_FINE_CFO,
+        OPT_INPUT_FIR,
+        OPT_DETECTOR_OVERLAP,
+        OPT_TRIM_BURSTS,
+        OPT_NOISE_FLOOR,
+        OPT_CHANNELS,
+        OPT_NARROWBAND,
+        OPT_CHANNELIZE,
+        OPT_MMAP,
+        OPT_OFFLINE_PARALLEL,
+        OPT_REPLAY_BURSTS,
+        OPT_BURST_OUT,
+        OPT_BURST_IN,
+        OPT_STATS_JSON,
+        OPT_OUTPUT_FLUSH_MS,
+        OPT_IDA_SLOTS,
+        OPT_CHASE_BITS,
+        OPT_FORMAT_OUT,
+        OPT_WISDOM,
+        OPT_PLAN_ONLY,
+        OPT_SDR_BUFFERS,
+        OPT_NET_INPUT,
+        OPT_SDR_BUFFER_SIZE,
+        OPT_DEDUP_MS,
     };
 
     static const struct option longopts[] = {
@@ -238,9 +444,12 @@ void parse_options(int argc, char **argv) {
         { "soapy-gain",     required_argument, NULL, OPT_SOAPY_GAIN },
         { "no-gpu",         no_argument,       NULL, OPT_NO_GPU },
         { "no-simd",        no_argument,       NULL, OPT_NO_SIMD },
+        { "simd",           required_argument, NULL, OPT_SIMD },
         { "web",            optional_argument, NULL, OPT_WEB },
         { "gsmtap",         optional_argument, NULL, OPT_GSMTAP },
         { "save-bursts",    required_argument, NULL, OPT_SAVE_BURSTS },
+        { "burst-segment-mb", required_argument, NULL, OPT_BURST_SEGMENT_MB },
+        { "burst-segments", required_argument, NULL, OPT_BURST_SEGMENTS },
         { "diagnostic",     no_argument,       NULL, OPT_DIAGNOSTIC },
         { "gardner",        no_argument,       NULL, OPT_GARDNER },
         { "no-gardner",     no_argument,       NULL, OPT_NO_GARDNER },
@@ -253,6 +462,41 @@ void parse_options(int argc, char **argv) {
         { "station",        required_argument, NULL, OPT_STATION },
         { "soapy-setting",  required_argument, NULL, OPT_SOAPY_SETTING },
         { "zmq",            optional_argument, NULL, OPT_ZMQ },
+        { "shm",            optional_argument, NULL, OPT_SHM },
+        { "shm-mb",         required_argument, NULL, OPT_SHM_MB },
+        { "workers",        required_argument, NULL, OPT_WORKERS },
+        { "affinity",       required_argument, NULL, OPT_AFFINITY },
+        { "huge-pages",     optional_argument, NULL, OPT_HUGE_PAGES },
+        { "downmix-batch",  required_argument, NULL, OPT_DOWNMIX_BATCH },
+        { "sync-corr",      required_argument, NULL, OPT_SYNC_CORR },
+        { "fine-cfo",       required_argument, NULL, OPT_FINE_CFO },
+        { "input-fir",      required_argument, NULL, OPT_INPUT_FIR },
+        { "detector-overlap", required_argument, NULL, OPT_DETECTOR_OVERLAP },
+        { "trim-bursts",    optional_argument, NULL, OPT_TRIM_BURSTS },
+        { "noise-floor",    required_argument, NULL, OPT_NOISE_FLOOR },
+        { "channels",       required_argument, NULL, OPT_CHANNELS },
+        { "narrowband",     optional_argument, NULL, OPT_NARROWBAND },
+        { "demod-workers",  required_argument, NULL, OPT_DEMOD_WORKERS },
+        { "burst-queue-mb", required_argument, NULL, OPT_BURST_QUEUE_MB },
+        { "shed-order",     required_argument, NULL, OPT_SHED_ORDER },
+        { "demod-batch",    required_argument, NULL, OPT_DEMOD_BATCH },
+        { "channelize",     required_argument, NULL, OPT_CHANNELIZE },
+        { "mmap",           no_argument,       NULL, OPT_MMAP },
+        { "offline-parallel", required_argument, NULL, OPT_OFFLINE_PARALLEL },
+        { "replay-bursts",  required_argument, NULL, OPT_REPLAY_BURSTS },
+        { "burst-out",      required_argument, NULL, OPT_BURST_OUT },
+        { "burst-in",       required_argument, NULL, OPT_BURST_IN },
+        { "stats-json",     no_argument,       NULL, OPT_STATS_JSON },
+        { "output-flush-ms", required_argument, NULL, OPT_OUTPUT_FLUSH_MS },
+        { "ida-slots",      required_argument, NULL, OPT_IDA_SLOTS },
+        { "chase-bits",     required_argument, NULL, OPT_CHASE_BITS },
+        { "format-out",     required_argument, NULL, OPT_FORMAT_OUT },
+        { "wisdom",         required_argument, NULL, OPT_WISDOM },
+        { "plan-only",      no_argument,       NULL, OPT_PLAN_ONLY },
+        { "sdr-buffers",    required_argument, NULL, OPT_SDR_BUFFERS },
+        { "net-input",      required_argument, NULL, OPT_NET_INPUT },
+        { "sdr-buffer-size", required_argument, NULL, OPT_SDR_BUFFER_SIZE },
+        { "dedup-ms",       required_argument, NULL, OPT_DEDUP_MS },
         { NULL,             0,                 NULL, 0 }
     };
 
@@ -272,29 +516,29 @@ void parse_options(int argc, char **argv) {
             case 'i':
 #ifdef HAVE_HACKRF
                 if (strstr(optarg, "hackrf-") == optarg) {
-                    serial = strdup(optarg + 7);
+                    add_rx(RX_HACKRF, strdup(optarg + 7), -1);
                     break;
                 }
 #endif
 #ifdef HAVE_BLADERF
                 if (strstr(optarg, "bladerf") == optarg) {
-                    bladerf_num = atoi(optarg + 7);
+                    add_rx(RX_BLADERF, NULL, atoi(optarg + 7));
                     break;
                 }
 #endif
 #ifdef HAVE_UHD
                 if (strstr(optarg, "usrp-") == optarg) {
-                    usrp_serial = strdup(usrp_get_serial(optarg));
+                    add_rx(RX_USRP, strdup(usrp_get_serial(optarg)), -1);
                     break;
                 }
 #endif
 #ifdef HAVE_SOAPYSDR
                 if (strstr(optarg, "soapy:") == optarg) {
-                    soapy_args = strdup(optarg + 6);
+                    add_rx(RX_SOAPY, strdup(optarg + 6), -1);
                     break;
                 }
                 if (strstr(optarg, "soapy-") == optarg) {
-                    soapy_num = atoi(optarg + 6);
+                    add_rx(RX_SOAPY, NULL, atoi(optarg + 6));
                     break;
                 }
 #endif
@@ -302,7 +546,9 @@ void parse_options(int argc, char **argv) {
                 break;
 
             case 'c':
-                center_freq = atof(optarg);
+                if (n_center_freqs == SDR_MAX_RX)
+                    errx(1, "-c can be given at most %d times", SDR_MAX_RX);
+                center_freqs[n_center_freqs++] = atof(optarg);
                 break;
 
             case 'r':
@@ -313,6 +559,36 @@ void parse_options(int argc, char **argv) {
                 bias_tee = 1;
                 break;
 
+            case OPT_NET_INPUT:
+                if (net_input_parse(optarg) != 0)
+                    errx(1, "--net-input must be udp://[ADDR:]PORT"
+#ifdef HAVE_ZMQ
+                         " or zmq://ENDPOINT"
+#endif
+                         " (got '%s')", optarg);
+                add_rx(RX_NET, optarg, -1);
+                break;
+
+            case OPT_DEDUP_MS:
+                dedup_ms = atoi(optarg);
+                if (dedup_ms < 0 || dedup_ms > 1000)
+                    errx(1, "--dedup-ms must be 0-1000 (got '%s')", optarg);
+                break;
+
+            case OPT_SDR_BUFFERS:
+                sdr_buffers = atoi(optarg);
+                if (sdr_buffers < 2 || sdr_buffers > 1024)
+                    errx(1, "--sdr-buffers must be 2-1024 (got '%s')", optarg);
+                break;
+
+            case OPT_SDR_BUFFER_SIZE:
+                sdr_buffer_size = atoi(optarg);
+                if (sdr_buffer_size < 1024 || sdr_buffer_size > 1048576 ||
+                        sdr_buffer_size % 1024 != 0)
+                    errx(1, "--sdr-buffer-size must be a multiple of 1024 "
+                         "from 1024 to 1048576 (got '%s')", optarg);
+                break;
+
             case 'd':
                 threshold_db = atof(optarg);
                 break;
@@ -348,7 +624,14 @@ void parse_options(int argc, char **argv) {
             case OPT_USRP_GAIN:   usrp_gain_val    = atoi(optarg); break;
             case OPT_SOAPY_GAIN:  soapy_gain_val   = atof(optarg); break;
             case OPT_NO_GPU:      use_gpu = 0;                       break;
-            case OPT_NO_SIMD:     no_simd = 1;                       break;
+            case OPT_NO_SIMD:     simd_impl = SIMD_GENERIC;          break;
+            case OPT_SIMD:
+                simd_impl = simd_parse_impl(optarg);
+                if (simd_impl < 0)
+                    errx(1, "Unknown SIMD set '%s'. Use auto, generic, avx2, avx512, or neon.", optarg);
+                if (!simd_supported(simd_impl))
+                    errx(1, "--simd=%s is not supported by this build or CPU", optarg);
+                break;
             case OPT_WEB:
                 web_enabled = 1;
                 if (optarg) web_port = atoi(optarg);
@@ -372,6 +655,18 @@ void parse_options(int argc, char **argv) {
                 save_bursts_dir = strdup(optarg);
                 break;
 
+            case OPT_BURST_SEGMENT_MB:
+                burst_segment_mb = atoi(optarg);
+                if (burst_segment_mb < 1 || burst_segment_mb > 65536)
+                    errx(1, "--burst-segment-mb must be 1-65536 (got '%s')", optarg);
+                break;
+
+            case OPT_BURST_SEGMENTS:
+                burst_segments = atoi(optarg);
+                if (burst_segments < 0)
+                    errx(1, "--burst-segments must be 0 or more (got '%s')", optarg);
+                break;
+
             case OPT_DIAGNOSTIC:
                 diagnostic_mode = 1;
                 break;
@@ -478,6 +773,244 @@ void parse_options(int argc, char **argv) {
 #endif
                 break;
 
+            case OPT_SHM:
+                shm_name = strdup(optarg ? optarg : SHM_RING_DEFAULT_NAME);
+                if (!shm_name[0] || strchr(shm_name + 1, '/'))
+                    errx(1, "--shm name must be non-empty and contain no '/' (got '%s')",
+                         shm_name);
+                break;
+
+            case OPT_SHM_MB:
+                shm_mb = atoi(optarg);
+                if (shm_mb < 1 || shm_mb > 1024)
+                    errx(1, "--shm-mb must be 1-1024 (got '%s')", optarg);
+                break;
+
+            case OPT_WORKERS:
+                pin_workers = 1;
+                if (strcmp(optarg, "auto") == 0) {
+                    downmix_workers_auto = 1;
+                } else {
+                    downmix_workers = atoi(optarg);
+                    if (downmix_workers < 1 || downmix_workers > DOWNMIX_POOL_MAX)
+                        errx(1, "--workers must be 1-%d or auto (got '%s')",
+                             DOWNMIX_POOL_MAX, optarg);
+                }
+                break;
+
+            case OPT_AFFINITY:
+                if (placement_parse(optarg) != 0)
+                    errx(1, "--affinity must be auto or ROLE:CPUS,... with "
+                         "online CPUs (got '%s')", optarg);
+                break;
+
+            case OPT_HUGE_PAGES:
+                if (!optarg || strcmp(optarg, "thp") == 0)
+                    huge_pages = HUGE_PAGES_THP;
+                else if (strcmp(optarg, "explicit") == 0)
+                    huge_pages = HUGE_PAGES_EXPLICIT;
+                else
+                    errx(1, "--huge-pages must be thp or explicit (got '%s')",
+                         optarg);
+                break;
+
+            case OPT_DOWNMIX_BATCH:
+                downmix_batch = atoi(optarg);
+                if (downmix_batch < 2 || downmix_batch > DOWNMIX_BATCH_MAX)
+                    errx(1, "--downmix-batch must be 2-%d (got '%s')",
+                         DOWNMIX_BATCH_MAX, optarg);
+                break;
+
+            case OPT_SYNC_CORR:
+                if (strcmp(optarg, "auto") == 0)
+                    sync_corr = SYNC_CORR_AUTO;
+                else if (strcmp(optarg, "fft") == 0)
+                    sync_corr = SYNC_CORR_FFT;
+                else if (strcmp(optarg, "packed") == 0)
+                    sync_corr = SYNC_CORR_PACKED;
+                else
+                    errx(1, "--sync-corr must be auto, fft or packed (got '%s')",
+                         optarg);
+                break;
+
+            case OPT_FINE_CFO:
+                if (strcmp(optarg, "fft") == 0)
+                    fine_cfo = FINE_CFO_FFT;
+                else if (strcmp(optarg, "zoom") == 0)
+                    fine_cfo = FINE_CFO_ZOOM;
+                else
+                    errx(1, "--fine-cfo must be fft or zoom (got '%s')", optarg);
+                break;
+
+            case OPT_INPUT_FIR:
+                if (strcmp(optarg, "float") == 0)
+                    input_fir = INPUT_FIR_FLOAT;
+                else if (strcmp(optarg, "q15") == 0)
+                    input_fir = INPUT_FIR_Q15;
+                else
+                    errx(1, "--input-fir must be float or q15 (got '%s')", optarg);
+                break;
+
+            case OPT_NOISE_FLOOR:
+                if (strcmp(optarg, "full") == 0)
+                    noise_floor = NOISE_FLOOR_FULL;
+                else if (strcmp(optarg, "block") == 0)
+                    noise_floor = NOISE_FLOOR_BLOCK;
+                else if (strcmp(optarg, "ema") == 0)
+                    noise_floor = NOISE_FLOOR_EMA;
+                else
+                    errx(1, "--noise-floor must be full, block or ema (got '%s')",
+                         optarg);
+                break;
+
+            case OPT_CHANNELS:
+                band_plan = band_plan_parse(optarg);
+                if (!band_plan)
+                    errx(1, "--channels must be simplex, duplex, N or N-M "
+                         "(0-%d), comma-separated (got '%s')",
+                         IR_CHANNELS - 1, optarg);
+                break;
+
+            case OPT_DETECTOR_OVERLAP: {
+                int pct = atoi(optarg);
+                if (pct == 0)
+                    detector_overlap = 1;
+                else if (pct == 50)
+                    detector_overlap = 2;
+                else if (pct == 75)
+                    detector_overlap = 4;
+                else
+                    errx(1, "--detector-overlap must be 0, 50 or 75 (got '%s')",
+                         optarg);
+                break;
+            }
+
+            case OPT_TRIM_BURSTS:
+                trim_bursts = 1;
+                if (optarg) {
+                    trim_margin_ms = atof(optarg);
+                    if (trim_margin_ms <= 0 || trim_margin_ms > IR_BURST_POST_MS)
+                        errx(1, "--trim-bursts margin must be above 0 and at most %d ms (got '%s')",
+                             IR_BURST_POST_MS, optarg);
+                }
+                break;
+
+            case OPT_NARROWBAND:
+                narrowband_rate = BURST_EXTRACT_DEFAULT_RATE;
+                if (optarg) {
+                    narrowband_rate = atoi(optarg);
+                    if (narrowband_rate < BURST_EXTRACT_DEFAULT_RATE)
+                        errx(1, "--narrowband rate must be at least %d Hz (got '%s')",
+                             BURST_EXTRACT_DEFAULT_RATE, optarg);
+                }
+                break;
+
+            case OPT_BURST_QUEUE_MB:
+                burst_queue_mb = atoi(optarg);
+                if (burst_queue_mb < 1 || burst_queue_mb > 65536)
+                    errx(1, "--burst-queue-mb must be 1-65536 (got '%s')", optarg);
+                break;
+
+            case OPT_SHED_ORDER:
+                n_shed_order = burst_sched_parse_order(optarg, shed_order);
+                if (n_shed_order < 0)
+                    errx(1, "--shed-order must list simplex, snr and short, "
+                         "each at most once (got '%s')", optarg);
+                break;
+
+            case OPT_DEMOD_WORKERS:
+                demod_workers = atoi(optarg);
+                if (demod_workers < 1 || demod_workers > DEMOD_POOL_MAX)
+                    errx(1, "--demod-workers must be 1-%d (got '%s')",
+                         DEMOD_POOL_MAX, optarg);
+                break;
+
+            case OPT_DEMOD_BATCH:
+                demod_batch = atoi(optarg);
+                if (demod_batch < 1 || demod_batch > QPSK_BATCH_MAX)
+                    errx(1, "--demod-batch must be 1-%d (got '%s')",
+                         QPSK_BATCH_MAX, optarg);
+                break;
+
+            case OPT_CHANNELIZE:
+                channelize = atoi(optarg);
+                if (channelize < 2 || channelize > CHANNELIZER_MAX ||
+                    channelize % 2)
+                    errx(1, "--channelize must be an even number 2-%d (got '%s')",
+                         CHANNELIZER_MAX, optarg);
+                break;
+
+            case OPT_STATS_JSON:
+                stats_json = 1;
+                break;
+
+            case OPT_FORMAT_OUT:
+                if (strcmp(optarg, "raw") == 0)
+                    output_format = OUTFMT_RAW;
+                else if (strcmp(optarg, "bin") == 0)
+                    output_format = OUTFMT_BIN;
+                else if (strcmp(optarg, "bin-llr") == 0)
+                    output_format = OUTFMT_BIN_LLR;
+                else
+                    errx(1, "Unknown output format '%s'. Use raw, bin, or bin-llr.", optarg);
+                break;
+
+            case OPT_WISDOM:
+                wisdom_path = optarg;
+                break;
+
+            case OPT_PLAN_ONLY:
+                plan_only = 1;
+                break;
+
+            case OPT_OUTPUT_FLUSH_MS:
+                output_flush_ms = atoi(optarg);
+                if (output_flush_ms < 0 || output_flush_ms > 10000)
+                    errx(1, "--output-flush-ms must be 0-10000 (got '%s')", optarg);
+                break;
+
+            case OPT_IDA_SLOTS:
+                ida_slots = atoi(optarg);
+                if (ida_slots < 1 || ida_slots > IDA_REASSEMBLY_MAX)
+                    errx(1, "--ida-slots must be 1-%d (got '%s')",
+                         IDA_REASSEMBLY_MAX, optarg);
+                break;
+
+            case OPT_CHASE_BITS:
+                chase_bits = atoi(optarg);
+                if (chase_bits < 1 || chase_bits > CHASE_MAX_BITS)
+                    errx(1, "--chase-bits must be 1-%d (got '%s')",
+                         CHASE_MAX_BITS, optarg);
+                break;
+
+            case OPT_MMAP:
+                use_mmap = 1;
+                break;
+
+            case OPT_OFFLINE_PARALLEL:
+                offline_parallel = atoi(optarg);
+                if (offline_parallel < 1 || offline_parallel > OFFLINE_PARALLEL_MAX)
+                    errx(1, "--offline-parallel must be 1-%d (got '%s')",
+                         OFFLINE_PARALLEL_MAX, optarg);
+                use_mmap = 1;
+                break;
+
+            case OPT_REPLAY_BURSTS:
+                replay_bursts_dir = strdup(optarg);
+                break;
+
+            case OPT_BURST_OUT:
+                if (burst_net_parse(optarg, 0) != 0)
+                    errx(1, "--burst-out must be HOST:PORT (got '%s')", optarg);
+                burst_out = strdup(optarg);
+                break;
+
+            case OPT_BURST_IN:
+                if (burst_net_parse(optarg, 1) != 0)
+                    errx(1, "--burst-in must be [ADDR:]PORT (got '%s')", optarg);
+                burst_in = strdup(optarg);
+                break;
+
             case OPT_SOAPY_SETTING:
 #ifdef HAVE_SOAPYSDR
                 if (soapy_setting_count >= SOAPY_SETTINGS_MAX)
@@ -509,26 +1042,64 @@ void parse_options(int argc, char **argv) {
         }
     }
 
-    /* -i implies live capture */
-    if (serial
-#ifdef HAVE_BLADERF
-        || bladerf_num >= 0
-#endif
-#ifdef HAVE_UHD
-        || usrp_serial
-#endif
-#ifdef HAVE_SOAPYSDR
-        || soapy_num >= 0 || soapy_args
-#endif
-    )
+    /* -i implies live capture; the network input stands in for an SDR */
+    if (n_rx)
         live = 1;
 
-    if (!live && in_file == NULL)
+    /* -c given once tunes every input, else each in the order given */
+    if (n_center_freqs > 1 && n_center_freqs != n_rx)
+        errx(1, "-c must be given once or once per input "
+             "(got %d for %d inputs)", n_center_freqs, n_rx);
+    if (n_center_freqs)
+        center_freq = center_freqs[0];
+    for (int k = 0; k < n_rx; k++)
+        rx_specs[k].center_freq = n_center_freqs > 1 ? center_freqs[k]
+                                                     : center_freq;
+
+    if (channelize && n_rx > 1)
+        errx(1, "--channelize cannot be combined with several inputs");
+
+    /* --plan-only accepts the usual command line, input and all */
+    if (!live && in_file == NULL && !replay_bursts_dir && !burst_in && !plan_only)
         usage(1);
 
     if (live && in_file != NULL)
         errx(1, "Cannot use both --live and --file");
 
+    if (replay_bursts_dir && (live || in_file != NULL))
+        errx(1, "--replay-bursts cannot be combined with --file or --live");
+
+    if (replay_bursts_dir && save_bursts_dir &&
+        strcmp(replay_bursts_dir, save_bursts_dir) == 0)
+        errx(1, "--save-bursts must name another directory than --replay-bursts");
+
+    if (burst_in && (live || in_file != NULL || replay_bursts_dir))
+        errx(1, "--burst-in cannot be combined with --file, --live or --replay-bursts");
+
+    /* An edge only detects: everything after the burst queue is central */
+    if (burst_out && (burst_in || replay_bursts_dir))
+        errx(1, "--burst-out needs --file or --live input");
+    if (burst_out && save_bursts_dir)
+        errx(1, "--save-bursts belongs on the --burst-in side of --burst-out");
+    if (burst_out && !narrowband_rate)
+        narrowband_rate = BURST_EXTRACT_DEFAULT_RATE;
+
+    if (plan_only && offline_parallel)
+        errx(1, "--plan-only cannot be combined with --offline-parallel");
+
+    if ((live || replay_bursts_dir || burst_in) && (use_mmap || offline_parallel))
+        errx(1, "--mmap and --offline-parallel need file input");
+
+    /* Workers each run a full pipeline; anything that binds a port or
+     * needs every frame in one process cannot be split */
+    if (offline_parallel > 1 && (web_enabled || position_enabled || zmq_enabled ||
+                                 shm_name || burst_out))
+        errx(1, "--offline-parallel cannot be combined with --web, --position, --zmq, "
+             "--shm or --burst-out");
+
+    if (output_format != OUTFMT_RAW && parsed_mode)
+        errx(1, "--format-out=bin cannot be combined with --parsed");
+
     /* Auto-detect format from file extension if not explicitly specified */
     if (in_filename && !format_explicit) {
         const char *ext = strrchr(in_filename, '.');
@@ -546,6 +1117,22 @@ void parse_options(int argc, char **argv) {
     if (samp_rate <= 0)
         errx(1, "Invalid sample rate: %.0f", samp_rate);
 
-    if (center_freq <= 0)
-        errx(1, "Invalid center frequency: %.0f", center_freq);
+    if (channelize && (long)samp_rate % (channelize / 2))
+        errx(1, "--channelize=%d needs a sample rate divisible by %d",
+             channelize, channelize / 2);
+
+    for (int k = 0; k < n_center_freqs; k++)
+        if (center_freqs[k] <= 0)
+            errx(1, "Invalid center frequency: %.0f", center_freqs[k]);
+
+    /* A detector whose band holds no planned channel would find nothing */
+    if (band_plan && !replay_bursts_dir && !burst_in) {
+        for (int k = 0; k < (n_rx ? n_rx : 1); k++) {
+            double c = n_rx ? rx_specs[k].center_freq : center_freq;
+            if (!band_plan_covers_range(band_plan, c - samp_rate / 2,
+                                        c + samp_rate / 2))
+                errx(1, "--channels: no planned channel lies in %.0f-%.0f Hz",
+                     c - samp_rate / 2, c + samp_rate / 2);
+        }
+    }
 }
@@ -0,0 +1,306 @@
+/*
+ * Output writer
+ *
+ * Double-buffered line output: the producer appends to one buffer while
+ * a writer thread drains the other with writev() and, for ZMQ, one
+ * multipart message per buffer, and copies --shm lines into the ring.
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Output writer
+ *
+ * Buffers are filled and written strictly alternately, so output order is
+ * put order. A buffer is handed to the writer when the next line does not
+ * fit, when its first line is flush_ms old, or on output_writer_flush().
+ * The producer only blocks when it needs a buffer and both are waiting to
+ * be written. Write errors (e.g. a closed pipe) are ignored, as they were
+ * with stdio.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef HAVE_ZMQ
+#include <zmq.h>
+#endif
+
+#include "output_writer.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+#define OUTPUT_BUF_SIZE     (256 * 1024)
+#define OUTPUT_BUF_LINES    4096
+
+typedef struct {
+    uint32_t off;
+    uint32_t len;
+    int dest;
+} out_line_t;
+
+typedef struct {
+    char data[OUTPUT_BUF_SIZE];
+    size_t used;
+    out_line_t lines[OUTPUT_BUF_LINES];
+    int n_lines;
+    uint64_t first_ns;      /* when the first line went in */
+} out_buf_t;
+
+static out_buf_t bufs[2];
+static int fill_idx = 0;        /* buffer being filled */
+static int write_idx = 0;       /* next buffer the writer will drain */
+static int pending[2];          /* handed to the writer, not yet written */
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t writer;
+static int started = 0;
+static int stopping = 0;
+static int write_through = 1;
+static int flush_ms = 0;
+static void *zmq_sock = NULL;
+static shm_ring_t *shm_ring = NULL;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ---- Sinks ---- */
+
+/* writev() until everything is out, resuming after short writes */
+static void write_all(struct iovec *iov, int n) {
+    while (n > 0) {
+        ssize_t r = writev(STDOUT_FILENO, iov, n > IOV_MAX ? IOV_MAX : n);
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        while (n > 0 && (size_t)r >= iov->iov_len) {
+            r -= iov->iov_len;
+            iov++;
+            n--;
+        }
+        if (n > 0) {
+            iov->iov_base = (char *)iov->iov_base + r;
+            iov->iov_len -= r;
+        }
+    }
+}
+
+static void zmq_publish(const char *line, size_t len, int dest, int more) {
+#ifdef HAVE_ZMQ
+    /* ZMQ messages are framed, strip trailing newline */
+    if (!(dest & OUTPUT_BINARY) && len > 0 && line[len - 1] == '\n')
+        len--;
+    zmq_send(zmq_sock, line, len, more ? ZMQ_SNDMORE : 0);
+#else
+    (void)line; (void)len; (void)dest; (void)more;
+#endif
+}
+
+/* Write one buffer: consecutive stdout lines are merged into one iovec,
+ * and the ZMQ lines go out as the parts of a single message */
+static void emit_buf(out_buf_t *b) {
+    static struct iovec iov[OUTPUT_BUF_LINES];
+    int n_iov = 0;
+    int last_zmq = -1;
+
+    for (int i = 0; i < b->n_lines; i++) {
+        out_line_t *l = &b->lines[i];
+        if (l->dest & OUTPUT_ZMQ)
+            last_zmq = i;
+        if (!(l->dest & OUTPUT_STDOUT))
+            continue;
+        char *p = b->data + l->off;
+        if (n_iov > 0 &&
+            (char *)iov[n_iov - 1].iov_base + iov[n_iov - 1].iov_len == p) {
+            iov[n_iov - 1].iov_len += l->len;
+        } else {
+            iov[n_iov].iov_base = p;
+            iov[n_iov].iov_len = l->len;
+            n_iov++;
+        }
+    }
+    write_all(iov, n_iov);
+
+    if (zmq_sock) {
+        for (int i = 0; i <= last_zmq; i++) {
+            out_line_t *l = &b->lines[i];
+            if (l->dest & OUTPUT_ZMQ)
+                zmq_publish(b->data + l->off, l->len, l->dest, i < last_zmq);
+        }
+    }
+
+    if (shm_ring) {
+        for (int i = 0; i < b->n_lines; i++) {
+            out_line_t *l = &b->lines[i];
+            if (l->dest & OUTPUT_SHM)
+                shm_ring_write(shm_ring, b->data + l->off, l->len);
+        }
+    }
+
+    b->used = 0;
+    b->n_lines = 0;
+}
+
+/* ---- Buffer hand-off (caller holds lock) ---- */
+
+/* Give the fill buffer to the writer once the other one is free */
+static void hand_off(void) {
+    while (pending[fill_idx ^ 1])
+        pthread_cond_wait(&done_cond, &lock);
+    pending[fill_idx] = 1;
+    fill_idx ^= 1;
+    pthread_cond_signal(&work_cond);
+}
+
+/* ---- Writer thread ---- */
+
+static void *writer_thread(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&lock);
+    while (1) {
+        if (pending[write_idx]) {
+            out_buf_t *b = &bufs[write_idx];
+            pthread_mutex_unlock(&lock);
+            emit_buf(b);
+            pthread_mutex_lock(&lock);
+            pending[write_idx] = 0;
+            write_idx ^= 1;
+            pthread_cond_broadcast(&done_cond);
+            continue;
+        }
+
+        out_buf_t *cur = &bufs[fill_idx];
+        if (cur->n_lines == 0) {
+            if (stopping)
+                break;
+            pthread_cond_wait(&work_cond, &lock);
+            continue;
+        }
+
+        /* Nothing pending, so the other buffer is free here */
+        uint64_t deadline = cur->first_ns + (uint64_t)flush_ms * 1000000ULL;
+        if (stopping || now_ns() >= deadline) {
+            pending[fill_idx] = 1;
+            fill_idx ^= 1;
+            continue;
+        }
+
+        /* now_ns() is CLOCK_MONOTONIC; the condvar waits on
+         * CLOCK_REALTIME, so convert the remaining time */
+        uint64_t wait_ns = deadline - now_ns();
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        uint64_t abs_ns = (uint64_t)ts.tv_sec * 1000000000ULL
+                        + (uint64_t)ts.tv_nsec + wait_ns;
+        ts.tv_sec = (time_t)(abs_ns / 1000000000ULL);
+        ts.tv_nsec = (long)(abs_ns % 1000000000ULL);
+        pthread_cond_timedwait(&work_cond, &lock, &ts);
+    }
+    pthread_mutex_unlock(&lock);
+    return NULL;
+}
+
+/* ---- Public API ---- */
+
+void output_writer_init(int ms, void *zmq_socket, shm_ring_t *shm) {
+    zmq_sock = zmq_socket;
+    shm_ring = shm;
+    flush_ms = ms;
+    /* Interactive sessions see each line as it is decoded */
+    write_through = ms <= 0 || isatty(STDOUT_FILENO);
+    if (write_through)
+        return;
+
+    pthread_create(&writer, NULL, writer_thread, NULL);
+    started = 1;
+#ifdef __linux__
+    pthread_setname_np(writer, "writer");
+#endif
+}
+
+void output_writer_put(const char *line, size_t len, int dest) {
+    if (len == 0 || !dest)
+        return;
+    if (!zmq_sock)
+        dest &= ~OUTPUT_ZMQ;
+    if (!shm_ring)
+        dest &= ~OUTPUT_SHM;
+    if (!(dest & (OUTPUT_STDOUT | OUTPUT_ZMQ | OUTPUT_SHM)))
+        return;
+
+    if (write_through) {
+        if (dest & OUTPUT_STDOUT) {
+            struct iovec iov = { (void *)line, len };
+            write_all(&iov, 1);
+        }
+        if (dest & OUTPUT_ZMQ)
+            zmq_publish(line, len, dest, 0);
+        if (dest & OUTPUT_SHM)
+            shm_ring_write(shm_ring, line, len);
+        return;
+    }
+
+    if (len > OUTPUT_BUF_SIZE)
+        len = OUTPUT_BUF_SIZE;
+
+    pthread_mutex_lock(&lock);
+    out_buf_t *cur = &bufs[fill_idx];
+    if (cur->used + len > OUTPUT_BUF_SIZE || cur->n_lines == OUTPUT_BUF_LINES) {
+        hand_off();
+        cur = &bufs[fill_idx];
+    }
+    if (cur->n_lines == 0) {
+        cur->first_ns = now_ns();
+        pthread_cond_signal(&work_cond);
+    }
+    memcpy(cur->data + cur->used, line, len);
+    cur->lines[cur->n_lines].off = (uint32_t)cur->used;
+    cur->lines[cur->n_lines].len = (uint32_t)len;
+    cur->lines[cur->n_lines].dest = dest;
+    cur->n_lines++;
+    cur->used += len;
+    pthread_mutex_unlock(&lock);
+}
+
+void output_writer_flush(void) {
+    if (write_through)
+        return;
+
+    pthread_mutex_lock(&lock);
+    if (bufs[fill_idx].n_lines > 0)
+        hand_off();
+    while (pending[0] || pending[1])
+        pthread_cond_wait(&done_cond, &lock);
+    pthread_mutex_unlock(&lock);
+}
+
+void output_writer_shutdown(void) {
+    if (!started)
+        return;
+
+    pthread_mutex_lock(&lock);
+    stopping = 1;
+    pthread_cond_signal(&work_cond);
+    pthread_mutex_unlock(&lock);
+    pthread_join(writer, NULL);
+    started = 0;
+    write_through = 1;
+}
@@ -0,0 +1,53 @@
+/*
+ * Output writer -- batched stdout, ZMQ and shared-memory delivery of output lines
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Output writer -- batched stdout, ZMQ and shared-memory delivery of output lines
+ *
+ * Lines are appended to one of two large buffers. A writer thread hands a
+ * buffer to writev() (and publishes its lines as one multipart ZMQ
+ * message, and appends them to the --shm ring) when it fills up or when
+ * its oldest line has waited flush_ms,
+ * while the producer keeps filling the other one. When stdout is a
+ * terminal, or flush_ms is 0, every line is written as soon as it is put,
+ * as before.
+ */
+
+#ifndef __OUTPUT_WRITER_H__
+#define __OUTPUT_WRITER_H__
+
+#include <stddef.h>
+
+#include "shm_ring.h"
+
+/* Default --output-flush-ms */
+#define OUTPUT_FLUSH_MS_DEFAULT 100
+
+/* Destinations of one line */
+#define OUTPUT_STDOUT   1
+#define OUTPUT_ZMQ      2
+#define OUTPUT_BINARY   4   /* a binary record: sent to ZMQ as is */
+#define OUTPUT_SHM      8
+
+/* Start the writer. zmq_socket is a bound ZMQ PUB socket or NULL, shm a
+ * shared-memory ring or NULL; both are only ever used from the writer's
+ * own thread (or the caller's thread in write-through mode). */
+void output_writer_init(int flush_ms, void *zmq_socket, shm_ring_t *shm);
+
+/* Queue one newline-terminated line (or, with OUTPUT_BINARY, one binary
+ * record) for the given destinations. Lines from one thread are written
+ * in order. */
+void output_writer_put(const char *line, size_t len, int dest);
+
+/* Write everything queued so far before returning, e.g. before other
+ * code writes to stdout directly */
+void output_writer_flush(void);
+
+/* Flush and stop the writer thread */
+void output_writer_shutdown(void);
+
+#endif
@@ -0,0 +1,199 @@
+#!/bin/bash
+# End-to-end throughput harness for iridium-sniffer
+# Runs the whole pipeline on a capture file once per configuration and
+# prints one JSON line per run: wall and CPU time, peak RSS, the
+# sample-rate ratio (seconds of capture per second of wall time) and the
+# share of the capture's bursts that decoded.
+#
+# Usage: ./perf-harness.sh [iq_file]
+#
+# Without a file, a synthetic capture is written by iridium-bench --synth
+# (so the number of bursts in it is known) and removed afterwards.
+
+set -e
+
+# Configuration
+SAMPLE_RATE=${SAMPLE_RATE:-10000000}
+CENTER_FREQ=${CENTER_FREQ:-1622000000}
+FORMAT=${FORMAT:-}
+DURATION=${DURATION:-10}
+BURST_RATE=${BURST_RATE:-200}
+SNR=${SNR:-20}
+CFO=${CFO:-30000}
+SEED=${SEED:-1}
+PAIRS=${PAIRS:-0}
+BURSTS=${BURSTS:-}
+CONFIGS=${CONFIGS:-}
+BINARIES=${BINARIES:-}
+BASELINE=${BASELINE:-}
+TOLERANCE=${TOLERANCE:-10}
+
+if [ "$1" = "-h" ] || [ "$1" = "--help" ]; then
+    echo "Usage: $0 [iq_file]"
+    echo ""
+    echo "Environment variables:"
+    echo "  SAMPLE_RATE   Sample rate in Hz (default: 10000000)"
+    echo "  CENTER_FREQ   Center frequency in Hz (default: 1622000000)"
+    echo "  FORMAT        IQ format: cf32/ci16/ci8 (default: from extension, ci8)"
+    echo "  DURATION, BURST_RATE, SNR, CFO, SEED, PAIRS"
+    echo "                Synthetic capture (defaults: 10 s, 200/s, 20 dB, 30000 Hz, 1, 0)"
+    echo "  BURSTS        Bursts in iq_file, for decode_rate (synthetic: known)"
+    echo "  CONFIGS       'name=args;name=args' sniffer configurations"
+    echo "                (default: default, no-gpu on GPU builds, 1 and 4 workers)"
+    echo "  BINARIES      'name=path;name=path' builds to compare, e.g. an"
+    echo "                OpenCL and a Vulkan build (default: the one found)"
+    echo "  BASELINE      Earlier output of this script to gate against"
+    echo "  TOLERANCE     Percent decode_rate may fall or cpu_s rise (default: 10)"
+    exit 1
+fi
+
+if [ -n "$BASELINE" ] && [ ! -f "$BASELINE" ]; then
+    echo "Error: Baseline not found: $BASELINE" >&2
+    exit 1
+fi
+
+# Find the binaries
+BUILD_DIR=""
+for d in . ./build ../build; do
+    if [ -x "$d/iridium-sniffer" ]; then
+        BUILD_DIR="$d"
+        break
+    fi
+done
+
+if [ -z "$BINARIES" ]; then
+    if [ -n "$BUILD_DIR" ]; then
+        BINARIES="sniffer=$BUILD_DIR/iridium-sniffer"
+    elif command -v iridium-sniffer >/dev/null 2>&1; then
+        BINARIES="sniffer=iridium-sniffer"
+    else
+        echo "Error: iridium-sniffer binary not found" >&2
+        echo "Run from the build/ directory or project root, or set BINARIES" >&2
+        exit 1
+    fi
+fi
+
+# Capture: the given file, or a synthetic one
+IQ_FILE="$1"
+CLEANUP=""
+if [ -z "$IQ_FILE" ]; then
+    BENCH=""
+    if [ -n "$BUILD_DIR" ] && [ -x "$BUILD_DIR/iridium-bench" ]; then
+        BENCH="$BUILD_DIR/iridium-bench"
+    elif command -v iridium-bench >/dev/null 2>&1; then
+        BENCH="iridium-bench"
+    else
+        echo "Error: no iq_file given and iridium-bench not found" >&2
+        exit 1
+    fi
+    FORMAT=${FORMAT:-ci8}
+    IQ_FILE=$(mktemp "${TMPDIR:-/tmp}/perf-harness-XXXXXX.$FORMAT")
+    CLEANUP="$IQ_FILE"
+    trap 'rm -f "$CLEANUP"' EXIT
+
+    echo "Generating ${DURATION}s synthetic capture..." >&2
+    SYNTH=$("$BENCH" --synth="$IQ_FILE" --format="$FORMAT" \
+        --rate="$SAMPLE_RATE" --center="$CENTER_FREQ" --duration="$DURATION" \
+        --burst-rate="$BURST_RATE" --snr="$SNR" --cfo="$CFO" --seed="$SEED" \
+        --pairs="$PAIRS")
+    echo "$SYNTH" >&2
+    BURSTS=$(echo "$SYNTH" | sed -n 's/.*"bursts":\([0-9]*\).*/\1/p')
+elif [ ! -f "$IQ_FILE" ]; then
+    echo "Error: File not found: $IQ_FILE" >&2
+    exit 1
+fi
+
+if [ -z "$FORMAT" ]; then
+    case "${IQ_FILE##*.}" in
+        cf32|fc32|cfile) FORMAT=cf32 ;;
+        ci16|cs16|sc16)  FORMAT=ci16 ;;
+        *)               FORMAT=ci8 ;;
+    esac
+fi
+
+# JSON number from the summary line, or null
+field() {
+    local v
+    v=$(echo "$1" | sed -n "s/.*\"$2\":\([-0-9.]*\).*/\1/p")
+    echo "${v:-null}"
+}
+
+RESULTS=$(mktemp "${TMPDIR:-/tmp}/perf-harness-XXXXXX.json")
+trap 'rm -f "$CLEANUP" "$RESULTS"' EXIT
+
+IFS=';' read -ra BIN_LIST <<< "$BINARIES"
+for bin_entry in "${BIN_LIST[@]}"; do
+    BIN_NAME="${bin_entry%%=*}"
+    SNIFFER="${bin_entry#*=}"
+
+    configs="$CONFIGS"
+    if [ -z "$configs" ]; then
+        configs="default="
+        if "$SNIFFER" --help 2>&1 | grep -q -- "--no-gpu"; then
+            configs="$configs;no-gpu=--no-gpu"
+        fi
+        configs="$configs;workers-1=--workers=1 --demod-workers=1"
+        configs="$configs;workers-4=--workers=4 --demod-workers=4"
+    fi
+
+    IFS=';' read -ra CONFIG_LIST <<< "$configs"
+    for cfg in "${CONFIG_LIST[@]}"; do
+        NAME="${cfg%%=*}"
+        ARGS="${cfg#*=}"
+        echo "Running $BIN_NAME/$NAME: $ARGS" >&2
+
+        # shellcheck disable=SC2086
+        SUMMARY=$("$SNIFFER" -f "$IQ_FILE" --format="$FORMAT" \
+            -r "$SAMPLE_RATE" -c "$CENTER_FREQ" --stats-json $ARGS \
+            2>&1 >/dev/null | grep '^{"summary"' || true)
+        if [ -z "$SUMMARY" ]; then
+            echo "Error: $BIN_NAME/$NAME printed no summary" >&2
+            exit 1
+        fi
+
+        CPU=$(field "$SUMMARY" cpu_s)
+        OK=$(field "$SUMMARY" frames_ok)
+        DECODE=null
+        if [ -n "$BURSTS" ] && [ "$BURSTS" -gt 0 ]; then
+            DECODE=$(awk -v ok="$OK" -v n="$BURSTS" 'BEGIN { printf "%.4f", ok / n }')
+        fi
+        PER_CPU=$(awk -v ok="$OK" -v cpu="$CPU" \
+            'BEGIN { printf "%.1f", (cpu > 0 ? ok / cpu : 0) }')
+
+        printf '{"binary":"%s","config":"%s","args":"%s","wall_s":%s,"cpu_s":%s,"max_rss_kb":%s,"srr":%s,"bursts":%s,"bursts_detected":%s,"frames_ok":%s,"decode_rate":%s,"frames_ok_per_cpu_s":%s}\n' \
+            "$BIN_NAME" "$NAME" "$ARGS" "$(field "$SUMMARY" wall_s)" "$CPU" \
+            "$(field "$SUMMARY" max_rss_kb)" "$(field "$SUMMARY" srr)" \
+            "${BURSTS:-null}" "$(field "$SUMMARY" bursts_detected)" "$OK" \
+            "$DECODE" "$PER_CPU" | tee -a "$RESULTS"
+    done
+done
+
+# Gate against a baseline: same binary and config name
+if [ -n "$BASELINE" ]; then
+    FAILED=0
+    while read -r line; do
+        key=$(echo "$line" | sed -n 's/.*"binary":"\([^"]*\)","config":"\([^"]*\)".*/\1\/\2/p')
+        base=$(grep -F "\"binary\":\"${key%%/*}\",\"config\":\"${key#*/}\"" "$BASELINE" | tail -1 || true)
+        if [ -z "$base" ]; then
+            echo "Gate: $key not in baseline, skipped" >&2
+            continue
+        fi
+        for metric in decode_rate cpu_s; do
+            now=$(field "$line" $metric)
+            was=$(field "$base" $metric)
+            [ "$now" = null ] || [ "$was" = null ] && continue
+            # decode_rate may not fall, cpu_s may not rise, by TOLERANCE %
+            if ! awk -v now="$now" -v was="$was" -v tol="$TOLERANCE" -v m=$metric \
+                'BEGIN { lim = tol / 100 * was;
+                         exit !(m == "cpu_s" ? now <= was + lim : now >= was - lim) }'; then
+                echo "Gate: $key $metric $was -> $now (tolerance $TOLERANCE%)" >&2
+                FAILED=1
+            fi
+        done
+    done < "$RESULTS"
+    if [ $FAILED -ne 0 ]; then
+        echo "Gate: FAILED" >&2
+        exit 1
+    fi
+    echo "Gate: passed" >&2
+fi
@@ -0,0 +1,357 @@
+/*
+ * Pipeline instrumentation -- per-stage timing, queue waits, end-to-end latency
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Pipeline instrumentation -- per-stage timing, queue waits, end-to-end latency
+ *
+ * Bucket b < 4 holds exactly b ns. Above that, bucket 4 * (msb - 1) + m
+ * holds values whose top bit is msb and next two bits are m, i.e. the range
+ * [(4 + m) << (msb - 2), (5 + m) << (msb - 2)). 160 buckets reach ~18 min.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pipeline_stats.h"
+
+typedef struct {
+    _Atomic uint64_t count;
+    _Atomic uint64_t sum_ns;
+    _Atomic uint64_t max_ns;
+    _Atomic uint64_t bucket[PSTATS_BUCKETS];
+} hist_t;
+
+static hist_t stage_hist[STAGE_COUNT];
+static hist_t take_hist[PQ_COUNT];
+static hist_t put_hist[PQ_COUNT];
+static hist_t latency_hist;
+static atomic_uint queue_depth[PQ_COUNT];
+static atomic_uint queue_depth_max[PQ_COUNT];
+
+static struct {
+    const char *name;
+    const char *help;
+    atomic_ulong *value;
+} counters[PSTATS_COUNTERS_MAX];
+static int n_counters = 0;
+
+static struct {
+    const char *name;
+    const char *help;
+    const char *label;
+    int n;
+    const int *keys;
+    atomic_ulong *values;
+} counter_sets[PSTATS_COUNTER_SETS_MAX];
+static int n_counter_sets = 0;
+
+static const char *stage_names[STAGE_COUNT] = {
+    "fft", "extract", "downmix", "downmix_fir", "sync", "demod", "pll", "classify",
+    "ida", "ira", "ibc",
+};
+
+static const char *queue_names[PQ_COUNT] = {
+    "samples", "burst", "frame",
+};
+
+/* ---- Recording ---- */
+
+static inline int bucket_of(uint64_t ns) {
+    if (ns < 4)
+        return (int)ns;
+    int msb = 63 - __builtin_clzll(ns);
+    int b = (msb - 1) * 4 + (int)((ns >> (msb - 2)) & 3);
+    return b < PSTATS_BUCKETS ? b : PSTATS_BUCKETS - 1;
+}
+
+static void hist_add(hist_t *h, uint64_t ns) {
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum_ns, ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->bucket[bucket_of(ns)], 1, memory_order_relaxed);
+
+    uint64_t max = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+    while (ns > max &&
+           !atomic_compare_exchange_weak_explicit(&h->max_ns, &max, ns,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+        ;
+}
+
+void pstats_stage(pstats_stage_t stage, uint64_t t0) {
+    hist_add(&stage_hist[stage], pstats_now() - t0);
+}
+
+void pstats_take_wait(pstats_queue_t q, uint64_t t0) {
+    hist_add(&take_hist[q], pstats_now() - t0);
+}
+
+void pstats_put_wait(pstats_queue_t q, uint64_t t0) {
+    hist_add(&put_hist[q], pstats_now() - t0);
+}
+
+void pstats_queue_depth(pstats_queue_t q, unsigned depth) {
+    atomic_store_explicit(&queue_depth[q], depth, memory_order_relaxed);
+    unsigned max = atomic_load_explicit(&queue_depth_max[q], memory_order_relaxed);
+    while (depth > max &&
+           !atomic_compare_exchange_weak_explicit(&queue_depth_max[q], &max, depth,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+        ;
+}
+
+void pstats_latency(uint64_t ns) {
+    hist_add(&latency_hist, ns);
+}
+
+void pstats_add_counter(const char *name, const char *help, atomic_ulong *value) {
+    if (n_counters == PSTATS_COUNTERS_MAX)
+        return;
+    counters[n_counters].name = name;
+    counters[n_counters].help = help;
+    counters[n_counters].value = value;
+    n_counters++;
+}
+
+void pstats_add_counter_set(const char *name, const char *help,
+                            const char *label, int n, const int *keys,
+                            atomic_ulong *values) {
+    if (n_counter_sets == PSTATS_COUNTER_SETS_MAX)
+        return;
+    counter_sets[n_counter_sets].name = name;
+    counter_sets[n_counter_sets].help = help;
+    counter_sets[n_counter_sets].label = label;
+    counter_sets[n_counter_sets].n = n;
+    counter_sets[n_counter_sets].keys = keys;
+    counter_sets[n_counter_sets].values = values;
+    n_counter_sets++;
+}
+
+/* ---- Snapshots ---- */
+
+static void hist_copy(pstats_hist_t *out, hist_t *h) {
+    out->count = atomic_load_explicit(&h->count, memory_order_relaxed);
+    out->sum_ns = atomic_load_explicit(&h->sum_ns, memory_order_relaxed);
+    out->max_ns = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+    for (int i = 0; i < PSTATS_BUCKETS; i++)
+        out->bucket[i] = atomic_load_explicit(&h->bucket[i], memory_order_relaxed);
+}
+
+void pstats_snapshot(pstats_snapshot_t *snap) {
+    for (int i = 0; i < STAGE_COUNT; i++)
+        hist_copy(&snap->stage[i], &stage_hist[i]);
+    for (int i = 0; i < PQ_COUNT; i++) {
+        hist_copy(&snap->take_wait[i], &take_hist[i]);
+        hist_copy(&snap->put_wait[i], &put_hist[i]);
+        snap->depth[i] = atomic_load(&queue_depth[i]);
+        snap->depth_max[i] = atomic_load(&queue_depth_max[i]);
+    }
+    hist_copy(&snap->latency, &latency_hist);
+}
+
+/* Midpoint of a bucket's range */
+static double bucket_value(int b) {
+    if (b < 4)
+        return b;
+    int msb = b / 4 + 1;
+    int m = b % 4;
+    double lo = (double)((uint64_t)(4 + m) << (msb - 2));
+    return lo * (1.0 + 0.5 / (4 + m));
+}
+
+/* Delta of two histograms; prev may be NULL */
+static void hist_delta(pstats_hist_t *d, const pstats_hist_t *cur,
+                       const pstats_hist_t *prev) {
+    *d = *cur;
+    if (!prev)
+        return;
+    d->count -= prev->count;
+    d->sum_ns -= prev->sum_ns;
+    d->max_ns = 0;
+    for (int i = 0; i < PSTATS_BUCKETS; i++) {
+        d->bucket[i] -= prev->bucket[i];
+        if (d->bucket[i])
+            d->max_ns = (uint64_t)bucket_value(i);
+    }
+    if (d->max_ns > cur->max_ns)
+        d->max_ns = cur->max_ns;
+}
+
+static double hist_quantile(const pstats_hist_t *h, double q) {
+    if (h->count == 0)
+        return 0;
+    uint64_t want = (uint64_t)(q * (double)h->count);
+    if (want >= h->count)
+        want = h->count - 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < PSTATS_BUCKETS; i++) {
+        seen += h->bucket[i];
+        if (seen > want) {
+            double v = bucket_value(i);
+            return h->max_ns && v > (double)h->max_ns ? (double)h->max_ns : v;
+        }
+    }
+    return (double)h->max_ns;
+}
+
+/* ---- Formatting ---- */
+
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t pos;
+} out_t;
+
+static void out_printf(out_t *o, const char *fmt, ...) {
+    if (o->pos >= o->len)
+        return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(o->buf + o->pos, o->len - o->pos, fmt, ap);
+    va_end(ap);
+    if (n > 0)
+        o->pos = o->pos + (size_t)n < o->len ? o->pos + (size_t)n : o->len - 1;
+}
+
+static void json_hist(out_t *o, const char *name, const pstats_hist_t *h,
+                      double scale, const char *unit) {
+    out_printf(o, "\"%s\":{\"n\":%llu,\"mean_%s\":%.1f,\"p50_%s\":%.1f,"
+               "\"p99_%s\":%.1f,\"max_%s\":%.1f}",
+               name, (unsigned long long)h->count,
+               unit, h->count ? (double)h->sum_ns / (double)h->count / scale : 0.0,
+               unit, hist_quantile(h, 0.50) / scale,
+               unit, hist_quantile(h, 0.99) / scale,
+               unit, (double)h->max_ns / scale);
+}
+
+int pstats_format_json(char *buf, size_t len, const pstats_snapshot_t *cur,
+                       const pstats_snapshot_t *prev) {
+    out_t o = { buf, len, 0 };
+    pstats_hist_t d;
+
+    if (len == 0)
+        return 0;
+    buf[0] = '\0';
+
+    out_printf(&o, "{\"time\":%ld", (long)time(NULL));
+    for (int i = 0; i < n_counters; i++)
+        out_printf(&o, ",\"%s\":%lu", counters[i].name,
+                   atomic_load(counters[i].value));
+    for (int i = 0; i < n_counter_sets; i++) {
+        out_printf(&o, ",\"%s\":{", counter_sets[i].name);
+        for (int j = 0; j < counter_sets[i].n; j++)
+            out_printf(&o, "%s\"%d\":%lu", j ? "," : "", counter_sets[i].keys[j],
+                       atomic_load(&counter_sets[i].values[j]));
+        out_printf(&o, "}");
+    }
+
+    out_printf(&o, ",\"stages\":{");
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        hist_delta(&d, &cur->stage[i], prev ? &prev->stage[i] : NULL);
+        if (i) out_printf(&o, ",");
+        json_hist(&o, stage_names[i], &d, 1e3, "us");
+    }
+
+    out_printf(&o, "},\"queues\":{");
+    for (int i = 0; i < PQ_COUNT; i++) {
+        if (i) out_printf(&o, ",");
+        out_printf(&o, "\"%s\":{\"depth\":%u,\"depth_max\":%u,",
+                   queue_names[i], cur->depth[i], cur->depth_max[i]);
+        hist_delta(&d, &cur->take_wait[i], prev ? &prev->take_wait[i] : NULL);
+        json_hist(&o, "take_wait", &d, 1e3, "us");
+        out_printf(&o, ",");
+        hist_delta(&d, &cur->put_wait[i], prev ? &prev->put_wait[i] : NULL);
+        json_hist(&o, "put_wait", &d, 1e3, "us");
+        out_printf(&o, "}");
+    }
+
+    out_printf(&o, "},");
+    hist_delta(&d, &cur->latency, prev ? &prev->latency : NULL);
+    json_hist(&o, "latency", &d, 1e6, "ms");
+    out_printf(&o, "}");
+
+    return (int)o.pos;
+}
+
+static void prom_hist(out_t *o, const char *metric, const char *labels,
+                      const pstats_hist_t *h) {
+    const char *sep = labels[0] ? "," : "";
+    out_printf(o, "%s{%s%squantile=\"0.5\"} %.9f\n", metric, labels, sep,
+               hist_quantile(h, 0.50) / 1e9);
+    out_printf(o, "%s{%s%squantile=\"0.99\"} %.9f\n", metric, labels, sep,
+               hist_quantile(h, 0.99) / 1e9);
+    out_printf(o, "%s_sum{%s} %.9f\n", metric, labels, (double)h->sum_ns / 1e9);
+    out_printf(o, "%s_count{%s} %llu\n", metric, labels,
+               (unsigned long long)h->count);
+}
+
+int pstats_format_prometheus(char *buf, size_t len) {
+    static pstats_snapshot_t snap;  /* large; callers are serialized below */
+    static atomic_flag busy = ATOMIC_FLAG_INIT;
+    out_t o = { buf, len, 0 };
+    char labels[64];
+
+    if (len == 0)
+        return 0;
+    buf[0] = '\0';
+
+    while (atomic_flag_test_and_set(&busy))
+        ;
+    pstats_snapshot(&snap);
+
+    for (int i = 0; i < n_counters; i++) {
+        out_printf(&o, "# HELP iridium_%s_total %s\n", counters[i].name,
+                   counters[i].help);
+        out_printf(&o, "# TYPE iridium_%s_total counter\n", counters[i].name);
+        out_printf(&o, "iridium_%s_total %lu\n", counters[i].name,
+                   atomic_load(counters[i].value));
+    }
+    for (int i = 0; i < n_counter_sets; i++) {
+        out_printf(&o, "# HELP iridium_%s_total %s\n", counter_sets[i].name,
+                   counter_sets[i].help);
+        out_printf(&o, "# TYPE iridium_%s_total counter\n", counter_sets[i].name);
+        for (int j = 0; j < counter_sets[i].n; j++)
+            out_printf(&o, "iridium_%s_total{%s=\"%d\"} %lu\n",
+                       counter_sets[i].name, counter_sets[i].label,
+                       counter_sets[i].keys[j],
+                       atomic_load(&counter_sets[i].values[j]));
+    }
+
+    out_printf(&o, "# HELP iridium_stage_seconds Processing time per stage run\n"
+                   "# TYPE iridium_stage_seconds summary\n");
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        snprintf(labels, sizeof(labels), "stage=\"%s\"", stage_names[i]);
+        prom_hist(&o, "iridium_stage_seconds", labels, &snap.stage[i]);
+    }
+
+    out_printf(&o, "# HELP iridium_queue_depth Queue depth after the last enqueue\n"
+                   "# TYPE iridium_queue_depth gauge\n");
+    for (int i = 0; i < PQ_COUNT; i++)
+        out_printf(&o, "iridium_queue_depth{queue=\"%s\"} %u\n",
+                   queue_names[i], snap.depth[i]);
+    out_printf(&o, "# HELP iridium_queue_depth_max Queue depth high-water mark\n"
+                   "# TYPE iridium_queue_depth_max gauge\n");
+    for (int i = 0; i < PQ_COUNT; i++)
+        out_printf(&o, "iridium_queue_depth_max{queue=\"%s\"} %u\n",
+                   queue_names[i], snap.depth_max[i]);
+
+    out_printf(&o, "# HELP iridium_queue_wait_seconds Time blocked in queue operations\n"
+                   "# TYPE iridium_queue_wait_seconds summary\n");
+    for (int i = 0; i < PQ_COUNT; i++) {
+        snprintf(labels, sizeof(labels), "queue=\"%s\",op=\"take\"", queue_names[i]);
+        prom_hist(&o, "iridium_queue_wait_seconds", labels, &snap.take_wait[i]);
+        snprintf(labels, sizeof(labels), "queue=\"%s\",op=\"put\"", queue_names[i]);
+        prom_hist(&o, "iridium_queue_wait_seconds", labels, &snap.put_wait[i]);
+    }
+
+    out_printf(&o, "# HELP iridium_latency_seconds Sample capture to frame output\n"
+                   "# TYPE iridium_latency_seconds summary\n");
+    prom_hist(&o, "iridium_latency_seconds", "", &snap.latency);
+
+    atomic_flag_clear(&busy);
+    return (int)o.pos;
+}
@@ -0,0 +1,116 @@
+/*
+ * Pipeline instrumentation -- per-stage timing, queue waits, end-to-end latency
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Pipeline instrumentation -- per-stage timing, queue waits, end-to-end latency
+ *
+ * Every measurement goes into a log-linear histogram (four buckets per
+ * power of two nanoseconds, so percentiles are within ~20%). Histograms are
+ * global and updated with relaxed atomic adds from whichever thread did the
+ * work, so recording never takes a lock. Readers take a snapshot and either
+ * format the delta since a previous snapshot (the --stats-json line) or the
+ * running totals (the web server's /metrics page).
+ */
+
+#ifndef __PIPELINE_STATS_H__
+#define __PIPELINE_STATS_H__
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Timed processing stages */
+typedef enum {
+    STAGE_FFT = 0,          /* detector: one FFT frame */
+    STAGE_EXTRACT,          /* detector: narrowband extraction of a burst */
+    STAGE_DOWNMIX,          /* downmix: one burst, end to end */
+    STAGE_DOWNMIX_FIR,      /* downmix: decimating input FIR */
+    STAGE_SYNC,             /* downmix: unique word correlation */
+    STAGE_DEMOD,            /* demod: one frame, end to end */
+    STAGE_PLL,              /* demod: QPSK phase tracking */
+    STAGE_CLASSIFY,         /* demod: frame classification */
+    STAGE_IDA,              /* demod: IDA decode */
+    STAGE_IRA,              /* demod: IRA decode */
+    STAGE_IBC,              /* demod: IBC decode */
+    STAGE_COUNT
+} pstats_stage_t;
+
+/* Instrumented queues */
+typedef enum {
+    PQ_SAMPLES = 0,
+    PQ_BURST,
+    PQ_FRAME,
+    PQ_COUNT
+} pstats_queue_t;
+
+#define PSTATS_BUCKETS 160
+#define PSTATS_COUNTERS_MAX 32
+#define PSTATS_COUNTER_SETS_MAX 4
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t bucket[PSTATS_BUCKETS];
+} pstats_hist_t;
+
+/* Point-in-time copy of every histogram */
+typedef struct {
+    pstats_hist_t stage[STAGE_COUNT];
+    pstats_hist_t take_wait[PQ_COUNT];  /* consumer blocked in take */
+    pstats_hist_t put_wait[PQ_COUNT];   /* producer blocked in put */
+    unsigned depth[PQ_COUNT];           /* last depth seen after an enqueue */
+    unsigned depth_max[PQ_COUNT];       /* high-water mark */
+    pstats_hist_t latency;              /* sample time to output */
+} pstats_snapshot_t;
+
+static inline uint64_t pstats_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Record one run of a stage that started at pstats_now() value t0 */
+void pstats_stage(pstats_stage_t stage, uint64_t t0);
+
+/* Record time spent blocked in a queue operation started at t0 */
+void pstats_take_wait(pstats_queue_t q, uint64_t t0);
+void pstats_put_wait(pstats_queue_t q, uint64_t t0);
+
+/* Record queue depth after an enqueue */
+void pstats_queue_depth(pstats_queue_t q, unsigned depth);
+
+/* Record the delay between a sample's capture and its frame's output */
+void pstats_latency(uint64_t ns);
+
+/* Export a pipeline counter (e.g. bursts detected) in the JSON line and
+ * on /metrics. name must be a valid metric name suffix; both strings are
+ * borrowed. */
+void pstats_add_counter(const char *name, const char *help, atomic_ulong *value);
+
+/* Export n counters of one kind told apart by a numeric label: values[i]
+ * is the count for label value keys[i]. An object keyed by label value in
+ * the JSON line, one labelled series each on /metrics. All pointers are
+ * borrowed. */
+void pstats_add_counter_set(const char *name, const char *help,
+                            const char *label, int n, const int *keys,
+                            atomic_ulong *values);
+
+void pstats_snapshot(pstats_snapshot_t *snap);
+
+/* Format the activity between two snapshots as one JSON object (no
+ * newline). Percentiles and max are estimated from the delta buckets.
+ * Returns the length written. */
+int pstats_format_json(char *buf, size_t len, const pstats_snapshot_t *cur,
+                       const pstats_snapshot_t *prev);
+
+/* Format the running totals in Prometheus text exposition format.
+ * Returns the length written. */
+int pstats_format_prometheus(char *buf, size_t len);
+
+#endif
@@ -0,0 +1,309 @@
+/*
+ * Placement
+ *
+ * Per-role CPU lists from --affinity, NUMA nodes read from sysfs, the
+ * memory policy set with set_mempolicy(2), and huge-page backed
+ * mappings for large buffers.
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+
+#include "placement.h"
+
+#define PLACE_MAX_CPUS  1024
+#define HUGE_PAGE_SIZE  (2u << 20)
+
+typedef struct {
+    int cpus[PLACE_MAX_CPUS];
+    int n;
+    char text[64];
+} role_cpus_t;
+
+static const char *role_names[PLACE_ROLES] = {
+    [PLACE_INPUT] = "input",
+    [PLACE_DETECTOR] = "detector",
+    [PLACE_WORKERS] = "workers",
+    [PLACE_DEMOD] = "demod",
+    [PLACE_OUTPUT] = "output",
+};
+
+static role_cpus_t roles[PLACE_ROLES];
+static int active = 0;
+static int is_auto = 0;
+static huge_pages_t huge_pages = HUGE_PAGES_OFF;
+
+/* ---- CPUs ---- */
+
+/* CPUs this process may run on, in order */
+static int allowed_cpus(int *cpus, int max) {
+    int n = 0;
+#ifdef __linux__
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE && n < max; c++)
+            if (CPU_ISSET(c, &set))
+                cpus[n++] = c;
+        return n;
+    }
+#endif
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int c = 0; c < ncpu && n < max; c++)
+        cpus[n++] = c;
+    return n;
+}
+
+static int cpu_allowed(int cpu, const int *cpus, int n) {
+    for (int i = 0; i < n; i++)
+        if (cpus[i] == cpu)
+            return 1;
+    return 0;
+}
+
+/* Format a CPU list as ranges joined by '+' */
+static void describe(role_cpus_t *r) {
+    size_t len = 0;
+    r->text[0] = '\0';
+    for (int i = 0; i < r->n && len < sizeof(r->text); ) {
+        int j = i;
+        while (j + 1 < r->n && r->cpus[j + 1] == r->cpus[j] + 1)
+            j++;
+        len += snprintf(r->text + len, sizeof(r->text) - len,
+                        j > i ? "%s%d-%d" : "%s%d", i ? "+" : "",
+                        r->cpus[i], r->cpus[j]);
+        i = j + 1;
+    }
+}
+
+static int parse_cpus(const char *s, role_cpus_t *r, const int *allowed,
+                      int n_allowed) {
+    r->n = 0;
+    while (*s) {
+        char *end;
+        long lo = strtol(s, &end, 10);
+        long hi = lo;
+        if (end == s)
+            return -1;
+        if (*end == '-') {
+            s = end + 1;
+            hi = strtol(s, &end, 10);
+            if (end == s)
+                return -1;
+        }
+        if (lo < 0 || hi < lo)
+            return -1;
+        for (long c = lo; c <= hi; c++) {
+            if (!cpu_allowed((int)c, allowed, n_allowed) || r->n == PLACE_MAX_CPUS)
+                return -1;
+            r->cpus[r->n++] = (int)c;
+        }
+        if (*end == '+')
+            end++;
+        else if (*end)
+            return -1;
+        s = end;
+    }
+    return r->n > 0 ? 0 : -1;
+}
+
+int placement_parse(const char *spec) {
+    static int allowed[PLACE_MAX_CPUS];
+    int n_allowed = allowed_cpus(allowed, PLACE_MAX_CPUS);
+
+    memset(roles, 0, sizeof(roles));
+    active = 1;
+    is_auto = strcmp(spec, "auto") == 0;
+    if (is_auto)
+        return 0;
+
+    char *buf = strdup(spec);
+    char *save = NULL;
+    int ret = -1;
+    for (char *tok = strtok_r(buf, ",", &save); tok;
+         tok = strtok_r(NULL, ",", &save)) {
+        char *colon = strchr(tok, ':');
+        if (!colon)
+            goto out;
+        *colon = '\0';
+        int role;
+        for (role = 0; role < PLACE_ROLES; role++)
+            if (strcmp(tok, role_names[role]) == 0)
+                break;
+        if (role == PLACE_ROLES || roles[role].n > 0 ||
+            parse_cpus(colon + 1, &roles[role], allowed, n_allowed) != 0)
+            goto out;
+        describe(&roles[role]);
+        ret = 0;
+    }
+out:
+    free(buf);
+    if (ret != 0)
+        active = 0;
+    return ret;
+}
+
+int placement_active(void) {
+    return active;
+}
+
+void placement_resolve(int n_detectors) {
+    if (!is_auto)
+        return;
+    int cpus[PLACE_MAX_CPUS];
+    int n = allowed_cpus(cpus, PLACE_MAX_CPUS);
+    if (n < 2)
+        return;     /* nothing to spread over */
+    if (n_detectors >= n)
+        n_detectors = n - 1;
+
+    role_cpus_t *det = &roles[PLACE_DETECTOR];
+    role_cpus_t *wrk = &roles[PLACE_WORKERS];
+    det->n = wrk->n = 0;
+    for (int i = 0; i < n; i++) {
+        if (i < n_detectors)
+            det->cpus[det->n++] = cpus[i];
+        else
+            wrk->cpus[wrk->n++] = cpus[i];
+    }
+    describe(det);
+    describe(wrk);
+}
+
+int placement_cpu(place_role_t role, int index) {
+    const role_cpus_t *r = &roles[role];
+    if (!active || r->n == 0)
+        return -1;
+    return r->cpus[index % r->n];
+}
+
+const char *placement_describe(place_role_t role) {
+    return roles[role].text;
+}
+
+/* ---- Pinning ---- */
+
+int placement_pin(pthread_t thread, place_role_t role, int index) {
+    int cpu = placement_cpu(role, index);
+    if (cpu < 0)
+        return -1;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(thread, sizeof(set), &set) != 0)
+        return -1;
+    return cpu;
+#else
+    (void)thread;
+    return -1;
+#endif
+}
+
+int placement_pin_self(place_role_t role, int index) {
+    return placement_pin(pthread_self(), role, index);
+}
+
+/* ---- NUMA ---- */
+
+int placement_node(place_role_t role, int index) {
+    int cpu = placement_cpu(role, index);
+    if (cpu < 0)
+        return -1;
+
+    /* /sys/devices/system/cpu/cpuN/ has a nodeM link on NUMA kernels */
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR *dir = opendir(path);
+    if (!dir)
+        return -1;
+    int node = -1;
+    struct dirent *e;
+    while ((e = readdir(dir)) != NULL) {
+        if (strncmp(e->d_name, "node", 4) == 0 &&
+            e->d_name[4] >= '0' && e->d_name[4] <= '9') {
+            node = atoi(e->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+void placement_prefer_node(int node) {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    if (node < 0) {
+        syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+    } else if (node < 64) {
+        unsigned long mask = 1UL << node;
+        syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, 64);
+    }
+#else
+    (void)node;
+#endif
+}
+
+/* ---- Huge pages ---- */
+
+void placement_set_huge_pages(huge_pages_t mode) {
+    huge_pages = mode;
+}
+
+static size_t large_len(size_t bytes) {
+    size_t unit = huge_pages ? HUGE_PAGE_SIZE : (size_t)sysconf(_SC_PAGESIZE);
+    return (bytes + unit - 1) / unit * unit;
+}
+
+void *placement_alloc_large(size_t bytes) {
+    size_t len = large_len(bytes);
+
+    if (huge_pages == HUGE_PAGES_OFF) {
+        void *p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return p == MAP_FAILED ? NULL : p;
+    }
+
+#ifdef MAP_HUGETLB
+    if (huge_pages == HUGE_PAGES_EXPLICIT) {
+        void *p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+            return p;
+    }
+#endif
+
+    /* Transparent: map one huge page extra and trim to a 2 MB boundary */
+    uint8_t *raw = mmap(NULL, len + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return NULL;
+    uintptr_t start = ((uintptr_t)raw + HUGE_PAGE_SIZE - 1)
+                      & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+    uint8_t *p = (uint8_t *)start;
+    if (p > raw)
+        munmap(raw, p - raw);
+    munmap(p + len, raw + HUGE_PAGE_SIZE - p);
+#ifdef MADV_HUGEPAGE
+    madvise(p, len, MADV_HUGEPAGE);
+#endif
+    return p;
+}
+
+void placement_free_large(void *p, size_t bytes) {
+    if (p)
+        munmap(p, large_len(bytes));
+}
@@ -0,0 +1,85 @@
+/*
+ * Placement -- CPU affinity, NUMA-local memory and huge pages
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Placement -- CPU affinity, NUMA-local memory and huge pages
+ *
+ * --affinity assigns each kind of pipeline thread a list of CPUs; the
+ * i-th thread of a role takes the i-th CPU of its list, wrapping. "auto"
+ * gives the detectors one CPU each from CPU 0 up and the downmix workers
+ * the CPUs after them, leaving the other roles to the scheduler.
+ *
+ * Memory follows the CPU: a thread pinned here allocates its buffers on
+ * its own NUMA node by first touch, and buffers that main() allocates
+ * for a thread it has not started yet are placed with
+ * placement_prefer_node() around their allocation.
+ *
+ * placement_alloc_large() backs the detector's multi-megabyte buffers
+ * with huge pages when --huge-pages asks for them: transparent huge pages
+ * by madvise, or explicit ones (the hugetlbfs pool, falling back to
+ * transparent ones if it is empty).
+ */
+
+#ifndef __PLACEMENT_H__
+#define __PLACEMENT_H__
+
+#include <pthread.h>
+#include <stddef.h>
+
+typedef enum {
+    PLACE_INPUT = 0,        /* file reader, SDR and network stream threads */
+    PLACE_DETECTOR,         /* detectors (channelizer: dispatcher, sub-bands) */
+    PLACE_WORKERS,          /* downmix workers */
+    PLACE_DEMOD,            /* demod workers */
+    PLACE_OUTPUT,           /* output sequencer */
+    PLACE_ROLES,
+} place_role_t;
+
+typedef enum {
+    HUGE_PAGES_OFF = 0,
+    HUGE_PAGES_THP,         /* transparent, by madvise */
+    HUGE_PAGES_EXPLICIT,    /* MAP_HUGETLB, else transparent */
+} huge_pages_t;
+
+/* Parse "auto" or ROLE:CPUS[,ROLE:CPUS...], ROLE one of input, detector,
+ * workers, demod, output and CPUS items N or N-M joined by '+'. Returns
+ * 0, or -1 if the spec is malformed or names a CPU that is not online. */
+int placement_parse(const char *spec);
+
+/* Nonzero once a spec has been parsed */
+int placement_active(void);
+
+/* Fill in "auto" for n_detectors detector threads (no-op otherwise) */
+void placement_resolve(int n_detectors);
+
+/* CPU for thread index of role, or -1 if the role is not pinned */
+int placement_cpu(place_role_t role, int index);
+
+/* NUMA node of that CPU, or -1 */
+int placement_node(place_role_t role, int index);
+
+/* Pin a thread (or the caller) to its CPU. Returns the CPU, or -1. */
+int placement_pin(pthread_t thread, place_role_t role, int index);
+int placement_pin_self(place_role_t role, int index);
+
+/* Make the caller's later allocations prefer node (-1: back to the
+ * default policy). No-op without NUMA. */
+void placement_prefer_node(int node);
+
+/* Describe the CPUs of role for log messages ("4-15", "auto", "") */
+const char *placement_describe(place_role_t role);
+
+void placement_set_huge_pages(huge_pages_t mode);
+
+/* Zeroed, page-aligned memory for a large buffer, on huge pages if they
+ * are enabled. Returns NULL if out of memory. */
+void *placement_alloc_large(size_t bytes);
+
+/* Free memory from placement_alloc_large(), with the same size */
+void placement_free_large(void *p, size_t bytes);
+
+#endif
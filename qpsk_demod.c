@@ -25,11 +25,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <sys/stat.h>
-#include <errno.h>
 
 #include "qpsk_demod.h"
+#include "burst_archive.h"
+#include "frame_pool.h"
 #include "iridium.h"
+#include "pipeline_stats.h"
+#include "simd_kernels.h"
 
 extern char *save_bursts_dir;
 extern int use_gardner;
@@ -37,6 +39,7 @@ extern int use_gardner;
 #define PLL_ALPHA           0.2f
 #define M_SQRT1_2f          0.70710678118654752f
 #define CONFIDENCE_ANGLE    22      /* degrees from ideal constellation */
+#define CONFIDENCE_COS_SQRT2 1.31123598f /* sqrt(2) * cos(CONFIDENCE_ANGLE) */
 #define MAGNITUDE_DROP      8.0f    /* end-of-frame: signal < peak/8 */
 #define MAX_LOW_COUNT       3       /* consecutive weak symbols = end */
 #define UW_MAX_ERRORS       2       /* max Hamming distance for hard UW check */
@@ -202,8 +205,15 @@ static int demod_qpsk(const float complex *burst, int n_symbols,
     float max_mag = 0;
     int low_count = 0;
     int n = 0;
-    float *offsets = malloc(n_symbols * sizeof(float));
-    float *magnitudes = malloc(n_symbols * sizeof(float));
+
+    if (n_symbols <= 0) {
+        *level_out = 0;
+        *confidence_out = 0;
+        return 0;
+    }
+
+    unsigned char *in_grid = frame_pool_alloc(n_symbols * sizeof(*in_grid));
+    float *magnitudes = frame_pool_alloc(n_symbols * sizeof(float));
 
     for (int i = 0; i < n_symbols; i++) {
         float re = crealf(burst[i]);
@@ -224,9 +234,11 @@ static int demod_qpsk(const float complex *burst, int n_symbols,
         else
             symbols[i] = 3;
 
-        /* Phase offset from ideal 45/135/225/315 grid */
-        float phase = (atan2f(im, re) + (float)M_PI) * 180.0f / (float)M_PI;
-        offsets[i] = 45.0f - fmodf(phase, 90.0f);
+        /* Within CONFIDENCE_ANGLE of the 45/135/225/315 grid: the cosine
+         * of the offset from the nearest diagonal is
+         * (|re| + |im|) / (sqrt(2) * mag), so no atan2 is needed */
+        in_grid[i] = mag > 0 &&
+                     fabsf(re) + fabsf(im) >= mag * CONFIDENCE_COS_SQRT2;
 
         n++;
 
@@ -247,15 +259,14 @@ static int demod_qpsk(const float complex *burst, int n_symbols,
     float sum = 0;
     for (int i = 0; i < n; i++) {
         sum += magnitudes[i];
-        if (fabsf(offsets[i]) <= CONFIDENCE_ANGLE)
-            n_ok++;
+        n_ok += in_grid[i];
     }
 
     *level_out = n > 0 ? sum / n : 0;
     *confidence_out = n > 0 ? (100 * n_ok) / n : 0;
 
-    free(offsets);
-    free(magnitudes);
+    frame_pool_free(in_grid);
+    frame_pool_free(magnitudes);
     return n;
 }
 
@@ -326,98 +337,47 @@ static float soft_check_sync_word(const float complex *pll_out, int n,
 
 /* ---- Symbol-to-bits mapping (MSB first) ---- */
 
-static void map_symbols_to_bits(const int *symbols, int n, uint8_t *bits)
-{
-    for (int i = 0; i < n; i++) {
-        bits[2 * i]     = (symbols[i] >> 1) & 1;  /* MSB */
-        bits[2 * i + 1] = symbols[i] & 1;          /* LSB */
-    }
-}
-
-/* ---- Burst IQ sample saving (for research/analysis) ---- */
-
-static void save_burst_iq(downmix_frame_t *in, const char *dir_name)
+/* Pack 32 symbols per word, MSB of each symbol first; bits must be zeroed */
+static void map_symbols_to_bits(const int *symbols, int n, uint64_t *bits)
 {
-    if (!dir_name) return;
-
-    /* Create directory if it doesn't exist */
-    struct stat st = {0};
-    if (stat(dir_name, &st) == -1) {
-        if (mkdir(dir_name, 0755) == -1 && errno != EEXIST) {
-            fprintf(stderr, "Warning: failed to create burst save directory: %s\n",
-                    strerror(errno));
-            return;
-        }
-    }
-
-    /* Format: <timestamp>_<freq>_<id>_<direction>.cf32 */
-    const char *dir_str = (in->direction == DIR_DOWNLINK) ? "DL" :
-                          (in->direction == DIR_UPLINK) ? "UL" : "UN";
-
-    char filename[512];
-    snprintf(filename, sizeof(filename), "%s/%020lu_%011.0f_%lu_%s",
-             dir_name, in->timestamp, in->center_frequency, in->id, dir_str);
-
-    /* Save IQ samples (cf32 format) */
-    char iq_file[520];
-    snprintf(iq_file, sizeof(iq_file), "%s.cf32", filename);
-    FILE *f = fopen(iq_file, "wb");
-    if (!f) {
-        fprintf(stderr, "Warning: failed to save burst IQ: %s\n", strerror(errno));
-        return;
+    for (int w = 0; w * 32 < n; w++) {
+        int end = n - w * 32 < 32 ? n - w * 32 : 32;
+        uint64_t v = 0;
+        for (int i = 0; i < end; i++)
+            v = (v << 2) | (uint64_t)(symbols[w * 32 + i] & 3);
+        bits[w] = v << (64 - 2 * end);
     }
-    fwrite(in->samples, sizeof(float complex), in->num_samples, f);
-    fclose(f);
-
-    /* Save metadata */
-    char meta_file[520];
-    snprintf(meta_file, sizeof(meta_file), "%s.meta", filename);
-    f = fopen(meta_file, "w");
-    if (!f) return;
-
-    fprintf(f, "burst_id: %lu\n", in->id);
-    fprintf(f, "timestamp_ns: %lu\n", in->timestamp);
-    fprintf(f, "center_freq_hz: %.0f\n", in->center_frequency);
-    fprintf(f, "sample_rate_hz: %.0f\n", in->sample_rate);
-    fprintf(f, "samples_per_symbol: %.2f\n", in->samples_per_symbol);
-    fprintf(f, "direction: %s\n", dir_str);
-    fprintf(f, "magnitude_db: %.2f\n", in->magnitude);
-    fprintf(f, "noise_dbfs_hz: %.2f\n", in->noise);
-    fprintf(f, "num_samples: %zu\n", in->num_samples);
-    fprintf(f, "uw_start_offset: %.2f\n", in->uw_start);
-    fclose(f);
 }
 
-/* ---- Main demodulation function ---- */
+/* ---- Per-frame stages around the PLL ---- */
 
-int qpsk_demod(downmix_frame_t *in, demod_frame_t **out)
+/* Decimate to 1 sample per symbol. *out is allocated and sized so the PLL
+ * output can overwrite it. Returns the symbol count, or -1. */
+static int decimate_frame(const downmix_frame_t *in, float complex **out)
 {
     int sps = (int)(in->samples_per_symbol + 0.5f);
     if (sps < 1) sps = 1;
 
     int max_symbols = (int)in->num_samples / sps + 1;
-    float complex *decimated = malloc(max_symbols * sizeof(float complex));
-    float complex *pll_out   = malloc(max_symbols * sizeof(float complex));
-    int *symbols             = malloc(max_symbols * sizeof(int));
-
-    if (!decimated || !pll_out || !symbols) {
-        free(decimated);
-        free(pll_out);
-        free(symbols);
-        return 0;
-    }
+    *out = frame_pool_alloc(max_symbols * sizeof(float complex));
+    if (!*out)
+        return -1;
 
-    /* Step 1: Decimate to 1 sample per symbol */
-    int n_symbols;
     if (use_gardner)
-        n_symbols = decimate_gardner(in->samples, (int)in->num_samples,
-                                     in->samples_per_symbol, decimated);
-    else
-        n_symbols = decimate_simple(in->samples, (int)in->num_samples,
-                                    in->samples_per_symbol, decimated);
+        return decimate_gardner(in->samples, (int)in->num_samples,
+                                in->samples_per_symbol, *out);
+    return decimate_simple(in->samples, (int)in->num_samples,
+                           in->samples_per_symbol, *out);
+}
 
-    /* Step 2: PLL phase correction */
-    float total_phase = qpsk_pll(decimated, pll_out, n_symbols, PLL_ALPHA);
+/* Everything after the PLL: decisions, UW check, DQPSK decode, bit
+ * packing and LLRs. Returns 1 and sets *out on success. */
+static int demod_finish(downmix_frame_t *in, const float complex *pll_out,
+                        int n_symbols, float total_phase, demod_frame_t **out)
+{
+    int *symbols = frame_pool_alloc((n_symbols > 0 ? n_symbols : 1) * sizeof(int));
+    if (!symbols)
+        return 0;
 
     /* Step 3: Hard-decision QPSK demod + confidence */
     float level;
@@ -442,11 +402,9 @@ int qpsk_demod(downmix_frame_t *in, demod_frame_t **out)
                 /* Save failed burst IQ if requested (for demod analysis) */
                 if (save_bursts_dir) {
                     in->direction = DIR_UNDEF;
-                    save_burst_iq(in, save_bursts_dir);
+                    burst_archive_add(in, 1);
                 }
-                free(decimated);
-                free(pll_out);
-                free(symbols);
+                frame_pool_free(symbols);
                 return 0;
             }
 
@@ -466,44 +424,44 @@ int qpsk_demod(downmix_frame_t *in, demod_frame_t **out)
 
     /* Save burst IQ if requested (for research/analysis) */
     if (save_bursts_dir) {
-        save_burst_iq(in, save_bursts_dir);
+        burst_archive_add(in, 0);
     }
 
     /* Step 5: DQPSK differential decode */
     decode_dqpsk(symbols, actual_symbols);
 
-    /* Step 6: Map to bits */
+    /* Step 6: Map to bits (packed into the frame below) */
+    if (actual_symbols > DEMOD_MAX_BITS / 2)
+        actual_symbols = DEMOD_MAX_BITS / 2;
     int n_bits = actual_symbols * 2;
-    uint8_t *bits = malloc(n_bits);
-    if (!bits) {
-        free(decimated);
-        free(pll_out);
-        free(symbols);
+
+    /* The output frame, with its LLRs in the same block */
+    demod_frame_t *frame = frame_pool_alloc(sizeof(demod_frame_t) +
+                                            n_bits * sizeof(float));
+    if (!frame) {
+        frame_pool_free(symbols);
         return 0;
     }
-    map_symbols_to_bits(symbols, actual_symbols, bits);
+    memset(frame, 0, sizeof(*frame));
+    float *llr = (float *)(frame + 1);
 
     /* Step 7: Compute per-bit soft reliability (LLR magnitude) from PLL output.
      * For QPSK: MSB reliability = |Re(symbol)|, LSB = |Im(symbol)|.
      * Normalized so average constellation distance = 1.0. */
-    float *llr = malloc(n_bits * sizeof(float));
-    if (llr) {
-        /* Compute average magnitude for normalization */
-        float sum_mag = 0;
-        for (int i = 0; i < actual_symbols; i++)
-            sum_mag += cabsf(pll_out[i]);
-        float scale = (actual_symbols > 0 && sum_mag > 0)
-                    ? (M_SQRT1_2f / (sum_mag / actual_symbols))
-                    : 1.0f;
-
-        for (int i = 0; i < actual_symbols; i++) {
-            llr[2 * i]     = fabsf(crealf(pll_out[i])) * scale;
-            llr[2 * i + 1] = fabsf(cimagf(pll_out[i])) * scale;
-        }
+    float sum_mag = 0;
+    for (int i = 0; i < actual_symbols; i++)
+        sum_mag += cabsf(pll_out[i]);
+    float scale = (actual_symbols > 0 && sum_mag > 0)
+                ? (M_SQRT1_2f / (sum_mag / actual_symbols))
+                : 1.0f;
+
+    for (int i = 0; i < actual_symbols; i++) {
+        llr[2 * i]     = fabsf(crealf(pll_out[i])) * scale;
+        llr[2 * i + 1] = fabsf(cimagf(pll_out[i])) * scale;
     }
 
-    /* Build output frame */
-    demod_frame_t *frame = calloc(1, sizeof(demod_frame_t));
+    /* Fill in the output frame */
+    map_symbols_to_bits(symbols, actual_symbols, frame->bits);
     frame->id = in->id;
     frame->timestamp = in->timestamp;
     frame->direction = in->direction;
@@ -513,7 +471,6 @@ int qpsk_demod(downmix_frame_t *in, demod_frame_t **out)
     frame->level = level;
     frame->n_symbols = actual_symbols;
     frame->n_payload_symbols = actual_symbols - IR_UW_LENGTH;
-    frame->bits = bits;
     frame->llr = llr;
     frame->n_bits = n_bits;
 
@@ -528,8 +485,106 @@ int qpsk_demod(downmix_frame_t *in, demod_frame_t **out)
 
     *out = frame;
 
-    free(decimated);
-    free(pll_out);
-    free(symbols);
+    frame_pool_free(symbols);
     return 1;
 }
+
+void demod_frame_free(demod_frame_t *frame)
+{
+    frame_pool_free(frame);
+}
+
+/* ---- Main demodulation function ---- */
+
+int qpsk_demod(downmix_frame_t *in, demod_frame_t **out)
+{
+    /* Step 1: Decimate to 1 sample per symbol */
+    float complex *decimated;
+    int n_symbols = decimate_frame(in, &decimated);
+    if (n_symbols < 0)
+        return 0;
+
+    float complex *pll_out = frame_pool_alloc((n_symbols > 0 ? n_symbols : 1) *
+                                              sizeof(float complex));
+    if (!pll_out) {
+        frame_pool_free(decimated);
+        return 0;
+    }
+
+    /* Step 2: PLL phase correction */
+    uint64_t t0 = pstats_now();
+    float total_phase = qpsk_pll(decimated, pll_out, n_symbols, PLL_ALPHA);
+    pstats_stage(STAGE_PLL, t0);
+
+    int ok = demod_finish(in, pll_out, n_symbols, total_phase, out);
+
+    frame_pool_free(decimated);
+    frame_pool_free(pll_out);
+    return ok;
+}
+
+/* ---- Batched demodulation ----
+ *
+ * Decimation is per frame (the Gardner loop moves its own sampling
+ * position), then the frames are transposed into one lane-interleaved
+ * buffer and simd_pll_batch runs all their PLLs in lock-step, one lane per
+ * frame. Shorter frames are zero-padded, which the kernel treats as "hold
+ * the loop". The corrected symbols go back to each frame's buffer for the
+ * per-frame tail.
+ */
+
+int qpsk_demod_batch(downmix_frame_t **in, int n, demod_frame_t **out)
+{
+    float complex *dec[QPSK_BATCH_MAX];
+    int n_sym[QPSK_BATCH_MAX];
+    float phase[SIMD_PLL_LANES];
+    int max_n = 0, n_ok = 0;
+
+    if (n > QPSK_BATCH_MAX)
+        n = QPSK_BATCH_MAX;
+
+    for (int k = 0; k < n; k++) {
+        out[k] = NULL;
+        n_sym[k] = decimate_frame(in[k], &dec[k]);
+        if (n_sym[k] < 0) {
+            dec[k] = NULL;
+            n_sym[k] = 0;
+        }
+        if (n_sym[k] > max_n)
+            max_n = n_sym[k];
+    }
+
+    uint64_t t0 = pstats_now();
+    size_t lanes_bytes = (size_t)max_n * SIMD_PLL_LANES * 2 * sizeof(float);
+    float *lanes = frame_pool_alloc(lanes_bytes);
+    if (lanes) {
+        memset(lanes, 0, lanes_bytes);
+        float *re = lanes, *im = lanes + (size_t)max_n * SIMD_PLL_LANES;
+        for (int k = 0; k < n; k++)
+            for (int i = 0; i < n_sym[k]; i++) {
+                re[i * SIMD_PLL_LANES + k] = crealf(dec[k][i]);
+                im[i * SIMD_PLL_LANES + k] = cimagf(dec[k][i]);
+            }
+
+        simd_pll_batch(re, im, max_n, n, PLL_ALPHA, phase);
+
+        for (int k = 0; k < n; k++)
+            for (int i = 0; i < n_sym[k]; i++)
+                dec[k][i] = re[i * SIMD_PLL_LANES + k] +
+                            im[i * SIMD_PLL_LANES + k] * I;
+        frame_pool_free(lanes);
+    } else {
+        /* No room for the lane buffer: one PLL at a time, in place */
+        for (int k = 0; k < n; k++)
+            phase[k] = qpsk_pll(dec[k], dec[k], n_sym[k], PLL_ALPHA);
+    }
+    pstats_stage(STAGE_PLL, t0);
+
+    for (int k = 0; k < n; k++) {
+        if (dec[k])
+            n_ok += demod_finish(in[k], dec[k], n_sym[k], phase[k], &out[k]);
+        frame_pool_free(dec[k]);
+    }
+
+    return n_ok;
+}
@@ -18,8 +18,13 @@
 
 #include <complex.h>
 #include <stdint.h>
+#include "bitpack.h"
 #include "burst_downmix.h"
 
+/* Longest demodulated frame (a full simplex burst is ~890 bits) */
+#define DEMOD_MAX_BITS      1024
+#define DEMOD_BIT_WORDS     BITPACK_WORDS(DEMOD_MAX_BITS)
+
 /* Demodulated frame output */
 typedef struct {
     uint64_t id;
@@ -32,15 +37,27 @@ typedef struct {
     float level;                /* average signal amplitude */
     int n_symbols;              /* total symbols including UW */
     int n_payload_symbols;      /* symbols after UW */
-    uint8_t *bits;              /* 2 bits per symbol (0 or 1 each) */
-    float *llr;                 /* per-bit reliability (|distance from boundary|) */
+    uint64_t bits[DEMOD_BIT_WORDS]; /* 2 bits per symbol, packed (bitpack.h) */
+    float *llr;                 /* per-bit reliability (|distance from boundary|),
+                                 * in the frame's own block */
     int n_bits;
 } demod_frame_t;
 
 /* Demodulate a downmixed frame. Returns 1 on success, 0 if frame invalid.
- * Caller owns returned frame and must free bits and frame. */
+ * Caller owns returned frame and frees it with demod_frame_free(). */
 int qpsk_demod(downmix_frame_t *in, demod_frame_t **out);
 
+/* Free a frame from qpsk_demod(); NULL is a no-op */
+void demod_frame_free(demod_frame_t *frame);
+
+/* Most frames one qpsk_demod_batch call takes (one PLL lane each) */
+#define QPSK_BATCH_MAX      16
+
+/* Demodulate up to QPSK_BATCH_MAX frames with their PLLs run side by side
+ * across SIMD lanes. out[k] is set as qpsk_demod would, or NULL if frame k
+ * is invalid. Returns the number of frames demodulated. */
+int qpsk_demod_batch(downmix_frame_t **in, int n, demod_frame_t **out);
+
 /* Thread function: pulls from frame_queue, pushes to output_queue */
 void *qpsk_demod_thread(void *arg);
 
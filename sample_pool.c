@@ -0,0 +1,146 @@
+/*
+ * Sample buffer pool
+ *
+ * Fixed-capacity free list of sample buffers shared by the SDR backends,
+ * the file reader and the detector. Push and pop are a lock-free Treiber
+ * stack over slot indices with a tag in the upper half of the head word
+ * to defeat ABA.
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Sample buffer pool
+ *
+ * Fixed-capacity free list of sample buffers shared by the SDR backends,
+ * the file reader and the detector. Push and pop are a lock-free Treiber
+ * stack over slot indices with a tag in the upper half of the head word
+ * to defeat ABA.
+ */
+
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "sample_pool.h"
+
+#define POOL_NO_SLOT UINT_MAX
+
+/* Hidden header in front of every sample_buf_t handed out */
+typedef struct {
+    unsigned slot;          /* pool slot, or POOL_NO_SLOT if malloc'd */
+    unsigned reserved;
+} pool_hdr_t;
+
+static unsigned pool_capacity = 0;
+static pool_hdr_t **slots;          /* slot memory, created on first use */
+static atomic_uint *next_free;      /* free list links: slot + 1, 0 = end */
+static atomic_ullong free_head;     /* (tag << 32) | (slot + 1) */
+static atomic_size_t slot_bytes;    /* payload size, fixed by first request */
+static atomic_uint n_created;
+static atomic_uint n_in_use;
+static atomic_ulong n_misses;
+
+void sample_pool_init(unsigned capacity) {
+    pool_capacity = capacity;
+    slots = calloc(capacity, sizeof(*slots));
+    next_free = calloc(capacity, sizeof(*next_free));
+    atomic_init(&free_head, 0);
+    atomic_init(&slot_bytes, 0);
+    atomic_init(&n_created, 0);
+    atomic_init(&n_in_use, 0);
+    atomic_init(&n_misses, 0);
+}
+
+static unsigned pool_pop(void) {
+    unsigned long long head = atomic_load(&free_head);
+    while (1) {
+        unsigned top = (unsigned)(head & 0xffffffffu);
+        if (top == 0)
+            return POOL_NO_SLOT;
+        unsigned long long tag = (head >> 32) + 1;
+        unsigned long long new_head = (tag << 32) | atomic_load(&next_free[top - 1]);
+        if (atomic_compare_exchange_weak(&free_head, &head, new_head))
+            return top - 1;
+    }
+}
+
+static void pool_push(unsigned slot) {
+    unsigned long long head = atomic_load(&free_head);
+    while (1) {
+        atomic_store(&next_free[slot], (unsigned)(head & 0xffffffffu));
+        unsigned long long tag = (head >> 32) + 1;
+        unsigned long long new_head = (tag << 32) | (slot + 1);
+        if (atomic_compare_exchange_weak(&free_head, &head, new_head))
+            return;
+    }
+}
+
+sample_buf_t *sample_buf_alloc(size_t payload_bytes) {
+    size_t size = atomic_load(&slot_bytes);
+    if (size == 0) {
+        atomic_compare_exchange_strong(&slot_bytes, &size, payload_bytes);
+        size = atomic_load(&slot_bytes);
+    }
+
+    if (pool_capacity > 0 && payload_bytes <= size) {
+        unsigned slot = pool_pop();
+
+        /* Free list empty: create another slot while under capacity */
+        if (slot == POOL_NO_SLOT && atomic_load(&n_created) < pool_capacity) {
+            unsigned i = atomic_fetch_add(&n_created, 1);
+            if (i < pool_capacity) {
+                pool_hdr_t *h = malloc(sizeof(*h) + sizeof(sample_buf_t) + size);
+                if (!h)
+                    return NULL;
+                h->slot = i;
+                slots[i] = h;
+                slot = i;
+            }
+        }
+
+        if (slot != POOL_NO_SLOT) {
+            atomic_fetch_add(&n_in_use, 1);
+            sample_buf_t *s = (sample_buf_t *)(slots[slot] + 1);
+            s->ext = NULL;
+            s->release = NULL;
+            s->rx = 0;
+            return s;
+        }
+    }
+
+    /* Pool exhausted or request larger than a slot */
+    atomic_fetch_add(&n_misses, 1);
+    pool_hdr_t *h = malloc(sizeof(*h) + sizeof(sample_buf_t) + payload_bytes);
+    if (!h)
+        return NULL;
+    h->slot = POOL_NO_SLOT;
+    sample_buf_t *s = (sample_buf_t *)(h + 1);
+    s->ext = NULL;
+    s->release = NULL;
+    s->rx = 0;
+    return s;
+}
+
+void sample_buf_free(sample_buf_t *s) {
+    if (!s)
+        return;
+    if (s->release)
+        s->release(s);
+    pool_hdr_t *h = (pool_hdr_t *)s - 1;
+    if (h->slot == POOL_NO_SLOT) {
+        free(h);
+        return;
+    }
+    atomic_fetch_sub(&n_in_use, 1);
+    pool_push(h->slot);
+}
+
+void sample_pool_stats(unsigned *in_use, unsigned *capacity,
+                       unsigned long *misses) {
+    if (in_use) *in_use = atomic_load(&n_in_use);
+    if (capacity) *capacity = pool_capacity;
+    if (misses) *misses = atomic_load(&n_misses);
+}
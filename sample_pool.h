@@ -0,0 +1,46 @@
+/*
+ * Sample buffer pool -- lock-free recycling of sample_buf_t blocks
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Sample buffer pool -- lock-free recycling of sample_buf_t blocks
+ *
+ * SDR callbacks and the file reader allocate one buffer per block and the
+ * detector releases it, on different threads. Recycling them through a
+ * fixed-size free list keeps the hot path out of malloc. Slots are created
+ * on first use (so idle capacity costs no memory) and all have the payload
+ * size of the first request; larger requests, and requests made while every
+ * slot is in use, fall back to malloc and are counted as misses.
+ */
+
+#ifndef __SAMPLE_POOL_H__
+#define __SAMPLE_POOL_H__
+
+#include <stddef.h>
+
+#include "sdr.h"
+
+/* Slots beyond samples_queue capacity: buffers held by the producer and
+ * the detector while the queue is full */
+#define SAMPLE_POOL_SLACK 64
+
+/* Set the pool capacity in buffers. Call once before any allocation. */
+void sample_pool_init(unsigned capacity);
+
+/* Get a sample buffer with room for payload_bytes of samples. Returns NULL
+ * only if malloc fails. */
+sample_buf_t *sample_buf_alloc(size_t payload_bytes);
+
+/* Return a buffer from sample_buf_alloc(), handing a driver buffer it
+ * carries back through its release hook first */
+void sample_buf_free(sample_buf_t *s);
+
+/* Pool buffers currently handed out, pool capacity, and allocations
+ * that had to fall back to malloc */
+void sample_pool_stats(unsigned *in_use, unsigned *capacity,
+                       unsigned long *misses);
+
+#endif
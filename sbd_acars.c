@@ -13,19 +13,14 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
-#include <arpa/inet.h>
 #include <errno.h>
-#include <netdb.h>
-#include <netinet/in.h>
-#include <netinet/tcp.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/socket.h>
 #include <time.h>
-#include <unistd.h>
 
+#include "net_output.h"
 #include "sbd_acars.h"
 
 #ifdef HAVE_LIBACARS
@@ -42,23 +37,21 @@ int acars_json = 0;
 extern int acars_enabled;
 static const char *station = NULL;
 
+/* Network sinks are served by the output I/O thread (net_output.h) */
+
 /* ---- UDP JSON streaming (up to 4 endpoints) ---- */
 
 #define UDP_MAX 4
 static int udp_count = 0;
-static int udp_fds[UDP_MAX];
-static struct sockaddr_in udp_addrs[UDP_MAX];
+static net_sink_t *udp_sinks[UDP_MAX];
 
 /* ---- Aggregator feed: UDP endpoint (iridium-toolkit format) ---- */
 
-static int hub_fd = -1;
-static struct sockaddr_in hub_addr;
+static net_sink_t *hub_sink = NULL;
 
 /* ---- Aggregator feed: TCP endpoint (iridium-toolkit format) ---- */
 
-static int airframes_fd = -1;
-static char *airframes_saved_host = NULL;
-static int airframes_saved_port = 0;
+static net_sink_t *airframes_sink = NULL;
 
 /* JSON output buffer -- used to build JSON for dual stdout/UDP dispatch */
 #define JSON_BUF_SIZE 8192
@@ -93,12 +86,8 @@ static void json_buf_emit(void)
     }
 
     /* UDP streams (--acars-udp, one or more endpoints) */
-    for (int i = 0; i < udp_count; i++) {
-        if (udp_fds[i] >= 0) {
-            sendto(udp_fds[i], json_buf, json_pos, 0,
-                   (struct sockaddr *)&udp_addrs[i], sizeof(udp_addrs[i]));
-        }
-    }
+    for (int i = 0; i < udp_count; i++)
+        net_send(udp_sinks[i], json_buf, json_pos);
 }
 
 /* Forward declarations */
@@ -126,68 +115,19 @@ static void hub_buf_append(const char *fmt, ...)
     if (hub_pos >= JSON_BUF_SIZE) hub_pos = JSON_BUF_SIZE - 1;
 }
 
-/* Attempt TCP connection to airframes endpoint (hostname resolved via getaddrinfo) */
-static int airframes_connect(const char *host, int port)
-{
-    char port_str[16];
-    snprintf(port_str, sizeof(port_str), "%d", port);
-
-    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM };
-    struct addrinfo *res = NULL;
-    if (getaddrinfo(host, port_str, &hints, &res) != 0 || !res)
-        return -1;
-
-    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
-    if (fd < 0) {
-        freeaddrinfo(res);
-        return -1;
-    }
-
-    if (connect(fd, res->ai_addr, res->ai_addrlen) != 0) {
-        close(fd);
-        freeaddrinfo(res);
-        return -1;
-    }
-    freeaddrinfo(res);
-
-    /* Disable Nagle for low-latency sends */
-    int flag = 1;
-    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
-
-    return fd;
-}
-
 static void hub_buf_emit(void)
 {
     if (hub_pos == 0) return;
 
     /* UDP to acarshub */
-    if (hub_fd >= 0)
-        sendto(hub_fd, hub_buf, hub_pos, 0,
-               (struct sockaddr *)&hub_addr, sizeof(hub_addr));
-
-    /* TCP to airframes.io */
-    if (airframes_fd >= 0 || airframes_saved_host) {
-        /* Reconnect if needed */
-        if (airframes_fd < 0 && airframes_saved_host) {
-            airframes_fd = airframes_connect(airframes_saved_host,
-                                             airframes_saved_port);
-            if (airframes_fd >= 0)
-                fprintf(stderr, "ACARS: reconnected to airframes %s:%d\n",
-                        airframes_saved_host, airframes_saved_port);
-        }
-
-        if (airframes_fd >= 0) {
-            /* Send JSON + newline over TCP (MSG_NOSIGNAL avoids SIGPIPE) */
-            ssize_t r = send(airframes_fd, hub_buf, hub_pos, MSG_NOSIGNAL);
-            if (r > 0)
-                r = send(airframes_fd, "\n", 1, MSG_NOSIGNAL);
-            if (r <= 0) {
-                /* Connection lost -- close and retry next message */
-                close(airframes_fd);
-                airframes_fd = -1;
-            }
-        }
+    net_send(hub_sink, hub_buf, hub_pos);
+
+    /* TCP to airframes.io, one line per message (hub_pos stays below
+     * JSON_BUF_SIZE, so the newline fits) */
+    if (airframes_sink) {
+        hub_buf[hub_pos] = '\n';
+        net_send(airframes_sink, hub_buf, hub_pos + 1);
+        hub_buf[hub_pos] = '\0';
     }
 }
 
@@ -232,7 +172,7 @@ static void hub_emit_acars(const char *mode, const char *reg, char ack,
                             uint64_t timestamp, double frequency,
                             float magnitude, const uint8_t *hdr, int hdr_len)
 {
-    if (hub_fd < 0 && airframes_fd < 0 && !airframes_saved_host) return;
+    if (!hub_sink && !airframes_sink) return;
 
     /* Timestamp as ISO-8601 */
     char ts_buf[32];
@@ -312,6 +252,7 @@ static int stat_sbd_single = 0;     /* single-packet messages */
 static int stat_sbd_multi_ok = 0;   /* completed multi-packet messages */
 static int stat_sbd_multi_frag = 0; /* multi-packet fragments processed */
 static int stat_sbd_broken = 0;     /* orphan/expired fragments */
+static int stat_sbd_evicted = 0;    /* partials evicted at the table cap */
 static int stat_acars_total = 0;    /* ACARS messages decoded */
 static int stat_acars_errors = 0;   /* ACARS with CRC/parity errors */
 
@@ -380,23 +321,47 @@ static uint16_t crc16_kermit(const uint8_t *data, int len)
 
 /* ---- SBD multi-packet reassembly ---- */
 
-#define SBD_MAX_MULTI    8
 #define SBD_MAX_DATA     1024
 #define SBD_TIMEOUT_NS   5000000000ULL  /* 5 seconds */
 
+/* Partial messages held at once: the table starts small and doubles on
+ * demand up to the cap, after which the oldest partial is evicted */
+#define SBD_MULTI_INITIAL   16
+#define SBD_MULTI_MAX       4096
+
+/* Partials are indexed by the message number their next fragment
+ * carries (a byte, so next is at most 256) in each direction */
+#define SBD_NEXT_KEYS       257
+
+/* Expiry timer wheel: 2^27 ns (134 ms) ticks, 64 of them spanning 8.6 s,
+ * more than SBD_TIMEOUT_NS, so a partial's deadline is never more than
+ * one turn of the wheel ahead */
+#define SBD_WHEEL_SHIFT     27
+#define SBD_WHEEL_SLOTS     64
+
 typedef struct {
-    int active;
     int msgno;          /* last received message number */
     int msgcnt;         /* total expected messages */
     int ul;             /* direction: 1=uplink, 0=downlink */
     uint64_t timestamp; /* timestamp of last fragment */
     double frequency;
     float magnitude;
-    uint8_t data[SBD_MAX_DATA];
+    int key_prev;       /* partials waiting for the same fragment */
+    int key_next;       /* (or the free list) */
+    int wheel_prev;     /* partials expiring in the same wheel tick */
+    int wheel_next;
     int data_len;
+    uint8_t data[SBD_MAX_DATA];
 } sbd_multi_t;
 
-static sbd_multi_t sbd_multi[SBD_MAX_MULTI];
+static sbd_multi_t *sbd_multi = NULL;
+static int sbd_multi_cap = 0;
+static int sbd_multi_used = 0;
+static int sbd_multi_free = -1;
+static int sbd_index[2 * SBD_NEXT_KEYS];       /* oldest partial per key */
+static int sbd_index_tail[2 * SBD_NEXT_KEYS];  /* newest */
+static int sbd_wheel[SBD_WHEEL_SLOTS];
+static uint64_t sbd_wheel_tick = 0;
 
 /* ================================================================
  * libacars path -- full ARINC-622/ADS-C/CPDLC decoding
@@ -575,7 +540,7 @@ static void acars_parse_libacars(const uint8_t *data, int len, int ul,
     }
 
     /* acarshub/airframes compat output (iridium-toolkit format) */
-    if ((hub_fd >= 0 || airframes_fd >= 0 || airframes_saved_host) &&
+    if ((hub_sink || airframes_sink) &&
         !msg->err) {
         char mode_str[2] = { msg->mode, '\0' };
 
@@ -937,7 +902,7 @@ static void acars_parse_fallback(const uint8_t *data, int len, int ul,
                           hdr, hdr_len, errors);
 
     /* acarshub/airframes compat output (iridium-toolkit format) */
-    if ((hub_fd >= 0 || airframes_fd >= 0 || airframes_saved_host) &&
+    if ((hub_sink || airframes_sink) &&
         errors == 0) {
         char mode_str[2] = { (char)stripped[0], '\0' };
 
@@ -1043,14 +1008,142 @@ static void sbd_process(const uint8_t *sbd_data, int sbd_len, int ul,
         sbd_output_raw(sbd_data, sbd_len, ul, timestamp, frequency);
 }
 
+static int sbd_key(const sbd_multi_t *s)
+{
+    return s->ul * SBD_NEXT_KEYS + s->msgno + 1;
+}
+
+static int sbd_wheel_slot(const sbd_multi_t *s)
+{
+    return (int)(((s->timestamp + SBD_TIMEOUT_NS) >> SBD_WHEEL_SHIFT)
+                 & (SBD_WHEEL_SLOTS - 1));
+}
+
+/* Oldest first within a key, so a continuation joins the partial that
+ * has waited longest for it */
+static void sbd_link(int idx)
+{
+    sbd_multi_t *s = &sbd_multi[idx];
+    int key = sbd_key(s);
+    s->key_prev = sbd_index_tail[key];
+    s->key_next = -1;
+    if (s->key_prev >= 0)
+        sbd_multi[s->key_prev].key_next = idx;
+    else
+        sbd_index[key] = idx;
+    sbd_index_tail[key] = idx;
+
+    int *head = &sbd_wheel[sbd_wheel_slot(s)];
+    s->wheel_prev = -1;
+    s->wheel_next = *head;
+    if (*head >= 0)
+        sbd_multi[*head].wheel_prev = idx;
+    *head = idx;
+}
+
+static void sbd_unlink(int idx)
+{
+    sbd_multi_t *s = &sbd_multi[idx];
+    if (s->key_prev >= 0)
+        sbd_multi[s->key_prev].key_next = s->key_next;
+    else
+        sbd_index[sbd_key(s)] = s->key_next;
+    if (s->key_next >= 0)
+        sbd_multi[s->key_next].key_prev = s->key_prev;
+    else
+        sbd_index_tail[sbd_key(s)] = s->key_prev;
+
+    if (s->wheel_prev >= 0)
+        sbd_multi[s->wheel_prev].wheel_next = s->wheel_next;
+    else
+        sbd_wheel[sbd_wheel_slot(s)] = s->wheel_next;
+    if (s->wheel_next >= 0)
+        sbd_multi[s->wheel_next].wheel_prev = s->wheel_prev;
+}
+
+static void sbd_release(int idx)
+{
+    sbd_unlink(idx);
+    sbd_multi[idx].key_next = sbd_multi_free;
+    sbd_multi_free = idx;
+    sbd_multi_used--;
+}
+
+/* Double the table, keeping slot indices (the lists hold indices, so a
+ * moved table needs no relinking). Returns 0 at the cap or out of memory. */
+static int sbd_grow(void)
+{
+    int cap = sbd_multi_cap ? 2 * sbd_multi_cap : SBD_MULTI_INITIAL;
+    if (cap > SBD_MULTI_MAX)
+        return 0;
+    sbd_multi_t *t = realloc(sbd_multi, cap * sizeof(*t));
+    if (!t)
+        return 0;
+    sbd_multi = t;
+    for (int i = cap - 1; i >= sbd_multi_cap; i--) {
+        sbd_multi[i].key_next = sbd_multi_free;
+        sbd_multi_free = i;
+    }
+    sbd_multi_cap = cap;
+    return 1;
+}
+
+/* Oldest partial: the earliest deadline lies in the first occupied wheel
+ * slot from the current tick on */
+static int sbd_oldest(void)
+{
+    for (int i = 0; i < SBD_WHEEL_SLOTS; i++) {
+        int idx = sbd_wheel[(sbd_wheel_tick + i) & (SBD_WHEEL_SLOTS - 1)];
+        int oldest = idx;
+        for (; idx >= 0; idx = sbd_multi[idx].wheel_next)
+            if (sbd_multi[idx].timestamp < sbd_multi[oldest].timestamp)
+                oldest = idx;
+        if (oldest >= 0)
+            return oldest;
+    }
+    return -1;
+}
+
+/* Free slot for a new partial, growing the table or evicting the oldest */
+static int sbd_alloc(void)
+{
+    if (sbd_multi_free < 0 && !sbd_grow()) {
+        int idx = sbd_oldest();
+        if (idx < 0)
+            return -1;
+        sbd_release(idx);
+        stat_sbd_evicted++;
+    }
+    int idx = sbd_multi_free;
+    sbd_multi_free = sbd_multi[idx].key_next;
+    sbd_multi_used++;
+    return idx;
+}
+
+/* Drop partials whose last fragment is older than SBD_TIMEOUT_NS. Only
+ * the wheel slots for the ticks since the last call are visited. */
 static void sbd_expire(uint64_t now_ns)
 {
-    for (int i = 0; i < SBD_MAX_MULTI; i++) {
-        if (sbd_multi[i].active &&
-            now_ns > sbd_multi[i].timestamp + SBD_TIMEOUT_NS) {
-            sbd_multi[i].active = 0;
+    uint64_t tick = now_ns >> SBD_WHEEL_SHIFT;
+    if (sbd_multi_used == 0 || tick < sbd_wheel_tick) {
+        if (sbd_multi_used == 0)
+            sbd_wheel_tick = tick;
+        return;
+    }
+
+    uint64_t n = tick - sbd_wheel_tick + 1;
+    if (n > SBD_WHEEL_SLOTS)
+        n = SBD_WHEEL_SLOTS;
+    for (uint64_t t = tick + 1 - n; t <= tick; t++) {
+        int idx = sbd_wheel[t & (SBD_WHEEL_SLOTS - 1)];
+        while (idx >= 0) {
+            int next = sbd_multi[idx].wheel_next;
+            if (now_ns > sbd_multi[idx].timestamp + SBD_TIMEOUT_NS)
+                sbd_release(idx);
+            idx = next;
         }
     }
+    sbd_wheel_tick = tick;
 }
 
 static void sbd_extract(const uint8_t *data, int len, int ul,
@@ -1160,23 +1253,11 @@ static void sbd_extract(const uint8_t *data, int len, int ul,
         stat_sbd_single++;
         sbd_process(sbd_data, sbd_len, ul, timestamp, frequency, magnitude);
     } else if (msgcnt > 1) {
-        int idx = -1;
-        for (int i = 0; i < SBD_MAX_MULTI; i++) {
-            if (!sbd_multi[i].active) { idx = i; break; }
-        }
-        if (idx < 0) {
-            uint64_t oldest = UINT64_MAX;
-            for (int i = 0; i < SBD_MAX_MULTI; i++) {
-                if (sbd_multi[i].timestamp < oldest) {
-                    oldest = sbd_multi[i].timestamp;
-                    idx = i;
-                }
-            }
-        }
-        if (idx < 0) idx = 0;
+        int idx = sbd_alloc();
+        if (idx < 0)
+            return;
 
         sbd_multi_t *s = &sbd_multi[idx];
-        s->active = 1;
         s->msgno = msgno;
         s->msgcnt = msgcnt;
         s->ul = ul;
@@ -1186,32 +1267,36 @@ static void sbd_extract(const uint8_t *data, int len, int ul,
         s->data_len = (sbd_len > (int)sizeof(s->data)) ?
                       (int)sizeof(s->data) : sbd_len;
         memcpy(s->data, sbd_data, s->data_len);
+        sbd_link(idx);
     } else if (msgno > 1) {
-        for (int i = SBD_MAX_MULTI - 1; i >= 0; i--) {
-            sbd_multi_t *s = &sbd_multi[i];
-            if (!s->active) continue;
-            if (s->ul != ul) continue;
-            if (msgno != s->msgno + 1) continue;
-
-            int space = (int)sizeof(s->data) - s->data_len;
-            int copy = (sbd_len > space) ? space : sbd_len;
-            if (copy > 0) {
-                memcpy(s->data + s->data_len, sbd_data, copy);
-                s->data_len += copy;
-            }
-            s->msgno = msgno;
-            s->timestamp = timestamp;
-
-            stat_sbd_multi_frag++;
-            if (msgno == s->msgcnt) {
-                stat_sbd_multi_ok++;
-                sbd_process(s->data, s->data_len, ul, timestamp,
-                            s->frequency, s->magnitude);
-                s->active = 0;
-            }
+        int idx = sbd_multi ? sbd_index[ul * SBD_NEXT_KEYS + msgno] : -1;
+        if (idx < 0) {
+            stat_sbd_broken++;
             return;
         }
-        stat_sbd_broken++;
+
+        sbd_multi_t *s = &sbd_multi[idx];
+        sbd_unlink(idx);
+        int space = (int)sizeof(s->data) - s->data_len;
+        int copy = (sbd_len > space) ? space : sbd_len;
+        if (copy > 0) {
+            memcpy(s->data + s->data_len, sbd_data, copy);
+            s->data_len += copy;
+        }
+        s->msgno = msgno;
+        s->timestamp = timestamp;
+
+        stat_sbd_multi_frag++;
+        if (msgno == s->msgcnt) {
+            stat_sbd_multi_ok++;
+            sbd_process(s->data, s->data_len, ul, timestamp,
+                        s->frequency, s->magnitude);
+            s->key_next = sbd_multi_free;
+            sbd_multi_free = idx;
+            sbd_multi_used--;
+        } else {
+            sbd_link(idx);
+        }
     }
 }
 
@@ -1223,67 +1308,48 @@ void acars_init(const char *station_id, const char **udp_hosts,
                 const char *af_host, int af_port)
 {
     station = station_id;
-    memset(sbd_multi, 0, sizeof(sbd_multi));
+    for (int i = 0; i < 2 * SBD_NEXT_KEYS; i++)
+        sbd_index[i] = sbd_index_tail[i] = -1;
+    for (int i = 0; i < SBD_WHEEL_SLOTS; i++)
+        sbd_wheel[i] = -1;
+    sbd_grow();
     if (!crc_initialized)
         crc16_init();
 
     /* UDP JSON streaming endpoints (dumpvdl2 format) */
     udp_count = 0;
     for (int i = 0; i < n_udp && i < UDP_MAX; i++) {
-        int fd = socket(AF_INET, SOCK_DGRAM, 0);
-        if (fd < 0) {
-            perror("acars_init: UDP socket");
-            continue;
-        }
-        struct sockaddr_in addr;
-        memset(&addr, 0, sizeof(addr));
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(udp_ports[i]);
-        if (inet_pton(AF_INET, udp_hosts[i], &addr.sin_addr) != 1) {
+        char name[16];
+        snprintf(name, sizeof(name), "acars_udp%d", i);
+        net_sink_t *sink = net_sink_udp(name, udp_hosts[i], udp_ports[i]);
+        if (!sink) {
             fprintf(stderr, "acars_init: invalid UDP host '%s'\n",
                     udp_hosts[i]);
-            close(fd);
             continue;
         }
-        udp_fds[udp_count] = fd;
-        udp_addrs[udp_count] = addr;
-        udp_count++;
+        udp_sinks[udp_count++] = sink;
         fprintf(stderr, "ACARS: UDP JSON stream -> %s:%d\n",
                 udp_hosts[i], udp_ports[i]);
     }
 
     /* acarshub compatibility endpoint (iridium-toolkit format, UDP) */
     if (hub_host && hub_port > 0) {
-        hub_fd = socket(AF_INET, SOCK_DGRAM, 0);
-        if (hub_fd < 0) {
-            perror("acars_init: acarshub socket");
-        } else {
-            memset(&hub_addr, 0, sizeof(hub_addr));
-            hub_addr.sin_family = AF_INET;
-            hub_addr.sin_port = htons(hub_port);
-            if (inet_pton(AF_INET, hub_host, &hub_addr.sin_addr) != 1) {
-                fprintf(stderr, "acars_init: invalid acarshub host '%s'\n",
-                        hub_host);
-                close(hub_fd);
-                hub_fd = -1;
-            } else {
-                fprintf(stderr, "ACARS: acarshub UDP stream -> %s:%d\n",
-                        hub_host, hub_port);
-            }
-        }
+        hub_sink = net_sink_udp("acarshub", hub_host, hub_port);
+        if (!hub_sink)
+            fprintf(stderr, "acars_init: invalid acarshub host '%s'\n",
+                    hub_host);
+        else
+            fprintf(stderr, "ACARS: acarshub UDP stream -> %s:%d\n",
+                    hub_host, hub_port);
     }
 
-    /* airframes.io direct feed (iridium-toolkit format, TCP) */
+    /* airframes.io direct feed (iridium-toolkit format, TCP); connected
+     * in the background by the I/O thread */
     if (af_host && af_port > 0) {
-        airframes_saved_host = strdup(af_host);
-        airframes_saved_port = af_port;
-        airframes_fd = airframes_connect(af_host, af_port);
-        if (airframes_fd >= 0)
+        airframes_sink = net_sink_tcp("airframes", af_host, af_port);
+        if (airframes_sink)
             fprintf(stderr, "ACARS: airframes TCP stream -> %s:%d\n",
                     af_host, af_port);
-        else
-            fprintf(stderr, "ACARS: airframes %s:%d connect failed "
-                    "(will retry on first message)\n", af_host, af_port);
     }
 
 #ifdef HAVE_LIBACARS
@@ -1296,23 +1362,15 @@ void acars_init(const char *station_id, const char **udp_hosts,
 
 void acars_shutdown(void)
 {
-    for (int i = 0; i < udp_count; i++) {
-        if (udp_fds[i] >= 0) {
-            close(udp_fds[i]);
-            udp_fds[i] = -1;
-        }
-    }
+    /* The sockets are closed by net_output_shutdown() */
     udp_count = 0;
-    if (hub_fd >= 0) {
-        close(hub_fd);
-        hub_fd = -1;
-    }
-    if (airframes_fd >= 0) {
-        close(airframes_fd);
-        airframes_fd = -1;
-    }
-    free(airframes_saved_host);
-    airframes_saved_host = NULL;
+    hub_sink = NULL;
+    airframes_sink = NULL;
+    free(sbd_multi);
+    sbd_multi = NULL;
+    sbd_multi_cap = 0;
+    sbd_multi_used = 0;
+    sbd_multi_free = -1;
 #ifdef HAVE_LIBACARS
     if (reasm_ctx) {
         la_reasm_ctx_destroy(reasm_ctx);
@@ -1342,6 +1400,9 @@ void acars_print_stats(void)
     if (stat_sbd_multi_frag > 0 || stat_sbd_broken > 0)
         fprintf(stderr, "SBD: %d multi-pkt fragments, %d broken/orphan\n",
                 stat_sbd_multi_frag, stat_sbd_broken);
+    if (stat_sbd_evicted > 0)
+        fprintf(stderr, "SBD: %d partial messages evicted (%d held)\n",
+                stat_sbd_evicted, SBD_MULTI_MAX);
     fprintf(stderr, "ACARS: %d messages decoded", stat_acars_total);
     if (stat_acars_errors > 0)
         fprintf(stderr, " (%d with errors)", stat_acars_errors);
@@ -25,7 +25,7 @@ void acars_init(const char *station_id, const char **udp_hosts,
                 const char *af_host, int af_port);
 
 /* IDA message callback for ACARS processing.
- * Pass this to ida_reassemble() as the callback function. */
+ * Register with ida_add_sink(). */
 void acars_ida_cb(const uint8_t *data, int len,
                   uint64_t timestamp, double frequency,
                   ir_direction_t direction, float magnitude,
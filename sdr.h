@@ -9,13 +9,51 @@
 
 #define SAMPLE_FMT_INT8   0
 #define SAMPLE_FMT_FLOAT  1
+#define SAMPLE_FMT_INT16  2
+
+/* Receivers (SDRs and network inputs) one process captures from at once */
+#define SDR_MAX_RX        8
+
+typedef enum {
+    RX_HACKRF,
+    RX_BLADERF,
+    RX_USRP,
+    RX_SOAPY,
+    RX_NET,
+} rx_kind_t;
+
+/* One -i or --net-input: what to open and where to tune it */
+typedef struct {
+    rx_kind_t kind;
+    char *arg;            /* serial, device args or network spec */
+    int num;              /* bladerfN / soapy-N index, -1 if by args */
+    double center_freq;
+} rx_spec_t;
+
+/* A stream thread's argument: the backend's device and the receiver its
+ * blocks are tagged with */
+typedef struct {
+    void *dev;
+    int rx;
+} sdr_stream_t;
 
 typedef struct _sample_buf_t {
     unsigned num;
-    int format;           /* SAMPLE_FMT_INT8 or SAMPLE_FMT_FLOAT */
-    int8_t samples[];     /* for SAMPLE_FMT_FLOAT: cast to float* (4x larger) */
+    int format;           /* SAMPLE_FMT_* */
+    const int8_t *ext;    /* if set, samples live here (mapped file, driver
+                             buffer), not below */
+    /* If set, sample_buf_free() calls it to hand ext back to its owner */
+    void (*release)(struct _sample_buf_t *s);
+    uintptr_t handle;     /* owner's id for ext, for release */
+    void *owner;          /* owner of ext, for release */
+    int rx;               /* receiver the block came from, 0 = the first */
+    int8_t samples[];     /* FLOAT/INT16: cast to float* / int16_t* */
 } sample_buf_t;
 
+static inline const int8_t *sample_buf_data(const sample_buf_t *s) {
+    return s->ext ? s->ext : s->samples;
+}
+
 void push_samples(sample_buf_t *buf);
 
 #endif
@@ -0,0 +1,293 @@
+/*
+ * Shared-memory ring
+ *
+ * The writer publishes reserve before it touches the data and head after,
+ * so a reader can tell a record it copied from one the writer was
+ * overwriting meanwhile, the way a seqlock does, without the writer ever
+ * looking at the readers.
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "shm_ring.h"
+
+#define REC_HDR     16
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t format;
+    uint64_t capacity;
+    uint64_t writer_pid;
+    _Atomic uint64_t reserve;
+    _Atomic uint64_t head;
+    _Atomic uint32_t closed;
+    _Atomic uint32_t preamble_len;
+    uint8_t pad[8];
+    uint8_t preamble[SHM_RING_PREAMBLE_MAX];
+} shm_ring_hdr_t;
+
+_Static_assert(sizeof(shm_ring_hdr_t) == SHM_RING_HEADER,
+               "shm ring header layout");
+
+typedef struct {
+    uint32_t len;
+    uint32_t type;
+    uint64_t seq;
+} shm_rec_t;
+
+struct shm_ring {
+    shm_ring_hdr_t *hdr;
+    uint8_t *data;
+    size_t map_len;
+    uint64_t pos;           /* next write position */
+    uint64_t seq;
+    char name[256];
+};
+
+static size_t pad8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+static void shm_path(char *out, size_t cap, const char *name) {
+    snprintf(out, cap, "%s%s", name[0] == '/' ? "" : "/", name);
+}
+
+/* ---- Writer ---- */
+
+shm_ring_t *shm_ring_create(const char *name, size_t capacity, int format) {
+    size_t cap = 4096;
+    while (cap < capacity)
+        cap *= 2;
+
+    shm_ring_t *r = calloc(1, sizeof(*r));
+    if (!r)
+        return NULL;
+    shm_path(r->name, sizeof(r->name), name);
+    r->map_len = SHM_RING_HEADER + cap;
+
+    /* A new object, so readers of a previous run keep their old mapping */
+    shm_unlink(r->name);
+    int fd = shm_open(r->name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+        goto fail;
+    if (ftruncate(fd, (off_t)r->map_len) != 0) {
+        int e = errno;
+        close(fd);
+        shm_unlink(r->name);
+        errno = e;
+        goto fail;
+    }
+    void *p = mmap(NULL, r->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int e = errno;
+    close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(r->name);
+        errno = e;
+        goto fail;
+    }
+
+    r->hdr = p;
+    r->data = (uint8_t *)p + SHM_RING_HEADER;
+    r->hdr->version = SHM_RING_VERSION;
+    r->hdr->format = (uint32_t)format;
+    r->hdr->capacity = cap;
+    r->hdr->writer_pid = (uint64_t)getpid();
+    /* Magic last: a reader that sees it sees a complete header */
+    atomic_thread_fence(memory_order_release);
+    memcpy(r->hdr->magic, SHM_RING_MAGIC, sizeof(r->hdr->magic));
+    return r;
+
+fail:
+    free(r);
+    return NULL;
+}
+
+void shm_ring_write(shm_ring_t *r, const void *data, size_t len) {
+    uint64_t cap = r->hdr->capacity;
+    size_t need = REC_HDR + pad8(len);
+    if (need > cap / 4)
+        return;
+
+    uint64_t pos = r->pos;
+    uint64_t off = pos & (cap - 1);
+    uint64_t skip = off + need > cap ? cap - off : 0;
+
+    /* Claim the bytes before writing them */
+    atomic_store_explicit(&r->hdr->reserve, pos + skip + need,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    if (skip) {
+        if (skip >= REC_HDR) {
+            shm_rec_t pad = { 0, SHM_REC_PAD, 0 };
+            memcpy(r->data + off, &pad, sizeof(pad));
+        }
+        pos += skip;
+        off = 0;
+    }
+    shm_rec_t rec = { (uint32_t)len, SHM_REC_DATA, r->seq++ };
+    memcpy(r->data + off, &rec, sizeof(rec));
+    memcpy(r->data + off + REC_HDR, data, len);
+
+    r->pos = pos + need;
+    atomic_store_explicit(&r->hdr->head, r->pos, memory_order_release);
+}
+
+void shm_ring_set_preamble(shm_ring_t *r, const void *data, size_t len) {
+    if (len > SHM_RING_PREAMBLE_MAX)
+        return;
+    atomic_store_explicit(&r->hdr->preamble_len, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(r->hdr->preamble, data, len);
+    atomic_store_explicit(&r->hdr->preamble_len, (uint32_t)len,
+                          memory_order_release);
+}
+
+void shm_ring_destroy(shm_ring_t *r) {
+    if (!r)
+        return;
+    atomic_store_explicit(&r->hdr->closed, 1, memory_order_release);
+    munmap(r->hdr, r->map_len);
+    shm_unlink(r->name);
+    free(r);
+}
+
+/* ---- Reader ---- */
+
+static const shm_ring_hdr_t *rd_hdr(const shm_ring_reader_t *rd) {
+    return (const shm_ring_hdr_t *)rd->map;
+}
+
+int shm_ring_open(shm_ring_reader_t *rd, const char *name) {
+    char path[256];
+    shm_path(path, sizeof(path), name);
+    memset(rd, 0, sizeof(*rd));
+
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < SHM_RING_HEADER) {
+        close(fd);
+        errno = EPROTO;
+        return -1;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    int e = errno;
+    close(fd);
+    if (p == MAP_FAILED) {
+        errno = e;
+        return -1;
+    }
+
+    const shm_ring_hdr_t *h = p;
+    if (memcmp(h->magic, SHM_RING_MAGIC, sizeof(h->magic)) != 0 ||
+        h->version != SHM_RING_VERSION ||
+        SHM_RING_HEADER + h->capacity > (uint64_t)st.st_size) {
+        munmap(p, (size_t)st.st_size);
+        errno = EPROTO;
+        return -1;
+    }
+    atomic_thread_fence(memory_order_acquire);
+
+    rd->map = p;
+    rd->map_len = (size_t)st.st_size;
+    rd->data = (const uint8_t *)p + SHM_RING_HEADER;
+    rd->capacity = h->capacity;
+    rd->format = (int)h->format;
+    rd->cursor = atomic_load_explicit(&((shm_ring_hdr_t *)h)->head,
+                                      memory_order_acquire);
+    return 0;
+}
+
+size_t shm_ring_preamble(const shm_ring_reader_t *rd, void *buf, size_t cap) {
+    shm_ring_hdr_t *h = (shm_ring_hdr_t *)rd_hdr(rd);
+    uint32_t len = atomic_load_explicit(&h->preamble_len, memory_order_acquire);
+    if (len > cap || len > SHM_RING_PREAMBLE_MAX)
+        return 0;
+    memcpy(buf, h->preamble, len);
+    return len;
+}
+
+int shm_ring_read(shm_ring_reader_t *rd, void *buf, size_t cap, size_t *len,
+                  uint64_t *lost) {
+    shm_ring_hdr_t *h = (shm_ring_hdr_t *)rd_hdr(rd);
+    uint64_t size = rd->capacity;
+
+    for (;;) {
+        uint64_t head = atomic_load_explicit(&h->head, memory_order_acquire);
+        if (rd->cursor == head) {
+            if (atomic_load_explicit(&h->closed, memory_order_acquire) &&
+                atomic_load_explicit(&h->head, memory_order_acquire) == head)
+                return -1;
+            return 0;
+        }
+        if (head - rd->cursor > size) {
+            rd->cursor = head;      /* lapped: continue at the newest */
+            continue;
+        }
+
+        uint64_t off = rd->cursor & (size - 1);
+        if (size - off < REC_HDR) {
+            rd->cursor += size - off;
+            continue;
+        }
+        shm_rec_t rec;
+        memcpy(&rec, rd->data + off, sizeof(rec));
+        size_t need = REC_HDR + pad8(rec.len);
+        int fits = rec.type == SHM_REC_DATA && off + need <= size;
+        if (fits && rec.len <= cap)
+            memcpy(buf, rd->data + off + REC_HDR, rec.len);
+
+        /* Anything the writer claimed past cursor + size overwrote us */
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t reserve = atomic_load_explicit(&h->reserve,
+                                                memory_order_relaxed);
+        if (reserve - rd->cursor > size) {
+            rd->cursor = atomic_load_explicit(&h->head, memory_order_acquire);
+            continue;
+        }
+
+        if (rec.type == SHM_REC_PAD) {
+            rd->cursor += size - off;
+            continue;
+        }
+        if (!fits) {
+            /* Not a record boundary: only a writer bug gets here */
+            rd->cursor = head;
+            continue;
+        }
+
+        rd->cursor += need;
+        if (rd->seq_known && rec.seq > rd->next_seq && lost)
+            *lost += rec.seq - rd->next_seq;
+        rd->next_seq = rec.seq + 1;
+        rd->seq_known = 1;
+        if (rec.len > cap) {
+            if (lost)
+                (*lost)++;
+            continue;
+        }
+        *len = rec.len;
+        return 1;
+    }
+}
+
+void shm_ring_close(shm_ring_reader_t *rd) {
+    if (rd->map)
+        munmap((void *)rd->map, rd->map_len);
+    rd->map = NULL;
+}
@@ -0,0 +1,124 @@
+/*
+ * Shared-memory ring -- frame output for any number of local readers
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Shared-memory ring -- frame output for any number of local readers
+ *
+ * --shm=NAME creates a POSIX shared memory object (/dev/shm/NAME) holding
+ * a header and a power-of-two ring of records. The sniffer writes each
+ * output line or binary record into it once; readers map it read-only and
+ * follow with cursors of their own. The writer never waits for readers: a
+ * reader that falls a whole ring behind finds its records overwritten,
+ * sees that from the reserve position, and skips to the newest record.
+ * Record sequence numbers tell it how many it lost.
+ *
+ * Layout (native byte order, which is little-endian on every supported
+ * target; offsets in bytes):
+ *
+ *   header, SHM_RING_HEADER bytes:
+ *     0   char magic[8]       SHM_RING_MAGIC
+ *     8   u32  version        SHM_RING_VERSION
+ *     12  u32  format         SHM_RING_TEXT or SHM_RING_BIN
+ *     16  u64  capacity       data bytes, a power of two
+ *     24  u64  writer_pid
+ *     32  u64  reserve        end of the record being written (atomic)
+ *     40  u64  head           end of the last complete record (atomic)
+ *     48  u32  closed         1 once the writer has stopped (atomic)
+ *     52  u32  preamble_len   followed at 64 by the preamble: for BIN, the
+ *                             FRAME_BIN_STREAM record a reader needs first
+ *   data, capacity bytes, from SHM_RING_HEADER:
+ *     records at 8-byte aligned positions (position % capacity):
+ *       u32 len               payload bytes
+ *       u32 type              SHM_REC_DATA, or SHM_REC_PAD: continue at
+ *                             the start of the ring
+ *       u64 seq               record number, from 0
+ *       payload, padded to 8 bytes
+ *
+ * Positions count bytes since the ring was created and never wrap. A
+ * record never straddles the end of the ring: the writer pads to the end
+ * instead (implicitly when fewer than 16 bytes are left). TEXT payloads
+ * are output lines with their newline, so the payloads of a ring in order
+ * are exactly what stdout would get; BIN payloads are frame_bin.h records
+ * with their length prefix.
+ *
+ * A reader copies a record out, then checks that reserve has not passed
+ * the record's position plus the capacity; if it has, the copy may be torn
+ * and the reader resynchronizes at head.
+ */
+
+#ifndef __SHM_RING_H__
+#define __SHM_RING_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHM_RING_MAGIC          "IRSHMRG1"
+#define SHM_RING_VERSION        1
+#define SHM_RING_HEADER         4096
+#define SHM_RING_PREAMBLE_MAX   (SHM_RING_HEADER - 64)
+
+#define SHM_RING_TEXT           0
+#define SHM_RING_BIN            1
+
+#define SHM_REC_DATA            0
+#define SHM_REC_PAD             1
+
+/* Default --shm name and --shm-mb */
+#define SHM_RING_DEFAULT_NAME   "iridium-sniffer"
+#define SHM_RING_DEFAULT_MB     16
+
+typedef struct shm_ring shm_ring_t;
+
+/* ---- Writer (one thread) ---- */
+
+/* Create (replacing any stale one) the object NAME ('/' is prepended if
+ * missing) with a ring of capacity bytes, rounded up to a power of two.
+ * Returns NULL with errno set on failure. */
+shm_ring_t *shm_ring_create(const char *name, size_t capacity, int format);
+
+/* Append one record. Records larger than a quarter of the ring are
+ * dropped. */
+void shm_ring_write(shm_ring_t *r, const void *data, size_t len);
+
+/* Set the preamble late readers get before their first record (at most
+ * SHM_RING_PREAMBLE_MAX bytes) */
+void shm_ring_set_preamble(shm_ring_t *r, const void *data, size_t len);
+
+/* Mark the ring closed, unmap it and remove the name. Readers that have
+ * it mapped drain what is left and then see it closed. */
+void shm_ring_destroy(shm_ring_t *r);
+
+/* ---- Reader ---- */
+
+typedef struct {
+    const uint8_t *map;
+    size_t map_len;
+    const uint8_t *data;
+    uint64_t capacity;
+    uint64_t cursor;
+    uint64_t next_seq;
+    int seq_known;
+    int format;
+} shm_ring_reader_t;
+
+/* Map the object NAME read-only; reading starts at the newest record.
+ * Returns 0, or -1 with errno set (EPROTO: not a ring of this version). */
+int shm_ring_open(shm_ring_reader_t *rd, const char *name);
+
+/* Copy the preamble into buf; returns its length (0 if none) */
+size_t shm_ring_preamble(const shm_ring_reader_t *rd, void *buf, size_t cap);
+
+/* Copy the next record into buf (cap bytes; longer records are skipped
+ * and counted as lost) and set *len. Records overwritten before they were
+ * read are added to *lost. Returns 1 for a record, 0 if there is none yet,
+ * or -1 if the writer has closed the ring and everything has been read. */
+int shm_ring_read(shm_ring_reader_t *rd, void *buf, size_t cap, size_t *len,
+                  uint64_t *lost);
+
+void shm_ring_close(shm_ring_reader_t *rd);
+
+#endif
@@ -13,6 +13,7 @@
 
 #include <immintrin.h>
 #include <complex.h>
+#include <math.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
@@ -109,6 +110,55 @@ void avx2_fir_ccf_dec(const float *taps, int ntaps,
     }
 }
 
+/* ---- Decimating complex FIR on int16 IQ (Q15 path) ---- */
+
+void avx2_fir_q15_dec(const int16_t *taps, int ntaps, const int16_t *in,
+                      float complex *out, int n_out, int decimation,
+                      float scale) {
+    const int16_t *tr = taps;
+    const int16_t *ti = taps + 2 * pad_to_8(ntaps);
+    float *outp = (float *)out;
+
+    for (int i = 0; i < n_out; i++) {
+        const int16_t *p = &in[2 * i * decimation];
+        __m256i acc_re = _mm256_setzero_si256();
+        __m256i acc_im = _mm256_setzero_si256();
+        int k = 0;
+
+        /* 8 complex samples: each int32 lane is re*a + im*b of one sample */
+        for (; k + 7 < ntaps; k += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i *)&p[2 * k]);
+            acc_re = _mm256_add_epi32(acc_re, _mm256_madd_epi16(x,
+                        _mm256_loadu_si256((const __m256i *)&tr[2 * k])));
+            acc_im = _mm256_add_epi32(acc_im, _mm256_madd_epi16(x,
+                        _mm256_loadu_si256((const __m256i *)&ti[2 * k])));
+        }
+
+        /* [re0+re1, re2+re3, im0+im1, im2+im3] per half, then both halves */
+        __m256i h = _mm256_hadd_epi32(acc_re, acc_im);
+        __m128i q = _mm_add_epi32(_mm256_castsi256_si128(h),
+                                  _mm256_extracti128_si256(h, 1));
+        if (k + 3 < ntaps) {
+            __m128i x = _mm_loadu_si128((const __m128i *)&p[2 * k]);
+            __m128i re = _mm_madd_epi16(x, _mm_loadu_si128((const __m128i *)&tr[2 * k]));
+            __m128i im = _mm_madd_epi16(x, _mm_loadu_si128((const __m128i *)&ti[2 * k]));
+            q = _mm_add_epi32(q, _mm_hadd_epi32(re, im));
+            k += 4;
+        }
+        q = _mm_hadd_epi32(q, q);
+        int32_t acc_r = _mm_cvtsi128_si32(q);
+        int32_t acc_i = _mm_extract_epi32(q, 1);
+
+        for (; k < ntaps; k++) {
+            acc_r += p[2 * k] * tr[2 * k] + p[2 * k + 1] * tr[2 * k + 1];
+            acc_i += p[2 * k] * ti[2 * k] + p[2 * k + 1] * ti[2 * k + 1];
+        }
+
+        outp[i * 2] = scale * (float)acc_r;
+        outp[i * 2 + 1] = scale * (float)acc_i;
+    }
+}
+
 /* ---- Real FIR filter ----
  *
  * Process 8 outputs at a time. For each tap, broadcast coefficient,
@@ -137,6 +187,150 @@ void avx2_fir_fff(const float *taps, int ntaps,
     }
 }
 
+/* ---- Fixed-length FIR kernels ----
+ *
+ * The three kernels above with ntaps (and the decimation) constant: each
+ * body is inlined into one function per length in SIMD_FIR_*_FIXED, so
+ * the tap loops unroll completely. Every output is summed in the same
+ * order as above.
+ */
+#define FIXED_INLINE static inline __attribute__((always_inline))
+#define FIXED_MAX_TAPS 128
+
+/* Four groups of 4 outputs per iteration share each tap broadcast */
+FIXED_INLINE void fir_ccf_fixed(const float *taps, const int ntaps,
+                                const float complex *in, float complex *out,
+                                int n) {
+    const float *inp = (const float *)in;
+    float *outp = (float *)out;
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+        __m256 a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+#pragma GCC unroll 128
+        for (int k = 0; k < ntaps; k++) {
+            __m256 c = _mm256_set1_ps(taps[k]);
+            const float *p = &inp[(i + k) * 2];
+            a0 = _mm256_fmadd_ps(c, _mm256_loadu_ps(p), a0);
+            a1 = _mm256_fmadd_ps(c, _mm256_loadu_ps(p + 8), a1);
+            a2 = _mm256_fmadd_ps(c, _mm256_loadu_ps(p + 16), a2);
+            a3 = _mm256_fmadd_ps(c, _mm256_loadu_ps(p + 24), a3);
+        }
+        _mm256_storeu_ps(&outp[i * 2], a0);
+        _mm256_storeu_ps(&outp[i * 2 + 8], a1);
+        _mm256_storeu_ps(&outp[i * 2 + 16], a2);
+        _mm256_storeu_ps(&outp[i * 2 + 24], a3);
+    }
+    if (i < n)
+        avx2_fir_ccf(taps, ntaps, in + i, out + i, n - i);
+}
+
+/* Taps duplicated into pairs once per call instead of once per output */
+FIXED_INLINE void fir_ccf_dec_fixed(const float *taps, const int ntaps,
+                                    const float complex *in,
+                                    float complex *out, int n_out,
+                                    const int decimation) {
+    const float *inp = (const float *)in;
+    float *outp = (float *)out;
+    const int n4 = ntaps / 4 * 4;
+    __m256 c[FIXED_MAX_TAPS / 4];
+
+#pragma GCC unroll 32
+    for (int k = 0; k < n4; k += 4) {
+        __m128 t4 = _mm_loadu_ps(&taps[k]);
+        c[k / 4] = _mm256_set_m128(_mm_unpackhi_ps(t4, t4),
+                                   _mm_unpacklo_ps(t4, t4));
+    }
+
+    for (int i = 0; i < n_out; i++) {
+        const float *p = &inp[i * decimation * 2];
+        __m256 acc = _mm256_setzero_ps();
+#pragma GCC unroll 32
+        for (int k = 0; k < n4; k += 4)
+            acc = _mm256_fmadd_ps(c[k / 4], _mm256_loadu_ps(&p[k * 2]), acc);
+
+        __m128 lo = _mm256_castps256_ps128(acc);
+        __m128 hi = _mm256_extractf128_ps(acc, 1);
+        __m128 sum = _mm_add_ps(lo, hi);
+        __m128 pair_hi = _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 2, 3, 2));
+        __m128 result = _mm_add_ps(sum, pair_hi);
+        float acc_re = _mm_cvtss_f32(result);
+        float acc_im = _mm_cvtss_f32(_mm_shuffle_ps(result, result, 1));
+
+#pragma GCC unroll 4
+        for (int k = n4; k < ntaps; k++) {
+            acc_re += taps[k] * p[k * 2];
+            acc_im += taps[k] * p[k * 2 + 1];
+        }
+        outp[i * 2] = acc_re;
+        outp[i * 2 + 1] = acc_im;
+    }
+}
+
+/* Four groups of 8 outputs per iteration */
+FIXED_INLINE void fir_fff_fixed(const float *taps, const int ntaps,
+                                const float *in, float *out, int n) {
+    int i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+        __m256 a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+#pragma GCC unroll 128
+        for (int k = 0; k < ntaps; k++) {
+            __m256 c = _mm256_set1_ps(taps[k]);
+            a0 = _mm256_fmadd_ps(c, _mm256_loadu_ps(&in[i + k]), a0);
+            a1 = _mm256_fmadd_ps(c, _mm256_loadu_ps(&in[i + k + 8]), a1);
+            a2 = _mm256_fmadd_ps(c, _mm256_loadu_ps(&in[i + k + 16]), a2);
+            a3 = _mm256_fmadd_ps(c, _mm256_loadu_ps(&in[i + k + 24]), a3);
+        }
+        _mm256_storeu_ps(&out[i], a0);
+        _mm256_storeu_ps(&out[i + 8], a1);
+        _mm256_storeu_ps(&out[i + 16], a2);
+        _mm256_storeu_ps(&out[i + 24], a3);
+    }
+    if (i < n)
+        avx2_fir_fff(taps, ntaps, in + i, out + i, n - i);
+}
+
+#define FIR_CCF_FIXED(N) \
+    static void avx2_fir_ccf_##N(const float *taps, int ntaps, \
+                                 const float complex *in, \
+                                 float complex *out, int n) { \
+        (void)ntaps; \
+        fir_ccf_fixed(taps, N, in, out, n); \
+    }
+#define FIR_CCF_DEC_FIXED(N, D) \
+    static void avx2_fir_ccf_dec_##N##_##D(const float *taps, int ntaps, \
+                                           const float complex *in, \
+                                           float complex *out, int n_out, \
+                                           int decimation) { \
+        _Static_assert(N <= FIXED_MAX_TAPS, "fixed FIR too long"); \
+        (void)ntaps; (void)decimation; \
+        fir_ccf_dec_fixed(taps, N, in, out, n_out, D); \
+    }
+#define FIR_FFF_FIXED(N) \
+    static void avx2_fir_fff_##N(const float *taps, int ntaps, \
+                                 const float *in, float *out, int n) { \
+        (void)ntaps; \
+        fir_fff_fixed(taps, N, in, out, n); \
+    }
+
+SIMD_FIR_CCF_FIXED(FIR_CCF_FIXED)
+SIMD_FIR_CCF_DEC_FIXED(FIR_CCF_DEC_FIXED)
+SIMD_FIR_FFF_FIXED(FIR_FFF_FIXED)
+
+#define CCF_ENTRY(N)        { N, 0, avx2_fir_ccf_##N, NULL, NULL },
+#define CCF_DEC_ENTRY(N, D) { N, D, NULL, avx2_fir_ccf_dec_##N##_##D, NULL },
+#define FFF_ENTRY(N)        { N, 0, NULL, NULL, avx2_fir_fff_##N },
+
+const simd_fir_fixed_t avx2_fir_fixed[] = {
+    SIMD_FIR_CCF_FIXED(CCF_ENTRY)
+    SIMD_FIR_CCF_DEC_FIXED(CCF_DEC_ENTRY)
+    SIMD_FIR_FFF_FIXED(FFF_ENTRY)
+    { 0, 0, NULL, NULL, NULL },
+};
+
 /* ---- Window multiply: complex * real ----
  *
  * Load 4 complex (8 floats), duplicate 4 window values to 8 lanes
@@ -293,6 +487,90 @@ void avx2_convert_i8_cf(const int8_t *iq, float complex *out, size_t n) {
     }
 }
 
+/* ---- int8 IQ -> windowed float complex ----
+ *
+ * avx2_convert_i8_cf() with the window multiply of avx2_window_cf() on
+ * the converted vectors, so the float frame is written once.
+ */
+void avx2_window_i8_cf(const int8_t *iq, const float *window,
+                       float complex *out, int n) {
+    float *outp = (float *)out;
+    __m256 scale = _mm256_set1_ps(1.0f / 128.0f);
+    int i = 0;
+
+    /* 8 complex samples (16 int8 values) per iteration */
+    for (; i + 7 < n; i += 8) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)&iq[i * 2]);
+        __m256 lo = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(bytes)),
+                                  scale);
+        __m256 hi = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(
+                                      _mm_srli_si128(bytes, 8))), scale);
+
+        __m128 w_lo = _mm_loadu_ps(&window[i]);
+        __m128 w_hi = _mm_loadu_ps(&window[i + 4]);
+        __m256 c_lo = _mm256_set_m128(_mm_unpackhi_ps(w_lo, w_lo),
+                                      _mm_unpacklo_ps(w_lo, w_lo));
+        __m256 c_hi = _mm256_set_m128(_mm_unpackhi_ps(w_hi, w_hi),
+                                      _mm_unpacklo_ps(w_hi, w_hi));
+        _mm256_storeu_ps(&outp[i * 2], _mm256_mul_ps(lo, c_lo));
+        _mm256_storeu_ps(&outp[(i + 4) * 2], _mm256_mul_ps(hi, c_hi));
+    }
+
+    /* Scalar tail */
+    for (; i < n; i++) {
+        outp[i * 2] = iq[2 * i] / 128.0f * window[i];
+        outp[i * 2 + 1] = iq[2 * i + 1] / 128.0f * window[i];
+    }
+}
+
+/* ---- int16 IQ -> float complex ---- */
+void avx2_convert_i16_cf(const int16_t *iq, float complex *out, size_t n) {
+    float *outp = (float *)out;
+    __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    size_t i = 0;
+
+    /* 8 complex samples (16 int16 values) per iteration */
+    for (; i + 7 < n; i += 8) {
+        __m128i lo = _mm_loadu_si128((const __m128i *)&iq[i * 2]);
+        __m128i hi = _mm_loadu_si128((const __m128i *)&iq[i * 2 + 8]);
+        _mm256_storeu_ps(&outp[i * 2],
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(lo)), scale));
+        _mm256_storeu_ps(&outp[(i + 4) * 2],
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(hi)), scale));
+    }
+
+    /* Scalar tail */
+    for (; i < n; i++) {
+        outp[i * 2] = iq[2 * i] / 32768.0f;
+        outp[i * 2 + 1] = iq[2 * i + 1] / 32768.0f;
+    }
+}
+
+/* ---- int16 IQ -> windowed float complex ---- */
+void avx2_window_i16_cf(const int16_t *iq, const float *window,
+                        float complex *out, int n) {
+    float *outp = (float *)out;
+    __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    int i = 0;
+
+    /* 4 complex samples (8 int16 values) per iteration */
+    for (; i + 3 < n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&iq[i * 2]);
+        __m256 data = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(v)),
+                                    scale);
+        __m128 w4 = _mm_loadu_ps(&window[i]);
+        __m256 coeff = _mm256_set_m128(_mm_unpackhi_ps(w4, w4),
+                                       _mm_unpacklo_ps(w4, w4));
+        _mm256_storeu_ps(&outp[i * 2], _mm256_mul_ps(data, coeff));
+    }
+
+    /* Scalar tail */
+    for (; i < n; i++) {
+        outp[i * 2] = iq[2 * i] / 32768.0f * window[i];
+        outp[i * 2 + 1] = iq[2 * i + 1] / 32768.0f * window[i];
+    }
+}
+
 /* ---- Magnitude-squared of complex array ---- */
 void avx2_mag_squared(const float complex *in, float *out, int n) {
     const float *inp = (const float *)in;
@@ -337,6 +615,32 @@ float avx2_max_float(const float *in, int n) {
     return max_val;
 }
 
+/* ---- Detector peak bins ----
+ *
+ * Compare 8 bins at a time; most blocks have no bin over the threshold
+ * and cost one movemask, the rest are walked bit by bit.
+ */
+int avx2_peak_bins(const float *mag, const float *mask, float threshold,
+                   int start, int end, int *bins) {
+    __m256 vthr = _mm256_set1_ps(threshold);
+    int n = 0;
+    int i = start;
+    for (; i + 7 < end; i += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(&mag[i]),
+                                 _mm256_loadu_ps(&mask[i]));
+        unsigned bits = (unsigned)_mm256_movemask_ps(
+            _mm256_cmp_ps(v, vthr, _CMP_GT_OQ));
+        while (bits) {
+            bins[n++] = i + __builtin_ctz(bits);
+            bits &= bits - 1;
+        }
+    }
+    for (; i < end; i++)
+        if (mag[i] * mask[i] > threshold)
+            bins[n++] = i;
+    return n;
+}
+
 /* ---- Complex square with window: out[i] = in[i]^2 * window[i] ----
  *
  * (a+bi)^2 = (a^2 - b^2) + (2ab)i
@@ -386,3 +690,187 @@ void avx2_csquare_window(const float complex *in, const float *window,
         outp[i * 2 + 1] = (2.0f * a * b) * window[i];
     }
 }
+
+/* ---- Complex dot product ----
+ *
+ * One accumulator takes a * b lane by lane (ar*br, ai*bi), the other a
+ * times b with re/im swapped (ar*bi, ai*br); the real part is then the
+ * even lanes minus the odd lanes of the first, the imaginary part the sum
+ * of the second.
+ */
+float complex avx2_dot_cc(const float complex *a, const float complex *b,
+                          int n) {
+    const float *ap = (const float *)a;
+    const float *bp = (const float *)b;
+    __m256 acc_rr = _mm256_setzero_ps();
+    __m256 acc_ri = _mm256_setzero_ps();
+    int i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m256 va = _mm256_loadu_ps(&ap[i * 2]);
+        __m256 vb = _mm256_loadu_ps(&bp[i * 2]);
+        acc_rr = _mm256_fmadd_ps(va, vb, acc_rr);
+        acc_ri = _mm256_fmadd_ps(va, _mm256_permute_ps(vb, 0xB1), acc_ri);
+    }
+
+    float rr[8], ri[8];
+    _mm256_storeu_ps(rr, acc_rr);
+    _mm256_storeu_ps(ri, acc_ri);
+    float re = (rr[0] - rr[1]) + (rr[2] - rr[3]) + (rr[4] - rr[5]) + (rr[6] - rr[7]);
+    float im = (ri[0] + ri[1]) + (ri[2] + ri[3]) + (ri[4] + ri[5]) + (ri[6] + ri[7]);
+
+    for (; i < n; i++) {
+        float ar = ap[i * 2], ai = ap[i * 2 + 1];
+        float br = bp[i * 2], bi = bp[i * 2 + 1];
+        re += ar * br - ai * bi;
+        im += ar * bi + ai * br;
+    }
+    return re + im * I;
+}
+
+/* ---- Chase candidate selection ----
+ *
+ * 8 candidates per iteration: gather the error entries of their syndromes
+ * and the reliabilities of both positions, and keep a per-lane minimum.
+ * Lanes see increasing m, so strict < keeps the lowest m per lane and the
+ * final reduction breaks ties on the index.
+ */
+int avx2_chase_select(const uint16_t *syn, const float *cost, int n,
+                      const uint16_t *err, const float *rel) {
+    const __m256i low16 = _mm256_set1_epi32(0xFFFF);
+    const __m256i none = _mm256_set1_epi32(SIMD_CHASE_NONE);
+    const __m256i pos_mask = _mm256_set1_epi32(31);
+    const __m256 inf = _mm256_set1_ps(INFINITY);
+    __m256 best = inf;
+    __m256i best_idx = _mm256_set1_epi32(-1);
+    __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    int m = 0;
+
+    for (; m + 8 <= n; m += 8) {
+        __m256i s = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(syn + m)));
+        __m256i e = _mm256_and_si256(_mm256_i32gather_epi32((const int *)err, s, 2), low16);
+        __m256i p1 = _mm256_and_si256(e, pos_mask);
+        __m256i p2 = _mm256_and_si256(_mm256_srli_epi32(e, 5), pos_mask);
+
+        /* Same summation order as the scalar loop */
+        __m256 c = _mm256_add_ps(_mm256_add_ps(_mm256_loadu_ps(cost + m),
+                                               _mm256_i32gather_ps(rel, p1, 4)),
+                                 _mm256_i32gather_ps(rel, p2, 4));
+        c = _mm256_blendv_ps(c, inf, _mm256_castsi256_ps(_mm256_cmpeq_epi32(e, none)));
+
+        __m256 lt = _mm256_cmp_ps(c, best, _CMP_LT_OQ);
+        best = _mm256_blendv_ps(best, c, lt);
+        best_idx = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(best_idx),
+                                                        _mm256_castsi256_ps(idx), lt));
+        idx = _mm256_add_epi32(idx, _mm256_set1_epi32(8));
+    }
+
+    float lane_cost[8];
+    int32_t lane_idx[8];
+    _mm256_storeu_ps(lane_cost, best);
+    _mm256_storeu_si256((__m256i *)lane_idx, best_idx);
+
+    int best_m = -1;
+    float best_cost = INFINITY;
+    for (int l = 0; l < 8; l++) {
+        if (lane_idx[l] < 0)
+            continue;
+        if (lane_cost[l] < best_cost ||
+            (lane_cost[l] == best_cost && lane_idx[l] < best_m)) {
+            best_cost = lane_cost[l];
+            best_m = lane_idx[l];
+        }
+    }
+
+    for (; m < n; m++) {
+        uint16_t e = err[syn[m]];
+        if (e == SIMD_CHASE_NONE)
+            continue;
+        float c = cost[m] + rel[e & 31] + rel[(e >> 5) & 31];
+        if (c < best_cost) {
+            best_cost = c;
+            best_m = m;
+        }
+    }
+    return best_m;
+}
+
+/* ---- Lock-step QPSK PLL (as generic_pll_batch, 8 lanes per pass) ---- */
+
+static inline __m256 sign_of(__m256 x, __m256 zero) {
+    return _mm256_blendv_ps(_mm256_set1_ps(-1.0f), _mm256_set1_ps(1.0f),
+                            _mm256_cmp_ps(x, zero, _CMP_GE_OQ));
+}
+
+void avx2_pll_batch(float *re, float *im, int n, int lanes, float alpha,
+                    float *phase) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 tiny = _mm256_set1_ps(1e-20f);
+    const __m256 scale = _mm256_set1_ps(alpha * 4.0f);
+
+    for (int g = 0; g < lanes; g += 8) {
+        __m256 pr = one, pi = zero, total = zero;
+
+        for (int i = 0; i < n; i++) {
+            float *rp = &re[i * SIMD_PLL_LANES + g];
+            float *ip = &im[i * SIMD_PLL_LANES + g];
+            __m256 yr = _mm256_loadu_ps(rp);
+            __m256 yi = _mm256_loadu_ps(ip);
+            __m256 xr = _mm256_sub_ps(_mm256_mul_ps(yr, pr), _mm256_mul_ps(yi, pi));
+            __m256 xi = _mm256_add_ps(_mm256_mul_ps(yr, pi), _mm256_mul_ps(yi, pr));
+            _mm256_storeu_ps(rp, xr);
+            _mm256_storeu_ps(ip, xi);
+
+            __m256 mag2 = _mm256_add_ps(_mm256_mul_ps(xr, xr), _mm256_mul_ps(xi, xi));
+            __m256 live = _mm256_cmp_ps(mag2, tiny, _CMP_GE_OQ);
+            if (_mm256_movemask_ps(live) == 0)
+                continue;
+
+            __m256 sr = sign_of(xr, zero), si = sign_of(xi, zero);
+            __m256 er = _mm256_add_ps(_mm256_mul_ps(sr, xr), _mm256_mul_ps(si, xi));
+            __m256 ei = _mm256_sub_ps(_mm256_mul_ps(sr, xi), _mm256_mul_ps(si, xr));
+            __m256 m = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(er, er),
+                                                    _mm256_mul_ps(ei, ei)));
+            __m256 c = _mm256_div_ps(er, m), s = _mm256_div_ps(ei, m);
+
+            __m256 c1 = _mm256_sqrt_ps(_mm256_mul_ps(_mm256_add_ps(one, c), half));
+            __m256 s1 = _mm256_div_ps(s, _mm256_mul_ps(two, c1));
+            __m256 u = _mm256_div_ps(s1, _mm256_add_ps(one, c1));
+            __m256 u2 = _mm256_mul_ps(u, u);
+            __m256 at = _mm256_add_ps(_mm256_set1_ps(-1.0f / 7),
+                                      _mm256_mul_ps(u2, _mm256_set1_ps(1.0f / 9)));
+            at = _mm256_add_ps(_mm256_set1_ps(1.0f / 5), _mm256_mul_ps(u2, at));
+            at = _mm256_add_ps(_mm256_set1_ps(-1.0f / 3), _mm256_mul_ps(u2, at));
+            at = _mm256_mul_ps(u, _mm256_add_ps(one, _mm256_mul_ps(u2, at)));
+
+            __m256 a = _mm256_and_ps(_mm256_mul_ps(scale, at), live);
+            total = _mm256_add_ps(total, a);
+
+            __m256 a2 = _mm256_mul_ps(a, a);
+            __m256 sn = _mm256_add_ps(_mm256_set1_ps(1.0f / 120),
+                                      _mm256_mul_ps(a2, _mm256_set1_ps(-1.0f / 5040)));
+            sn = _mm256_add_ps(_mm256_set1_ps(-1.0f / 6), _mm256_mul_ps(a2, sn));
+            sn = _mm256_mul_ps(a, _mm256_add_ps(one, _mm256_mul_ps(a2, sn)));
+            __m256 cs = _mm256_add_ps(_mm256_set1_ps(-1.0f / 720),
+                                      _mm256_mul_ps(a2, _mm256_set1_ps(1.0f / 40320)));
+            cs = _mm256_add_ps(_mm256_set1_ps(1.0f / 24), _mm256_mul_ps(a2, cs));
+            cs = _mm256_add_ps(_mm256_set1_ps(-0.5f), _mm256_mul_ps(a2, cs));
+            cs = _mm256_add_ps(one, _mm256_mul_ps(a2, cs));
+
+            __m256 nr = _mm256_add_ps(_mm256_mul_ps(cs, pr), _mm256_mul_ps(sn, pi));
+            __m256 ni = _mm256_sub_ps(_mm256_mul_ps(cs, pi), _mm256_mul_ps(sn, pr));
+            __m256 pm = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(nr, nr),
+                                                     _mm256_mul_ps(ni, ni)));
+            pr = _mm256_blendv_ps(pr, _mm256_div_ps(nr, pm), live);
+            pi = _mm256_blendv_ps(pi, _mm256_div_ps(ni, pm), live);
+        }
+
+        float lane_phase[8];
+        _mm256_storeu_ps(lane_phase, total);
+        for (int l = g; l < lanes && l < g + 8; l++)
+            phase[l] = lane_phase[l - g];
+    }
+}
@@ -0,0 +1,708 @@
+/*
+ * AVX-512 (F + DQ) SIMD kernel implementations
+ *
+ * This file is compiled with -mavx512f -mavx512dq -mavx2 -mfma flags.
+ * All functions match the signatures in simd_kernels.h.
+ *
+ * Complex float layout: interleaved [re0, im0, re1, im1, ...]
+ * AVX-512 __m512 holds 16 floats = 8 complex values. Tails are handled
+ * with masked loads and stores instead of scalar loops, except for the
+ * int8 conversion (byte masks need AVX-512BW).
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <immintrin.h>
+#include <complex.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "simd_kernels.h"
+
+/* Mask with the low n of 16 lanes set (n <= 16) */
+static inline __mmask16 lane_mask(int n) {
+    return (__mmask16)((1u << n) - 1);
+}
+
+/* Even lanes of a:b (real parts) and odd lanes (imaginary parts) */
+static inline void deinterleave16(__m512 a, __m512 b, __m512 *re, __m512 *im) {
+    const __m512i idx_re = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14,
+                                             16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i idx_im = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15,
+                                             17, 19, 21, 23, 25, 27, 29, 31);
+    *re = _mm512_permutex2var_ps(a, idx_re, b);
+    *im = _mm512_permutex2var_ps(a, idx_im, b);
+}
+
+/* 8 floats duplicated into pairs: [t0,t0,t1,t1,...,t7,t7] */
+static inline __m512 dup_pairs(__m512 t) {
+    const __m512i idx = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3,
+                                          4, 4, 5, 5, 6, 6, 7, 7);
+    return _mm512_permutexvar_ps(idx, t);
+}
+
+/* Load up to 16 complex values (n of them) as two deinterleaved vectors */
+static inline void load_cf16(const float *p, int n, __m512 *re, __m512 *im) {
+    __m512 a, b;
+    if (n >= 16) {
+        a = _mm512_loadu_ps(p);
+        b = _mm512_loadu_ps(p + 16);
+    } else {
+        int na = n < 8 ? n : 8;
+        a = _mm512_maskz_loadu_ps(lane_mask(2 * na), p);
+        b = _mm512_maskz_loadu_ps(lane_mask(2 * (n - na)), p + 16);
+    }
+    deinterleave16(a, b, re, im);
+}
+
+/* Sum of the even lanes and of the odd lanes of acc */
+static inline void hsum_complex(__m512 acc, float *re, float *im) {
+    __m256 s8 = _mm256_add_ps(_mm512_castps512_ps256(acc),
+                              _mm256_castpd_ps(_mm512_extractf64x4_pd(
+                                  _mm512_castps_pd(acc), 1)));
+    __m128 s4 = _mm_add_ps(_mm256_castps256_ps128(s8),
+                           _mm256_extractf128_ps(s8, 1));
+    __m128 s2 = _mm_add_ps(s4, _mm_shuffle_ps(s4, s4, _MM_SHUFFLE(3, 2, 3, 2)));
+    *re = _mm_cvtss_f32(s2);
+    *im = _mm_cvtss_f32(_mm_shuffle_ps(s2, s2, 1));
+}
+
+/* ---- Complex FIR filter (real taps * complex input) ----
+ *
+ * 8 complex outputs per iteration; the last partial group is computed
+ * with masked loads/stores.
+ */
+void avx512_fir_ccf(const float *taps, int ntaps,
+                    const float complex *in, float complex *out, int n) {
+    const float *inp = (const float *)in;
+    float *outp = (float *)out;
+
+    for (int i = 0; i < n; i += 8) {
+        int rem = n - i;
+        __mmask16 m = rem >= 8 ? 0xffff : lane_mask(2 * rem);
+        __m512 acc = _mm512_setzero_ps();
+        for (int k = 0; k < ntaps; k++) {
+            __m512 data = _mm512_maskz_loadu_ps(m, &inp[(i + k) * 2]);
+            acc = _mm512_fmadd_ps(_mm512_set1_ps(taps[k]), data, acc);
+        }
+        _mm512_mask_storeu_ps(&outp[i * 2], m, acc);
+    }
+}
+
+/* ---- Decimating complex FIR ----
+ *
+ * Vectorize the tap loop: 8 taps (8 complex inputs = one register) per
+ * step in two accumulators, with a masked final step for the remainder.
+ */
+void avx512_fir_ccf_dec(const float *taps, int ntaps,
+                        const float complex *in, float complex *out,
+                        int n_out, int decimation) {
+    const float *inp = (const float *)in;
+    float *outp = (float *)out;
+
+    for (int i = 0; i < n_out; i++) {
+        const float *p = &inp[i * decimation * 2];
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+        int k = 0;
+
+        for (; k + 15 < ntaps; k += 16) {
+            __m512 t = _mm512_loadu_ps(&taps[k]);
+            __m512 c0 = dup_pairs(t);
+            __m512 c1 = dup_pairs(_mm512_shuffle_f32x4(t, t, _MM_SHUFFLE(3, 2, 3, 2)));
+            acc0 = _mm512_fmadd_ps(c0, _mm512_loadu_ps(&p[k * 2]), acc0);
+            acc1 = _mm512_fmadd_ps(c1, _mm512_loadu_ps(&p[k * 2 + 16]), acc1);
+        }
+        for (; k < ntaps; k += 8) {
+            int rem = ntaps - k < 8 ? ntaps - k : 8;
+            __m512 t = _mm512_maskz_loadu_ps(lane_mask(rem), &taps[k]);
+            __m512 data = _mm512_maskz_loadu_ps(lane_mask(2 * rem), &p[k * 2]);
+            acc0 = _mm512_fmadd_ps(dup_pairs(t), data, acc0);
+        }
+
+        hsum_complex(_mm512_add_ps(acc0, acc1), &outp[i * 2], &outp[i * 2 + 1]);
+    }
+}
+
+/* ---- Real FIR filter ----
+ *
+ * 16 outputs per iteration, masked tail.
+ */
+void avx512_fir_fff(const float *taps, int ntaps,
+                    const float *in, float *out, int n) {
+    for (int i = 0; i < n; i += 16) {
+        __mmask16 m = n - i >= 16 ? 0xffff : lane_mask(n - i);
+        __m512 acc = _mm512_setzero_ps();
+        for (int k = 0; k < ntaps; k++) {
+            __m512 data = _mm512_maskz_loadu_ps(m, &in[i + k]);
+            acc = _mm512_fmadd_ps(_mm512_set1_ps(taps[k]), data, acc);
+        }
+        _mm512_mask_storeu_ps(&out[i], m, acc);
+    }
+}
+
+/* ---- Fixed-length FIR kernels ----
+ *
+ * The three kernels above with ntaps (and the decimation) constant: each
+ * body is inlined into one function per length in SIMD_FIR_*_FIXED, so
+ * the tap loops unroll completely and the masks are constants. Every
+ * output is summed in the same order as above.
+ */
+#define FIXED_INLINE static inline __attribute__((always_inline))
+#define FIXED_MAX_TAPS 128
+
+/* Four groups of 8 outputs per iteration share each tap broadcast */
+FIXED_INLINE void fir_ccf_fixed(const float *taps, const int ntaps,
+                                const float complex *in, float complex *out,
+                                int n) {
+    const float *inp = (const float *)in;
+    float *outp = (float *)out;
+    int i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps();
+        __m512 a2 = _mm512_setzero_ps(), a3 = _mm512_setzero_ps();
+#pragma GCC unroll 128
+        for (int k = 0; k < ntaps; k++) {
+            __m512 c = _mm512_set1_ps(taps[k]);
+            const float *p = &inp[(i + k) * 2];
+            a0 = _mm512_fmadd_ps(c, _mm512_loadu_ps(p), a0);
+            a1 = _mm512_fmadd_ps(c, _mm512_loadu_ps(p + 16), a1);
+            a2 = _mm512_fmadd_ps(c, _mm512_loadu_ps(p + 32), a2);
+            a3 = _mm512_fmadd_ps(c, _mm512_loadu_ps(p + 48), a3);
+        }
+        _mm512_storeu_ps(&outp[i * 2], a0);
+        _mm512_storeu_ps(&outp[i * 2 + 16], a1);
+        _mm512_storeu_ps(&outp[i * 2 + 32], a2);
+        _mm512_storeu_ps(&outp[i * 2 + 48], a3);
+    }
+    if (i < n)
+        avx512_fir_ccf(taps, ntaps, in + i, out + i, n - i);
+}
+
+/* Taps duplicated into pairs once per call instead of once per output */
+FIXED_INLINE void fir_ccf_dec_fixed(const float *taps, const int ntaps,
+                                    const float complex *in,
+                                    float complex *out, int n_out,
+                                    const int decimation) {
+    const float *inp = (const float *)in;
+    float *outp = (float *)out;
+    const int n16 = ntaps / 16 * 16;
+    __m512 c[FIXED_MAX_TAPS / 8];
+
+#pragma GCC unroll 16
+    for (int k = 0; k < ntaps; k += 8) {
+        int rem = ntaps - k < 8 ? ntaps - k : 8;
+        c[k / 8] = dup_pairs(_mm512_maskz_loadu_ps(lane_mask(rem), &taps[k]));
+    }
+
+    for (int i = 0; i < n_out; i++) {
+        const float *p = &inp[i * decimation * 2];
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+#pragma GCC unroll 16
+        for (int k = 0; k < n16; k += 16) {
+            acc0 = _mm512_fmadd_ps(c[k / 8], _mm512_loadu_ps(&p[k * 2]), acc0);
+            acc1 = _mm512_fmadd_ps(c[k / 8 + 1], _mm512_loadu_ps(&p[k * 2 + 16]),
+                                   acc1);
+        }
+#pragma GCC unroll 2
+        for (int k = n16; k < ntaps; k += 8) {
+            int rem = ntaps - k < 8 ? ntaps - k : 8;
+            __m512 data = _mm512_maskz_loadu_ps(lane_mask(2 * rem), &p[k * 2]);
+            acc0 = _mm512_fmadd_ps(c[k / 8], data, acc0);
+        }
+        hsum_complex(_mm512_add_ps(acc0, acc1), &outp[i * 2], &outp[i * 2 + 1]);
+    }
+}
+
+/* Four groups of 16 outputs per iteration */
+FIXED_INLINE void fir_fff_fixed(const float *taps, const int ntaps,
+                                const float *in, float *out, int n) {
+    int i = 0;
+
+    for (; i + 64 <= n; i += 64) {
+        __m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps();
+        __m512 a2 = _mm512_setzero_ps(), a3 = _mm512_setzero_ps();
+#pragma GCC unroll 128
+        for (int k = 0; k < ntaps; k++) {
+            __m512 c = _mm512_set1_ps(taps[k]);
+            a0 = _mm512_fmadd_ps(c, _mm512_loadu_ps(&in[i + k]), a0);
+            a1 = _mm512_fmadd_ps(c, _mm512_loadu_ps(&in[i + k + 16]), a1);
+            a2 = _mm512_fmadd_ps(c, _mm512_loadu_ps(&in[i + k + 32]), a2);
+            a3 = _mm512_fmadd_ps(c, _mm512_loadu_ps(&in[i + k + 48]), a3);
+        }
+        _mm512_storeu_ps(&out[i], a0);
+        _mm512_storeu_ps(&out[i + 16], a1);
+        _mm512_storeu_ps(&out[i + 32], a2);
+        _mm512_storeu_ps(&out[i + 48], a3);
+    }
+    if (i < n)
+        avx512_fir_fff(taps, ntaps, in + i, out + i, n - i);
+}
+
+#define FIR_CCF_FIXED(N) \
+    static void avx512_fir_ccf_##N(const float *taps, int ntaps, \
+                                   const float complex *in, \
+                                   float complex *out, int n) { \
+        (void)ntaps; \
+        fir_ccf_fixed(taps, N, in, out, n); \
+    }
+#define FIR_CCF_DEC_FIXED(N, D) \
+    static void avx512_fir_ccf_dec_##N##_##D(const float *taps, int ntaps, \
+                                             const float complex *in, \
+                                             float complex *out, int n_out, \
+                                             int decimation) { \
+        _Static_assert(N <= FIXED_MAX_TAPS, "fixed FIR too long"); \
+        (void)ntaps; (void)decimation; \
+        fir_ccf_dec_fixed(taps, N, in, out, n_out, D); \
+    }
+#define FIR_FFF_FIXED(N) \
+    static void avx512_fir_fff_##N(const float *taps, int ntaps, \
+                                   const float *in, float *out, int n) { \
+        (void)ntaps; \
+        fir_fff_fixed(taps, N, in, out, n); \
+    }
+
+SIMD_FIR_CCF_FIXED(FIR_CCF_FIXED)
+SIMD_FIR_CCF_DEC_FIXED(FIR_CCF_DEC_FIXED)
+SIMD_FIR_FFF_FIXED(FIR_FFF_FIXED)
+
+#define CCF_ENTRY(N)        { N, 0, avx512_fir_ccf_##N, NULL, NULL },
+#define CCF_DEC_ENTRY(N, D) { N, D, NULL, avx512_fir_ccf_dec_##N##_##D, NULL },
+#define FFF_ENTRY(N)        { N, 0, NULL, NULL, avx512_fir_fff_##N },
+
+const simd_fir_fixed_t avx512_fir_fixed[] = {
+    SIMD_FIR_CCF_FIXED(CCF_ENTRY)
+    SIMD_FIR_CCF_DEC_FIXED(CCF_DEC_ENTRY)
+    SIMD_FIR_FFF_FIXED(FFF_ENTRY)
+    { 0, 0, NULL, NULL, NULL },
+};
+
+/* ---- Window multiply: complex * real ----
+ *
+ * 8 complex per iteration, window values duplicated into re/im pairs.
+ */
+void avx512_window_cf(const float complex *samples, const float *window,
+                      float complex *out, int n) {
+    const float *sp = (const float *)samples;
+    float *op = (float *)out;
+
+    for (int i = 0; i < n; i += 8) {
+        int rem = n - i < 8 ? n - i : 8;
+        __mmask16 m = lane_mask(2 * rem);
+        __m512 w = dup_pairs(_mm512_maskz_loadu_ps(lane_mask(rem), &window[i]));
+        __m512 data = _mm512_maskz_loadu_ps(m, &sp[i * 2]);
+        _mm512_mask_storeu_ps(&op[i * 2], m, _mm512_mul_ps(data, w));
+    }
+}
+
+/* ---- fftshift + magnitude-squared ----
+ *
+ * mag_shifted[i] = |fft_out[half+i]|^2  for i < half
+ * mag_shifted[half+i] = |fft_out[i]|^2  for i < half
+ *
+ * 16 complex -> 16 magnitudes per iteration and half.
+ */
+void avx512_fftshift_mag(const float complex *fft_out,
+                         float *mag_shifted, int fft_size) {
+    int half = fft_size / 2;
+    const float *fp = (const float *)fft_out;
+
+    for (int i = 0; i < half; i += 16) {
+        int rem = half - i < 16 ? half - i : 16;
+        __mmask16 m = lane_mask(rem);
+        __m512 re, im;
+
+        load_cf16(&fp[(half + i) * 2], rem, &re, &im);
+        _mm512_mask_storeu_ps(&mag_shifted[i], m,
+                              _mm512_fmadd_ps(re, re, _mm512_mul_ps(im, im)));
+
+        load_cf16(&fp[i * 2], rem, &re, &im);
+        _mm512_mask_storeu_ps(&mag_shifted[half + i], m,
+                              _mm512_fmadd_ps(re, re, _mm512_mul_ps(im, im)));
+    }
+}
+
+/* ---- Baseline update: sum[i] = sum[i] - old[i] + new[i] ---- */
+void avx512_baseline_update(float *sum, const float *old_hist,
+                            const float *new_mag, int n) {
+    int i = 0;
+    for (; i + 31 < n; i += 32) {
+        __m512 s0 = _mm512_loadu_ps(&sum[i]);
+        __m512 s1 = _mm512_loadu_ps(&sum[i + 16]);
+        s0 = _mm512_sub_ps(s0, _mm512_loadu_ps(&old_hist[i]));
+        s1 = _mm512_sub_ps(s1, _mm512_loadu_ps(&old_hist[i + 16]));
+        s0 = _mm512_add_ps(s0, _mm512_loadu_ps(&new_mag[i]));
+        s1 = _mm512_add_ps(s1, _mm512_loadu_ps(&new_mag[i + 16]));
+        _mm512_storeu_ps(&sum[i], s0);
+        _mm512_storeu_ps(&sum[i + 16], s1);
+    }
+    for (; i < n; i += 16) {
+        __mmask16 m = n - i >= 16 ? 0xffff : lane_mask(n - i);
+        __m512 s = _mm512_maskz_loadu_ps(m, &sum[i]);
+        s = _mm512_sub_ps(s, _mm512_maskz_loadu_ps(m, &old_hist[i]));
+        s = _mm512_add_ps(s, _mm512_maskz_loadu_ps(m, &new_mag[i]));
+        _mm512_mask_storeu_ps(&sum[i], m, s);
+    }
+}
+
+/* ---- Relative magnitude with zero check ----
+ *
+ * The compare mask doubles as a zeroing mask for the divide; lanes past
+ * the end load a zero baseline and so produce nothing.
+ */
+void avx512_relative_mag(const float *mag, const float *baseline,
+                         float *out, int n) {
+    __m512 zero = _mm512_setzero_ps();
+    for (int i = 0; i < n; i += 16) {
+        __mmask16 m = n - i >= 16 ? 0xffff : lane_mask(n - i);
+        __m512 mg = _mm512_maskz_loadu_ps(m, &mag[i]);
+        __m512 b = _mm512_maskz_loadu_ps(m, &baseline[i]);
+        __mmask16 pos = _mm512_cmp_ps_mask(b, zero, _CMP_GT_OQ);
+        _mm512_mask_storeu_ps(&out[i], m, _mm512_maskz_div_ps(pos, mg, b));
+    }
+}
+
+/* ---- int8 IQ -> float complex ----
+ *
+ * Load 16 int8 values (8 IQ pairs), sign-extend to int32, convert to
+ * float, multiply by 1/128.
+ */
+void avx512_convert_i8_cf(const int8_t *iq, float complex *out, size_t n) {
+    float *outp = (float *)out;
+    __m512 scale = _mm512_set1_ps(1.0f / 128.0f);
+    size_t i = 0;
+
+    /* 16 complex samples (32 int8 values) per iteration */
+    for (; i + 15 < n; i += 16) {
+        __m128i lo = _mm_loadu_si128((const __m128i *)&iq[i * 2]);
+        __m128i hi = _mm_loadu_si128((const __m128i *)&iq[i * 2 + 16]);
+        __m512 lo_f = _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(lo));
+        __m512 hi_f = _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(hi));
+        _mm512_storeu_ps(&outp[i * 2], _mm512_mul_ps(lo_f, scale));
+        _mm512_storeu_ps(&outp[i * 2 + 16], _mm512_mul_ps(hi_f, scale));
+    }
+
+    /* Scalar tail */
+    for (; i < n; i++) {
+        outp[i * 2] = iq[2 * i] / 128.0f;
+        outp[i * 2 + 1] = iq[2 * i + 1] / 128.0f;
+    }
+}
+
+/* ---- int8 IQ -> windowed float complex ---- */
+void avx512_window_i8_cf(const int8_t *iq, const float *window,
+                         float complex *out, int n) {
+    float *outp = (float *)out;
+    __m512 scale = _mm512_set1_ps(1.0f / 128.0f);
+    int i = 0;
+
+    /* 8 complex samples (16 int8 values) per iteration */
+    for (; i + 7 < n; i += 8) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)&iq[i * 2]);
+        __m512 data = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(bytes)),
+                                    scale);
+        __m512 w = dup_pairs(_mm512_maskz_loadu_ps(lane_mask(8), &window[i]));
+        _mm512_storeu_ps(&outp[i * 2], _mm512_mul_ps(data, w));
+    }
+
+    /* Scalar tail */
+    for (; i < n; i++) {
+        outp[i * 2] = iq[2 * i] / 128.0f * window[i];
+        outp[i * 2 + 1] = iq[2 * i + 1] / 128.0f * window[i];
+    }
+}
+
+/* ---- int16 IQ -> float complex ---- */
+void avx512_convert_i16_cf(const int16_t *iq, float complex *out, size_t n) {
+    float *outp = (float *)out;
+    __m512 scale = _mm512_set1_ps(1.0f / 32768.0f);
+    size_t i = 0;
+
+    /* 16 complex samples (32 int16 values) per iteration */
+    for (; i + 15 < n; i += 16) {
+        __m256i lo = _mm256_loadu_si256((const __m256i *)&iq[i * 2]);
+        __m256i hi = _mm256_loadu_si256((const __m256i *)&iq[i * 2 + 16]);
+        _mm512_storeu_ps(&outp[i * 2],
+            _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(lo)), scale));
+        _mm512_storeu_ps(&outp[i * 2 + 16],
+            _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(hi)), scale));
+    }
+
+    /* Scalar tail */
+    for (; i < n; i++) {
+        outp[i * 2] = iq[2 * i] / 32768.0f;
+        outp[i * 2 + 1] = iq[2 * i + 1] / 32768.0f;
+    }
+}
+
+/* ---- int16 IQ -> windowed float complex ---- */
+void avx512_window_i16_cf(const int16_t *iq, const float *window,
+                          float complex *out, int n) {
+    float *outp = (float *)out;
+    __m512 scale = _mm512_set1_ps(1.0f / 32768.0f);
+    int i = 0;
+
+    /* 8 complex samples (16 int16 values) per iteration */
+    for (; i + 7 < n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)&iq[i * 2]);
+        __m512 data = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(v)),
+                                    scale);
+        __m512 w = dup_pairs(_mm512_maskz_loadu_ps(lane_mask(8), &window[i]));
+        _mm512_storeu_ps(&outp[i * 2], _mm512_mul_ps(data, w));
+    }
+
+    /* Scalar tail */
+    for (; i < n; i++) {
+        outp[i * 2] = iq[2 * i] / 32768.0f * window[i];
+        outp[i * 2 + 1] = iq[2 * i + 1] / 32768.0f * window[i];
+    }
+}
+
+/* ---- Magnitude-squared of complex array ---- */
+void avx512_mag_squared(const float complex *in, float *out, int n) {
+    const float *inp = (const float *)in;
+
+    for (int i = 0; i < n; i += 16) {
+        int rem = n - i < 16 ? n - i : 16;
+        __m512 re, im;
+        load_cf16(&inp[i * 2], rem, &re, &im);
+        _mm512_mask_storeu_ps(&out[i], lane_mask(rem),
+                              _mm512_fmadd_ps(re, re, _mm512_mul_ps(im, im)));
+    }
+}
+
+/* ---- Find max float ---- */
+float avx512_max_float(const float *in, int n) {
+    __m512 vmax = _mm512_set1_ps(-1e30f);
+    for (int i = 0; i < n; i += 16) {
+        __mmask16 m = n - i >= 16 ? 0xffff : lane_mask(n - i);
+        __m512 v = _mm512_maskz_loadu_ps(m, &in[i]);
+        vmax = _mm512_mask_max_ps(vmax, m, vmax, v);
+    }
+    return _mm512_reduce_max_ps(vmax);
+}
+
+/* ---- Detector peak bins ----
+ *
+ * Compare 16 bins at a time and compress-store the indices over the
+ * threshold.
+ */
+int avx512_peak_bins(const float *mag, const float *mask, float threshold,
+                     int start, int end, int *bins) {
+    __m512 vthr = _mm512_set1_ps(threshold);
+    __m512i vidx = _mm512_add_epi32(_mm512_set1_epi32(start),
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7,
+                          8, 9, 10, 11, 12, 13, 14, 15));
+    __m512i step = _mm512_set1_epi32(16);
+    int n = 0;
+    for (int i = start; i < end; i += 16) {
+        __mmask16 m = end - i >= 16 ? 0xffff : lane_mask(end - i);
+        __m512 v = _mm512_mul_ps(_mm512_maskz_loadu_ps(m, &mag[i]),
+                                 _mm512_maskz_loadu_ps(m, &mask[i]));
+        __mmask16 hit = _mm512_mask_cmp_ps_mask(m, v, vthr, _CMP_GT_OQ);
+        _mm512_mask_compressstoreu_epi32(&bins[n], hit, vidx);
+        n += __builtin_popcount(hit);
+        vidx = _mm512_add_epi32(vidx, step);
+    }
+    return n;
+}
+
+/* ---- Complex square with window: out[i] = in[i]^2 * window[i] ----
+ *
+ * (a+bi)^2 = (a^2 - b^2) + (2ab)i
+ * Then multiply by real window value.
+ */
+void avx512_csquare_window(const float complex *in, const float *window,
+                           float complex *out, int n) {
+    const float *inp = (const float *)in;
+    float *outp = (float *)out;
+    const __m512i idx_lo = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19,
+                                             4, 20, 5, 21, 6, 22, 7, 23);
+    const __m512i idx_hi = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27,
+                                             12, 28, 13, 29, 14, 30, 15, 31);
+    __m512 two = _mm512_set1_ps(2.0f);
+
+    for (int i = 0; i < n; i += 16) {
+        int rem = n - i < 16 ? n - i : 16;
+        int na = rem < 8 ? rem : 8;
+        __m512 re, im;
+        load_cf16(&inp[i * 2], rem, &re, &im);
+        __m512 w = _mm512_maskz_loadu_ps(lane_mask(rem), &window[i]);
+
+        __m512 sq_re = _mm512_sub_ps(_mm512_mul_ps(re, re), _mm512_mul_ps(im, im));
+        __m512 sq_im = _mm512_mul_ps(two, _mm512_mul_ps(re, im));
+        sq_re = _mm512_mul_ps(sq_re, w);
+        sq_im = _mm512_mul_ps(sq_im, w);
+
+        /* Interleave back: [sq_re0, sq_im0, sq_re1, sq_im1, ...] */
+        _mm512_mask_storeu_ps(&outp[i * 2], lane_mask(2 * na),
+                              _mm512_permutex2var_ps(sq_re, idx_lo, sq_im));
+        _mm512_mask_storeu_ps(&outp[i * 2 + 16], lane_mask(2 * (rem - na)),
+                              _mm512_permutex2var_ps(sq_re, idx_hi, sq_im));
+    }
+}
+
+/* ---- Complex dot product (as avx2_dot_cc, tail masked) ---- */
+
+float complex avx512_dot_cc(const float complex *a, const float complex *b,
+                            int n) {
+    const float *ap = (const float *)a;
+    const float *bp = (const float *)b;
+    __m512 acc_rr = _mm512_setzero_ps();
+    __m512 acc_ri = _mm512_setzero_ps();
+    int i = 0;
+
+    for (; i < n; i += 8) {
+        int left = n - i < 8 ? n - i : 8;
+        __mmask16 m = lane_mask(2 * left);
+        __m512 va = _mm512_maskz_loadu_ps(m, &ap[i * 2]);
+        __m512 vb = _mm512_maskz_loadu_ps(m, &bp[i * 2]);
+        acc_rr = _mm512_fmadd_ps(va, vb, acc_rr);
+        acc_ri = _mm512_fmadd_ps(va, _mm512_permute_ps(vb, 0xB1), acc_ri);
+    }
+
+    /* Negate the odd lanes of acc_rr, then sum */
+    const __m512 sign = _mm512_setr_ps(1, -1, 1, -1, 1, -1, 1, -1,
+                                       1, -1, 1, -1, 1, -1, 1, -1);
+    float re = _mm512_reduce_add_ps(_mm512_mul_ps(acc_rr, sign));
+    float im = _mm512_reduce_add_ps(acc_ri);
+    return re + im * I;
+}
+
+/* ---- Chase candidate selection (as avx2_chase_select, 16 lanes) ---- */
+
+int avx512_chase_select(const uint16_t *syn, const float *cost, int n,
+                        const uint16_t *err, const float *rel) {
+    const __m512i low16 = _mm512_set1_epi32(0xFFFF);
+    const __m512i none = _mm512_set1_epi32(SIMD_CHASE_NONE);
+    const __m512i pos_mask = _mm512_set1_epi32(31);
+    __m512 best = _mm512_set1_ps(INFINITY);
+    __m512i best_idx = _mm512_set1_epi32(-1);
+    __m512i idx = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7,
+                                    8, 9, 10, 11, 12, 13, 14, 15);
+    int m = 0;
+
+    for (; m + 16 <= n; m += 16) {
+        __m512i s = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *)(syn + m)));
+        __m512i e = _mm512_and_si512(_mm512_i32gather_epi32(s, (const int *)err, 2), low16);
+        __mmask16 ok = _mm512_cmpneq_epi32_mask(e, none);
+        __m512i p1 = _mm512_and_si512(e, pos_mask);
+        __m512i p2 = _mm512_and_si512(_mm512_srli_epi32(e, 5), pos_mask);
+
+        __m512 c = _mm512_add_ps(_mm512_add_ps(_mm512_loadu_ps(cost + m),
+                                               _mm512_mask_i32gather_ps(_mm512_setzero_ps(),
+                                                                        ok, p1, rel, 4)),
+                                 _mm512_mask_i32gather_ps(_mm512_setzero_ps(),
+                                                          ok, p2, rel, 4));
+
+        __mmask16 lt = _mm512_mask_cmp_ps_mask(ok, c, best, _CMP_LT_OQ);
+        best = _mm512_mask_mov_ps(best, lt, c);
+        best_idx = _mm512_mask_mov_epi32(best_idx, lt, idx);
+        idx = _mm512_add_epi32(idx, _mm512_set1_epi32(16));
+    }
+
+    float lane_cost[16];
+    int32_t lane_idx[16];
+    _mm512_storeu_ps(lane_cost, best);
+    _mm512_storeu_si512(lane_idx, best_idx);
+
+    int best_m = -1;
+    float best_cost = INFINITY;
+    for (int l = 0; l < 16; l++) {
+        if (lane_idx[l] < 0)
+            continue;
+        if (lane_cost[l] < best_cost ||
+            (lane_cost[l] == best_cost && lane_idx[l] < best_m)) {
+            best_cost = lane_cost[l];
+            best_m = lane_idx[l];
+        }
+    }
+
+    for (; m < n; m++) {
+        uint16_t e = err[syn[m]];
+        if (e == SIMD_CHASE_NONE)
+            continue;
+        float c = cost[m] + rel[e & 31] + rel[(e >> 5) & 31];
+        if (c < best_cost) {
+            best_cost = c;
+            best_m = m;
+        }
+    }
+    return best_m;
+}
+
+/* ---- Lock-step QPSK PLL (as generic_pll_batch, all 16 lanes) ---- */
+
+void avx512_pll_batch(float *re, float *im, int n, int lanes, float alpha,
+                      float *phase) {
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 neg = _mm512_set1_ps(-1.0f);
+    const __m512 half = _mm512_set1_ps(0.5f);
+    const __m512 two = _mm512_set1_ps(2.0f);
+    const __m512 tiny = _mm512_set1_ps(1e-20f);
+    const __m512 scale = _mm512_set1_ps(alpha * 4.0f);
+    __m512 pr = one, pi = zero, total = zero;
+
+    for (int i = 0; i < n; i++) {
+        float *rp = &re[i * SIMD_PLL_LANES];
+        float *ip = &im[i * SIMD_PLL_LANES];
+        __m512 yr = _mm512_loadu_ps(rp);
+        __m512 yi = _mm512_loadu_ps(ip);
+        __m512 xr = _mm512_sub_ps(_mm512_mul_ps(yr, pr), _mm512_mul_ps(yi, pi));
+        __m512 xi = _mm512_add_ps(_mm512_mul_ps(yr, pi), _mm512_mul_ps(yi, pr));
+        _mm512_storeu_ps(rp, xr);
+        _mm512_storeu_ps(ip, xi);
+
+        __m512 mag2 = _mm512_add_ps(_mm512_mul_ps(xr, xr), _mm512_mul_ps(xi, xi));
+        __mmask16 live = _mm512_cmp_ps_mask(mag2, tiny, _CMP_GE_OQ);
+        if (live == 0)
+            continue;
+
+        __m512 sr = _mm512_mask_mov_ps(neg, _mm512_cmp_ps_mask(xr, zero, _CMP_GE_OQ), one);
+        __m512 si = _mm512_mask_mov_ps(neg, _mm512_cmp_ps_mask(xi, zero, _CMP_GE_OQ), one);
+        __m512 er = _mm512_add_ps(_mm512_mul_ps(sr, xr), _mm512_mul_ps(si, xi));
+        __m512 ei = _mm512_sub_ps(_mm512_mul_ps(sr, xi), _mm512_mul_ps(si, xr));
+        __m512 m = _mm512_sqrt_ps(_mm512_add_ps(_mm512_mul_ps(er, er),
+                                                _mm512_mul_ps(ei, ei)));
+        __m512 c = _mm512_div_ps(er, m), s = _mm512_div_ps(ei, m);
+
+        __m512 c1 = _mm512_sqrt_ps(_mm512_mul_ps(_mm512_add_ps(one, c), half));
+        __m512 s1 = _mm512_div_ps(s, _mm512_mul_ps(two, c1));
+        __m512 u = _mm512_div_ps(s1, _mm512_add_ps(one, c1));
+        __m512 u2 = _mm512_mul_ps(u, u);
+        __m512 at = _mm512_add_ps(_mm512_set1_ps(-1.0f / 7),
+                                  _mm512_mul_ps(u2, _mm512_set1_ps(1.0f / 9)));
+        at = _mm512_add_ps(_mm512_set1_ps(1.0f / 5), _mm512_mul_ps(u2, at));
+        at = _mm512_add_ps(_mm512_set1_ps(-1.0f / 3), _mm512_mul_ps(u2, at));
+        at = _mm512_mul_ps(u, _mm512_add_ps(one, _mm512_mul_ps(u2, at)));
+
+        __m512 a = _mm512_maskz_mov_ps(live, _mm512_mul_ps(scale, at));
+        total = _mm512_add_ps(total, a);
+
+        __m512 a2 = _mm512_mul_ps(a, a);
+        __m512 sn = _mm512_add_ps(_mm512_set1_ps(1.0f / 120),
+                                  _mm512_mul_ps(a2, _mm512_set1_ps(-1.0f / 5040)));
+        sn = _mm512_add_ps(_mm512_set1_ps(-1.0f / 6), _mm512_mul_ps(a2, sn));
+        sn = _mm512_mul_ps(a, _mm512_add_ps(one, _mm512_mul_ps(a2, sn)));
+        __m512 cs = _mm512_add_ps(_mm512_set1_ps(-1.0f / 720),
+                                  _mm512_mul_ps(a2, _mm512_set1_ps(1.0f / 40320)));
+        cs = _mm512_add_ps(_mm512_set1_ps(1.0f / 24), _mm512_mul_ps(a2, cs));
+        cs = _mm512_add_ps(_mm512_set1_ps(-0.5f), _mm512_mul_ps(a2, cs));
+        cs = _mm512_add_ps(one, _mm512_mul_ps(a2, cs));
+
+        __m512 nr = _mm512_add_ps(_mm512_mul_ps(cs, pr), _mm512_mul_ps(sn, pi));
+        __m512 ni = _mm512_sub_ps(_mm512_mul_ps(cs, pi), _mm512_mul_ps(sn, pr));
+        __m512 pm = _mm512_sqrt_ps(_mm512_add_ps(_mm512_mul_ps(nr, nr),
+                                                 _mm512_mul_ps(ni, ni)));
+        pr = _mm512_mask_div_ps(pr, live, nr, pm);
+        pi = _mm512_mask_div_ps(pi, live, ni, pm);
+    }
+
+    _mm512_mask_storeu_ps(phase, lane_mask(lanes), total);
+}
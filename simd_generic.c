@@ -24,24 +24,139 @@ simd_fftshift_mag_fn   simd_fftshift_mag   = NULL;
 simd_baseline_update_fn simd_baseline_update = NULL;
 simd_relative_mag_fn   simd_relative_mag   = NULL;
 simd_convert_i8_cf_fn  simd_convert_i8_cf  = NULL;
+simd_window_i8_cf_fn   simd_window_i8_cf   = NULL;
+simd_convert_i16_cf_fn simd_convert_i16_cf = NULL;
+simd_window_i16_cf_fn  simd_window_i16_cf  = NULL;
 simd_mag_squared_fn    simd_mag_squared    = NULL;
 simd_max_float_fn      simd_max_float      = NULL;
+simd_peak_bins_fn      simd_peak_bins      = NULL;
 simd_csquare_window_fn simd_csquare_window = NULL;
+simd_dot_cc_fn         simd_dot_cc         = NULL;
+simd_chase_select_fn   simd_chase_select   = NULL;
+simd_pll_batch_fn      simd_pll_batch      = NULL;
+simd_fir_q15_dec_fn    simd_fir_q15_dec    = NULL;
+const simd_fir_fixed_t *simd_fir_fixed     = NULL;
 
-/* ---- Runtime dispatch ---- */
+/* ---- Fixed-length FIR lookup ---- */
 
-void simd_init(int force_generic) {
-    int use_avx2 = 0;
+simd_fir_ccf_fn simd_fir_ccf_fixed(const simd_fir_fixed_t *table, int ntaps) {
+    for (; table && table->ntaps; table++)
+        if (table->ntaps == ntaps && table->ccf)
+            return table->ccf;
+    return NULL;
+}
+
+simd_fir_ccf_dec_fn simd_fir_ccf_dec_fixed(const simd_fir_fixed_t *table,
+                                           int ntaps, int decimation) {
+    for (; table && table->ntaps; table++)
+        if (table->ntaps == ntaps && table->decimation == decimation &&
+            table->ccf_dec)
+            return table->ccf_dec;
+    return NULL;
+}
+
+simd_fir_fff_fn simd_fir_fff_fixed(const simd_fir_fixed_t *table, int ntaps) {
+    for (; table && table->ntaps; table++)
+        if (table->ntaps == ntaps && table->fff)
+            return table->fff;
+    return NULL;
+}
+
+/* ---- Runtime dispatch ---- */
 
 #if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
-    if (!force_generic && __builtin_cpu_supports("avx2") &&
-        __builtin_cpu_supports("fma")) {
-        use_avx2 = 1;
-    }
+#define SIMD_X86 1
 #endif
 
-    if (use_avx2) {
-#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+static const char *const impl_names[] = {
+    [SIMD_AUTO]    = "auto",
+    [SIMD_GENERIC] = "generic",
+    [SIMD_AVX2]    = "avx2",
+    [SIMD_AVX512]  = "avx512",
+    [SIMD_NEON]    = "neon",
+};
+
+int simd_parse_impl(const char *name) {
+    for (int i = 0; i < (int)(sizeof(impl_names) / sizeof(impl_names[0])); i++)
+        if (strcmp(name, impl_names[i]) == 0)
+            return i;
+    return -1;
+}
+
+const char *simd_impl_name(simd_impl_t impl) {
+    return impl_names[impl];
+}
+
+int simd_supported(simd_impl_t impl) {
+    switch (impl) {
+    case SIMD_AUTO:
+    case SIMD_GENERIC:
+        return 1;
+#ifdef SIMD_X86
+    case SIMD_AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#ifdef HAVE_AVX512
+    case SIMD_AVX512:
+        return __builtin_cpu_supports("avx512f") &&
+               __builtin_cpu_supports("avx512dq") &&
+               __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#endif
+#if defined(__aarch64__)
+    case SIMD_NEON:
+        return neon_supported();
+#endif
+    default:
+        return 0;
+    }
+}
+
+simd_impl_t simd_init(simd_impl_t impl) {
+    if (impl == SIMD_AUTO) {
+        /* Widest first */
+        static const simd_impl_t order[] = { SIMD_AVX512, SIMD_AVX2, SIMD_NEON };
+        impl = SIMD_GENERIC;
+        for (int i = 0; i < (int)(sizeof(order) / sizeof(order[0])); i++) {
+            if (simd_supported(order[i])) {
+                impl = order[i];
+                break;
+            }
+        }
+    } else if (!simd_supported(impl)) {
+        fprintf(stderr, "iridium-sniffer: %s SIMD kernels not available, "
+                "using scalar\n", impl_names[impl]);
+        impl = SIMD_GENERIC;
+    }
+
+    switch (impl) {
+#ifdef SIMD_X86
+#ifdef HAVE_AVX512
+    case SIMD_AVX512:
+        simd_fir_ccf        = avx512_fir_ccf;
+        simd_fir_ccf_dec    = avx512_fir_ccf_dec;
+        simd_fir_fff        = avx512_fir_fff;
+        simd_window_cf      = avx512_window_cf;
+        simd_fftshift_mag   = avx512_fftshift_mag;
+        simd_baseline_update = avx512_baseline_update;
+        simd_relative_mag   = avx512_relative_mag;
+        simd_convert_i8_cf  = avx512_convert_i8_cf;
+        simd_window_i8_cf   = avx512_window_i8_cf;
+        simd_convert_i16_cf = avx512_convert_i16_cf;
+        simd_window_i16_cf  = avx512_window_i16_cf;
+        simd_mag_squared    = avx512_mag_squared;
+        simd_max_float      = avx512_max_float;
+        simd_peak_bins      = avx512_peak_bins;
+        simd_csquare_window = avx512_csquare_window;
+        simd_dot_cc         = avx512_dot_cc;
+        simd_chase_select   = avx512_chase_select;
+        simd_pll_batch      = avx512_pll_batch;
+        /* Multiply-add of int16 pairs on zmm needs AVX512BW */
+        simd_fir_q15_dec    = avx2_fir_q15_dec;
+        simd_fir_fixed      = avx512_fir_fixed;
+        fprintf(stderr, "iridium-sniffer: using AVX-512 SIMD kernels\n");
+        break;
+#endif
+    case SIMD_AVX2:
         simd_fir_ccf        = avx2_fir_ccf;
         simd_fir_ccf_dec    = avx2_fir_ccf_dec;
         simd_fir_fff        = avx2_fir_fff;
@@ -50,12 +165,51 @@ void simd_init(int force_generic) {
         simd_baseline_update = avx2_baseline_update;
         simd_relative_mag   = avx2_relative_mag;
         simd_convert_i8_cf  = avx2_convert_i8_cf;
+        simd_window_i8_cf   = avx2_window_i8_cf;
+        simd_convert_i16_cf = avx2_convert_i16_cf;
+        simd_window_i16_cf  = avx2_window_i16_cf;
         simd_mag_squared    = avx2_mag_squared;
         simd_max_float      = avx2_max_float;
+        simd_peak_bins      = avx2_peak_bins;
         simd_csquare_window = avx2_csquare_window;
+        simd_dot_cc         = avx2_dot_cc;
+        simd_chase_select   = avx2_chase_select;
+        simd_pll_batch      = avx2_pll_batch;
+        simd_fir_q15_dec    = avx2_fir_q15_dec;
+        simd_fir_fixed      = avx2_fir_fixed;
         fprintf(stderr, "iridium-sniffer: using AVX2+FMA SIMD kernels\n");
+        break;
 #endif
-    } else {
+#if defined(__aarch64__)
+    case SIMD_NEON:
+        simd_fir_ccf        = neon_fir_ccf;
+        simd_fir_ccf_dec    = neon_fir_ccf_dec;
+        simd_fir_fff        = neon_fir_fff;
+        simd_window_cf      = neon_window_cf;
+        simd_fftshift_mag   = neon_fftshift_mag;
+        simd_baseline_update = neon_baseline_update;
+        simd_relative_mag   = neon_relative_mag;
+        simd_convert_i8_cf  = neon_convert_i8_cf;
+        /* Widening loads dominate either way; the scalar loop keeps up */
+        simd_window_i8_cf   = generic_window_i8_cf;
+        simd_convert_i16_cf = neon_convert_i16_cf;
+        simd_window_i16_cf  = neon_window_i16_cf;
+        simd_mag_squared    = neon_mag_squared;
+        simd_max_float      = neon_max_float;
+        /* No movemask to compact with; the scalar scan keeps up */
+        simd_peak_bins      = generic_peak_bins;
+        simd_csquare_window = neon_csquare_window;
+        simd_dot_cc         = generic_dot_cc;
+        /* Table lookups per lane and no gather: scalar is as fast */
+        simd_chase_select   = generic_chase_select;
+        simd_pll_batch      = generic_pll_batch;
+        simd_fir_q15_dec    = neon_fir_q15_dec;
+        simd_fir_fixed      = NULL;
+        fprintf(stderr, "iridium-sniffer: using NEON SIMD kernels\n");
+        break;
+#endif
+    default:
+        impl = SIMD_GENERIC;
         simd_fir_ccf        = generic_fir_ccf;
         simd_fir_ccf_dec    = generic_fir_ccf_dec;
         simd_fir_fff        = generic_fir_fff;
@@ -64,11 +218,23 @@ void simd_init(int force_generic) {
         simd_baseline_update = generic_baseline_update;
         simd_relative_mag   = generic_relative_mag;
         simd_convert_i8_cf  = generic_convert_i8_cf;
+        simd_window_i8_cf   = generic_window_i8_cf;
+        simd_convert_i16_cf = generic_convert_i16_cf;
+        simd_window_i16_cf  = generic_window_i16_cf;
         simd_mag_squared    = generic_mag_squared;
         simd_max_float      = generic_max_float;
+        simd_peak_bins      = generic_peak_bins;
         simd_csquare_window = generic_csquare_window;
+        simd_dot_cc         = generic_dot_cc;
+        simd_chase_select   = generic_chase_select;
+        simd_pll_batch      = generic_pll_batch;
+        simd_fir_q15_dec    = generic_fir_q15_dec;
+        simd_fir_fixed      = NULL;
         fprintf(stderr, "iridium-sniffer: using scalar SIMD kernels\n");
+        break;
     }
+
+    return impl;
 }
 
 /* ---- Generic implementations ---- */
@@ -95,6 +261,22 @@ void generic_fir_ccf_dec(const float *taps, int ntaps,
     }
 }
 
+void generic_fir_q15_dec(const int16_t *taps, int ntaps, const int16_t *in,
+                         float complex *out, int n_out, int decimation,
+                         float scale) {
+    const int16_t *tr = taps;
+    const int16_t *ti = taps + 2 * pad_to_8(ntaps);
+    for (int i = 0; i < n_out; i++) {
+        const int16_t *p = &in[2 * i * decimation];
+        int32_t re = 0, im = 0;
+        for (int k = 0; k < 2 * ntaps; k += 2) {
+            re += p[k] * tr[k] + p[k + 1] * tr[k + 1];
+            im += p[k] * ti[k] + p[k + 1] * ti[k + 1];
+        }
+        out[i] = scale * (float)re + scale * (float)im * I;
+    }
+}
+
 void generic_fir_fff(const float *taps, int ntaps,
                      const float *in, float *out, int n) {
     for (int i = 0; i < n; i++) {
@@ -152,6 +334,32 @@ void generic_convert_i8_cf(const int8_t *iq, float complex *out, size_t n) {
     }
 }
 
+void generic_window_i8_cf(const int8_t *iq, const float *window,
+                          float complex *out, int n) {
+    for (int i = 0; i < n; i++) {
+        float re = iq[2 * i] / 128.0f;
+        float im = iq[2 * i + 1] / 128.0f;
+        out[i] = (re + im * I) * window[i];
+    }
+}
+
+void generic_convert_i16_cf(const int16_t *iq, float complex *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        float re = iq[2 * i] / 32768.0f;
+        float im = iq[2 * i + 1] / 32768.0f;
+        out[i] = re + im * I;
+    }
+}
+
+void generic_window_i16_cf(const int16_t *iq, const float *window,
+                           float complex *out, int n) {
+    for (int i = 0; i < n; i++) {
+        float re = iq[2 * i] / 32768.0f;
+        float im = iq[2 * i + 1] / 32768.0f;
+        out[i] = (re + im * I) * window[i];
+    }
+}
+
 void generic_mag_squared(const float complex *in, float *out, int n) {
     for (int i = 0; i < n; i++) {
         float re = crealf(in[i]);
@@ -169,6 +377,15 @@ float generic_max_float(const float *in, int n) {
     return max_val;
 }
 
+int generic_peak_bins(const float *mag, const float *mask, float threshold,
+                      int start, int end, int *bins) {
+    int n = 0;
+    for (int i = start; i < end; i++)
+        if (mag[i] * mask[i] > threshold)
+            bins[n++] = i;
+    return n;
+}
+
 void generic_csquare_window(const float complex *in, const float *window,
                             float complex *out, int n) {
     for (int i = 0; i < n; i++) {
@@ -176,3 +393,97 @@ void generic_csquare_window(const float complex *in, const float *window,
         out[i] = s * s * window[i];
     }
 }
+
+float complex generic_dot_cc(const float complex *a, const float complex *b,
+                             int n) {
+    float re = 0, im = 0;
+    for (int i = 0; i < n; i++) {
+        float ar = crealf(a[i]), ai = cimagf(a[i]);
+        float br = crealf(b[i]), bi = cimagf(b[i]);
+        re += ar * br - ai * bi;
+        im += ar * bi + ai * br;
+    }
+    return re + im * I;
+}
+
+int generic_chase_select(const uint16_t *syn, const float *cost, int n,
+                         const uint16_t *err, const float *rel) {
+    int best = -1;
+    float best_cost = INFINITY;
+    for (int m = 0; m < n; m++) {
+        uint16_t e = err[syn[m]];
+        if (e == SIMD_CHASE_NONE)
+            continue;
+        int p1 = e & 31, p2 = (e >> 5) & 31;
+        float c = cost[m] + rel[p1] + rel[p2];
+        if (c < best_cost) {
+            best_cost = c;
+            best = m;
+        }
+    }
+    return best;
+}
+
+/* The loop error er = x * conj(decision) lies within 45 degrees of the real
+ * axis, so its angle needs no atan2: two half-angle steps bring it under
+ * 11.25 degrees (|u| < 0.2) where a five-term series for atan(u) is good
+ * to 1e-8 rad, and alpha * angle is small enough for short sin/cos
+ * series. The SIMD versions evaluate the same expressions. */
+void generic_pll_batch(float *re, float *im, int n, int lanes, float alpha,
+                       float *phase) {
+    float pr[SIMD_PLL_LANES], pi[SIMD_PLL_LANES];
+
+    /* Lanes inner: their loops are independent, so they overlap instead
+     * of each waiting on its own sqrt/divide chain */
+    for (int l = 0; l < lanes; l++) {
+        pr[l] = 1.0f;
+        pi[l] = 0.0f;
+        phase[l] = 0.0f;
+    }
+
+    for (int i = 0; i < n; i++) {
+        float *yr = &re[i * SIMD_PLL_LANES];
+        float *yi = &im[i * SIMD_PLL_LANES];
+
+        for (int l = 0; l < lanes; l++) {
+            float xr = yr[l] * pr[l] - yi[l] * pi[l];
+            float xi = yr[l] * pi[l] + yi[l] * pr[l];
+            yr[l] = xr;
+            yi[l] = xi;
+
+            float mag2 = xr * xr + xi * xi;
+            if (mag2 < 1e-20f)
+                continue;
+
+            /* Rotate by the conjugate of the nearest QPSK point */
+            float sr = xr >= 0 ? 1.0f : -1.0f;
+            float si = xi >= 0 ? 1.0f : -1.0f;
+            float er = sr * xr + si * xi;
+            float ei = sr * xi - si * xr;
+            float m = sqrtf(er * er + ei * ei);
+            float c = er / m, s = ei / m;
+
+            float c1 = sqrtf((1.0f + c) * 0.5f);
+            float s1 = s / (2.0f * c1);
+            float u = s1 / (1.0f + c1);
+            float u2 = u * u;
+            float at = u * (1.0f + u2 * (-1.0f / 3 + u2 * (1.0f / 5 +
+                       u2 * (-1.0f / 7 + u2 * (1.0f / 9)))));
+
+            float a = alpha * 4.0f * at;
+            phase[l] += a;
+
+            float a2 = a * a;
+            float sn = a * (1.0f + a2 * (-1.0f / 6 + a2 * (1.0f / 120 +
+                       a2 * (-1.0f / 5040))));
+            float cs = 1.0f + a2 * (-0.5f + a2 * (1.0f / 24 +
+                       a2 * (-1.0f / 720 + a2 * (1.0f / 40320))));
+
+            float nr = cs * pr[l] + sn * pi[l];
+            float ni = cs * pi[l] - sn * pr[l];
+            float pm = sqrtf(nr * nr + ni * ni);
+            pr[l] = nr / pm;
+            pi[l] = ni / pm;
+        }
+    }
+}
@@ -2,7 +2,8 @@
  * SIMD kernel dispatch - runtime CPU feature detection
  *
  * Call simd_init() once at startup. All function pointers are then set
- * to either AVX2 or scalar implementations based on CPU capabilities.
+ * to AVX-512 or AVX2 (x86), NEON (AArch64) or scalar implementations based
+ * on CPU capabilities, or to the set named with --simd.
  *
  * Copyright (c) 2026 CEMAXECUTER LLC
  * SPDX-License-Identifier: GPL-3.0-or-later
@@ -78,6 +79,20 @@ typedef void (*simd_relative_mag_fn)(const float *mag, const float *baseline,
 typedef void (*simd_convert_i8_cf_fn)(const int8_t *iq, float complex *out,
                                        size_t n);
 
+/* int8 IQ pairs converted as above and windowed in the same pass:
+ * out[i] = (iq[2i]/128 + iq[2i+1]/128 * I) * window[i] */
+typedef void (*simd_window_i8_cf_fn)(const int8_t *iq, const float *window,
+                                      float complex *out, int n);
+
+/* int16 IQ pairs to float complex, full scale 1.0:
+ * out[i] = iq[2i]/32768 + iq[2i+1]/32768 * I */
+typedef void (*simd_convert_i16_cf_fn)(const int16_t *iq, float complex *out,
+                                        size_t n);
+
+/* int16 IQ converted as above and windowed in the same pass */
+typedef void (*simd_window_i16_cf_fn)(const int16_t *iq, const float *window,
+                                       float complex *out, int n);
+
 /* Magnitude-squared of complex array: out[i] = re*re + im*im */
 typedef void (*simd_mag_squared_fn)(const float complex *in, float *out,
                                      int n);
@@ -85,11 +100,57 @@ typedef void (*simd_mag_squared_fn)(const float complex *in, float *out,
 /* Find max float in array */
 typedef float (*simd_max_float_fn)(const float *in, int n);
 
+/* Detector peak bins: writes every i in [start, end) with
+ * mag[i] * mask[i] > threshold to bins, in order; returns the count */
+typedef int (*simd_peak_bins_fn)(const float *mag, const float *mask,
+                                  float threshold, int start, int end,
+                                  int *bins);
+
 /* Complex square with window: out[i] = in[i]*in[i] * window[i] */
 typedef void (*simd_csquare_window_fn)(const float complex *in,
                                         const float *window,
                                         float complex *out, int n);
 
+/* Complex dot product: sum of a[i] * b[i] */
+typedef float complex (*simd_dot_cc_fn)(const float complex *a,
+                                         const float complex *b, int n);
+
+/* Chase BCH candidate selection (bch_chase.c). Candidate m has syndrome
+ * syn[m] and flip cost cost[m]; err[s] packs the hard-decision error
+ * positions of syndrome s (SIMD_CHASE_ERR, or SIMD_CHASE_NONE if it is
+ * not correctable) and is read 32 bits at a time, so it needs one entry
+ * of padding. Each error position adds rel[pos] (32 entries, 0 at
+ * SIMD_CHASE_NOPOS) to the cost. Returns the correctable candidate of
+ * lowest cost (lowest m on ties), or -1. */
+typedef int (*simd_chase_select_fn)(const uint16_t *syn, const float *cost,
+                                     int n, const uint16_t *err,
+                                     const float *rel);
+
+#define SIMD_CHASE_NONE     0xFFFF
+#define SIMD_CHASE_NOPOS    31
+#define SIMD_CHASE_ERR(p1, p2)  ((uint16_t)((p1) | ((p2) << 5)))
+
+/* First-order QPSK PLL run in lock-step over up to SIMD_PLL_LANES frames
+ * (qpsk_demod_batch). Symbol i of lane l is re/im[i * SIMD_PLL_LANES + l];
+ * each lane is phase-corrected in place and its summed loop correction
+ * (radians) is written to phase[l]. A zero sample leaves a lane's loop
+ * untouched, so shorter frames are zero-padded to n. Unused lanes up to
+ * SIMD_PLL_LANES must be zero; alpha is at most 1. */
+typedef void (*simd_pll_batch_fn)(float *re, float *im, int n, int lanes,
+                                   float alpha, float *phase);
+
+#define SIMD_PLL_LANES      16
+
+/* Decimating complex FIR on int16 IQ pairs (the Q15 input path):
+ * out[i] = scale * sum_k g[k] * in[i * decimation + k] for complex taps g
+ * in fixed point. taps holds two rows of pad_to_8(ntaps) int16 pairs,
+ * (re g, -im g) then (im g, re g), so each output component is one
+ * pairwise multiply-add per sample. Products are summed in int32 without
+ * saturation; the caller scales g so the sum cannot overflow. */
+typedef void (*simd_fir_q15_dec_fn)(const int16_t *taps, int ntaps,
+                                     const int16_t *in, float complex *out,
+                                     int n_out, int decimation, float scale);
+
 /* ---- Global function pointers (set by simd_init) ---- */
 
 extern simd_fir_ccf_fn        simd_fir_ccf;
@@ -100,15 +161,82 @@ extern simd_fftshift_mag_fn   simd_fftshift_mag;
 extern simd_baseline_update_fn simd_baseline_update;
 extern simd_relative_mag_fn   simd_relative_mag;
 extern simd_convert_i8_cf_fn  simd_convert_i8_cf;
+extern simd_window_i8_cf_fn   simd_window_i8_cf;
+extern simd_convert_i16_cf_fn simd_convert_i16_cf;
+extern simd_window_i16_cf_fn  simd_window_i16_cf;
 extern simd_mag_squared_fn    simd_mag_squared;
 extern simd_max_float_fn      simd_max_float;
+extern simd_peak_bins_fn      simd_peak_bins;
 extern simd_csquare_window_fn simd_csquare_window;
+extern simd_dot_cc_fn         simd_dot_cc;
+extern simd_chase_select_fn   simd_chase_select;
+extern simd_pll_batch_fn      simd_pll_batch;
+extern simd_fir_q15_dec_fn    simd_fir_q15_dec;
+
+/* ---- Fixed-length FIR kernels ----
+ *
+ * The downmix filters have tap counts (and the input stages decimations)
+ * that depend only on the sample rate. For the ones common rates give,
+ * the AVX2 and AVX-512 sets also have FIR kernels with ntaps and the
+ * decimation as compile-time constants: the tap loop is unrolled, the taps
+ * stay in registers where they fit, and several outputs are in flight at
+ * once. Each output is summed in the same order as by the set's
+ * generic-length kernel, so results are identical. fir_filter_create()
+ * and fir_filter_create_dec() pick them up. The lists below instantiate
+ * them; add a length here to get a kernel for it. */
+
+/* fir_ccf: noise LPF (25) and RRC (51) at 10 samples per symbol */
+#define SIMD_FIR_CCF_FIXED(X)   X(25) X(51)
+
+/* fir_fff: the burst start box filter at 10 samples per symbol */
+#define SIMD_FIR_FFF_FIXED(X)   X(20)
+
+/* fir_ccf_dec (ntaps, decimation): the downmix input stages at 2, 2.4, 4,
+ * 5, 8, 10, 12, 12.5 and 20 Msps, and at 500 ksps (--narrowband) */
+#define SIMD_FIR_CCF_DEC_FIXED(X) \
+    X(33, 4) X(41, 2) X(41, 5) X(39, 2) X(21, 4) X(81, 4) X(27, 5) \
+    X(43, 8) X(53, 10) X(65, 12) X(51, 10) X(101, 5) X(81, 16)
+
+typedef struct {
+    int ntaps;
+    int decimation;                 /* ccf_dec only */
+    simd_fir_ccf_fn ccf;            /* exactly one of the three is set */
+    simd_fir_ccf_dec_fn ccf_dec;
+    simd_fir_fff_fn fff;
+} simd_fir_fixed_t;
+
+/* The selected set's fixed-length kernels, ended by ntaps 0, or NULL */
+extern const simd_fir_fixed_t *simd_fir_fixed;
+
+/* The kernel in table for ntaps (and decimation), or NULL */
+simd_fir_ccf_fn simd_fir_ccf_fixed(const simd_fir_fixed_t *table, int ntaps);
+simd_fir_ccf_dec_fn simd_fir_ccf_dec_fixed(const simd_fir_fixed_t *table,
+                                           int ntaps, int decimation);
+simd_fir_fff_fn simd_fir_fff_fixed(const simd_fir_fixed_t *table, int ntaps);
 
 /* ---- Initialization ---- */
 
-/* Detect CPU features and set function pointers.
- * If force_generic is nonzero, always use scalar fallback. */
-void simd_init(int force_generic);
+/* Kernel implementation sets */
+typedef enum {
+    SIMD_AUTO = 0,      /* widest set the CPU supports */
+    SIMD_GENERIC,       /* scalar */
+    SIMD_AVX2,          /* x86 AVX2 + FMA */
+    SIMD_AVX512,        /* x86 AVX-512 F + DQ */
+    SIMD_NEON,          /* AArch64 Advanced SIMD */
+} simd_impl_t;
+
+/* Parse "auto", "generic", "avx2", "avx512" or "neon"; -1 if unknown */
+int simd_parse_impl(const char *name);
+
+const char *simd_impl_name(simd_impl_t impl);
+
+/* Nonzero if impl is compiled in and this CPU supports it */
+int simd_supported(simd_impl_t impl);
+
+/* Detect CPU features and set function pointers to impl (SIMD_AUTO picks
+ * the widest supported set; an unsupported set falls back to scalar).
+ * Returns the set selected. */
+simd_impl_t simd_init(simd_impl_t impl);
 
 /* ---- Generic (scalar) implementations ---- */
 
@@ -128,10 +256,26 @@ void generic_baseline_update(float *sum, const float *old_hist,
 void generic_relative_mag(const float *mag, const float *baseline,
                           float *out, int n);
 void generic_convert_i8_cf(const int8_t *iq, float complex *out, size_t n);
+void generic_window_i8_cf(const int8_t *iq, const float *window,
+                          float complex *out, int n);
+void generic_convert_i16_cf(const int16_t *iq, float complex *out, size_t n);
+void generic_window_i16_cf(const int16_t *iq, const float *window,
+                           float complex *out, int n);
 void generic_mag_squared(const float complex *in, float *out, int n);
 float generic_max_float(const float *in, int n);
+int generic_peak_bins(const float *mag, const float *mask, float threshold,
+                      int start, int end, int *bins);
 void generic_csquare_window(const float complex *in, const float *window,
                             float complex *out, int n);
+float complex generic_dot_cc(const float complex *a, const float complex *b,
+                             int n);
+int generic_chase_select(const uint16_t *syn, const float *cost, int n,
+                         const uint16_t *err, const float *rel);
+void generic_pll_batch(float *re, float *im, int n, int lanes, float alpha,
+                       float *phase);
+void generic_fir_q15_dec(const int16_t *taps, int ntaps, const int16_t *in,
+                         float complex *out, int n_out, int decimation,
+                         float scale);
 
 /* ---- AVX2 implementations (only on x86_64) ---- */
 #if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
@@ -152,11 +296,103 @@ void avx2_baseline_update(float *sum, const float *old_hist,
 void avx2_relative_mag(const float *mag, const float *baseline,
                         float *out, int n);
 void avx2_convert_i8_cf(const int8_t *iq, float complex *out, size_t n);
+void avx2_window_i8_cf(const int8_t *iq, const float *window,
+                       float complex *out, int n);
+void avx2_convert_i16_cf(const int16_t *iq, float complex *out, size_t n);
+void avx2_window_i16_cf(const int16_t *iq, const float *window,
+                        float complex *out, int n);
 void avx2_mag_squared(const float complex *in, float *out, int n);
 float avx2_max_float(const float *in, int n);
+int avx2_peak_bins(const float *mag, const float *mask, float threshold,
+                   int start, int end, int *bins);
 void avx2_csquare_window(const float complex *in, const float *window,
                           float complex *out, int n);
+float complex avx2_dot_cc(const float complex *a, const float complex *b,
+                          int n);
+int avx2_chase_select(const uint16_t *syn, const float *cost, int n,
+                      const uint16_t *err, const float *rel);
+void avx2_pll_batch(float *re, float *im, int n, int lanes, float alpha,
+                    float *phase);
+void avx2_fir_q15_dec(const int16_t *taps, int ntaps, const int16_t *in,
+                      float complex *out, int n_out, int decimation,
+                      float scale);
+extern const simd_fir_fixed_t avx2_fir_fixed[];
+
+/* ---- AVX-512 implementations (when the compiler accepts -mavx512f) ---- */
+#ifdef HAVE_AVX512
+
+void avx512_fir_ccf(const float *taps, int ntaps,
+                    const float complex *in, float complex *out, int n);
+void avx512_fir_ccf_dec(const float *taps, int ntaps,
+                        const float complex *in, float complex *out,
+                        int n_out, int decimation);
+void avx512_fir_fff(const float *taps, int ntaps,
+                    const float *in, float *out, int n);
+void avx512_window_cf(const float complex *samples, const float *window,
+                      float complex *out, int n);
+void avx512_fftshift_mag(const float complex *fft_out,
+                         float *mag_shifted, int fft_size);
+void avx512_baseline_update(float *sum, const float *old_hist,
+                            const float *new_mag, int n);
+void avx512_relative_mag(const float *mag, const float *baseline,
+                         float *out, int n);
+void avx512_convert_i8_cf(const int8_t *iq, float complex *out, size_t n);
+void avx512_window_i8_cf(const int8_t *iq, const float *window,
+                         float complex *out, int n);
+void avx512_convert_i16_cf(const int16_t *iq, float complex *out, size_t n);
+void avx512_window_i16_cf(const int16_t *iq, const float *window,
+                          float complex *out, int n);
+void avx512_mag_squared(const float complex *in, float *out, int n);
+float avx512_max_float(const float *in, int n);
+int avx512_peak_bins(const float *mag, const float *mask, float threshold,
+                     int start, int end, int *bins);
+void avx512_csquare_window(const float complex *in, const float *window,
+                           float complex *out, int n);
+float complex avx512_dot_cc(const float complex *a, const float complex *b,
+                            int n);
+int avx512_chase_select(const uint16_t *syn, const float *cost, int n,
+                        const uint16_t *err, const float *rel);
+void avx512_pll_batch(float *re, float *im, int n, int lanes, float alpha,
+                      float *phase);
+extern const simd_fir_fixed_t avx512_fir_fixed[];
+
+#endif /* HAVE_AVX512 */
 
 #endif /* x86 */
 
+/* ---- NEON implementations (only on AArch64) ---- */
+#if defined(__aarch64__)
+
+void neon_fir_ccf(const float *taps, int ntaps,
+                  const float complex *in, float complex *out, int n);
+void neon_fir_ccf_dec(const float *taps, int ntaps,
+                      const float complex *in, float complex *out,
+                      int n_out, int decimation);
+void neon_fir_fff(const float *taps, int ntaps,
+                  const float *in, float *out, int n);
+void neon_window_cf(const float complex *samples, const float *window,
+                    float complex *out, int n);
+void neon_fftshift_mag(const float complex *fft_out,
+                       float *mag_shifted, int fft_size);
+void neon_baseline_update(float *sum, const float *old_hist,
+                          const float *new_mag, int n);
+void neon_relative_mag(const float *mag, const float *baseline,
+                       float *out, int n);
+void neon_convert_i8_cf(const int8_t *iq, float complex *out, size_t n);
+void neon_convert_i16_cf(const int16_t *iq, float complex *out, size_t n);
+void neon_window_i16_cf(const int16_t *iq, const float *window,
+                        float complex *out, int n);
+void neon_mag_squared(const float complex *in, float *out, int n);
+float neon_max_float(const float *in, int n);
+void neon_csquare_window(const float complex *in, const float *window,
+                         float complex *out, int n);
+void neon_fir_q15_dec(const int16_t *taps, int ntaps, const int16_t *in,
+                      float complex *out, int n_out, int decimation,
+                      float scale);
+
+/* Nonzero if the CPU reports Advanced SIMD (HWCAP_ASIMD) */
+int neon_supported(void);
+
+#endif /* __aarch64__ */
+
 #endif /* __SIMD_KERNELS_H__ */
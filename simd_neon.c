@@ -0,0 +1,437 @@
+/*
+ * AArch64 NEON SIMD kernel implementations
+ *
+ * Advanced SIMD is part of the AArch64 base ISA, so no extra compiler
+ * flags are needed; simd_init() still checks HWCAP_ASIMD before use.
+ * All functions match the signatures in simd_kernels.h.
+ *
+ * Complex float layout: interleaved [re0, im0, re1, im1, ...]
+ * vld2q_f32 splits 4 complex values into re[4] and im[4] registers,
+ * vst2q_f32 interleaves them back.
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#if defined(__aarch64__)
+
+#include <arm_neon.h>
+#include <complex.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "simd_kernels.h"
+
+#ifdef __linux__
+#include <sys/auxv.h>   /* getauxval; glibc pulls in HWCAP_* from bits/hwcap.h */
+#endif
+
+/* ---- Runtime detection ---- */
+
+int neon_supported(void) {
+#if defined(__linux__) && defined(HWCAP_ASIMD)
+    return (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+#else
+    return 1;  /* mandatory in the AArch64 base ISA */
+#endif
+}
+
+/* ---- Complex FIR filter (real taps * complex input) ----
+ *
+ * Process 4 complex outputs at a time: for each tap, load 8 interleaved
+ * floats and FMA with the broadcast coefficient. Re and im never mix, so
+ * the interleaved layout can be kept as is.
+ */
+void neon_fir_ccf(const float *taps, int ntaps,
+                  const float complex *in, float complex *out, int n) {
+    const float *inp = (const float *)in;
+    float *outp = (float *)out;
+
+    int i = 0;
+    for (; i + 3 < n; i += 4) {
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+        const float *p = &inp[i * 2];
+        for (int k = 0; k < ntaps; k++) {
+            acc0 = vfmaq_n_f32(acc0, vld1q_f32(&p[k * 2]), taps[k]);
+            acc1 = vfmaq_n_f32(acc1, vld1q_f32(&p[k * 2 + 4]), taps[k]);
+        }
+        vst1q_f32(&outp[i * 2], acc0);
+        vst1q_f32(&outp[i * 2 + 4], acc1);
+    }
+
+    /* Scalar tail */
+    for (; i < n; i++) {
+        float acc_re = 0, acc_im = 0;
+        for (int k = 0; k < ntaps; k++) {
+            acc_re += taps[k] * inp[(i + k) * 2];
+            acc_im += taps[k] * inp[(i + k) * 2 + 1];
+        }
+        outp[i * 2] = acc_re;
+        outp[i * 2 + 1] = acc_im;
+    }
+}
+
+/* ---- Decimating complex FIR ----
+ *
+ * Vectorize the tap loop: deinterleave 4 inputs into re/im and FMA with
+ * 4 consecutive taps, so no coefficient shuffling is needed. Two
+ * accumulator pairs (8 taps per step) hide the FMA latency.
+ */
+void neon_fir_ccf_dec(const float *taps, int ntaps,
+                      const float complex *in, float complex *out,
+                      int n_out, int decimation) {
+    const float *inp = (const float *)in;
+    float *outp = (float *)out;
+
+    for (int i = 0; i < n_out; i++) {
+        const float *p = &inp[i * decimation * 2];
+        float32x4_t acc_re0 = vdupq_n_f32(0.0f), acc_im0 = vdupq_n_f32(0.0f);
+        float32x4_t acc_re1 = vdupq_n_f32(0.0f), acc_im1 = vdupq_n_f32(0.0f);
+        int k = 0;
+
+        for (; k + 7 < ntaps; k += 8) {
+            float32x4x2_t d0 = vld2q_f32(&p[k * 2]);
+            float32x4x2_t d1 = vld2q_f32(&p[k * 2 + 8]);
+            float32x4_t t0 = vld1q_f32(&taps[k]);
+            float32x4_t t1 = vld1q_f32(&taps[k + 4]);
+            acc_re0 = vfmaq_f32(acc_re0, t0, d0.val[0]);
+            acc_im0 = vfmaq_f32(acc_im0, t0, d0.val[1]);
+            acc_re1 = vfmaq_f32(acc_re1, t1, d1.val[0]);
+            acc_im1 = vfmaq_f32(acc_im1, t1, d1.val[1]);
+        }
+        for (; k + 3 < ntaps; k += 4) {
+            float32x4x2_t d = vld2q_f32(&p[k * 2]);
+            float32x4_t t = vld1q_f32(&taps[k]);
+            acc_re0 = vfmaq_f32(acc_re0, t, d.val[0]);
+            acc_im0 = vfmaq_f32(acc_im0, t, d.val[1]);
+        }
+
+        float acc_re = vaddvq_f32(vaddq_f32(acc_re0, acc_re1));
+        float acc_im = vaddvq_f32(vaddq_f32(acc_im0, acc_im1));
+
+        /* Scalar tail for remaining taps */
+        for (; k < ntaps; k++) {
+            acc_re += taps[k] * p[k * 2];
+            acc_im += taps[k] * p[k * 2 + 1];
+        }
+
+        outp[i * 2] = acc_re;
+        outp[i * 2 + 1] = acc_im;
+    }
+}
+
+/* ---- Decimating complex FIR on int16 IQ (Q15 path) ----
+ *
+ * vld2q splits 8 samples into re and im lanes and each tap row into its
+ * two halves, so every product is one widening multiply-accumulate.
+ */
+void neon_fir_q15_dec(const int16_t *taps, int ntaps, const int16_t *in,
+                      float complex *out, int n_out, int decimation,
+                      float scale) {
+    const int16_t *tr = taps;
+    const int16_t *ti = taps + 2 * pad_to_8(ntaps);
+    float *outp = (float *)out;
+
+    for (int i = 0; i < n_out; i++) {
+        const int16_t *p = &in[2 * i * decimation];
+        int32x4_t acc_re = vdupq_n_s32(0), acc_im = vdupq_n_s32(0);
+        int k = 0;
+
+        for (; k + 7 < ntaps; k += 8) {
+            int16x8x2_t x = vld2q_s16(&p[2 * k]);   /* re, im */
+            int16x8x2_t a = vld2q_s16(&tr[2 * k]);  /* re g, -im g */
+            int16x8x2_t b = vld2q_s16(&ti[2 * k]);  /* im g, re g */
+            acc_re = vmlal_s16(acc_re, vget_low_s16(x.val[0]), vget_low_s16(a.val[0]));
+            acc_re = vmlal_high_s16(acc_re, x.val[0], a.val[0]);
+            acc_re = vmlal_s16(acc_re, vget_low_s16(x.val[1]), vget_low_s16(a.val[1]));
+            acc_re = vmlal_high_s16(acc_re, x.val[1], a.val[1]);
+            acc_im = vmlal_s16(acc_im, vget_low_s16(x.val[0]), vget_low_s16(b.val[0]));
+            acc_im = vmlal_high_s16(acc_im, x.val[0], b.val[0]);
+            acc_im = vmlal_s16(acc_im, vget_low_s16(x.val[1]), vget_low_s16(b.val[1]));
+            acc_im = vmlal_high_s16(acc_im, x.val[1], b.val[1]);
+        }
+
+        int32_t acc_r = vaddvq_s32(acc_re);
+        int32_t acc_i = vaddvq_s32(acc_im);
+
+        /* Scalar tail for remaining taps */
+        for (; k < ntaps; k++) {
+            acc_r += p[2 * k] * tr[2 * k] + p[2 * k + 1] * tr[2 * k + 1];
+            acc_i += p[2 * k] * ti[2 * k] + p[2 * k + 1] * ti[2 * k + 1];
+        }
+
+        outp[i * 2] = scale * (float)acc_r;
+        outp[i * 2 + 1] = scale * (float)acc_i;
+    }
+}
+
+/* ---- Real FIR filter ----
+ *
+ * Process 8 outputs at a time in two accumulators.
+ */
+void neon_fir_fff(const float *taps, int ntaps,
+                  const float *in, float *out, int n) {
+    int i = 0;
+    for (; i + 7 < n; i += 8) {
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+        for (int k = 0; k < ntaps; k++) {
+            acc0 = vfmaq_n_f32(acc0, vld1q_f32(&in[i + k]), taps[k]);
+            acc1 = vfmaq_n_f32(acc1, vld1q_f32(&in[i + k + 4]), taps[k]);
+        }
+        vst1q_f32(&out[i], acc0);
+        vst1q_f32(&out[i + 4], acc1);
+    }
+
+    /* Scalar tail */
+    for (; i < n; i++) {
+        float acc = 0;
+        for (int k = 0; k < ntaps; k++)
+            acc += taps[k] * in[i + k];
+        out[i] = acc;
+    }
+}
+
+/* ---- Window multiply: complex * real ---- */
+void neon_window_cf(const float complex *samples, const float *window,
+                    float complex *out, int n) {
+    const float *sp = (const float *)samples;
+    float *op = (float *)out;
+    int i = 0;
+
+    for (; i + 3 < n; i += 4) {
+        float32x4x2_t d = vld2q_f32(&sp[i * 2]);
+        float32x4_t w = vld1q_f32(&window[i]);
+        d.val[0] = vmulq_f32(d.val[0], w);
+        d.val[1] = vmulq_f32(d.val[1], w);
+        vst2q_f32(&op[i * 2], d);
+    }
+
+    /* Scalar tail */
+    for (; i < n; i++)
+        out[i] = samples[i] * window[i];
+}
+
+/* ---- fftshift + magnitude-squared ----
+ *
+ * mag_shifted[i] = |fft_out[half+i]|^2  for i < half
+ * mag_shifted[half+i] = |fft_out[i]|^2  for i < half
+ */
+void neon_fftshift_mag(const float complex *fft_out,
+                       float *mag_shifted, int fft_size) {
+    int half = fft_size / 2;
+    const float *fp = (const float *)fft_out;
+    int i = 0;
+
+    for (; i + 3 < half; i += 4) {
+        float32x4x2_t pos = vld2q_f32(&fp[(half + i) * 2]);
+        float32x4x2_t neg = vld2q_f32(&fp[i * 2]);
+        float32x4_t mag_pos = vfmaq_f32(vmulq_f32(pos.val[1], pos.val[1]),
+                                        pos.val[0], pos.val[0]);
+        float32x4_t mag_neg = vfmaq_f32(vmulq_f32(neg.val[1], neg.val[1]),
+                                        neg.val[0], neg.val[0]);
+        vst1q_f32(&mag_shifted[i], mag_pos);
+        vst1q_f32(&mag_shifted[half + i], mag_neg);
+    }
+
+    /* Scalar tail */
+    for (; i < half; i++) {
+        float re, im;
+        re = crealf(fft_out[half + i]);
+        im = cimagf(fft_out[half + i]);
+        mag_shifted[i] = re * re + im * im;
+
+        re = crealf(fft_out[i]);
+        im = cimagf(fft_out[i]);
+        mag_shifted[half + i] = re * re + im * im;
+    }
+}
+
+/* ---- Baseline update: sum[i] = sum[i] - old[i] + new[i] ---- */
+void neon_baseline_update(float *sum, const float *old_hist,
+                          const float *new_mag, int n) {
+    int i = 0;
+    for (; i + 7 < n; i += 8) {
+        float32x4_t s0 = vld1q_f32(&sum[i]);
+        float32x4_t s1 = vld1q_f32(&sum[i + 4]);
+        s0 = vsubq_f32(s0, vld1q_f32(&old_hist[i]));
+        s1 = vsubq_f32(s1, vld1q_f32(&old_hist[i + 4]));
+        s0 = vaddq_f32(s0, vld1q_f32(&new_mag[i]));
+        s1 = vaddq_f32(s1, vld1q_f32(&new_mag[i + 4]));
+        vst1q_f32(&sum[i], s0);
+        vst1q_f32(&sum[i + 4], s1);
+    }
+    for (; i < n; i++) {
+        sum[i] -= old_hist[i];
+        sum[i] += new_mag[i];
+    }
+}
+
+/* ---- Relative magnitude with zero check ---- */
+void neon_relative_mag(const float *mag, const float *baseline,
+                       float *out, int n) {
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 3 < n; i += 4) {
+        float32x4_t m = vld1q_f32(&mag[i]);
+        float32x4_t b = vld1q_f32(&baseline[i]);
+        uint32x4_t mask = vcgtq_f32(b, zero);
+        float32x4_t div = vdivq_f32(m, b);
+        vst1q_f32(&out[i], vreinterpretq_f32_u32(
+            vandq_u32(vreinterpretq_u32_f32(div), mask)));
+    }
+    for (; i < n; i++) {
+        if (baseline[i] > 0)
+            out[i] = mag[i] / baseline[i];
+        else
+            out[i] = 0;
+    }
+}
+
+/* ---- int8 IQ -> float complex ----
+ *
+ * Load 16 int8 values (8 IQ pairs), widen to int32 and convert with 7
+ * fractional bits, which is exactly x / 128.
+ */
+void neon_convert_i8_cf(const int8_t *iq, float complex *out, size_t n) {
+    float *outp = (float *)out;
+    size_t i = 0;
+
+    for (; i + 7 < n; i += 8) {
+        int8x16_t bytes = vld1q_s8(&iq[i * 2]);
+        int16x8_t lo16 = vmovl_s8(vget_low_s8(bytes));
+        int16x8_t hi16 = vmovl_high_s8(bytes);
+
+        vst1q_f32(&outp[i * 2],      vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(lo16)), 7));
+        vst1q_f32(&outp[i * 2 + 4],  vcvtq_n_f32_s32(vmovl_high_s16(lo16), 7));
+        vst1q_f32(&outp[i * 2 + 8],  vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(hi16)), 7));
+        vst1q_f32(&outp[i * 2 + 12], vcvtq_n_f32_s32(vmovl_high_s16(hi16), 7));
+    }
+
+    /* Scalar tail */
+    for (; i < n; i++) {
+        outp[i * 2] = iq[2 * i] / 128.0f;
+        outp[i * 2 + 1] = iq[2 * i + 1] / 128.0f;
+    }
+}
+
+/* ---- int16 IQ -> float complex ---- */
+void neon_convert_i16_cf(const int16_t *iq, float complex *out, size_t n) {
+    float *outp = (float *)out;
+    size_t i = 0;
+
+    for (; i + 3 < n; i += 4) {
+        int16x8_t v = vld1q_s16(&iq[i * 2]);
+        vst1q_f32(&outp[i * 2],     vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(v)), 15));
+        vst1q_f32(&outp[i * 2 + 4], vcvtq_n_f32_s32(vmovl_high_s16(v), 15));
+    }
+
+    /* Scalar tail */
+    for (; i < n; i++) {
+        outp[i * 2] = iq[2 * i] / 32768.0f;
+        outp[i * 2 + 1] = iq[2 * i + 1] / 32768.0f;
+    }
+}
+
+/* ---- int16 IQ -> windowed float complex ----
+ *
+ * vld2 deinterleaves 8 samples into I and Q, which take the same window
+ * vector, as in neon_window_cf().
+ */
+void neon_window_i16_cf(const int16_t *iq, const float *window,
+                        float complex *out, int n) {
+    float *op = (float *)out;
+    int i = 0;
+
+    for (; i + 7 < n; i += 8) {
+        int16x8x2_t d = vld2q_s16(&iq[i * 2]);
+        float32x4_t w0 = vld1q_f32(&window[i]);
+        float32x4_t w1 = vld1q_f32(&window[i + 4]);
+        float32x4x2_t lo, hi;
+        lo.val[0] = vmulq_f32(vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(d.val[0])), 15), w0);
+        lo.val[1] = vmulq_f32(vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(d.val[1])), 15), w0);
+        hi.val[0] = vmulq_f32(vcvtq_n_f32_s32(vmovl_high_s16(d.val[0]), 15), w1);
+        hi.val[1] = vmulq_f32(vcvtq_n_f32_s32(vmovl_high_s16(d.val[1]), 15), w1);
+        vst2q_f32(&op[i * 2], lo);
+        vst2q_f32(&op[i * 2 + 8], hi);
+    }
+
+    /* Scalar tail */
+    for (; i < n; i++) {
+        op[i * 2] = iq[2 * i] / 32768.0f * window[i];
+        op[i * 2 + 1] = iq[2 * i + 1] / 32768.0f * window[i];
+    }
+}
+
+/* ---- Magnitude-squared of complex array ---- */
+void neon_mag_squared(const float complex *in, float *out, int n) {
+    const float *inp = (const float *)in;
+    int i = 0;
+
+    for (; i + 3 < n; i += 4) {
+        float32x4x2_t d = vld2q_f32(&inp[i * 2]);
+        vst1q_f32(&out[i], vfmaq_f32(vmulq_f32(d.val[1], d.val[1]),
+                                     d.val[0], d.val[0]));
+    }
+
+    for (; i < n; i++) {
+        float re = inp[i * 2];
+        float im = inp[i * 2 + 1];
+        out[i] = re * re + im * im;
+    }
+}
+
+/* ---- Find max float ---- */
+float neon_max_float(const float *in, int n) {
+    float32x4_t vmax0 = vdupq_n_f32(-1e30f);
+    float32x4_t vmax1 = vdupq_n_f32(-1e30f);
+    int i = 0;
+    for (; i + 7 < n; i += 8) {
+        vmax0 = vmaxq_f32(vmax0, vld1q_f32(&in[i]));
+        vmax1 = vmaxq_f32(vmax1, vld1q_f32(&in[i + 4]));
+    }
+    float max_val = vmaxvq_f32(vmaxq_f32(vmax0, vmax1));
+    /* Scalar tail */
+    for (; i < n; i++) {
+        if (in[i] > max_val) max_val = in[i];
+    }
+    return max_val;
+}
+
+/* ---- Complex square with window: out[i] = in[i]^2 * window[i] ----
+ *
+ * (a+bi)^2 = (a^2 - b^2) + (2ab)i
+ * Then multiply by real window value.
+ */
+void neon_csquare_window(const float complex *in, const float *window,
+                         float complex *out, int n) {
+    const float *inp = (const float *)in;
+    float *outp = (float *)out;
+    int i = 0;
+
+    for (; i + 3 < n; i += 4) {
+        float32x4x2_t d = vld2q_f32(&inp[i * 2]);
+        float32x4_t re = d.val[0];
+        float32x4_t im = d.val[1];
+        float32x4_t w = vld1q_f32(&window[i]);
+
+        float32x4_t sq_re = vsubq_f32(vmulq_f32(re, re), vmulq_f32(im, im));
+        float32x4_t sq_im = vmulq_n_f32(vmulq_f32(re, im), 2.0f);
+
+        float32x4x2_t r;
+        r.val[0] = vmulq_f32(sq_re, w);
+        r.val[1] = vmulq_f32(sq_im, w);
+        vst2q_f32(&outp[i * 2], r);
+    }
+
+    for (; i < n; i++) {
+        float a = inp[i * 2];
+        float b = inp[i * 2 + 1];
+        outp[i * 2] = (a * a - b * b) * window[i];
+        outp[i * 2 + 1] = (2.0f * a * b) * window[i];
+    }
+}
+
+#endif /* __aarch64__ */
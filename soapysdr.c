@@ -4,7 +4,9 @@
  */
 
 #include <err.h>
+#include <pthread.h>
 #include <signal.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,22 +17,47 @@
 #include <SoapySDR/Formats.h>
 #include <SoapySDR/Version.h>
 
+#include "sample_pool.h"
 #include "sdr.h"
+#include "soapysdr.h"
 
 extern sig_atomic_t running;
 extern pid_t self_pid;
 extern double samp_rate;
-extern double center_freq;
 extern double soapy_gain_val;
 extern int bias_tee;
 extern int verbose;
+extern int sdr_buffers;
+extern int sdr_buffer_size;
 
 #define SOAPY_SETTINGS_MAX 8
 extern char *soapy_setting_keys[SOAPY_SETTINGS_MAX];
 extern char *soapy_setting_vals[SOAPY_SETTINGS_MAX];
 extern int soapy_setting_count;
 
-static int sample_mode = 0;  /* 0=CS8, 1=CF32, 2=CS16 (fallback) */
+/* Per sample_mode: stream format, bytes per IQ pair, and the format the
+ * samples are handed on in (as read, never converted) */
+static const char *mode_format[] = { SOAPY_SDR_CS8, SOAPY_SDR_CF32, SOAPY_SDR_CS16 };
+static const size_t mode_sample_size[] = {
+    2 * sizeof(int8_t), 2 * sizeof(float), 2 * sizeof(int16_t)
+};
+static const int mode_sample_fmt[] = {
+    SAMPLE_FMT_INT8, SAMPLE_FMT_FLOAT, SAMPLE_FMT_INT16
+};
+
+/* One open device. Zero-copy: driver buffers handed on to the detector
+ * stay out until their sample buffer is freed; direct_lock keeps a late
+ * release off a closed stream. */
+struct soapy_rx {
+    SoapySDRDevice *device;
+    SoapySDRStream *stream;
+    int rx;
+    int sample_mode;            /* 0=CS8, 1=CF32, 2=CS16 */
+    pthread_mutex_t direct_lock;
+    int direct_closed;
+    atomic_int direct_held;
+    unsigned long direct_passed, direct_copied;
+};
 
 void soapy_list(void) {
     size_t length;
@@ -74,7 +101,7 @@ void soapy_list(void) {
     SoapySDRKwargsList_clear(results, length);
 }
 
-SoapySDRDevice *soapy_setup(int id, const char *args) {
+soapy_rx_t *soapy_setup(int id, const char *args, double freq, int rx) {
     SoapySDRDevice *device;
     char **formats;
     size_t num_formats;
@@ -104,28 +131,41 @@ SoapySDRDevice *soapy_setup(int id, const char *args) {
             errx(1, "Unable to open SoapySDR device: %s", SoapySDRDevice_lastError());
     }
 
-    /* Check supported formats: prefer CS8, then CF32, then CS16 */
+    /* Check supported formats: prefer CS8, then CS16 (native for most
+     * devices, and half the bytes of CF32), then CF32 */
+    soapy_rx_t *sr = calloc(1, sizeof(*sr));
+    if (sr == NULL)
+        err(1, "Unable to allocate SoapySDR state");
+    sr->device = device;
+    sr->rx = rx;
+    pthread_mutex_init(&sr->direct_lock, NULL);
+    atomic_init(&sr->direct_held, 0);
+
     formats = SoapySDRDevice_getStreamFormats(device, SOAPY_SDR_RX, 0, &num_formats);
-    sample_mode = 2;  /* CS16 fallback */
+    sr->sample_mode = 2;  /* CS16 fallback */
+    int has_cs16 = 0, has_cf32 = 0;
     for (size_t i = 0; i < num_formats; ++i) {
         if (strcmp(formats[i], SOAPY_SDR_CS8) == 0) {
-            sample_mode = 0;
+            sr->sample_mode = 0;
             break;
         }
+        if (strcmp(formats[i], SOAPY_SDR_CS16) == 0)
+            has_cs16 = 1;
         if (strcmp(formats[i], SOAPY_SDR_CF32) == 0)
-            sample_mode = 1;
+            has_cf32 = 1;
     }
+    if (sr->sample_mode != 0 && has_cf32 && !has_cs16)
+        sr->sample_mode = 1;
     SoapySDRStrings_clear(&formats, num_formats);
 
     if (verbose) {
-        const char *fmt_name[] = { "CS8", "CF32", "CS16" };
-        fprintf(stderr, "SoapySDR: using %s format\n", fmt_name[sample_mode]);
+        fprintf(stderr, "SoapySDR: using %s format\n", mode_format[sr->sample_mode]);
     }
 
     if (SoapySDRDevice_setSampleRate(device, SOAPY_SDR_RX, 0, samp_rate) != 0)
         errx(1, "Unable to set SoapySDR sample rate: %s", SoapySDRDevice_lastError());
 
-    if (SoapySDRDevice_setFrequency(device, SOAPY_SDR_RX, 0, center_freq, NULL) != 0)
+    if (SoapySDRDevice_setFrequency(device, SOAPY_SDR_RX, 0, freq, NULL) != 0)
         errx(1, "Unable to set SoapySDR frequency: %s", SoapySDRDevice_lastError());
 
     /* Disable AGC for manual gain control. SDRplay devices (RSP1A, RSP2, etc.)
@@ -152,7 +192,7 @@ SoapySDRDevice *soapy_setup(int id, const char *args) {
      * in soapy_stream_thread(). Some drivers (SDRPlay) segfault if
      * writeSetting is called before activateStream / sdrplay_api_Init(). */
 
-    return device;
+    return sr;
 }
 
 /* Apply bias tee and custom device settings.
@@ -210,54 +250,109 @@ static void soapy_apply_settings(SoapySDRDevice *device) {
     }
 }
 
-static void soapy_cs16_to_float(int16_t *in, float *out, size_t num_samples) {
-    for (size_t i = 0; i < num_samples * 2; ++i)
-        out[i] = in[i] * (1.0f / 32768.0f);
+/* Open the RX stream in the sample_mode's format. The buffer options go in as
+ * the "buffers" and "bufflen" (bytes) stream args, which the modules that
+ * allocate their own driver buffers (RTL-SDR, HackRF, Airspy...) take;
+ * others ignore them. */
+static SoapySDRStream *soapy_setup_stream(soapy_rx_t *sr) {
+    SoapySDRKwargs args = { 0 };
+    char val[32];
+    size_t channel = 0;
+
+    if (sdr_buffers) {
+        snprintf(val, sizeof(val), "%d", sdr_buffers);
+        SoapySDRKwargs_set(&args, "buffers", val);
+    }
+    if (sdr_buffer_size) {
+        snprintf(val, sizeof(val), "%zu",
+                 (size_t)sdr_buffer_size * mode_sample_size[sr->sample_mode]);
+        SoapySDRKwargs_set(&args, "bufflen", val);
+    }
+    SoapySDRStream *stream = SoapySDRDevice_setupStream(
+        sr->device, SOAPY_SDR_RX, mode_format[sr->sample_mode], &channel, 1, &args);
+    SoapySDRKwargs_clear(&args);
+    return stream;
+}
+
+static void soapy_release_buf(sample_buf_t *s) {
+    soapy_rx_t *sr = (soapy_rx_t *)s->owner;
+    pthread_mutex_lock(&sr->direct_lock);
+    if (!sr->direct_closed)
+        SoapySDRDevice_releaseReadBuffer(sr->device, sr->stream,
+                                         (size_t)s->handle);
+    pthread_mutex_unlock(&sr->direct_lock);
+    atomic_fetch_sub(&sr->direct_held, 1);
+}
+
+/* Wrap an acquired driver buffer of num samples for the pipeline. It is
+ * passed on as is while at least half of the n_direct buffers remain
+ * with the driver; past that it is copied and handed straight back, so a
+ * backlog in samples_queue cannot starve the driver into overflows. */
+static sample_buf_t *soapy_direct_buf(soapy_rx_t *sr, size_t handle,
+                                      const void *buf, int num, size_t mtu,
+                                      size_t n_direct) {
+    size_t sample_size = mode_sample_size[sr->sample_mode];
+    sample_buf_t *s = sample_buf_alloc(mtu * sample_size);
+
+    if (s != NULL && (size_t)atomic_load(&sr->direct_held) < n_direct / 2) {
+        atomic_fetch_add(&sr->direct_held, 1);
+        s->ext = buf;
+        s->handle = handle;
+        s->owner = sr;
+        s->release = soapy_release_buf;
+        sr->direct_passed++;
+        return s;
+    }
+
+    if (s != NULL)
+        memcpy(s->samples, buf, num * sample_size);
+    SoapySDRDevice_releaseReadBuffer(sr->device, sr->stream, handle);
+    sr->direct_copied++;
+    return s;
 }
 
 void *soapy_stream_thread(void *arg) {
-    SoapySDRDevice *device = (SoapySDRDevice *)arg;
+    soapy_rx_t *sr = (soapy_rx_t *)arg;
+    SoapySDRDevice *device = sr->device;
     SoapySDRStream *stream;
-    size_t channel = 0;
     int flags;
     long long time_ns;
-    const char *format;
     size_t mtu;
 
-    if (sample_mode == 0) {
-        format = SOAPY_SDR_CS8;
-        stream = SoapySDRDevice_setupStream(device, SOAPY_SDR_RX, format,
-                                             &channel, 1, NULL);
+    if (sr->sample_mode == 0) {
+        stream = soapy_setup_stream(sr);
         if (stream == NULL) {
             if (verbose)
-                warnx("CS8 stream failed, trying CF32");
-            sample_mode = 1;
+                warnx("CS8 stream failed, trying CS16");
+            sr->sample_mode = 2;
         }
     } else {
         stream = NULL;
     }
 
-    if (stream == NULL && sample_mode == 1) {
-        format = SOAPY_SDR_CF32;
-        stream = SoapySDRDevice_setupStream(device, SOAPY_SDR_RX, format,
-                                             &channel, 1, NULL);
+    if (stream == NULL && sr->sample_mode == 2) {
+        stream = soapy_setup_stream(sr);
         if (stream == NULL) {
             if (verbose)
-                warnx("CF32 stream failed, falling back to CS16");
-            sample_mode = 2;
+                warnx("CS16 stream failed, falling back to CF32");
+            sr->sample_mode = 1;
         }
     }
 
     if (stream == NULL) {
-        format = SOAPY_SDR_CS16;
-        stream = SoapySDRDevice_setupStream(device, SOAPY_SDR_RX, format,
-                                             &channel, 1, NULL);
+        stream = soapy_setup_stream(sr);
         if (stream == NULL)
             errx(1, "Unable to setup SoapySDR stream: %s", SoapySDRDevice_lastError());
     }
 
+    /* Drivers that expose their buffers are read through them */
+    size_t n_direct = SoapySDRDevice_getNumDirectAccessBuffers(device, stream);
+    sr->stream = stream;
+
     if (verbose)
-        fprintf(stderr, "SoapySDR: streaming with %s format\n", format);
+        fprintf(stderr, "SoapySDR: streaming with %s format%s\n",
+                mode_format[sr->sample_mode],
+                n_direct ? ", zero-copy from driver buffers" : "");
 
     mtu = SoapySDRDevice_getStreamMTU(device, stream);
     if (mtu == 0)
@@ -271,71 +366,71 @@ void *soapy_stream_thread(void *arg) {
      * before writeSetting can be used safely. */
     soapy_apply_settings(device);
 
-    int16_t *cs16_buf = NULL;
-    if (sample_mode == 2) {
-        cs16_buf = malloc(mtu * 2 * sizeof(int16_t));
-        if (cs16_buf == NULL)
-            errx(1, "Unable to allocate CS16 buffer");
-    }
-
-    /* Sample size per IQ pair depends on format */
-    size_t sample_size = (sample_mode == 0) ? 2 * sizeof(int8_t)
-                                            : 2 * sizeof(float);
+    size_t sample_size = mode_sample_size[sr->sample_mode];
 
     while (running) {
-        sample_buf_t *s = malloc(sizeof(*s) + mtu * sample_size);
-        if (s == NULL) {
-            warnx("Unable to allocate sample buffer");
-            break;
-        }
-
-        void *buffs[1];
+        sample_buf_t *s = NULL;
         int ret;
 
-        if (sample_mode == 2) {
-            /* CS16 -> float conversion */
-            buffs[0] = cs16_buf;
-            ret = SoapySDRDevice_readStream(device, stream, buffs, mtu,
-                                             &flags, &time_ns, 100000);
-            if (ret > 0)
-                soapy_cs16_to_float(cs16_buf, (float *)s->samples, ret);
-        } else if (sample_mode == 1) {
-            /* CF32 direct */
-            buffs[0] = s->samples;
-            ret = SoapySDRDevice_readStream(device, stream, buffs, mtu,
-                                             &flags, &time_ns, 100000);
+        if (n_direct > 0) {
+            size_t handle;
+            const void *buffs[1];
+            ret = SoapySDRDevice_acquireReadBuffer(device, stream, &handle,
+                                                   buffs, &flags, &time_ns,
+                                                   100000);
+            if (ret >= 0)
+                s = soapy_direct_buf(sr, handle, buffs[0], ret, mtu, n_direct);
         } else {
-            /* CS8 direct */
-            buffs[0] = s->samples;
+            /* Otherwise straight into the sample buffer */
+            s = sample_buf_alloc(mtu * sample_size);
+            if (s == NULL) {
+                warnx("Unable to allocate sample buffer");
+                break;
+            }
+            void *buffs[1] = { s->samples };
             ret = SoapySDRDevice_readStream(device, stream, buffs, mtu,
-                                             &flags, &time_ns, 100000);
+                                            &flags, &time_ns, 100000);
+            if (ret < 0) {
+                sample_buf_free(s);
+                s = NULL;
+            }
         }
 
         if (ret < 0) {
-            if (ret == SOAPY_SDR_TIMEOUT) {
-                free(s);
+            if (ret == SOAPY_SDR_TIMEOUT)
                 continue;
-            }
             if (ret == SOAPY_SDR_OVERFLOW) {
                 if (verbose)
                     warnx("SoapySDR overflow");
-                free(s);
                 continue;
             }
             warnx("SoapySDR read error: %d", ret);
-            free(s);
+            break;
+        }
+        if (s == NULL) {
+            warnx("Unable to allocate sample buffer");
             break;
         }
 
-        s->format = (sample_mode == 0) ? SAMPLE_FMT_INT8 : SAMPLE_FMT_FLOAT;
+        s->format = mode_sample_fmt[sr->sample_mode];
         s->num = ret;
+        s->rx = sr->rx;
         if (running)
             push_samples(s);
         else
-            free(s);
+            sample_buf_free(s);
     }
 
-    free(cs16_buf);
+    /* Give the detector a moment to hand back the driver buffers it still
+     * holds; any released later are dropped rather than released */
+    for (int i = 0; i < 100 && atomic_load(&sr->direct_held) > 0; i++)
+        usleep(10000);
+    pthread_mutex_lock(&sr->direct_lock);
+    sr->direct_closed = 1;
+    pthread_mutex_unlock(&sr->direct_lock);
+    if (verbose && n_direct > 0)
+        fprintf(stderr, "SoapySDR: %lu driver buffers passed on, %lu copied\n",
+                sr->direct_passed, sr->direct_copied);
 
     SoapySDRDevice_deactivateStream(device, stream, 0, 0);
     SoapySDRDevice_closeStream(device, stream);
@@ -346,6 +441,8 @@ void *soapy_stream_thread(void *arg) {
     return NULL;
 }
 
-void soapy_close(SoapySDRDevice *device) {
-    SoapySDRDevice_unmake(device);
+void soapy_close(soapy_rx_t *sr) {
+    SoapySDRDevice_unmake(sr->device);
+    pthread_mutex_destroy(&sr->direct_lock);
+    free(sr);
 }
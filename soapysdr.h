@@ -7,9 +7,13 @@
 
 #include <SoapySDR/Device.h>
 
+typedef struct soapy_rx soapy_rx_t;
+
 void soapy_list(void);
-SoapySDRDevice *soapy_setup(int id, const char *args);
+/* Open device id, or the one args names, tuned to freq; its blocks are
+ * tagged with receiver rx */
+soapy_rx_t *soapy_setup(int id, const char *args, double freq, int rx);
 void *soapy_stream_thread(void *arg);
-void soapy_close(SoapySDRDevice *device);
+void soapy_close(soapy_rx_t *sr);
 
 #endif
@@ -13,13 +13,15 @@
 
 #include <uhd.h>
 
+#include "sample_pool.h"
 #include "sdr.h"
 
 extern sig_atomic_t running;
 extern pid_t self_pid;
 extern double samp_rate;
-extern double center_freq;
 extern int usrp_gain_val;
+extern int sdr_buffers;
+extern int sdr_buffer_size;
 
 #define KVLEN 16
 typedef struct _kv_pair_t {
@@ -124,18 +126,19 @@ char *usrp_get_serial(char *name) {
     return dash + 1;
 }
 
-uhd_usrp_handle usrp_setup(char *serial) {
+uhd_usrp_handle usrp_setup(char *serial, double freq) {
     uhd_usrp_handle usrp;
     uhd_error error;
     char arg[128];
     uhd_tune_request_t tune_request = {
-        .target_freq = center_freq,
+        .target_freq = freq,
         .rf_freq_policy = UHD_TUNE_REQUEST_POLICY_AUTO,
         .dsp_freq_policy = UHD_TUNE_REQUEST_POLICY_AUTO,
     };
     uhd_tune_result_t tune_result;
 
-    snprintf(arg, sizeof(arg), "serial=%s,num_recv_frames=1024", serial);
+    snprintf(arg, sizeof(arg), "serial=%s,num_recv_frames=%d", serial,
+             sdr_buffers ? sdr_buffers : 1024);
 
     error = uhd_usrp_make(&usrp, arg);
     if (error)
@@ -152,7 +155,8 @@ uhd_usrp_handle usrp_setup(char *serial) {
 }
 
 void *usrp_stream_thread(void *arg) {
-    uhd_usrp_handle usrp = arg;
+    sdr_stream_t *rx = (sdr_stream_t *)arg;
+    uhd_usrp_handle usrp = rx->dev;
     uhd_rx_streamer_handle rx_handle;
     uhd_error error;
     uhd_rx_metadata_handle md;
@@ -180,12 +184,17 @@ void *usrp_stream_thread(void *arg) {
     if (error)
         errx(1, "Error opening RX stream: %u", error);
 
+    /* Receive blocks straight into pool buffers: one packet's worth, or
+     * --sdr-buffer-size samples gathered across packets */
     uhd_rx_streamer_max_num_samps(rx_handle, &num_samples);
+    if (sdr_buffer_size)
+        num_samples = sdr_buffer_size;
     uhd_rx_streamer_issue_stream_cmd(rx_handle, &stream_cmd);
 
     while (running) {
-        sample_buf_t *s = malloc(sizeof(*s) + num_samples * 2 * sizeof(int8_t));
+        sample_buf_t *s = sample_buf_alloc(num_samples * 2 * sizeof(int8_t));
         s->format = SAMPLE_FMT_INT8;
+        s->rx = rx->rx;
         buf = s->samples;
         uhd_rx_streamer_recv(rx_handle, &buf, num_samples, &md, 3.0, false, &num_rx_samples);
         uhd_rx_metadata_error_code(md, &error_code);
@@ -195,7 +204,7 @@ void *usrp_stream_thread(void *arg) {
         if (running)
             push_samples(s);
         else
-            free(s);
+            sample_buf_free(s);
     }
 
     stream_cmd.stream_mode = UHD_STREAM_MODE_STOP_CONTINUOUS;
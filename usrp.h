@@ -8,8 +8,9 @@
 #include <uhd.h>
 
 void usrp_list(void);
-uhd_usrp_handle usrp_setup(char *serial);
+uhd_usrp_handle usrp_setup(char *serial, double freq);
 char *usrp_get_serial(char *name);
+/* arg: sdr_stream_t with the handle from usrp_setup() */
 void *usrp_stream_thread(void *arg);
 void usrp_close(uhd_usrp_handle usrp);
 
@@ -6,9 +6,15 @@
  *   2. GPU: VkFFT batched forward FFT (in-place)
  *   3. CPU: fftshift + magnitude squared (read from mapped GPU buffer)
  *
- * Uses host-visible coherent memory for zero-copy transfers.
+ * Uses host-visible coherent memory for zero-copy transfers: step 1
+ * reads the frames in the detector's ring buffer and writes the mapped
+ * buffer directly. Each in-flight batch has its own buffer, command
+ * buffer and fence.
  * Suitable for shared-memory GPUs (Pi5 VideoCore VII) and discrete GPUs.
  *
+ * The downmix engine runs plain batched transforms the same way: copy
+ * the rows into the mapped buffer, transform in place, copy them out.
+ *
  * Copyright (c) 2026 CEMAXECUTER LLC
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
@@ -21,12 +27,19 @@
  *   2. GPU: VkFFT batched forward FFT (in-place)
  *   3. CPU: fftshift + magnitude squared (read from mapped GPU buffer)
  *
- * Uses host-visible coherent memory for zero-copy transfers.
+ * Uses host-visible coherent memory for zero-copy transfers: step 1
+ * reads the frames in the detector's ring buffer and writes the mapped
+ * buffer directly. Each in-flight batch has its own buffer, command
+ * buffer and fence.
  * Suitable for shared-memory GPUs (Pi5 VideoCore VII) and discrete GPUs.
+ *
+ * The downmix engine runs plain batched transforms the same way: copy
+ * the rows into the mapped buffer, transform in place, copy them out.
  */
 
 #ifdef USE_VULKAN
 
+#include <complex.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -38,31 +51,52 @@
 #include "vkFFT.h"
 
 #include "burst_fft.h"
+#include "simd_kernels.h"
 
-/* ---- GPU context ---- */
+/* ---- Device context ----
+ *
+ * Instance, compute queue and command pool, plus one or more slots of a
+ * command buffer, fence and permanently mapped host-visible buffer:
+ * everything VkFFT apps on those buffers need. Shared by the detector
+ * and downmix engines.
+ */
 
-struct gpu_burst_fft {
-    int fft_size;
-    int batch_size;
-    float *window;          /* CPU-side window coefficients */
+typedef struct {
+    VkCommandBuffer command_buffer;
+    VkFence fence;
 
-    /* Vulkan objects */
+    /* Buffer (host-visible, coherent) */
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+    float *mapped;          /* permanently mapped pointer */
+    int in_flight;          /* submitted, fence not waited for yet */
+} vk_slot_t;
+
+typedef struct {
     VkInstance instance;
     VkPhysicalDevice physical_device;
     VkDevice device;
     VkQueue queue;
     uint32_t queue_family;
     VkCommandPool command_pool;
-    VkCommandBuffer command_buffer;
-    VkFence fence;
 
-    /* Buffer (host-visible, coherent) */
-    VkBuffer buffer;
-    VkDeviceMemory memory;
-    float *mapped;          /* permanently mapped pointer */
-    uint64_t buffer_size;
+    vk_slot_t slots[GPU_BURST_FFT_SLOTS];
+    int n_slots;
+    uint64_t buffer_size;   /* per slot */
+} vk_ctx_t;
+
+/* ---- GPU context ---- */
+
+struct gpu_burst_fft {
+    int fft_size;
+    int batch_size;
+    float *window;          /* CPU-side window coefficients */
+
+    vk_ctx_t vk;            /* one slot per in-flight batch */
+    float *magnitude[GPU_BURST_FFT_SLOTS];
+    int batch_count[GPU_BURST_FFT_SLOTS];
 
-    /* VkFFT */
+    /* VkFFT: one app, launched on each slot's buffer */
     VkFFTApplication vkfft_app;
 };
 
@@ -115,21 +149,108 @@ static int find_compute_queue_family(VkPhysicalDevice phys) {
     return idx;
 }
 
-/* ---- Create ---- */
+/* ---- Device context setup ---- */
 
-gpu_burst_fft_t *gpu_burst_fft_create(int fft_size, int batch_size,
-                                       const float *window) {
+/* Command buffer, fence and mapped buffer of one slot. On error the
+ * caller releases the slot with vk_slot_destroy(). */
+static int vk_slot_create(vk_ctx_t *c, vk_slot_t *sl) {
     VkResult vk;
 
-    gpu_burst_fft_t *g = calloc(1, sizeof(*g));
-    if (!g) return NULL;
+    VkCommandBufferAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = c->command_pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
 
-    g->fft_size = fft_size;
-    g->batch_size = batch_size;
+    vk = vkAllocateCommandBuffers(c->device, &alloc_info, &sl->command_buffer);
+    if (vk != VK_SUCCESS) {
+        fprintf(stderr, "Vulkan: allocate command buffer error %d\n", vk);
+        return -1;
+    }
 
-    /* Save window coefficients for CPU-side multiply */
-    g->window = malloc(sizeof(float) * fft_size);
-    memcpy(g->window, window, sizeof(float) * fft_size);
+    /* ---- Fence ---- */
+    VkFenceCreateInfo fence_info = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    };
+
+    vk = vkCreateFence(c->device, &fence_info, NULL, &sl->fence);
+    if (vk != VK_SUCCESS) {
+        fprintf(stderr, "Vulkan: create fence error %d\n", vk);
+        return -1;
+    }
+
+    /* ---- Allocate GPU buffer ---- */
+    VkBufferCreateInfo buf_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = c->buffer_size,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+               | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+               | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    vk = vkCreateBuffer(c->device, &buf_info, NULL, &sl->buffer);
+    if (vk != VK_SUCCESS) {
+        fprintf(stderr, "Vulkan: create buffer error %d\n", vk);
+        return -1;
+    }
+
+    /* Find host-visible, coherent memory */
+    VkMemoryRequirements mem_reqs;
+    vkGetBufferMemoryRequirements(c->device, sl->buffer, &mem_reqs);
+
+    uint32_t mem_type = find_memory_type(c->physical_device, mem_reqs.memoryTypeBits,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (mem_type == UINT32_MAX) {
+        fprintf(stderr, "Vulkan: no suitable memory type found\n");
+        return -1;
+    }
+
+    VkMemoryAllocateInfo mem_info = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = mem_reqs.size,
+        .memoryTypeIndex = mem_type,
+    };
+
+    vk = vkAllocateMemory(c->device, &mem_info, NULL, &sl->memory);
+    if (vk != VK_SUCCESS) {
+        fprintf(stderr, "Vulkan: allocate memory error %d\n", vk);
+        return -1;
+    }
+
+    vk = vkBindBufferMemory(c->device, sl->buffer, sl->memory, 0);
+    if (vk != VK_SUCCESS) {
+        fprintf(stderr, "Vulkan: bind buffer memory error %d\n", vk);
+        return -1;
+    }
+
+    /* Map buffer permanently */
+    vk = vkMapMemory(c->device, sl->memory, 0, c->buffer_size, 0,
+                     (void **)&sl->mapped);
+    if (vk != VK_SUCCESS) {
+        fprintf(stderr, "Vulkan: map memory error %d\n", vk);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Vulkan accepts null handles here, so a partly created slot is fine */
+static void vk_slot_destroy(vk_ctx_t *c, vk_slot_t *sl) {
+    if (sl->mapped)
+        vkUnmapMemory(c->device, sl->memory);
+    vkFreeMemory(c->device, sl->memory, NULL);
+    vkDestroyBuffer(c->device, sl->buffer, NULL);
+    vkDestroyFence(c->device, sl->fence, NULL);
+    memset(sl, 0, sizeof(*sl));
+}
+
+/* Bring up the device and n_slots slots with a buffer_size byte mapped
+ * buffer each, and initialize glslang. Returns 0, or -1 with everything
+ * released. */
+static int vk_ctx_create(vk_ctx_t *c, uint64_t buffer_size, int n_slots) {
+    VkResult vk;
 
     /* ---- Create Vulkan instance ---- */
     VkApplicationInfo app_info = {
@@ -143,52 +264,52 @@ gpu_burst_fft_t *gpu_burst_fft_create(int fft_size, int batch_size,
         .pApplicationInfo = &app_info,
     };
 
-    vk = vkCreateInstance(&inst_info, NULL, &g->instance);
+    vk = vkCreateInstance(&inst_info, NULL, &c->instance);
     if (vk != VK_SUCCESS) {
         fprintf(stderr, "Vulkan: create instance error %d\n", vk);
-        goto err_free;
+        return -1;
     }
 
     /* ---- Find physical device ---- */
     uint32_t dev_count = 0;
-    vkEnumeratePhysicalDevices(g->instance, &dev_count, NULL);
+    vkEnumeratePhysicalDevices(c->instance, &dev_count, NULL);
     if (dev_count == 0) {
         fprintf(stderr, "Vulkan: no devices found\n");
         goto err_instance;
     }
 
     VkPhysicalDevice *devices = malloc(dev_count * sizeof(VkPhysicalDevice));
-    vkEnumeratePhysicalDevices(g->instance, &dev_count, devices);
+    vkEnumeratePhysicalDevices(c->instance, &dev_count, devices);
 
     /* Prefer discrete GPU, fall back to any */
-    g->physical_device = devices[0];
+    c->physical_device = devices[0];
     for (uint32_t i = 0; i < dev_count; i++) {
         VkPhysicalDeviceProperties props;
         vkGetPhysicalDeviceProperties(devices[i], &props);
         if (props.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
-            g->physical_device = devices[i];
+            c->physical_device = devices[i];
             break;
         }
     }
 
     VkPhysicalDeviceProperties dev_props;
-    vkGetPhysicalDeviceProperties(g->physical_device, &dev_props);
+    vkGetPhysicalDeviceProperties(c->physical_device, &dev_props);
     fprintf(stderr, "Vulkan GPU: %s\n", dev_props.deviceName);
     free(devices);
 
     /* ---- Find compute queue family ---- */
-    int qf = find_compute_queue_family(g->physical_device);
+    int qf = find_compute_queue_family(c->physical_device);
     if (qf < 0) {
         fprintf(stderr, "Vulkan: no compute queue found\n");
         goto err_instance;
     }
-    g->queue_family = (uint32_t)qf;
+    c->queue_family = (uint32_t)qf;
 
     /* ---- Create logical device ---- */
     float queue_priority = 1.0f;
     VkDeviceQueueCreateInfo queue_info = {
         .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-        .queueFamilyIndex = g->queue_family,
+        .queueFamilyIndex = c->queue_family,
         .queueCount = 1,
         .pQueuePriorities = &queue_priority,
     };
@@ -198,222 +319,242 @@ gpu_burst_fft_t *gpu_burst_fft_create(int fft_size, int batch_size,
         .pQueueCreateInfos = &queue_info,
     };
 
-    vk = vkCreateDevice(g->physical_device, &dev_info, NULL, &g->device);
+    vk = vkCreateDevice(c->physical_device, &dev_info, NULL, &c->device);
     if (vk != VK_SUCCESS) {
         fprintf(stderr, "Vulkan: create device error %d\n", vk);
         goto err_instance;
     }
 
-    vkGetDeviceQueue(g->device, g->queue_family, 0, &g->queue);
+    vkGetDeviceQueue(c->device, c->queue_family, 0, &c->queue);
 
-    /* ---- Command pool + buffer ---- */
+    /* ---- Command pool + slots ---- */
     VkCommandPoolCreateInfo pool_info = {
         .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
         .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-        .queueFamilyIndex = g->queue_family,
+        .queueFamilyIndex = c->queue_family,
     };
 
-    vk = vkCreateCommandPool(g->device, &pool_info, NULL, &g->command_pool);
+    vk = vkCreateCommandPool(c->device, &pool_info, NULL, &c->command_pool);
     if (vk != VK_SUCCESS) {
         fprintf(stderr, "Vulkan: create command pool error %d\n", vk);
         goto err_device;
     }
 
-    VkCommandBufferAllocateInfo alloc_info = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .commandPool = g->command_pool,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = 1,
-    };
-
-    vk = vkAllocateCommandBuffers(g->device, &alloc_info, &g->command_buffer);
-    if (vk != VK_SUCCESS) {
-        fprintf(stderr, "Vulkan: allocate command buffer error %d\n", vk);
-        goto err_pool;
+    c->buffer_size = buffer_size;
+    c->n_slots = n_slots;
+    for (int i = 0; i < n_slots; i++) {
+        if (vk_slot_create(c, &c->slots[i]) != 0)
+            goto err_slots;
     }
 
-    /* ---- Fence ---- */
-    VkFenceCreateInfo fence_info = {
-        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-    };
+    /* ---- Initialize glslang (VkFFT needs it for shader compilation) ---- */
+    glslang_initialize_process();
+    return 0;
 
-    vk = vkCreateFence(g->device, &fence_info, NULL, &g->fence);
-    if (vk != VK_SUCCESS) {
-        fprintf(stderr, "Vulkan: create fence error %d\n", vk);
-        goto err_pool;
+err_slots:
+    for (int i = 0; i < n_slots; i++)
+        vk_slot_destroy(c, &c->slots[i]);
+    vkDestroyCommandPool(c->device, c->command_pool, NULL);
+err_device:
+    vkDestroyDevice(c->device, NULL);
+err_instance:
+    vkDestroyInstance(c->instance, NULL);
+    return -1;
+}
+
+static void vk_ctx_destroy(vk_ctx_t *c) {
+    glslang_finalize_process();
+
+    /* Nothing may still be running on the buffers */
+    for (int i = 0; i < c->n_slots; i++) {
+        if (c->slots[i].in_flight)
+            vkWaitForFences(c->device, 1, &c->slots[i].fence, VK_TRUE,
+                            (uint64_t)5000000000);
+        vk_slot_destroy(c, &c->slots[i]);
     }
+    vkDestroyCommandPool(c->device, c->command_pool, NULL);
+    vkDestroyDevice(c->device, NULL);
+    vkDestroyInstance(c->instance, NULL);
+}
 
-    /* ---- Allocate GPU buffer ---- */
-    g->buffer_size = (uint64_t)batch_size * fft_size * 2 * sizeof(float);
+/* VkFFT app transforming batches rows of size points on a slot's
+ * buffer (each launch names the slot) */
+static VkFFTResult vk_ctx_fft_init(vk_ctx_t *c, VkFFTApplication *app,
+                                   int size, int batches) {
+    VkFFTConfiguration config = {};
+    config.FFTdim = 1;
+    config.size[0] = (uint64_t)size;
+    config.numberBatches = (uint64_t)batches;
+    config.physicalDevice = &c->physical_device;
+    config.device = &c->device;
+    config.queue = &c->queue;
+    config.commandPool = &c->command_pool;
+    config.fence = &c->slots[0].fence;
+    config.isCompilerInitialized = 1;
+    config.buffer = &c->slots[0].buffer;
+    config.bufferSize = &c->buffer_size;
 
-    VkBufferCreateInfo buf_info = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .size = g->buffer_size,
-        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
-               | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
-               | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    return initializeVkFFT(app, config);
+}
+
+/* Record and submit one transform of a slot's mapped buffer */
+static int vk_ctx_fft_submit(vk_ctx_t *c, int slot, VkFFTApplication *app,
+                             int sign) {
+    vk_slot_t *sl = &c->slots[slot];
+    VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
     };
 
-    vk = vkCreateBuffer(g->device, &buf_info, NULL, &g->buffer);
-    if (vk != VK_SUCCESS) {
-        fprintf(stderr, "Vulkan: create buffer error %d\n", vk);
-        goto err_fence;
-    }
+    vkResetCommandBuffer(sl->command_buffer, 0);
+    vkBeginCommandBuffer(sl->command_buffer, &begin_info);
 
-    /* Find host-visible, coherent memory */
-    VkMemoryRequirements mem_reqs;
-    vkGetBufferMemoryRequirements(g->device, g->buffer, &mem_reqs);
+    VkFFTLaunchParams params = {};
+    params.commandBuffer = &sl->command_buffer;
+    params.buffer = &sl->buffer;
 
-    uint32_t mem_type = find_memory_type(g->physical_device, mem_reqs.memoryTypeBits,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    if (mem_type == UINT32_MAX) {
-        fprintf(stderr, "Vulkan: no suitable memory type found\n");
-        goto err_buffer;
+    VkFFTResult vk_res = VkFFTAppend(app, sign, &params);
+    if (vk_res != VKFFT_SUCCESS) {
+        fprintf(stderr, "GPU: VkFFT error %d\n", vk_res);
+        vkEndCommandBuffer(sl->command_buffer);
+        return -1;
     }
 
-    VkMemoryAllocateInfo mem_info = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = mem_reqs.size,
-        .memoryTypeIndex = mem_type,
+    vkEndCommandBuffer(sl->command_buffer);
+
+    VkSubmitInfo submit_info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &sl->command_buffer,
     };
 
-    vk = vkAllocateMemory(g->device, &mem_info, NULL, &g->memory);
+    VkResult vk = vkQueueSubmit(c->queue, 1, &submit_info, sl->fence);
     if (vk != VK_SUCCESS) {
-        fprintf(stderr, "Vulkan: allocate memory error %d\n", vk);
-        goto err_buffer;
+        fprintf(stderr, "GPU: queue submit error %d\n", vk);
+        return -1;
     }
+    sl->in_flight = 1;
+    return 0;
+}
 
-    vk = vkBindBufferMemory(g->device, g->buffer, g->memory, 0);
-    if (vk != VK_SUCCESS) {
-        fprintf(stderr, "Vulkan: bind buffer memory error %d\n", vk);
-        goto err_memory;
-    }
+/* Wait for a slot's transform. Returns 0, -1 on error, or 1 if the
+ * fence wait timed out (the device may be stuck). */
+static int vk_ctx_fft_wait(vk_ctx_t *c, int slot, uint64_t timeout_ns) {
+    vk_slot_t *sl = &c->slots[slot];
 
-    /* Map buffer permanently */
-    vk = vkMapMemory(g->device, g->memory, 0, g->buffer_size, 0,
-                     (void **)&g->mapped);
+    if (!sl->in_flight)
+        return -1;
+    VkResult vk = vkWaitForFences(c->device, 1, &sl->fence, VK_TRUE,
+                                  timeout_ns);
+    if (vk == VK_TIMEOUT)
+        return 1;
+    sl->in_flight = 0;
     if (vk != VK_SUCCESS) {
-        fprintf(stderr, "Vulkan: map memory error %d\n", vk);
-        goto err_memory;
+        fprintf(stderr, "GPU: fence wait failed\n");
+        return -1;
     }
+    vkResetFences(c->device, 1, &sl->fence);
+    return 0;
+}
 
-    /* ---- Initialize glslang (VkFFT needs it for shader compilation) ---- */
-    glslang_initialize_process();
-
-    /* ---- Initialize VkFFT ---- */
-    VkFFTConfiguration config = {};
-    config.FFTdim = 1;
-    config.size[0] = (uint64_t)fft_size;
-    config.numberBatches = (uint64_t)batch_size;
-    config.physicalDevice = &g->physical_device;
-    config.device = &g->device;
-    config.queue = &g->queue;
-    config.commandPool = &g->command_pool;
-    config.fence = &g->fence;
-    config.isCompilerInitialized = 1;
-    config.buffer = &g->buffer;
-    config.bufferSize = &g->buffer_size;
+static int vk_ctx_fft_run(vk_ctx_t *c, int slot, VkFFTApplication *app,
+                          int sign, uint64_t timeout_ns) {
+    if (vk_ctx_fft_submit(c, slot, app, sign) != 0)
+        return -1;
+    return vk_ctx_fft_wait(c, slot, timeout_ns);
+}
 
-    VkFFTResult vk_res = initializeVkFFT(&g->vkfft_app, config);
-    if (vk_res != VKFFT_SUCCESS) {
-        fprintf(stderr, "VkFFT init error: %d\n", vk_res);
-        goto err_glslang;
-    }
+/* Some GPUs (e.g. Pi5 VideoCore VII) report Vulkan support but cannot
+ * execute VkFFT compute shaders correctly. Run a single DC-input forward
+ * FFT of size points on every slot and check the output makes sense.
+ * Returns 0 if it passed, -1 if it failed, 1 if the device hung (skip
+ * cleanup that could hang too). */
+static int vk_ctx_validate(vk_ctx_t *c, VkFFTApplication *app, int size) {
+    for (int s = 0; s < c->n_slots; s++) {
+        float *mapped = c->slots[s].mapped;
 
-    /* ---- Validation: run a test FFT to verify GPU actually works ----
-     * Some GPUs (e.g. Pi5 VideoCore VII) report Vulkan support but
-     * cannot execute VkFFT compute shaders correctly.  Run a single
-     * DC-input FFT and check the output makes sense. */
-    {
         /* Fill first frame with DC signal: all (1.0, 0.0) */
-        for (int i = 0; i < fft_size; i++) {
-            g->mapped[2 * i]     = 1.0f;
-            g->mapped[2 * i + 1] = 0.0f;
-        }
-
-        VkCommandBufferBeginInfo tbi = {
-            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-        };
-        vkResetCommandBuffer(g->command_buffer, 0);
-        vkBeginCommandBuffer(g->command_buffer, &tbi);
-
-        VkFFTLaunchParams tp = {};
-        tp.commandBuffer = &g->command_buffer;
-        tp.buffer = &g->buffer;
-        VkFFTResult tr = VkFFTAppend(&g->vkfft_app, -1, &tp);
-
-        if (tr != VKFFT_SUCCESS) {
-            fprintf(stderr, "GPU validation: VkFFT append failed (%d), disabling GPU\n", tr);
-            goto err_glslang;
-        }
-
-        vkEndCommandBuffer(g->command_buffer);
-
-        VkSubmitInfo tsi = {
-            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-            .commandBufferCount = 1,
-            .pCommandBuffers = &g->command_buffer,
-        };
-
-        vk = vkQueueSubmit(g->queue, 1, &tsi, g->fence);
-        if (vk != VK_SUCCESS) {
-            fprintf(stderr, "GPU validation: submit failed (%d), disabling GPU\n", vk);
-            goto err_glslang;
+        for (int i = 0; i < size; i++) {
+            mapped[2 * i]     = 1.0f;
+            mapped[2 * i + 1] = 0.0f;
         }
 
         /* Wait with 2-second timeout instead of forever */
-        vk = vkWaitForFences(g->device, 1, &g->fence, VK_TRUE,
-                             (uint64_t)2000000000);
-        if (vk == VK_TIMEOUT) {
+        int r = vk_ctx_fft_run(c, s, app, -1, (uint64_t)2000000000);
+        if (r == 1) {
             fprintf(stderr, "GPU validation: FFT timed out (GPU compute broken), disabling GPU\n");
-            /* Device may be stuck -- skip cleanup that could hang */
-            vkDestroyInstance(g->instance, NULL);
-            free(g->window);
-            free(g);
-            return NULL;
+            return 1;
         }
-        if (vk != VK_SUCCESS) {
-            fprintf(stderr, "GPU validation: fence wait error (%d), disabling GPU\n", vk);
-            goto err_glslang;
+        if (r != 0) {
+            fprintf(stderr, "GPU validation: FFT failed, disabling GPU\n");
+            return -1;
         }
-        vkResetFences(g->device, 1, &g->fence);
 
-        /* DC input FFT: bin 0 should have all the energy (re = fft_size, im = 0).
+        /* DC input FFT: bin 0 should have all the energy (re = size, im = 0).
          * Just check that bin 0 magnitude >> other bins. */
-        float dc_re = g->mapped[0];
-        float dc_im = g->mapped[1];
+        float dc_re = mapped[0];
+        float dc_im = mapped[1];
         float dc_mag = dc_re * dc_re + dc_im * dc_im;
-        float expected = (float)fft_size * (float)fft_size;
+        float expected = (float)size * (float)size;
 
         if (dc_mag < expected * 0.5f || dc_mag > expected * 2.0f) {
             fprintf(stderr, "GPU validation: DC test failed (expected ~%.0f, got %.0f), disabling GPU\n",
                     expected, dc_mag);
-            goto err_glslang;
+            return -1;
         }
     }
+    return 0;
+}
+
+/* ---- Create ---- */
+
+gpu_burst_fft_t *gpu_burst_fft_create(int fft_size, int batch_size,
+                                       const float *window) {
+    gpu_burst_fft_t *g = calloc(1, sizeof(*g));
+    if (!g) return NULL;
 
-    fprintf(stderr, "GPU burst FFT: %d-point, batch %d, VkFFT ready\n",
-            fft_size, batch_size);
+    g->fft_size = fft_size;
+    g->batch_size = batch_size;
+
+    /* Save window coefficients for CPU-side multiply */
+    g->window = malloc(sizeof(float) * fft_size);
+    memcpy(g->window, window, sizeof(float) * fft_size);
+    for (int i = 0; i < GPU_BURST_FFT_SLOTS; i++)
+        g->magnitude[i] = malloc(sizeof(float) * batch_size * fft_size);
+
+    if (vk_ctx_create(&g->vk, (uint64_t)batch_size * fft_size * 2 * sizeof(float),
+                      GPU_BURST_FFT_SLOTS) != 0)
+        goto err_free;
+
+    /* ---- Initialize VkFFT ---- */
+    VkFFTResult vk_res = vk_ctx_fft_init(&g->vk, &g->vkfft_app,
+                                         fft_size, batch_size);
+    if (vk_res != VKFFT_SUCCESS) {
+        fprintf(stderr, "VkFFT init error: %d\n", vk_res);
+        goto err_ctx;
+    }
+
+    /* ---- Validation: run a test FFT to verify GPU actually works ---- */
+    int v = vk_ctx_validate(&g->vk, &g->vkfft_app, fft_size);
+    if (v == 1) {
+        /* Device may be stuck -- skip cleanup that could hang */
+        vkDestroyInstance(g->vk.instance, NULL);
+        goto err_free;
+    }
+    if (v != 0)
+        goto err_app;
+
+    fprintf(stderr, "GPU burst FFT: %d-point, batch %d x %d, VkFFT ready\n",
+            fft_size, batch_size, GPU_BURST_FFT_SLOTS);
     return g;
 
-err_glslang:
-    glslang_finalize_process();
-    vkUnmapMemory(g->device, g->memory);
-err_memory:
-    vkFreeMemory(g->device, g->memory, NULL);
-err_buffer:
-    vkDestroyBuffer(g->device, g->buffer, NULL);
-err_fence:
-    vkDestroyFence(g->device, g->fence, NULL);
-err_pool:
-    vkDestroyCommandPool(g->device, g->command_pool, NULL);
-err_device:
-    vkDestroyDevice(g->device, NULL);
-err_instance:
-    vkDestroyInstance(g->instance, NULL);
+err_app:
+    deleteVkFFT(&g->vkfft_app);
+err_ctx:
+    vk_ctx_destroy(&g->vk);
 err_free:
+    for (int i = 0; i < GPU_BURST_FFT_SLOTS; i++)
+        free(g->magnitude[i]);
     free(g->window);
     free(g);
     return NULL;
@@ -425,92 +566,177 @@ void gpu_burst_fft_destroy(gpu_burst_fft_t *g) {
     if (!g) return;
 
     deleteVkFFT(&g->vkfft_app);
-    glslang_finalize_process();
-
-    vkUnmapMemory(g->device, g->memory);
-    vkFreeMemory(g->device, g->memory, NULL);
-    vkDestroyBuffer(g->device, g->buffer, NULL);
-    vkDestroyFence(g->device, g->fence, NULL);
-    vkDestroyCommandPool(g->device, g->command_pool, NULL);
-    vkDestroyDevice(g->device, NULL);
-    vkDestroyInstance(g->instance, NULL);
+    vk_ctx_destroy(&g->vk);
 
+    for (int i = 0; i < GPU_BURST_FFT_SLOTS; i++)
+        free(g->magnitude[i]);
     free(g->window);
     free(g);
 }
 
 /* ---- Process batch ---- */
 
-int gpu_burst_fft_process(gpu_burst_fft_t *g, const float *input,
-                           float *output, int batch_count) {
-    if (batch_count <= 0 || batch_count > g->batch_size)
+int gpu_burst_fft_submit(gpu_burst_fft_t *g, int slot,
+                          const float *const *frames, int batch_count) {
+    if (batch_count <= 0 || batch_count > g->batch_size ||
+        slot < 0 || slot >= GPU_BURST_FFT_SLOTS || g->vk.slots[slot].in_flight)
         return -1;
 
-    int n = batch_count * g->fft_size;
+    float complex *mapped = (float complex *)g->vk.slots[slot].mapped;
 
-    /* Step 1: CPU window multiply, write to mapped GPU buffer */
-    for (int i = 0; i < n; i++) {
-        int win_idx = i % g->fft_size;
-        float w = g->window[win_idx];
-        g->mapped[2 * i]     = input[2 * i]     * w;
-        g->mapped[2 * i + 1] = input[2 * i + 1] * w;
-    }
+    /* Step 1: CPU window multiply, straight from the caller's frames into
+     * the mapped GPU buffer */
+    for (int i = 0; i < batch_count; i++)
+        simd_window_cf((const float complex *)frames[i], g->window,
+                       mapped + (size_t)i * g->fft_size, g->fft_size);
 
     /* Step 2: Record and submit VkFFT forward FFT */
-    VkCommandBufferBeginInfo begin_info = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-    };
+    g->batch_count[slot] = batch_count;
+    return vk_ctx_fft_submit(&g->vk, slot, &g->vkfft_app, -1);
+}
 
-    vkResetCommandBuffer(g->command_buffer, 0);
-    vkBeginCommandBuffer(g->command_buffer, &begin_info);
+const float *gpu_burst_fft_wait(gpu_burst_fft_t *g, int slot) {
+    if (slot < 0 || slot >= GPU_BURST_FFT_SLOTS)
+        return NULL;
 
-    VkFFTLaunchParams params = {};
-    params.commandBuffer = &g->command_buffer;
-    params.buffer = &g->buffer;
+    /* 5-second timeout prevents hanging on broken GPUs */
+    int r = vk_ctx_fft_wait(&g->vk, slot, (uint64_t)5000000000);
+    if (r != 0) {
+        if (r == 1)
+            fprintf(stderr, "GPU: fence wait timed out\n");
+        return NULL;
+    }
 
-    VkFFTResult vk_res = VkFFTAppend(&g->vkfft_app, -1, &params);
-    if (vk_res != VKFFT_SUCCESS) {
-        fprintf(stderr, "GPU: VkFFT error %d\n", vk_res);
+    /* Step 3: CPU fftshift + magnitude squared */
+    const float complex *mapped = (const float complex *)g->vk.slots[slot].mapped;
+    for (int i = 0; i < g->batch_count[slot]; i++)
+        simd_fftshift_mag(mapped + (size_t)i * g->fft_size,
+                          g->magnitude[slot] + (size_t)i * g->fft_size,
+                          g->fft_size);
+
+    return g->magnitude[slot];
+}
+
+/* ---- Batched downmix FFTs ---- */
+
+struct gpu_downmix_fft {
+    int cfo_size;
+    int corr_size;
+    int batch_size;
+
+    /* Buffer: complex, max(batch * cfo, 2 * batch * corr) */
+    vk_ctx_t vk;
+
+    /* One app per shape, all on the same buffer */
+    VkFFTApplication app_cfo;       /* cfo_size x batch */
+    VkFFTApplication app_corr;      /* corr_size x batch */
+    VkFFTApplication app_corr_inv;  /* corr_size x 2 * batch */
+    int n_apps;
+};
+
+static int downmix_app_init(gpu_downmix_fft_t *g, VkFFTApplication *app,
+                            int size, int batches) {
+    VkFFTResult res = vk_ctx_fft_init(&g->vk, app, size, batches);
+    if (res != VKFFT_SUCCESS) {
+        fprintf(stderr, "VkFFT init error: %d (%d-point x %d)\n",
+                res, size, batches);
         return -1;
     }
+    g->n_apps++;
+    return 0;
+}
 
-    vkEndCommandBuffer(g->command_buffer);
+static void downmix_apps_delete(gpu_downmix_fft_t *g) {
+    /* Apps are initialized in this order; release the ones that were */
+    if (g->n_apps > 0) deleteVkFFT(&g->app_cfo);
+    if (g->n_apps > 1) deleteVkFFT(&g->app_corr);
+    if (g->n_apps > 2) deleteVkFFT(&g->app_corr_inv);
+}
 
-    VkSubmitInfo submit_info = {
-        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .commandBufferCount = 1,
-        .pCommandBuffers = &g->command_buffer,
-    };
+gpu_downmix_fft_t *gpu_downmix_fft_create(int cfo_size, int corr_size,
+                                           int batch_size) {
+    gpu_downmix_fft_t *g = calloc(1, sizeof(*g));
+    if (!g) return NULL;
 
-    VkResult vk = vkQueueSubmit(g->queue, 1, &submit_info, g->fence);
-    if (vk != VK_SUCCESS) {
-        fprintf(stderr, "GPU: queue submit error %d\n", vk);
-        return -1;
+    g->cfo_size = cfo_size;
+    g->corr_size = corr_size;
+    g->batch_size = batch_size;
+
+    uint64_t cfo_elems = (uint64_t)batch_size * cfo_size;
+    uint64_t corr_elems = (uint64_t)2 * batch_size * corr_size;
+    uint64_t bytes = (cfo_elems > corr_elems ? cfo_elems : corr_elems)
+                   * 2 * sizeof(float);
+
+    if (vk_ctx_create(&g->vk, bytes, 1) != 0) {
+        free(g);
+        return NULL;
     }
 
-    /* 5-second timeout prevents hanging on broken GPUs */
-    vk = vkWaitForFences(g->device, 1, &g->fence, VK_TRUE,
-                         (uint64_t)5000000000);
-    if (vk != VK_SUCCESS) {
-        fprintf(stderr, "GPU: fence wait %s\n",
-                vk == VK_TIMEOUT ? "timed out" : "failed");
-        return -1;
+    if (downmix_app_init(g, &g->app_cfo, cfo_size, batch_size) != 0 ||
+        downmix_app_init(g, &g->app_corr, corr_size, batch_size) != 0 ||
+        downmix_app_init(g, &g->app_corr_inv, corr_size, 2 * batch_size) != 0)
+        goto err_apps;
+
+    int v = vk_ctx_validate(&g->vk, &g->app_cfo, cfo_size);
+    if (v == 1) {
+        /* Device may be stuck -- skip cleanup that could hang */
+        vkDestroyInstance(g->vk.instance, NULL);
+        free(g);
+        return NULL;
     }
-    vkResetFences(g->device, 1, &g->fence);
+    if (v != 0)
+        goto err_apps;
 
-    /* Step 3: CPU fftshift + magnitude squared */
-    int half_n = g->fft_size / 2;
-    for (int i = 0; i < n; i++) {
-        int frame = i / g->fft_size;
-        int bin = i % g->fft_size;
-        int src_bin = (bin + half_n) % g->fft_size;
-        int src_idx = frame * g->fft_size + src_bin;
-        float re = g->mapped[2 * src_idx];
-        float im = g->mapped[2 * src_idx + 1];
-        output[i] = re * re + im * im;
+    fprintf(stderr, "GPU downmix FFT: %d/%d-point, batch %d, VkFFT ready\n",
+            cfo_size, corr_size, batch_size);
+    return g;
+
+err_apps:
+    downmix_apps_delete(g);
+    vk_ctx_destroy(&g->vk);
+    free(g);
+    return NULL;
+}
+
+void gpu_downmix_fft_destroy(gpu_downmix_fft_t *g) {
+    if (!g) return;
+
+    downmix_apps_delete(g);
+    vk_ctx_destroy(&g->vk);
+    free(g);
+}
+
+int gpu_downmix_fft_execute(gpu_downmix_fft_t *g, float *data, int size,
+                             int rows, int sign) {
+    VkFFTApplication *app;
+    int max_rows;
+
+    if (sign > 0) {
+        app = &g->app_corr_inv;
+        max_rows = 2 * g->batch_size;
+    } else if (size == g->cfo_size) {
+        app = &g->app_cfo;
+        max_rows = g->batch_size;
+    } else {
+        app = &g->app_corr;
+        max_rows = g->batch_size;
+    }
+    if (rows <= 0 || rows > max_rows || (sign > 0 && size != g->corr_size))
+        return -1;
+
+    /* The app always transforms max_rows; rows past the batch are stale
+     * and never read back */
+    size_t bytes = (size_t)rows * size * 2 * sizeof(float);
+    memcpy(g->vk.slots[0].mapped, data, bytes);
+
+    int r = vk_ctx_fft_run(&g->vk, 0, app, sign, (uint64_t)5000000000);
+    if (r != 0) {
+        if (r == 1)
+            fprintf(stderr, "GPU: fence wait timed out\n");
+        return -1;
     }
 
+    memcpy(data, g->vk.slots[0].mapped, bytes);
     return 0;
 }
 
@@ -14,15 +14,30 @@
  * Minimal HTTP server with SSE (Server-Sent Events) for real-time
  * map updates. Uses Leaflet.js + OpenStreetMap for visualization.
  *
- * Two endpoints:
+ * Endpoints:
  *   GET /           → embedded HTML/JS map page
- *   GET /api/events → SSE stream (1 Hz JSON updates)
+ *   GET /api/events → SSE stream (snapshot on connect, 1 Hz deltas)
+ *   GET /api/state  → current map state as JSON
+ *   GET /metrics    → pipeline counters and timings (Prometheus text)
+ *
+ * The decoders never wait on the server. The output thread publishes
+ * each point onto a single-producer ring and the stats thread publishes
+ * the receiver position through a seqlock; neither takes a lock the
+ * server holds. One server thread owns the map, drains the ring, and
+ * serves every client from a single epoll (poll() elsewhere) loop on
+ * non-blocking sockets. Every stored point carries the map sequence
+ * number of its last change, so once per tick the server builds a single
+ * delta of the points changed since the previous tick and queues the same
+ * refcounted buffer on every SSE client. A full snapshot is only built for
+ * newly connected clients, /api/state, and clients too slow to keep up.
  */
 
 #include <arpa/inet.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <math.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <pthread.h>
 #include <signal.h>
 #include <stdatomic.h>
@@ -33,9 +48,13 @@
 #include <sys/uio.h>
 #include <time.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 
 #include "web_map.h"
 #include "ida_decode.h"
+#include "pipeline_stats.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -48,11 +67,26 @@
 #define MAX_MT_POINTS    500
 #define MAX_SATELLITES   100
 #define MAX_SSE_CLIENTS  8
+#define MAX_HTTP_CLIENTS 32
 #define JSON_BUF_SIZE    131072
+#define METRICS_BUF_SIZE 32768
 #define HTTP_BUF_SIZE    4096
 
-/* ---- SSE client count ---- */
-static atomic_int sse_client_count = 0;
+/* Points queued between server wake-ups (power of two) */
+#define UPDATE_RING      4096
+
+#define TICK_MS          1000   /* SSE delta period */
+#define DRAIN_MS         100    /* longest the ring waits to be drained */
+#define REQUEST_TIMEOUT_MS 10000
+
+/* Events queued per client; a client that falls this far behind has its
+ * pending deltas replaced by a snapshot */
+#define CLIENT_QUEUE     8
+
+/* Most recent points sent per category */
+#define SNAP_RA          500
+#define SNAP_BEAMS       300
+#define SNAP_MT          200
 
 /* ---- Shared state ---- */
 
@@ -64,6 +98,8 @@ typedef struct {
     uint32_t tmsi;
     double frequency;
     uint64_t timestamp;
+    uint64_t id;            /* map sequence at creation */
+    uint64_t seq;           /* map sequence of the last change */
 } ra_point_t;
 
 /* Ground beam center position (alt < 100 from IRA frames) */
@@ -75,6 +111,7 @@ typedef struct {
     uint32_t tmsi;
     double frequency;
     uint64_t timestamp;
+    uint64_t id, seq;
 } beam_point_t;
 
 /* MT phone/terminal position from IDA reassembly */
@@ -84,6 +121,7 @@ typedef struct {
     uint16_t msg_type;
     uint64_t timestamp;
     double frequency;
+    uint64_t id, seq;
 } mt_point_t;
 
 typedef struct {
@@ -93,8 +131,8 @@ typedef struct {
     int count;
 } sat_entry_t;
 
+/* Owned by the server thread */
 static struct {
-    pthread_mutex_t lock;
     ra_point_t ra[MAX_RA_POINTS];
     int ra_head;
     int ra_count;
@@ -106,122 +144,251 @@ static struct {
     int mt_count;
     sat_entry_t sats[MAX_SATELLITES];
     int n_sats;
-    unsigned long total_ira;
-    unsigned long total_ibc;
-    unsigned long total_pages;
-    unsigned long total_beams;
-    unsigned long total_mt;
-    /* Doppler positioning receiver estimate */
-    double rx_lat, rx_lon;
-    double rx_hdop;
-    int rx_valid;
+    uint64_t seq;           /* bumped for every point added or changed */
 } state;
 
+/* Counted by the writers, so points dropped from a full ring still count */
+static atomic_ulong total_ira, total_ibc, total_pages, total_beams, total_mt;
+
+/* ---- Update ring (output thread → server thread) ---- */
+
+enum { UPD_RA, UPD_BEAM, UPD_MT, UPD_SAT };
+
+typedef struct {
+    int kind;
+    double lat, lon;
+    int alt;
+    int sat_id, beam_id;
+    int n_pages;
+    uint32_t tmsi;
+    uint16_t msg_type;
+    double frequency;
+    uint64_t timestamp;
+} map_update_t;
+
+static map_update_t updates[UPDATE_RING];
+static atomic_size_t upd_head, upd_tail;
+static atomic_ulong upd_dropped;
+
+/* Next free ring slot, or NULL (counted as dropped) while the ring is full */
+static map_update_t *upd_claim(void)
+{
+    size_t tail = atomic_load_explicit(&upd_tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&upd_head, memory_order_acquire);
+    if (tail - head == UPDATE_RING) {
+        atomic_fetch_add(&upd_dropped, 1);
+        return NULL;
+    }
+    return &updates[tail % UPDATE_RING];
+}
+
+static void upd_publish(void)
+{
+    size_t tail = atomic_load_explicit(&upd_tail, memory_order_relaxed);
+    atomic_store_explicit(&upd_tail, tail + 1, memory_order_release);
+}
+
+/* ---- Receiver position (stats thread → server thread, seqlock) ---- */
+
+static struct {
+    atomic_uint seq;        /* odd while the writer is mid-update */
+    _Atomic double lat, lon, hdop;
+} rx;
+
+static int rx_read(double *lat, double *lon, double *hdop)
+{
+    unsigned s1, s2;
+    do {
+        s1 = atomic_load_explicit(&rx.seq, memory_order_acquire);
+        *lat = atomic_load_explicit(&rx.lat, memory_order_relaxed);
+        *lon = atomic_load_explicit(&rx.lon, memory_order_relaxed);
+        *hdop = atomic_load_explicit(&rx.hdop, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        s2 = atomic_load_explicit(&rx.seq, memory_order_relaxed);
+    } while (s1 != s2 || (s1 & 1));
+    return s1 != 0;
+}
+
 /* ---- Server state ---- */
 
 static int server_fd = -1;
 static pthread_t server_thread;
-static volatile int server_running = 0;
+static atomic_int server_running = 0;
+
+/* ---- State update functions ---- */
+
+static void fill_ra_update(map_update_t *u, int kind, const ira_data_t *ra,
+                           uint64_t timestamp, double frequency)
+{
+    u->kind = kind;
+    u->lat = ra->lat;
+    u->lon = ra->lon;
+    u->alt = ra->alt;
+    u->sat_id = ra->sat_id;
+    u->beam_id = ra->beam_id;
+    u->n_pages = ra->n_pages;
+    u->tmsi = (ra->n_pages > 0) ? ra->pages[0].tmsi : 0;
+    u->frequency = frequency;
+    u->timestamp = timestamp;
+}
+
+void web_map_add_ra(const ira_data_t *ra, uint64_t timestamp,
+                     double frequency)
+{
+    /* Sanity check coordinates */
+    if (ra->lat < -90 || ra->lat > 90 || ra->lon < -180 || ra->lon > 180)
+        return;
+    if (ra->sat_id == 0 && ra->beam_id == 0 && ra->lat == 0 && ra->lon == 0)
+        return;
+
+    int kind;
+    if (ra->alt >= 0 && ra->alt < 100) {
+        /* Ground beam position: alt < 100 km (beam center on earth surface) */
+        kind = UPD_BEAM;
+        atomic_fetch_add(&total_beams, 1);
+    } else if (ra->alt >= 700 && ra->alt <= 900) {
+        /* Satellite orbital position: 700-900 km */
+        kind = UPD_RA;
+    } else {
+        return;
+    }
+    atomic_fetch_add(&total_ira, 1);
+    if (ra->n_pages > 0)
+        atomic_fetch_add(&total_pages, 1);
+
+    map_update_t *u = upd_claim();
+    if (!u) return;
+    fill_ra_update(u, kind, ra, timestamp, frequency);
+    upd_publish();
+}
+
+void web_map_add_sat(const ibc_data_t *ibc, uint64_t timestamp)
+{
+    if (ibc->sat_id == 0) return;
+
+    atomic_fetch_add(&total_ibc, 1);
+
+    map_update_t *u = upd_claim();
+    if (!u) return;
+    u->kind = UPD_SAT;
+    u->sat_id = ibc->sat_id;
+    u->beam_id = ibc->beam_id;
+    u->timestamp = timestamp;
+    upd_publish();
+}
+
+void web_map_set_position(double lat, double lon, double hdop)
+{
+    unsigned s = atomic_load_explicit(&rx.seq, memory_order_relaxed);
+    atomic_store_explicit(&rx.seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&rx.lat, lat, memory_order_relaxed);
+    atomic_store_explicit(&rx.lon, lon, memory_order_relaxed);
+    atomic_store_explicit(&rx.hdop, hdop, memory_order_relaxed);
+    atomic_store_explicit(&rx.seq, s + 2, memory_order_release);
+}
+
+void web_map_add_mt(double lat, double lon, int alt, uint16_t msg_type,
+                     uint64_t timestamp, double frequency)
+{
+    if (lat < -90 || lat > 90 || lon < -180 || lon > 180)
+        return;
 
-/* ---- State update functions (thread-safe) ---- */
+    atomic_fetch_add(&total_mt, 1);
+
+    map_update_t *u = upd_claim();
+    if (!u) return;
+    u->kind = UPD_MT;
+    u->lat = lat;
+    u->lon = lon;
+    u->alt = alt;
+    u->msg_type = msg_type;
+    u->timestamp = timestamp;
+    u->frequency = frequency;
+    upd_publish();
+}
+
+/* ---- Applying updates (server thread) ---- */
 
-static void add_beam_locked(const ira_data_t *ra, uint64_t timestamp,
-                             double frequency)
+static void apply_beam(const map_update_t *u)
 {
     /* Deduplication: skip if same sat_id already has this lat/lon recently */
     int search = (state.beam_count < 20) ? state.beam_count : 20;
     for (int i = 0; i < search; i++) {
         int idx = (state.beam_head - 1 - i + MAX_BEAM_POINTS) % MAX_BEAM_POINTS;
         beam_point_t *b = &state.beams[idx];
-        if (b->sat_id == ra->sat_id &&
-            fabs(b->lat - ra->lat) < 0.001 &&
-            fabs(b->lon - ra->lon) < 0.001) {
+        if (b->sat_id == u->sat_id &&
+            fabs(b->lat - u->lat) < 0.001 &&
+            fabs(b->lon - u->lon) < 0.001) {
             /* Duplicate -- update timestamp and page info */
-            b->timestamp = timestamp;
-            if (ra->n_pages > 0) {
-                b->n_pages = ra->n_pages;
-                b->tmsi = ra->pages[0].tmsi;
-                state.total_pages++;
+            b->timestamp = u->timestamp;
+            if (u->n_pages > 0) {
+                b->n_pages = u->n_pages;
+                b->tmsi = u->tmsi;
             }
-            state.total_beams++;
+            b->seq = ++state.seq;
             return;
         }
     }
 
     beam_point_t *p = &state.beams[state.beam_head];
-    p->lat = ra->lat;
-    p->lon = ra->lon;
-    p->alt = ra->alt;
-    p->sat_id = ra->sat_id;
-    p->beam_id = ra->beam_id;
-    p->n_pages = ra->n_pages;
-    p->tmsi = (ra->n_pages > 0) ? ra->pages[0].tmsi : 0;
-    p->frequency = frequency;
-    p->timestamp = timestamp;
+    p->lat = u->lat;
+    p->lon = u->lon;
+    p->alt = u->alt;
+    p->sat_id = u->sat_id;
+    p->beam_id = u->beam_id;
+    p->n_pages = u->n_pages;
+    p->tmsi = u->tmsi;
+    p->frequency = u->frequency;
+    p->timestamp = u->timestamp;
+    p->id = p->seq = ++state.seq;
 
     state.beam_head = (state.beam_head + 1) % MAX_BEAM_POINTS;
     if (state.beam_count < MAX_BEAM_POINTS)
         state.beam_count++;
-    state.total_beams++;
-    if (ra->n_pages > 0)
-        state.total_pages++;
 }
 
-void web_map_add_ra(const ira_data_t *ra, uint64_t timestamp,
-                     double frequency)
+static void apply_ra(const map_update_t *u)
 {
-    /* Sanity check coordinates */
-    if (ra->lat < -90 || ra->lat > 90 || ra->lon < -180 || ra->lon > 180)
-        return;
-    if (ra->sat_id == 0 && ra->beam_id == 0 && ra->lat == 0 && ra->lon == 0)
-        return;
-
-    /* Ground beam position: alt < 100 km (beam center on earth surface) */
-    if (ra->alt >= 0 && ra->alt < 100) {
-        pthread_mutex_lock(&state.lock);
-        state.total_ira++;
-        add_beam_locked(ra, timestamp, frequency);
-        pthread_mutex_unlock(&state.lock);
-        return;
-    }
-
-    /* Satellite orbital position: 700-900 km */
-    if (ra->alt < 700 || ra->alt > 900)
-        return;
-
-    pthread_mutex_lock(&state.lock);
-
     ra_point_t *p = &state.ra[state.ra_head];
-    p->lat = ra->lat;
-    p->lon = ra->lon;
-    p->alt = ra->alt;
-    p->sat_id = ra->sat_id;
-    p->beam_id = ra->beam_id;
-    p->n_pages = ra->n_pages;
-    p->tmsi = (ra->n_pages > 0) ? ra->pages[0].tmsi : 0;
-    p->frequency = frequency;
-    p->timestamp = timestamp;
+    p->lat = u->lat;
+    p->lon = u->lon;
+    p->alt = u->alt;
+    p->sat_id = u->sat_id;
+    p->beam_id = u->beam_id;
+    p->n_pages = u->n_pages;
+    p->tmsi = u->tmsi;
+    p->frequency = u->frequency;
+    p->timestamp = u->timestamp;
+    p->id = p->seq = ++state.seq;
 
     state.ra_head = (state.ra_head + 1) % MAX_RA_POINTS;
     if (state.ra_count < MAX_RA_POINTS)
         state.ra_count++;
-    state.total_ira++;
-    if (ra->n_pages > 0)
-        state.total_pages++;
-
-    pthread_mutex_unlock(&state.lock);
 }
 
-void web_map_add_sat(const ibc_data_t *ibc, uint64_t timestamp)
+static void apply_mt(const map_update_t *u)
 {
-    if (ibc->sat_id == 0) return;
+    mt_point_t *p = &state.mt[state.mt_head];
+    p->lat = u->lat;
+    p->lon = u->lon;
+    p->alt = u->alt;
+    p->msg_type = u->msg_type;
+    p->timestamp = u->timestamp;
+    p->frequency = u->frequency;
+    p->id = p->seq = ++state.seq;
 
-    pthread_mutex_lock(&state.lock);
+    state.mt_head = (state.mt_head + 1) % MAX_MT_POINTS;
+    if (state.mt_count < MAX_MT_POINTS)
+        state.mt_count++;
+}
 
+static void apply_sat(const map_update_t *u)
+{
     /* Find or create satellite entry */
     int idx = -1;
     for (int i = 0; i < state.n_sats; i++) {
-        if (state.sats[i].sat_id == ibc->sat_id) {
+        if (state.sats[i].sat_id == u->sat_id) {
             idx = i;
             break;
         }
@@ -229,52 +396,35 @@ void web_map_add_sat(const ibc_data_t *ibc, uint64_t timestamp)
 
     if (idx < 0 && state.n_sats < MAX_SATELLITES) {
         idx = state.n_sats++;
-        state.sats[idx].sat_id = ibc->sat_id;
+        state.sats[idx].sat_id = u->sat_id;
         state.sats[idx].count = 0;
     }
 
     if (idx >= 0) {
-        state.sats[idx].beam_id = ibc->beam_id;
-        state.sats[idx].last_seen = timestamp;
+        state.sats[idx].beam_id = u->beam_id;
+        state.sats[idx].last_seen = u->timestamp;
         state.sats[idx].count++;
     }
-    state.total_ibc++;
-
-    pthread_mutex_unlock(&state.lock);
-}
-
-void web_map_set_position(double lat, double lon, double hdop)
-{
-    pthread_mutex_lock(&state.lock);
-    state.rx_lat = lat;
-    state.rx_lon = lon;
-    state.rx_hdop = hdop;
-    state.rx_valid = 1;
-    pthread_mutex_unlock(&state.lock);
 }
 
-void web_map_add_mt(double lat, double lon, int alt, uint16_t msg_type,
-                     uint64_t timestamp, double frequency)
+/* Apply everything the output thread has published. Returns the number of
+ * updates applied. */
+static size_t drain_updates(void)
 {
-    if (lat < -90 || lat > 90 || lon < -180 || lon > 180)
-        return;
-
-    pthread_mutex_lock(&state.lock);
-
-    mt_point_t *p = &state.mt[state.mt_head];
-    p->lat = lat;
-    p->lon = lon;
-    p->alt = alt;
-    p->msg_type = msg_type;
-    p->timestamp = timestamp;
-    p->frequency = frequency;
-
-    state.mt_head = (state.mt_head + 1) % MAX_MT_POINTS;
-    if (state.mt_count < MAX_MT_POINTS)
-        state.mt_count++;
-    state.total_mt++;
-
-    pthread_mutex_unlock(&state.lock);
+    size_t head = atomic_load_explicit(&upd_head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&upd_tail, memory_order_acquire);
+
+    for (size_t i = head; i != tail; i++) {
+        const map_update_t *u = &updates[i % UPDATE_RING];
+        switch (u->kind) {
+        case UPD_RA:   apply_ra(u);   break;
+        case UPD_BEAM: apply_beam(u); break;
+        case UPD_MT:   apply_mt(u);   break;
+        case UPD_SAT:  apply_sat(u);  break;
+        }
+    }
+    atomic_store_explicit(&upd_head, tail, memory_order_release);
+    return tail - head;
 }
 
 /* ---- MT position extraction from IDA messages ---- */
@@ -362,29 +512,32 @@ void mtpos_ida_cb(const uint8_t *data, int len,
 
 /* ---- JSON serialization ---- */
 
-static int build_json(char *buf, int bufsize)
+/* Map state as JSON: the totals, satellites and receiver position, plus
+ * the points changed after map sequence since (0 for all of them) */
+static int build_json(char *buf, int bufsize, uint64_t since)
 {
-    pthread_mutex_lock(&state.lock);
-
     int off = 0;
     off += snprintf(buf + off, bufsize - off,
-                    "{\"total_ira\":%lu,\"total_ibc\":%lu,\"total_pages\":%lu,"
-                    "\"total_beams\":%lu,\"total_mt\":%lu,",
-                    state.total_ira, state.total_ibc, state.total_pages,
-                    state.total_beams, state.total_mt);
-
-    /* Satellite orbital positions (most recent first, max 500) */
+                    "{\"seq\":%llu,\"total_ira\":%lu,\"total_ibc\":%lu,"
+                    "\"total_pages\":%lu,\"total_beams\":%lu,\"total_mt\":%lu,",
+                    (unsigned long long)state.seq,
+                    atomic_load(&total_ira), atomic_load(&total_ibc),
+                    atomic_load(&total_pages), atomic_load(&total_beams),
+                    atomic_load(&total_mt));
+
+    /* Satellite orbital positions (most recent first, max SNAP_RA) */
     off += snprintf(buf + off, bufsize - off, "\"ra\":[");
     int n_out = 0;
-    for (int i = 0; i < state.ra_count && n_out < 500; i++) {
+    for (int i = 0; i < state.ra_count && n_out < SNAP_RA; i++) {
         int idx = (state.ra_head - 1 - i + MAX_RA_POINTS) % MAX_RA_POINTS;
         ra_point_t *p = &state.ra[idx];
+        if (p->seq <= since) break;
         if (n_out > 0) off += snprintf(buf + off, bufsize - off, ",");
         off += snprintf(buf + off, bufsize - off,
-            "{\"lat\":%.4f,\"lon\":%.4f,\"alt\":%d,"
+            "{\"id\":%llu,\"lat\":%.4f,\"lon\":%.4f,\"alt\":%d,"
             "\"sat\":%d,\"beam\":%d,\"pages\":%d,"
             "\"tmsi\":%u,\"freq\":%.0f,\"t\":%llu}",
-            p->lat, p->lon, p->alt,
+            (unsigned long long)p->id, p->lat, p->lon, p->alt,
             p->sat_id, p->beam_id, p->n_pages,
             p->tmsi, p->frequency,
             (unsigned long long)(p->timestamp / 1000000000ULL));
@@ -393,18 +546,20 @@ static int build_json(char *buf, int bufsize)
     }
     off += snprintf(buf + off, bufsize - off, "],");
 
-    /* Ground beam positions (most recent first, max 300) */
+    /* Ground beam positions (most recent first, max SNAP_BEAMS). Duplicates
+     * update a point in place, so changed points are not all at the head. */
     off += snprintf(buf + off, bufsize - off, "\"beams\":[");
     n_out = 0;
-    for (int i = 0; i < state.beam_count && n_out < 300; i++) {
+    for (int i = 0; i < state.beam_count && n_out < SNAP_BEAMS; i++) {
         int idx = (state.beam_head - 1 - i + MAX_BEAM_POINTS) % MAX_BEAM_POINTS;
         beam_point_t *p = &state.beams[idx];
+        if (p->seq <= since) continue;
         if (n_out > 0) off += snprintf(buf + off, bufsize - off, ",");
         off += snprintf(buf + off, bufsize - off,
-            "{\"lat\":%.4f,\"lon\":%.4f,\"alt\":%d,"
+            "{\"id\":%llu,\"lat\":%.4f,\"lon\":%.4f,\"alt\":%d,"
             "\"sat\":%d,\"beam\":%d,\"pages\":%d,"
             "\"tmsi\":%u,\"freq\":%.0f,\"t\":%llu}",
-            p->lat, p->lon, p->alt,
+            (unsigned long long)p->id, p->lat, p->lon, p->alt,
             p->sat_id, p->beam_id, p->n_pages,
             p->tmsi, p->frequency,
             (unsigned long long)(p->timestamp / 1000000000ULL));
@@ -413,17 +568,18 @@ static int build_json(char *buf, int bufsize)
     }
     off += snprintf(buf + off, bufsize - off, "],");
 
-    /* MT phone/terminal positions (most recent first, max 200) */
+    /* MT phone/terminal positions (most recent first, max SNAP_MT) */
     off += snprintf(buf + off, bufsize - off, "\"mt\":[");
     n_out = 0;
-    for (int i = 0; i < state.mt_count && n_out < 200; i++) {
+    for (int i = 0; i < state.mt_count && n_out < SNAP_MT; i++) {
         int idx = (state.mt_head - 1 - i + MAX_MT_POINTS) % MAX_MT_POINTS;
         mt_point_t *p = &state.mt[idx];
+        if (p->seq <= since) break;
         if (n_out > 0) off += snprintf(buf + off, bufsize - off, ",");
         off += snprintf(buf + off, bufsize - off,
-            "{\"lat\":%.4f,\"lon\":%.4f,\"alt\":%d,"
+            "{\"id\":%llu,\"lat\":%.4f,\"lon\":%.4f,\"alt\":%d,"
             "\"type\":%u,\"freq\":%.0f,\"t\":%llu}",
-            p->lat, p->lon, p->alt,
+            (unsigned long long)p->id, p->lat, p->lon, p->alt,
             (unsigned)p->msg_type, p->frequency,
             (unsigned long long)(p->timestamp / 1000000000ULL));
         n_out++;
@@ -454,15 +610,14 @@ static int build_json(char *buf, int bufsize)
     off += snprintf(buf + off, bufsize - off, "]");
 
     /* Receiver position estimate (Doppler positioning) */
-    if (state.rx_valid) {
+    double rx_lat, rx_lon, rx_hdop;
+    if (rx_read(&rx_lat, &rx_lon, &rx_hdop)) {
         off += snprintf(buf + off, bufsize - off,
             ",\"rx\":{\"lat\":%.6f,\"lon\":%.6f,\"hdop\":%.1f}",
-            state.rx_lat, state.rx_lon, state.rx_hdop);
+            rx_lat, rx_lon, rx_hdop);
     }
 
     off += snprintf(buf + off, bufsize - off, "}");
-
-    pthread_mutex_unlock(&state.lock);
     return off;
 }
 
@@ -727,11 +882,28 @@ static const char HTML_PAGE[] =
 "  }\n"
 "}\n"
 "\n"
+"/* Points by id: a snapshot replaces them, a delta adds or updates */\n"
+"var P={ra:{},beams:{},mt:{}};\n"
+"var LIM={ra:500,beams:300,mt:200};\n"
+"function merge(d,reset){\n"
+"  ['ra','beams','mt'].forEach(function(k){\n"
+"    if(reset)P[k]={};\n"
+"    if(d[k])d[k].forEach(function(p){P[k][p.id]=p});\n"
+"    var ids=Object.keys(P[k]).map(Number).sort(function(a,b){return b-a});\n"
+"    ids.slice(LIM[k]).forEach(function(id){delete P[k][id]});\n"
+"    d[k]=ids.slice(0,LIM[k]).map(function(id){return P[k][id]});\n"
+"  });\n"
+"  update(d);\n"
+"}\n"
+"\n"
 "function connect(){\n"
 "  var base=window.location.href.split('#')[0].split('?')[0].replace(/\\/?$/,'/');\n"
 "  var es=new EventSource(base+'api/events');\n"
-"  es.addEventListener('update',function(e){\n"
-"    try{update(JSON.parse(e.data))}catch(err){}\n"
+"  es.addEventListener('snapshot',function(e){\n"
+"    try{merge(JSON.parse(e.data),true)}catch(err){}\n"
+"  });\n"
+"  es.addEventListener('delta',function(e){\n"
+"    try{merge(JSON.parse(e.data),false)}catch(err){}\n"
 "  });\n"
 "  es.onerror=function(){\n"
 "    document.getElementById('status').style.color='#ef4444';\n"
@@ -743,83 +915,227 @@ static const char HTML_PAGE[] =
 "connect();\n"
 "</script></body></html>\n";
 
-/* ---- HTTP request handling ---- */
+/* ---- Refcounted output buffers ---- */
 
-static void send_response(int fd, const char *status, const char *content_type,
-                            const char *body, int body_len)
+/* One response body or SSE event, queued on any number of clients */
+typedef struct {
+    int refs;
+    int len;
+    int body_off, body_len;     /* the JSON inside an SSE event */
+    char data[];
+} wm_buf_t;
+
+static wm_buf_t *buf_new(int cap)
 {
-    char header[512];
-    int hlen = snprintf(header, sizeof(header),
-        "HTTP/1.1 %s\r\n"
-        "Content-Type: %s\r\n"
-        "Content-Length: %d\r\n"
-        "Connection: close\r\n"
-        "Access-Control-Allow-Origin: *\r\n"
-        "\r\n", status, content_type, body_len);
-    if (write(fd, header, hlen) < 0) return;
-    if (body_len > 0) {
-        if (write(fd, body, body_len) < 0) return;
-    }
+    wm_buf_t *b = malloc(sizeof(*b) + cap);
+    b->refs = 1;
+    b->len = 0;
+    b->body_off = b->body_len = 0;
+    return b;
 }
 
-static void handle_sse(int fd)
+static void buf_unref(wm_buf_t *b)
 {
-    char header[256];
-    int hlen = snprintf(header, sizeof(header),
-        "HTTP/1.1 200 OK\r\n"
-        "Content-Type: text/event-stream\r\n"
-        "Cache-Control: no-cache\r\n"
-        "Connection: keep-alive\r\n"
-        "X-Accel-Buffering: no\r\n"
-        "Access-Control-Allow-Origin: *\r\n"
-        "\r\n");
-    if (write(fd, header, hlen) < 0) return;
+    if (b && --b->refs == 0)
+        free(b);
+}
+
+/* SSE event carrying the points changed after map sequence since */
+static wm_buf_t *build_event(const char *name, uint64_t since)
+{
+    wm_buf_t *b = buf_new(JSON_BUF_SIZE);
+    int off = snprintf(b->data, JSON_BUF_SIZE, "event: %s\nid: %llu\ndata: ",
+                       name, (unsigned long long)state.seq);
+    b->body_off = off;
+    b->body_len = build_json(b->data + off, JSON_BUF_SIZE - off - 64, since);
+    off += b->body_len;
+    memcpy(b->data + off, "\n\n", 2);
+    b->len = off + 2;
+    return realloc(b, sizeof(*b) + b->len);
+}
+
+/* Full map state, built at most once per change and shared by new SSE
+ * clients and /api/state */
+static wm_buf_t *snapshot = NULL;
 
-    char *json = malloc(JSON_BUF_SIZE);
-    if (!json) return;
+static wm_buf_t *get_snapshot(void)
+{
+    if (!snapshot)
+        snapshot = build_event("snapshot", 0);
+    return snapshot;
+}
+
+static void snapshot_invalidate(void)
+{
+    buf_unref(snapshot);
+    snapshot = NULL;
+}
+
+/* ---- Clients ---- */
 
-    while (server_running) {
-        usleep(1000000);  /* 1 Hz updates */
-        if (!server_running) break;
+enum { CL_FREE, CL_REQUEST, CL_RESPONSE, CL_SSE };
+
+typedef struct {
+    wm_buf_t *buf;              /* NULL for static data */
+    const char *data;
+    int len;
+} out_chunk_t;
 
-        int jlen = build_json(json, JSON_BUF_SIZE - 64);
+typedef struct {
+    int fd;
+    int state;
+    char req[HTTP_BUF_SIZE];
+    int req_len;
+    uint64_t opened_ms;
+    out_chunk_t q[CLIENT_QUEUE];
+    int q_n;
+    uint64_t seq;               /* SSE: map sequence sent so far */
+    short armed;                /* events registered with epoll */
+} wm_client_t;
+
+static wm_client_t clients[MAX_HTTP_CLIENTS];
+static int n_sse = 0;
+static uint64_t tick_seq = 0;   /* map sequence at the last SSE tick */
+
+#ifdef __linux__
+#define LISTEN_TAG UINT32_MAX
+static int ep_fd = -1;
+#endif
 
-        char prefix[] = "event: update\ndata: ";
-        char suffix[] = "\n\n";
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
 
-        struct iovec iov[3];
-        iov[0].iov_base = prefix;
-        iov[0].iov_len = sizeof(prefix) - 1;
-        iov[1].iov_base = json;
-        iov[1].iov_len = jlen;
-        iov[2].iov_base = suffix;
-        iov[2].iov_len = sizeof(suffix) - 1;
+static void set_nonblock(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
 
-        /* Use writev for atomic write */
-        if (writev(fd, iov, 3) < 0) break;
+/* Register the events the client currently needs */
+static void client_arm(wm_client_t *c)
+{
+#ifdef __linux__
+    short want = POLLIN | (c->q_n ? POLLOUT : 0);
+    if (want == c->armed) return;
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | (c->q_n ? EPOLLOUT : 0);
+    ev.data.u32 = (uint32_t)(c - clients);
+    epoll_ctl(ep_fd, c->armed ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, c->fd, &ev);
+    c->armed = want;
+#else
+    (void)c;
+#endif
+}
+
+static void client_close(wm_client_t *c)
+{
+    for (int i = 0; i < c->q_n; i++)
+        buf_unref(c->q[i].buf);
+    if (c->state == CL_SSE)
+        n_sse--;
+    close(c->fd);
+    c->fd = -1;
+    c->state = CL_FREE;
+    c->q_n = 0;
+    c->armed = 0;
+}
+
+static void client_queue(wm_client_t *c, wm_buf_t *buf,
+                          const char *data, int len)
+{
+    if (c->q_n == CLIENT_QUEUE || len <= 0) return;
+    if (buf) buf->refs++;
+    c->q[c->q_n].buf = buf;
+    c->q[c->q_n].data = data;
+    c->q[c->q_n].len = len;
+    c->q_n++;
+}
+
+/* Write as much of the queue as the socket takes. Returns -1 once the
+ * client is to be closed: on error, or when a response has gone out. */
+static int client_flush(wm_client_t *c)
+{
+    while (c->q_n > 0) {
+        struct iovec iov[CLIENT_QUEUE];
+        for (int i = 0; i < c->q_n; i++) {
+            iov[i].iov_base = (void *)c->q[i].data;
+            iov[i].iov_len = c->q[i].len;
+        }
+        ssize_t n = writev(c->fd, iov, c->q_n);
+        if (n < 0)
+            return (errno == EAGAIN || errno == EWOULDBLOCK ||
+                    errno == EINTR) ? 0 : -1;
+
+        int done = 0;
+        while (done < c->q_n && n >= c->q[done].len) {
+            n -= c->q[done].len;
+            buf_unref(c->q[done].buf);
+            done++;
+        }
+        if (done < c->q_n) {
+            c->q[done].data += n;
+            c->q[done].len -= n;
+        }
+        memmove(c->q, c->q + done, (c->q_n - done) * sizeof(c->q[0]));
+        c->q_n -= done;
     }
+    return c->state == CL_RESPONSE ? -1 : 0;
+}
 
-    free(json);
+static void client_service(wm_client_t *c)
+{
+    if (client_flush(c) < 0)
+        client_close(c);
+    else
+        client_arm(c);
 }
 
-static void *client_thread(void *arg)
+/* ---- HTTP request handling ---- */
+
+static const char SSE_HEADER[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "X-Accel-Buffering: no\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "\r\n";
+
+static void queue_response(wm_client_t *c, const char *status,
+                            const char *content_type, wm_buf_t *body_buf,
+                            const char *body, int body_len)
 {
-    int fd = (int)(intptr_t)arg;
+    wm_buf_t *h = buf_new(512);
+    h->len = snprintf(h->data, 512,
+        "HTTP/1.1 %s\r\n"
+        "Content-Type: %s\r\n"
+        "Content-Length: %d\r\n"
+        "Connection: close\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "\r\n", status, content_type, body_len);
+    client_queue(c, h, h->data, h->len);
+    buf_unref(h);
+    client_queue(c, body_buf, body, body_len);
+    c->state = CL_RESPONSE;
+}
 
-    char buf[HTTP_BUF_SIZE];
-    int n = read(fd, buf, sizeof(buf) - 1);
-    if (n <= 0) { close(fd); return NULL; }
-    buf[n] = '\0';
+static void handle_request(wm_client_t *c)
+{
+    char *buf = c->req;
 
     /* Parse GET path */
     if (strncmp(buf, "GET ", 4) != 0) {
-        send_response(fd, "405 Method Not Allowed", "text/plain", "405", 3);
-        close(fd);
-        return NULL;
+        queue_response(c, "405 Method Not Allowed", "text/plain",
+                       NULL, "405", 3);
+        return;
     }
 
     char *path = buf + 4;
-    char *end = strchr(path, ' ');
+    char *end = strpbrk(path, " \r\n");
     if (end) *end = '\0';
 
     /* Strip query string — reverse proxies may append ?... parameters */
@@ -827,67 +1143,235 @@ static void *client_thread(void *arg)
     if (qs) *qs = '\0';
 
     if (strcmp(path, "/") == 0 || strcmp(path, "/index.html") == 0) {
-        send_response(fd, "200 OK", "text/html",
-                       HTML_PAGE, sizeof(HTML_PAGE) - 1);
-        close(fd);
+        queue_response(c, "200 OK", "text/html",
+                       NULL, HTML_PAGE, sizeof(HTML_PAGE) - 1);
     } else if (strcmp(path, "/api/events") == 0) {
-        if (atomic_fetch_add(&sse_client_count, 1) >= MAX_SSE_CLIENTS) {
-            atomic_fetch_sub(&sse_client_count, 1);
-            send_response(fd, "503 Service Unavailable", "text/plain",
-                          "too many clients", 16);
-        } else {
-            handle_sse(fd);
-            atomic_fetch_sub(&sse_client_count, 1);
+        if (n_sse >= MAX_SSE_CLIENTS) {
+            queue_response(c, "503 Service Unavailable", "text/plain",
+                           NULL, "too many clients", 16);
+            return;
         }
-        close(fd);
+        /* Start with the full state; deltas follow on every tick */
+        client_queue(c, NULL, SSE_HEADER, sizeof(SSE_HEADER) - 1);
+        wm_buf_t *s = get_snapshot();
+        client_queue(c, s, s->data, s->len);
+        c->seq = state.seq;
+        c->state = CL_SSE;
+        n_sse++;
+    } else if (strcmp(path, "/metrics") == 0) {
+        wm_buf_t *text = buf_new(METRICS_BUF_SIZE);
+        text->len = pstats_format_prometheus(text->data, METRICS_BUF_SIZE);
+        queue_response(c, "200 OK", "text/plain; version=0.0.4",
+                       text, text->data, text->len);
+        buf_unref(text);
     } else if (strcmp(path, "/api/state") == 0) {
-        char *json = malloc(JSON_BUF_SIZE);
-        if (json) {
-            int jlen = build_json(json, JSON_BUF_SIZE);
-            send_response(fd, "200 OK", "application/json", json, jlen);
-            free(json);
-        }
-        close(fd);
+        wm_buf_t *s = get_snapshot();
+        queue_response(c, "200 OK", "application/json",
+                       s, s->data + s->body_off, s->body_len);
     } else {
-        send_response(fd, "404 Not Found", "text/plain", "404", 3);
-        close(fd);
+        queue_response(c, "404 Not Found", "text/plain", NULL, "404", 3);
     }
-
-    return NULL;
 }
 
-/* ---- Server thread ---- */
-
-static void *server_thread_fn(void *arg)
+static void client_read(wm_client_t *c)
 {
-    (void)arg;
+    if (c->state != CL_REQUEST) {
+        /* Nothing more is expected; this only notices the peer leaving */
+        char scratch[512];
+        ssize_t n = read(c->fd, scratch, sizeof(scratch));
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK &&
+                       errno != EINTR))
+            client_close(c);
+        return;
+    }
+
+    ssize_t n = read(c->fd, c->req + c->req_len,
+                     sizeof(c->req) - 1 - c->req_len);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK &&
+                   errno != EINTR)) {
+        client_close(c);
+        return;
+    }
+    if (n < 0) return;
+    c->req_len += n;
+    c->req[c->req_len] = '\0';
+
+    /* Only the request line matters; later header bytes are discarded */
+    if (!strchr(c->req, '\n') && c->req_len < (int)sizeof(c->req) - 1)
+        return;
+    handle_request(c);
+    client_service(c);
+}
 
-    while (server_running) {
-        struct sockaddr_in addr;
-        socklen_t addrlen = sizeof(addr);
-        int client = accept(server_fd, (struct sockaddr *)&addr, &addrlen);
-        if (client < 0) {
-            if (server_running) usleep(10000);
+static void accept_clients(void)
+{
+    for (;;) {
+        int fd = accept(server_fd, NULL, NULL);
+        if (fd < 0) return;
+
+        wm_client_t *c = NULL;
+        for (int i = 0; i < MAX_HTTP_CLIENTS; i++) {
+            if (clients[i].state == CL_FREE) {
+                c = &clients[i];
+                break;
+            }
+        }
+        if (!c) {
+            close(fd);
             continue;
         }
 
+        set_nonblock(fd);
+
         /* Set SO_KEEPALIVE for SSE connections */
         int keepalive = 1;
-        setsockopt(client, SOL_SOCKET, SO_KEEPALIVE,
+        setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE,
                     &keepalive, sizeof(keepalive));
 
-        /* Spawn client handler thread (detached) */
-        pthread_t tid;
-        pthread_attr_t attr;
-        pthread_attr_init(&attr);
-        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
-        if (pthread_create(&tid, &attr, client_thread,
-                            (void *)(intptr_t)client) != 0) {
-            close(client);
+        c->fd = fd;
+        c->state = CL_REQUEST;
+        c->req_len = 0;
+        c->q_n = 0;
+        c->armed = 0;
+        c->opened_ms = now_ms();
+        client_arm(c);
+    }
+}
+
+/* ---- Server thread ---- */
+
+/* Once per tick: one delta since the previous tick, shared by every SSE
+ * client that has all earlier events queued */
+static void sse_tick(void)
+{
+    wm_buf_t *delta = NULL;
+    uint64_t now = now_ms();
+
+    for (int i = 0; i < MAX_HTTP_CLIENTS; i++) {
+        wm_client_t *c = &clients[i];
+        if (c->state == CL_REQUEST && now - c->opened_ms > REQUEST_TIMEOUT_MS)
+            client_close(c);
+        if (c->state != CL_SSE)
+            continue;
+
+        if (c->q_n == CLIENT_QUEUE) {
+            /* Too slow for deltas: finish the event being written and
+             * replace the rest with a snapshot */
+            for (int j = 1; j < c->q_n; j++)
+                buf_unref(c->q[j].buf);
+            c->q_n = 1;
+            c->seq = 0;
+        }
+
+        wm_buf_t *b;
+        if (c->seq < tick_seq) {
+            b = get_snapshot();
+        } else {
+            if (!delta)
+                delta = build_event("delta", tick_seq);
+            b = delta;
+        }
+        client_queue(c, b, b->data, b->len);
+        c->seq = state.seq;
+        client_service(c);
+    }
+
+    buf_unref(delta);
+    tick_seq = state.seq;
+}
+
+typedef struct {
+    int tag;                    /* client index, or -1 for the listener */
+    short revents;              /* POLLIN and/or POLLOUT */
+} ready_t;
+
+static int wait_events(int timeout_ms, ready_t *ready)
+{
+    int n_ready = 0;
+#ifdef __linux__
+    struct epoll_event evs[MAX_HTTP_CLIENTS + 1];
+    int n = epoll_wait(ep_fd, evs, MAX_HTTP_CLIENTS + 1, timeout_ms);
+    for (int i = 0; i < n; i++) {
+        uint32_t e = evs[i].events;
+        ready[n_ready].tag = evs[i].data.u32 == LISTEN_TAG
+                           ? -1 : (int)evs[i].data.u32;
+        ready[n_ready].revents =
+            ((e & (EPOLLIN | EPOLLHUP | EPOLLERR)) ? POLLIN : 0) |
+            ((e & EPOLLOUT) ? POLLOUT : 0);
+        n_ready++;
+    }
+#else
+    struct pollfd pfd[MAX_HTTP_CLIENTS + 1];
+    int tags[MAX_HTTP_CLIENTS + 1];
+    int np = 0;
+    pfd[np].fd = server_fd;
+    pfd[np].events = POLLIN;
+    tags[np++] = -1;
+    for (int i = 0; i < MAX_HTTP_CLIENTS; i++) {
+        if (clients[i].state == CL_FREE) continue;
+        pfd[np].fd = clients[i].fd;
+        pfd[np].events = POLLIN | (clients[i].q_n ? POLLOUT : 0);
+        tags[np++] = i;
+    }
+    if (poll(pfd, np, timeout_ms) <= 0)
+        return 0;
+    for (int i = 0; i < np; i++) {
+        short e = pfd[i].revents;
+        if (!e) continue;
+        ready[n_ready].tag = tags[i];
+        ready[n_ready].revents =
+            ((e & (POLLIN | POLLHUP | POLLERR)) ? POLLIN : 0) |
+            (e & POLLOUT);
+        n_ready++;
+    }
+#endif
+    return n_ready;
+}
+
+static void *server_thread_fn(void *arg)
+{
+    (void)arg;
+    ready_t ready[MAX_HTTP_CLIENTS + 1];
+    uint64_t next_tick = now_ms() + TICK_MS;
+
+    while (atomic_load(&server_running)) {
+        uint64_t now = now_ms();
+        int timeout = next_tick > now ? (int)(next_tick - now) : 0;
+        if (timeout > DRAIN_MS) timeout = DRAIN_MS;
+
+        int n = wait_events(timeout, ready);
+
+        /* New points first, so requests below see them */
+        if (drain_updates() > 0)
+            snapshot_invalidate();
+
+        for (int i = 0; i < n; i++) {
+            if (ready[i].tag < 0) {
+                accept_clients();
+                continue;
+            }
+            wm_client_t *c = &clients[ready[i].tag];
+            if (c->state != CL_FREE && (ready[i].revents & POLLOUT))
+                client_service(c);
+            if (c->state != CL_FREE && (ready[i].revents & POLLIN))
+                client_read(c);
+        }
+
+        now = now_ms();
+        if (now >= next_tick) {
+            /* Totals and the receiver position change without a drain */
+            snapshot_invalidate();
+            sse_tick();
+            next_tick += TICK_MS;
+            if (next_tick <= now)
+                next_tick = now + TICK_MS;
         }
-        pthread_attr_destroy(&attr);
     }
 
+    for (int i = 0; i < MAX_HTTP_CLIENTS; i++)
+        if (clients[i].state != CL_FREE)
+            client_close(&clients[i]);
+    snapshot_invalidate();
     return NULL;
 }
 
@@ -896,7 +1380,10 @@ static void *server_thread_fn(void *arg)
 int web_map_init(int port)
 {
     memset(&state, 0, sizeof(state));
-    pthread_mutex_init(&state.lock, NULL);
+    for (int i = 0; i < MAX_HTTP_CLIENTS; i++) {
+        clients[i].fd = -1;
+        clients[i].state = CL_FREE;
+    }
 
     /* Ignore SIGPIPE (broken SSE connections) */
     signal(SIGPIPE, SIG_IGN);
@@ -929,8 +1416,25 @@ int web_map_init(int port)
         server_fd = -1;
         return -1;
     }
+    set_nonblock(server_fd);
+
+#ifdef __linux__
+    ep_fd = epoll_create1(0);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = LISTEN_TAG;
+    if (ep_fd < 0 || epoll_ctl(ep_fd, EPOLL_CTL_ADD, server_fd, &ev) < 0) {
+        perror("web_map: epoll");
+        if (ep_fd >= 0) close(ep_fd);
+        ep_fd = -1;
+        close(server_fd);
+        server_fd = -1;
+        return -1;
+    }
+#endif
 
-    server_running = 1;
+    atomic_store(&server_running, 1);
     if (pthread_create(&server_thread, NULL, server_thread_fn, NULL) != 0) {
         perror("web_map: pthread_create");
         close(server_fd);
@@ -944,15 +1448,23 @@ int web_map_init(int port)
 
 void web_map_shutdown(void)
 {
-    if (!server_running) return;
-    server_running = 0;
+    if (!atomic_load(&server_running)) return;
+    atomic_store(&server_running, 0);
+    pthread_join(server_thread, NULL);
 
     if (server_fd >= 0) {
-        shutdown(server_fd, SHUT_RDWR);
         close(server_fd);
         server_fd = -1;
     }
+#ifdef __linux__
+    if (ep_fd >= 0) {
+        close(ep_fd);
+        ep_fd = -1;
+    }
+#endif
 
-    pthread_join(server_thread, NULL);
-    pthread_mutex_destroy(&state.lock);
+    unsigned long dropped = atomic_load(&upd_dropped);
+    if (dropped)
+        fprintf(stderr, "Web map: %lu map updates dropped (update ring full)\n",
+                dropped);
 }
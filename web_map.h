@@ -26,23 +26,26 @@ int web_map_init(int port);
 /* Shut down the web map server and free resources. */
 void web_map_shutdown(void);
 
-/* Add a decoded IRA (ring alert) to the map state. Thread-safe.
- * Routes to beam storage (alt < 100) or satellite storage (700-900). */
+/* Add a decoded IRA (ring alert) to the map state. Never blocks.
+ * Routes to beam storage (alt < 100) or satellite storage (700-900).
+ * This and the other web_map_add_*() calls publish onto a single-producer
+ * ring: call them from one thread only (the output thread). */
 void web_map_add_ra(const ira_data_t *ra, uint64_t timestamp,
                      double frequency);
 
-/* Add/update a satellite from a decoded IBC frame. Thread-safe. */
+/* Add/update a satellite from a decoded IBC frame. Never blocks. */
 void web_map_add_sat(const ibc_data_t *ibc, uint64_t timestamp);
 
-/* Set estimated receiver position from Doppler positioning. Thread-safe. */
+/* Set estimated receiver position from Doppler positioning. Never blocks;
+ * callable from any one thread. */
 void web_map_set_position(double lat, double lon, double hdop);
 
-/* Add an MT (mobile terminal) position. Thread-safe. */
+/* Add an MT (mobile terminal) position. Never blocks. */
 void web_map_add_mt(double lat, double lon, int alt, uint16_t msg_type,
                      uint64_t timestamp, double frequency);
 
 /* IDA message callback for MT position extraction.
- * Pass to ida_reassemble() when --web is active. */
+ * Registered with ida_add_sink() when --web is active. */
 void mtpos_ida_cb(const uint8_t *data, int len, uint64_t timestamp,
                    double frequency, ir_direction_t direction,
                    float magnitude, void *user);